@@ -0,0 +1,60 @@
+#ifndef CMAGIC_BENCH_H
+#define CMAGIC_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Helpers shared by the benchmark programs. Every benchmark accepts an optional command line
+ * argument limiting the largest tested container size.
+ */
+
+static inline size_t bench_parse_max_size(int argc, char *argv[], size_t default_max_size) {
+    if (argc < 2) {
+        return default_max_size;
+    }
+
+    char *end;
+    unsigned long long parsed = strtoull(argv[1], &end, 10);
+    if (*end != '\0' || parsed == 0) {
+        fprintf(stderr, "usage: %s [max_size]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    return (size_t)parsed;
+}
+
+static inline double bench_seconds(void) {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static inline double bench_ns_per_op(double start_seconds, size_t operations) {
+    return (bench_seconds() - start_seconds) * 1e9 / (double)operations;
+}
+
+// Deterministic xorshift generator, so every run and every compared container sees the same input
+static inline unsigned bench_random(void) {
+    static unsigned state = 2463534242u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static inline void bench_shuffle(int *array, size_t size) {
+    for (size_t i = size; i > 1; i--) {
+        size_t j = bench_random() % i;
+        int tmp = array[i - 1];
+        array[i - 1] = array[j];
+        array[j] = tmp;
+    }
+}
+
+static inline int bench_int_comparator(const void *key1, const void *key2) {
+    int int_key1 = *(const int *)key1;
+    int int_key2 = *(const int *)key2;
+    return (int_key1 > int_key2) - (int_key1 < int_key2);
+}
+
+#endif /* CMAGIC_BENCH_H */
@@ -0,0 +1,178 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "cmagic/flat_map.h"
+#include "cmagic/map.h"
+#include "bench.h"
+
+/*
+ * Compares the flat map with the map engines on a read-mostly table of int keys and values. For
+ * every size, the table is built from keys in random order, then every key is looked up in a
+ * different random order. The flat map is built once by a batch and once from sorted keys. Memory
+ * is the number of bytes requested from the allocator per element while the table is built,
+ * excluding the overhead of the allocator itself, which only adds to the per node cost of the
+ * trees.
+ */
+
+static const struct {
+    const char *name;
+    cmagic_map_engine_t engine;
+} ENGINES[] = {
+    { "avl_tree", CMAGIC_MAP_ENGINE_AVL_TREE },
+    { "b_tree", CMAGIC_MAP_ENGINE_B_TREE },
+    { "compact", CMAGIC_MAP_ENGINE_COMPACT_TREE }
+};
+
+// Every block is preceded by a header holding its size, so freed bytes can be subtracted
+typedef union {
+    size_t size;
+    max_align_t alignment;
+} block_header_t;
+
+static size_t allocated_bytes;
+
+static void *counting_malloc(size_t size) {
+    block_header_t *header = (block_header_t *)malloc(sizeof(block_header_t) + size);
+    if (!header) {
+        return NULL;
+    }
+    header->size = size;
+    allocated_bytes += size;
+    return header + 1;
+}
+
+static void *counting_realloc(void *ptr, size_t size) {
+    if (!ptr) {
+        return counting_malloc(size);
+    }
+    block_header_t *header = (block_header_t *)ptr - 1;
+    const size_t old_size = header->size;
+    header = (block_header_t *)realloc(header, sizeof(block_header_t) + size);
+    if (!header) {
+        return NULL;
+    }
+    header->size = size;
+    allocated_bytes += size - old_size;
+    return header + 1;
+}
+
+static void counting_free(void *ptr) {
+    if (ptr) {
+        block_header_t *header = (block_header_t *)ptr - 1;
+        allocated_bytes -= header->size;
+        free(header);
+    }
+}
+
+static const cmagic_memory_alloc_packet_t COUNTING_ALLOC_PACKET = {
+    counting_malloc, counting_realloc, counting_free
+};
+
+static void print_result(const char *name, size_t size, double build_ns, double find_ns,
+                         size_t bytes, long long checksum) {
+    printf("%-11s %10zu %12.1f %12.1f %12.1f %s\n", name, size, build_ns, find_ns,
+           (double)bytes / (double)size, checksum == 0 ? "" : "CHECKSUM MISMATCH");
+}
+
+static void run_map(const char *engine_name, cmagic_map_engine_t engine, int *keys, size_t size) {
+    CMAGIC_MAP(int) map = CMAGIC_MAP_NEW_EXT(int, int, bench_int_comparator,
+                                             &COUNTING_ALLOC_PACKET, engine);
+    if (!map) {
+        fprintf(stderr, "map allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bench_shuffle(keys, size);
+    double start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        if (!CMAGIC_MAP_INSERT(map, &keys[i], &keys[i]).inserted_or_existing) {
+            fprintf(stderr, "insertion failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    double build_ns = bench_ns_per_op(start, size);
+    const size_t bytes = allocated_bytes;
+
+    bench_shuffle(keys, size);
+    long long checksum = 0;
+    start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        checksum += keys[i] - CMAGIC_MAP_GET_VALUE(int, CMAGIC_MAP_FIND(map, &keys[i]));
+    }
+    double find_ns = bench_ns_per_op(start, size);
+
+    CMAGIC_MAP_FREE(map);
+    print_result(engine_name, size, build_ns, find_ns, bytes, checksum);
+}
+
+static void run_flat_map(bool sorted, int *keys, size_t size) {
+    CMAGIC_FLAT_MAP(int) flat_map = CMAGIC_FLAT_MAP_NEW(int, int, bench_int_comparator,
+                                                        &COUNTING_ALLOC_PACKET);
+    if (!flat_map) {
+        fprintf(stderr, "flat map allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Keys are the numbers below size, so the sorted keys are their own values
+    if (sorted) {
+        for (size_t i = 0; i < size; i++) {
+            keys[i] = (int)i;
+        }
+    } else {
+        bench_shuffle(keys, size);
+    }
+
+    double start = bench_seconds();
+    bool built = true;
+    if (sorted) {
+        built = CMAGIC_FLAT_MAP_BUILD_SORTED(flat_map, keys, keys, size);
+    } else {
+        for (size_t i = 0; i < size && built; i++) {
+            built = CMAGIC_FLAT_MAP_BATCH_INSERT(flat_map, &keys[i], &keys[i]);
+        }
+        built = built && CMAGIC_FLAT_MAP_BATCH_COMMIT(flat_map);
+    }
+    if (!built) {
+        fprintf(stderr, "insertion failed\n");
+        exit(EXIT_FAILURE);
+    }
+    double build_ns = bench_ns_per_op(start, size);
+    const size_t bytes = allocated_bytes;
+
+    bench_shuffle(keys, size);
+    long long checksum = 0;
+    start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        checksum += keys[i] - CMAGIC_FLAT_MAP_GET_VALUE(int,
+                                                        CMAGIC_FLAT_MAP_FIND(flat_map, &keys[i]));
+    }
+    double find_ns = bench_ns_per_op(start, size);
+
+    CMAGIC_FLAT_MAP_FREE(flat_map);
+    print_result(sorted ? "flat_sorted" : "flat_batch", size, build_ns, find_ns, bytes, checksum);
+}
+
+int main(int argc, char *argv[]) {
+    const size_t max_size = bench_parse_max_size(argc, argv, 1000000);
+    int *keys = (int *)malloc(max_size * sizeof(int));
+    if (!keys) {
+        fprintf(stderr, "cannot allocate %zu keys\n", max_size);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-11s %10s %12s %12s %12s\n", "container", "size", "build ns", "find ns",
+           "bytes/elem");
+    for (size_t size = 1000; size <= max_size; size *= 10) {
+        for (size_t i = 0; i < size; i++) {
+            keys[i] = (int)i;
+        }
+        for (size_t i = 0; i < sizeof(ENGINES) / sizeof(ENGINES[0]); i++) {
+            run_map(ENGINES[i].name, ENGINES[i].engine, keys, size);
+        }
+        run_flat_map(false, keys, size);
+        run_flat_map(true, keys, size);
+    }
+
+    free(keys);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "cmagic/hash.h"
+#include "bench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_CYCLE_COUNTER 1
+#endif
+
+/*
+ * Measures the throughput of the byte hash for inputs of various lengths, compared with the
+ * byte-at-a-time FNV-1a hash. Inputs start one byte past an aligned address. Besides GB/s the
+ * throughput is given in bytes per cycle of the time stamp counter on x86, which ticks at the
+ * nominal frequency of the processor.
+ */
+
+#define TOTAL_BYTES ((size_t)1 << 28)
+
+static uint64_t fnv1a(const void *data, size_t size, uint64_t seed) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t hash = UINT64_C(0xCBF29CE484222325) ^ seed;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ p[i]) * UINT64_C(0x100000001B3);
+    }
+    return hash;
+}
+
+static uint64_t cycles(void) {
+#ifdef HAS_CYCLE_COUNTER
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void run(const char *hash_name, uint64_t (*hash)(const void *, size_t, uint64_t),
+                const uint8_t *input, size_t size) {
+    const size_t iterations = TOTAL_BYTES / size;
+    uint64_t checksum = 0;
+    const double start = bench_seconds();
+    const uint64_t start_cycles = cycles();
+    for (size_t i = 0; i < iterations; i++) {
+        // Feeding the previous hash as the seed keeps the calls from being optimized out
+        checksum = hash(input, size, checksum);
+    }
+    const uint64_t elapsed_cycles = cycles() - start_cycles;
+    const double seconds = bench_seconds() - start;
+    const double bytes = (double)(iterations * size);
+
+    printf("%-8s %10zu %12.2f", hash_name, size, bytes / seconds / 1e9);
+    if (elapsed_cycles > 0) {
+        printf(" %12.2f", bytes / (double)elapsed_cycles);
+    } else {
+        printf(" %12s", "n/a");
+    }
+    printf(" %016llx\n", (unsigned long long)checksum);
+}
+
+int main(int argc, char *argv[]) {
+    const size_t max_size = bench_parse_max_size(argc, argv, 1 << 20);
+    uint8_t *buffer = (uint8_t *)malloc(max_size + 1);
+    if (!buffer) {
+        fprintf(stderr, "cannot allocate %zu bytes\n", max_size);
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < max_size + 1; i++) {
+        buffer[i] = (uint8_t)bench_random();
+    }
+
+    printf("%-8s %10s %12s %12s %16s\n", "hash", "size", "GB/s", "bytes/cycle", "checksum");
+    for (size_t size = 4; size <= max_size; size *= 4) {
+        run("cmagic", cmagic_hash_bytes, buffer + 1, size);
+        run("fnv1a", fnv1a, buffer + 1, size);
+    }
+
+    free(buffer);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "cmagic/hashset.h"
+#include "cmagic/set.h"
+#include "bench.h"
+
+/*
+ * Compares membership tests of 64-bit IDs in the hash set and in the ordered set. For every size,
+ * random IDs are inserted, then every one of them is looked up (positive lookups) followed by the
+ * same number of IDs which are not in the set (negative lookups).
+ */
+
+static uint64_t random_id(void) {
+    return (uint64_t)bench_random() << 32 | bench_random();
+}
+
+static size_t id_hash(const void *key) {
+    return (size_t)*(const uint64_t *)key;
+}
+
+static void fill_ids(uint64_t *present, uint64_t *absent, size_t size) {
+    // Present IDs are odd and absent ones even, so they never collide
+    for (size_t i = 0; i < size; i++) {
+        present[i] = random_id() | 1;
+        absent[i] = random_id() & ~(uint64_t)1;
+    }
+}
+
+static void print_result(const char *set_name, size_t size, double insert_ns, double positive_ns,
+                         double negative_ns, size_t found) {
+    printf("%-14s %10zu %12.1f %12.1f %12.1f %s\n", set_name, size, insert_ns, positive_ns,
+           negative_ns, found == size ? "" : "CHECKSUM MISMATCH");
+}
+
+static void run_hashset(const uint64_t *present, const uint64_t *absent, size_t size) {
+    CMAGIC_HASHSET(uint64_t) hashset =
+        CMAGIC_HASHSET_NEW(uint64_t, id_hash, NULL, &CMAGIC_MEMORY_ALLOC_PACKET_STD);
+    if (!hashset) {
+        fprintf(stderr, "hashset allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        if (!CMAGIC_HASHSET_INSERT(hashset, &present[i]).inserted_or_existing) {
+            fprintf(stderr, "insertion failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    double insert_ns = bench_ns_per_op(start, size);
+
+    size_t found = 0;
+    start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        found += CMAGIC_HASHSET_CONTAINS(hashset, &present[i]);
+    }
+    double positive_ns = bench_ns_per_op(start, size);
+
+    start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        found += CMAGIC_HASHSET_CONTAINS(hashset, &absent[i]);
+    }
+    double negative_ns = bench_ns_per_op(start, size);
+
+    CMAGIC_HASHSET_FREE(hashset);
+    print_result("cmagic_hashset", size, insert_ns, positive_ns, negative_ns, found);
+}
+
+static void run_set(const uint64_t *present, const uint64_t *absent, size_t size) {
+    CMAGIC_SET(uint64_t) set =
+        CMAGIC_SET_NEW(uint64_t, cmagic_utils_compare_uint64, &CMAGIC_MEMORY_ALLOC_PACKET_STD);
+    if (!set) {
+        fprintf(stderr, "set allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        if (!CMAGIC_SET_INSERT(set, &present[i]).inserted_or_existing) {
+            fprintf(stderr, "insertion failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    double insert_ns = bench_ns_per_op(start, size);
+
+    size_t found = 0;
+    start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        found += CMAGIC_SET_FIND(set, &present[i]) != NULL;
+    }
+    double positive_ns = bench_ns_per_op(start, size);
+
+    start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        found += CMAGIC_SET_FIND(set, &absent[i]) != NULL;
+    }
+    double negative_ns = bench_ns_per_op(start, size);
+
+    CMAGIC_SET_FREE(set);
+    print_result("cmagic_set", size, insert_ns, positive_ns, negative_ns, found);
+}
+
+int main(int argc, char *argv[]) {
+    const size_t max_size = bench_parse_max_size(argc, argv, 1000000);
+    uint64_t *present = (uint64_t *)malloc(max_size * sizeof(uint64_t));
+    uint64_t *absent = (uint64_t *)malloc(max_size * sizeof(uint64_t));
+    if (!present || !absent) {
+        fprintf(stderr, "cannot allocate %zu IDs\n", max_size);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-14s %10s %12s %12s %12s\n", "set", "size", "insert ns", "hit ns", "miss ns");
+    for (size_t size = 1000; size <= max_size; size *= 10) {
+        fill_ids(present, absent, size);
+        run_hashset(present, absent, size);
+        run_set(present, absent, size);
+    }
+
+    free(present);
+    free(absent);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include "cmagic/map.hpp"
+#include "bench.h"
+
+/*
+ * Compares the cost of key comparisons in the C++ map wrapper. Integer keys ordered by the default
+ * comparison object are compared inline by the tree, keys ordered by any other comparison object
+ * through a function pointer. std::map is given for reference. For every size, keys are inserted
+ * in random order and then looked up in a different random order.
+ */
+
+namespace {
+
+// Same order as the default one, but not recognized by the wrapper
+struct opaque_less {
+    bool operator()(int lhs, int rhs) const {
+        return lhs < rhs;
+    }
+};
+
+template<typename Map>
+void run(const char *map_name, int *keys, size_t size) {
+    Map map;
+    bench_shuffle(keys, size);
+    double start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        if (!map.insert({ keys[i], keys[i] }).second) {
+            fprintf(stderr, "insertion failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    double insert_ns = bench_ns_per_op(start, size);
+
+    bench_shuffle(keys, size);
+    long long checksum = 0;
+    start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        checksum += map.find(keys[i])->second - keys[i];
+    }
+    double find_ns = bench_ns_per_op(start, size);
+
+    printf("%-14s %10zu %12.1f %12.1f %s\n", map_name, size, insert_ns, find_ns,
+           checksum == 0 ? "" : "CHECKSUM MISMATCH");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const size_t max_size = bench_parse_max_size(argc, argv, 1000000);
+    int *keys = static_cast<int *>(malloc(max_size * sizeof(int)));
+    if (!keys) {
+        fprintf(stderr, "cannot allocate %zu keys\n", max_size);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-14s %10s %12s %12s\n", "map", "size", "insert ns", "find ns");
+    for (size_t size = 1000; size <= max_size; size *= 10) {
+        for (size_t i = 0; i < size; i++) {
+            keys[i] = static_cast<int>(i);
+        }
+        run<cmagic::map<int, int>>("cmagic_inline", keys, size);
+        run<cmagic::map<int, int, opaque_less>>("cmagic_pointer", keys, size);
+        run<std::map<int, int>>("std_map", keys, size);
+    }
+
+    free(keys);
+    return EXIT_SUCCESS;
+}
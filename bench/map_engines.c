@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "cmagic/map.h"
+#include "bench.h"
+
+/*
+ * Compares the AVL tree, the B-tree and the compact tree map engines. For every size, keys are
+ * inserted in random order, then looked up in a different random order and finally the whole map
+ * is iterated.
+ */
+
+static const struct {
+    const char *name;
+    cmagic_map_engine_t engine;
+} ENGINES[] = {
+    { "avl_tree", CMAGIC_MAP_ENGINE_AVL_TREE },
+    { "b_tree", CMAGIC_MAP_ENGINE_B_TREE },
+    { "compact", CMAGIC_MAP_ENGINE_COMPACT_TREE }
+};
+
+static void run(const char *engine_name, cmagic_map_engine_t engine, int *keys, size_t size) {
+    CMAGIC_MAP(int) map = CMAGIC_MAP_NEW_EXT(int, int, bench_int_comparator,
+                                             &CMAGIC_MEMORY_ALLOC_PACKET_STD, engine);
+    if (!map) {
+        fprintf(stderr, "map allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bench_shuffle(keys, size);
+    double start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        if (!CMAGIC_MAP_INSERT(map, &keys[i], &keys[i]).inserted_or_existing) {
+            fprintf(stderr, "insertion failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    double insert_ns = bench_ns_per_op(start, size);
+
+    bench_shuffle(keys, size);
+    long long checksum = 0;
+    start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        checksum += CMAGIC_MAP_GET_VALUE(int, CMAGIC_MAP_FIND(map, &keys[i]));
+    }
+    double find_ns = bench_ns_per_op(start, size);
+
+    start = bench_seconds();
+    for (cmagic_map_iterator_t it = CMAGIC_MAP_FIRST(map); it; it = CMAGIC_MAP_ITERATOR_NEXT(it)) {
+        checksum -= CMAGIC_MAP_GET_VALUE(int, it);
+    }
+    double iterate_ns = bench_ns_per_op(start, size);
+
+    CMAGIC_MAP_FREE(map);
+    printf("%-9s %10zu %12.1f %12.1f %12.1f %s\n", engine_name, size, insert_ns, find_ns,
+           iterate_ns, checksum == 0 ? "" : "CHECKSUM MISMATCH");
+}
+
+int main(int argc, char *argv[]) {
+    const size_t max_size = bench_parse_max_size(argc, argv, 1000000);
+    int *keys = (int *)malloc(max_size * sizeof(int));
+    if (!keys) {
+        fprintf(stderr, "cannot allocate %zu keys\n", max_size);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-9s %10s %12s %12s %12s\n", "engine", "size", "insert ns", "find ns", "iterate ns");
+    for (size_t size = 1000; size <= max_size; size *= 10) {
+        for (size_t i = 0; i < size; i++) {
+            keys[i] = (int)i;
+        }
+        for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(ENGINES); i++) {
+            run(ENGINES[i].name, ENGINES[i].engine, keys, size);
+        }
+    }
+
+    free(keys);
+    return EXIT_SUCCESS;
+}
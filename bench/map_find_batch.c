@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "cmagic/map.h"
+#include "bench.h"
+
+/*
+ * Compares a loop of single lookups against batched lookups in an AVL tree map. Keys are looked
+ * up in random order, so for large maps almost every visited node misses the processor cache.
+ */
+
+#define LOOKUPS_PER_BATCH 256
+
+static void run(int *keys, size_t size) {
+    CMAGIC_MAP(int) map = CMAGIC_MAP_NEW(int, int, bench_int_comparator,
+                                         &CMAGIC_MEMORY_ALLOC_PACKET_STD);
+    if (!map) {
+        fprintf(stderr, "map allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bench_shuffle(keys, size);
+    for (size_t i = 0; i < size; i++) {
+        if (!CMAGIC_MAP_INSERT(map, &keys[i], &keys[i]).inserted_or_existing) {
+            fprintf(stderr, "insertion failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    bench_shuffle(keys, size);
+    long long checksum = 0;
+    double start = bench_seconds();
+    for (size_t i = 0; i < size; i++) {
+        checksum += CMAGIC_MAP_GET_VALUE(int, CMAGIC_MAP_FIND(map, &keys[i]));
+    }
+    double find_ns = bench_ns_per_op(start, size);
+
+    cmagic_map_iterator_t results[LOOKUPS_PER_BATCH];
+    start = bench_seconds();
+    for (size_t i = 0; i < size; i += LOOKUPS_PER_BATCH) {
+        size_t count = CMAGIC_UTILS_MIN((size_t)LOOKUPS_PER_BATCH, size - i);
+        CMAGIC_MAP_FIND_BATCH(map, &keys[i], count, results);
+        for (size_t j = 0; j < count; j++) {
+            checksum -= CMAGIC_MAP_GET_VALUE(int, results[j]);
+        }
+    }
+    double find_batch_ns = bench_ns_per_op(start, size);
+
+    CMAGIC_MAP_FREE(map);
+    printf("%10zu %12.1f %14.1f %8.2fx %s\n", size, find_ns, find_batch_ns,
+           find_ns / find_batch_ns, checksum == 0 ? "" : "CHECKSUM MISMATCH");
+}
+
+int main(int argc, char *argv[]) {
+    const size_t max_size = bench_parse_max_size(argc, argv, 1000000);
+    int *keys = (int *)malloc(max_size * sizeof(int));
+    if (!keys) {
+        fprintf(stderr, "cannot allocate %zu keys\n", max_size);
+        return EXIT_FAILURE;
+    }
+
+    printf("%10s %12s %14s %9s\n", "size", "find ns", "find_batch ns", "speedup");
+    for (size_t size = 1000; size <= max_size; size *= 10) {
+        for (size_t i = 0; i < size; i++) {
+            keys[i] = (int)i;
+        }
+        run(keys, size);
+    }
+
+    free(keys);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include "cmagic/map.hpp"
+#include "bench.h"
+
+/*
+ * Measures iteration over a map with large values. The map iterators give references to the
+ * stored elements, copying every element is shown for comparison, as it was done by the former
+ * iterators. std::map is given for reference.
+ */
+
+namespace {
+
+const size_t VALUE_LENGTH = 256;
+
+template<typename Map>
+double iterate_ns(const Map &map, size_t size, size_t &checksum) {
+    double start = bench_seconds();
+    for (const auto &element : map) {
+        checksum += element.second.size();
+    }
+    return bench_ns_per_op(start, size);
+}
+
+double iterate_copies_ns(const cmagic::map<int, std::string> &map, size_t size,
+                         size_t &checksum) {
+    double start = bench_seconds();
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        const cmagic::map<int, std::string>::value_type element = *it;
+        checksum += element.second.size();
+    }
+    return bench_ns_per_op(start, size);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const size_t max_size = bench_parse_max_size(argc, argv, 100000);
+    const std::string value(VALUE_LENGTH, 'x');
+
+    printf("%10s %14s %14s %14s\n", "size", "reference ns", "copy ns", "std::map ns");
+    for (size_t size = 1000; size <= max_size; size *= 10) {
+        cmagic::map<int, std::string> map;
+        std::map<int, std::string> std_map;
+        for (size_t i = 0; i < size; i++) {
+            const int key = static_cast<int>(bench_random());
+            map.insert({ key, value });
+            std_map.insert({ key, value });
+        }
+
+        size_t checksum = 0;
+        const double reference_ns = iterate_ns(map, map.size(), checksum);
+        const double copy_ns = iterate_copies_ns(map, map.size(), checksum);
+        const double std_map_ns = iterate_ns(std_map, std_map.size(), checksum);
+        printf("%10zu %14.1f %14.1f %14.1f %s\n", map.size(), reference_ns, copy_ns, std_map_ns,
+               checksum == 3 * map.size() * VALUE_LENGTH ? "" : "CHECKSUM MISMATCH");
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "cmagic/set.h"
+#include "bench.h"
+
+/*
+ * Compares the merge-based union and intersection of two sets against the naive approach, which
+ * looks up every element of one set in the other and inserts it into the result one by one. The
+ * first set contains even and the second one multiples of three, so they partially overlap.
+ */
+
+static CMAGIC_SET(int) new_set(cmagic_set_engine_t engine) {
+    CMAGIC_SET(int) result = CMAGIC_SET_NEW_EXT(int, bench_int_comparator,
+                                                &CMAGIC_MEMORY_ALLOC_PACKET_STD, engine);
+    if (!result) {
+        fprintf(stderr, "set allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+static void insert_or_die(CMAGIC_SET(int) int_set, const int *key) {
+    if (!CMAGIC_SET_INSERT(int_set, key).inserted_or_existing) {
+        fprintf(stderr, "insertion failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static CMAGIC_SET(int) naive_union(CMAGIC_SET(int) set1, CMAGIC_SET(int) set2,
+                                   cmagic_set_engine_t engine) {
+    CMAGIC_SET(int) result = new_set(engine);
+    for (cmagic_set_iterator_t it = CMAGIC_SET_FIRST(set1); it; it = CMAGIC_SET_ITERATOR_NEXT(it)) {
+        insert_or_die(result, (const int *)it->key);
+    }
+    for (cmagic_set_iterator_t it = CMAGIC_SET_FIRST(set2); it; it = CMAGIC_SET_ITERATOR_NEXT(it)) {
+        insert_or_die(result, (const int *)it->key);
+    }
+    return result;
+}
+
+static CMAGIC_SET(int) naive_intersection(CMAGIC_SET(int) set1, CMAGIC_SET(int) set2,
+                                          cmagic_set_engine_t engine) {
+    CMAGIC_SET(int) result = new_set(engine);
+    for (cmagic_set_iterator_t it = CMAGIC_SET_FIRST(set1); it; it = CMAGIC_SET_ITERATOR_NEXT(it)) {
+        if (CMAGIC_SET_FIND(set2, (const int *)it->key)) {
+            insert_or_die(result, (const int *)it->key);
+        }
+    }
+    return result;
+}
+
+static double measure(CMAGIC_SET(int) result, double start, size_t operations,
+                      size_t expected_size) {
+    double ns = bench_ns_per_op(start, operations);
+    if (!result || CMAGIC_SET_SIZE(result) != expected_size) {
+        fprintf(stderr, "unexpected result\n");
+        exit(EXIT_FAILURE);
+    }
+    CMAGIC_SET_FREE(result);
+    return ns;
+}
+
+static void run(const char *engine_name, cmagic_set_engine_t engine, size_t size) {
+    CMAGIC_SET(int) even_set = new_set(engine);
+    CMAGIC_SET(int) triple_set = new_set(engine);
+    size_t union_size = 0;
+    size_t intersection_size = 0;
+    for (size_t i = 0; i < size; i++) {
+        int key = (int)i;
+        if (i % 2 == 0) {
+            insert_or_die(even_set, &key);
+        }
+        if (i % 3 == 0) {
+            insert_or_die(triple_set, &key);
+        }
+        union_size += i % 2 == 0 || i % 3 == 0;
+        intersection_size += i % 6 == 0;
+    }
+    const size_t operations = CMAGIC_SET_SIZE(even_set) + CMAGIC_SET_SIZE(triple_set);
+
+    double start = bench_seconds();
+    double naive_union_ns = measure(naive_union(even_set, triple_set, engine), start, operations,
+                                    union_size);
+    start = bench_seconds();
+    double union_ns = measure(CMAGIC_SET_UNION(int, even_set, triple_set), start, operations,
+                              union_size);
+    start = bench_seconds();
+    double naive_intersection_ns = measure(naive_intersection(even_set, triple_set, engine),
+                                           start, operations, intersection_size);
+    start = bench_seconds();
+    double intersection_ns = measure(CMAGIC_SET_INTERSECTION(int, even_set, triple_set), start,
+                                     operations, intersection_size);
+
+    CMAGIC_SET_FREE(even_set);
+    CMAGIC_SET_FREE(triple_set);
+    printf("%-9s %10zu %14.1f %14.1f %14.1f %14.1f\n", engine_name, size, naive_union_ns, union_ns,
+           naive_intersection_ns, intersection_ns);
+}
+
+int main(int argc, char *argv[]) {
+    const size_t max_size = bench_parse_max_size(argc, argv, 1000000);
+
+    printf("%-9s %10s %14s %14s %14s %14s\n", "engine", "size", "naive union", "union",
+           "naive inter", "intersection");
+    for (size_t size = 1000; size <= max_size; size *= 10) {
+        run("avl_tree", CMAGIC_SET_ENGINE_AVL_TREE, size);
+        run("b_tree", CMAGIC_SET_ENGINE_B_TREE, size);
+    }
+
+    return EXIT_SUCCESS;
+}
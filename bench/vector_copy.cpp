@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "cmagic/vector.hpp"
+#include "bench.h"
+
+/*
+ * Measures the copy throughput of the C++ vector wrapper. For every size, a vector is copy
+ * constructed and copy assigned to a vector holding a few elements, repeatedly, so that every size
+ * copies about the same number of elements in total. Integers are trivially copyable, the wrapped
+ * integer has a user-provided copy constructor, so it's copied element by element. std::vector is
+ * given for reference.
+ */
+
+namespace {
+
+struct wrapped_int {
+    int val;
+
+    explicit wrapped_int(int val_) : val(val_) {}
+
+    wrapped_int(const wrapped_int &x) : val(x.val) {}
+
+    wrapped_int &operator=(const wrapped_int &x) {
+        val = x.val;
+        return *this;
+    }
+};
+
+const size_t TOTAL_COPIED_ELEMENTS = 100000000;
+
+int value_of(int val) {
+    return val;
+}
+
+int value_of(const wrapped_int &val) {
+    return val.val;
+}
+
+template<typename Vector>
+void run(const char *vector_name, size_t size) {
+    Vector source;
+    for (size_t i = 0; i < size; i++) {
+        source.push_back(typename Vector::value_type(static_cast<int>(i)));
+    }
+    const size_t repetitions = TOTAL_COPIED_ELEMENTS / size;
+    long long checksum = 0;
+
+    double start = bench_seconds();
+    for (size_t i = 0; i < repetitions; i++) {
+        Vector copy {source};
+        checksum += value_of(copy[i % size]) - value_of(source[i % size]);
+    }
+    double construct_ns = bench_ns_per_op(start, repetitions * size);
+
+    start = bench_seconds();
+    for (size_t i = 0; i < repetitions; i++) {
+        Vector copy;
+        copy.push_back(typename Vector::value_type(-1));
+        copy = source;
+        checksum += value_of(copy[i % size]) - value_of(source[i % size]);
+    }
+    double assign_ns = bench_ns_per_op(start, repetitions * size);
+
+    printf("%-18s %10zu %14.3f %14.3f %s\n", vector_name, size, construct_ns, assign_ns,
+           checksum == 0 ? "" : "CHECKSUM MISMATCH");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const size_t max_size = bench_parse_max_size(argc, argv, 10000000);
+
+    printf("%-18s %10s %14s %14s\n", "vector", "size", "construct ns", "assign ns");
+    for (size_t size = 1000; size <= max_size; size *= 10) {
+        run<cmagic::vector<int>>("cmagic int", size);
+        run<std::vector<int>>("std int", size);
+        run<cmagic::vector<wrapped_int>>("cmagic wrapped_int", size);
+        run<std::vector<wrapped_int>>("std wrapped_int", size);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,485 @@
+/**
+ * @file    flat_map.h
+ * @brief   Implementation of a @b flat_map container.
+ * @details The flat map keeps its elements sorted like @ref map.h, but in two contiguous arrays
+ *          built on @ref vector.h, one of the keys and one of the values. It takes no memory per
+ *          element besides the key and the value, and a lookup is a binary search over the key
+ *          array. Inserting or erasing an element moves all elements after it, so the container
+ *          suits tables which are filled once, e.g. with @ref CMAGIC_FLAT_MAP_BUILD_SORTED or by a
+ *          batch of insertions, and then mostly searched. Please <b>use provided macros</b> instead
+ *          of raw functions to gain additional type checks.
+ */
+
+#ifndef CMAGIC_FLAT_MAP_H
+#define CMAGIC_FLAT_MAP_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmagic/memory.h"
+#include "cmagic/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Pointer to a function that compares two keys
+ * @details Same as @ref cmagic_map_key_comparator_t, so the built-in comparators from
+ *          @ref utils.h can be used.
+ * @param   key1 pointer to the first key value
+ * @param   key2 pointer to the second key value
+ * @return  negative value if @p key1 goes before @p key2, 0 if they are equivalent, positive value
+ *          otherwise
+ */
+typedef int (*cmagic_flat_map_key_comparator_t)(const void *key1, const void *key2);
+
+/**
+ * @brief   User defined additional tasks to be executed right before flat map element deletion
+ * @warning Do not call @c free function on the @c key or @c value. They are stored inside the flat
+ *          map.
+ * @param   key pointer to key to be deleted
+ * @param   value pointer to the value to be deleted
+ */
+typedef void (*cmagic_flat_map_erase_destructor_t)(void *key, void *value);
+
+/**
+ * @brief   User defined initialization of an element copied into another flat map
+ * @param   destination_key pointer to uninitialized memory of the new key
+ * @param   destination_value pointer to uninitialized memory of the new value
+ * @param   source_key pointer to the key to be copied
+ * @param   source_value pointer to the value to be copied
+ */
+typedef void (*cmagic_flat_map_copy_function_t)(void *destination_key, void *destination_value,
+                                                const void *source_key, const void *source_value);
+
+/**
+ * @brief   Flat map iterator
+ * @details Iterators are passed by value. An iterator with @c NULL @c key points past the last
+ *          element. Elements are moved byte by byte, so inserting or erasing an element
+ *          invalidates all iterators.
+ */
+typedef struct {
+    const void *key;
+    void *value;
+} cmagic_flat_map_iterator_t;
+
+/**
+ * @brief   Flat map insertion result
+ */
+typedef struct {
+
+    /**
+     * @brief   iterator pointing to a new or already existing element, its @c key is @c NULL if
+     *          the allocation has failed
+     */
+    cmagic_flat_map_iterator_t inserted_or_existing;
+
+    /**
+     * @brief   @c true if the element already exists in the flat map and the flat map was not
+     *          modified, @c false if a new element has been allocated
+     */
+    bool already_exists;
+
+} cmagic_flat_map_insert_result_t;
+
+void *
+cmagic_flat_map_new(size_t key_size, size_t value_size,
+                    cmagic_flat_map_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet);
+
+void
+cmagic_flat_map_free(void *flat_map_ptr);
+
+void *
+cmagic_flat_map_copy(void *flat_map_ptr, cmagic_flat_map_copy_function_t copy);
+
+bool
+cmagic_flat_map_build_sorted(void *flat_map_ptr, const void *keys, const void *values,
+                             size_t count);
+
+cmagic_flat_map_insert_result_t
+cmagic_flat_map_allocate(void *flat_map_ptr, const void *key);
+
+cmagic_flat_map_insert_result_t
+cmagic_flat_map_insert(void *flat_map_ptr, const void *key, const void *value);
+
+bool
+cmagic_flat_map_batch_insert(void *flat_map_ptr, const void *key, const void *value);
+
+bool
+cmagic_flat_map_batch_commit(void *flat_map_ptr, cmagic_flat_map_erase_destructor_t destructor);
+
+size_t
+cmagic_flat_map_batch_size(void *flat_map_ptr);
+
+void
+cmagic_flat_map_erase(void *flat_map_ptr, const void *key,
+                      cmagic_flat_map_erase_destructor_t destructor);
+
+void
+cmagic_flat_map_erase_iterator(void *flat_map_ptr, cmagic_flat_map_iterator_t iterator,
+                               cmagic_flat_map_erase_destructor_t destructor);
+
+void
+cmagic_flat_map_clear_ext(void *flat_map_ptr, cmagic_flat_map_erase_destructor_t destructor);
+
+void
+cmagic_flat_map_clear(void *flat_map_ptr);
+
+size_t
+cmagic_flat_map_size(void *flat_map_ptr);
+
+const void *
+cmagic_flat_map_keys(void *flat_map_ptr);
+
+void *
+cmagic_flat_map_values(void *flat_map_ptr);
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_first(void *flat_map_ptr);
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_last(void *flat_map_ptr);
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_iterator_next(void *flat_map_ptr, cmagic_flat_map_iterator_t iterator);
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_iterator_prev(void *flat_map_ptr, cmagic_flat_map_iterator_t iterator);
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_find(void *flat_map_ptr, const void *key);
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_lower_bound(void *flat_map_ptr, const void *key);
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_upper_bound(void *flat_map_ptr, const void *key);
+
+const cmagic_memory_alloc_packet_t *
+cmagic_flat_map_get_alloc_packet(void *flat_map_ptr);
+
+/**
+ * @brief   Convenient alias for @c type*. Returned type of @ref CMAGIC_FLAT_MAP_NEW.
+ * @param   type type of flat map keys
+ */
+#define CMAGIC_FLAT_MAP(key_type) key_type*
+
+/**
+ * @brief   Allocates and returns an address of a newly created empty flat map.
+ * @param   key_type type of flat map keys
+ * @param   value_type type of flat map values
+ * @param   key_comparator function of type @ref cmagic_flat_map_key_comparator_t determining the
+ *          order of the elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @return  a new empty flat map or @c NULL if the allocation has failed
+ */
+#define CMAGIC_FLAT_MAP_NEW(key_type, value_type, key_comparator, alloc_packet) \
+    ((CMAGIC_FLAT_MAP(key_type))cmagic_flat_map_new(sizeof(key_type), sizeof(value_type), \
+    (key_comparator), (alloc_packet)))
+
+/**
+ * @brief   Frees the resources allocated by the flat map before.
+ * @details Must not use @p cmagic_flat_map after free. Pending elements of an uncommitted batch
+ *          are released too.
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ */
+#define CMAGIC_FLAT_MAP_FREE(cmagic_flat_map) cmagic_flat_map_free((void*)(cmagic_flat_map))
+
+/**
+ * @brief   Allocates and returns a copy of the flat map
+ * @details Both arrays are copied as a whole, so no key is compared. Elements are copied byte by
+ *          byte.
+ * @warning The flat map must have no pending batch.
+ * @param   key_type type of flat map keys
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @return  a new flat map or @c NULL if the allocation has failed
+ */
+#define CMAGIC_FLAT_MAP_COPY(key_type, cmagic_flat_map) \
+    CMAGIC_FLAT_MAP_COPY_EXT(key_type, cmagic_flat_map, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_FLAT_MAP_COPY but initializes the copied elements with a user
+ *          defined function
+ * @param   key_type type of flat map keys
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   copy function of type @ref cmagic_flat_map_copy_function_t to be called on every new
+ *          element
+ * @return  a new flat map or @c NULL if the allocation has failed
+ */
+#define CMAGIC_FLAT_MAP_COPY_EXT(key_type, cmagic_flat_map, copy) \
+    ((CMAGIC_FLAT_MAP(key_type))cmagic_flat_map_copy((void*)(cmagic_flat_map), (copy)))
+
+/**
+ * @brief   Fills an empty flat map with elements which are already sorted
+ * @details Keys and values are copied byte by byte in linear time, without any comparison.
+ * @warning The flat map must be empty and have no pending batch. @p keys must be in strictly
+ *          ascending order, which is checked only by debug builds.
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   keys pointer to an array of @p count keys
+ * @param   values pointer to an array of @p count values, the value of every key has its index
+ * @param   count number of elements
+ * @return  @c true on success, @c false if the allocation has failed, in which case the flat map is
+ *          left empty
+ */
+#define CMAGIC_FLAT_MAP_BUILD_SORTED(cmagic_flat_map, keys, values, count) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_map), *(keys)), \
+    cmagic_flat_map_build_sorted((void*)(cmagic_flat_map), (keys), (values), (count)))
+
+/**
+ * @brief   Allocates space for a new element but does not initialize it.
+ * @details The key is initialized with @p key, the value is left uninitialized. New element is
+ *          allocated only if @p key doesn't already exist in the flat map, all elements after it
+ *          are moved then.
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   key pointer to the key value
+ * @return  @ref cmagic_flat_map_insert_result_t pointing to the new or already existing element
+ */
+#define CMAGIC_FLAT_MAP_ALLOCATE(cmagic_flat_map, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_map), *(key)), \
+    cmagic_flat_map_allocate((void*)(cmagic_flat_map), (key)))
+
+/**
+ * @brief   Allocates a new element and initializes it with data under @p key and @p value
+ * @details New element is created only if @p key doesn't already exist in the flat map.
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   key pointer to the key value
+ * @param   value pointer to the value value
+ * @return  @ref cmagic_flat_map_insert_result_t pointing to the new or already existing element
+ */
+#define CMAGIC_FLAT_MAP_INSERT(cmagic_flat_map, key, value) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_map), *(key)), \
+    cmagic_flat_map_insert((void*)(cmagic_flat_map), (key), (value)))
+
+/**
+ * @brief   Adds an element to the pending batch without moving any element of the flat map
+ * @details The element is copied byte by byte at the end of the batch in constant amortized time.
+ *          Pending elements are not visible to lookups or iteration until
+ *          @ref CMAGIC_FLAT_MAP_BATCH_COMMIT merges them into the flat map.
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   key pointer to the key value
+ * @param   value pointer to the value value
+ * @return  @c true on success, @c false if the allocation has failed
+ */
+#define CMAGIC_FLAT_MAP_BATCH_INSERT(cmagic_flat_map, key, value) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_map), *(key)), \
+    cmagic_flat_map_batch_insert((void*)(cmagic_flat_map), (key), (value)))
+
+/**
+ * @brief   Extended version of @ref CMAGIC_FLAT_MAP_BATCH_COMMIT
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   destructor function of type @ref cmagic_flat_map_erase_destructor_t to be called on
+ *          every pending element which is dropped as a duplicate
+ * @return  @c true on success, @c false if the allocation has failed
+ */
+#define CMAGIC_FLAT_MAP_BATCH_COMMIT_EXT(cmagic_flat_map, destructor) \
+    cmagic_flat_map_batch_commit((void*)(cmagic_flat_map), (destructor))
+
+/**
+ * @brief   Merges the pending batch into the flat map
+ * @details The batch is sorted and merged with the elements of the flat map, so committing @c p
+ *          elements into a flat map of @c n elements takes O(n + p log p) time instead of O(n * p)
+ *          of separate insertions. Same as with @ref CMAGIC_FLAT_MAP_INSERT, an element whose key
+ *          already exists in the flat map or earlier in the batch is dropped. If the allocation
+ *          fails, both the flat map and the batch are unchanged, so the commit may be retried.
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @return  @c true on success, @c false if the allocation has failed
+ */
+#define CMAGIC_FLAT_MAP_BATCH_COMMIT(cmagic_flat_map) \
+    CMAGIC_FLAT_MAP_BATCH_COMMIT_EXT(cmagic_flat_map, NULL)
+
+/**
+ * @brief   Returns the number of pending elements which are not committed yet
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @return  number of elements of the pending batch
+ */
+#define CMAGIC_FLAT_MAP_BATCH_SIZE(cmagic_flat_map) \
+    cmagic_flat_map_batch_size((void*)(cmagic_flat_map))
+
+/**
+ * @brief   Extended version of @ref CMAGIC_FLAT_MAP_ERASE
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   key pointer to a key of the element to be removed
+ * @param   destructor function of type @ref cmagic_flat_map_erase_destructor_t to be called on the
+ *          key and value right before deleting them
+ */
+#define CMAGIC_FLAT_MAP_ERASE_EXT(cmagic_flat_map, key, destructor) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_map), *(key)), \
+    cmagic_flat_map_erase((void*)(cmagic_flat_map), (key), (destructor)))
+
+/**
+ * @brief   Removes a single element from the flat map
+ * @details All elements after it are moved. Function does nothing if the key doesn't exist.
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   key pointer to a key of the element to be removed
+ */
+#define CMAGIC_FLAT_MAP_ERASE(cmagic_flat_map, key) \
+    CMAGIC_FLAT_MAP_ERASE_EXT(cmagic_flat_map, key, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_FLAT_MAP_ERASE_ITERATOR
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   iterator @ref cmagic_flat_map_iterator_t pointing to the element to be removed
+ * @param   destructor function of type @ref cmagic_flat_map_erase_destructor_t to be called on the
+ *          key and value right before deleting them
+ */
+#define CMAGIC_FLAT_MAP_ERASE_ITERATOR_EXT(cmagic_flat_map, iterator, destructor) \
+    cmagic_flat_map_erase_iterator((void*)(cmagic_flat_map), (iterator), (destructor))
+
+/**
+ * @brief   Removes the element pointed to by @p iterator without looking up its key
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   iterator @ref cmagic_flat_map_iterator_t pointing to the element to be removed
+ */
+#define CMAGIC_FLAT_MAP_ERASE_ITERATOR(cmagic_flat_map, iterator) \
+    CMAGIC_FLAT_MAP_ERASE_ITERATOR_EXT(cmagic_flat_map, iterator, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_FLAT_MAP_CLEAR
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   destructor function of type @ref cmagic_flat_map_erase_destructor_t to be called on
+ *          every element, including the pending ones, right before deleting it
+ */
+#define CMAGIC_FLAT_MAP_CLEAR_EXT(cmagic_flat_map, destructor) \
+    cmagic_flat_map_clear_ext((void*)(cmagic_flat_map), (destructor))
+
+/**
+ * @brief   Removes all elements from the flat map and discards the pending batch
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ */
+#define CMAGIC_FLAT_MAP_CLEAR(cmagic_flat_map) cmagic_flat_map_clear((void*)(cmagic_flat_map))
+
+/**
+ * @brief   Returns the number of elements in the flat map
+ * @details Pending elements of the batch are not counted.
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @return  number of elements in the flat map
+ */
+#define CMAGIC_FLAT_MAP_SIZE(cmagic_flat_map) cmagic_flat_map_size((void*)(cmagic_flat_map))
+
+/**
+ * @brief   Returns the array of all keys in ascending order
+ * @details The array has @ref CMAGIC_FLAT_MAP_SIZE keys and it's valid until the flat map is
+ *          modified.
+ * @param   key_type type of flat map keys
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @return  pointer to the first key
+ */
+#define CMAGIC_FLAT_MAP_KEYS(key_type, cmagic_flat_map) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_map), *(key_type*)NULL), \
+    (const key_type*)cmagic_flat_map_keys((void*)(cmagic_flat_map)))
+
+/**
+ * @brief   Returns the array of all values in the order of their keys
+ * @details The array has @ref CMAGIC_FLAT_MAP_SIZE values and it's valid until the flat map is
+ *          modified.
+ * @param   value_type type of flat map values
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @return  pointer to the value of the first key
+ */
+#define CMAGIC_FLAT_MAP_VALUES(value_type, cmagic_flat_map) \
+    ((value_type*)cmagic_flat_map_values((void*)(cmagic_flat_map)))
+
+/**
+ * @brief   Return iterator to the first element in the flat map
+ * @details It's the element with the lowest key, as defined by
+ *          @ref cmagic_flat_map_key_comparator_t.
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @return  an iterator to the first element, its @c key is @c NULL if the flat map is empty
+ */
+#define CMAGIC_FLAT_MAP_FIRST(cmagic_flat_map) cmagic_flat_map_first((void*)(cmagic_flat_map))
+
+/**
+ * @brief   Return iterator to the last element in the flat map
+ * @details It's the element with the greatest key, as defined by
+ *          @ref cmagic_flat_map_key_comparator_t.
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @return  an iterator to the last element, its @c key is @c NULL if the flat map is empty
+ */
+#define CMAGIC_FLAT_MAP_LAST(cmagic_flat_map) cmagic_flat_map_last((void*)(cmagic_flat_map))
+
+/**
+ * @brief   Return iterator to the next element
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   iterator @ref cmagic_flat_map_iterator_t pointing to an element of the flat map
+ * @return  an iterator to the next element, its @c key is @c NULL if @p iterator points to the
+ *          last one
+ */
+#define CMAGIC_FLAT_MAP_ITERATOR_NEXT(cmagic_flat_map, iterator) \
+    cmagic_flat_map_iterator_next((void*)(cmagic_flat_map), (iterator))
+
+/**
+ * @brief   Return iterator to the previous element
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   iterator @ref cmagic_flat_map_iterator_t pointing to an element of the flat map
+ * @return  an iterator to the previous element, its @c key is @c NULL if @p iterator points to
+ *          the first one
+ */
+#define CMAGIC_FLAT_MAP_ITERATOR_PREV(cmagic_flat_map, iterator) \
+    cmagic_flat_map_iterator_prev((void*)(cmagic_flat_map), (iterator))
+
+/**
+ * @brief   Searches the container for an element with a key equal to @p key
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   key pointer to a key to be searched for
+ * @return  an iterator to the element, its @c key is @c NULL if @p key is not found
+ */
+#define CMAGIC_FLAT_MAP_FIND(cmagic_flat_map, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_map), *(key)), \
+    cmagic_flat_map_find((void*)(cmagic_flat_map), (key)))
+
+/**
+ * @brief   Returns an iterator pointing to the first element that is not less than @p key
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  an iterator to the element, its @c key is @c NULL if all keys are less than @p key
+ */
+#define CMAGIC_FLAT_MAP_LOWER_BOUND(cmagic_flat_map, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_map), *(key)), \
+    cmagic_flat_map_lower_bound((void*)(cmagic_flat_map), (key)))
+
+/**
+ * @brief   Returns an iterator pointing to the first element that is greater than @p key
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  an iterator to the element, its @c key is @c NULL if no key is greater than @p key
+ */
+#define CMAGIC_FLAT_MAP_UPPER_BOUND(cmagic_flat_map, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_map), *(key)), \
+    cmagic_flat_map_upper_bound((void*)(cmagic_flat_map), (key)))
+
+/**
+ * @brief   Helper macro for retrieving the key from the iterator
+ * @warning @p iterator must point to an element
+ * @param   key_type type of the keys of the flat map which the iterator is associated with
+ * @param   iterator @ref cmagic_flat_map_iterator_t object
+ * @return  flat map key
+ */
+#define CMAGIC_FLAT_MAP_GET_KEY(key_type, iterator) \
+    (assert((iterator).key), *((const key_type*)(iterator).key))
+
+/**
+ * @brief   Helper macro for retrieving the value from the iterator
+ * @warning @p iterator must point to an element
+ * @param   value_type type of the values of the flat map which the iterator is associated with
+ * @param   iterator @ref cmagic_flat_map_iterator_t object
+ * @return  flat map value
+ */
+#define CMAGIC_FLAT_MAP_GET_VALUE(value_type, iterator) \
+    (assert((iterator).value), *((value_type*)(iterator).value))
+
+/**
+ * @brief   Retrieves @ref cmagic_memory_alloc_packet_t associated with the flat map
+ * @param   cmagic_flat_map a flat map allocated before with @ref CMAGIC_FLAT_MAP_NEW
+ * @return  @ref cmagic_memory_alloc_packet_t associated with the flat map
+ */
+#define CMAGIC_FLAT_MAP_GET_ALLOC_PACKET(cmagic_flat_map) \
+    cmagic_flat_map_get_alloc_packet((void*)(cmagic_flat_map))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_FLAT_MAP_H */
@@ -0,0 +1,439 @@
+/**
+ * @file    flat_set.h
+ * @brief   Implementation of a @b flat_set container.
+ * @details The flat set keeps its keys sorted like @ref set.h, but in a single contiguous array
+ *          built on @ref vector.h. It takes no memory per key besides the key itself, and a lookup
+ *          is a binary search over the array. Inserting or erasing a key moves all keys after it,
+ *          so the container suits sets which are filled once, e.g. with
+ *          @ref CMAGIC_FLAT_SET_BUILD_SORTED or by a batch of insertions, and then mostly searched.
+ *          Please <b>use provided macros</b> instead of raw functions to gain additional type
+ *          checks.
+ */
+
+#ifndef CMAGIC_FLAT_SET_H
+#define CMAGIC_FLAT_SET_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmagic/memory.h"
+#include "cmagic/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Pointer to a function that compares two keys
+ * @details Same as @ref cmagic_set_key_comparator_t, so the built-in comparators from
+ *          @ref utils.h can be used.
+ * @param   key1 pointer to the first key value
+ * @param   key2 pointer to the second key value
+ * @return  negative value if @p key1 goes before @p key2, 0 if they are equivalent, positive value
+ *          otherwise
+ */
+typedef int (*cmagic_flat_set_key_comparator_t)(const void *key1, const void *key2);
+
+/**
+ * @brief   User defined additional tasks to be executed right before key deletion
+ * @warning Do not call @c free function on the @c key. It's stored inside the flat set.
+ * @param   key pointer to key to be deleted
+ */
+typedef void (*cmagic_flat_set_erase_destructor_t)(void *key);
+
+/**
+ * @brief   User defined initialization of a key copied into another flat set
+ * @param   destination pointer to uninitialized memory of the new key
+ * @param   source pointer to the key to be copied
+ */
+typedef void (*cmagic_flat_set_copy_function_t)(void *destination, const void *source);
+
+/**
+ * @brief   Flat set iterator, which points directly to the key
+ * @details @c NULL iterator points past the last key. Keys are moved byte by byte, so inserting
+ *          or erasing a key invalidates all iterators.
+ */
+typedef const void *cmagic_flat_set_iterator_t;
+
+/**
+ * @brief   Flat set insertion result
+ */
+typedef struct {
+
+    /**
+     * @brief   iterator pointing to a new or already existing key or @c NULL if the allocation has
+     *          failed
+     */
+    cmagic_flat_set_iterator_t inserted_or_existing;
+
+    /**
+     * @brief   @c true if the key already exists in the flat set and the flat set was not
+     *          modified, @c false if a new key has been allocated
+     */
+    bool already_exists;
+
+} cmagic_flat_set_insert_result_t;
+
+void *
+cmagic_flat_set_new(size_t key_size, cmagic_flat_set_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet);
+
+void
+cmagic_flat_set_free(void *flat_set_ptr);
+
+void *
+cmagic_flat_set_copy(void *flat_set_ptr, cmagic_flat_set_copy_function_t copy);
+
+bool
+cmagic_flat_set_build_sorted(void *flat_set_ptr, const void *keys, size_t count);
+
+cmagic_flat_set_insert_result_t
+cmagic_flat_set_insert(void *flat_set_ptr, const void *key);
+
+bool
+cmagic_flat_set_batch_insert(void *flat_set_ptr, const void *key);
+
+bool
+cmagic_flat_set_batch_commit(void *flat_set_ptr, cmagic_flat_set_erase_destructor_t destructor);
+
+size_t
+cmagic_flat_set_batch_size(void *flat_set_ptr);
+
+void
+cmagic_flat_set_erase(void *flat_set_ptr, const void *key,
+                      cmagic_flat_set_erase_destructor_t destructor);
+
+void
+cmagic_flat_set_erase_iterator(void *flat_set_ptr, cmagic_flat_set_iterator_t iterator,
+                               cmagic_flat_set_erase_destructor_t destructor);
+
+void
+cmagic_flat_set_clear_ext(void *flat_set_ptr, cmagic_flat_set_erase_destructor_t destructor);
+
+void
+cmagic_flat_set_clear(void *flat_set_ptr);
+
+size_t
+cmagic_flat_set_size(void *flat_set_ptr);
+
+const void *
+cmagic_flat_set_keys(void *flat_set_ptr);
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_first(void *flat_set_ptr);
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_last(void *flat_set_ptr);
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_iterator_next(void *flat_set_ptr, cmagic_flat_set_iterator_t iterator);
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_iterator_prev(void *flat_set_ptr, cmagic_flat_set_iterator_t iterator);
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_find(void *flat_set_ptr, const void *key);
+
+bool
+cmagic_flat_set_contains(void *flat_set_ptr, const void *key);
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_lower_bound(void *flat_set_ptr, const void *key);
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_upper_bound(void *flat_set_ptr, const void *key);
+
+const cmagic_memory_alloc_packet_t *
+cmagic_flat_set_get_alloc_packet(void *flat_set_ptr);
+
+/**
+ * @brief   Convenient alias for @c type*. Returned type of @ref CMAGIC_FLAT_SET_NEW.
+ * @param   type type of flat set keys
+ */
+#define CMAGIC_FLAT_SET(key_type) key_type*
+
+/**
+ * @brief   Allocates and returns an address of a newly created empty flat set.
+ * @param   key_type type of flat set keys
+ * @param   key_comparator function of type @ref cmagic_flat_set_key_comparator_t determining the
+ *          order of the keys
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @return  a new empty flat set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_FLAT_SET_NEW(key_type, key_comparator, alloc_packet) \
+    ((CMAGIC_FLAT_SET(key_type))cmagic_flat_set_new(sizeof(key_type), (key_comparator), \
+    (alloc_packet)))
+
+/**
+ * @brief   Frees the resources allocated by the flat set before.
+ * @details Must not use @p cmagic_flat_set after free. Pending keys of an uncommitted batch are
+ *          released too.
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ */
+#define CMAGIC_FLAT_SET_FREE(cmagic_flat_set) cmagic_flat_set_free((void*)(cmagic_flat_set))
+
+/**
+ * @brief   Allocates and returns a copy of the flat set
+ * @details The key array is copied as a whole, so no key is compared. Keys are copied byte by
+ *          byte.
+ * @warning The flat set must have no pending batch.
+ * @param   key_type type of flat set keys
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @return  a new flat set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_FLAT_SET_COPY(key_type, cmagic_flat_set) \
+    CMAGIC_FLAT_SET_COPY_EXT(key_type, cmagic_flat_set, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_FLAT_SET_COPY but initializes the copied keys with a user defined
+ *          function
+ * @param   key_type type of flat set keys
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   copy function of type @ref cmagic_flat_set_copy_function_t to be called on every new
+ *          key
+ * @return  a new flat set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_FLAT_SET_COPY_EXT(key_type, cmagic_flat_set, copy) \
+    ((CMAGIC_FLAT_SET(key_type))cmagic_flat_set_copy((void*)(cmagic_flat_set), (copy)))
+
+/**
+ * @brief   Fills an empty flat set with keys which are already sorted
+ * @details Keys are copied byte by byte in linear time, without any comparison.
+ * @warning The flat set must be empty and have no pending batch. @p keys must be in strictly
+ *          ascending order, which is checked only by debug builds.
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   keys pointer to an array of @p count keys
+ * @param   count number of keys
+ * @return  @c true on success, @c false if the allocation has failed, in which case the flat set is
+ *          left empty
+ */
+#define CMAGIC_FLAT_SET_BUILD_SORTED(cmagic_flat_set, keys, count) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_set), *(keys)), \
+    cmagic_flat_set_build_sorted((void*)(cmagic_flat_set), (keys), (count)))
+
+/**
+ * @brief   Allocates a new key and initializes it with data under @p key
+ * @details New key is created only if @p key doesn't already exist in the flat set, all keys
+ *          after it are moved then.
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   key pointer to the key value
+ * @return  @ref cmagic_flat_set_insert_result_t pointing to the new or already existing key
+ */
+#define CMAGIC_FLAT_SET_INSERT(cmagic_flat_set, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_set), *(key)), \
+    cmagic_flat_set_insert((void*)(cmagic_flat_set), (key)))
+
+/**
+ * @brief   Adds a key to the pending batch without moving any key of the flat set
+ * @details The key is copied byte by byte at the end of the batch in constant amortized time.
+ *          Pending keys are not visible to lookups or iteration until
+ *          @ref CMAGIC_FLAT_SET_BATCH_COMMIT merges them into the flat set.
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   key pointer to the key value
+ * @return  @c true on success, @c false if the allocation has failed
+ */
+#define CMAGIC_FLAT_SET_BATCH_INSERT(cmagic_flat_set, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_set), *(key)), \
+    cmagic_flat_set_batch_insert((void*)(cmagic_flat_set), (key)))
+
+/**
+ * @brief   Extended version of @ref CMAGIC_FLAT_SET_BATCH_COMMIT
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   destructor function of type @ref cmagic_flat_set_erase_destructor_t to be called on
+ *          every pending key which is dropped as a duplicate
+ * @return  @c true on success, @c false if the allocation has failed
+ */
+#define CMAGIC_FLAT_SET_BATCH_COMMIT_EXT(cmagic_flat_set, destructor) \
+    cmagic_flat_set_batch_commit((void*)(cmagic_flat_set), (destructor))
+
+/**
+ * @brief   Merges the pending batch into the flat set
+ * @details The batch is sorted and merged with the keys of the flat set, so committing @c p keys
+ *          into a flat set of @c n keys takes O(n + p log p) time instead of O(n * p) of separate
+ *          insertions. A key which already exists in the flat set or earlier in the batch is
+ *          dropped. If the allocation fails, both the flat set and the batch are unchanged, so the
+ *          commit may be retried.
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @return  @c true on success, @c false if the allocation has failed
+ */
+#define CMAGIC_FLAT_SET_BATCH_COMMIT(cmagic_flat_set) \
+    CMAGIC_FLAT_SET_BATCH_COMMIT_EXT(cmagic_flat_set, NULL)
+
+/**
+ * @brief   Returns the number of pending keys which are not committed yet
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @return  number of keys of the pending batch
+ */
+#define CMAGIC_FLAT_SET_BATCH_SIZE(cmagic_flat_set) \
+    cmagic_flat_set_batch_size((void*)(cmagic_flat_set))
+
+/**
+ * @brief   Extended version of @ref CMAGIC_FLAT_SET_ERASE
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   key pointer to the key to be removed
+ * @param   destructor function of type @ref cmagic_flat_set_erase_destructor_t to be called on the
+ *          key right before deleting it
+ */
+#define CMAGIC_FLAT_SET_ERASE_EXT(cmagic_flat_set, key, destructor) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_set), *(key)), \
+    cmagic_flat_set_erase((void*)(cmagic_flat_set), (key), (destructor)))
+
+/**
+ * @brief   Removes a single key from the flat set
+ * @details All keys after it are moved. Function does nothing if the key doesn't exist.
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   key pointer to the key to be removed
+ */
+#define CMAGIC_FLAT_SET_ERASE(cmagic_flat_set, key) \
+    CMAGIC_FLAT_SET_ERASE_EXT(cmagic_flat_set, key, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_FLAT_SET_ERASE_ITERATOR
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   iterator @ref cmagic_flat_set_iterator_t pointing to the key to be removed
+ * @param   destructor function of type @ref cmagic_flat_set_erase_destructor_t to be called on the
+ *          key right before deleting it
+ */
+#define CMAGIC_FLAT_SET_ERASE_ITERATOR_EXT(cmagic_flat_set, iterator, destructor) \
+    cmagic_flat_set_erase_iterator((void*)(cmagic_flat_set), (iterator), (destructor))
+
+/**
+ * @brief   Removes the key pointed to by @p iterator without looking it up
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   iterator @ref cmagic_flat_set_iterator_t pointing to the key to be removed
+ */
+#define CMAGIC_FLAT_SET_ERASE_ITERATOR(cmagic_flat_set, iterator) \
+    CMAGIC_FLAT_SET_ERASE_ITERATOR_EXT(cmagic_flat_set, iterator, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_FLAT_SET_CLEAR
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   destructor function of type @ref cmagic_flat_set_erase_destructor_t to be called on
+ *          every key, including the pending ones, right before deleting it
+ */
+#define CMAGIC_FLAT_SET_CLEAR_EXT(cmagic_flat_set, destructor) \
+    cmagic_flat_set_clear_ext((void*)(cmagic_flat_set), (destructor))
+
+/**
+ * @brief   Removes all keys from the flat set and discards the pending batch
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ */
+#define CMAGIC_FLAT_SET_CLEAR(cmagic_flat_set) cmagic_flat_set_clear((void*)(cmagic_flat_set))
+
+/**
+ * @brief   Returns the number of keys in the flat set
+ * @details Pending keys of the batch are not counted.
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @return  number of keys in the flat set
+ */
+#define CMAGIC_FLAT_SET_SIZE(cmagic_flat_set) cmagic_flat_set_size((void*)(cmagic_flat_set))
+
+/**
+ * @brief   Returns the array of all keys in ascending order
+ * @details The array has @ref CMAGIC_FLAT_SET_SIZE keys and it's valid until the flat set is
+ *          modified.
+ * @param   key_type type of flat set keys
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @return  pointer to the first key
+ */
+#define CMAGIC_FLAT_SET_KEYS(key_type, cmagic_flat_set) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_set), *(key_type*)NULL), \
+    (const key_type*)cmagic_flat_set_keys((void*)(cmagic_flat_set)))
+
+/**
+ * @brief   Return iterator to the first key in the flat set
+ * @details It's the lowest key, as defined by @ref cmagic_flat_set_key_comparator_t.
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @return  an iterator to the first key or @c NULL if the flat set is empty
+ */
+#define CMAGIC_FLAT_SET_FIRST(cmagic_flat_set) cmagic_flat_set_first((void*)(cmagic_flat_set))
+
+/**
+ * @brief   Return iterator to the last key in the flat set
+ * @details It's the greatest key, as defined by @ref cmagic_flat_set_key_comparator_t.
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @return  an iterator to the last key or @c NULL if the flat set is empty
+ */
+#define CMAGIC_FLAT_SET_LAST(cmagic_flat_set) cmagic_flat_set_last((void*)(cmagic_flat_set))
+
+/**
+ * @brief   Return iterator to the next key
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   iterator @ref cmagic_flat_set_iterator_t pointing to a key of the flat set
+ * @return  an iterator to the next key or @c NULL if @p iterator points to the last one
+ */
+#define CMAGIC_FLAT_SET_ITERATOR_NEXT(cmagic_flat_set, iterator) \
+    cmagic_flat_set_iterator_next((void*)(cmagic_flat_set), (iterator))
+
+/**
+ * @brief   Return iterator to the previous key
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   iterator @ref cmagic_flat_set_iterator_t pointing to a key of the flat set
+ * @return  an iterator to the previous key or @c NULL if @p iterator points to the first one
+ */
+#define CMAGIC_FLAT_SET_ITERATOR_PREV(cmagic_flat_set, iterator) \
+    cmagic_flat_set_iterator_prev((void*)(cmagic_flat_set), (iterator))
+
+/**
+ * @brief   Searches the container for a key equal to @p key
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   key pointer to a key to be searched for
+ * @return  an iterator to the key or @c NULL if @p key is not found
+ */
+#define CMAGIC_FLAT_SET_FIND(cmagic_flat_set, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_set), *(key)), \
+    cmagic_flat_set_find((void*)(cmagic_flat_set), (key)))
+
+/**
+ * @brief   Checks whether the flat set contains a key equal to @p key
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   key pointer to a key to be searched for
+ * @return  @c true if @p key is found
+ */
+#define CMAGIC_FLAT_SET_CONTAINS(cmagic_flat_set, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_set), *(key)), \
+    cmagic_flat_set_contains((void*)(cmagic_flat_set), (key)))
+
+/**
+ * @brief   Returns an iterator pointing to the first key that is not less than @p key
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  an iterator to the key or @c NULL if all keys are less than @p key
+ */
+#define CMAGIC_FLAT_SET_LOWER_BOUND(cmagic_flat_set, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_set), *(key)), \
+    cmagic_flat_set_lower_bound((void*)(cmagic_flat_set), (key)))
+
+/**
+ * @brief   Returns an iterator pointing to the first key that is greater than @p key
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  an iterator to the key or @c NULL if no key is greater than @p key
+ */
+#define CMAGIC_FLAT_SET_UPPER_BOUND(cmagic_flat_set, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_flat_set), *(key)), \
+    cmagic_flat_set_upper_bound((void*)(cmagic_flat_set), (key)))
+
+/**
+ * @brief   Helper macro for retrieving the key from the iterator
+ * @param   key_type type of the keys of the flat set which the iterator is associated with
+ * @param   iterator @ref cmagic_flat_set_iterator_t object
+ * @return  flat set key
+ */
+#define CMAGIC_FLAT_SET_GET_KEY(key_type, iterator) \
+    (assert(iterator), *((const key_type*)(iterator)))
+
+/**
+ * @brief   Retrieves @ref cmagic_memory_alloc_packet_t associated with the flat set
+ * @param   cmagic_flat_set a flat set allocated before with @ref CMAGIC_FLAT_SET_NEW
+ * @return  @ref cmagic_memory_alloc_packet_t associated with the flat set
+ */
+#define CMAGIC_FLAT_SET_GET_ALLOC_PACKET(cmagic_flat_set) \
+    cmagic_flat_set_get_alloc_packet((void*)(cmagic_flat_set))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_FLAT_SET_H */
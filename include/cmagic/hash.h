@@ -0,0 +1,109 @@
+/**
+ * @file    hash.h
+ * @brief   Hash functions for the hashed containers and user keys.
+ * @details @ref cmagic_hash_bytes hashes memory of any length, the mixers scramble integers and
+ *          @ref cmagic_hash_combine merges hashes of several fields into one. Hash values don't
+ *          depend on the platform, but they may change between library versions, so they must not
+ *          be stored persistently. None of the functions is cryptographically secure.
+ */
+
+#ifndef CMAGIC_HASH_H
+#define CMAGIC_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Hashes @p size bytes starting at @p data
+ * @details Based on the public domain wyhash algorithm. Memory is read in 64-bit words with no
+ *          alignment requirement, and long inputs are processed 48 bytes at a time in three
+ *          independent lanes, so the multiplications of the lanes overlap in the pipeline.
+ * @param   data pointer to the bytes to be hashed, may be @c NULL if @p size is 0
+ * @param   size number of bytes
+ * @param   seed value changing the hash of every input
+ * @return  64-bit hash of the bytes
+ */
+uint64_t
+cmagic_hash_bytes(const void *data, size_t size, uint64_t seed);
+
+/**
+ * @brief   Hashes an @c int32_t key, see @ref cmagic_hash_uint64
+ */
+size_t
+cmagic_hash_int32(const void *key);
+
+/**
+ * @brief   Hashes a @c uint32_t key, see @ref cmagic_hash_uint64
+ */
+size_t
+cmagic_hash_uint32(const void *key);
+
+/**
+ * @brief   Hashes an @c int64_t key, see @ref cmagic_hash_uint64
+ */
+size_t
+cmagic_hash_int64(const void *key);
+
+/**
+ * @brief   Hashes a @c uint64_t key
+ * @details Built-in key hashes may be passed to a hashmap or a hashset like any other hash
+ *          function.
+ * @param   key pointer to the key
+ * @return  mixed value of the key
+ */
+size_t
+cmagic_hash_uint64(const void *key);
+
+/**
+ * @brief   Scrambles the bits of a 64-bit integer, so that every input bit affects every output bit
+ * @details It's a bijection, so distinct integers never get the same hash.
+ * @param   value integer to be mixed
+ * @return  mixed value
+ */
+static inline uint64_t cmagic_hash_mix64(uint64_t value) {
+    value ^= value >> 30;
+    value *= UINT64_C(0xBF58476D1CE4E5B9);
+    value ^= value >> 27;
+    value *= UINT64_C(0x94D049BB133111EB);
+    value ^= value >> 31;
+    return value;
+}
+
+/**
+ * @brief   Scrambles the bits of a 32-bit integer, see @ref cmagic_hash_mix64
+ * @param   value integer to be mixed
+ * @return  mixed value
+ */
+static inline uint32_t cmagic_hash_mix32(uint32_t value) {
+    value ^= value >> 16;
+    value *= UINT32_C(0x7FEB352D);
+    value ^= value >> 15;
+    value *= UINT32_C(0x846CA68B);
+    value ^= value >> 16;
+    return value;
+}
+
+/**
+ * @brief   Merges the hash of another field into the hash of the preceding fields
+ * @details The result depends on the order of the fields. Example usage:
+ *          @code
+ *          uint64_t hash = cmagic_hash_mix64(point.x);
+ *          hash = cmagic_hash_combine(hash, cmagic_hash_mix64(point.y));
+ *          @endcode
+ * @param   seed hash of the preceding fields
+ * @param   hash hash of the next field
+ * @return  hash of all the fields
+ */
+static inline uint64_t cmagic_hash_combine(uint64_t seed, uint64_t hash) {
+    return cmagic_hash_mix64(seed + UINT64_C(0x9E3779B97F4A7C15) + hash);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_HASH_H */
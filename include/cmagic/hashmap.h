@@ -0,0 +1,395 @@
+/**
+ * @file    hashmap.h
+ * @brief   Implementation of a @b hashmap container.
+ * @details Unlike @ref map.h the hashmap keeps its elements in no particular order. It's an open
+ *          addressing hash table storing keys and values inline in a single flat array, so a lookup
+ *          usually touches one group of control bytes and one element. Please <b>use provided
+ *          macros</b> instead of raw functions to gain additional type checks.
+ */
+
+#ifndef CMAGIC_HASHMAP_H
+#define CMAGIC_HASHMAP_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmagic/memory.h"
+#include "cmagic/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Pointer to a function that hashes a key
+ * @details Equal keys must have equal hashes. The hashmap mixes the result before use, so even the
+ *          identity function is a reasonable hash of integer keys.
+ * @param   key pointer to the key to be hashed
+ * @return  hash of the key
+ */
+typedef size_t (*cmagic_hashmap_hash_function_t)(const void *key);
+
+/**
+ * @brief   Pointer to a function that checks whether two keys are equal
+ * @details May be @c NULL, in which case keys are compared byte by byte. That's enough for
+ *          integers, but not for structures with padding or keys owning other memory.
+ * @param   key1 pointer to the first key
+ * @param   key2 pointer to the second key
+ * @return  @c true if the keys are equal
+ */
+typedef bool (*cmagic_hashmap_key_equal_t)(const void *key1, const void *key2);
+
+/**
+ * @brief   User defined additional tasks to be executed right before hashmap element deletion
+ * @warning Do not call @c free function on the @c key or @c value. They are stored inside the
+ *          hashmap.
+ * @param   key pointer to key to be deleted
+ * @param   value pointer to the value to be deleted
+ */
+typedef void (*cmagic_hashmap_erase_destructor_t)(void *key, void *value);
+
+/**
+ * @brief   User defined initialization of an element copied into another hashmap
+ * @param   destination_key pointer to uninitialized memory of the new key
+ * @param   destination_value pointer to uninitialized memory of the new value
+ * @param   source_key pointer to the key to be copied
+ * @param   source_value pointer to the value to be copied
+ */
+typedef void (*cmagic_hashmap_copy_function_t)(void *destination_key, void *destination_value,
+                                               const void *source_key, const void *source_value);
+
+/**
+ * @brief   User defined move of an element to another place when the hashmap grows
+ * @details Needed only by elements which can't be moved byte by byte, e.g. ones pointing to
+ *          themselves. The source element is released afterwards without calling any destructor.
+ * @param   destination_key pointer to uninitialized memory of the moved key
+ * @param   destination_value pointer to uninitialized memory of the moved value
+ * @param   source_key pointer to the key to be moved
+ * @param   source_value pointer to the value to be moved
+ */
+typedef void (*cmagic_hashmap_relocate_function_t)(void *destination_key, void *destination_value,
+                                                   void *source_key, void *source_value);
+
+/**
+ * @brief   Hashmap iterator
+ * @details Iterators are passed by value. An iterator with @c NULL @c key points past the last
+ *          element. Inserting an element may move all elements and invalidates all iterators,
+ *          erasing one keeps other iterators valid.
+ */
+typedef struct {
+    const void *key;
+    void *value;
+} cmagic_hashmap_iterator_t;
+
+/**
+ * @brief   Hashmap insertion result
+ */
+typedef struct {
+
+    /**
+     * @brief   iterator pointing to a new or already existing element, its @c key is @c NULL if
+     *          the allocation has failed
+     */
+    cmagic_hashmap_iterator_t inserted_or_existing;
+
+    /**
+     * @brief   @c true if the element already exists in the hashmap and the hashmap was not
+     *          modified, @c false if a new element has been allocated
+     */
+    bool already_exists;
+
+} cmagic_hashmap_insert_result_t;
+
+void *
+cmagic_hashmap_new(size_t key_size, size_t value_size, cmagic_hashmap_hash_function_t hash,
+                   cmagic_hashmap_key_equal_t key_equal,
+                   const cmagic_memory_alloc_packet_t *alloc_packet);
+
+void *
+cmagic_hashmap_new_ext(size_t key_size, size_t value_size, cmagic_hashmap_hash_function_t hash,
+                       cmagic_hashmap_key_equal_t key_equal,
+                       const cmagic_memory_alloc_packet_t *alloc_packet,
+                       cmagic_hashmap_relocate_function_t relocate);
+
+void
+cmagic_hashmap_free(void *hashmap_ptr);
+
+void *
+cmagic_hashmap_copy(void *hashmap_ptr, cmagic_hashmap_copy_function_t copy);
+
+cmagic_hashmap_insert_result_t
+cmagic_hashmap_allocate(void *hashmap_ptr, const void *key);
+
+cmagic_hashmap_insert_result_t
+cmagic_hashmap_insert(void *hashmap_ptr, const void *key, const void *value);
+
+void
+cmagic_hashmap_erase(void *hashmap_ptr, const void *key,
+                     cmagic_hashmap_erase_destructor_t destructor);
+
+void
+cmagic_hashmap_erase_iterator(void *hashmap_ptr, cmagic_hashmap_iterator_t iterator,
+                              cmagic_hashmap_erase_destructor_t destructor);
+
+void
+cmagic_hashmap_clear_ext(void *hashmap_ptr, cmagic_hashmap_erase_destructor_t destructor);
+
+void
+cmagic_hashmap_clear(void *hashmap_ptr);
+
+bool
+cmagic_hashmap_reserve(void *hashmap_ptr, size_t count);
+
+size_t
+cmagic_hashmap_size(void *hashmap_ptr);
+
+size_t
+cmagic_hashmap_capacity(void *hashmap_ptr);
+
+cmagic_hashmap_iterator_t
+cmagic_hashmap_first(void *hashmap_ptr);
+
+cmagic_hashmap_iterator_t
+cmagic_hashmap_iterator_next(void *hashmap_ptr, cmagic_hashmap_iterator_t iterator);
+
+cmagic_hashmap_iterator_t
+cmagic_hashmap_find(void *hashmap_ptr, const void *key);
+
+const cmagic_memory_alloc_packet_t *
+cmagic_hashmap_get_alloc_packet(void *hashmap_ptr);
+
+/**
+ * @brief   Convenient alias for @c type*. Returned type of @ref CMAGIC_HASHMAP_NEW.
+ * @warning Type checks are performed only for hashmap keys.
+ * @param   type type of hashmap keys
+ */
+#define CMAGIC_HASHMAP(key_type) key_type*
+
+/**
+ * @brief   Allocates and returns an address of a newly created empty hashmap.
+ * @details No element array is allocated until the first insertion.
+ * @param   key_type type of hashmap keys
+ * @param   value_type type of hashmap values
+ * @param   hash function of type @ref cmagic_hashmap_hash_function_t
+ * @param   key_equal function of type @ref cmagic_hashmap_key_equal_t or @c NULL to compare the
+ *          keys byte by byte
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @return  a new empty hashmap or @c NULL if the allocation has failed
+ */
+#define CMAGIC_HASHMAP_NEW(key_type, value_type, hash, key_equal, alloc_packet) \
+    ((CMAGIC_HASHMAP(key_type))cmagic_hashmap_new(sizeof(key_type), sizeof(value_type), \
+    (hash), (key_equal), (alloc_packet)))
+
+/**
+ * @brief   Same as @ref CMAGIC_HASHMAP_NEW, but the elements are moved by a user defined function
+ *          when the hashmap grows
+ * @param   key_type type of hashmap keys
+ * @param   value_type type of hashmap values
+ * @param   hash function of type @ref cmagic_hashmap_hash_function_t
+ * @param   key_equal function of type @ref cmagic_hashmap_key_equal_t or @c NULL
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @param   relocate function of type @ref cmagic_hashmap_relocate_function_t or @c NULL to move
+ *          the elements byte by byte
+ * @return  a new empty hashmap or @c NULL if the allocation has failed
+ */
+#define CMAGIC_HASHMAP_NEW_EXT(key_type, value_type, hash, key_equal, alloc_packet, relocate) \
+    ((CMAGIC_HASHMAP(key_type))cmagic_hashmap_new_ext(sizeof(key_type), sizeof(value_type), \
+    (hash), (key_equal), (alloc_packet), (relocate)))
+
+/**
+ * @brief   Frees the resources allocated by the hashmap before.
+ * @details Must not use @p cmagic_hashmap after free.
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ */
+#define CMAGIC_HASHMAP_FREE(cmagic_hashmap) cmagic_hashmap_free((void*)(cmagic_hashmap))
+
+/**
+ * @brief   Allocates and returns a copy of the hashmap
+ * @details The element array is duplicated as a whole, so no key is hashed or compared. Keys and
+ *          values are copied byte by byte.
+ * @param   key_type type of hashmap keys
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @return  a new hashmap or @c NULL if the allocation has failed
+ */
+#define CMAGIC_HASHMAP_COPY(key_type, cmagic_hashmap) \
+    CMAGIC_HASHMAP_COPY_EXT(key_type, cmagic_hashmap, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_HASHMAP_COPY but initializes the copied elements with a user
+ *          defined function
+ * @param   key_type type of hashmap keys
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   copy function of type @ref cmagic_hashmap_copy_function_t to be called on every new
+ *          element
+ * @return  a new hashmap or @c NULL if the allocation has failed
+ */
+#define CMAGIC_HASHMAP_COPY_EXT(key_type, cmagic_hashmap, copy) \
+    ((CMAGIC_HASHMAP(key_type))cmagic_hashmap_copy((void*)(cmagic_hashmap), (copy)))
+
+/**
+ * @brief   Allocates space for a new element (key-value pair) but does not initialize it.
+ * @details New element is allocated only if @p key doesn't already exist in the hashmap.
+ * @warning The new element must be initialized right after calling this function. Especially its
+ *          key must have the same hash and be equal to @p key then.
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   key pointer to the key value, needed to find a place for the new element
+ * @return  @ref cmagic_hashmap_insert_result_t pointing to the new or already existing element
+ */
+#define CMAGIC_HASHMAP_ALLOCATE(cmagic_hashmap, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_hashmap), *(key)), \
+    cmagic_hashmap_allocate((void*)(cmagic_hashmap), (key)))
+
+/**
+ * @brief   Allocates a new element and initializes it with data under @p key and @p value
+ * @details New element is created only if @p key doesn't already exist in the hashmap.
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   key pointer to the key value
+ * @param   value pointer to the value value
+ * @return  @ref cmagic_hashmap_insert_result_t pointing to the new or already existing element
+ */
+#define CMAGIC_HASHMAP_INSERT(cmagic_hashmap, key, value) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_hashmap), *(key)), \
+    cmagic_hashmap_insert((void*)(cmagic_hashmap), (key), (value)))
+
+/**
+ * @brief   Extended version of @ref CMAGIC_HASHMAP_ERASE
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   key pointer to a key of the element to be removed
+ * @param   destructor function of type @ref cmagic_hashmap_erase_destructor_t to be called on the
+ *          key and value right before deleting them
+ */
+#define CMAGIC_HASHMAP_ERASE_EXT(cmagic_hashmap, key, destructor) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_hashmap), *(key)), \
+    cmagic_hashmap_erase((void*)(cmagic_hashmap), (key), (destructor)))
+
+/**
+ * @brief   Removes a single element from the hashmap
+ * @details Other elements are not moved. Function does nothing if the key doesn't exist.
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   key pointer to a key of the element to be removed
+ */
+#define CMAGIC_HASHMAP_ERASE(cmagic_hashmap, key) \
+    CMAGIC_HASHMAP_ERASE_EXT(cmagic_hashmap, key, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_HASHMAP_ERASE_ITERATOR
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   iterator @ref cmagic_hashmap_iterator_t pointing to the element to be removed
+ * @param   destructor function of type @ref cmagic_hashmap_erase_destructor_t to be called on the
+ *          key and value right before deleting them
+ */
+#define CMAGIC_HASHMAP_ERASE_ITERATOR_EXT(cmagic_hashmap, iterator, destructor) \
+    cmagic_hashmap_erase_iterator((void*)(cmagic_hashmap), (iterator), (destructor))
+
+/**
+ * @brief   Removes the element pointed to by @p iterator without looking up its key
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   iterator @ref cmagic_hashmap_iterator_t pointing to the element to be removed
+ */
+#define CMAGIC_HASHMAP_ERASE_ITERATOR(cmagic_hashmap, iterator) \
+    CMAGIC_HASHMAP_ERASE_ITERATOR_EXT(cmagic_hashmap, iterator, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_HASHMAP_CLEAR
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   destructor function of type @ref cmagic_hashmap_erase_destructor_t to be called on
+ *          every key and value right before deleting them
+ */
+#define CMAGIC_HASHMAP_CLEAR_EXT(cmagic_hashmap, destructor) \
+    cmagic_hashmap_clear_ext((void*)(cmagic_hashmap), (destructor))
+
+/**
+ * @brief   Removes all elements from the hashmap
+ * @details The element array is kept for further insertions.
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ */
+#define CMAGIC_HASHMAP_CLEAR(cmagic_hashmap) cmagic_hashmap_clear((void*)(cmagic_hashmap))
+
+/**
+ * @brief   Makes room for @p count elements, so inserting them doesn't move any element
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   count number of elements
+ * @return  @c true on success, @c false if the allocation has failed, in which case the hashmap is
+ *          unchanged
+ */
+#define CMAGIC_HASHMAP_RESERVE(cmagic_hashmap, count) \
+    cmagic_hashmap_reserve((void*)(cmagic_hashmap), (count))
+
+/**
+ * @brief   Returns the number of elements in the hashmap
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @return  number of elements in the hashmap
+ */
+#define CMAGIC_HASHMAP_SIZE(cmagic_hashmap) cmagic_hashmap_size((void*)(cmagic_hashmap))
+
+/**
+ * @brief   Returns the number of slots of the element array
+ * @details The hashmap grows when 7/8 of the slots are in use.
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @return  number of slots, 0 if no element array has been allocated yet
+ */
+#define CMAGIC_HASHMAP_CAPACITY(cmagic_hashmap) cmagic_hashmap_capacity((void*)(cmagic_hashmap))
+
+/**
+ * @brief   Return iterator to the first element in the hashmap
+ * @details Elements are visited in unspecified order with @ref CMAGIC_HASHMAP_ITERATOR_NEXT.
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @return  an iterator to the first element, its @c key is @c NULL if the hashmap is empty
+ */
+#define CMAGIC_HASHMAP_FIRST(cmagic_hashmap) cmagic_hashmap_first((void*)(cmagic_hashmap))
+
+/**
+ * @brief   Return iterator to the next element
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   iterator @ref cmagic_hashmap_iterator_t pointing to an element of the hashmap
+ * @return  an iterator to the next element, its @c key is @c NULL if @p iterator points to the
+ *          last one
+ */
+#define CMAGIC_HASHMAP_ITERATOR_NEXT(cmagic_hashmap, iterator) \
+    cmagic_hashmap_iterator_next((void*)(cmagic_hashmap), (iterator))
+
+/**
+ * @brief   Searches the container for an element with a key equal to @p key
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @param   key pointer to a key to be searched for
+ * @return  an iterator to the element, its @c key is @c NULL if @p key is not found
+ */
+#define CMAGIC_HASHMAP_FIND(cmagic_hashmap, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_hashmap), *(key)), \
+    cmagic_hashmap_find((void*)(cmagic_hashmap), (key)))
+
+/**
+ * @brief   Helper macro for retrieving the key from the iterator
+ * @warning @p iterator must point to an element
+ * @param   key_type type of the keys of the hashmap which the iterator is associated with
+ * @param   iterator @ref cmagic_hashmap_iterator_t object
+ * @return  hashmap key
+ */
+#define CMAGIC_HASHMAP_GET_KEY(key_type, iterator) \
+    (assert((iterator).key), *((const key_type*)(iterator).key))
+
+/**
+ * @brief   Helper macro for retrieving the value from the iterator
+ * @warning @p iterator must point to an element
+ * @param   value_type type of the values of the hashmap which the iterator is associated with
+ * @param   iterator @ref cmagic_hashmap_iterator_t object
+ * @return  hashmap value
+ */
+#define CMAGIC_HASHMAP_GET_VALUE(value_type, iterator) \
+    (assert((iterator).value), *((value_type*)(iterator).value))
+
+/**
+ * @brief   Retrieves @ref cmagic_memory_alloc_packet_t associated with the hashmap
+ * @param   cmagic_hashmap a hashmap allocated before with @ref CMAGIC_HASHMAP_NEW
+ * @return  @ref cmagic_memory_alloc_packet_t associated with the hashmap
+ */
+#define CMAGIC_HASHMAP_GET_ALLOC_PACKET(cmagic_hashmap) \
+    cmagic_hashmap_get_alloc_packet((void*)(cmagic_hashmap))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_HASHMAP_H */
@@ -0,0 +1,379 @@
+/**
+ * @file    hashset.h
+ * @brief   Implementation of a @b hashset container.
+ * @details Unlike @ref set.h the hashset keeps its elements in no particular order. It's an open
+ *          addressing hash table storing the keys inline in a single flat array, the same as
+ *          @ref hashmap.h. Please <b>use provided macros</b> instead of raw functions to gain
+ *          additional type checks.
+ */
+
+#ifndef CMAGIC_HASHSET_H
+#define CMAGIC_HASHSET_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmagic/memory.h"
+#include "cmagic/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Pointer to a function that hashes a key
+ * @details Equal keys must have equal hashes. The hashset mixes the result before use, so even the
+ *          identity function is a reasonable hash of integer keys.
+ * @param   key pointer to the key to be hashed
+ * @return  hash of the key
+ */
+typedef size_t (*cmagic_hashset_hash_function_t)(const void *key);
+
+/**
+ * @brief   Pointer to a function that checks whether two keys are equal
+ * @details May be @c NULL, in which case keys are compared byte by byte.
+ * @param   key1 pointer to the first key
+ * @param   key2 pointer to the second key
+ * @return  @c true if the keys are equal
+ */
+typedef bool (*cmagic_hashset_key_equal_t)(const void *key1, const void *key2);
+
+/**
+ * @brief   User defined additional tasks to be executed right before key deletion
+ * @warning Do not call @c free function on the @c key. It's stored inside the hashset.
+ * @param   key pointer to key to be deleted
+ */
+typedef void (*cmagic_hashset_erase_destructor_t)(void *key);
+
+/**
+ * @brief   User defined initialization of a key copied into another hashset
+ * @param   destination pointer to uninitialized memory of the new key
+ * @param   source pointer to the key to be copied
+ */
+typedef void (*cmagic_hashset_copy_function_t)(void *destination, const void *source);
+
+/**
+ * @brief   User defined move of a key to another place when the hashset grows
+ * @details Needed only by keys which can't be moved byte by byte. The source key is released
+ *          afterwards without calling any destructor.
+ * @param   destination pointer to uninitialized memory of the moved key
+ * @param   source pointer to the key to be moved
+ */
+typedef void (*cmagic_hashset_relocate_function_t)(void *destination, void *source);
+
+/**
+ * @brief   Hashset iterator, which points directly to the key
+ * @details @c NULL iterator points past the last element. Inserting an element may move all
+ *          elements and invalidates all iterators, erasing one keeps other iterators valid.
+ */
+typedef const void *cmagic_hashset_iterator_t;
+
+/**
+ * @brief   Hashset insertion result
+ */
+typedef struct {
+
+    /**
+     * @brief   iterator pointing to a new or already existing element or @c NULL if the allocation
+     *          has failed
+     */
+    cmagic_hashset_iterator_t inserted_or_existing;
+
+    /**
+     * @brief   @c true if the element already exists in the hashset and the hashset was not
+     *          modified, @c false if a new element has been allocated
+     */
+    bool already_exists;
+
+} cmagic_hashset_insert_result_t;
+
+void *
+cmagic_hashset_new(size_t key_size, cmagic_hashset_hash_function_t hash,
+                   cmagic_hashset_key_equal_t key_equal,
+                   const cmagic_memory_alloc_packet_t *alloc_packet);
+
+void *
+cmagic_hashset_new_ext(size_t key_size, cmagic_hashset_hash_function_t hash,
+                       cmagic_hashset_key_equal_t key_equal,
+                       const cmagic_memory_alloc_packet_t *alloc_packet,
+                       cmagic_hashset_relocate_function_t relocate);
+
+void
+cmagic_hashset_free(void *hashset_ptr);
+
+void *
+cmagic_hashset_copy(void *hashset_ptr, cmagic_hashset_copy_function_t copy);
+
+cmagic_hashset_insert_result_t
+cmagic_hashset_allocate(void *hashset_ptr, const void *key);
+
+cmagic_hashset_insert_result_t
+cmagic_hashset_insert(void *hashset_ptr, const void *key);
+
+void
+cmagic_hashset_erase(void *hashset_ptr, const void *key,
+                     cmagic_hashset_erase_destructor_t destructor);
+
+void
+cmagic_hashset_erase_iterator(void *hashset_ptr, cmagic_hashset_iterator_t iterator,
+                              cmagic_hashset_erase_destructor_t destructor);
+
+void
+cmagic_hashset_clear_ext(void *hashset_ptr, cmagic_hashset_erase_destructor_t destructor);
+
+void
+cmagic_hashset_clear(void *hashset_ptr);
+
+bool
+cmagic_hashset_reserve(void *hashset_ptr, size_t count);
+
+size_t
+cmagic_hashset_size(void *hashset_ptr);
+
+size_t
+cmagic_hashset_capacity(void *hashset_ptr);
+
+cmagic_hashset_iterator_t
+cmagic_hashset_first(void *hashset_ptr);
+
+cmagic_hashset_iterator_t
+cmagic_hashset_iterator_next(void *hashset_ptr, cmagic_hashset_iterator_t iterator);
+
+cmagic_hashset_iterator_t
+cmagic_hashset_find(void *hashset_ptr, const void *key);
+
+bool
+cmagic_hashset_contains(void *hashset_ptr, const void *key);
+
+const cmagic_memory_alloc_packet_t *
+cmagic_hashset_get_alloc_packet(void *hashset_ptr);
+
+/**
+ * @brief   Convenient alias for @c type*. Returned type of @ref CMAGIC_HASHSET_NEW.
+ * @param   type type of hashset keys
+ */
+#define CMAGIC_HASHSET(key_type) key_type*
+
+/**
+ * @brief   Allocates and returns an address of a newly created empty hashset.
+ * @details No key array is allocated until the first insertion.
+ * @param   key_type type of hashset keys
+ * @param   hash function of type @ref cmagic_hashset_hash_function_t
+ * @param   key_equal function of type @ref cmagic_hashset_key_equal_t or @c NULL to compare the
+ *          keys byte by byte
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @return  a new empty hashset or @c NULL if the allocation has failed
+ */
+#define CMAGIC_HASHSET_NEW(key_type, hash, key_equal, alloc_packet) \
+    ((CMAGIC_HASHSET(key_type))cmagic_hashset_new(sizeof(key_type), (hash), (key_equal), \
+    (alloc_packet)))
+
+/**
+ * @brief   Same as @ref CMAGIC_HASHSET_NEW, but the keys are moved by a user defined function
+ *          when the hashset grows
+ * @param   key_type type of hashset keys
+ * @param   hash function of type @ref cmagic_hashset_hash_function_t
+ * @param   key_equal function of type @ref cmagic_hashset_key_equal_t or @c NULL
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @param   relocate function of type @ref cmagic_hashset_relocate_function_t or @c NULL to move
+ *          the keys byte by byte
+ * @return  a new empty hashset or @c NULL if the allocation has failed
+ */
+#define CMAGIC_HASHSET_NEW_EXT(key_type, hash, key_equal, alloc_packet, relocate) \
+    ((CMAGIC_HASHSET(key_type))cmagic_hashset_new_ext(sizeof(key_type), (hash), (key_equal), \
+    (alloc_packet), (relocate)))
+
+/**
+ * @brief   Frees the resources allocated by the hashset before.
+ * @details Must not use @p cmagic_hashset after free.
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ */
+#define CMAGIC_HASHSET_FREE(cmagic_hashset) cmagic_hashset_free((void*)(cmagic_hashset))
+
+/**
+ * @brief   Allocates and returns a copy of the hashset
+ * @details The key array is duplicated as a whole, so no key is hashed or compared. Keys are
+ *          copied byte by byte.
+ * @param   key_type type of hashset keys
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @return  a new hashset or @c NULL if the allocation has failed
+ */
+#define CMAGIC_HASHSET_COPY(key_type, cmagic_hashset) \
+    CMAGIC_HASHSET_COPY_EXT(key_type, cmagic_hashset, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_HASHSET_COPY but initializes the copied keys with a user defined
+ *          function
+ * @param   key_type type of hashset keys
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   copy function of type @ref cmagic_hashset_copy_function_t to be called on every new
+ *          key
+ * @return  a new hashset or @c NULL if the allocation has failed
+ */
+#define CMAGIC_HASHSET_COPY_EXT(key_type, cmagic_hashset, copy) \
+    ((CMAGIC_HASHSET(key_type))cmagic_hashset_copy((void*)(cmagic_hashset), (copy)))
+
+/**
+ * @brief   Allocates space for a new key but does not initialize it.
+ * @details New key is allocated only if @p key doesn't already exist in the hashset.
+ * @warning The new key must be initialized right after calling this function, and it must have
+ *          the same hash and be equal to @p key then.
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   key pointer to the key value, needed to find a place for the new key
+ * @return  @ref cmagic_hashset_insert_result_t pointing to the new or already existing key
+ */
+#define CMAGIC_HASHSET_ALLOCATE(cmagic_hashset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_hashset), *(key)), \
+    cmagic_hashset_allocate((void*)(cmagic_hashset), (key)))
+
+/**
+ * @brief   Allocates a new key and initializes it with data under @p key
+ * @details New key is created only if @p key doesn't already exist in the hashset.
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   key pointer to the key value
+ * @return  @ref cmagic_hashset_insert_result_t pointing to the new or already existing key
+ */
+#define CMAGIC_HASHSET_INSERT(cmagic_hashset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_hashset), *(key)), \
+    cmagic_hashset_insert((void*)(cmagic_hashset), (key)))
+
+/**
+ * @brief   Extended version of @ref CMAGIC_HASHSET_ERASE
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   key pointer to the key to be removed
+ * @param   destructor function of type @ref cmagic_hashset_erase_destructor_t to be called on the
+ *          key right before deleting it
+ */
+#define CMAGIC_HASHSET_ERASE_EXT(cmagic_hashset, key, destructor) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_hashset), *(key)), \
+    cmagic_hashset_erase((void*)(cmagic_hashset), (key), (destructor)))
+
+/**
+ * @brief   Removes a single key from the hashset
+ * @details Other keys are not moved. Function does nothing if the key doesn't exist.
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   key pointer to the key to be removed
+ */
+#define CMAGIC_HASHSET_ERASE(cmagic_hashset, key) \
+    CMAGIC_HASHSET_ERASE_EXT(cmagic_hashset, key, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_HASHSET_ERASE_ITERATOR
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   iterator @ref cmagic_hashset_iterator_t pointing to the key to be removed
+ * @param   destructor function of type @ref cmagic_hashset_erase_destructor_t to be called on the
+ *          key right before deleting it
+ */
+#define CMAGIC_HASHSET_ERASE_ITERATOR_EXT(cmagic_hashset, iterator, destructor) \
+    cmagic_hashset_erase_iterator((void*)(cmagic_hashset), (iterator), (destructor))
+
+/**
+ * @brief   Removes the key pointed to by @p iterator without looking it up
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   iterator @ref cmagic_hashset_iterator_t pointing to the key to be removed
+ */
+#define CMAGIC_HASHSET_ERASE_ITERATOR(cmagic_hashset, iterator) \
+    CMAGIC_HASHSET_ERASE_ITERATOR_EXT(cmagic_hashset, iterator, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_HASHSET_CLEAR
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   destructor function of type @ref cmagic_hashset_erase_destructor_t to be called on
+ *          every key right before deleting it
+ */
+#define CMAGIC_HASHSET_CLEAR_EXT(cmagic_hashset, destructor) \
+    cmagic_hashset_clear_ext((void*)(cmagic_hashset), (destructor))
+
+/**
+ * @brief   Removes all keys from the hashset
+ * @details The key array is kept for further insertions.
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ */
+#define CMAGIC_HASHSET_CLEAR(cmagic_hashset) cmagic_hashset_clear((void*)(cmagic_hashset))
+
+/**
+ * @brief   Makes room for @p count keys, so inserting them doesn't move any key
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   count number of keys
+ * @return  @c true on success, @c false if the allocation has failed, in which case the hashset is
+ *          unchanged
+ */
+#define CMAGIC_HASHSET_RESERVE(cmagic_hashset, count) \
+    cmagic_hashset_reserve((void*)(cmagic_hashset), (count))
+
+/**
+ * @brief   Returns the number of keys in the hashset
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @return  number of keys in the hashset
+ */
+#define CMAGIC_HASHSET_SIZE(cmagic_hashset) cmagic_hashset_size((void*)(cmagic_hashset))
+
+/**
+ * @brief   Returns the number of slots of the key array
+ * @details The hashset grows when 7/8 of the slots are in use.
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @return  number of slots, 0 if no key array has been allocated yet
+ */
+#define CMAGIC_HASHSET_CAPACITY(cmagic_hashset) cmagic_hashset_capacity((void*)(cmagic_hashset))
+
+/**
+ * @brief   Return iterator to the first key in the hashset
+ * @details Keys are visited in unspecified order with @ref CMAGIC_HASHSET_ITERATOR_NEXT.
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @return  an iterator to the first key or @c NULL if the hashset is empty
+ */
+#define CMAGIC_HASHSET_FIRST(cmagic_hashset) cmagic_hashset_first((void*)(cmagic_hashset))
+
+/**
+ * @brief   Return iterator to the next key
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   iterator @ref cmagic_hashset_iterator_t pointing to a key of the hashset
+ * @return  an iterator to the next key or @c NULL if @p iterator points to the last one
+ */
+#define CMAGIC_HASHSET_ITERATOR_NEXT(cmagic_hashset, iterator) \
+    cmagic_hashset_iterator_next((void*)(cmagic_hashset), (iterator))
+
+/**
+ * @brief   Searches the container for a key equal to @p key
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   key pointer to a key to be searched for
+ * @return  an iterator to the key or @c NULL if @p key is not found
+ */
+#define CMAGIC_HASHSET_FIND(cmagic_hashset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_hashset), *(key)), \
+    cmagic_hashset_find((void*)(cmagic_hashset), (key)))
+
+/**
+ * @brief   Checks whether the hashset contains a key equal to @p key
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @param   key pointer to a key to be searched for
+ * @return  @c true if @p key is found
+ */
+#define CMAGIC_HASHSET_CONTAINS(cmagic_hashset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_hashset), *(key)), \
+    cmagic_hashset_contains((void*)(cmagic_hashset), (key)))
+
+/**
+ * @brief   Helper macro for retrieving the key from the iterator
+ * @param   key_type type of the keys of the hashset which the iterator is associated with
+ * @param   iterator @ref cmagic_hashset_iterator_t object
+ * @return  hashset key
+ */
+#define CMAGIC_HASHSET_GET_KEY(key_type, iterator) \
+    (assert(iterator), *((const key_type*)(iterator)))
+
+/**
+ * @brief   Retrieves @ref cmagic_memory_alloc_packet_t associated with the hashset
+ * @param   cmagic_hashset a hashset allocated before with @ref CMAGIC_HASHSET_NEW
+ * @return  @ref cmagic_memory_alloc_packet_t associated with the hashset
+ */
+#define CMAGIC_HASHSET_GET_ALLOC_PACKET(cmagic_hashset) \
+    cmagic_hashset_get_alloc_packet((void*)(cmagic_hashset))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_HASHSET_H */
@@ -44,13 +44,83 @@ typedef int (*cmagic_map_key_comparator_t)(const void *key1, const void *key2);
  */
 typedef void (*cmagic_map_erase_destructor_t)(void *key, void *value);
 
+/**
+ * @brief   User defined initialization of an element copied into another map
+ * @details Called on uninitialized memory of the new key and value, which must become equivalent
+ *          to the source key and value.
+ * @param   destination_key pointer to uninitialized memory of the new key
+ * @param   destination_value pointer to uninitialized memory of the new value
+ * @param   source_key pointer to the key to be copied
+ * @param   source_value pointer to the value to be copied
+ */
+typedef void (*cmagic_map_copy_function_t)(void *destination_key, void *destination_value,
+                                           const void *source_key, const void *source_value);
+
+/**
+ * @brief   Internal data structure of a map
+ * @details All engines keep the elements sorted by the key comparator and provide the same
+ *          operations, but differ in memory layout:
+ *          - @ref CMAGIC_MAP_ENGINE_AVL_TREE allocates a separate node for every element. Iterators
+ *            stay valid until the element they point to is erased.
+ *          - @ref CMAGIC_MAP_ENGINE_B_TREE stores copies of many keys in a single node spanning a
+ *            few cache lines, which makes lookups faster for large maps. Every element is still
+ *            allocated separately, so iteration is only slightly faster than with the AVL tree and
+ *            iterators stay valid until the element they point to is erased.
+ *          - @ref CMAGIC_MAP_ENGINE_COMPACT_TREE keeps all elements in a single array and links
+ *            them by 32-bit indices, which takes less memory per element than the AVL tree.
+ *            Erasing an element keeps other iterators valid, but inserting one may invalidate all
+ *            iterators.
+ */
+typedef enum {
+
+    /**
+     * @brief   self-balancing binary search tree, the default engine
+     */
+    CMAGIC_MAP_ENGINE_AVL_TREE,
+
+    /**
+     * @brief   cache-friendly B+ tree with multi-element nodes
+     */
+    CMAGIC_MAP_ENGINE_B_TREE,
+
+    /**
+     * @brief   AVL tree stored in a contiguous array of compact nodes
+     */
+    CMAGIC_MAP_ENGINE_COMPACT_TREE
+
+} cmagic_map_engine_t;
+
 void *
 cmagic_map_new(size_t key_size, size_t value_size, cmagic_map_key_comparator_t key_comparator,
                const cmagic_memory_alloc_packet_t *alloc_packet);
 
+void *
+cmagic_map_new_ext(size_t key_size, size_t value_size, cmagic_map_key_comparator_t key_comparator,
+                   const cmagic_memory_alloc_packet_t *alloc_packet, cmagic_map_engine_t engine);
+
+/**
+ * @brief   Memory for a map placed on the stack or inside another object
+ * @details Its content is private, the map is set up in it by @ref CMAGIC_MAP_INIT.
+ */
+typedef struct {
+    void *private_data[7];
+} cmagic_map_storage_t;
+
+void *
+cmagic_map_init_ext(cmagic_map_storage_t *storage, size_t key_size, size_t value_size,
+                    cmagic_map_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet, cmagic_map_engine_t engine);
+
+void
+cmagic_map_destroy(void *map_ptr);
+
 void
 cmagic_map_free(void *map_ptr);
 
+void *
+cmagic_map_copy(void *map_ptr, cmagic_map_copy_function_t copy,
+                cmagic_map_erase_destructor_t destructor);
+
 typedef struct {
     const void *key;
     void *value;
@@ -84,6 +154,28 @@ cmagic_map_insert(void *map_ptr, const void *key, const void *value);
 void
 cmagic_map_erase(void *map_ptr, const void *key, cmagic_map_erase_destructor_t destructor);
 
+/**
+ * @brief   Element detached from a map
+ * @details Owns the key and the value of the element which can be accessed like through
+ *          @ref cmagic_map_iterator_t, e.g. with @ref CMAGIC_MAP_GET_KEY. It must be either
+ *          inserted into a map with @ref CMAGIC_MAP_INSERT_NODE or released with
+ *          @ref CMAGIC_MAP_NODE_FREE.
+ */
+typedef cmagic_map_iterator_t cmagic_map_node_t;
+
+cmagic_map_node_t
+cmagic_map_extract(void *map_ptr, const void *key);
+
+cmagic_map_insert_result_t
+cmagic_map_insert_node(void *map_ptr, cmagic_map_node_t node);
+
+void
+cmagic_map_node_free(cmagic_map_node_t node, const cmagic_memory_alloc_packet_t *alloc_packet,
+                     cmagic_map_erase_destructor_t destructor);
+
+void
+cmagic_map_clear_ext(void *map_ptr, cmagic_map_erase_destructor_t destructor);
+
 void
 cmagic_map_clear(void *map_ptr);
 
@@ -105,6 +197,68 @@ cmagic_map_iterator_prev(cmagic_map_iterator_t iterator);
 cmagic_map_iterator_t
 cmagic_map_find(void *map_ptr, const void *key);
 
+void
+cmagic_map_find_batch(void *map_ptr, const void *keys, size_t count,
+                      cmagic_map_iterator_t *out_iterators);
+
+cmagic_map_iterator_t
+cmagic_map_lower_bound(void *map_ptr, const void *key);
+
+cmagic_map_iterator_t
+cmagic_map_upper_bound(void *map_ptr, const void *key);
+
+/**
+ * @brief   Range of map elements
+ * @details Contains all elements starting from @c begin up to, but not including, @c end. The range
+ *          is empty if both iterators are equal.
+ */
+typedef struct {
+
+    /**
+     * @brief   iterator pointing to the first element of the range or @c NULL if the range starts
+     *          past the last element of the map
+     */
+    cmagic_map_iterator_t begin;
+
+    /**
+     * @brief   iterator pointing to the first element after the range or @c NULL if the range ends
+     *          at the last element of the map
+     */
+    cmagic_map_iterator_t end;
+
+} cmagic_map_range_t;
+
+cmagic_map_range_t
+cmagic_map_equal_range(void *map_ptr, const void *key);
+
+cmagic_map_iterator_t
+cmagic_map_find_by(void *map_ptr, const void *key, cmagic_map_key_comparator_t key_comparator);
+
+cmagic_map_iterator_t
+cmagic_map_lower_bound_by(void *map_ptr, const void *key,
+                          cmagic_map_key_comparator_t key_comparator);
+
+cmagic_map_iterator_t
+cmagic_map_upper_bound_by(void *map_ptr, const void *key,
+                          cmagic_map_key_comparator_t key_comparator);
+
+cmagic_map_range_t
+cmagic_map_equal_range_by(void *map_ptr, const void *key,
+                          cmagic_map_key_comparator_t key_comparator);
+
+void
+cmagic_map_erase_by(void *map_ptr, const void *key, cmagic_map_key_comparator_t key_comparator,
+                    cmagic_map_erase_destructor_t destructor);
+
+bool
+cmagic_map_merge(void *map_ptr, void *source_map_ptr);
+
+bool
+cmagic_map_split(void *map_ptr, const void *key, void *right_map_ptr);
+
+bool
+cmagic_map_join(void *map_ptr, void *right_map_ptr);
+
 const cmagic_memory_alloc_packet_t *
 cmagic_map_get_alloc_packet(void *map_ptr);
 
@@ -130,6 +284,64 @@ cmagic_map_get_alloc_packet(void *map_ptr);
 #define CMAGIC_MAP_NEW(key_type, value_type, key_comparator, alloc_packet) ((CMAGIC_MAP(key_type)) \
     cmagic_map_new(sizeof(key_type), sizeof(value_type), (key_comparator), (alloc_packet)))
 
+/**
+ * @brief   Allocates and returns an address of a newly created empty map using the given internal
+ *          data structure.
+ * @param   key_type type of map elements
+ * @param   value_type type of map values
+ * @param   key_comparator function of type @ref cmagic_map_key_comparator_t determining the order
+ *          of the elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @param   engine @ref cmagic_map_engine_t internal data structure of the map
+ * @return  a new empty map
+ */
+#define CMAGIC_MAP_NEW_EXT(key_type, value_type, key_comparator, alloc_packet, engine) \
+    ((CMAGIC_MAP(key_type))cmagic_map_new_ext(sizeof(key_type), sizeof(value_type), \
+    (key_comparator), (alloc_packet), (engine)))
+
+/**
+ * @brief   Sets up an empty map in @p storage without any allocation.
+ * @details The map allocates memory only when the first element is inserted, so an empty map costs
+ *          no dynamic memory at all. Resources of the map must be released by
+ *          @ref CMAGIC_MAP_DESTROY, not @ref CMAGIC_MAP_FREE.
+ * @param   storage pointer to @ref cmagic_map_storage_t, which must outlive the map
+ * @param   key_type type of map elements
+ * @param   value_type type of map values
+ * @param   key_comparator function of type @ref cmagic_map_key_comparator_t determining the order
+ *          of the elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @return  an empty map, never @c NULL
+ */
+#define CMAGIC_MAP_INIT(storage, key_type, value_type, key_comparator, alloc_packet) \
+    CMAGIC_MAP_INIT_EXT(storage, key_type, value_type, key_comparator, alloc_packet, \
+    CMAGIC_MAP_ENGINE_AVL_TREE)
+
+/**
+ * @brief   Sets up an empty map in @p storage using the given internal data structure.
+ * @details Same as @ref CMAGIC_MAP_INIT.
+ * @param   storage pointer to @ref cmagic_map_storage_t, which must outlive the map
+ * @param   key_type type of map elements
+ * @param   value_type type of map values
+ * @param   key_comparator function of type @ref cmagic_map_key_comparator_t determining the order
+ *          of the elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @param   engine @ref cmagic_map_engine_t internal data structure of the map
+ * @return  an empty map, never @c NULL
+ */
+#define CMAGIC_MAP_INIT_EXT(storage, key_type, value_type, key_comparator, alloc_packet, engine) \
+    ((CMAGIC_MAP(key_type))cmagic_map_init_ext((storage), sizeof(key_type), sizeof(value_type), \
+    (key_comparator), (alloc_packet), (engine)))
+
+/**
+ * @brief   Releases the resources of a map initialized before by @ref CMAGIC_MAP_INIT.
+ * @details The map is left empty and can be used again. Its storage is not released.
+ * @param   cmagic_map a map initialized before with @ref CMAGIC_MAP_INIT
+ */
+#define CMAGIC_MAP_DESTROY(cmagic_map) cmagic_map_destroy((void*)(cmagic_map))
+
 /**
  * @brief   Frees the resources allocated by the map before.
  * @details Must not use @p cmagic_map after free.
@@ -137,6 +349,32 @@ cmagic_map_get_alloc_packet(void *map_ptr);
  */
 #define CMAGIC_MAP_FREE(cmagic_map) cmagic_map_free((void*)(cmagic_map))
 
+/**
+ * @brief   Allocates and returns a copy of the map
+ * @details With @ref CMAGIC_MAP_ENGINE_AVL_TREE the shape of the tree is duplicated node by node,
+ *          other engines build the copy from the sorted elements. Either way no key is compared
+ *          and the whole operation takes linear time. The copy uses the same comparator, allocator
+ *          and engine. Keys and values are copied byte by byte.
+ * @param   key_type type of map keys
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @return  a new map or @c NULL if the allocation has failed
+ */
+#define CMAGIC_MAP_COPY(key_type, cmagic_map) \
+    CMAGIC_MAP_COPY_EXT(key_type, cmagic_map, NULL, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_MAP_COPY but initializes the copied elements with a user defined
+ *          function
+ * @param   key_type type of map keys
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   copy function of type @ref cmagic_map_copy_function_t to be called on every new element
+ * @param   destructor function of type @ref cmagic_map_erase_destructor_t to be called on the
+ *          elements copied so far if the allocation fails, may be @c NULL
+ * @return  a new map or @c NULL if the allocation has failed
+ */
+#define CMAGIC_MAP_COPY_EXT(key_type, cmagic_map, copy, destructor) \
+    ((CMAGIC_MAP(key_type))cmagic_map_copy((void*)(cmagic_map), (copy), (destructor)))
+
 /**
  * @brief   Allocates space for a new element (key-value pair) but does not initialize it.
  * @details New element is allocated only if @p key doesn't already exist in the map.
@@ -185,6 +423,61 @@ cmagic_map_get_alloc_packet(void *map_ptr);
  */
 #define CMAGIC_MAP_ERASE(cmagic_map, key) CMAGIC_MAP_ERASE_EXT(cmagic_map, key, NULL)
 
+/**
+ * @brief   Removes a single element from the map without freeing its key and value
+ * @details The element is detached together with its internal node, so it can be moved to another
+ *          map with @ref CMAGIC_MAP_INSERT_NODE without any memory allocation. Iterators to other
+ *          elements stay valid.
+ * @warning Supported only by @ref CMAGIC_MAP_ENGINE_AVL_TREE. Must not be used on maps with other
+ *          engines.
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   key pointer to a key of the element to be detached
+ * @return  @ref cmagic_map_node_t owning the element or @c NULL if the key doesn't exist in the map
+ */
+#define CMAGIC_MAP_EXTRACT(cmagic_map, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_map), *(key)), \
+    cmagic_map_extract((void*)(cmagic_map), (key)))
+
+/**
+ * @brief   Inserts an element detached before with @ref CMAGIC_MAP_EXTRACT
+ * @details The node is linked into the map as it is, no memory is allocated. If an equivalent key
+ *          already exists in the map, the map is not modified and @p node stays detached.
+ * @warning Supported only by @ref CMAGIC_MAP_ENGINE_AVL_TREE. @p node must come from a map of the
+ *          same type using the same memory allocation functions.
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   node @ref cmagic_map_node_t to be inserted
+ * @return  @ref cmagic_map_insert_result_t, @c inserted_or_existing is equal to @p node if it has
+ *          been inserted
+ */
+#define CMAGIC_MAP_INSERT_NODE(cmagic_map, node) cmagic_map_insert_node((void*)(cmagic_map), (node))
+
+/**
+ * @brief   Extended version of @ref CMAGIC_MAP_NODE_FREE
+ * @param   node @ref cmagic_map_node_t to be released
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t of the map the node comes from
+ * @param   destructor function of type @ref cmagic_map_erase_destructor_t to be called on the key
+ *          and value right before deleting them
+ */
+#define CMAGIC_MAP_NODE_FREE_EXT(node, alloc_packet, destructor) \
+    cmagic_map_node_free((node), (alloc_packet), (destructor))
+
+/**
+ * @brief   Frees the key, the value and the node of a detached element
+ * @param   node @ref cmagic_map_node_t to be released
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t of the map the node comes from
+ */
+#define CMAGIC_MAP_NODE_FREE(node, alloc_packet) CMAGIC_MAP_NODE_FREE_EXT(node, alloc_packet, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_MAP_CLEAR
+ * @details All elements are removed in a single pass over the internal tree, without recursion.
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   destructor function of type @ref cmagic_map_erase_destructor_t to be called on every
+ *          key and value right before deleting them. Elements are visited in unspecified order.
+ */
+#define CMAGIC_MAP_CLEAR_EXT(cmagic_map, destructor) \
+    cmagic_map_clear_ext((void*)(cmagic_map), (destructor))
+
 /**
  * @brief   Removes all elements from the map
  * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
@@ -240,6 +533,113 @@ cmagic_map_get_alloc_packet(void *map_ptr);
 #define CMAGIC_MAP_FIND(cmagic_map, key) (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_map), *(key)), \
     cmagic_map_find((void*)(cmagic_map), (key)))
 
+/**
+ * @brief   Searches the container for many keys at once
+ * @details Gives the same results as calling @ref CMAGIC_MAP_FIND for every key, but with
+ *          @ref CMAGIC_MAP_ENGINE_AVL_TREE several lookups are advanced together and the nodes they
+ *          visit next are prefetched. Memory latency of independent lookups overlaps, which
+ *          speeds up searching maps much larger than the processor cache.
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   keys array of keys to be searched for
+ * @param   count number of keys
+ * @param   out_iterators array of @p count @ref cmagic_map_iterator_t receiving an iterator to the
+ *          element for every key, or @c NULL if the key is not found
+ */
+#define CMAGIC_MAP_FIND_BATCH(cmagic_map, keys, count, out_iterators) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_map), *(keys)), \
+    cmagic_map_find_batch((void*)(cmagic_map), (keys), (count), (out_iterators)))
+
+/**
+ * @brief   Returns an iterator pointing to the first element in the container whose key is not
+ *          considered to go before @p key
+ * @details Together with @ref CMAGIC_MAP_ITERATOR_NEXT allows to visit a range of keys in
+ *          O(log n + k) time, where k is the number of visited elements.
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  an iterator to the first element whose key is equivalent to or goes after @p key, or
+ *          @c NULL if all keys go before @p key
+ */
+#define CMAGIC_MAP_LOWER_BOUND(cmagic_map, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_map), *(key)), \
+    cmagic_map_lower_bound((void*)(cmagic_map), (key)))
+
+/**
+ * @brief   Returns an iterator pointing to the first element in the container whose key is
+ *          considered to go after @p key
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  an iterator to the first element whose key goes after @p key, or @c NULL if no such
+ *          element exists
+ */
+#define CMAGIC_MAP_UPPER_BOUND(cmagic_map, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_map), *(key)), \
+    cmagic_map_upper_bound((void*)(cmagic_map), (key)))
+
+/**
+ * @brief   Returns the bounds of a range that includes all the elements in the container which
+ *          have a key equivalent to @p key
+ * @details Because keys in a map are unique, the range contains at most one element. It is
+ *          equivalent to a pair of @ref CMAGIC_MAP_LOWER_BOUND and @ref CMAGIC_MAP_UPPER_BOUND
+ *          but performs only one search in the internal binary tree.
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  @ref cmagic_map_range_t of the matching elements
+ */
+#define CMAGIC_MAP_EQUAL_RANGE(cmagic_map, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_map), *(key)), \
+    cmagic_map_equal_range((void*)(cmagic_map), (key)))
+
+/**
+ * @brief   Searches the container for an element equivalent to @p key, which may be of another type
+ *          than the keys of the map
+ * @details Allows to search e.g. a map of strings by a string literal without constructing a
+ *          temporary key. @p key_comparator is called with @p key as the first argument and a key
+ *          of the map as the second one.
+ * @warning @p key_comparator must order @p key consistently with the comparator of the map.
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   key pointer to a key of any type to be searched for
+ * @param   key_comparator function of type @ref cmagic_map_key_comparator_t comparing @p key with
+ *          the keys of the map
+ * @return  an iterator to the key, if @p key is found, or @c NULL otherwise
+ */
+#define CMAGIC_MAP_FIND_BY(cmagic_map, key, key_comparator) \
+    cmagic_map_find_by((void*)(cmagic_map), (key), (key_comparator))
+
+/**
+ * @brief   Version of @ref CMAGIC_MAP_LOWER_BOUND taking a key of any type, see
+ *          @ref CMAGIC_MAP_FIND_BY
+ */
+#define CMAGIC_MAP_LOWER_BOUND_BY(cmagic_map, key, key_comparator) \
+    cmagic_map_lower_bound_by((void*)(cmagic_map), (key), (key_comparator))
+
+/**
+ * @brief   Version of @ref CMAGIC_MAP_UPPER_BOUND taking a key of any type, see
+ *          @ref CMAGIC_MAP_FIND_BY
+ */
+#define CMAGIC_MAP_UPPER_BOUND_BY(cmagic_map, key, key_comparator) \
+    cmagic_map_upper_bound_by((void*)(cmagic_map), (key), (key_comparator))
+
+/**
+ * @brief   Version of @ref CMAGIC_MAP_EQUAL_RANGE taking a key of any type, see
+ *          @ref CMAGIC_MAP_FIND_BY
+ */
+#define CMAGIC_MAP_EQUAL_RANGE_BY(cmagic_map, key, key_comparator) \
+    cmagic_map_equal_range_by((void*)(cmagic_map), (key), (key_comparator))
+
+/**
+ * @brief   Version of @ref CMAGIC_MAP_ERASE_EXT taking a key of any type, see
+ *          @ref CMAGIC_MAP_FIND_BY
+ */
+#define CMAGIC_MAP_ERASE_BY_EXT(cmagic_map, key, key_comparator, destructor) \
+    cmagic_map_erase_by((void*)(cmagic_map), (key), (key_comparator), (destructor))
+
+/**
+ * @brief   Version of @ref CMAGIC_MAP_ERASE taking a key of any type, see
+ *          @ref CMAGIC_MAP_FIND_BY
+ */
+#define CMAGIC_MAP_ERASE_BY(cmagic_map, key, key_comparator) \
+    CMAGIC_MAP_ERASE_BY_EXT(cmagic_map, key, key_comparator, NULL)
+
 /**
  * @brief   Helper macro for retrieving the key from the iterator
  * @warning @p iterator must not be @c NULL
@@ -260,6 +660,55 @@ cmagic_map_get_alloc_packet(void *map_ptr);
 #define CMAGIC_MAP_GET_VALUE(value_type, iterator) \
     (assert(iterator), assert((iterator)->value), *((value_type*)(iterator)->value))
 
+/**
+ * @brief   Moves the elements of @p source_map whose keys are not present in @p cmagic_map into
+ *          @p cmagic_map
+ * @details Elements with keys already present in @p cmagic_map stay in @p source_map. Keys and
+ *          values are relinked without copying. Both maps are traversed once in order and their
+ *          internal trees are rebuilt from the merged sequences, so the whole operation takes
+ *          linear time instead of a search per element. All iterators of both maps are invalidated.
+ * @warning Both maps must be ordered by equivalent comparators and use the same memory allocation
+ *          functions.
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   source_map a map of the same type
+ * @return  @c true on success, @c false if the allocation has failed and both maps are unchanged
+ */
+#define CMAGIC_MAP_MERGE(cmagic_map, source_map) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_map), *(source_map)), \
+    cmagic_map_merge((void*)(cmagic_map), (void*)(source_map)))
+
+/**
+ * @brief   Moves all elements whose keys do not go before @p key to @p right_map
+ * @details With @ref CMAGIC_MAP_ENGINE_AVL_TREE whole subtrees are relinked and the operation takes
+ *          logarithmic time. Other engines rebuild both maps in linear time. Keys and values are
+ *          never copied. Iterators of moved elements stay valid only with the AVL tree engine.
+ * @warning @p right_map must be empty and created with the same engine and memory allocation
+ *          functions as @p cmagic_map.
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   key pointer to the first key to be moved
+ * @param   right_map an empty map of the same type
+ * @return  @c true on success, @c false if the allocation has failed and both maps are unchanged
+ */
+#define CMAGIC_MAP_SPLIT(cmagic_map, key, right_map) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_map), *(key)), \
+    CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_map), *(right_map)), \
+    cmagic_map_split((void*)(cmagic_map), (key), (void*)(right_map)))
+
+/**
+ * @brief   Moves all elements of @p right_map to @p cmagic_map
+ * @details Inverse of @ref CMAGIC_MAP_SPLIT. With @ref CMAGIC_MAP_ENGINE_AVL_TREE the operation
+ *          takes logarithmic time, other engines rebuild the map in linear time. Keys and values
+ *          are never copied.
+ * @warning All keys of @p right_map must go after all keys of @p cmagic_map. Both maps must use
+ *          the same engine and memory allocation functions.
+ * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
+ * @param   right_map a map of the same type, empty on success
+ * @return  @c true on success, @c false if the allocation has failed and both maps are unchanged
+ */
+#define CMAGIC_MAP_JOIN(cmagic_map, right_map) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_map), *(right_map)), \
+    cmagic_map_join((void*)(cmagic_map), (void*)(right_map)))
+
 /**
  * @brief   Retrieves @ref cmagic_memory_alloc_packet_t associated with the map
  * @param   cmagic_map a map allocated before with @ref CMAGIC_MAP_NEW
@@ -0,0 +1,310 @@
+/**
+ * @file    multimap.h
+ * @brief   Implementation of a @b multimap container.
+ * @details A multimap is a map whose elements may have equivalent keys. Elements with equivalent
+ *          keys are kept in the order of their insertion. It shares the types of its callbacks and
+ *          iterators with @ref map.h. Please <b>use provided macros</b> instead of raw functions to
+ *          gain additional type checks.
+ */
+
+#ifndef CMAGIC_MULTIMAP_H
+#define CMAGIC_MULTIMAP_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmagic/map.h"
+#include "cmagic/memory.h"
+#include "cmagic/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *
+cmagic_multimap_new(size_t key_size, size_t value_size,
+                    cmagic_map_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet);
+
+void
+cmagic_multimap_free(void *multimap_ptr);
+
+void *
+cmagic_multimap_copy(void *multimap_ptr, cmagic_map_copy_function_t copy,
+                     cmagic_map_erase_destructor_t destructor);
+
+cmagic_map_iterator_t
+cmagic_multimap_allocate(void *multimap_ptr, const void *key);
+
+cmagic_map_iterator_t
+cmagic_multimap_insert(void *multimap_ptr, const void *key, const void *value);
+
+size_t
+cmagic_multimap_erase(void *multimap_ptr, const void *key,
+                      cmagic_map_erase_destructor_t destructor);
+
+void
+cmagic_multimap_erase_iterator(void *multimap_ptr, cmagic_map_iterator_t iterator,
+                               cmagic_map_erase_destructor_t destructor);
+
+void
+cmagic_multimap_clear_ext(void *multimap_ptr, cmagic_map_erase_destructor_t destructor);
+
+void
+cmagic_multimap_clear(void *multimap_ptr);
+
+size_t
+cmagic_multimap_size(void *multimap_ptr);
+
+cmagic_map_iterator_t
+cmagic_multimap_first(void *multimap_ptr);
+
+cmagic_map_iterator_t
+cmagic_multimap_last(void *multimap_ptr);
+
+cmagic_map_iterator_t
+cmagic_multimap_find(void *multimap_ptr, const void *key);
+
+size_t
+cmagic_multimap_count(void *multimap_ptr, const void *key);
+
+cmagic_map_iterator_t
+cmagic_multimap_lower_bound(void *multimap_ptr, const void *key);
+
+cmagic_map_iterator_t
+cmagic_multimap_upper_bound(void *multimap_ptr, const void *key);
+
+cmagic_map_range_t
+cmagic_multimap_equal_range(void *multimap_ptr, const void *key);
+
+const cmagic_memory_alloc_packet_t *
+cmagic_multimap_get_alloc_packet(void *multimap_ptr);
+
+/**
+ * @brief   Convenient alias for @c type*. Returned type of @ref CMAGIC_MULTIMAP_NEW.
+ * @warning Like with @ref CMAGIC_MAP, type checks are performed only for multimap keys.
+ * @param   type type of multimap keys
+ */
+#define CMAGIC_MULTIMAP(key_type) key_type*
+
+/**
+ * @brief   Allocates and returns an address of a newly created empty multimap.
+ * @param   key_type type of multimap keys
+ * @param   value_type type of multimap values
+ * @param   key_comparator function of type @ref cmagic_map_key_comparator_t determining the order
+ *          of the elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @return  a new empty multimap or @c NULL if the allocation has failed
+ */
+#define CMAGIC_MULTIMAP_NEW(key_type, value_type, key_comparator, alloc_packet) \
+    ((CMAGIC_MULTIMAP(key_type))cmagic_multimap_new(sizeof(key_type), sizeof(value_type), \
+    (key_comparator), (alloc_packet)))
+
+/**
+ * @brief   Frees the resources allocated by the multimap before.
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ */
+#define CMAGIC_MULTIMAP_FREE(cmagic_multimap) cmagic_multimap_free((void*)(cmagic_multimap))
+
+/**
+ * @brief   Allocates and returns a copy of the multimap
+ * @details The shape of the tree is duplicated node by node, so the order of equivalent keys is
+ *          preserved and the copy takes linear time. Keys and values are copied byte by byte.
+ * @param   key_type type of multimap keys
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @return  a new multimap or @c NULL if the allocation has failed
+ */
+#define CMAGIC_MULTIMAP_COPY(key_type, cmagic_multimap) \
+    CMAGIC_MULTIMAP_COPY_EXT(key_type, cmagic_multimap, NULL, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_MULTIMAP_COPY but initializes the copied elements with a user
+ *          defined function
+ * @param   key_type type of multimap keys
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   copy function of type @ref cmagic_map_copy_function_t to be called on every new
+ *          element
+ * @param   destructor function of type @ref cmagic_map_erase_destructor_t to be called on the
+ *          elements copied so far if the allocation fails, may be @c NULL
+ * @return  a new multimap or @c NULL if the allocation has failed
+ */
+#define CMAGIC_MULTIMAP_COPY_EXT(key_type, cmagic_multimap, copy, destructor) \
+    ((CMAGIC_MULTIMAP(key_type))cmagic_multimap_copy((void*)(cmagic_multimap), (copy), \
+    (destructor)))
+
+/**
+ * @brief   Allocates space for a new element but does not initialize it.
+ * @details The element is placed after all elements with keys equivalent to @p key.
+ * @warning The new element must be initialized right after calling this function, see
+ *          @ref CMAGIC_MAP_ALLOCATE.
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   key pointer to the key value, needed to place the new element in the internal tree
+ * @return  @ref cmagic_map_iterator_t pointing to the new element or @c NULL if the allocation has
+ *          failed
+ */
+#define CMAGIC_MULTIMAP_ALLOCATE(cmagic_multimap, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multimap), *(key)), \
+    cmagic_multimap_allocate((void*)(cmagic_multimap), (key)))
+
+/**
+ * @brief   Allocates a new element and initializes it with data under @p key and @p value
+ * @details The element is placed after all elements with keys equivalent to @p key.
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   key pointer to the key value
+ * @param   value pointer to the value value
+ * @return  @ref cmagic_map_iterator_t pointing to the new element or @c NULL if the allocation has
+ *          failed
+ */
+#define CMAGIC_MULTIMAP_INSERT(cmagic_multimap, key, value) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multimap), *(key)), \
+    cmagic_multimap_insert((void*)(cmagic_multimap), (key), (value)))
+
+/**
+ * @brief   Extended version of @ref CMAGIC_MULTIMAP_ERASE
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   key pointer to a key of the elements to be removed
+ * @param   destructor function of type @ref cmagic_map_erase_destructor_t to be called on every
+ *          key and value right before deleting them
+ * @return  number of removed elements
+ */
+#define CMAGIC_MULTIMAP_ERASE_EXT(cmagic_multimap, key, destructor) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multimap), *(key)), \
+    cmagic_multimap_erase((void*)(cmagic_multimap), (key), (destructor)))
+
+/**
+ * @brief   Removes all elements with keys equivalent to @p key
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   key pointer to a key of the elements to be removed
+ * @return  number of removed elements
+ */
+#define CMAGIC_MULTIMAP_ERASE(cmagic_multimap, key) \
+    CMAGIC_MULTIMAP_ERASE_EXT(cmagic_multimap, key, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_MULTIMAP_ERASE_ITERATOR
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   iterator @ref cmagic_map_iterator_t pointing to the element to be removed
+ * @param   destructor function of type @ref cmagic_map_erase_destructor_t to be called on the key
+ *          and value right before deleting them
+ */
+#define CMAGIC_MULTIMAP_ERASE_ITERATOR_EXT(cmagic_multimap, iterator, destructor) \
+    cmagic_multimap_erase_iterator((void*)(cmagic_multimap), (iterator), (destructor))
+
+/**
+ * @brief   Removes the single element pointed to by @p iterator
+ * @details Iterators to other elements stay valid.
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   iterator @ref cmagic_map_iterator_t pointing to the element to be removed
+ */
+#define CMAGIC_MULTIMAP_ERASE_ITERATOR(cmagic_multimap, iterator) \
+    CMAGIC_MULTIMAP_ERASE_ITERATOR_EXT(cmagic_multimap, iterator, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_MULTIMAP_CLEAR
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   destructor function of type @ref cmagic_map_erase_destructor_t to be called on every
+ *          key and value right before deleting them. Elements are visited in unspecified order.
+ */
+#define CMAGIC_MULTIMAP_CLEAR_EXT(cmagic_multimap, destructor) \
+    cmagic_multimap_clear_ext((void*)(cmagic_multimap), (destructor))
+
+/**
+ * @brief   Removes all elements from the multimap
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ */
+#define CMAGIC_MULTIMAP_CLEAR(cmagic_multimap) cmagic_multimap_clear((void*)(cmagic_multimap))
+
+/**
+ * @brief   Returns the number of elements in the multimap
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @return  number of elements in the multimap
+ */
+#define CMAGIC_MULTIMAP_SIZE(cmagic_multimap) cmagic_multimap_size((void*)(cmagic_multimap))
+
+/**
+ * @brief   Return iterator to the first element in the multimap
+ * @details Elements are visited with @ref CMAGIC_MAP_ITERATOR_NEXT and
+ *          @ref CMAGIC_MAP_ITERATOR_PREV and accessed with @ref CMAGIC_MAP_GET_KEY and
+ *          @ref CMAGIC_MAP_GET_VALUE.
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @return  an iterator to the first element or @c NULL if the multimap is empty
+ */
+#define CMAGIC_MULTIMAP_FIRST(cmagic_multimap) cmagic_multimap_first((void*)(cmagic_multimap))
+
+/**
+ * @brief   Return iterator to the last element in the multimap
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @return  an iterator to the last element or @c NULL if the multimap is empty
+ */
+#define CMAGIC_MULTIMAP_LAST(cmagic_multimap) cmagic_multimap_last((void*)(cmagic_multimap))
+
+/**
+ * @brief   Searches the container for the first inserted element with a key equivalent to @p key
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   key pointer to a key to be searched for
+ * @return  an iterator to the element, if @p key is found, or @c NULL otherwise
+ */
+#define CMAGIC_MULTIMAP_FIND(cmagic_multimap, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multimap), *(key)), \
+    cmagic_multimap_find((void*)(cmagic_multimap), (key)))
+
+/**
+ * @brief   Counts the elements with keys equivalent to @p key
+ * @details Takes logarithmic time regardless of the result, the internal tree keeps the sizes of
+ *          its subtrees.
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   key pointer to a key to be searched for
+ * @return  number of matching elements
+ */
+#define CMAGIC_MULTIMAP_COUNT(cmagic_multimap, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multimap), *(key)), \
+    cmagic_multimap_count((void*)(cmagic_multimap), (key)))
+
+/**
+ * @brief   Returns an iterator pointing to the first element whose key is not considered to go
+ *          before @p key
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  an iterator to the element or @c NULL if all keys go before @p key
+ */
+#define CMAGIC_MULTIMAP_LOWER_BOUND(cmagic_multimap, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multimap), *(key)), \
+    cmagic_multimap_lower_bound((void*)(cmagic_multimap), (key)))
+
+/**
+ * @brief   Returns an iterator pointing to the first element whose key is considered to go after
+ *          @p key
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  an iterator to the element or @c NULL if no such element exists
+ */
+#define CMAGIC_MULTIMAP_UPPER_BOUND(cmagic_multimap, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multimap), *(key)), \
+    cmagic_multimap_upper_bound((void*)(cmagic_multimap), (key)))
+
+/**
+ * @brief   Returns the range of all elements with keys equivalent to @p key
+ * @details The elements of the range are in the order of their insertion. Finding the range takes
+ *          logarithmic time, visiting its k elements O(k) more.
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  @ref cmagic_map_range_t of the matching elements
+ */
+#define CMAGIC_MULTIMAP_EQUAL_RANGE(cmagic_multimap, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multimap), *(key)), \
+    cmagic_multimap_equal_range((void*)(cmagic_multimap), (key)))
+
+/**
+ * @brief   Retrieves @ref cmagic_memory_alloc_packet_t associated with the multimap
+ * @param   cmagic_multimap a multimap allocated before with @ref CMAGIC_MULTIMAP_NEW
+ * @return  @ref cmagic_memory_alloc_packet_t associated with the multimap
+ */
+#define CMAGIC_MULTIMAP_GET_ALLOC_PACKET(cmagic_multimap) \
+    cmagic_multimap_get_alloc_packet((void*)(cmagic_multimap))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_MULTIMAP_H */
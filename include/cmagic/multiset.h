@@ -0,0 +1,306 @@
+/**
+ * @file    multiset.h
+ * @brief   Implementation of a @b multiset container.
+ * @details A multiset is a set which may contain equivalent keys. Elements with equivalent
+ *          keys are kept in the order of their insertion. It shares the types of its callbacks and
+ *          iterators with @ref set.h. Please <b>use provided macros</b> instead of raw functions to
+ *          gain additional type checks.
+ */
+
+#ifndef CMAGIC_MULTISET_H
+#define CMAGIC_MULTISET_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmagic/set.h"
+#include "cmagic/memory.h"
+#include "cmagic/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *
+cmagic_multiset_new(size_t key_size, cmagic_set_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet);
+
+void
+cmagic_multiset_free(void *multiset_ptr);
+
+void *
+cmagic_multiset_copy(void *multiset_ptr, cmagic_set_copy_function_t copy,
+                     cmagic_set_erase_destructor_t destructor);
+
+cmagic_set_iterator_t
+cmagic_multiset_allocate(void *multiset_ptr, const void *key);
+
+cmagic_set_iterator_t
+cmagic_multiset_insert(void *multiset_ptr, const void *key);
+
+size_t
+cmagic_multiset_erase(void *multiset_ptr, const void *key,
+                      cmagic_set_erase_destructor_t destructor);
+
+void
+cmagic_multiset_erase_iterator(void *multiset_ptr, cmagic_set_iterator_t iterator,
+                               cmagic_set_erase_destructor_t destructor);
+
+void
+cmagic_multiset_clear_ext(void *multiset_ptr, cmagic_set_erase_destructor_t destructor);
+
+void
+cmagic_multiset_clear(void *multiset_ptr);
+
+size_t
+cmagic_multiset_size(void *multiset_ptr);
+
+cmagic_set_iterator_t
+cmagic_multiset_first(void *multiset_ptr);
+
+cmagic_set_iterator_t
+cmagic_multiset_last(void *multiset_ptr);
+
+cmagic_set_iterator_t
+cmagic_multiset_find(void *multiset_ptr, const void *key);
+
+size_t
+cmagic_multiset_count(void *multiset_ptr, const void *key);
+
+cmagic_set_iterator_t
+cmagic_multiset_lower_bound(void *multiset_ptr, const void *key);
+
+cmagic_set_iterator_t
+cmagic_multiset_upper_bound(void *multiset_ptr, const void *key);
+
+cmagic_set_range_t
+cmagic_multiset_equal_range(void *multiset_ptr, const void *key);
+
+const cmagic_memory_alloc_packet_t *
+cmagic_multiset_get_alloc_packet(void *multiset_ptr);
+
+/**
+ * @brief   Convenient alias for @c type*. Returned type of @ref CMAGIC_MULTISET_NEW.
+ * @warning Like with @ref CMAGIC_MAP, type checks are performed only for multiset keys.
+ * @param   type type of multiset keys
+ */
+#define CMAGIC_MULTISET(key_type) key_type*
+
+/**
+ * @brief   Allocates and returns an address of a newly created empty multiset.
+ * @param   key_type type of multiset keys
+ * @param   key_comparator function of type @ref cmagic_set_key_comparator_t determining the order
+ *          of the elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @return  a new empty multiset or @c NULL if the allocation has failed
+ */
+#define CMAGIC_MULTISET_NEW(key_type, key_comparator, alloc_packet) \
+    ((CMAGIC_MULTISET(key_type))cmagic_multiset_new(sizeof(key_type), (key_comparator), \
+    (alloc_packet)))
+
+/**
+ * @brief   Frees the resources allocated by the multiset before.
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ */
+#define CMAGIC_MULTISET_FREE(cmagic_multiset) cmagic_multiset_free((void*)(cmagic_multiset))
+
+/**
+ * @brief   Allocates and returns a copy of the multiset
+ * @details The shape of the tree is duplicated node by node, so the order of equivalent keys is
+ *          preserved and the copy takes linear time. Keys are copied byte by byte.
+ * @param   key_type type of multiset keys
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @return  a new multiset or @c NULL if the allocation has failed
+ */
+#define CMAGIC_MULTISET_COPY(key_type, cmagic_multiset) \
+    CMAGIC_MULTISET_COPY_EXT(key_type, cmagic_multiset, NULL, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_MULTISET_COPY but initializes the copied elements with a user
+ *          defined function
+ * @param   key_type type of multiset keys
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   copy function of type @ref cmagic_set_copy_function_t to be called on every new
+ *          element
+ * @param   destructor function of type @ref cmagic_set_erase_destructor_t to be called on the
+ *          elements copied so far if the allocation fails, may be @c NULL
+ * @return  a new multiset or @c NULL if the allocation has failed
+ */
+#define CMAGIC_MULTISET_COPY_EXT(key_type, cmagic_multiset, copy, destructor) \
+    ((CMAGIC_MULTISET(key_type))cmagic_multiset_copy((void*)(cmagic_multiset), (copy), \
+    (destructor)))
+
+/**
+ * @brief   Allocates space for a new element but does not initialize it.
+ * @details The element is placed after all elements with keys equivalent to @p key.
+ * @warning The new element must be initialized right after calling this function, see
+ *          @ref CMAGIC_SET_ALLOCATE.
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   key pointer to the key value, needed to place the new element in the internal tree
+ * @return  @ref cmagic_set_iterator_t pointing to the new element or @c NULL if the allocation has
+ *          failed
+ */
+#define CMAGIC_MULTISET_ALLOCATE(cmagic_multiset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multiset), *(key)), \
+    cmagic_multiset_allocate((void*)(cmagic_multiset), (key)))
+
+/**
+ * @brief   Allocates a new element and initializes it with data under @p key
+ * @details The element is placed after all elements with keys equivalent to @p key.
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   key pointer to the key value
+ * @return  @ref cmagic_set_iterator_t pointing to the new element or @c NULL if the allocation has
+ *          failed
+ */
+#define CMAGIC_MULTISET_INSERT(cmagic_multiset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multiset), *(key)), \
+    cmagic_multiset_insert((void*)(cmagic_multiset), (key)))
+
+/**
+ * @brief   Extended version of @ref CMAGIC_MULTISET_ERASE
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   key pointer to a key of the elements to be removed
+ * @param   destructor function of type @ref cmagic_set_erase_destructor_t to be called on every
+ *          key right before deleting it
+ * @return  number of removed elements
+ */
+#define CMAGIC_MULTISET_ERASE_EXT(cmagic_multiset, key, destructor) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multiset), *(key)), \
+    cmagic_multiset_erase((void*)(cmagic_multiset), (key), (destructor)))
+
+/**
+ * @brief   Removes all elements with keys equivalent to @p key
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   key pointer to a key of the elements to be removed
+ * @return  number of removed elements
+ */
+#define CMAGIC_MULTISET_ERASE(cmagic_multiset, key) \
+    CMAGIC_MULTISET_ERASE_EXT(cmagic_multiset, key, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_MULTISET_ERASE_ITERATOR
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   iterator @ref cmagic_set_iterator_t pointing to the element to be removed
+ * @param   destructor function of type @ref cmagic_set_erase_destructor_t to be called on the key
+ *          right before deleting it
+ */
+#define CMAGIC_MULTISET_ERASE_ITERATOR_EXT(cmagic_multiset, iterator, destructor) \
+    cmagic_multiset_erase_iterator((void*)(cmagic_multiset), (iterator), (destructor))
+
+/**
+ * @brief   Removes the single element pointed to by @p iterator
+ * @details Iterators to other elements stay valid.
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   iterator @ref cmagic_set_iterator_t pointing to the element to be removed
+ */
+#define CMAGIC_MULTISET_ERASE_ITERATOR(cmagic_multiset, iterator) \
+    CMAGIC_MULTISET_ERASE_ITERATOR_EXT(cmagic_multiset, iterator, NULL)
+
+/**
+ * @brief   Extended version of @ref CMAGIC_MULTISET_CLEAR
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   destructor function of type @ref cmagic_set_erase_destructor_t to be called on every
+ *          key right before deleting it. Elements are visited in unspecified order.
+ */
+#define CMAGIC_MULTISET_CLEAR_EXT(cmagic_multiset, destructor) \
+    cmagic_multiset_clear_ext((void*)(cmagic_multiset), (destructor))
+
+/**
+ * @brief   Removes all elements from the multiset
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ */
+#define CMAGIC_MULTISET_CLEAR(cmagic_multiset) cmagic_multiset_clear((void*)(cmagic_multiset))
+
+/**
+ * @brief   Returns the number of elements in the multiset
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @return  number of elements in the multiset
+ */
+#define CMAGIC_MULTISET_SIZE(cmagic_multiset) cmagic_multiset_size((void*)(cmagic_multiset))
+
+/**
+ * @brief   Return iterator to the first element in the multiset
+ * @details Elements are visited with @ref CMAGIC_SET_ITERATOR_NEXT and
+ *          @ref CMAGIC_SET_ITERATOR_PREV and accessed with @ref CMAGIC_SET_GET_KEY.
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @return  an iterator to the first element or @c NULL if the multiset is empty
+ */
+#define CMAGIC_MULTISET_FIRST(cmagic_multiset) cmagic_multiset_first((void*)(cmagic_multiset))
+
+/**
+ * @brief   Return iterator to the last element in the multiset
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @return  an iterator to the last element or @c NULL if the multiset is empty
+ */
+#define CMAGIC_MULTISET_LAST(cmagic_multiset) cmagic_multiset_last((void*)(cmagic_multiset))
+
+/**
+ * @brief   Searches the container for the first inserted element with a key equivalent to @p key
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   key pointer to a key to be searched for
+ * @return  an iterator to the element, if @p key is found, or @c NULL otherwise
+ */
+#define CMAGIC_MULTISET_FIND(cmagic_multiset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multiset), *(key)), \
+    cmagic_multiset_find((void*)(cmagic_multiset), (key)))
+
+/**
+ * @brief   Counts the elements with keys equivalent to @p key
+ * @details Takes logarithmic time regardless of the result, the internal tree keeps the sizes of
+ *          its subtrees.
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   key pointer to a key to be searched for
+ * @return  number of matching elements
+ */
+#define CMAGIC_MULTISET_COUNT(cmagic_multiset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multiset), *(key)), \
+    cmagic_multiset_count((void*)(cmagic_multiset), (key)))
+
+/**
+ * @brief   Returns an iterator pointing to the first element whose key is not considered to go
+ *          before @p key
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  an iterator to the element or @c NULL if all keys go before @p key
+ */
+#define CMAGIC_MULTISET_LOWER_BOUND(cmagic_multiset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multiset), *(key)), \
+    cmagic_multiset_lower_bound((void*)(cmagic_multiset), (key)))
+
+/**
+ * @brief   Returns an iterator pointing to the first element whose key is considered to go after
+ *          @p key
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  an iterator to the element or @c NULL if no such element exists
+ */
+#define CMAGIC_MULTISET_UPPER_BOUND(cmagic_multiset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multiset), *(key)), \
+    cmagic_multiset_upper_bound((void*)(cmagic_multiset), (key)))
+
+/**
+ * @brief   Returns the range of all elements with keys equivalent to @p key
+ * @details The elements of the range are in the order of their insertion. Finding the range takes
+ *          logarithmic time, visiting its k elements O(k) more.
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @param   key pointer to a key to be compared with
+ * @return  @ref cmagic_set_range_t of the matching elements
+ */
+#define CMAGIC_MULTISET_EQUAL_RANGE(cmagic_multiset, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_multiset), *(key)), \
+    cmagic_multiset_equal_range((void*)(cmagic_multiset), (key)))
+
+/**
+ * @brief   Retrieves @ref cmagic_memory_alloc_packet_t associated with the multiset
+ * @param   cmagic_multiset a multiset allocated before with @ref CMAGIC_MULTISET_NEW
+ * @return  @ref cmagic_memory_alloc_packet_t associated with the multiset
+ */
+#define CMAGIC_MULTISET_GET_ALLOC_PACKET(cmagic_multiset) \
+    cmagic_multiset_get_alloc_packet((void*)(cmagic_multiset))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_MULTISET_H */
@@ -43,13 +43,80 @@ typedef int (*cmagic_set_key_comparator_t)(const void *key1, const void *key2);
  */
 typedef void (*cmagic_set_erase_destructor_t)(void *key);
 
+/**
+ * @brief   User defined initialization of a key copied into another set
+ * @details Called on uninitialized memory of the @p destination key, which must become
+ *          equivalent to the @p source key.
+ * @param   destination pointer to uninitialized memory of the new key
+ * @param   source pointer to the key to be copied
+ */
+typedef void (*cmagic_set_copy_function_t)(void *destination, const void *source);
+
+/**
+ * @brief   Internal data structure of a set
+ * @details All engines keep the elements sorted by the key comparator and provide the same
+ *          operations, but differ in memory layout:
+ *          - @ref CMAGIC_SET_ENGINE_AVL_TREE allocates a separate node for every element. Iterators
+ *            stay valid until the element they point to is erased.
+ *          - @ref CMAGIC_SET_ENGINE_B_TREE stores copies of many keys in a single node spanning a
+ *            few cache lines, which makes lookups faster for large sets. Every element is still
+ *            allocated separately, so iteration is only slightly faster than with the AVL tree and
+ *            iterators stay valid until the element they point to is erased.
+ *          - @ref CMAGIC_SET_ENGINE_COMPACT_TREE keeps all elements in a single array and links
+ *            them by 32-bit indices, which takes less memory per element than the AVL tree.
+ *            Erasing an element keeps other iterators valid, but inserting one may invalidate all
+ *            iterators.
+ */
+typedef enum {
+
+    /**
+     * @brief   self-balancing binary search tree, the default engine
+     */
+    CMAGIC_SET_ENGINE_AVL_TREE,
+
+    /**
+     * @brief   cache-friendly B+ tree with multi-element nodes
+     */
+    CMAGIC_SET_ENGINE_B_TREE,
+
+    /**
+     * @brief   AVL tree stored in a contiguous array of compact nodes
+     */
+    CMAGIC_SET_ENGINE_COMPACT_TREE
+
+} cmagic_set_engine_t;
+
 void *
 cmagic_set_new(size_t key_size, cmagic_set_key_comparator_t key_comparator,
                const cmagic_memory_alloc_packet_t *alloc_packet);
 
+void *
+cmagic_set_new_ext(size_t key_size, cmagic_set_key_comparator_t key_comparator,
+                   const cmagic_memory_alloc_packet_t *alloc_packet, cmagic_set_engine_t engine);
+
+/**
+ * @brief   Memory for a set placed on the stack or inside another object
+ * @details Its content is private, the set is set up in it by @ref CMAGIC_SET_INIT.
+ */
+typedef struct {
+    void *private_data[6];
+} cmagic_set_storage_t;
+
+void *
+cmagic_set_init_ext(cmagic_set_storage_t *storage, size_t key_size,
+                    cmagic_set_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet, cmagic_set_engine_t engine);
+
+void
+cmagic_set_destroy(void *set_ptr);
+
 void
 cmagic_set_free(void *set_ptr);
 
+void *
+cmagic_set_copy(void *set_ptr, cmagic_set_copy_function_t copy,
+                cmagic_set_erase_destructor_t destructor);
+
 typedef struct {
     const void *key;
 } *cmagic_set_iterator_t;
@@ -82,6 +149,9 @@ cmagic_set_insert(void *set_ptr, const void *key);
 void
 cmagic_set_erase(void *set_ptr, const void *key, cmagic_set_erase_destructor_t destructor);
 
+void
+cmagic_set_clear_ext(void *set_ptr, cmagic_set_erase_destructor_t destructor);
+
 void
 cmagic_set_clear(void *set_ptr);
 
@@ -103,6 +173,70 @@ cmagic_set_iterator_prev(cmagic_set_iterator_t iterator);
 cmagic_set_iterator_t
 cmagic_set_find(void *set_ptr, const void *key);
 
+cmagic_set_iterator_t
+cmagic_set_lower_bound(void *set_ptr, const void *key);
+
+cmagic_set_iterator_t
+cmagic_set_upper_bound(void *set_ptr, const void *key);
+
+/**
+ * @brief   Range of set elements
+ * @details Contains all elements starting from @c begin up to, but not including, @c end. The range
+ *          is empty if both iterators are equal.
+ */
+typedef struct {
+
+    /**
+     * @brief   iterator pointing to the first element of the range or @c NULL if the range starts
+     *          past the last element of the set
+     */
+    cmagic_set_iterator_t begin;
+
+    /**
+     * @brief   iterator pointing to the first element after the range or @c NULL if the range ends
+     *          at the last element of the set
+     */
+    cmagic_set_iterator_t end;
+
+} cmagic_set_range_t;
+
+cmagic_set_range_t
+cmagic_set_equal_range(void *set_ptr, const void *key);
+
+cmagic_set_iterator_t
+cmagic_set_find_by(void *set_ptr, const void *key, cmagic_set_key_comparator_t key_comparator);
+
+cmagic_set_iterator_t
+cmagic_set_lower_bound_by(void *set_ptr, const void *key,
+                          cmagic_set_key_comparator_t key_comparator);
+
+cmagic_set_iterator_t
+cmagic_set_upper_bound_by(void *set_ptr, const void *key,
+                          cmagic_set_key_comparator_t key_comparator);
+
+cmagic_set_range_t
+cmagic_set_equal_range_by(void *set_ptr, const void *key,
+                          cmagic_set_key_comparator_t key_comparator);
+
+void
+cmagic_set_erase_by(void *set_ptr, const void *key, cmagic_set_key_comparator_t key_comparator,
+                    cmagic_set_erase_destructor_t destructor);
+
+void *
+cmagic_set_union(void *set1_ptr, void *set2_ptr, cmagic_set_copy_function_t copy);
+
+void *
+cmagic_set_intersection(void *set1_ptr, void *set2_ptr, cmagic_set_copy_function_t copy);
+
+void *
+cmagic_set_difference(void *set1_ptr, void *set2_ptr, cmagic_set_copy_function_t copy);
+
+bool
+cmagic_set_split(void *set_ptr, const void *key, void *right_set_ptr);
+
+bool
+cmagic_set_join(void *set_ptr, void *right_set_ptr);
+
 const cmagic_memory_alloc_packet_t *
 cmagic_set_get_alloc_packet(void *set_ptr);
 
@@ -124,6 +258,60 @@ cmagic_set_get_alloc_packet(void *set_ptr);
 #define CMAGIC_SET_NEW(key_type, key_comparator, alloc_packet) \
     ((CMAGIC_SET(key_type))cmagic_set_new(sizeof(key_type), (key_comparator), (alloc_packet)))
 
+/**
+ * @brief   Allocates and returns an address of a newly created empty set using the given internal
+ *          data structure.
+ * @param   key_type type of set elements
+ * @param   key_comparator function of type @ref cmagic_set_key_comparator_t determining the order
+ *          of the elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @param   engine @ref cmagic_set_engine_t internal data structure of the set
+ * @return  a new empty set
+ */
+#define CMAGIC_SET_NEW_EXT(key_type, key_comparator, alloc_packet, engine) \
+    ((CMAGIC_SET(key_type))cmagic_set_new_ext(sizeof(key_type), (key_comparator), (alloc_packet), \
+    (engine)))
+
+/**
+ * @brief   Sets up an empty set in @p storage without any allocation.
+ * @details The set allocates memory only when the first element is inserted, so an empty set costs
+ *          no dynamic memory at all. Resources of the set must be released by
+ *          @ref CMAGIC_SET_DESTROY, not @ref CMAGIC_SET_FREE.
+ * @param   storage pointer to @ref cmagic_set_storage_t, which must outlive the set
+ * @param   key_type type of set elements
+ * @param   key_comparator function of type @ref cmagic_set_key_comparator_t determining the order
+ *          of the elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @return  an empty set, never @c NULL
+ */
+#define CMAGIC_SET_INIT(storage, key_type, key_comparator, alloc_packet) \
+    CMAGIC_SET_INIT_EXT(storage, key_type, key_comparator, alloc_packet, CMAGIC_SET_ENGINE_AVL_TREE)
+
+/**
+ * @brief   Sets up an empty set in @p storage using the given internal data structure.
+ * @details Same as @ref CMAGIC_SET_INIT.
+ * @param   storage pointer to @ref cmagic_set_storage_t, which must outlive the set
+ * @param   key_type type of set elements
+ * @param   key_comparator function of type @ref cmagic_set_key_comparator_t determining the order
+ *          of the elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @param   engine @ref cmagic_set_engine_t internal data structure of the set
+ * @return  an empty set, never @c NULL
+ */
+#define CMAGIC_SET_INIT_EXT(storage, key_type, key_comparator, alloc_packet, engine) \
+    ((CMAGIC_SET(key_type))cmagic_set_init_ext((storage), sizeof(key_type), (key_comparator), \
+    (alloc_packet), (engine)))
+
+/**
+ * @brief   Releases the resources of a set initialized before by @ref CMAGIC_SET_INIT.
+ * @details The set is left empty and can be used again. Its storage is not released.
+ * @param   cmagic_set a set initialized before with @ref CMAGIC_SET_INIT
+ */
+#define CMAGIC_SET_DESTROY(cmagic_set) cmagic_set_destroy((void*)(cmagic_set))
+
 /**
  * @brief   Frees the resources allocated by the set before.
  * @details Must not use @p cmagic_set after free.
@@ -131,6 +319,32 @@ cmagic_set_get_alloc_packet(void *set_ptr);
  */
 #define CMAGIC_SET_FREE(cmagic_set) cmagic_set_free((void*)(cmagic_set))
 
+/**
+ * @brief   Allocates and returns a copy of the set
+ * @details With @ref CMAGIC_SET_ENGINE_AVL_TREE the shape of the tree is duplicated node by node,
+ *          other engines build the copy from the sorted elements. Either way no key is compared
+ *          and the whole operation takes linear time. The copy uses the same comparator, allocator
+ *          and engine. Keys are copied byte by byte.
+ * @param   key_type type of set elements
+ * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
+ * @return  a new set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_SET_COPY(key_type, cmagic_set) \
+    CMAGIC_SET_COPY_EXT(key_type, cmagic_set, NULL, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_SET_COPY but initializes the copied keys with a user defined
+ *          function
+ * @param   key_type type of set elements
+ * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   copy function of type @ref cmagic_set_copy_function_t to be called on every new key
+ * @param   destructor function of type @ref cmagic_set_erase_destructor_t to be called on the keys
+ *          copied so far if the allocation fails, may be @c NULL
+ * @return  a new set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_SET_COPY_EXT(key_type, cmagic_set, copy, destructor) \
+    ((CMAGIC_SET(key_type))cmagic_set_copy((void*)(cmagic_set), (copy), (destructor)))
+
 /**
  * @brief   Allocates space for a new element but does not initialize it.
  * @details New element is allocated only if it doesn't already exist in the set.
@@ -178,6 +392,16 @@ cmagic_set_get_alloc_packet(void *set_ptr);
  */
 #define CMAGIC_SET_ERASE(cmagic_set, key) CMAGIC_SET_ERASE_EXT(cmagic_set, key, NULL)
 
+/**
+ * @brief   Extended version of @ref CMAGIC_SET_CLEAR
+ * @details All elements are removed in a single pass over the internal tree, without recursion.
+ * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   destructor function of type @ref cmagic_set_erase_destructor_t to be called on every
+ *          key right before deleting it. Elements are visited in unspecified order.
+ */
+#define CMAGIC_SET_CLEAR_EXT(cmagic_set, destructor) \
+    cmagic_set_clear_ext((void*)(cmagic_set), (destructor))
+
 /**
  * @brief   Removes all elements from the set
  * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
@@ -233,6 +457,97 @@ cmagic_set_get_alloc_packet(void *set_ptr);
 #define CMAGIC_SET_FIND(cmagic_set, key) (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_set), *(key)), \
     cmagic_set_find((void*)(cmagic_set), (key)))
 
+/**
+ * @brief   Returns an iterator pointing to the first element in the container which is not
+ *          considered to go before @p key
+ * @details Together with @ref CMAGIC_SET_ITERATOR_NEXT allows to visit a range of elements in
+ *          O(log n + k) time, where k is the number of visited elements.
+ * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   key pointer to a value to be compared with
+ * @return  an iterator to the first element equivalent to or going after @p key, or @c NULL if all
+ *          elements go before @p key
+ */
+#define CMAGIC_SET_LOWER_BOUND(cmagic_set, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_set), *(key)), \
+    cmagic_set_lower_bound((void*)(cmagic_set), (key)))
+
+/**
+ * @brief   Returns an iterator pointing to the first element in the container which is considered
+ *          to go after @p key
+ * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   key pointer to a value to be compared with
+ * @return  an iterator to the first element going after @p key, or @c NULL if no such element
+ *          exists
+ */
+#define CMAGIC_SET_UPPER_BOUND(cmagic_set, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_set), *(key)), \
+    cmagic_set_upper_bound((void*)(cmagic_set), (key)))
+
+/**
+ * @brief   Returns the bounds of a range that includes all the elements in the container which
+ *          are equivalent to @p key
+ * @details Because elements in a set are unique, the range contains at most one element. It is
+ *          equivalent to a pair of @ref CMAGIC_SET_LOWER_BOUND and @ref CMAGIC_SET_UPPER_BOUND
+ *          but performs only one search in the internal binary tree.
+ * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   key pointer to a value to be compared with
+ * @return  @ref cmagic_set_range_t of the matching elements
+ */
+#define CMAGIC_SET_EQUAL_RANGE(cmagic_set, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_set), *(key)), \
+    cmagic_set_equal_range((void*)(cmagic_set), (key)))
+
+/**
+ * @brief   Searches the container for an element equivalent to @p key, which may be of another type
+ *          than the keys of the set
+ * @details Allows to search e.g. a set of strings by a string literal without constructing a
+ *          temporary key. @p key_comparator is called with @p key as the first argument and a key
+ *          of the set as the second one.
+ * @warning @p key_comparator must order @p key consistently with the comparator of the set.
+ * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   key pointer to a key of any type to be searched for
+ * @param   key_comparator function of type @ref cmagic_set_key_comparator_t comparing @p key with
+ *          the keys of the set
+ * @return  an iterator to the element, if @p key is found, or @c NULL otherwise
+ */
+#define CMAGIC_SET_FIND_BY(cmagic_set, key, key_comparator) \
+    cmagic_set_find_by((void*)(cmagic_set), (key), (key_comparator))
+
+/**
+ * @brief   Version of @ref CMAGIC_SET_LOWER_BOUND taking a key of any type, see
+ *          @ref CMAGIC_SET_FIND_BY
+ */
+#define CMAGIC_SET_LOWER_BOUND_BY(cmagic_set, key, key_comparator) \
+    cmagic_set_lower_bound_by((void*)(cmagic_set), (key), (key_comparator))
+
+/**
+ * @brief   Version of @ref CMAGIC_SET_UPPER_BOUND taking a key of any type, see
+ *          @ref CMAGIC_SET_FIND_BY
+ */
+#define CMAGIC_SET_UPPER_BOUND_BY(cmagic_set, key, key_comparator) \
+    cmagic_set_upper_bound_by((void*)(cmagic_set), (key), (key_comparator))
+
+/**
+ * @brief   Version of @ref CMAGIC_SET_EQUAL_RANGE taking a key of any type, see
+ *          @ref CMAGIC_SET_FIND_BY
+ */
+#define CMAGIC_SET_EQUAL_RANGE_BY(cmagic_set, key, key_comparator) \
+    cmagic_set_equal_range_by((void*)(cmagic_set), (key), (key_comparator))
+
+/**
+ * @brief   Version of @ref CMAGIC_SET_ERASE_EXT taking a key of any type, see
+ *          @ref CMAGIC_SET_FIND_BY
+ */
+#define CMAGIC_SET_ERASE_BY_EXT(cmagic_set, key, key_comparator, destructor) \
+    cmagic_set_erase_by((void*)(cmagic_set), (key), (key_comparator), (destructor))
+
+/**
+ * @brief   Version of @ref CMAGIC_SET_ERASE taking a key of any type, see
+ *          @ref CMAGIC_SET_FIND_BY
+ */
+#define CMAGIC_SET_ERASE_BY(cmagic_set, key, key_comparator) \
+    CMAGIC_SET_ERASE_BY_EXT(cmagic_set, key, key_comparator, NULL)
+
 /**
  * @brief   Helper macro for retrieving the key value from the iterator
  * @warning @p iterator must not be @c NULL
@@ -243,6 +558,120 @@ cmagic_set_get_alloc_packet(void *set_ptr);
 #define CMAGIC_SET_GET_KEY(key_type, iterator) \
     (assert(iterator), assert((iterator)->key), *((const key_type*)(iterator)->key))
 
+/**
+ * @brief   Allocates and returns a new set containing the elements present in any of two sets
+ * @details Both sets are traversed once in order and the result is built directly from the merged
+ *          sequence, so the whole operation takes linear time instead of a search per element.
+ *          The new set uses the comparator, the allocator and the engine of @p cmagic_set1. Keys
+ *          are copied byte by byte.
+ * @warning Both sets must be ordered by equivalent comparators.
+ * @param   key_type type of set elements
+ * @param   cmagic_set1 a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   cmagic_set2 a set of the same type
+ * @return  a new set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_SET_UNION(key_type, cmagic_set1, cmagic_set2) \
+    CMAGIC_SET_UNION_EXT(key_type, cmagic_set1, cmagic_set2, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_SET_UNION but initializes the copied keys with a user defined
+ *          function
+ * @param   key_type type of set elements
+ * @param   cmagic_set1 a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   cmagic_set2 a set of the same type
+ * @param   copy function of type @ref cmagic_set_copy_function_t to be called on every new key
+ * @return  a new set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_SET_UNION_EXT(key_type, cmagic_set1, cmagic_set2, copy) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_set1), *(cmagic_set2)), \
+    (CMAGIC_SET(key_type))cmagic_set_union((void*)(cmagic_set1), (void*)(cmagic_set2), \
+    (copy)))
+
+/**
+ * @brief   Allocates and returns a new set containing the elements present in both sets
+ * @details Works in linear time like @ref CMAGIC_SET_UNION.
+ * @warning Both sets must be ordered by equivalent comparators.
+ * @param   key_type type of set elements
+ * @param   cmagic_set1 a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   cmagic_set2 a set of the same type
+ * @return  a new set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_SET_INTERSECTION(key_type, cmagic_set1, cmagic_set2) \
+    CMAGIC_SET_INTERSECTION_EXT(key_type, cmagic_set1, cmagic_set2, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_SET_INTERSECTION but initializes the copied keys with a user defined
+ *          function
+ * @param   key_type type of set elements
+ * @param   cmagic_set1 a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   cmagic_set2 a set of the same type
+ * @param   copy function of type @ref cmagic_set_copy_function_t to be called on every new key
+ * @return  a new set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_SET_INTERSECTION_EXT(key_type, cmagic_set1, cmagic_set2, copy) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_set1), *(cmagic_set2)), \
+    (CMAGIC_SET(key_type))cmagic_set_intersection((void*)(cmagic_set1), (void*)(cmagic_set2), \
+    (copy)))
+
+/**
+ * @brief   Allocates and returns a new set containing the elements of @p cmagic_set1 which are
+ *          not present in @p cmagic_set2
+ * @details Works in linear time like @ref CMAGIC_SET_UNION.
+ * @warning Both sets must be ordered by equivalent comparators.
+ * @param   key_type type of set elements
+ * @param   cmagic_set1 a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   cmagic_set2 a set of the same type
+ * @return  a new set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_SET_DIFFERENCE(key_type, cmagic_set1, cmagic_set2) \
+    CMAGIC_SET_DIFFERENCE_EXT(key_type, cmagic_set1, cmagic_set2, NULL)
+
+/**
+ * @brief   Same as @ref CMAGIC_SET_DIFFERENCE but initializes the copied keys with a user defined
+ *          function
+ * @param   key_type type of set elements
+ * @param   cmagic_set1 a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   cmagic_set2 a set of the same type
+ * @param   copy function of type @ref cmagic_set_copy_function_t to be called on every new key
+ * @return  a new set or @c NULL if the allocation has failed
+ */
+#define CMAGIC_SET_DIFFERENCE_EXT(key_type, cmagic_set1, cmagic_set2, copy) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_set1), *(cmagic_set2)), \
+    (CMAGIC_SET(key_type))cmagic_set_difference((void*)(cmagic_set1), (void*)(cmagic_set2), \
+    (copy)))
+
+/**
+ * @brief   Moves all elements which do not go before @p key to @p right_set
+ * @details With @ref CMAGIC_SET_ENGINE_AVL_TREE whole subtrees are relinked and the operation takes
+ *          logarithmic time. Other engines rebuild both sets in linear time. Keys are never copied.
+ *          Iterators of moved elements stay valid only with the AVL tree engine.
+ * @warning @p right_set must be empty and created with the same engine and memory allocation
+ *          functions as @p cmagic_set.
+ * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   key pointer to the first value to be moved
+ * @param   right_set an empty set of the same type
+ * @return  @c true on success, @c false if the allocation has failed and both sets are unchanged
+ */
+#define CMAGIC_SET_SPLIT(cmagic_set, key, right_set) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_set), *(key)), \
+    CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_set), *(right_set)), \
+    cmagic_set_split((void*)(cmagic_set), (key), (void*)(right_set)))
+
+/**
+ * @brief   Moves all elements of @p right_set to @p cmagic_set
+ * @details Inverse of @ref CMAGIC_SET_SPLIT. With @ref CMAGIC_SET_ENGINE_AVL_TREE the operation
+ *          takes logarithmic time, other engines rebuild the set in linear time. Keys are never
+ *          copied.
+ * @warning All elements of @p right_set must go after all elements of @p cmagic_set. Both sets
+ *          must use the same engine and memory allocation functions.
+ * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
+ * @param   right_set a set of the same type, empty on success
+ * @return  @c true on success, @c false if the allocation has failed and both sets are unchanged
+ */
+#define CMAGIC_SET_JOIN(cmagic_set, right_set) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(cmagic_set), *(right_set)), \
+    cmagic_set_join((void*)(cmagic_set), (void*)(right_set)))
+
 /**
  * @brief   Retrieves @ref cmagic_memory_alloc_packet_t associated with the set
  * @param   cmagic_set a set allocated before with @ref CMAGIC_SET_NEW
@@ -42,6 +42,17 @@ extern "C" {
  */
 #define CMAGIC_UTILS_MAX(val1, val2) ((val1) > (val2) ? (val1) : (val2))
 
+/**
+ * @brief   Hints the processor to start loading the memory at the given address into the cache.
+ * @details Has no effect if the compiler doesn't provide a prefetch builtin. Never faults, even on
+ *          an invalid address.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define CMAGIC_UTILS_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CMAGIC_UTILS_PREFETCH(address) ((void)(address))
+#endif
+
 /**
  * @brief   Increases the address if it's not aligned.
  * @param   unaligned_addr      original address
@@ -62,6 +73,38 @@ uintptr_t
 cmagic_utils_align_address_down(uintptr_t unaligned_addr,
                                 size_t required_alignment);
 
+/**
+ * @brief   Compares two @c int32_t keys
+ * @details Built-in key comparators may be passed to a map or a set like any other comparator.
+ *          The containers recognize them and compare the keys inline in their search loops instead
+ *          of calling the comparator for every visited element, which makes lookups of integer
+ *          keys considerably faster.
+ * @param   key1 pointer to the first key
+ * @param   key2 pointer to the second key
+ * @return  negative value, 0 or positive value if the first key is respectively less than, equal
+ *          to or greater than the second key
+ */
+int
+cmagic_utils_compare_int32(const void *key1, const void *key2);
+
+/**
+ * @brief   Compares two @c uint32_t keys, see @ref cmagic_utils_compare_int32
+ */
+int
+cmagic_utils_compare_uint32(const void *key1, const void *key2);
+
+/**
+ * @brief   Compares two @c int64_t keys, see @ref cmagic_utils_compare_int32
+ */
+int
+cmagic_utils_compare_int64(const void *key1, const void *key2);
+
+/**
+ * @brief   Compares two @c uint64_t keys, see @ref cmagic_utils_compare_int32
+ */
+int
+cmagic_utils_compare_uint64(const void *key1, const void *key2);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
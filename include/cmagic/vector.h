@@ -18,9 +18,62 @@
 extern "C" {
 #endif
 
+/**
+ * @brief   Rules by which a vector changes its capacity
+ * @details The capacity grows only when an element is added to a full vector. It shrinks only on
+ *          explicit request by @ref CMAGIC_VECTOR_SHRINK_TO_FIT, unless @c auto_shrink is set.
+ */
+typedef struct {
+
+    /**
+     * @brief   capacity after growth in percents of the capacity before, must be greater than 100
+     */
+    size_t growth_percent;
+
+    /**
+     * @brief   if @c true, removing an element halves the capacity when the size drops to a quarter
+     *          of it, otherwise removing elements never reallocates the data
+     */
+    bool auto_shrink;
+
+    /**
+     * @brief   capacity allocated for the first element, the capacity of a non-empty vector is
+     *          never reduced below it
+     */
+    size_t min_capacity;
+
+} cmagic_vector_policy_t;
+
+/**
+ * @brief   Policy used by @ref CMAGIC_VECTOR_NEW: the capacity doubles and never shrinks by itself.
+ */
+static const cmagic_vector_policy_t CMAGIC_VECTOR_POLICY_DEFAULT = {
+    200, false, 5
+};
+
 void **
 cmagic_vector_new(size_t member_size, const cmagic_memory_alloc_packet_t *alloc_packet);
 
+void **
+cmagic_vector_new_ext(size_t member_size, const cmagic_memory_alloc_packet_t *alloc_packet,
+                      const cmagic_vector_policy_t *policy);
+
+/**
+ * @brief   Memory for a vector placed on the stack or inside another object
+ * @details Its content is private, the vector is set up in it by @ref CMAGIC_VECTOR_INIT.
+ */
+typedef struct {
+    void *private_data[9];
+} cmagic_vector_storage_t;
+
+void **
+cmagic_vector_init_ext(cmagic_vector_storage_t *storage, size_t member_size,
+                       const cmagic_memory_alloc_packet_t *alloc_packet,
+                       const cmagic_vector_policy_t *policy);
+
+void
+cmagic_vector_destroy(void **vector_ptr);
+
 void
 cmagic_vector_free(void **vector_ptr);
 
@@ -33,9 +86,42 @@ cmagic_vector_push_back(void **vector_ptr, const void *new_element_ptr);
 void
 cmagic_vector_pop_back(void **vector_ptr);
 
+void
+cmagic_vector_truncate(void **vector_ptr, size_t size);
+
+void
+cmagic_vector_clear(void **vector_ptr);
+
+bool
+cmagic_vector_resize(void **vector_ptr, size_t size);
+
+bool
+cmagic_vector_append(void **vector_ptr, const void *src, size_t count);
+
+bool
+cmagic_vector_insert_range(void **vector_ptr, size_t pos, const void *src, size_t count);
+
+void
+cmagic_vector_erase_range(void **vector_ptr, size_t first, size_t last);
+
+bool
+cmagic_vector_reserve(void **vector_ptr, size_t capacity);
+
+void
+cmagic_vector_shrink_to_fit(void **vector_ptr);
+
 size_t
 cmagic_vector_size(void **vector_ptr);
 
+size_t
+cmagic_vector_capacity(void **vector_ptr);
+
+const cmagic_vector_policy_t *
+cmagic_vector_get_policy(void **vector_ptr);
+
+void
+cmagic_vector_set_policy(void **vector_ptr, const cmagic_vector_policy_t *policy);
+
 const cmagic_memory_alloc_packet_t *
 cmagic_vector_get_alloc_packet(void **vector_ptr);
 
@@ -48,7 +134,8 @@ cmagic_vector_get_alloc_packet(void **vector_ptr);
 /**
  * @brief   Gets an address to the beginning of the vector data.
  * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
- * @return  address of the first element in the vector
+ * @return  address of the first element in the vector, @c NULL if the vector has no data
+ *          allocated
  */
 #define CMAGIC_VECTOR_DATA(cmagic_vector) (*(cmagic_vector))
 
@@ -63,6 +150,8 @@ cmagic_vector_get_alloc_packet(void **vector_ptr);
 
 /**
  * @brief   Allocates and returns an address of a newly created empty vector.
+ * @details Only the vector itself is allocated, the data is allocated when the first element is
+ *          added.
  * @param   type type of vector elements
  * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
  *          functions
@@ -71,6 +160,53 @@ cmagic_vector_get_alloc_packet(void **vector_ptr);
 #define CMAGIC_VECTOR_NEW(type, alloc_packet) \
     ((CMAGIC_VECTOR(type))cmagic_vector_new(sizeof(type), (alloc_packet)))
 
+/**
+ * @brief   Allocates and returns an address of a newly created empty vector with the given capacity
+ *          policy.
+ * @param   type type of vector elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @param   policy pointer to @ref cmagic_vector_policy_t, which is copied into the vector
+ * @return  a new empty vector
+ */
+#define CMAGIC_VECTOR_NEW_EXT(type, alloc_packet, policy) \
+    ((CMAGIC_VECTOR(type))cmagic_vector_new_ext(sizeof(type), (alloc_packet), (policy)))
+
+/**
+ * @brief   Sets up an empty vector in @p storage without any allocation.
+ * @details The data is allocated when the first element is added, so an empty vector costs no
+ *          dynamic memory at all. Resources of the vector must be released by
+ *          @ref CMAGIC_VECTOR_DESTROY, not @ref CMAGIC_VECTOR_FREE.
+ * @param   storage pointer to @ref cmagic_vector_storage_t, which must outlive the vector
+ * @param   type type of vector elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @return  an empty vector, never @c NULL
+ */
+#define CMAGIC_VECTOR_INIT(storage, type, alloc_packet) \
+    CMAGIC_VECTOR_INIT_EXT(storage, type, alloc_packet, &CMAGIC_VECTOR_POLICY_DEFAULT)
+
+/**
+ * @brief   Sets up an empty vector in @p storage with the given capacity policy.
+ * @details Same as @ref CMAGIC_VECTOR_INIT.
+ * @param   storage pointer to @ref cmagic_vector_storage_t, which must outlive the vector
+ * @param   type type of vector elements
+ * @param   alloc_packet @ref cmagic_memory_alloc_packet_t suite of dynamic memory managing
+ *          functions
+ * @param   policy pointer to @ref cmagic_vector_policy_t, which is copied into the vector
+ * @return  an empty vector, never @c NULL
+ */
+#define CMAGIC_VECTOR_INIT_EXT(storage, type, alloc_packet, policy) \
+    ((CMAGIC_VECTOR(type))cmagic_vector_init_ext((storage), sizeof(type), (alloc_packet), \
+    (policy)))
+
+/**
+ * @brief   Releases the data of a vector initialized before by @ref CMAGIC_VECTOR_INIT.
+ * @details The vector is left empty and can be used again. Its storage is not released.
+ * @param   cmagic_vector a vector initialized before with @ref CMAGIC_VECTOR_INIT
+ */
+#define CMAGIC_VECTOR_DESTROY(cmagic_vector) cmagic_vector_destroy((void**)(cmagic_vector))
+
 /**
  * @brief   Frees the resources allocated by the vector before.
  * @details Must not use @p cmagic_vector after free.
@@ -102,18 +238,153 @@ cmagic_vector_get_alloc_packet(void **vector_ptr);
 
 /**
  * @brief   Deallocates the last element in the vector.
+ * @details The data is reallocated only if the vector policy has @c auto_shrink set.
  * @warning Do not use this without ensuring the vector is not empty.
  * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
  */
 #define CMAGIC_VECTOR_POP_BACK(cmagic_vector) cmagic_vector_pop_back((void**)(cmagic_vector))
 
 /**
- * @brief   Deallocates the last element in the vector.
- * @warning Do not use this without ensuring the vector is not empty.
+ * @brief   Deallocates the elements past the first @p size elements in constant time.
+ * @details If the vector policy has @c auto_shrink set, the data is reallocated at most once, to
+ *          the capacity that removing the elements one by one would end with.
+ * @warning @p size must not be greater than the size of the vector.
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @param   size new number of elements
+ */
+#define CMAGIC_VECTOR_TRUNCATE(cmagic_vector, size) \
+    cmagic_vector_truncate((void**)(cmagic_vector), (size))
+
+/**
+ * @brief   Deallocates all elements of the vector in constant time.
+ * @details Same as @ref CMAGIC_VECTOR_TRUNCATE to zero elements.
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ */
+#define CMAGIC_VECTOR_CLEAR(cmagic_vector) cmagic_vector_clear((void**)(cmagic_vector))
+
+/**
+ * @brief   Changes the number of elements in the vector.
+ * @details A smaller @p size truncates the vector like @ref CMAGIC_VECTOR_TRUNCATE. A greater
+ *          @p size allocates the new elements at the end without initializing them, which takes
+ *          at most one reallocation.
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @param   size new number of elements
+ * @return  @c true on success, @c false if there's not sufficient memory space and the vector was
+ *          not modified
+ */
+#define CMAGIC_VECTOR_RESIZE(cmagic_vector, size) \
+    cmagic_vector_resize((void**)(cmagic_vector), (size))
+
+/**
+ * @brief   Copies @p count elements from the array @p src to the end of the vector.
+ * @details Takes at most one reallocation and a single copy of the whole array.
+ * @warning @p src must not point into the vector itself.
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @param   src pointer to the first of the elements to be copied
+ * @param   count number of elements to be copied
+ * @return  @c true on success, @c false if there's not sufficient memory space and the vector was
+ *          not modified
+ */
+#define CMAGIC_VECTOR_APPEND(cmagic_vector, src, count) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(**(cmagic_vector), *(src)), \
+    cmagic_vector_append((void**)(cmagic_vector), (src), (count)))
+
+/**
+ * @brief   Copies @p count elements from the array @p src into the vector before the element at
+ *          position @p pos.
+ * @details The elements from @p pos to the end are moved by a single @c memmove, the new elements
+ *          are copied by a single @c memcpy, with at most one reallocation before.
+ * @warning @p src must not point into the vector itself.
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @param   pos position of the first new element, not greater than the size of the vector
+ * @param   src pointer to the first of the elements to be copied
+ * @param   count number of elements to be copied
+ * @return  @c true on success, @c false if there's not sufficient memory space and the vector was
+ *          not modified
+ */
+#define CMAGIC_VECTOR_INSERT_RANGE(cmagic_vector, pos, src, count) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(**(cmagic_vector), *(src)), \
+    cmagic_vector_insert_range((void**)(cmagic_vector), (pos), (src), (count)))
+
+/**
+ * @brief   Allocates space for @p count new elements before the element at position @p pos but
+ *          does not initialize them.
+ * @details Same as @ref CMAGIC_VECTOR_INSERT_RANGE, except the new elements are left to be
+ *          initialized by the caller.
  * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @param   pos position of the first new element, not greater than the size of the vector
+ * @param   count number of new elements
+ * @return  @c true on success, @c false if there's not sufficient memory space and the vector was
+ *          not modified
+ */
+#define CMAGIC_VECTOR_INSERT_UNINITIALIZED(cmagic_vector, pos, count) \
+    cmagic_vector_insert_range((void**)(cmagic_vector), (pos), NULL, (count))
+
+/**
+ * @brief   Deallocates the elements from position @p first up to, but not including, @p last.
+ * @details The following elements are moved by a single @c memmove. The data is reallocated only
+ *          if the vector policy has @c auto_shrink set.
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @param   first position of the first element to be removed
+ * @param   last position past the last element to be removed, not greater than the size of the
+ *          vector
+ */
+#define CMAGIC_VECTOR_ERASE_RANGE(cmagic_vector, first, last) \
+    cmagic_vector_erase_range((void**)(cmagic_vector), (first), (last))
+
+/**
+ * @brief   Returns the number of elements in the vector.
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @return  number of elements in the vector
  */
 #define CMAGIC_VECTOR_SIZE(cmagic_vector) cmagic_vector_size((void**)(cmagic_vector))
 
+/**
+ * @brief   Returns the number of elements the vector can hold before it has to reallocate its data
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @return  capacity of the vector, never less than its size
+ */
+#define CMAGIC_VECTOR_CAPACITY(cmagic_vector) cmagic_vector_capacity((void**)(cmagic_vector))
+
+/**
+ * @brief   Makes room for at least @p capacity elements with a single reallocation
+ * @details Adding elements up to @p capacity doesn't reallocate the data afterwards, so pointers
+ *          to the elements stay valid. Function does nothing if the capacity is already
+ *          sufficient.
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @param   capacity requested number of elements
+ * @return  @c true on success, @c false if there's not sufficient memory space and the vector was
+ *          not modified
+ */
+#define CMAGIC_VECTOR_RESERVE(cmagic_vector, capacity) \
+    cmagic_vector_reserve((void**)(cmagic_vector), (capacity))
+
+/**
+ * @brief   Reduces the capacity of the vector to its size
+ * @details The capacity never drops below the minimum capacity of the vector policy, except for
+ *          an empty vector, which releases its data entirely. If the reallocation fails, the
+ *          vector keeps its capacity.
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ */
+#define CMAGIC_VECTOR_SHRINK_TO_FIT(cmagic_vector) \
+    cmagic_vector_shrink_to_fit((void**)(cmagic_vector))
+
+/**
+ * @brief   Returns the capacity policy of the vector
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @return  pointer to @ref cmagic_vector_policy_t valid until the vector is freed
+ */
+#define CMAGIC_VECTOR_GET_POLICY(cmagic_vector) cmagic_vector_get_policy((void**)(cmagic_vector))
+
+/**
+ * @brief   Replaces the capacity policy of the vector
+ * @details The current capacity is kept, the new policy applies to the following operations.
+ * @param   cmagic_vector a vector allocated before with @ref CMAGIC_VECTOR_NEW
+ * @param   policy pointer to @ref cmagic_vector_policy_t, which is copied into the vector
+ */
+#define CMAGIC_VECTOR_SET_POLICY(cmagic_vector, policy) \
+    cmagic_vector_set_policy((void**)(cmagic_vector), (policy))
+
 /**
  * @brief   Extracts @ref cmagic_memory_alloc_packet_t which was used as an argument of @ref
  *          CMAGIC_VECTOR_NEW
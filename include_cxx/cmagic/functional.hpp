@@ -0,0 +1,96 @@
+/**
+ * @file    functional.hpp
+ * @brief   Function objects used by the ordered containers.
+ */
+
+#ifndef CMAGIC_FUNCTIONAL_HPP
+#define CMAGIC_FUNCTIONAL_HPP
+
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include "cmagic/utils.h"
+
+
+namespace cmagic {
+
+/**
+ * @brief   Function object comparing its arguments by @c operator<
+ * @details Unlike @c std::less it accepts arguments of two different types, so containers ordered
+ *          by it can look up keys of other types without converting them. It's the default order of
+ *          @ref map and @ref set.
+ */
+struct less {
+    using is_transparent = void;
+
+    template<typename T, typename U>
+    constexpr bool operator()(const T &lhs, const U &rhs) const {
+        return lhs < rhs;
+    }
+};
+
+/**
+ * @brief   Checks whether keys of type @p K can be looked up in a container of @p Key keys ordered
+ *          by @p Compare without converting them
+ * @details It's the case if @p Compare is transparent, i.e. defines @c is_transparent, and can
+ *          order @p K and @p Key both ways.
+ */
+template<typename Compare, typename Key, typename K, typename = void>
+struct is_transparent_key : std::false_type {};
+
+template<typename Compare, typename Key, typename K>
+struct is_transparent_key<Compare, Key, K, decltype(
+    static_cast<void>(std::declval<typename Compare::is_transparent *>()),
+    static_cast<void>(std::declval<const Compare &>()(std::declval<const K &>(),
+                                                      std::declval<const Key &>())),
+    static_cast<void>(std::declval<const Compare &>()(std::declval<const Key &>(),
+                                                      std::declval<const K &>())))>
+: std::integral_constant<bool, !std::is_same<typename std::decay<K>::type, Key>::value> {};
+
+/**
+ * @brief   Converts a comparison function object into a comparator of the C containers
+ * @details The function object must be stateless, since C comparators receive no context. Integer
+ *          keys ordered by @ref less or @c std::less are compared by the built-in comparators from
+ *          @ref utils.h, which the containers inline in their search loops. Other keys are compared
+ *          by a function calling the function object, which the compiler inlines into it.
+ */
+template<typename Key, typename Compare>
+struct key_comparator {
+    static_assert(std::is_empty<Compare>::value && std::is_default_constructible<Compare>::value,
+                  "comparison object must be stateless");
+
+    using function_type = int (*)(const void *key1, const void *key2);
+
+    static int compare(const void *void_key1, const void *void_key2) {
+        const Key &key1 = *static_cast<const Key *>(void_key1);
+        const Key &key2 = *static_cast<const Key *>(void_key2);
+        if (Compare()(key1, key2)) {
+            return -1;
+        } else if (Compare()(key2, key1)) {
+            return 1;
+        } else {
+            return 0;
+        }
+    }
+
+    static function_type function() {
+        const bool is_natural_order = std::is_same<Compare, less>::value
+                                      || std::is_same<Compare, std::less<Key>>::value;
+        if (!is_natural_order || !std::is_integral<Key>::value || std::is_same<Key, bool>::value) {
+            return compare;
+        }
+
+        if (sizeof(Key) == sizeof(int32_t)) {
+            return std::is_signed<Key>::value ? cmagic_utils_compare_int32
+                                              : cmagic_utils_compare_uint32;
+        } else if (sizeof(Key) == sizeof(int64_t)) {
+            return std::is_signed<Key>::value ? cmagic_utils_compare_int64
+                                              : cmagic_utils_compare_uint64;
+        }
+        return compare;
+    }
+};
+
+} // namespace cmagic
+
+#endif /* CMAGIC_FUNCTIONAL_HPP */
@@ -0,0 +1,99 @@
+/**
+ * @file    hash.hpp
+ * @brief   Hash function objects used by the unordered containers.
+ * @details This is a wrapper over C implementation from @ref hash.h
+ */
+
+#ifndef CMAGIC_HASH_HPP
+#define CMAGIC_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include "cmagic/hash.h"
+
+
+namespace cmagic {
+
+/**
+ * @brief   Function object hashing values of type @p T, the default hash of @ref unordered_map
+ *          and @ref unordered_set
+ * @details Integers, enumerations, pointers, floating point numbers and strings are hashed by the
+ *          functions from @ref hash.h. Other types fall back to @c std::hash, so user types need to
+ *          specialize either @c std::hash or @c cmagic::hash.
+ */
+template<typename T, typename = void>
+struct hash : std::hash<T> {};
+
+/**
+ * @brief   Hash of integers and enumerations, which mixes all their bits
+ */
+template<typename T>
+struct hash<T, typename std::enable_if<std::is_integral<T>::value
+                                       || std::is_enum<T>::value>::type> {
+    size_t operator()(T value) const {
+        return static_cast<size_t>(cmagic_hash_mix64(static_cast<uint64_t>(value)));
+    }
+};
+
+/**
+ * @brief   Hash of pointers, which mixes their addresses
+ */
+template<typename T>
+struct hash<T *> {
+    size_t operator()(T *pointer) const {
+        return static_cast<size_t>(cmagic_hash_mix64(reinterpret_cast<uintptr_t>(pointer)));
+    }
+};
+
+/**
+ * @brief   Hash of @c float and @c double, which hashes their representation
+ * @details Both zeros compare equal, so they get the same hash. Wider types may have padding bits,
+ *          so they're left to @c std::hash.
+ */
+template<typename T>
+struct hash<T, typename std::enable_if<std::is_floating_point<T>::value
+                                       && sizeof(T) <= sizeof(uint64_t)>::type> {
+    size_t operator()(T value) const {
+        if (value == 0) {
+            value = 0;
+        }
+        unsigned char bytes[sizeof(T)] = {};
+        std::memcpy(bytes, &value, sizeof(T));
+        return static_cast<size_t>(cmagic_hash_bytes(bytes, sizeof(bytes), 0));
+    }
+};
+
+/**
+ * @brief   Hash of strings, which hashes their characters with @ref cmagic_hash_bytes
+ */
+template<typename CharT, typename Traits, typename Allocator>
+struct hash<std::basic_string<CharT, Traits, Allocator>> {
+    size_t operator()(const std::basic_string<CharT, Traits, Allocator> &string) const {
+        return static_cast<size_t>(cmagic_hash_bytes(string.data(), string.size() * sizeof(CharT),
+                                                     0));
+    }
+};
+
+/**
+ * @brief   Merges the hash of another value into the hash of the preceding ones
+ * @details See @ref cmagic_hash_combine. Example usage:
+ *          @code
+ *          size_t seed = 0;
+ *          cmagic::hash_combine(seed, point.x);
+ *          cmagic::hash_combine(seed, point.y);
+ *          @endcode
+ * @param   seed hash of the preceding values, updated with the hash of @p value
+ * @param   value value to be hashed by @ref hash
+ */
+template<typename T>
+void hash_combine(size_t &seed, const T &value) {
+    seed = static_cast<size_t>(cmagic_hash_combine(seed, hash<T>()(value)));
+}
+
+} // namespace cmagic
+
+#endif /* CMAGIC_HASH_HPP */
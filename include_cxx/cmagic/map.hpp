@@ -13,12 +13,13 @@
 #include <new>
 #include <type_traits>
 #include <utility>
+#include "cmagic/functional.hpp"
 #include "cmagic/map.h"
 
 
 namespace cmagic {
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Compare = less>
 class map {
 
 public:
@@ -37,83 +38,240 @@ public:
      */
     using value_type = std::pair<key_type, mapped_type>;
 
+    /**
+     * @brief   Type of the function object ordering the keys. It must be stateless.
+     */
+    using key_compare = Compare;
+
     /**
      * @brief   Type used to measure element size
      */
     using size_type = size_t;
 
-    class iterator {
+    /**
+     * @brief   Reference to a map element, obtained by dereferencing an iterator
+     * @details Elements are not stored as pairs, so the reference binds the key and the value
+     *          stored separately instead. Neither of them is copied. The value can be modified
+     *          unless the reference comes from a @ref map::const_iterator.
+     */
+    template<typename Mapped>
+    struct basic_reference {
+        const key_type &first;
+        Mapped &second;
+
+        /**
+         * @brief   Copies the referenced element
+         */
+        operator value_type() const {
+            return value_type(first, second);
+        }
+    };
+
+    /**
+     * @brief   Result of the arrow operator of an iterator, which gives access to the members of
+     *          @ref map::basic_reference
+     */
+    template<typename Mapped>
+    class basic_pointer {
+        basic_reference<Mapped> element;
+
+    public:
+        explicit basic_pointer(const basic_reference<Mapped> &element_arg) : element(element_arg) {}
+        const basic_reference<Mapped> *operator->() const { return &element; }
+    };
+
+    /**
+     * @brief   Bidirectional iterator over the map elements in the order of their keys
+     * @details Dereferencing the iterator doesn't copy anything. A mutable iterator converts to a
+     *          constant one.
+     */
+    template<bool is_const>
+    class basic_iterator {
+        friend class map;
+
+        template<bool other_is_const>
+        friend class basic_iterator;
+
+        using mapped_access_type =
+            typename std::conditional<is_const, const mapped_type, mapped_type>::type;
 
     public:
         using iterator_category = std::bidirectional_iterator_tag;
-        using const_pointer = const value_type*;
-        using const_reference = const value_type&;
+        using value_type = map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = basic_reference<mapped_access_type>;
+        using pointer = basic_pointer<mapped_access_type>;
 
     private:
         cmagic_map_iterator_t internal_iterator;
-        value_type adapter;
 
-        constexpr value_type make_adapter() {
+    public:
+        basic_iterator() : internal_iterator(nullptr) {}
+        basic_iterator(cmagic_map_iterator_t initializer) : internal_iterator(initializer) {}
+
+        template<bool other_is_const,
+                 typename = typename std::enable_if<is_const && !other_is_const>::type>
+        basic_iterator(const basic_iterator<other_is_const> &other)
+        : internal_iterator(other.internal_iterator) {}
+
+        reference operator*() const {
             assert(internal_iterator);
-            return std::make_pair(*static_cast<const key_type *>(internal_iterator->key),
-                                  *static_cast<mapped_type *>(internal_iterator->value));
+            return reference {*static_cast<const key_type *>(internal_iterator->key),
+                              *static_cast<mapped_type *>(internal_iterator->value)};
         }
 
-        void update_adapter() {
-            if (internal_iterator) {
-                adapter = make_adapter();
-            }
-        }
+        pointer operator->() const { return pointer(**this); }
 
-        void increment() {
+        basic_iterator &operator++() {
             assert(internal_iterator);
             internal_iterator = CMAGIC_MAP_ITERATOR_NEXT(internal_iterator);
-            update_adapter();
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator to_return = *this;
+            ++(*this);
+            return to_return;
         }
 
-        void decrement() {
+        basic_iterator &operator--() {
             assert(internal_iterator);
             internal_iterator = CMAGIC_MAP_ITERATOR_PREV(internal_iterator);
-            update_adapter();
+            return *this;
+        }
+
+        basic_iterator operator--(int) {
+            basic_iterator to_return = *this;
+            --(*this);
+            return to_return;
+        }
+
+        template<bool other_is_const>
+        bool operator==(const basic_iterator<other_is_const> &other) const {
+            return this->internal_iterator == other.internal_iterator;
+        }
+
+        template<bool other_is_const>
+        bool operator!=(const basic_iterator<other_is_const> &other) const {
+            return !(*this == other);
+        }
+
+    };
+
+    /**
+     * @brief   Iterator giving access to the keys and modifiable values
+     */
+    using iterator = basic_iterator<false>;
+
+    /**
+     * @brief   Iterator giving read-only access to the elements
+     */
+    using const_iterator = basic_iterator<true>;
+
+    /**
+     * @brief   Element detached from a map with @ref map::extract
+     * @details Owns the key and the value of the element. They are destroyed and released together
+     *          with the node handle unless it is inserted into a map with @ref map::insert.
+     */
+    class node_type {
+        friend class map;
+
+        cmagic_map_node_t node;
+        const cmagic_memory_alloc_packet_t *alloc_packet;
+
+        node_type(cmagic_map_node_t node_arg, const cmagic_memory_alloc_packet_t *alloc_packet_arg)
+        : node(node_arg), alloc_packet(alloc_packet_arg) {}
+
+        void reset() {
+            if (node) {
+                CMAGIC_MAP_NODE_FREE_EXT(node, alloc_packet, [](void *raw_key, void *raw_value) {
+                    static_cast<key_type *>(raw_key)->~key_type();
+                    static_cast<mapped_type *>(raw_value)->~mapped_type();
+                });
+                node = nullptr;
+            }
         }
 
     public:
-        const_pointer operator->() const { return &adapter; }
-        const_reference operator*() const { return *this->operator->(); }
-        bool operator!=(const iterator &other) const { return !(*this == other); }
+        node_type() : node(nullptr), alloc_packet(nullptr) {}
+        node_type(const node_type &) = delete;
+        node_type &operator=(const node_type &) = delete;
 
-        iterator(cmagic_map_iterator_t initializer) : internal_iterator(initializer) {
-            update_adapter();
+        node_type(node_type &&x) : node(x.node), alloc_packet(x.alloc_packet) {
+            x.node = nullptr;
         }
 
-        iterator &operator++() {
-            increment();
+        node_type &operator=(node_type &&x) {
+            if (&x != this) {
+                reset();
+                node = x.node;
+                alloc_packet = x.alloc_packet;
+                x.node = nullptr;
+            }
             return *this;
         }
 
-        iterator operator++(int) {
-            iterator to_return = *this;
-            ++(*this);
-            return to_return;
+        ~node_type() {
+            reset();
         }
 
-        iterator &operator--() {
-            decrement();
-            return *this;
+        /**
+         * @brief   Checks whether the node handle owns no element
+         * @return  @c true if the handle is empty
+         */
+        bool empty() const {
+            return !node;
         }
 
-        iterator operator--(int) {
-            iterator to_return = *this;
-            --(*this);
-            return to_return;
+        explicit operator bool() const {
+            return !empty();
         }
 
-        bool operator==(const iterator &other) const {
-            return this->internal_iterator == other.internal_iterator;
+        /**
+         * @brief   Returns the key of the owned element. It may be modified before the element is
+         *          inserted again.
+         * @return  reference to the key
+         */
+        key_type &key() const {
+            assert(node);
+            return *static_cast<key_type *>(const_cast<void *>(node->key));
+        }
+
+        /**
+         * @brief   Returns the value of the owned element
+         * @return  reference to the value
+         */
+        mapped_type &mapped() const {
+            assert(node);
+            return *static_cast<mapped_type *>(node->value);
         }
 
     };
 
+    /**
+     * @brief   Result of inserting a @ref map::node_type
+     */
+    struct insert_return_type {
+
+        /**
+         * @brief   iterator pointing to the inserted or already existing element, or @ref map::end
+         *          if the node handle was empty
+         */
+        iterator position;
+
+        /**
+         * @brief   @c true if the element has been inserted
+         */
+        bool inserted;
+
+        /**
+         * @brief   the node handle given back if an equivalent key already exists in the map or
+         *          the map allocation has failed, empty otherwise
+         */
+        node_type node;
+
+    };
+
 private:
     static_assert(std::is_copy_constructible<key_type>(), "key type must be copy-constructible");
     static_assert(std::is_copy_constructible<mapped_type>(),
@@ -121,37 +279,105 @@ private:
     static_assert(std::is_copy_assignable<mapped_type>(), "mapped type must be copy-assignable");
 
     CMAGIC_MAP(key_type) map_handle;
+    // Memory allocation of the map, kept to allocate it again once it's uninitialized
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+
+    using comparator = key_comparator<key_type, key_compare>;
 
-    static int key_comparator(const void *void_key1, const void *void_key2) {
-        const key_type &key1 = *static_cast<const key_type *>(void_key1);
-        const key_type &key2 = *static_cast<const key_type *>(void_key2);
-        if (key1 < key2) {
+    // Keys of other types are looked up directly if the comparison object is transparent
+    template<typename K, typename Result>
+    using enable_if_comparable =
+        typename std::enable_if<is_transparent_key<key_compare, key_type, K>::value, Result>::type;
+
+    template<typename K>
+    static int probe_comparator(const void *void_probe, const void *void_key) {
+        const K &probe = *static_cast<const K *>(void_probe);
+        const key_type &key = *static_cast<const key_type *>(void_key);
+        if (key_compare()(probe, key)) {
             return -1;
-        } else if (key1 > key2) {
+        } else if (key_compare()(key, probe)) {
             return 1;
         } else {
             return 0;
         }
     }
 
-    explicit map(const cmagic_memory_alloc_packet_t *alloc_packet)
-    : map_handle(CMAGIC_MAP_NEW(key_type, mapped_type, key_comparator, alloc_packet)) {}
+    explicit map(const cmagic_memory_alloc_packet_t *alloc_packet_arg)
+    : map_handle(CMAGIC_MAP_NEW(key_type, mapped_type, comparator::function(), alloc_packet_arg)),
+      alloc_packet(alloc_packet_arg) {}
 
-    template <typename Key_URef, typename Val_URef>
-    std::pair<iterator, bool> insert_template(Key_URef &&key, Val_URef &&value) {
-        assert(*this);
+    // Allocates an uninitialized map again
+    bool initialize() {
+        if (!map_handle) {
+            map_handle = CMAGIC_MAP_NEW(key_type, mapped_type, comparator::function(),
+                                        alloc_packet);
+        }
+        return static_cast<bool>(map_handle);
+    }
+
+    /*
+     * Allocates the element with a single descent into the tree. The key and the value are
+     * constructed in place only if the key is not present yet.
+     */
+    template <typename Key_URef, typename... Args>
+    std::pair<iterator, bool> emplace_template(Key_URef &&key, Args &&...args) {
+        if (!initialize()) {
+            return std::make_pair(end(), false);
+        }
         cmagic_map_insert_result_t insert_result = CMAGIC_MAP_ALLOCATE(map_handle, &key);
         if (!insert_result.already_exists && insert_result.inserted_or_existing) {
             new(const_cast<void *>(insert_result.inserted_or_existing->key))
-                key_type {std::forward<Key_URef>(key)};
+                key_type(std::forward<Key_URef>(key));
             new(insert_result.inserted_or_existing->value)
-                mapped_type {std::forward<Val_URef>(value)};
+                mapped_type(std::forward<Args>(args)...);
         }
         const bool insert_unique_success =
             insert_result.inserted_or_existing && !insert_result.already_exists;
         return std::make_pair(insert_result.inserted_or_existing, insert_unique_success);
     }
 
+    template <typename Key_URef, typename Val_URef>
+    std::pair<iterator, bool> insert_or_assign_template(Key_URef &&key, Val_URef &&value) {
+        std::pair<iterator, bool> result =
+            emplace_template(std::forward<Key_URef>(key), std::forward<Val_URef>(value));
+        if (!result.second && result.first != end()) {
+            result.first->second = std::forward<Val_URef>(value);
+        }
+        return result;
+    }
+
+    static cmagic_map_copy_function_t copy_function() {
+        if (std::is_trivially_copyable<key_type>::value
+                && std::is_trivially_copyable<mapped_type>::value) {
+            return nullptr;
+        }
+        return [](void *destination_key, void *destination_value, const void *source_key,
+                  const void *source_value) {
+            new(destination_key) key_type(*static_cast<const key_type *>(source_key));
+            new(destination_value) mapped_type(*static_cast<const mapped_type *>(source_value));
+        };
+    }
+
+    static cmagic_map_erase_destructor_t destructor() {
+        if (std::is_trivially_destructible<key_type>::value
+                && std::is_trivially_destructible<mapped_type>::value) {
+            return nullptr;
+        }
+        return [](void *raw_key, void *raw_value) {
+            static_cast<key_type *>(raw_key)->~key_type();
+            static_cast<mapped_type *>(raw_value)->~mapped_type();
+        };
+    }
+
+    // Destroys the elements and leaves the map uninitialized
+    void release() {
+        if (*this) {
+            clear();
+            CMAGIC_MAP_FREE(map_handle);
+            map_handle = nullptr;
+        }
+    }
+
 public:
     /**
      * @brief   Constructs an empty map with standard memory allocation.
@@ -167,45 +393,51 @@ public:
         return map(&CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
     }
 
+    /**
+     * @brief   Replaces the elements with copies of the elements of @p x
+     * @details The copy is made in linear time without any key comparison, see
+     *          @ref CMAGIC_MAP_COPY. If the allocation fails, the map is left uninitialized.
+     * @param   x map to be copied
+     * @return  reference to this map
+     */
     map &operator=(const map &x) {
-        assert(*this);
-        if (&x == this) {
-            return *this;
-        }
-
-        clear();
-        for (const value_type &val : x) {
-            auto insert_result = insert(val);
-            assert(insert_result.first == end() || insert_result.second);
-            if (insert_result.first == end()) {
-                clear();
-                CMAGIC_MAP_FREE(map_handle);
-                map_handle = nullptr;
-                return *this;
-            }
+        if (&x != this) {
+            *this = map(x);
         }
         return *this;
     }
 
-    map(const map &x) : map(CMAGIC_MAP_GET_ALLOC_PACKET(x.map_handle)) {
-        if (*this) {
-            operator=(x);
-        }
-    }
+    /**
+     * @copydoc map::operator=(const map &)
+     */
+    map(const map &x)
+    : map_handle(x ? CMAGIC_MAP_COPY_EXT(key_type, x.map_handle, copy_function(), destructor())
+                   : nullptr),
+      alloc_packet(x.alloc_packet) {}
 
-    map &operator=(map &&x) {
-        assert(*this);
-        clear();
-        CMAGIC_MAP_FREE(map_handle);
-        map_handle = x.map_handle;
-        x.map_handle = CMAGIC_MAP_NEW(key_type, mapped_type, key_comparator,
-                                      CMAGIC_MAP_GET_ALLOC_PACKET(x.map_handle));
+    /**
+     * @brief   Takes the elements of @p x without any allocation or copying
+     * @details @p x is left uninitialized, as if its allocation had failed: it's empty and holds
+     *          no memory. It can be used as any other map, inserting an element allocates it again
+     *          with the same memory allocation.
+     * @param   x map to take the elements from
+     * @return  reference to this map
+     */
+    map &operator=(map &&x) noexcept {
+        if (&x != this) {
+            release();
+            map_handle = x.map_handle;
+            alloc_packet = x.alloc_packet;
+            x.map_handle = nullptr;
+        }
         return *this;
     }
 
-    map(map &&x) : map_handle(x.map_handle) {
-        x.map_handle = CMAGIC_MAP_NEW(key_type, mapped_type, key_comparator,
-                                      CMAGIC_MAP_GET_ALLOC_PACKET(x.map_handle));
+    /**
+     * @copydoc map::operator=(map &&)
+     */
+    map(map &&x) noexcept : map_handle(x.map_handle), alloc_packet(x.alloc_packet) {
+        x.map_handle = nullptr;
     }
 
     /**
@@ -219,10 +451,10 @@ public:
      *              std::cerr << "Map allocation failed!\n";
      *          }
      *          @endcode
-     * @return  @c true if map is initialized, @c false if map allocation has failed and no
-     *          operation should be made on it
+     * @return  @c true if map is initialized, @c false if map allocation has failed or the map
+     *          was moved from. Operations inserting elements into it try to allocate it again.
      */
-    operator bool() const {
+    explicit operator bool() const {
         return static_cast<bool>(map_handle);
     }
 
@@ -232,9 +464,22 @@ public:
      *          empty, the returned iterator value shall not be dereferenced.
      * @return  an iterator to the beginning of the container
      */
-    iterator begin() const {
-        assert(map_handle);
-        return CMAGIC_MAP_FIRST(map_handle);
+    iterator begin() {
+        return map_handle ? CMAGIC_MAP_FIRST(map_handle) : nullptr;
+    }
+
+    /**
+     * @copydoc map::begin
+     */
+    const_iterator begin() const {
+        return map_handle ? CMAGIC_MAP_FIRST(map_handle) : nullptr;
+    }
+
+    /**
+     * @copydoc map::begin
+     */
+    const_iterator cbegin() const {
+        return begin();
     }
 
     /**
@@ -242,25 +487,43 @@ public:
      * @details It does not point to any element, and thus shall not be dereferenced.
      * @return  an iterator to the element past the end of the sequence
      */
-    iterator end() const {
-        assert(map_handle);
+    iterator end() {
+        return nullptr;
+    }
+
+    /**
+     * @copydoc map::end
+     */
+    const_iterator end() const {
         return nullptr;
     }
 
+    /**
+     * @copydoc map::end
+     */
+    const_iterator cend() const {
+        return end();
+    }
+
     /**
      * @brief   Removes all elements from the map, leaving the container with a size of 0.
+     * @details Elements are destroyed and deallocated in a single pass. Destructors are not called
+     *          at all if both key and value types are trivially destructible.
      */
     void clear() {
-        assert(*this);
-        for (cmagic_map_iterator_t it = CMAGIC_MAP_FIRST(map_handle);
-             it;
-             it = CMAGIC_MAP_ITERATOR_NEXT(it)) {
-            const key_type *key_ptr = static_cast<const key_type *>(it->key);
-            mapped_type *value_ptr = static_cast<mapped_type *>(it->value);
-            key_ptr->~key_type();
-            value_ptr->~mapped_type();
+        if (!*this) {
+            return;
+        }
+        if (std::is_trivially_destructible<key_type>::value
+                && std::is_trivially_destructible<mapped_type>::value) {
+            CMAGIC_MAP_CLEAR(map_handle);
+            return;
         }
-        CMAGIC_MAP_CLEAR(map_handle);
+
+        CMAGIC_MAP_CLEAR_EXT(map_handle, [](void *raw_key, void *raw_value) {
+            static_cast<key_type *>(raw_key)->~key_type();
+            static_cast<mapped_type *>(raw_value)->~mapped_type();
+        });
     }
 
     /**
@@ -277,14 +540,96 @@ public:
      *          already existed (or could not be inserted due to allocation failure).
      */
     std::pair<iterator, bool> insert(const value_type &val) {
-        return insert_template(val.first, val.second);
+        return emplace_template(val.first, val.second);
     }
 
     /**
      * @copydoc map::insert
      */
     std::pair<iterator, bool> insert(value_type &&val) {
-        return insert_template(std::move(val.first), std::move(val.second));
+        return emplace_template(std::move(val.first), std::move(val.second));
+    }
+
+    /**
+     * @brief   Inserts a new element constructed from @p args if its key is not present in the map
+     * @details The element is constructed first to obtain its key, so it's created and destroyed
+     *          even if the key already exists. Use @ref map::try_emplace to avoid it.
+     * @param   args arguments forwarded to the constructor of @ref map::value_type
+     * @return  the same as @ref map::insert
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args &&...args) {
+        value_type element(std::forward<Args>(args)...);
+        return emplace_template(std::move(element.first), std::move(element.second));
+    }
+
+    /**
+     * @brief   Inserts a new element with the value constructed in place from @p args if @p key is
+     *          not present in the map
+     * @details The key is looked up only once. Neither @p key nor @p args are touched if the key
+     *          already exists, and no temporary value is created otherwise.
+     * @param   key key of the element, copied (or moved) only if the element is inserted
+     * @param   args arguments forwarded to the constructor of @ref map::mapped_type
+     * @return  the same as @ref map::insert
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const key_type &key, Args &&...args) {
+        return emplace_template(key, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @copydoc map::try_emplace
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type &&key, Args &&...args) {
+        return emplace_template(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief   Inserts a new element or assigns the value of the element with an equivalent key
+     * @details The key is looked up only once.
+     * @param   key key of the element, copied (or moved) only if the element is inserted
+     * @param   value value to be assigned or inserted
+     * @return  a pair, with its member @c pair::first set to an iterator pointing to the inserted
+     *          or assigned element, or @ref map::end if allocation of the new element has failed.
+     *          The @c pair::second element is @c true if the element was inserted and @c false if
+     *          the value was assigned.
+     */
+    template<typename Val_URef>
+    std::pair<iterator, bool> insert_or_assign(const key_type &key, Val_URef &&value) {
+        return insert_or_assign_template(key, std::forward<Val_URef>(value));
+    }
+
+    /**
+     * @copydoc map::insert_or_assign
+     */
+    template<typename Val_URef>
+    std::pair<iterator, bool> insert_or_assign(key_type &&key, Val_URef &&value) {
+        return insert_or_assign_template(std::move(key), std::forward<Val_URef>(value));
+    }
+
+    /**
+     * @brief   Returns the value of the element with the given key, inserting a value-initialized
+     *          value if the key is not present in the map
+     * @details The key is looked up only once.
+     * @warning The behavior is undefined if the allocation of a new element fails. Use
+     *          @ref map::try_emplace if it has to be handled.
+     * @param   key key of the element
+     * @return  reference to the value
+     */
+    mapped_type &operator[](const key_type &key) {
+        std::pair<iterator, bool> result = emplace_template(key);
+        assert(result.first != end());
+        return result.first->second;
+    }
+
+    /**
+     * @copydoc map::operator[]
+     */
+    mapped_type &operator[](key_type &&key) {
+        std::pair<iterator, bool> result = emplace_template(std::move(key));
+        assert(result.first != end());
+        return result.first->second;
     }
 
     /**
@@ -293,20 +638,131 @@ public:
      *          doesn't exist in the map.
      */
     void erase(const key_type &key) {
-        assert(*this);
+        if (!*this) {
+            return;
+        }
         CMAGIC_MAP_ERASE_EXT(map_handle, &key, [](void *raw_key, void *raw_value) {
             static_cast<key_type *>(raw_key)->~key_type();
             static_cast<mapped_type *>(raw_value)->~mapped_type();
         });
     }
 
+    /**
+     * @brief   Removes a single element from the map without constructing a temporary key
+     * @param   key key of any type which can be compared with @ref map::key_type by @c operator<,
+     *          e.g. a string literal for a map of @c std::string keys
+     */
+    template<typename K>
+    enable_if_comparable<K, void> erase(const K &key) {
+        if (!*this) {
+            return;
+        }
+        CMAGIC_MAP_ERASE_BY_EXT(map_handle, &key, probe_comparator<K>,
+                                [](void *raw_key, void *raw_value) {
+            static_cast<key_type *>(raw_key)->~key_type();
+            static_cast<mapped_type *>(raw_value)->~mapped_type();
+        });
+    }
+
+    /**
+     * @brief   Moves the elements of @p source whose keys are not present in this map into this map
+     * @details Elements with keys already present in this map stay in @p source. No element is
+     *          copied or moved, they are relinked in linear time. All iterators of both maps are
+     *          invalidated.
+     * @warning Both maps must use the same kind of memory allocation, e.g. both created with
+     *          @ref map::custom_allocation_map or both with the default constructor.
+     * @param   source map to take the elements from
+     * @return  @c true on success, @c false if the allocation has failed, in which case both maps
+     *          are unchanged
+     */
+    bool merge(map &source) {
+        if (source.empty()) {
+            return true;
+        }
+        return initialize() && CMAGIC_MAP_MERGE(map_handle, source.map_handle);
+    }
+
+    /**
+     * @brief   Moves all elements whose keys do not go before @p key to @p right
+     * @details Whole subtrees are relinked in logarithmic time, no element is copied or moved.
+     * @warning @p right must be empty and use the same kind of memory allocation.
+     * @param   key first key to be moved
+     * @param   right empty map to receive the elements
+     * @return  @c true on success, @c false if @p right was uninitialized and its allocation has
+     *          failed, in which case both maps are unchanged
+     */
+    bool split(const key_type &key, map &right) {
+        assert(right.empty());
+        if (empty()) {
+            return true;
+        }
+        return right.initialize() && CMAGIC_MAP_SPLIT(map_handle, &key, right.map_handle);
+    }
+
+    /**
+     * @brief   Moves all elements of @p right to this map in logarithmic time
+     * @warning All keys of @p right must go after all keys of this map. Both maps must use the same
+     *          kind of memory allocation.
+     * @param   right map to take the elements from
+     * @return  always @c true, the operation does not allocate memory
+     */
+    bool join(map &right) {
+        if (!*this) {
+            *this = std::move(right);
+            return true;
+        }
+        return !right || CMAGIC_MAP_JOIN(map_handle, right.map_handle);
+    }
+
+    /**
+     * @brief   Removes the element with the given key from the map without destroying it
+     * @details No memory is released and iterators to other elements stay valid. The element can
+     *          be moved to another map with @ref map::insert without any memory allocation.
+     * @param   key key of the element to be detached
+     * @return  a node handle owning the element, empty if the key doesn't exist in the map
+     */
+    node_type extract(const key_type &key) {
+        if (!*this) {
+            return node_type {};
+        }
+        return node_type(CMAGIC_MAP_EXTRACT(map_handle, &key),
+                         CMAGIC_MAP_GET_ALLOC_PACKET(map_handle));
+    }
+
+    /**
+     * @brief   Inserts an element owned by the node handle
+     * @details The element is linked into the map as it is, no memory is allocated and neither key
+     *          nor value is copied or moved.
+     * @warning Both maps must use the same kind of memory allocation.
+     * @param   node node handle obtained from @ref map::extract
+     * @return  @ref map::insert_return_type. If an equivalent key already exists in the map, the
+     *          node handle is given back in @c insert_return_type::node.
+     */
+    insert_return_type insert(node_type &&node) {
+        if (node.empty()) {
+            return insert_return_type {end(), false, node_type {}};
+        }
+        if (!initialize()) {
+            return insert_return_type {end(), false, std::move(node)};
+        }
+
+        assert(node.alloc_packet->free_function ==
+               CMAGIC_MAP_GET_ALLOC_PACKET(map_handle)->free_function);
+        cmagic_map_insert_result_t insert_result = CMAGIC_MAP_INSERT_NODE(map_handle, node.node);
+        if (insert_result.already_exists) {
+            return insert_return_type {insert_result.inserted_or_existing, false, std::move(node)};
+        }
+
+        node.node = nullptr;
+        return insert_return_type {insert_result.inserted_or_existing, true, node_type {}};
+    }
+
     /**
      * @brief   Returns the number of elements in the map
      * @return  number of elements in the map
      */
     size_type size() const {
-        assert(*this);
-        return CMAGIC_MAP_SIZE(map_handle);
+        return map_handle ? CMAGIC_MAP_SIZE(map_handle) : 0;
     }
 
     /**
@@ -319,21 +775,199 @@ public:
         return size() == 0;
     }
 
+    /**
+     * @brief   Returns the comparison object ordering the keys
+     * @return  a copy of the comparison object
+     */
+    key_compare key_comp() const {
+        return key_compare();
+    }
+
     /**
      * @brief   Searches the container for an element with a key equivalent to @p key and returns an
      *          iterator to it if found, otherwise it returns @ref map::end.
      * @param   key key to be searched for
      * @return  an iterator to the element, if @p key is found, or @ref map::end otherwise
      */
-    iterator find(const key_type &key) const {
-        return CMAGIC_MAP_FIND(map_handle, &key);
+    iterator find(const key_type &key) {
+        return map_handle ? CMAGIC_MAP_FIND(map_handle, &key) : nullptr;
     }
 
-    ~map() {
-        if (*this) {
-            clear();
-            CMAGIC_MAP_FREE(map_handle);
+    /**
+     * @copydoc map::find
+     */
+    const_iterator find(const key_type &key) const {
+        return map_handle ? CMAGIC_MAP_FIND(map_handle, &key) : nullptr;
+    }
+
+    /**
+     * @brief   Searches the container for an element with a key equivalent to @p key without
+     *          constructing a temporary key
+     * @param   key key of any type which can be compared with @ref map::key_type by @c operator<,
+     *          e.g. a string literal for a map of @c std::string keys
+     * @return  an iterator to the element, if @p key is found, or @ref map::end otherwise
+     */
+    template<typename K>
+    enable_if_comparable<K, iterator> find(const K &key) {
+        return map_handle ? CMAGIC_MAP_FIND_BY(map_handle, &key, probe_comparator<K>) : nullptr;
+    }
+
+    /**
+     * @copydoc map::find
+     */
+    template<typename K>
+    enable_if_comparable<K, const_iterator> find(const K &key) const {
+        return map_handle ? CMAGIC_MAP_FIND_BY(map_handle, &key, probe_comparator<K>) : nullptr;
+    }
+
+    /**
+     * @brief   Counts the elements with a key equivalent to @p key
+     * @param   key key to be searched for
+     * @return  1 if @p key is found, 0 otherwise
+     */
+    size_type count(const key_type &key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    /**
+     * @copydoc map::count
+     * @details Accepts a key of any type which can be compared with @ref map::key_type.
+     */
+    template<typename K>
+    enable_if_comparable<K, size_type> count(const K &key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    /**
+     * @brief   Returns an iterator pointing to the first element in the container whose key is not
+     *          considered to go before @p key
+     * @param   key key to be compared with
+     * @return  an iterator to the first element whose key is equivalent to or goes after @p key,
+     *          or @ref map::end if all keys go before @p key
+     */
+    iterator lower_bound(const key_type &key) {
+        return map_handle ? CMAGIC_MAP_LOWER_BOUND(map_handle, &key) : nullptr;
+    }
+
+    /**
+     * @copydoc map::lower_bound
+     */
+    const_iterator lower_bound(const key_type &key) const {
+        return map_handle ? CMAGIC_MAP_LOWER_BOUND(map_handle, &key) : nullptr;
+    }
+
+    /**
+     * @copydoc map::lower_bound
+     * @details Accepts a key of any type which can be compared with @ref map::key_type.
+     */
+    template<typename K>
+    enable_if_comparable<K, iterator> lower_bound(const K &key) {
+        return map_handle ? CMAGIC_MAP_LOWER_BOUND_BY(map_handle, &key, probe_comparator<K>)
+                          : nullptr;
+    }
+
+    /**
+     * @copydoc map::lower_bound
+     */
+    template<typename K>
+    enable_if_comparable<K, const_iterator> lower_bound(const K &key) const {
+        return map_handle ? CMAGIC_MAP_LOWER_BOUND_BY(map_handle, &key, probe_comparator<K>)
+                          : nullptr;
+    }
+
+    /**
+     * @brief   Returns an iterator pointing to the first element in the container whose key is
+     *          considered to go after @p key
+     * @param   key key to be compared with
+     * @return  an iterator to the first element whose key goes after @p key, or @ref map::end if
+     *          no such element exists
+     */
+    iterator upper_bound(const key_type &key) {
+        return map_handle ? CMAGIC_MAP_UPPER_BOUND(map_handle, &key) : nullptr;
+    }
+
+    /**
+     * @copydoc map::upper_bound
+     */
+    const_iterator upper_bound(const key_type &key) const {
+        return map_handle ? CMAGIC_MAP_UPPER_BOUND(map_handle, &key) : nullptr;
+    }
+
+    /**
+     * @copydoc map::upper_bound
+     * @details Accepts a key of any type which can be compared with @ref map::key_type.
+     */
+    template<typename K>
+    enable_if_comparable<K, iterator> upper_bound(const K &key) {
+        return map_handle ? CMAGIC_MAP_UPPER_BOUND_BY(map_handle, &key, probe_comparator<K>)
+                          : nullptr;
+    }
+
+    /**
+     * @copydoc map::upper_bound
+     */
+    template<typename K>
+    enable_if_comparable<K, const_iterator> upper_bound(const K &key) const {
+        return map_handle ? CMAGIC_MAP_UPPER_BOUND_BY(map_handle, &key, probe_comparator<K>)
+                          : nullptr;
+    }
+
+    /**
+     * @brief   Returns the bounds of a range that includes all the elements in the container which
+     *          have a key equivalent to @p key
+     * @details Because keys in a map are unique, the range contains at most one element.
+     * @param   key key to be compared with
+     * @return  a pair, whose member @c pair::first is the lower bound of the range (the same as
+     *          @ref map::lower_bound), and @c pair::second is the upper bound (the same as @ref
+     *          map::upper_bound)
+     */
+    std::pair<iterator, iterator> equal_range(const key_type &key) {
+        if (!map_handle) {
+            return std::make_pair(end(), end());
         }
+        cmagic_map_range_t range = CMAGIC_MAP_EQUAL_RANGE(map_handle, &key);
+        return std::make_pair(iterator {range.begin}, iterator {range.end});
+    }
+
+    /**
+     * @copydoc map::equal_range
+     */
+    std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const {
+        if (!map_handle) {
+            return std::make_pair(end(), end());
+        }
+        cmagic_map_range_t range = CMAGIC_MAP_EQUAL_RANGE(map_handle, &key);
+        return std::make_pair(const_iterator {range.begin}, const_iterator {range.end});
+    }
+
+    /**
+     * @copydoc map::equal_range
+     * @details Accepts a key of any type which can be compared with @ref map::key_type.
+     */
+    template<typename K>
+    enable_if_comparable<K, std::pair<iterator, iterator>> equal_range(const K &key) {
+        if (!map_handle) {
+            return std::make_pair(end(), end());
+        }
+        cmagic_map_range_t range = CMAGIC_MAP_EQUAL_RANGE_BY(map_handle, &key, probe_comparator<K>);
+        return std::make_pair(iterator {range.begin}, iterator {range.end});
+    }
+
+    /**
+     * @copydoc map::equal_range
+     */
+    template<typename K>
+    enable_if_comparable<K, std::pair<const_iterator, const_iterator>>
+    equal_range(const K &key) const {
+        if (!map_handle) {
+            return std::make_pair(end(), end());
+        }
+        cmagic_map_range_t range = CMAGIC_MAP_EQUAL_RANGE_BY(map_handle, &key, probe_comparator<K>);
+        return std::make_pair(const_iterator {range.begin}, const_iterator {range.end});
+    }
+
+    ~map() {
+        release();
     }
 
 };
@@ -0,0 +1,547 @@
+/**
+ * @file    multimap.hpp
+ * @brief   Template implementation of a @b multimap container.
+ * @details This is a wrapper over C implementation from @ref multimap.h
+ */
+
+#ifndef CMAGIC_MULTIMAP_HPP
+#define CMAGIC_MULTIMAP_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "cmagic/functional.hpp"
+#include "cmagic/multimap.h"
+
+
+namespace cmagic {
+
+/**
+ * @brief   An ordered container of key-value pairs whose keys don't have to be unique.
+ * @details Elements with equivalent keys are kept in the order of their insertion. Multimap is
+ *          implemented as an AVL tree which knows the sizes of its subtrees, so elements with a
+ *          given key are counted in logarithmic time. Keys are ordered by the stateless function
+ *          object @p Compare, by @c operator< by default.
+ */
+template<typename Key, typename Value, typename Compare = less>
+class multimap {
+
+public:
+    /**
+     * @brief   Type of multimap keys
+     */
+    using key_type = Key;
+
+    /**
+     * @brief   Type of multimap values
+     */
+    using mapped_type = Value;
+
+    /**
+     * @brief   Type of multimap elements
+     */
+    using value_type = std::pair<key_type, mapped_type>;
+
+    /**
+     * @brief   Type of the function object ordering the keys. It must be stateless.
+     */
+    using key_compare = Compare;
+
+    /**
+     * @brief   Type used to measure element size
+     */
+    using size_type = size_t;
+
+    /**
+     * @brief   Reference to a multimap element, obtained by dereferencing an iterator
+     * @details Binds the key and the value stored separately, neither of them is copied.
+     */
+    template<typename Mapped>
+    struct basic_reference {
+        const key_type &first;
+        Mapped &second;
+
+        /**
+         * @brief   Copies the referenced element
+         */
+        operator value_type() const {
+            return value_type(first, second);
+        }
+    };
+
+    /**
+     * @brief   Result of the arrow operator of an iterator, which gives access to the members of
+     *          @ref multimap::basic_reference
+     */
+    template<typename Mapped>
+    class basic_pointer {
+        basic_reference<Mapped> element;
+
+    public:
+        explicit basic_pointer(const basic_reference<Mapped> &element_arg) : element(element_arg) {}
+        const basic_reference<Mapped> *operator->() const { return &element; }
+    };
+
+    /**
+     * @brief   Bidirectional iterator over the multimap elements in the order of their keys
+     * @details A mutable iterator converts to a constant one.
+     */
+    template<bool is_const>
+    class basic_iterator {
+        friend class multimap;
+
+        template<bool other_is_const>
+        friend class basic_iterator;
+
+        using mapped_access_type =
+            typename std::conditional<is_const, const mapped_type, mapped_type>::type;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = multimap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = basic_reference<mapped_access_type>;
+        using pointer = basic_pointer<mapped_access_type>;
+
+    private:
+        cmagic_map_iterator_t internal_iterator;
+
+    public:
+        basic_iterator() : internal_iterator(nullptr) {}
+        basic_iterator(cmagic_map_iterator_t initializer) : internal_iterator(initializer) {}
+
+        template<bool other_is_const,
+                 typename = typename std::enable_if<is_const && !other_is_const>::type>
+        basic_iterator(const basic_iterator<other_is_const> &other)
+        : internal_iterator(other.internal_iterator) {}
+
+        reference operator*() const {
+            assert(internal_iterator);
+            return reference {*static_cast<const key_type *>(internal_iterator->key),
+                              *static_cast<mapped_type *>(internal_iterator->value)};
+        }
+
+        pointer operator->() const { return pointer(**this); }
+
+        basic_iterator &operator++() {
+            assert(internal_iterator);
+            internal_iterator = CMAGIC_MAP_ITERATOR_NEXT(internal_iterator);
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator to_return = *this;
+            ++(*this);
+            return to_return;
+        }
+
+        basic_iterator &operator--() {
+            assert(internal_iterator);
+            internal_iterator = CMAGIC_MAP_ITERATOR_PREV(internal_iterator);
+            return *this;
+        }
+
+        basic_iterator operator--(int) {
+            basic_iterator to_return = *this;
+            --(*this);
+            return to_return;
+        }
+
+        template<bool other_is_const>
+        bool operator==(const basic_iterator<other_is_const> &other) const {
+            return this->internal_iterator == other.internal_iterator;
+        }
+
+        template<bool other_is_const>
+        bool operator!=(const basic_iterator<other_is_const> &other) const {
+            return !(*this == other);
+        }
+
+    };
+
+    /**
+     * @brief   Iterator giving access to the keys and modifiable values
+     */
+    using iterator = basic_iterator<false>;
+
+    /**
+     * @brief   Iterator giving read-only access to the elements
+     */
+    using const_iterator = basic_iterator<true>;
+
+private:
+    static_assert(std::is_copy_constructible<key_type>(), "key type must be copy-constructible");
+    static_assert(std::is_copy_constructible<mapped_type>(),
+                  "mapped type must be copy-constructible");
+
+    CMAGIC_MULTIMAP(key_type) multimap_handle;
+    // Memory allocation of the multimap, kept to allocate it again once it's uninitialized
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+
+    using comparator = key_comparator<key_type, key_compare>;
+
+    explicit multimap(const cmagic_memory_alloc_packet_t *alloc_packet_arg)
+    : multimap_handle(CMAGIC_MULTIMAP_NEW(key_type, mapped_type, comparator::function(),
+                                          alloc_packet_arg)),
+      alloc_packet(alloc_packet_arg) {}
+
+    // Allocates an uninitialized multimap again
+    bool initialize() {
+        if (!multimap_handle) {
+            multimap_handle = CMAGIC_MULTIMAP_NEW(key_type, mapped_type, comparator::function(),
+                                                  alloc_packet);
+        }
+        return static_cast<bool>(multimap_handle);
+    }
+
+    template <typename Key_URef, typename... Args>
+    iterator emplace_template(Key_URef &&key, Args &&...args) {
+        if (!initialize()) {
+            return end();
+        }
+        cmagic_map_iterator_t inserted = CMAGIC_MULTIMAP_ALLOCATE(multimap_handle, &key);
+        if (inserted) {
+            new(const_cast<void *>(inserted->key)) key_type(std::forward<Key_URef>(key));
+            new(inserted->value) mapped_type(std::forward<Args>(args)...);
+        }
+        return inserted;
+    }
+
+    static cmagic_map_copy_function_t copy_function() {
+        if (std::is_trivially_copyable<key_type>::value
+                && std::is_trivially_copyable<mapped_type>::value) {
+            return nullptr;
+        }
+        return [](void *destination_key, void *destination_value, const void *source_key,
+                  const void *source_value) {
+            new(destination_key) key_type(*static_cast<const key_type *>(source_key));
+            new(destination_value) mapped_type(*static_cast<const mapped_type *>(source_value));
+        };
+    }
+
+    static cmagic_map_erase_destructor_t destructor() {
+        if (std::is_trivially_destructible<key_type>::value
+                && std::is_trivially_destructible<mapped_type>::value) {
+            return nullptr;
+        }
+        return [](void *raw_key, void *raw_value) {
+            static_cast<key_type *>(raw_key)->~key_type();
+            static_cast<mapped_type *>(raw_value)->~mapped_type();
+        };
+    }
+
+    // Destroys the elements and leaves the multimap uninitialized
+    void release() {
+        if (*this) {
+            clear();
+            CMAGIC_MULTIMAP_FREE(multimap_handle);
+            multimap_handle = nullptr;
+        }
+    }
+
+public:
+    /**
+     * @brief   Constructs an empty multimap with standard memory allocation.
+     * @return  a new empty multimap
+     */
+    multimap() : multimap(&CMAGIC_MEMORY_ALLOC_PACKET_STD) {}
+
+    /**
+     * @brief   Constructs an empty multimap using custom @e CMagic memory allocation from
+     *          @ref memory.h
+     * @return  a new empty multimap
+     */
+    static multimap custom_allocation_multimap() {
+        return multimap(&CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    }
+
+    /**
+     * @brief   Replaces the elements with copies of the elements of @p x
+     * @details The copy is made in linear time and keeps the order of equivalent keys, see
+     *          @ref CMAGIC_MULTIMAP_COPY. If the allocation fails, the multimap is left
+     *          uninitialized.
+     * @param   x multimap to be copied
+     * @return  reference to this multimap
+     */
+    multimap &operator=(const multimap &x) {
+        if (&x != this) {
+            *this = multimap(x);
+        }
+        return *this;
+    }
+
+    /**
+     * @copydoc multimap::operator=(const multimap &)
+     */
+    multimap(const multimap &x)
+    : multimap_handle(x ? CMAGIC_MULTIMAP_COPY_EXT(key_type, x.multimap_handle, copy_function(),
+                                                   destructor())
+                        : nullptr),
+      alloc_packet(x.alloc_packet) {}
+
+    /**
+     * @brief   Takes the elements of @p x without any allocation or copying
+     * @details @p x is left uninitialized, as if its allocation had failed: it's empty and holds
+     *          no memory. It can be used as any other multimap, inserting an element allocates it
+     *          again with the same memory allocation.
+     * @param   x multimap to take the elements from
+     * @return  reference to this multimap
+     */
+    multimap &operator=(multimap &&x) noexcept {
+        if (&x != this) {
+            release();
+            multimap_handle = x.multimap_handle;
+            alloc_packet = x.alloc_packet;
+            x.multimap_handle = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * @copydoc multimap::operator=(multimap &&)
+     */
+    multimap(multimap &&x) noexcept
+    : multimap_handle(x.multimap_handle), alloc_packet(x.alloc_packet) {
+        x.multimap_handle = nullptr;
+    }
+
+    /**
+     * @brief   Checks if the multimap is properly initialized
+     * @return  @c true if multimap is initialized, @c false if multimap allocation has failed or
+     *          the multimap was moved from. Inserting elements into it tries to allocate it again.
+     */
+    explicit operator bool() const {
+        return static_cast<bool>(multimap_handle);
+    }
+
+    /**
+     * @brief   Return iterator to beginning
+     * @return  an iterator to the first element or @ref multimap::end if the multimap is empty
+     */
+    iterator begin() {
+        return multimap_handle ? CMAGIC_MULTIMAP_FIRST(multimap_handle) : nullptr;
+    }
+
+    /**
+     * @copydoc multimap::begin
+     */
+    const_iterator begin() const {
+        return multimap_handle ? CMAGIC_MULTIMAP_FIRST(multimap_handle) : nullptr;
+    }
+
+    /**
+     * @copydoc multimap::begin
+     */
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    /**
+     * @brief   Return iterator to end
+     * @details It does not point to any element, and thus shall not be dereferenced.
+     * @return  an iterator to the element past the end of the sequence
+     */
+    iterator end() {
+        return nullptr;
+    }
+
+    /**
+     * @copydoc multimap::end
+     */
+    const_iterator end() const {
+        return nullptr;
+    }
+
+    /**
+     * @copydoc multimap::end
+     */
+    const_iterator cend() const {
+        return end();
+    }
+
+    /**
+     * @brief   Removes all elements from the multimap, leaving the container with a size of 0.
+     * @details Destructors are not called at all if both key and value types are trivially
+     *          destructible.
+     */
+    void clear() {
+        if (*this) {
+            CMAGIC_MULTIMAP_CLEAR_EXT(multimap_handle, destructor());
+        }
+    }
+
+    /**
+     * @brief   Inserts a new element after all elements with equivalent keys
+     * @param   val value to be copied (or moved) to the multimap
+     * @return  an iterator pointing to the new element or @ref multimap::end if its allocation
+     *          has failed
+     */
+    iterator insert(const value_type &val) {
+        return emplace_template(val.first, val.second);
+    }
+
+    /**
+     * @copydoc multimap::insert
+     */
+    iterator insert(value_type &&val) {
+        return emplace_template(std::move(val.first), std::move(val.second));
+    }
+
+    /**
+     * @brief   Inserts a new element constructed from @p args after all elements with equivalent
+     *          keys
+     * @param   args arguments forwarded to the constructor of @ref multimap::value_type
+     * @return  the same as @ref multimap::insert
+     */
+    template<typename... Args>
+    iterator emplace(Args &&...args) {
+        value_type element(std::forward<Args>(args)...);
+        return emplace_template(std::move(element.first), std::move(element.second));
+    }
+
+    /**
+     * @brief   Removes all elements with a key equivalent to @p key
+     * @param   key key of the elements to be removed
+     * @return  number of removed elements
+     */
+    size_type erase(const key_type &key) {
+        return multimap_handle ? CMAGIC_MULTIMAP_ERASE_EXT(multimap_handle, &key, destructor())
+                               : 0;
+    }
+
+    /**
+     * @brief   Removes the single element pointed to by @p position
+     * @details Iterators to other elements stay valid.
+     * @param   position iterator to the element to be removed
+     * @return  an iterator to the element following the removed one
+     */
+    iterator erase(const_iterator position) {
+        assert(*this);
+        assert(position != end());
+        cmagic_map_iterator_t next = CMAGIC_MAP_ITERATOR_NEXT(position.internal_iterator);
+        CMAGIC_MULTIMAP_ERASE_ITERATOR_EXT(multimap_handle, position.internal_iterator,
+                                           destructor());
+        return next;
+    }
+
+    /**
+     * @brief   Returns the number of elements in the multimap
+     * @return  number of elements in the multimap
+     */
+    size_type size() const {
+        return multimap_handle ? CMAGIC_MULTIMAP_SIZE(multimap_handle) : 0;
+    }
+
+    /**
+     * @brief   Returns whether the multimap is empty (i.e. whether its size is 0).
+     * @return  @c true if the container size is 0, @c false otherwise
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief   Returns the comparison object ordering the keys
+     * @return  a copy of the comparison object
+     */
+    key_compare key_comp() const {
+        return key_compare();
+    }
+
+    /**
+     * @brief   Searches the container for the first inserted element with a key equivalent to
+     *          @p key
+     * @param   key key to be searched for
+     * @return  an iterator to the element, if @p key is found, or @ref multimap::end otherwise
+     */
+    iterator find(const key_type &key) {
+        return multimap_handle ? CMAGIC_MULTIMAP_FIND(multimap_handle, &key) : nullptr;
+    }
+
+    /**
+     * @copydoc multimap::find
+     */
+    const_iterator find(const key_type &key) const {
+        return multimap_handle ? CMAGIC_MULTIMAP_FIND(multimap_handle, &key) : nullptr;
+    }
+
+    /**
+     * @brief   Counts the elements with a key equivalent to @p key in logarithmic time
+     * @param   key key to be searched for
+     * @return  number of matching elements
+     */
+    size_type count(const key_type &key) const {
+        return multimap_handle ? CMAGIC_MULTIMAP_COUNT(multimap_handle, &key) : 0;
+    }
+
+    /**
+     * @brief   Returns an iterator pointing to the first element in the container whose key is not
+     *          considered to go before @p key
+     * @param   key key to be compared with
+     * @return  an iterator to the element or @ref multimap::end if all keys go before @p key
+     */
+    iterator lower_bound(const key_type &key) {
+        return multimap_handle ? CMAGIC_MULTIMAP_LOWER_BOUND(multimap_handle, &key) : nullptr;
+    }
+
+    /**
+     * @copydoc multimap::lower_bound
+     */
+    const_iterator lower_bound(const key_type &key) const {
+        return multimap_handle ? CMAGIC_MULTIMAP_LOWER_BOUND(multimap_handle, &key) : nullptr;
+    }
+
+    /**
+     * @brief   Returns an iterator pointing to the first element in the container whose key is
+     *          considered to go after @p key
+     * @param   key key to be compared with
+     * @return  an iterator to the element or @ref multimap::end if no such element exists
+     */
+    iterator upper_bound(const key_type &key) {
+        return multimap_handle ? CMAGIC_MULTIMAP_UPPER_BOUND(multimap_handle, &key) : nullptr;
+    }
+
+    /**
+     * @copydoc multimap::upper_bound
+     */
+    const_iterator upper_bound(const key_type &key) const {
+        return multimap_handle ? CMAGIC_MULTIMAP_UPPER_BOUND(multimap_handle, &key) : nullptr;
+    }
+
+    /**
+     * @brief   Returns the range of all elements with a key equivalent to @p key in the order of
+     *          their insertion
+     * @param   key key to be compared with
+     * @return  a pair of @ref multimap::lower_bound and @ref multimap::upper_bound
+     */
+    std::pair<iterator, iterator> equal_range(const key_type &key) {
+        if (!multimap_handle) {
+            return std::make_pair(end(), end());
+        }
+        cmagic_map_range_t range = CMAGIC_MULTIMAP_EQUAL_RANGE(multimap_handle, &key);
+        return std::make_pair(iterator {range.begin}, iterator {range.end});
+    }
+
+    /**
+     * @copydoc multimap::equal_range
+     */
+    std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const {
+        if (!multimap_handle) {
+            return std::make_pair(end(), end());
+        }
+        cmagic_map_range_t range = CMAGIC_MULTIMAP_EQUAL_RANGE(multimap_handle, &key);
+        return std::make_pair(const_iterator {range.begin}, const_iterator {range.end});
+    }
+
+    ~multimap() {
+        release();
+    }
+
+};
+
+} // namespace cmagic
+
+#endif /* CMAGIC_MULTIMAP_HPP */
@@ -0,0 +1,419 @@
+/**
+ * @file    multiset.hpp
+ * @brief   Template implementation of a @b multiset container.
+ * @details This is a wrapper over C implementation from @ref multiset.h
+ */
+
+#ifndef CMAGIC_MULTISET_HPP
+#define CMAGIC_MULTISET_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "cmagic/functional.hpp"
+#include "cmagic/multiset.h"
+
+
+namespace cmagic {
+
+/**
+ * @brief   An ordered container whose elements don't have to be unique.
+ * @details Equivalent elements are kept in the order of their insertion. Multiset is implemented
+ *          as an AVL tree which knows the sizes of its subtrees, so equivalent elements are counted
+ *          in logarithmic time. Elements are ordered by the stateless function object @p Compare,
+ *          by @c operator< by default.
+ */
+template<typename T, typename Compare = less>
+class multiset {
+
+public:
+    /**
+     * @brief   Type of multiset elements.
+     */
+    using value_type = T;
+
+    /**
+     * @brief   Type of the function object ordering the elements. It must be stateless.
+     */
+    using key_compare = Compare;
+
+    /**
+     * @brief   Same as @ref multiset::key_compare, since elements are their own keys.
+     */
+    using value_compare = Compare;
+
+    /**
+     * @brief   Type used to measure element size.
+     */
+    using size_type = size_t;
+
+    class iterator {
+        friend class multiset;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using const_pointer = const value_type*;
+        using const_reference = const value_type&;
+        using pointer = const_pointer;
+        using reference = const_reference;
+
+    private:
+        cmagic_set_iterator_t internal_iterator;
+
+    public:
+        iterator() : internal_iterator(nullptr) {}
+        iterator(cmagic_set_iterator_t initializer) : internal_iterator(initializer) {}
+        const_reference operator*() const { return *this->operator->(); }
+        bool operator!=(const iterator &other) const { return !(*this == other); }
+
+        const_pointer operator->() const {
+            return static_cast<const_pointer>(internal_iterator->key);
+        }
+
+        iterator &operator++() {
+            assert(internal_iterator);
+            internal_iterator = CMAGIC_SET_ITERATOR_NEXT(internal_iterator);
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator to_return = *this;
+            ++(*this);
+            return to_return;
+        }
+
+        iterator &operator--() {
+            assert(internal_iterator);
+            internal_iterator = CMAGIC_SET_ITERATOR_PREV(internal_iterator);
+            return *this;
+        }
+
+        iterator operator--(int) {
+            iterator to_return = *this;
+            --(*this);
+            return to_return;
+        }
+
+        bool operator==(const iterator &other) const {
+            return this->internal_iterator == other.internal_iterator;
+        }
+
+    };
+
+    /**
+     * @brief   Same as @ref multiset::iterator, since elements of a multiset cannot be modified
+     */
+    using const_iterator = iterator;
+
+private:
+    static_assert(std::is_copy_constructible<T>(), "value type must be copy-constructible");
+    CMAGIC_MULTISET(value_type) multiset_handle;
+    // Memory allocation of the multiset, kept to allocate it again once it's uninitialized
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+
+    using comparator = key_comparator<value_type, key_compare>;
+
+    explicit multiset(const cmagic_memory_alloc_packet_t *alloc_packet_arg)
+    : multiset_handle(CMAGIC_MULTISET_NEW(value_type, comparator::function(),
+                                          alloc_packet_arg)),
+      alloc_packet(alloc_packet_arg) {}
+
+    // Allocates an uninitialized multiset again
+    bool initialize() {
+        if (!multiset_handle) {
+            multiset_handle = CMAGIC_MULTISET_NEW(value_type, comparator::function(),
+                                                  alloc_packet);
+        }
+        return static_cast<bool>(multiset_handle);
+    }
+
+    static cmagic_set_copy_function_t copy_function() {
+        if (std::is_trivially_copyable<value_type>::value) {
+            return nullptr;
+        }
+        return [](void *destination, const void *source) {
+            new(destination) value_type {*static_cast<const value_type *>(source)};
+        };
+    }
+
+    static cmagic_set_erase_destructor_t destructor() {
+        if (std::is_trivially_destructible<value_type>::value) {
+            return nullptr;
+        }
+        return [](void *key) {
+            static_cast<value_type *>(key)->~value_type();
+        };
+    }
+
+    template <typename URef>
+    iterator insert_template(URef &&val) {
+        if (!initialize()) {
+            return end();
+        }
+        cmagic_set_iterator_t inserted = CMAGIC_MULTISET_ALLOCATE(multiset_handle, &val);
+        if (inserted) {
+            new(const_cast<void *>(inserted->key)) value_type {std::forward<URef>(val)};
+        }
+        return inserted;
+    }
+
+    // Destroys the elements and leaves the multiset uninitialized
+    void release() {
+        if (*this) {
+            clear();
+            CMAGIC_MULTISET_FREE(multiset_handle);
+            multiset_handle = nullptr;
+        }
+    }
+
+public:
+    /**
+     * @brief   Constructs an empty multiset with standard memory allocation.
+     * @return  a new empty multiset
+     */
+    multiset() : multiset(&CMAGIC_MEMORY_ALLOC_PACKET_STD) {}
+
+    /**
+     * @brief   Constructs an empty multiset using custom @e CMagic memory allocation from
+     *          @ref memory.h
+     * @return  a new empty multiset
+     */
+    static multiset custom_allocation_multiset() {
+        return multiset(&CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    }
+
+    /**
+     * @brief   Replaces the elements with copies of the elements of @p x
+     * @details The copy is made in linear time and keeps the order of equivalent elements, see
+     *          @ref CMAGIC_MULTISET_COPY. If the allocation fails, the multiset is left
+     *          uninitialized.
+     * @param   x multiset to be copied
+     * @return  reference to this multiset
+     */
+    multiset &operator=(const multiset &x) {
+        if (&x != this) {
+            *this = multiset(x);
+        }
+        return *this;
+    }
+
+    /**
+     * @copydoc multiset::operator=(const multiset &)
+     */
+    multiset(const multiset &x)
+    : multiset_handle(x ? CMAGIC_MULTISET_COPY_EXT(value_type, x.multiset_handle, copy_function(),
+                                                   destructor())
+                        : nullptr),
+      alloc_packet(x.alloc_packet) {}
+
+    /**
+     * @brief   Takes the elements of @p x without any allocation or copying
+     * @details @p x is left uninitialized, as if its allocation had failed: it's empty and holds
+     *          no memory. It can be used as any other multiset, inserting an element allocates it
+     *          again with the same memory allocation.
+     * @param   x multiset to take the elements from
+     * @return  reference to this multiset
+     */
+    multiset &operator=(multiset &&x) noexcept {
+        if (&x != this) {
+            release();
+            multiset_handle = x.multiset_handle;
+            alloc_packet = x.alloc_packet;
+            x.multiset_handle = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * @copydoc multiset::operator=(multiset &&)
+     */
+    multiset(multiset &&x) noexcept
+    : multiset_handle(x.multiset_handle), alloc_packet(x.alloc_packet) {
+        x.multiset_handle = nullptr;
+    }
+
+    /**
+     * @brief   Checks if the multiset is properly initialized
+     * @return  @c true if multiset is initialized, @c false if multiset allocation has failed or
+     *          the multiset was moved from. Inserting elements into it tries to allocate it again.
+     */
+    operator bool() const {
+        return static_cast<bool>(multiset_handle);
+    }
+
+    /**
+     * @brief   Return iterator to beginning
+     * @return  an iterator to the first element or @ref multiset::end if the multiset is empty
+     */
+    iterator begin() const {
+        return multiset_handle ? CMAGIC_MULTISET_FIRST(multiset_handle) : nullptr;
+    }
+
+    /**
+     * @brief   Return iterator to end
+     * @details It does not point to any element, and thus shall not be dereferenced.
+     * @return  an iterator to the element past the end of the sequence
+     */
+    iterator end() const {
+        return nullptr;
+    }
+
+    /**
+     * @brief   Removes all elements from the multiset, leaving the container with a size of 0.
+     * @details Destructors are not called at all if the element type is trivially destructible.
+     */
+    void clear() {
+        if (*this) {
+            CMAGIC_MULTISET_CLEAR_EXT(multiset_handle, destructor());
+        }
+    }
+
+    /**
+     * @brief   Inserts a new element after all equivalent elements
+     * @param   val value to be copied (or moved) to the multiset
+     * @return  an iterator pointing to the new element or @ref multiset::end if its allocation
+     *          has failed
+     */
+    iterator insert(const value_type &val) {
+        return insert_template(val);
+    }
+
+    /**
+     * @copydoc multiset::insert
+     */
+    iterator insert(value_type &&val) {
+        return insert_template(std::move(val));
+    }
+
+    /**
+     * @brief   Inserts a new element constructed from @p args after all equivalent elements
+     * @param   args arguments forwarded to the constructor of @ref multiset::value_type
+     * @return  the same as @ref multiset::insert
+     */
+    template<typename... Args>
+    iterator emplace(Args &&...args) {
+        return insert_template(value_type(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief   Removes all elements equivalent to @p key
+     * @param   key value of the elements to be removed
+     * @return  number of removed elements
+     */
+    size_type erase(const value_type &key) {
+        return multiset_handle ? CMAGIC_MULTISET_ERASE_EXT(multiset_handle, &key, destructor())
+                               : 0;
+    }
+
+    /**
+     * @brief   Removes the single element pointed to by @p position
+     * @details Iterators to other elements stay valid.
+     * @param   position iterator to the element to be removed
+     * @return  an iterator to the element following the removed one
+     */
+    iterator erase(const_iterator position) {
+        assert(*this);
+        assert(position != end());
+        cmagic_set_iterator_t next = CMAGIC_SET_ITERATOR_NEXT(position.internal_iterator);
+        CMAGIC_MULTISET_ERASE_ITERATOR_EXT(multiset_handle, position.internal_iterator,
+                                           destructor());
+        return next;
+    }
+
+    /**
+     * @brief   Returns the number of elements in the multiset
+     * @return  number of elements in the multiset
+     */
+    size_type size() const {
+        return multiset_handle ? CMAGIC_MULTISET_SIZE(multiset_handle) : 0;
+    }
+
+    /**
+     * @brief   Returns whether the multiset is empty (i.e. whether its size is 0).
+     * @return  @c true if the container size is 0, @c false otherwise
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief   Returns the comparison object ordering the elements
+     * @return  a copy of the comparison object
+     */
+    key_compare key_comp() const {
+        return key_compare();
+    }
+
+    /**
+     * @copydoc multiset::key_comp
+     */
+    value_compare value_comp() const {
+        return value_compare();
+    }
+
+    /**
+     * @brief   Searches the container for the first inserted element equivalent to @p key
+     * @param   key value to be searched for
+     * @return  an iterator to the element, if @p key is found, or @ref multiset::end otherwise
+     */
+    iterator find(const value_type &key) const {
+        return multiset_handle ? CMAGIC_MULTISET_FIND(multiset_handle, &key) : nullptr;
+    }
+
+    /**
+     * @brief   Counts the elements equivalent to @p key in logarithmic time
+     * @param   key value to be searched for
+     * @return  number of matching elements
+     */
+    size_type count(const value_type &key) const {
+        return multiset_handle ? CMAGIC_MULTISET_COUNT(multiset_handle, &key) : 0;
+    }
+
+    /**
+     * @brief   Returns an iterator pointing to the first element in the container which is not
+     *          considered to go before @p key
+     * @param   key value to be compared with
+     * @return  an iterator to the element or @ref multiset::end if all elements go before @p key
+     */
+    iterator lower_bound(const value_type &key) const {
+        return multiset_handle ? CMAGIC_MULTISET_LOWER_BOUND(multiset_handle, &key) : nullptr;
+    }
+
+    /**
+     * @brief   Returns an iterator pointing to the first element in the container which is
+     *          considered to go after @p key
+     * @param   key value to be compared with
+     * @return  an iterator to the element or @ref multiset::end if no such element exists
+     */
+    iterator upper_bound(const value_type &key) const {
+        return multiset_handle ? CMAGIC_MULTISET_UPPER_BOUND(multiset_handle, &key) : nullptr;
+    }
+
+    /**
+     * @brief   Returns the range of all elements equivalent to @p key in the order of their
+     *          insertion
+     * @param   key value to be compared with
+     * @return  a pair of @ref multiset::lower_bound and @ref multiset::upper_bound
+     */
+    std::pair<iterator, iterator> equal_range(const value_type &key) const {
+        if (!multiset_handle) {
+            return std::make_pair(end(), end());
+        }
+        cmagic_set_range_t range = CMAGIC_MULTISET_EQUAL_RANGE(multiset_handle, &key);
+        return std::make_pair(iterator {range.begin}, iterator {range.end});
+    }
+
+    ~multiset() {
+        release();
+    }
+
+};
+
+} // namespace cmagic
+
+#endif /* CMAGIC_MULTISET_HPP */
@@ -12,6 +12,8 @@
 #include <iterator>
 #include <new>
 #include <type_traits>
+#include <utility>
+#include "cmagic/functional.hpp"
 #include "cmagic/set.h"
 
 
@@ -21,9 +23,10 @@ namespace cmagic {
  * @brief   A container that stores unique elements following a specific order.
  * @details Each value in the set is unique. The value of the elements in a set cannot be modified
  *          once in the container but they can be inserted or removed from the container. Set is
- *          implemented as an AVL tree.
+ *          implemented as an AVL tree. Elements are ordered by the stateless function object
+ *          @p Compare, by @c operator< by default.
  */
-template<typename T>
+template<typename T, typename Compare = less>
 class set {
 
 public:
@@ -32,6 +35,16 @@ public:
      */
     using value_type = T;
 
+    /**
+     * @brief   Type of the function object ordering the elements. It must be stateless.
+     */
+    using key_compare = Compare;
+
+    /**
+     * @brief   Same as @ref set::key_compare, since elements are their own keys.
+     */
+    using value_compare = Compare;
+
     /**
      * @brief   Type used to measure element size.
      */
@@ -42,13 +55,17 @@ public:
     public:
         using iterator_category = std::bidirectional_iterator_tag;
         using value_type = T;
+        using difference_type = std::ptrdiff_t;
         using const_pointer = const value_type*;
         using const_reference = const value_type&;
+        using pointer = const_pointer;
+        using reference = const_reference;
 
     private:
         cmagic_set_iterator_t internal_iterator;
     
     public:
+        iterator() : internal_iterator(nullptr) {}
         iterator(cmagic_set_iterator_t initializer) : internal_iterator(initializer) {}
         const_reference operator*() const { return *this->operator->(); }
         bool operator!=(const iterator &other) const { return !(*this == other); }
@@ -87,29 +104,102 @@ public:
 
     };
 
+    /**
+     * @brief   Same as @ref set::iterator, since elements of a set cannot be modified
+     */
+    using const_iterator = iterator;
+
 private:
     static_assert(std::is_copy_assignable<T>(), "value type must be copy-assignable");
     static_assert(std::is_copy_constructible<T>(), "value type must be copy-constructible");
     CMAGIC_SET(value_type) set_handle;
+    // Memory allocation of the set, kept to allocate it again once it's uninitialized
+    const cmagic_memory_alloc_packet_t *alloc_packet;
 
-    static int key_comparator(const void *void_key1, const void *void_key2) {
-        const value_type &key1 = *static_cast<const value_type *>(void_key1);
-        const value_type &key2 = *static_cast<const value_type *>(void_key2);
-        if (key1 < key2) {
+    using comparator = key_comparator<value_type, key_compare>;
+
+    // Keys of other types are looked up directly if the comparison object is transparent
+    template<typename K, typename Result>
+    using enable_if_comparable = typename std::enable_if<
+        is_transparent_key<key_compare, value_type, K>::value, Result>::type;
+
+    template<typename K>
+    static int probe_comparator(const void *void_probe, const void *void_key) {
+        const K &probe = *static_cast<const K *>(void_probe);
+        const value_type &key = *static_cast<const value_type *>(void_key);
+        if (key_compare()(probe, key)) {
             return -1;
-        } else if (key1 > key2) {
+        } else if (key_compare()(key, probe)) {
             return 1;
         } else {
             return 0;
         }
     }
 
-    explicit set(const cmagic_memory_alloc_packet_t *alloc_packet)
-    : set_handle(CMAGIC_SET_NEW(value_type, key_comparator, alloc_packet)) {}
+    explicit set(const cmagic_memory_alloc_packet_t *alloc_packet_arg)
+    : set_handle(CMAGIC_SET_NEW(value_type, comparator::function(), alloc_packet_arg)),
+      alloc_packet(alloc_packet_arg) {}
+
+    struct adopt_handle_tag {};
+
+    set(adopt_handle_tag, CMAGIC_SET(value_type) handle,
+        const cmagic_memory_alloc_packet_t *alloc_packet_arg)
+    : set_handle(handle), alloc_packet(alloc_packet_arg) {}
+
+    // Allocates an uninitialized set again
+    bool initialize() {
+        if (!set_handle) {
+            set_handle = CMAGIC_SET_NEW(value_type, comparator::function(), alloc_packet);
+        }
+        return static_cast<bool>(set_handle);
+    }
+
+    // Runs a set operation on the handles of both sets, standing in an empty set for an
+    // uninitialized one
+    template <typename Operation>
+    static set apply(const set &x, const set &y, Operation operation) {
+        if (x && y) {
+            return set(adopt_handle_tag {}, operation(x.set_handle, y.set_handle), x.alloc_packet);
+        }
+        const set empty_set {x.alloc_packet};
+        if (!empty_set) {
+            return set(adopt_handle_tag {}, nullptr, x.alloc_packet);
+        }
+        return apply(x ? x : empty_set, y ? y : empty_set, operation);
+    }
+
+    static cmagic_set_copy_function_t copy_function() {
+        if (std::is_trivially_copyable<value_type>::value) {
+            return nullptr;
+        }
+        return [](void *destination, const void *source) {
+            new(destination) value_type {*static_cast<const value_type *>(source)};
+        };
+    }
+
+    static cmagic_set_erase_destructor_t destructor() {
+        if (std::is_trivially_destructible<value_type>::value) {
+            return nullptr;
+        }
+        return [](void *key) {
+            static_cast<value_type *>(key)->~value_type();
+        };
+    }
+
+    template<typename U, typename C>
+    friend set<U, C> set_union(const set<U, C> &x, const set<U, C> &y);
+
+    template<typename U, typename C>
+    friend set<U, C> set_intersection(const set<U, C> &x, const set<U, C> &y);
+
+    template<typename U, typename C>
+    friend set<U, C> set_difference(const set<U, C> &x, const set<U, C> &y);
 
     template <typename URef>
     std::pair<iterator, bool> insert_template(URef &&val) {
-        assert(*this);
+        if (!initialize()) {
+            return std::make_pair(end(), false);
+        }
         cmagic_set_insert_result_t insert_result = CMAGIC_SET_ALLOCATE(set_handle, &val);
         if (!insert_result.already_exists && insert_result.inserted_or_existing) {
             new(const_cast<void *>(insert_result.inserted_or_existing->key))
@@ -120,6 +210,15 @@ private:
         return std::make_pair(insert_result.inserted_or_existing, insert_unique_success);
     }
 
+    // Destroys the elements and leaves the set uninitialized
+    void release() {
+        if (*this) {
+            clear();
+            CMAGIC_SET_FREE(set_handle);
+            set_handle = nullptr;
+        }
+    }
+
 public:
     /**
      * @brief   Constructs an empty set with standard memory allocation.
@@ -135,45 +234,51 @@ public:
         return set(&CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
     }
 
+    /**
+     * @brief   Replaces the elements with copies of the elements of @p x
+     * @details The copy is made in linear time without any comparison, see @ref CMAGIC_SET_COPY.
+     *          If the allocation fails, the set is left uninitialized.
+     * @param   x set to be copied
+     * @return  reference to this set
+     */
     set &operator=(const set &x) {
-        assert(*this);
-        if (&x == this) {
-            return *this;
-        }
-
-        clear();
-        for (const value_type &val : x) {
-            auto insert_result = insert(val);
-            assert(insert_result.first == end() || insert_result.second);
-            if (insert_result.first == end()) {
-                clear();
-                CMAGIC_SET_FREE(set_handle);
-                set_handle = nullptr;
-                return *this;
-            }
+        if (&x != this) {
+            *this = set(x);
         }
         return *this;
     }
 
-    set(const set &x) : set(CMAGIC_SET_GET_ALLOC_PACKET(x.set_handle)) {
-        if (*this) {
-            operator=(x);
-        }
-    }
+    /**
+     * @copydoc set::operator=(const set &)
+     */
+    set(const set &x)
+    : set_handle(x ? CMAGIC_SET_COPY_EXT(value_type, x.set_handle, copy_function(), destructor())
+                   : nullptr),
+      alloc_packet(x.alloc_packet) {}
 
-    set &operator=(set &&x) {
-        assert(*this);
-        clear();
-        CMAGIC_SET_FREE(set_handle);
-        set_handle = x.set_handle;
-        x.set_handle = CMAGIC_SET_NEW(value_type, key_comparator,
-                                      CMAGIC_SET_GET_ALLOC_PACKET(x.set_handle));
+    /**
+     * @brief   Takes the elements of @p x without any allocation or copying
+     * @details @p x is left uninitialized, as if its allocation had failed: it's empty and holds
+     *          no memory. It can be used as any other set, inserting an element allocates it again
+     *          with the same memory allocation.
+     * @param   x set to take the elements from
+     * @return  reference to this set
+     */
+    set &operator=(set &&x) noexcept {
+        if (&x != this) {
+            release();
+            set_handle = x.set_handle;
+            alloc_packet = x.alloc_packet;
+            x.set_handle = nullptr;
+        }
         return *this;
     }
 
-    set(set &&x) : set_handle(x.set_handle) {
-        x.set_handle = CMAGIC_SET_NEW(value_type, key_comparator,
-                                      CMAGIC_SET_GET_ALLOC_PACKET(x.set_handle));
+    /**
+     * @copydoc set::operator=(set &&)
+     */
+    set(set &&x) noexcept : set_handle(x.set_handle), alloc_packet(x.alloc_packet) {
+        x.set_handle = nullptr;
     }
 
     /**
@@ -187,8 +292,8 @@ public:
      *              std::cerr << "Set allocation failed!\n";
      *          }
      *          @endcode
-     * @return  @c true if set is initialized, @c false if set allocation has failed and no
-     *          operation should be made on it
+     * @return  @c true if set is initialized, @c false if set allocation has failed or the set
+     *          was moved from. Operations inserting elements into it try to allocate it again.
      */
     operator bool() const {
         return static_cast<bool>(set_handle);
@@ -201,8 +306,7 @@ public:
      * @return  an iterator to the beginning of the container
      */
     iterator begin() const {
-        assert(set_handle);
-        return CMAGIC_SET_FIRST(set_handle);
+        return set_handle ? CMAGIC_SET_FIRST(set_handle) : nullptr;
     }
 
     /**
@@ -211,19 +315,26 @@ public:
      * @return  an iterator to the element past the end of the sequence
      */
     iterator end() const {
-        assert(set_handle);
         return nullptr;
     }
 
     /**
      * @brief   Removes all elements from the set, leaving the container with a size of 0.
+     * @details Elements are destroyed and deallocated in a single pass. Destructors are not called
+     *          at all if the element type is trivially destructible.
      */
     void clear() {
-        assert(*this);
-        for (const value_type &key : *this) {
-            key.~value_type();
+        if (!*this) {
+            return;
+        }
+        if (std::is_trivially_destructible<value_type>::value) {
+            CMAGIC_SET_CLEAR(set_handle);
+            return;
         }
-        CMAGIC_SET_CLEAR(set_handle);
+
+        CMAGIC_SET_CLEAR_EXT(set_handle, [](void *raw_key) {
+            static_cast<value_type *>(raw_key)->~value_type();
+        });
     }
 
     /**
@@ -256,19 +367,35 @@ public:
      *          exist in the set.
      */
     void erase(const value_type &val) {
-        assert(*this);
+        if (!*this) {
+            return;
+        }
         CMAGIC_SET_ERASE_EXT(set_handle, &val, [](void *key) {
             static_cast<value_type *>(key)->~value_type();
         });
     }
 
+    /**
+     * @brief   Removes a single element from the set without constructing a temporary value
+     * @param   val value of any type which can be compared with @ref set::value_type by
+     *          @c operator<, e.g. a string literal for a set of @c std::string
+     */
+    template<typename K>
+    enable_if_comparable<K, void> erase(const K &val) {
+        if (!*this) {
+            return;
+        }
+        CMAGIC_SET_ERASE_BY_EXT(set_handle, &val, probe_comparator<K>, [](void *key) {
+            static_cast<value_type *>(key)->~value_type();
+        });
+    }
+
     /**
      * @brief   Returns the number of elements in the set.
      * @return  number of elements in the set
      */
     size_type size() const {
-        assert(*this);
-        return CMAGIC_SET_SIZE(set_handle);
+        return set_handle ? CMAGIC_SET_SIZE(set_handle) : 0;
     }
 
     /**
@@ -281,6 +408,14 @@ public:
         return size() == 0;
     }
 
+    /**
+     * @brief   Returns the comparison object ordering the elements
+     * @return  a copy of the comparison object
+     */
+    key_compare key_comp() const {
+        return key_compare();
+    }
+
     /**
      * @brief   Searches the container for an element equivalent to @p val and returns an iterator
      *          to it if found, otherwise it returns @ref set::end.
@@ -288,18 +423,200 @@ public:
      * @return  an iterator to the element, if @p val is found, or @ref set::end otherwise
      */
     iterator find(const value_type &val) const {
-        return CMAGIC_SET_FIND(set_handle, &val);
+        return set_handle ? CMAGIC_SET_FIND(set_handle, &val) : nullptr;
     }
 
-    ~set() {
-        if (*this) {
-            clear();
-            CMAGIC_SET_FREE(set_handle);
+    /**
+     * @brief   Searches the container for an element equivalent to @p val without constructing a
+     *          temporary value
+     * @param   val value of any type which can be compared with @ref set::value_type by
+     *          @c operator<, e.g. a string literal for a set of @c std::string
+     * @return  an iterator to the element, if @p val is found, or @ref set::end otherwise
+     */
+    template<typename K>
+    enable_if_comparable<K, iterator> find(const K &val) const {
+        return set_handle ? CMAGIC_SET_FIND_BY(set_handle, &val, probe_comparator<K>) : nullptr;
+    }
+
+    /**
+     * @brief   Counts the elements equivalent to @p val
+     * @param   val value to be searched for
+     * @return  1 if @p val is found, 0 otherwise
+     */
+    size_type count(const value_type &val) const {
+        return find(val) != end() ? 1 : 0;
+    }
+
+    /**
+     * @copydoc set::count
+     * @details Accepts a value of any type which can be compared with @ref set::value_type.
+     */
+    template<typename K>
+    enable_if_comparable<K, size_type> count(const K &val) const {
+        return find(val) != end() ? 1 : 0;
+    }
+
+    /**
+     * @brief   Returns an iterator pointing to the first element in the container which is not
+     *          considered to go before @p val
+     * @param   val value to be compared with
+     * @return  an iterator to the first element equivalent to or going after @p val, or @ref
+     *          set::end if all elements go before @p val
+     */
+    iterator lower_bound(const value_type &val) const {
+        return set_handle ? CMAGIC_SET_LOWER_BOUND(set_handle, &val) : nullptr;
+    }
+
+    /**
+     * @copydoc set::lower_bound
+     * @details Accepts a value of any type which can be compared with @ref set::value_type.
+     */
+    template<typename K>
+    enable_if_comparable<K, iterator> lower_bound(const K &val) const {
+        return set_handle ? CMAGIC_SET_LOWER_BOUND_BY(set_handle, &val, probe_comparator<K>)
+                          : nullptr;
+    }
+
+    /**
+     * @brief   Returns an iterator pointing to the first element in the container which is
+     *          considered to go after @p val
+     * @param   val value to be compared with
+     * @return  an iterator to the first element going after @p val, or @ref set::end if no such
+     *          element exists
+     */
+    iterator upper_bound(const value_type &val) const {
+        return set_handle ? CMAGIC_SET_UPPER_BOUND(set_handle, &val) : nullptr;
+    }
+
+    /**
+     * @copydoc set::upper_bound
+     * @details Accepts a value of any type which can be compared with @ref set::value_type.
+     */
+    template<typename K>
+    enable_if_comparable<K, iterator> upper_bound(const K &val) const {
+        return set_handle ? CMAGIC_SET_UPPER_BOUND_BY(set_handle, &val, probe_comparator<K>)
+                          : nullptr;
+    }
+
+    /**
+     * @brief   Returns the bounds of a range that includes all the elements in the container which
+     *          are equivalent to @p val
+     * @details Because elements in a set are unique, the range contains at most one element.
+     * @param   val value to be compared with
+     * @return  a pair, whose member @c pair::first is the lower bound of the range (the same as
+     *          @ref set::lower_bound), and @c pair::second is the upper bound (the same as @ref
+     *          set::upper_bound)
+     */
+    std::pair<iterator, iterator> equal_range(const value_type &val) const {
+        if (!set_handle) {
+            return std::make_pair(end(), end());
+        }
+        cmagic_set_range_t range = CMAGIC_SET_EQUAL_RANGE(set_handle, &val);
+        return std::make_pair(iterator {range.begin}, iterator {range.end});
+    }
+
+    /**
+     * @copydoc set::equal_range
+     * @details Accepts a value of any type which can be compared with @ref set::value_type.
+     */
+    template<typename K>
+    enable_if_comparable<K, std::pair<iterator, iterator>> equal_range(const K &val) const {
+        if (!set_handle) {
+            return std::make_pair(end(), end());
+        }
+        cmagic_set_range_t range = CMAGIC_SET_EQUAL_RANGE_BY(set_handle, &val, probe_comparator<K>);
+        return std::make_pair(iterator {range.begin}, iterator {range.end});
+    }
+
+    /**
+     * @brief   Moves all elements which do not go before @p val to @p right
+     * @details Whole subtrees are relinked in logarithmic time, no element is copied or moved.
+     * @warning @p right must be empty and use the same kind of memory allocation.
+     * @param   val first value to be moved
+     * @param   right empty set to receive the elements
+     * @return  @c true on success, @c false if @p right was uninitialized and its allocation has
+     *          failed, in which case both sets are unchanged
+     */
+    bool split(const value_type &val, set &right) {
+        assert(right.empty());
+        if (empty()) {
+            return true;
+        }
+        return right.initialize() && CMAGIC_SET_SPLIT(set_handle, &val, right.set_handle);
+    }
+
+    /**
+     * @brief   Moves all elements of @p right to this set in logarithmic time
+     * @warning All elements of @p right must go after all elements of this set. Both sets must use
+     *          the same kind of memory allocation.
+     * @param   right set to take the elements from
+     * @return  always @c true, the operation does not allocate memory
+     */
+    bool join(set &right) {
+        if (!*this) {
+            *this = std::move(right);
+            return true;
         }
+        return !right || CMAGIC_SET_JOIN(set_handle, right.set_handle);
+    }
+
+    ~set() {
+        release();
     }
 
 };
 
+/**
+ * @brief   Constructs a set containing the elements present in any of two sets
+ * @details Works in linear time. The result uses the same kind of memory allocation as @p x.
+ * @param   x first set
+ * @param   y second set
+ * @return  a new set, which is not initialized (see @ref set::operator bool) if the allocation has
+ *          failed
+ */
+template<typename T, typename Compare>
+set<T, Compare> set_union(const set<T, Compare> &x, const set<T, Compare> &y) {
+    using set_type = set<T, Compare>;
+    const cmagic_set_copy_function_t copy = set_type::copy_function();
+    return set_type::apply(x, y, [copy](CMAGIC_SET(T) x_handle, CMAGIC_SET(T) y_handle) {
+        return CMAGIC_SET_UNION_EXT(T, x_handle, y_handle, copy);
+    });
+}
+
+/**
+ * @brief   Constructs a set containing the elements present in both sets
+ * @details Works in linear time. The result uses the same kind of memory allocation as @p x.
+ * @param   x first set
+ * @param   y second set
+ * @return  a new set, which is not initialized (see @ref set::operator bool) if the allocation has
+ *          failed
+ */
+template<typename T, typename Compare>
+set<T, Compare> set_intersection(const set<T, Compare> &x, const set<T, Compare> &y) {
+    using set_type = set<T, Compare>;
+    const cmagic_set_copy_function_t copy = set_type::copy_function();
+    return set_type::apply(x, y, [copy](CMAGIC_SET(T) x_handle, CMAGIC_SET(T) y_handle) {
+        return CMAGIC_SET_INTERSECTION_EXT(T, x_handle, y_handle, copy);
+    });
+}
+
+/**
+ * @brief   Constructs a set containing the elements of @p x which are not present in @p y
+ * @details Works in linear time. The result uses the same kind of memory allocation as @p x.
+ * @param   x first set
+ * @param   y second set
+ * @return  a new set, which is not initialized (see @ref set::operator bool) if the allocation has
+ *          failed
+ */
+template<typename T, typename Compare>
+set<T, Compare> set_difference(const set<T, Compare> &x, const set<T, Compare> &y) {
+    using set_type = set<T, Compare>;
+    const cmagic_set_copy_function_t copy = set_type::copy_function();
+    return set_type::apply(x, y, [copy](CMAGIC_SET(T) x_handle, CMAGIC_SET(T) y_handle) {
+        return CMAGIC_SET_DIFFERENCE_EXT(T, x_handle, y_handle, copy);
+    });
+}
+
 } // namespace cmagic
 
 #endif /* CMAGIC_SET_HPP */
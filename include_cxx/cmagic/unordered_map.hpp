@@ -0,0 +1,599 @@
+/**
+ * @file    unordered_map.hpp
+ * @brief   Template implementation of an @b unordered_map container.
+ * @details This is a wrapper over C implementation from @ref hashmap.h
+ */
+
+#ifndef CMAGIC_UNORDERED_MAP_HPP
+#define CMAGIC_UNORDERED_MAP_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "cmagic/hash.hpp"
+#include "cmagic/hashmap.h"
+
+
+namespace cmagic {
+
+/**
+ * @brief   An unordered container of key-value pairs with unique keys.
+ * @details Unordered map is an open addressing hash table storing the elements inline in a single
+ *          array, see @ref hashmap.h. Unlike @c std::unordered_map inserting an element may move
+ *          the other ones, which invalidates all iterators and references to the elements. Keys
+ *          are hashed by @p Hash and compared by @p KeyEqual, both have to be stateless function
+ *          objects.
+ */
+template<typename Key, typename Value, typename Hash = hash<Key>,
+         typename KeyEqual = std::equal_to<Key>>
+class unordered_map {
+
+public:
+    /**
+     * @brief   Type of unordered map keys
+     */
+    using key_type = Key;
+
+    /**
+     * @brief   Type of unordered map values
+     */
+    using mapped_type = Value;
+
+    /**
+     * @brief   Type of unordered map elements
+     */
+    using value_type = std::pair<key_type, mapped_type>;
+
+    /**
+     * @brief   Type of the function object hashing the keys. It must be stateless.
+     */
+    using hasher = Hash;
+
+    /**
+     * @brief   Type of the function object comparing the keys. It must be stateless.
+     */
+    using key_equal = KeyEqual;
+
+    /**
+     * @brief   Type used to measure element size
+     */
+    using size_type = size_t;
+
+    /**
+     * @brief   Reference to an unordered map element, obtained by dereferencing an iterator
+     * @details Binds the key and the value stored in the table, neither of them is copied.
+     */
+    template<typename Mapped>
+    struct basic_reference {
+        const key_type &first;
+        Mapped &second;
+
+        /**
+         * @brief   Copies the referenced element
+         */
+        operator value_type() const {
+            return value_type(first, second);
+        }
+    };
+
+    /**
+     * @brief   Result of the arrow operator of an iterator, which gives access to the members of
+     *          @ref unordered_map::basic_reference
+     */
+    template<typename Mapped>
+    class basic_pointer {
+        basic_reference<Mapped> element;
+
+    public:
+        explicit basic_pointer(const basic_reference<Mapped> &element_arg) : element(element_arg) {}
+        const basic_reference<Mapped> *operator->() const { return &element; }
+    };
+
+    /**
+     * @brief   Forward iterator over the unordered map elements in unspecified order
+     * @details A mutable iterator converts to a constant one.
+     */
+    template<bool is_const>
+    class basic_iterator {
+        friend class unordered_map;
+
+        template<bool other_is_const>
+        friend class basic_iterator;
+
+        using mapped_access_type =
+            typename std::conditional<is_const, const mapped_type, mapped_type>::type;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = unordered_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = basic_reference<mapped_access_type>;
+        using pointer = basic_pointer<mapped_access_type>;
+
+    private:
+        CMAGIC_HASHMAP(key_type) hashmap_handle;
+        cmagic_hashmap_iterator_t internal_iterator;
+
+        basic_iterator(CMAGIC_HASHMAP(key_type) handle, cmagic_hashmap_iterator_t initializer)
+        : hashmap_handle(handle), internal_iterator(initializer) {}
+
+    public:
+        basic_iterator() : hashmap_handle(nullptr), internal_iterator {nullptr, nullptr} {}
+
+        template<bool other_is_const,
+                 typename = typename std::enable_if<is_const && !other_is_const>::type>
+        basic_iterator(const basic_iterator<other_is_const> &other)
+        : hashmap_handle(other.hashmap_handle), internal_iterator(other.internal_iterator) {}
+
+        reference operator*() const {
+            assert(internal_iterator.key);
+            return reference {*static_cast<const key_type *>(internal_iterator.key),
+                              *static_cast<mapped_type *>(internal_iterator.value)};
+        }
+
+        pointer operator->() const { return pointer(**this); }
+
+        basic_iterator &operator++() {
+            assert(internal_iterator.key);
+            internal_iterator = CMAGIC_HASHMAP_ITERATOR_NEXT(hashmap_handle, internal_iterator);
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator to_return = *this;
+            ++(*this);
+            return to_return;
+        }
+
+        template<bool other_is_const>
+        bool operator==(const basic_iterator<other_is_const> &other) const {
+            return this->internal_iterator.key == other.internal_iterator.key;
+        }
+
+        template<bool other_is_const>
+        bool operator!=(const basic_iterator<other_is_const> &other) const {
+            return !(*this == other);
+        }
+
+    };
+
+    /**
+     * @brief   Iterator giving access to the keys and modifiable values
+     */
+    using iterator = basic_iterator<false>;
+
+    /**
+     * @brief   Iterator giving read-only access to the elements
+     */
+    using const_iterator = basic_iterator<true>;
+
+private:
+    static_assert(std::is_copy_constructible<key_type>(), "key type must be copy-constructible");
+    static_assert(std::is_copy_constructible<mapped_type>(),
+                  "mapped type must be copy-constructible");
+    static_assert(std::is_empty<hasher>::value && std::is_default_constructible<hasher>::value,
+                  "hash object must be stateless");
+    static_assert(std::is_empty<key_equal>::value
+                      && std::is_default_constructible<key_equal>::value,
+                  "key equality object must be stateless");
+
+    CMAGIC_HASHMAP(key_type) hashmap_handle;
+    // Memory allocation of the unordered map, kept to allocate it again once it's uninitialized
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+
+    static size_t hash_function(const void *key) {
+        return hasher()(*static_cast<const key_type *>(key));
+    }
+
+    static bool key_equal_function(const void *key1, const void *key2) {
+        return key_equal()(*static_cast<const key_type *>(key1),
+                           *static_cast<const key_type *>(key2));
+    }
+
+    static cmagic_hashmap_relocate_function_t relocate_function() {
+        if (std::is_trivially_copyable<key_type>::value
+                && std::is_trivially_copyable<mapped_type>::value) {
+            return nullptr;
+        }
+        return [](void *destination_key, void *destination_value, void *source_key,
+                  void *source_value) {
+            key_type &key = *static_cast<key_type *>(source_key);
+            mapped_type &value = *static_cast<mapped_type *>(source_value);
+            new(destination_key) key_type(std::move(key));
+            new(destination_value) mapped_type(std::move(value));
+            key.~key_type();
+            value.~mapped_type();
+        };
+    }
+
+    static cmagic_hashmap_copy_function_t copy_function() {
+        if (std::is_trivially_copyable<key_type>::value
+                && std::is_trivially_copyable<mapped_type>::value) {
+            return nullptr;
+        }
+        return [](void *destination_key, void *destination_value, const void *source_key,
+                  const void *source_value) {
+            new(destination_key) key_type(*static_cast<const key_type *>(source_key));
+            new(destination_value) mapped_type(*static_cast<const mapped_type *>(source_value));
+        };
+    }
+
+    static cmagic_hashmap_erase_destructor_t destructor() {
+        if (std::is_trivially_destructible<key_type>::value
+                && std::is_trivially_destructible<mapped_type>::value) {
+            return nullptr;
+        }
+        return [](void *raw_key, void *raw_value) {
+            static_cast<key_type *>(raw_key)->~key_type();
+            static_cast<mapped_type *>(raw_value)->~mapped_type();
+        };
+    }
+
+    explicit unordered_map(const cmagic_memory_alloc_packet_t *alloc_packet_arg)
+    : hashmap_handle(CMAGIC_HASHMAP_NEW_EXT(key_type, mapped_type, hash_function,
+                                            key_equal_function, alloc_packet_arg,
+                                            relocate_function())),
+      alloc_packet(alloc_packet_arg) {}
+
+    // Allocates an uninitialized unordered map again
+    bool initialize() {
+        if (!hashmap_handle) {
+            hashmap_handle = CMAGIC_HASHMAP_NEW_EXT(key_type, mapped_type, hash_function,
+                                                    key_equal_function, alloc_packet,
+                                                    relocate_function());
+        }
+        return static_cast<bool>(hashmap_handle);
+    }
+
+    iterator make_iterator(cmagic_hashmap_iterator_t internal_iterator) {
+        return iterator(hashmap_handle, internal_iterator);
+    }
+
+    const_iterator make_iterator(cmagic_hashmap_iterator_t internal_iterator) const {
+        return const_iterator(hashmap_handle, internal_iterator);
+    }
+
+    /*
+     * Allocates the element with a single lookup. The key and the value are constructed in place
+     * only if the key is not present yet.
+     */
+    template <typename Key_URef, typename... Args>
+    std::pair<iterator, bool> emplace_template(Key_URef &&key, Args &&...args) {
+        if (!initialize()) {
+            return std::make_pair(end(), false);
+        }
+        cmagic_hashmap_insert_result_t insert_result =
+            CMAGIC_HASHMAP_ALLOCATE(hashmap_handle, &key);
+        cmagic_hashmap_iterator_t inserted = insert_result.inserted_or_existing;
+        if (!insert_result.already_exists && inserted.key) {
+            new(const_cast<void *>(inserted.key)) key_type(std::forward<Key_URef>(key));
+            new(inserted.value) mapped_type(std::forward<Args>(args)...);
+        }
+        const bool insert_unique_success = inserted.key && !insert_result.already_exists;
+        return std::make_pair(make_iterator(inserted), insert_unique_success);
+    }
+
+    // Destroys the elements and leaves the unordered map uninitialized
+    void release() {
+        if (*this) {
+            clear();
+            CMAGIC_HASHMAP_FREE(hashmap_handle);
+            hashmap_handle = nullptr;
+        }
+    }
+
+public:
+    /**
+     * @brief   Constructs an empty unordered map with standard memory allocation.
+     * @details No element array is allocated until the first insertion.
+     * @return  a new empty unordered map
+     */
+    unordered_map() : unordered_map(&CMAGIC_MEMORY_ALLOC_PACKET_STD) {}
+
+    /**
+     * @brief   Constructs an empty unordered map using custom @e CMagic memory allocation from
+     *          @ref memory.h
+     * @return  a new empty unordered map
+     */
+    static unordered_map custom_allocation_unordered_map() {
+        return unordered_map(&CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    }
+
+    /**
+     * @brief   Replaces the elements with copies of the elements of @p x
+     * @details The element array is copied as a whole, so no key is hashed. If the allocation
+     *          fails, the unordered map is left uninitialized.
+     * @param   x unordered map to be copied
+     * @return  reference to this unordered map
+     */
+    unordered_map &operator=(const unordered_map &x) {
+        if (&x != this) {
+            *this = unordered_map(x);
+        }
+        return *this;
+    }
+
+    /**
+     * @copydoc unordered_map::operator=(const unordered_map &)
+     */
+    unordered_map(const unordered_map &x)
+    : hashmap_handle(x ? CMAGIC_HASHMAP_COPY_EXT(key_type, x.hashmap_handle, copy_function())
+                       : nullptr),
+      alloc_packet(x.alloc_packet) {}
+
+    /**
+     * @brief   Takes the elements of @p x without any allocation or copying
+     * @details @p x is left uninitialized, as if its allocation had failed: it's empty and holds
+     *          no memory. It can be used as any other unordered map, inserting an element
+     *          allocates it again with the same memory allocation.
+     * @param   x unordered map to take the elements from
+     * @return  reference to this unordered map
+     */
+    unordered_map &operator=(unordered_map &&x) noexcept {
+        if (&x != this) {
+            release();
+            hashmap_handle = x.hashmap_handle;
+            alloc_packet = x.alloc_packet;
+            x.hashmap_handle = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * @copydoc unordered_map::operator=(unordered_map &&)
+     */
+    unordered_map(unordered_map &&x) noexcept
+    : hashmap_handle(x.hashmap_handle), alloc_packet(x.alloc_packet) {
+        x.hashmap_handle = nullptr;
+    }
+
+    /**
+     * @brief   Checks if the unordered map is properly initialized
+     * @return  @c true if unordered map is initialized, @c false if its allocation has failed or
+     *          it was moved from. Operations inserting elements into it try to allocate it again.
+     */
+    explicit operator bool() const {
+        return static_cast<bool>(hashmap_handle);
+    }
+
+    /**
+     * @brief   Return iterator to beginning
+     * @return  an iterator to the first element or @ref unordered_map::end if the unordered map
+     *          is empty
+     */
+    iterator begin() {
+        return hashmap_handle ? make_iterator(CMAGIC_HASHMAP_FIRST(hashmap_handle)) : end();
+    }
+
+    /**
+     * @copydoc unordered_map::begin
+     */
+    const_iterator begin() const {
+        return hashmap_handle ? make_iterator(CMAGIC_HASHMAP_FIRST(hashmap_handle)) : end();
+    }
+
+    /**
+     * @copydoc unordered_map::begin
+     */
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    /**
+     * @brief   Return iterator to end
+     * @details It does not point to any element, and thus shall not be dereferenced.
+     * @return  an iterator to the element past the end of the sequence
+     */
+    iterator end() {
+        return iterator();
+    }
+
+    /**
+     * @copydoc unordered_map::end
+     */
+    const_iterator end() const {
+        return const_iterator();
+    }
+
+    /**
+     * @copydoc unordered_map::end
+     */
+    const_iterator cend() const {
+        return end();
+    }
+
+    /**
+     * @brief   Removes all elements from the unordered map, leaving the container with a size of 0.
+     * @details The element array is kept. Destructors are not called at all if both key and value
+     *          types are trivially destructible.
+     */
+    void clear() {
+        if (*this) {
+            CMAGIC_HASHMAP_CLEAR_EXT(hashmap_handle, destructor());
+        }
+    }
+
+    /**
+     * @brief   Inserts a new element if its key is not present yet
+     * @param   val value to be copied (or moved) to the unordered map
+     * @return  a pair, with its member @c pair::first set to an iterator pointing to either the
+     *          newly inserted element or to the element with an equal key in the unordered map.
+     *          The @c pair::second element in the pair is set to @c true if a new element was
+     *          inserted or @c false if an equal key already existed or the allocation has failed,
+     *          in which case @c pair::first is @ref unordered_map::end.
+     */
+    std::pair<iterator, bool> insert(const value_type &val) {
+        return emplace_template(val.first, val.second);
+    }
+
+    /**
+     * @copydoc unordered_map::insert
+     */
+    std::pair<iterator, bool> insert(value_type &&val) {
+        return emplace_template(std::move(val.first), std::move(val.second));
+    }
+
+    /**
+     * @brief   Inserts a new element constructed from @p args if its key is not present yet
+     * @details The element is constructed before the lookup, so its arguments are consumed even
+     *          if the key already exists. Use @ref unordered_map::try_emplace to avoid it.
+     * @param   args arguments forwarded to the constructor of @ref unordered_map::value_type
+     * @return  the same as @ref unordered_map::insert
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args &&...args) {
+        value_type element(std::forward<Args>(args)...);
+        return emplace_template(std::move(element.first), std::move(element.second));
+    }
+
+    /**
+     * @brief   Inserts a new element with the value constructed from @p args if @p key is not
+     *          present yet
+     * @details Neither @p key nor @p args are consumed if the key already exists.
+     * @param   key key of the element
+     * @param   args arguments forwarded to the constructor of @ref unordered_map::mapped_type
+     * @return  the same as @ref unordered_map::insert
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const key_type &key, Args &&...args) {
+        return emplace_template(key, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @copydoc unordered_map::try_emplace
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type &&key, Args &&...args) {
+        return emplace_template(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief   Returns the value of the element with the given key, inserting a value-initialized
+     *          value if the key is not present in the unordered map
+     * @details The key is looked up only once.
+     * @warning The behavior is undefined if the allocation of a new element fails. Use
+     *          @ref unordered_map::try_emplace if it has to be handled.
+     * @param   key key of the element
+     * @return  reference to the value
+     */
+    mapped_type &operator[](const key_type &key) {
+        std::pair<iterator, bool> result = emplace_template(key);
+        assert(result.first != end());
+        return result.first->second;
+    }
+
+    /**
+     * @copydoc unordered_map::operator[]
+     */
+    mapped_type &operator[](key_type &&key) {
+        std::pair<iterator, bool> result = emplace_template(std::move(key));
+        assert(result.first != end());
+        return result.first->second;
+    }
+
+    /**
+     * @brief   Removes a single element from the unordered map
+     * @param   key key of the element to be removed
+     * @return  number of removed elements, 0 or 1
+     */
+    size_type erase(const key_type &key) {
+        if (!*this) {
+            return 0;
+        }
+        cmagic_hashmap_iterator_t found = CMAGIC_HASHMAP_FIND(hashmap_handle, &key);
+        if (!found.key) {
+            return 0;
+        }
+        CMAGIC_HASHMAP_ERASE_ITERATOR_EXT(hashmap_handle, found, destructor());
+        return 1;
+    }
+
+    /**
+     * @brief   Removes the single element pointed to by @p position
+     * @details No element is moved, so iterators to other elements stay valid.
+     * @param   position iterator to the element to be removed
+     * @return  an iterator to the element following the removed one
+     */
+    iterator erase(const_iterator position) {
+        assert(*this);
+        assert(position != end());
+        cmagic_hashmap_iterator_t next =
+            CMAGIC_HASHMAP_ITERATOR_NEXT(hashmap_handle, position.internal_iterator);
+        CMAGIC_HASHMAP_ERASE_ITERATOR_EXT(hashmap_handle, position.internal_iterator,
+                                          destructor());
+        return make_iterator(next);
+    }
+
+    /**
+     * @brief   Makes room for @p count elements, so inserting them moves no element
+     * @param   count number of elements
+     * @return  @c true on success, @c false if the allocation has failed
+     */
+    bool reserve(size_type count) {
+        return initialize() && CMAGIC_HASHMAP_RESERVE(hashmap_handle, count);
+    }
+
+    /**
+     * @brief   Returns the number of elements in the unordered map
+     * @return  number of elements in the unordered map
+     */
+    size_type size() const {
+        return hashmap_handle ? CMAGIC_HASHMAP_SIZE(hashmap_handle) : 0;
+    }
+
+    /**
+     * @brief   Returns whether the unordered map is empty (i.e. whether its size is 0).
+     * @return  @c true if the container size is 0, @c false otherwise
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief   Returns the number of slots of the element array
+     * @return  number of slots, 0 if no element array has been allocated yet
+     */
+    size_type capacity() const {
+        return hashmap_handle ? CMAGIC_HASHMAP_CAPACITY(hashmap_handle) : 0;
+    }
+
+    /**
+     * @brief   Searches the container for an element with a key equal to @p key
+     * @param   key key to be searched for
+     * @return  an iterator to the element, if @p key is found, or @ref unordered_map::end
+     *          otherwise
+     */
+    iterator find(const key_type &key) {
+        return hashmap_handle ? make_iterator(CMAGIC_HASHMAP_FIND(hashmap_handle, &key)) : end();
+    }
+
+    /**
+     * @copydoc unordered_map::find
+     */
+    const_iterator find(const key_type &key) const {
+        return hashmap_handle ? make_iterator(CMAGIC_HASHMAP_FIND(hashmap_handle, &key)) : end();
+    }
+
+    /**
+     * @brief   Counts elements with a specific key
+     * @param   key key to be searched for
+     * @return  1 if the container contains an element whose key is equal to @p key, or 0
+     *          otherwise
+     */
+    size_type count(const key_type &key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    ~unordered_map() {
+        release();
+    }
+
+};
+
+} // namespace cmagic
+
+#endif /* CMAGIC_UNORDERED_MAP_HPP */
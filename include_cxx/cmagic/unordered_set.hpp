@@ -0,0 +1,447 @@
+/**
+ * @file    unordered_set.hpp
+ * @brief   Template implementation of an @b unordered_set container.
+ * @details This is a wrapper over C implementation from @ref hashset.h
+ */
+
+#ifndef CMAGIC_UNORDERED_SET_HPP
+#define CMAGIC_UNORDERED_SET_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "cmagic/hash.hpp"
+#include "cmagic/hashset.h"
+
+
+namespace cmagic {
+
+/**
+ * @brief   An unordered container of unique keys.
+ * @details Unordered set is an open addressing hash table storing the keys inline in a single
+ *          array, see @ref hashset.h. Unlike @c std::unordered_set inserting a key may move the
+ *          other ones, which invalidates all iterators and references to the keys. Keys are hashed
+ *          by @p Hash and compared by @p KeyEqual, both have to be stateless function objects.
+ */
+template<typename T, typename Hash = hash<T>, typename KeyEqual = std::equal_to<T>>
+class unordered_set {
+
+public:
+    /**
+     * @brief   Type of unordered set keys
+     */
+    using key_type = T;
+
+    /**
+     * @brief   Type of unordered set elements, the same as @ref unordered_set::key_type
+     */
+    using value_type = T;
+
+    /**
+     * @brief   Type of the function object hashing the keys. It must be stateless.
+     */
+    using hasher = Hash;
+
+    /**
+     * @brief   Type of the function object comparing the keys. It must be stateless.
+     */
+    using key_equal = KeyEqual;
+
+    /**
+     * @brief   Type used to measure element size
+     */
+    using size_type = size_t;
+
+    /**
+     * @brief   Forward iterator over the unordered set keys in unspecified order
+     */
+    class iterator {
+        friend class unordered_set;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+    private:
+        CMAGIC_HASHSET(value_type) hashset_handle;
+        cmagic_hashset_iterator_t internal_iterator;
+
+        iterator(CMAGIC_HASHSET(value_type) handle, cmagic_hashset_iterator_t initializer)
+        : hashset_handle(handle), internal_iterator(initializer) {}
+
+    public:
+        iterator() : hashset_handle(nullptr), internal_iterator(nullptr) {}
+
+        reference operator*() const { return *this->operator->(); }
+
+        pointer operator->() const {
+            assert(internal_iterator);
+            return static_cast<pointer>(internal_iterator);
+        }
+
+        iterator &operator++() {
+            assert(internal_iterator);
+            internal_iterator = CMAGIC_HASHSET_ITERATOR_NEXT(hashset_handle, internal_iterator);
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator to_return = *this;
+            ++(*this);
+            return to_return;
+        }
+
+        bool operator==(const iterator &other) const {
+            return this->internal_iterator == other.internal_iterator;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+    };
+
+    /**
+     * @brief   Same as @ref unordered_set::iterator, since elements of a set cannot be modified
+     */
+    using const_iterator = iterator;
+
+private:
+    static_assert(std::is_copy_constructible<value_type>(),
+                  "value type must be copy-constructible");
+    static_assert(std::is_empty<hasher>::value && std::is_default_constructible<hasher>::value,
+                  "hash object must be stateless");
+    static_assert(std::is_empty<key_equal>::value
+                      && std::is_default_constructible<key_equal>::value,
+                  "key equality object must be stateless");
+
+    CMAGIC_HASHSET(value_type) hashset_handle;
+    // Memory allocation of the unordered set, kept to allocate it again once it's uninitialized
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+
+    static size_t hash_function(const void *key) {
+        return hasher()(*static_cast<const value_type *>(key));
+    }
+
+    static bool key_equal_function(const void *key1, const void *key2) {
+        return key_equal()(*static_cast<const value_type *>(key1),
+                           *static_cast<const value_type *>(key2));
+    }
+
+    static cmagic_hashset_relocate_function_t relocate_function() {
+        if (std::is_trivially_copyable<value_type>::value) {
+            return nullptr;
+        }
+        return [](void *destination, void *source) {
+            value_type &key = *static_cast<value_type *>(source);
+            new(destination) value_type(std::move(key));
+            key.~value_type();
+        };
+    }
+
+    static cmagic_hashset_copy_function_t copy_function() {
+        if (std::is_trivially_copyable<value_type>::value) {
+            return nullptr;
+        }
+        return [](void *destination, const void *source) {
+            new(destination) value_type(*static_cast<const value_type *>(source));
+        };
+    }
+
+    static cmagic_hashset_erase_destructor_t destructor() {
+        if (std::is_trivially_destructible<value_type>::value) {
+            return nullptr;
+        }
+        return [](void *key) {
+            static_cast<value_type *>(key)->~value_type();
+        };
+    }
+
+    explicit unordered_set(const cmagic_memory_alloc_packet_t *alloc_packet_arg)
+    : hashset_handle(CMAGIC_HASHSET_NEW_EXT(value_type, hash_function, key_equal_function,
+                                            alloc_packet_arg, relocate_function())),
+      alloc_packet(alloc_packet_arg) {}
+
+    // Allocates an uninitialized unordered set again
+    bool initialize() {
+        if (!hashset_handle) {
+            hashset_handle = CMAGIC_HASHSET_NEW_EXT(value_type, hash_function, key_equal_function,
+                                                    alloc_packet, relocate_function());
+        }
+        return static_cast<bool>(hashset_handle);
+    }
+
+    iterator make_iterator(cmagic_hashset_iterator_t internal_iterator) const {
+        return iterator(hashset_handle, internal_iterator);
+    }
+
+    template <typename URef>
+    std::pair<iterator, bool> insert_template(URef &&val) {
+        if (!initialize()) {
+            return std::make_pair(end(), false);
+        }
+        cmagic_hashset_insert_result_t insert_result =
+            CMAGIC_HASHSET_ALLOCATE(hashset_handle, &val);
+        if (!insert_result.already_exists && insert_result.inserted_or_existing) {
+            new(const_cast<void *>(insert_result.inserted_or_existing))
+                value_type(std::forward<URef>(val));
+        }
+        const bool insert_unique_success =
+            insert_result.inserted_or_existing && !insert_result.already_exists;
+        return std::make_pair(make_iterator(insert_result.inserted_or_existing),
+                              insert_unique_success);
+    }
+
+    // Destroys the elements and leaves the unordered set uninitialized
+    void release() {
+        if (*this) {
+            clear();
+            CMAGIC_HASHSET_FREE(hashset_handle);
+            hashset_handle = nullptr;
+        }
+    }
+
+public:
+    /**
+     * @brief   Constructs an empty unordered set with standard memory allocation.
+     * @details No key array is allocated until the first insertion.
+     * @return  a new empty unordered set
+     */
+    unordered_set() : unordered_set(&CMAGIC_MEMORY_ALLOC_PACKET_STD) {}
+
+    /**
+     * @brief   Constructs an empty unordered set using custom @e CMagic memory allocation from
+     *          @ref memory.h
+     * @return  a new empty unordered set
+     */
+    static unordered_set custom_allocation_unordered_set() {
+        return unordered_set(&CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    }
+
+    /**
+     * @brief   Replaces the elements with copies of the elements of @p x
+     * @details The key array is copied as a whole, so no key is hashed. If the allocation fails,
+     *          the unordered set is left uninitialized.
+     * @param   x unordered set to be copied
+     * @return  reference to this unordered set
+     */
+    unordered_set &operator=(const unordered_set &x) {
+        if (&x != this) {
+            *this = unordered_set(x);
+        }
+        return *this;
+    }
+
+    /**
+     * @copydoc unordered_set::operator=(const unordered_set &)
+     */
+    unordered_set(const unordered_set &x)
+    : hashset_handle(x ? CMAGIC_HASHSET_COPY_EXT(value_type, x.hashset_handle, copy_function())
+                       : nullptr),
+      alloc_packet(x.alloc_packet) {}
+
+    /**
+     * @brief   Takes the elements of @p x without any allocation or copying
+     * @details @p x is left uninitialized, as if its allocation had failed: it's empty and holds
+     *          no memory. It can be used as any other unordered set, inserting an element
+     *          allocates it again with the same memory allocation.
+     * @param   x unordered set to take the elements from
+     * @return  reference to this unordered set
+     */
+    unordered_set &operator=(unordered_set &&x) noexcept {
+        if (&x != this) {
+            release();
+            hashset_handle = x.hashset_handle;
+            alloc_packet = x.alloc_packet;
+            x.hashset_handle = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * @copydoc unordered_set::operator=(unordered_set &&)
+     */
+    unordered_set(unordered_set &&x) noexcept
+    : hashset_handle(x.hashset_handle), alloc_packet(x.alloc_packet) {
+        x.hashset_handle = nullptr;
+    }
+
+    /**
+     * @brief   Checks if the unordered set is properly initialized
+     * @return  @c true if unordered set is initialized, @c false if its allocation has failed or
+     *          it was moved from. Operations inserting elements into it try to allocate it again.
+     */
+    explicit operator bool() const {
+        return static_cast<bool>(hashset_handle);
+    }
+
+    /**
+     * @brief   Return iterator to beginning
+     * @return  an iterator to the first element or @ref unordered_set::end if the unordered set
+     *          is empty
+     */
+    iterator begin() const {
+        return hashset_handle ? make_iterator(CMAGIC_HASHSET_FIRST(hashset_handle)) : end();
+    }
+
+    /**
+     * @brief   Return iterator to end
+     * @details It does not point to any element, and thus shall not be dereferenced.
+     * @return  an iterator to the element past the end of the sequence
+     */
+    iterator end() const {
+        return iterator();
+    }
+
+    /**
+     * @brief   Removes all elements from the unordered set, leaving the container with a size of 0.
+     * @details The key array is kept. Destructors are not called at all if the element type is
+     *          trivially destructible.
+     */
+    void clear() {
+        if (*this) {
+            CMAGIC_HASHSET_CLEAR_EXT(hashset_handle, destructor());
+        }
+    }
+
+    /**
+     * @brief   Inserts a new element if it's not equal to any element already contained in the
+     *          unordered set
+     * @param   val value to be copied (or moved) to the unordered set
+     * @return  a pair, with its member @c pair::first set to an iterator pointing to either the
+     *          newly inserted element or to the equal element already in the unordered set. The
+     *          @c pair::second element in the pair is set to @c true if a new element was inserted
+     *          or @c false if an equal element already existed or the allocation has failed, in
+     *          which case @c pair::first is @ref unordered_set::end.
+     */
+    std::pair<iterator, bool> insert(const value_type &val) {
+        return insert_template(val);
+    }
+
+    /**
+     * @copydoc unordered_set::insert
+     */
+    std::pair<iterator, bool> insert(value_type &&val) {
+        return insert_template(std::move(val));
+    }
+
+    /**
+     * @brief   Inserts a new element constructed from @p args if it's not present yet
+     * @param   args arguments forwarded to the constructor of @ref unordered_set::value_type
+     * @return  the same as @ref unordered_set::insert
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args &&...args) {
+        return insert_template(value_type(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief   Removes a single element from the unordered set
+     * @param   val value to be removed
+     * @return  number of removed elements, 0 or 1
+     */
+    size_type erase(const value_type &val) {
+        if (!*this) {
+            return 0;
+        }
+        cmagic_hashset_iterator_t found = CMAGIC_HASHSET_FIND(hashset_handle, &val);
+        if (!found) {
+            return 0;
+        }
+        CMAGIC_HASHSET_ERASE_ITERATOR_EXT(hashset_handle, found, destructor());
+        return 1;
+    }
+
+    /**
+     * @brief   Removes the single element pointed to by @p position
+     * @details No element is moved, so iterators to other elements stay valid.
+     * @param   position iterator to the element to be removed
+     * @return  an iterator to the element following the removed one
+     */
+    iterator erase(const_iterator position) {
+        assert(*this);
+        assert(position != end());
+        cmagic_hashset_iterator_t next =
+            CMAGIC_HASHSET_ITERATOR_NEXT(hashset_handle, position.internal_iterator);
+        CMAGIC_HASHSET_ERASE_ITERATOR_EXT(hashset_handle, position.internal_iterator,
+                                          destructor());
+        return make_iterator(next);
+    }
+
+    /**
+     * @brief   Makes room for @p count elements, so inserting them moves no element
+     * @param   count number of elements
+     * @return  @c true on success, @c false if the allocation has failed
+     */
+    bool reserve(size_type count) {
+        return initialize() && CMAGIC_HASHSET_RESERVE(hashset_handle, count);
+    }
+
+    /**
+     * @brief   Returns the number of elements in the unordered set
+     * @return  number of elements in the unordered set
+     */
+    size_type size() const {
+        return hashset_handle ? CMAGIC_HASHSET_SIZE(hashset_handle) : 0;
+    }
+
+    /**
+     * @brief   Returns whether the unordered set is empty (i.e. whether its size is 0).
+     * @return  @c true if the container size is 0, @c false otherwise
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief   Returns the number of slots of the key array
+     * @return  number of slots, 0 if no key array has been allocated yet
+     */
+    size_type capacity() const {
+        return hashset_handle ? CMAGIC_HASHSET_CAPACITY(hashset_handle) : 0;
+    }
+
+    /**
+     * @brief   Searches the container for an element equal to @p val
+     * @param   val value to be searched for
+     * @return  an iterator to the element, if @p val is found, or @ref unordered_set::end
+     *          otherwise
+     */
+    iterator find(const value_type &val) const {
+        return hashset_handle ? make_iterator(CMAGIC_HASHSET_FIND(hashset_handle, &val)) : end();
+    }
+
+    /**
+     * @brief   Checks whether the container holds an element equal to @p val
+     * @param   val value to be searched for
+     * @return  @c true if @p val is found
+     */
+    bool contains(const value_type &val) const {
+        return hashset_handle && CMAGIC_HASHSET_CONTAINS(hashset_handle, &val);
+    }
+
+    /**
+     * @brief   Counts elements equal to @p val
+     * @param   val value to be searched for
+     * @return  1 if the container contains an element equal to @p val, or 0 otherwise
+     */
+    size_type count(const value_type &val) const {
+        return contains(val) ? 1 : 0;
+    }
+
+    ~unordered_set() {
+        release();
+    }
+
+};
+
+} // namespace cmagic
+
+#endif /* CMAGIC_UNORDERED_SET_HPP */
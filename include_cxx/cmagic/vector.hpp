@@ -8,6 +8,9 @@
 #define CMAGIC_VECTOR_HPP
 
 #include <cassert>
+#include <cstring>
+#include <iterator>
+#include <memory>
 #include <type_traits>
 #include <new>
 #include "cmagic/vector.h"
@@ -40,18 +43,28 @@ private:
     static_assert(std::is_copy_assignable<T>(), "value type must be copy-assignable");
     static_assert(std::is_copy_constructible<T>(), "value type must be copy-constructible");
     CMAGIC_VECTOR(T) vector_handle;
-
-    explicit vector(const cmagic_memory_alloc_packet_t *alloc_packet)
-    : vector_handle(CMAGIC_VECTOR_NEW(value_type, alloc_packet)) {}
+    // Memory allocation of the vector, kept to allocate it again once it's uninitialized
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+
+    vector(const cmagic_memory_alloc_packet_t *alloc_packet_arg,
+           const cmagic_vector_policy_t &policy)
+    : vector_handle(CMAGIC_VECTOR_NEW_EXT(value_type, alloc_packet_arg, &policy)),
+      alloc_packet(alloc_packet_arg) {}
+
+    // Allocates an uninitialized vector again, with the default capacity policy
+    bool initialize() {
+        if (!vector_handle) {
+            vector_handle = CMAGIC_VECTOR_NEW(value_type, alloc_packet);
+        }
+        return static_cast<bool>(vector_handle);
+    }
 
     bool allocate_back() {
-        assert(*this);
-        return CMAGIC_VECTOR_ALLOCATE_BACK(vector_handle);
+        return initialize() && CMAGIC_VECTOR_ALLOCATE_BACK(vector_handle);
     }
 
     template <typename URef>
     bool push_back_template(URef &&val) {
-        assert(*this);
         if (!allocate_back()) {
             return false;
         }
@@ -60,12 +73,90 @@ private:
         return true;
     }
 
+    // Destroys the elements from pos to the end and removes them in a single step
+    void destroy_from(size_type pos) {
+        assert(pos <= size());
+        if (!std::is_trivially_destructible<value_type>::value) {
+            for (value_type *it = begin() + pos; it != end(); ++it) {
+                it->~value_type();
+            }
+        }
+        CMAGIC_VECTOR_TRUNCATE(vector_handle, pos);
+    }
+
+    template <typename... Args>
+    bool resize_template(size_type new_size, const Args &...args) {
+        const size_type old_size = size();
+        if (new_size <= old_size) {
+            if (*this) {
+                destroy_from(new_size);
+            }
+            return true;
+        }
+
+        if (!initialize() || !CMAGIC_VECTOR_RESIZE(vector_handle, new_size)) {
+            return false;
+        }
+        for (value_type *it = begin() + old_size; it != end(); ++it) {
+            new(it) value_type(args...);
+        }
+        return true;
+    }
+
+    template <typename URef>
+    value_type *insert_template(const value_type *pos, URef &&val) {
+        assert(pos >= begin() && pos <= end());
+        if (&val >= begin() && &val < end()) {
+            // Opening the gap would move val
+            value_type val_copy {std::forward<URef>(val)};
+            return insert_template(pos, std::move(val_copy));
+        }
+
+        const size_type index = static_cast<size_type>(pos - begin());
+        if (!initialize() || !CMAGIC_VECTOR_INSERT_UNINITIALIZED(vector_handle, index, 1)) {
+            return nullptr;
+        }
+        value_type *result = CMAGIC_VECTOR_DATA(vector_handle) + index;
+        new(result) value_type {std::forward<URef>(val)};
+        return result;
+    }
+
+    static void copy_construct(value_type *dest, const value_type *src, size_type count,
+                               std::true_type /* trivially copyable */) {
+        if (count > 0) {
+            std::memcpy(static_cast<void *>(dest), src, count * sizeof(value_type));
+        }
+    }
+
+    static void copy_construct(value_type *dest, const value_type *src, size_type count,
+                               std::false_type /* trivially copyable */) {
+        std::uninitialized_copy(src, src + count, dest);
+    }
+
+    // Destroys the elements and leaves the vector uninitialized
+    void release() {
+        if (*this) {
+            clear();
+            CMAGIC_VECTOR_FREE(vector_handle);
+            vector_handle = nullptr;
+        }
+    }
+
 public:
     /**
      * @brief   Constructs an empty vector with standard memory allocation.
      * @return  a new empty vector
      */
-    vector() : vector(&CMAGIC_MEMORY_ALLOC_PACKET_STD) {}
+    vector() : vector(&CMAGIC_MEMORY_ALLOC_PACKET_STD, CMAGIC_VECTOR_POLICY_DEFAULT) {}
+
+    /**
+     * @brief   Constructs an empty vector with standard memory allocation and the given capacity
+     *          policy.
+     * @param   policy rules by which the vector changes its capacity
+     * @return  a new empty vector
+     */
+    explicit vector(const cmagic_vector_policy_t &policy)
+    : vector(&CMAGIC_MEMORY_ALLOC_PACKET_STD, policy) {}
 
     /**
      * @brief   Constructs an empty vector using custom @e CMagic memory allocation from @ref
@@ -73,46 +164,79 @@ public:
      * @return  a new empty vector
      */
     static vector custom_allocation_vector() {
-        return vector(&CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+        return vector(&CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC, CMAGIC_VECTOR_POLICY_DEFAULT);
     }
 
+    /**
+     * @brief   Replaces the elements with copies of the elements of @p x
+     * @details The vector takes the capacity policy of @p x. The storage is sized once for all
+     *          the elements. Trivially copyable elements are copied by a single @c memcpy. If the
+     *          allocation fails, the vector is left uninitialized, see @ref vector::operator bool.
+     * @param   x vector to copy the elements from
+     * @return  reference to this vector
+     */
     vector &operator=(const vector &x) {
-        assert(*this);
         if (&x == this) {
             return *this;
         }
 
-        clear();
-        for (const value_type &val : x) {
-            if (!push_back(val)) {
-                clear();
-                CMAGIC_VECTOR_FREE(vector_handle);
-                vector_handle = nullptr;
+        if (!x) {
+            release();
+            return *this;
+        }
+        if (!*this) {
+            alloc_packet = x.alloc_packet;
+            vector_handle = CMAGIC_VECTOR_NEW_EXT(value_type, alloc_packet,
+                                                  CMAGIC_VECTOR_GET_POLICY(x.vector_handle));
+            if (!*this) {
                 return *this;
             }
+        } else {
+            CMAGIC_VECTOR_SET_POLICY(vector_handle, CMAGIC_VECTOR_GET_POLICY(x.vector_handle));
         }
+
+        clear();
+        const size_type new_size = x.size();
+        if (!CMAGIC_VECTOR_RESERVE(vector_handle, new_size)
+            || !CMAGIC_VECTOR_RESIZE(vector_handle, new_size)) {
+            release();
+            return *this;
+        }
+        copy_construct(CMAGIC_VECTOR_DATA(vector_handle), x.begin(), new_size,
+                       std::is_trivially_copyable<value_type>());
         return *this;
     }
 
-    vector(const vector &x) : vector(CMAGIC_VECTOR_GET_ALLOC_PACKET(x.vector_handle)) {
-        if (*this) {
-            operator=(x);
-        }
+    /**
+     * @copydoc vector::operator=(const vector &)
+     */
+    vector(const vector &x) : vector_handle(nullptr), alloc_packet(x.alloc_packet) {
+        operator=(x);
     }
 
-    vector &operator=(vector &&x) {
-        assert(*this);
-        clear();
-        CMAGIC_VECTOR_FREE(vector_handle);
-        vector_handle = x.vector_handle;
-        x.vector_handle = CMAGIC_VECTOR_NEW(value_type,
-                                            CMAGIC_VECTOR_GET_ALLOC_PACKET(x.vector_handle));
+    /**
+     * @brief   Takes the elements of @p x without any allocation or copying
+     * @details @p x is left uninitialized, as if its allocation had failed: it's empty and holds
+     *          no memory. It can be used as any other vector, adding an element allocates it again
+     *          with the same memory allocation and the default capacity policy.
+     * @param   x vector to take the elements from
+     * @return  reference to this vector
+     */
+    vector &operator=(vector &&x) noexcept {
+        if (&x != this) {
+            release();
+            vector_handle = x.vector_handle;
+            alloc_packet = x.alloc_packet;
+            x.vector_handle = nullptr;
+        }
         return *this;
     }
 
-    vector(vector &&x) : vector_handle(x.vector_handle) {
-        x.vector_handle = CMAGIC_VECTOR_NEW(value_type,
-                                            CMAGIC_VECTOR_GET_ALLOC_PACKET(x.vector_handle));
+    /**
+     * @copydoc vector::operator=(vector &&)
+     */
+    vector(vector &&x) noexcept : vector_handle(x.vector_handle), alloc_packet(x.alloc_packet) {
+        x.vector_handle = nullptr;
     }
 
     /**
@@ -122,8 +246,7 @@ public:
      * @return  number of elements in the vector
      */
     size_type size() const {
-        assert(*this);
-        return CMAGIC_VECTOR_SIZE(vector_handle);
+        return vector_handle ? CMAGIC_VECTOR_SIZE(vector_handle) : 0;
     }
 
     /**
@@ -136,6 +259,65 @@ public:
         return size() == 0;
     }
 
+    /**
+     * @brief   Returns the size of the storage space currently allocated for the vector, expressed
+     *          in terms of elements.
+     * @return  number of elements the vector can hold without reallocation, 0 if the vector is
+     *          uninitialized
+     */
+    size_type capacity() const {
+        return vector_handle ? CMAGIC_VECTOR_CAPACITY(vector_handle) : 0;
+    }
+
+    /**
+     * @brief   Requests that the vector capacity be at least enough to contain @p new_capacity
+     *          elements.
+     * @details The storage is reallocated at most once, so a vector filled with a known number of
+     *          elements after this call never reallocates. Elements are moved byte by byte.
+     * @param   new_capacity minimum capacity of the vector
+     * @return  @c true on success, @c false if the allocation has failed and the vector was not
+     *          modified
+     */
+    bool reserve(size_type new_capacity) {
+        return initialize() && CMAGIC_VECTOR_RESERVE(vector_handle, new_capacity);
+    }
+
+    /**
+     * @brief   Requests the vector to reduce its capacity to fit its size.
+     * @details The request is non-binding, the capacity is kept if the reallocation fails.
+     */
+    void shrink_to_fit() {
+        if (*this) {
+            CMAGIC_VECTOR_SHRINK_TO_FIT(vector_handle);
+        }
+    }
+
+    /**
+     * @brief   Returns the rules by which the vector changes its capacity.
+     * @return  capacity policy of the vector, the default one if the vector is uninitialized
+     */
+    const cmagic_vector_policy_t &policy() const {
+        return vector_handle ? *CMAGIC_VECTOR_GET_POLICY(vector_handle)
+                             : CMAGIC_VECTOR_POLICY_DEFAULT;
+    }
+
+    /**
+     * @brief   Replaces the rules by which the vector changes its capacity.
+     * @details The current capacity is kept, the new policy applies to the following operations.
+     *          An uninitialized vector is allocated again with the new policy.
+     * @param   new_policy capacity policy of the vector
+     * @return  @c true on success, @c false if the vector was uninitialized and its allocation has
+     *          failed
+     */
+    bool set_policy(const cmagic_vector_policy_t &new_policy) {
+        if (!vector_handle) {
+            vector_handle = CMAGIC_VECTOR_NEW_EXT(value_type, alloc_packet, &new_policy);
+            return static_cast<bool>(vector_handle);
+        }
+        CMAGIC_VECTOR_SET_POLICY(vector_handle, &new_policy);
+        return true;
+    }
+
     /**
      * @brief   Returns a reference to the element at position @p pos in the vector container.
      * @warning Never call this function with an argument n that is out of range, since this causes
@@ -189,7 +371,6 @@ public:
      */
     template<typename... Args>
     bool emplace_back(Args&&... args) {
-        assert(*this);
         if (!allocate_back()) {
             return false;
         }
@@ -215,13 +396,124 @@ public:
     /**
      * @brief   Removes all elements from the vector (which are destroyed), leaving the container
      *          with a size of 0.
+     * @details Takes constant time if @ref value_type is trivially destructible.
      */
     void clear() {
-        while (size() > 0) {
-            pop_back();
+        if (*this) {
+            destroy_from(0);
         }
     }
 
+    /**
+     * @brief   Insert element
+     * @details Inserts a copy of @p val before the element at @p pos. The following elements are
+     *          moved byte by byte in a single step, with at most one reallocation before.
+     * @param   pos position in the vector where the new element is inserted
+     * @param   val value to be copied (or moved) to the new element
+     * @return  an iterator pointing to the new element, @c nullptr if the allocation has failed
+     *          and the vector was not modified
+     */
+    value_type *insert(const value_type *pos, const value_type &val) {
+        return insert_template(pos, val);
+    }
+
+    /**
+     * @copydoc vector::insert(const value_type *, const value_type &)
+     */
+    value_type *insert(const value_type *pos, value_type &&val) {
+        return insert_template(pos, std::move(val));
+    }
+
+    /**
+     * @brief   Insert range of elements
+     * @details Inserts copies of the elements from @p first up to, but not including, @p last
+     *          before the element at @p pos. The room for all of them is made in a single step,
+     *          with at most one reallocation.
+     * @warning The range must not point into the vector itself.
+     * @param   pos position in the vector where the new elements are inserted
+     * @param   first forward iterator to the first element to be copied
+     * @param   last forward iterator past the last element to be copied
+     * @return  an iterator pointing to the first new element, @c nullptr if the allocation has
+     *          failed and the vector was not modified
+     */
+    template <typename ForwardIt>
+    value_type *insert(const value_type *pos, ForwardIt first, ForwardIt last) {
+        assert(pos >= begin() && pos <= end());
+        const size_type index = static_cast<size_type>(pos - begin());
+        const size_type count = static_cast<size_type>(std::distance(first, last));
+        if (!initialize() || !CMAGIC_VECTOR_INSERT_UNINITIALIZED(vector_handle, index, count)) {
+            return nullptr;
+        }
+        value_type *result = CMAGIC_VECTOR_DATA(vector_handle) + index;
+        std::uninitialized_copy(first, last, result);
+        return result;
+    }
+
+    /**
+     * @brief   Erase element
+     * @details Destroys the element at @p pos and moves the following elements byte by byte.
+     * @param   pos iterator pointing to the element to be removed
+     * @return  an iterator pointing to the element that followed the removed one
+     */
+    value_type *erase(const value_type *pos) {
+        return erase(pos, pos + 1);
+    }
+
+    /**
+     * @brief   Erase range of elements
+     * @details Destroys the elements from @p first up to, but not including, @p last in a single
+     *          pass, which is skipped if @ref value_type is trivially destructible, and then moves
+     *          the following elements in a single step.
+     * @param   first iterator pointing to the first element to be removed
+     * @param   last iterator pointing past the last element to be removed
+     * @return  an iterator pointing to the element that followed the last removed one
+     */
+    value_type *erase(const value_type *first, const value_type *last) {
+        assert(first >= begin() && first <= last && last <= end());
+        const size_type first_index = static_cast<size_type>(first - begin());
+        if (first == last) {
+            return begin() + first_index;
+        }
+        const size_type last_index = static_cast<size_type>(last - begin());
+        if (!std::is_trivially_destructible<value_type>::value) {
+            for (value_type *it = begin() + first_index; it != begin() + last_index; ++it) {
+                it->~value_type();
+            }
+        }
+        CMAGIC_VECTOR_ERASE_RANGE(vector_handle, first_index, last_index);
+        return begin() + first_index;
+    }
+
+    /**
+     * @brief   Resizes the container so that it contains @p new_size elements.
+     * @details If @p new_size is smaller than the current size, the elements past the first
+     *          @p new_size are destroyed. If it's greater, value-initialized elements are appended
+     *          after a single reallocation at most.
+     * @param   new_size new number of elements
+     * @return  @c true on success, @c false if the allocation has failed and the vector was not
+     *          modified
+     */
+    bool resize(size_type new_size) {
+        return resize_template(new_size);
+    }
+
+    /**
+     * @brief   Resizes the container so that it contains @p new_size elements.
+     * @details Same as @ref vector::resize(size_type), but appended elements are copies of @p val.
+     * @param   new_size new number of elements
+     * @param   val value to be copied to the appended elements
+     * @return  @c true on success, @c false if the allocation has failed and the vector was not
+     *          modified
+     */
+    bool resize(size_type new_size, const value_type &val) {
+        if (new_size > capacity() && &val >= begin() && &val < end()) {
+            // The reallocation would invalidate val
+            const value_type val_copy {val};
+            return resize_template(new_size, val_copy);
+        }
+        return resize_template(new_size, val);
+    }
+
     /**
      * @brief   Return iterator to beginning
      * @details Returns an iterator pointing to the first element in the vector. If the container is
@@ -229,16 +521,14 @@ public:
      * @return  an iterator to the beginning of the sequence container
      */
     value_type *begin() {
-        assert(*this);
-        return &(*this)[0];
+        return vector_handle ? CMAGIC_VECTOR_DATA(vector_handle) : nullptr;
     }
 
     /**
      * @copydoc vector::begin
      */
     const value_type *begin() const {
-        assert(*this);
-        return &(*this)[0];
+        return vector_handle ? CMAGIC_VECTOR_DATA(vector_handle) : nullptr;
     }
 
     /**
@@ -250,16 +540,14 @@ public:
      * @return  an iterator to the element past the end of the sequence
      */
     value_type *end() {
-        assert(*this);
-        return &(*this)[size()];
+        return begin() + size();
     }
 
     /**
      * @copydoc vector::end
      */
     const value_type *end() const {
-        assert(*this);
-        return &(*this)[size()];
+        return begin() + size();
     }
 
     /**
@@ -273,18 +561,15 @@ public:
      *              std::cerr << "Vector allocation failed!\n";
      *          }
      *          @endcode
-     * @return  @c true if vector is initialized, @c false if vector allocation has failed and no
-     *          operation should be made on it
+     * @return  @c true if vector is initialized, @c false if vector allocation has failed or the
+     *          vector was moved from. Operations adding elements to it try to allocate it again.
      */
     operator bool() const {
         return static_cast<bool>(vector_handle);
     }
 
     ~vector() {
-        if (*this) {
-            clear();
-            CMAGIC_VECTOR_FREE(vector_handle);
-        }
+        release();
     }
 
 };
@@ -0,0 +1,515 @@
+#include <stdint.h>
+#include <string.h>
+#include "cmagic/flat_map.h"
+#include "cmagic/vector.h"
+#include "sorted_array.h"
+
+#ifndef NDEBUG
+static const int_least32_t FLAT_MAP_MAGIC_VALUE = 'F' << 16 | 'M' << 8 | 'P';
+#endif
+
+
+/*
+ * Keys and values are kept in separate vectors, so a binary search touches only the keys. The
+ * element of a key is the value with the same index. Pending elements of a batch are appended to
+ * another pair of vectors, which exists only while the batch is not empty.
+ */
+typedef struct {
+#ifndef NDEBUG
+    int_least32_t magic_value;
+#endif
+    void **keys;
+    void **values;
+    void **pending_keys;
+    void **pending_values;
+    cmagic_flat_map_key_comparator_t key_comparator;
+    size_t key_size;
+    size_t value_size;
+} flat_map_descriptor_t;
+
+
+void *
+cmagic_flat_map_new(size_t key_size, size_t value_size,
+                    cmagic_flat_map_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet) {
+    assert(key_size > 0);
+    assert(value_size > 0);
+    assert(key_comparator);
+    assert(alloc_packet);
+
+    flat_map_descriptor_t *flat_map_desc =
+        (flat_map_descriptor_t *) alloc_packet->malloc_function(sizeof(flat_map_descriptor_t));
+    if (!flat_map_desc) {
+        return NULL;
+    }
+
+    *flat_map_desc = (flat_map_descriptor_t) {
+#ifndef NDEBUG
+        .magic_value = FLAT_MAP_MAGIC_VALUE,
+#endif
+        .keys = cmagic_vector_new(key_size, alloc_packet),
+        .values = cmagic_vector_new(value_size, alloc_packet),
+        .pending_keys = NULL,
+        .pending_values = NULL,
+        .key_comparator = key_comparator,
+        .key_size = key_size,
+        .value_size = value_size
+    };
+
+    if (!flat_map_desc->keys || !flat_map_desc->values) {
+        if (flat_map_desc->keys) {
+            cmagic_vector_free(flat_map_desc->keys);
+        }
+        if (flat_map_desc->values) {
+            cmagic_vector_free(flat_map_desc->values);
+        }
+        alloc_packet->free_function(flat_map_desc);
+        return NULL;
+    }
+
+    return (void *)flat_map_desc;
+}
+
+static flat_map_descriptor_t *_get_flat_map_descriptor(void *flat_map_ptr) {
+    assert(flat_map_ptr);
+    flat_map_descriptor_t *result = (flat_map_descriptor_t *)flat_map_ptr;
+    assert(result->magic_value == FLAT_MAP_MAGIC_VALUE);
+    return result;
+}
+
+static const cmagic_memory_alloc_packet_t *
+_get_alloc_packet(flat_map_descriptor_t *flat_map_desc) {
+    return cmagic_vector_get_alloc_packet(flat_map_desc->keys);
+}
+
+static size_t _size(flat_map_descriptor_t *flat_map_desc) {
+    return cmagic_vector_size(flat_map_desc->keys);
+}
+
+static char *_key_at(flat_map_descriptor_t *flat_map_desc, size_t index) {
+    return (char *)*flat_map_desc->keys + index * flat_map_desc->key_size;
+}
+
+static char *_value_at(flat_map_descriptor_t *flat_map_desc, size_t index) {
+    return (char *)*flat_map_desc->values + index * flat_map_desc->value_size;
+}
+
+static cmagic_flat_map_iterator_t _iterator_at(flat_map_descriptor_t *flat_map_desc,
+                                               size_t index) {
+    if (index >= _size(flat_map_desc)) {
+        return (cmagic_flat_map_iterator_t) { NULL, NULL };
+    }
+
+    return (cmagic_flat_map_iterator_t) {
+        _key_at(flat_map_desc, index), _value_at(flat_map_desc, index)
+    };
+}
+
+static size_t _index_of(flat_map_descriptor_t *flat_map_desc,
+                        cmagic_flat_map_iterator_t iterator) {
+    assert(iterator.key);
+    const size_t index =
+        (size_t)((const char *)iterator.key - _key_at(flat_map_desc, 0)) / flat_map_desc->key_size;
+    assert(index < _size(flat_map_desc));
+    return index;
+}
+
+static size_t _lower_bound(flat_map_descriptor_t *flat_map_desc, const void *key) {
+    return cmagic_sorted_array_lower_bound(*flat_map_desc->keys, _size(flat_map_desc),
+                                           flat_map_desc->key_size, key,
+                                           flat_map_desc->key_comparator);
+}
+
+static bool _contains_at(flat_map_descriptor_t *flat_map_desc, size_t index, const void *key) {
+    return index < _size(flat_map_desc)
+        && flat_map_desc->key_comparator(_key_at(flat_map_desc, index), key) == 0;
+}
+
+static void _shrink_vector(void **vector, size_t count) {
+    cmagic_vector_truncate(vector, cmagic_vector_size(vector) - count);
+}
+
+// Appends uninitialized elements to the vector, which is unchanged if the allocation fails
+static bool _grow_vector(void **vector, size_t count) {
+    return cmagic_vector_resize(vector, cmagic_vector_size(vector) + count);
+}
+
+// Appends uninitialized elements to both arrays, which are unchanged if the allocation fails
+static bool _grow(flat_map_descriptor_t *flat_map_desc, size_t count) {
+    if (!_grow_vector(flat_map_desc->keys, count)) {
+        return false;
+    }
+    if (!_grow_vector(flat_map_desc->values, count)) {
+        _shrink_vector(flat_map_desc->keys, count);
+        return false;
+    }
+
+    return true;
+}
+
+static void _free_batch(flat_map_descriptor_t *flat_map_desc) {
+    if (flat_map_desc->pending_keys) {
+        cmagic_vector_free(flat_map_desc->pending_keys);
+        cmagic_vector_free(flat_map_desc->pending_values);
+        flat_map_desc->pending_keys = NULL;
+        flat_map_desc->pending_values = NULL;
+    }
+}
+
+void
+cmagic_flat_map_free(void *flat_map_ptr) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(flat_map_desc);
+    _free_batch(flat_map_desc);
+    cmagic_vector_free(flat_map_desc->keys);
+    cmagic_vector_free(flat_map_desc->values);
+    alloc_packet->free_function(flat_map_desc);
+}
+
+void *
+cmagic_flat_map_copy(void *flat_map_ptr, cmagic_flat_map_copy_function_t copy) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    assert(!flat_map_desc->pending_keys);
+    const size_t size = _size(flat_map_desc);
+    flat_map_descriptor_t *copy_desc = (flat_map_descriptor_t *)cmagic_flat_map_new(
+        flat_map_desc->key_size, flat_map_desc->value_size, flat_map_desc->key_comparator,
+        _get_alloc_packet(flat_map_desc));
+    if (!copy_desc) {
+        return NULL;
+    }
+    if (!_grow(copy_desc, size)) {
+        cmagic_flat_map_free(copy_desc);
+        return NULL;
+    }
+
+    if (copy) {
+        for (size_t i = 0; i < size; i++) {
+            copy(_key_at(copy_desc, i), _value_at(copy_desc, i), _key_at(flat_map_desc, i),
+                 _value_at(flat_map_desc, i));
+        }
+    } else if (size > 0) {
+        memcpy(_key_at(copy_desc, 0), _key_at(flat_map_desc, 0), size * flat_map_desc->key_size);
+        memcpy(_value_at(copy_desc, 0), _value_at(flat_map_desc, 0),
+               size * flat_map_desc->value_size);
+    }
+
+    return (void *)copy_desc;
+}
+
+bool
+cmagic_flat_map_build_sorted(void *flat_map_ptr, const void *keys, const void *values,
+                             size_t count) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    assert(_size(flat_map_desc) == 0);
+    assert(!flat_map_desc->pending_keys);
+    assert(count == 0 || (keys && values));
+#ifndef NDEBUG
+    const char *key_bytes = (const char *)keys;
+    for (size_t i = 1; i < count; i++) {
+        assert(flat_map_desc->key_comparator(key_bytes + (i - 1) * flat_map_desc->key_size,
+                                             key_bytes + i * flat_map_desc->key_size) < 0);
+    }
+#endif
+
+    if (count == 0) {
+        return true;
+    }
+    if (!_grow(flat_map_desc, count)) {
+        return false;
+    }
+
+    memcpy(_key_at(flat_map_desc, 0), keys, count * flat_map_desc->key_size);
+    memcpy(_value_at(flat_map_desc, 0), values, count * flat_map_desc->value_size);
+    return true;
+}
+
+cmagic_flat_map_insert_result_t
+cmagic_flat_map_allocate(void *flat_map_ptr, const void *key) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    const size_t index = _lower_bound(flat_map_desc, key);
+    if (_contains_at(flat_map_desc, index, key)) {
+        return (cmagic_flat_map_insert_result_t) {
+            .inserted_or_existing = _iterator_at(flat_map_desc, index),
+            .already_exists = true
+        };
+    }
+
+    const size_t moved_count = _size(flat_map_desc) - index;
+    if (!_grow(flat_map_desc, 1)) {
+        return (cmagic_flat_map_insert_result_t) {
+            .inserted_or_existing = { NULL, NULL },
+            .already_exists = false
+        };
+    }
+
+    memmove(_key_at(flat_map_desc, index + 1), _key_at(flat_map_desc, index),
+            moved_count * flat_map_desc->key_size);
+    memmove(_value_at(flat_map_desc, index + 1), _value_at(flat_map_desc, index),
+            moved_count * flat_map_desc->value_size);
+    memcpy(_key_at(flat_map_desc, index), key, flat_map_desc->key_size);
+    return (cmagic_flat_map_insert_result_t) {
+        .inserted_or_existing = _iterator_at(flat_map_desc, index),
+        .already_exists = false
+    };
+}
+
+cmagic_flat_map_insert_result_t
+cmagic_flat_map_insert(void *flat_map_ptr, const void *key, const void *value) {
+    cmagic_flat_map_insert_result_t result = cmagic_flat_map_allocate(flat_map_ptr, key);
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+
+    if (result.inserted_or_existing.key && !result.already_exists) {
+        memcpy(result.inserted_or_existing.value, value, flat_map_desc->value_size);
+    }
+
+    return result;
+}
+
+bool
+cmagic_flat_map_batch_insert(void *flat_map_ptr, const void *key, const void *value) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    if (!flat_map_desc->pending_keys) {
+        const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(flat_map_desc);
+        void **pending_keys = cmagic_vector_new(flat_map_desc->key_size, alloc_packet);
+        if (!pending_keys) {
+            return false;
+        }
+        void **pending_values = cmagic_vector_new(flat_map_desc->value_size, alloc_packet);
+        if (!pending_values) {
+            cmagic_vector_free(pending_keys);
+            return false;
+        }
+        flat_map_desc->pending_keys = pending_keys;
+        flat_map_desc->pending_values = pending_values;
+    }
+
+    if (!cmagic_vector_push_back(flat_map_desc->pending_keys, key)) {
+        return false;
+    }
+    if (!cmagic_vector_push_back(flat_map_desc->pending_values, value)) {
+        cmagic_vector_pop_back(flat_map_desc->pending_keys);
+        return false;
+    }
+
+    return true;
+}
+
+size_t
+cmagic_flat_map_batch_size(void *flat_map_ptr) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    return flat_map_desc->pending_keys ? cmagic_vector_size(flat_map_desc->pending_keys) : 0;
+}
+
+static char *_pending_key_at(flat_map_descriptor_t *flat_map_desc, size_t index) {
+    return (char *)*flat_map_desc->pending_keys + index * flat_map_desc->key_size;
+}
+
+static char *_pending_value_at(flat_map_descriptor_t *flat_map_desc, size_t index) {
+    return (char *)*flat_map_desc->pending_values + index * flat_map_desc->value_size;
+}
+
+/*
+ * Pending elements are sorted by their indices, which keeps them in place until the allocation
+ * of the merged arrays succeeds. The first of equal pending keys is kept, unless the key is already
+ * in the flat map. Kept elements are then merged from the back, so every element is moved once.
+ */
+bool
+cmagic_flat_map_batch_commit(void *flat_map_ptr, cmagic_flat_map_erase_destructor_t destructor) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    const size_t pending_count = cmagic_flat_map_batch_size(flat_map_ptr);
+    if (pending_count == 0) {
+        _free_batch(flat_map_desc);
+        return true;
+    }
+
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(flat_map_desc);
+    size_t *indices = (size_t *)alloc_packet->malloc_function(2 * pending_count * sizeof(size_t));
+    if (!indices) {
+        return false;
+    }
+
+    size_t *dropped = indices + pending_count;
+    for (size_t i = 0; i < pending_count; i++) {
+        indices[i] = i;
+    }
+    cmagic_sorted_array_sort_indices(*flat_map_desc->pending_keys, flat_map_desc->key_size,
+                                     indices, dropped, pending_count,
+                                     flat_map_desc->key_comparator);
+
+    const size_t size = _size(flat_map_desc);
+    size_t kept_count = 0;
+    size_t dropped_count = 0;
+    size_t position = 0;
+    for (size_t i = 0; i < pending_count; i++) {
+        const char *key = _pending_key_at(flat_map_desc, indices[i]);
+        // Pending keys are ascending, so each search continues from the previous position
+        position += cmagic_sorted_array_lower_bound(_key_at(flat_map_desc, position),
+                                                    size - position, flat_map_desc->key_size,
+                                                    key, flat_map_desc->key_comparator);
+        const bool duplicate = (kept_count > 0 && flat_map_desc->key_comparator(
+            _pending_key_at(flat_map_desc, indices[kept_count - 1]), key) == 0)
+            || _contains_at(flat_map_desc, position, key);
+        if (duplicate) {
+            dropped[dropped_count++] = indices[i];
+        } else {
+            indices[kept_count++] = indices[i];
+        }
+    }
+
+    if (!_grow(flat_map_desc, kept_count)) {
+        alloc_packet->free_function(indices);
+        return false;
+    }
+
+    size_t old_index = size;
+    size_t kept_index = kept_count;
+    size_t merged_index = size + kept_count;
+    while (kept_index > 0) {
+        merged_index--;
+        const char *pending_key = _pending_key_at(flat_map_desc, indices[kept_index - 1]);
+        if (old_index > 0 && flat_map_desc->key_comparator(_key_at(flat_map_desc, old_index - 1),
+                                                           pending_key) > 0) {
+            old_index--;
+            memcpy(_key_at(flat_map_desc, merged_index), _key_at(flat_map_desc, old_index),
+                   flat_map_desc->key_size);
+            memcpy(_value_at(flat_map_desc, merged_index), _value_at(flat_map_desc, old_index),
+                   flat_map_desc->value_size);
+        } else {
+            kept_index--;
+            memcpy(_key_at(flat_map_desc, merged_index), pending_key, flat_map_desc->key_size);
+            memcpy(_value_at(flat_map_desc, merged_index),
+                   _pending_value_at(flat_map_desc, indices[kept_index]),
+                   flat_map_desc->value_size);
+        }
+    }
+
+    if (destructor) {
+        for (size_t i = 0; i < dropped_count; i++) {
+            destructor(_pending_key_at(flat_map_desc, dropped[i]),
+                       _pending_value_at(flat_map_desc, dropped[i]));
+        }
+    }
+
+    alloc_packet->free_function(indices);
+    _free_batch(flat_map_desc);
+    return true;
+}
+
+void
+cmagic_flat_map_erase_iterator(void *flat_map_ptr, cmagic_flat_map_iterator_t iterator,
+                               cmagic_flat_map_erase_destructor_t destructor) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    const size_t index = _index_of(flat_map_desc, iterator);
+    if (destructor) {
+        destructor(_key_at(flat_map_desc, index), _value_at(flat_map_desc, index));
+    }
+
+    const size_t moved_count = _size(flat_map_desc) - index - 1;
+    memmove(_key_at(flat_map_desc, index), _key_at(flat_map_desc, index + 1),
+            moved_count * flat_map_desc->key_size);
+    memmove(_value_at(flat_map_desc, index), _value_at(flat_map_desc, index + 1),
+            moved_count * flat_map_desc->value_size);
+    cmagic_vector_pop_back(flat_map_desc->keys);
+    cmagic_vector_pop_back(flat_map_desc->values);
+}
+
+void
+cmagic_flat_map_erase(void *flat_map_ptr, const void *key,
+                      cmagic_flat_map_erase_destructor_t destructor) {
+    cmagic_flat_map_iterator_t found = cmagic_flat_map_find(flat_map_ptr, key);
+    if (found.key) {
+        cmagic_flat_map_erase_iterator(flat_map_ptr, found, destructor);
+    }
+}
+
+void
+cmagic_flat_map_clear_ext(void *flat_map_ptr, cmagic_flat_map_erase_destructor_t destructor) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    const size_t size = _size(flat_map_desc);
+    const size_t pending_count = cmagic_flat_map_batch_size(flat_map_ptr);
+    if (destructor) {
+        for (size_t i = 0; i < size; i++) {
+            destructor(_key_at(flat_map_desc, i), _value_at(flat_map_desc, i));
+        }
+        for (size_t i = 0; i < pending_count; i++) {
+            destructor(_pending_key_at(flat_map_desc, i), _pending_value_at(flat_map_desc, i));
+        }
+    }
+
+    cmagic_vector_clear(flat_map_desc->keys);
+    cmagic_vector_clear(flat_map_desc->values);
+    _free_batch(flat_map_desc);
+}
+
+void
+cmagic_flat_map_clear(void *flat_map_ptr) {
+    cmagic_flat_map_clear_ext(flat_map_ptr, NULL);
+}
+
+size_t
+cmagic_flat_map_size(void *flat_map_ptr) {
+    return _size(_get_flat_map_descriptor(flat_map_ptr));
+}
+
+const void *
+cmagic_flat_map_keys(void *flat_map_ptr) {
+    return *_get_flat_map_descriptor(flat_map_ptr)->keys;
+}
+
+void *
+cmagic_flat_map_values(void *flat_map_ptr) {
+    return *_get_flat_map_descriptor(flat_map_ptr)->values;
+}
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_first(void *flat_map_ptr) {
+    return _iterator_at(_get_flat_map_descriptor(flat_map_ptr), 0);
+}
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_last(void *flat_map_ptr) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    const size_t size = _size(flat_map_desc);
+    return _iterator_at(flat_map_desc, size > 0 ? size - 1 : 0);
+}
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_iterator_next(void *flat_map_ptr, cmagic_flat_map_iterator_t iterator) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    return _iterator_at(flat_map_desc, _index_of(flat_map_desc, iterator) + 1);
+}
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_iterator_prev(void *flat_map_ptr, cmagic_flat_map_iterator_t iterator) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    const size_t index = _index_of(flat_map_desc, iterator);
+    return index > 0 ? _iterator_at(flat_map_desc, index - 1)
+        : (cmagic_flat_map_iterator_t) { NULL, NULL };
+}
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_find(void *flat_map_ptr, const void *key) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    const size_t index = _lower_bound(flat_map_desc, key);
+    return _contains_at(flat_map_desc, index, key) ? _iterator_at(flat_map_desc, index)
+        : (cmagic_flat_map_iterator_t) { NULL, NULL };
+}
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_lower_bound(void *flat_map_ptr, const void *key) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    return _iterator_at(flat_map_desc, _lower_bound(flat_map_desc, key));
+}
+
+cmagic_flat_map_iterator_t
+cmagic_flat_map_upper_bound(void *flat_map_ptr, const void *key) {
+    flat_map_descriptor_t *flat_map_desc = _get_flat_map_descriptor(flat_map_ptr);
+    return _iterator_at(flat_map_desc, cmagic_sorted_array_upper_bound(
+        *flat_map_desc->keys, _size(flat_map_desc), flat_map_desc->key_size, key,
+        flat_map_desc->key_comparator));
+}
+
+const cmagic_memory_alloc_packet_t *
+cmagic_flat_map_get_alloc_packet(void *flat_map_ptr) {
+    return _get_alloc_packet(_get_flat_map_descriptor(flat_map_ptr));
+}
@@ -0,0 +1,410 @@
+#include <stdint.h>
+#include <string.h>
+#include "cmagic/flat_set.h"
+#include "cmagic/vector.h"
+#include "sorted_array.h"
+
+#ifndef NDEBUG
+static const int_least32_t FLAT_SET_MAGIC_VALUE = 'F' << 16 | 'S' << 8 | 'T';
+#endif
+
+
+// Same layout as the flat map without the values
+typedef struct {
+#ifndef NDEBUG
+    int_least32_t magic_value;
+#endif
+    void **keys;
+    void **pending_keys;
+    cmagic_flat_set_key_comparator_t key_comparator;
+    size_t key_size;
+} flat_set_descriptor_t;
+
+
+void *
+cmagic_flat_set_new(size_t key_size, cmagic_flat_set_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet) {
+    assert(key_size > 0);
+    assert(key_comparator);
+    assert(alloc_packet);
+
+    flat_set_descriptor_t *flat_set_desc =
+        (flat_set_descriptor_t *) alloc_packet->malloc_function(sizeof(flat_set_descriptor_t));
+    if (!flat_set_desc) {
+        return NULL;
+    }
+
+    *flat_set_desc = (flat_set_descriptor_t) {
+#ifndef NDEBUG
+        .magic_value = FLAT_SET_MAGIC_VALUE,
+#endif
+        .keys = cmagic_vector_new(key_size, alloc_packet),
+        .pending_keys = NULL,
+        .key_comparator = key_comparator,
+        .key_size = key_size
+    };
+
+    if (!flat_set_desc->keys) {
+        alloc_packet->free_function(flat_set_desc);
+        return NULL;
+    }
+
+    return (void *)flat_set_desc;
+}
+
+static flat_set_descriptor_t *_get_flat_set_descriptor(void *flat_set_ptr) {
+    assert(flat_set_ptr);
+    flat_set_descriptor_t *result = (flat_set_descriptor_t *)flat_set_ptr;
+    assert(result->magic_value == FLAT_SET_MAGIC_VALUE);
+    return result;
+}
+
+static const cmagic_memory_alloc_packet_t *
+_get_alloc_packet(flat_set_descriptor_t *flat_set_desc) {
+    return cmagic_vector_get_alloc_packet(flat_set_desc->keys);
+}
+
+static size_t _size(flat_set_descriptor_t *flat_set_desc) {
+    return cmagic_vector_size(flat_set_desc->keys);
+}
+
+static char *_key_at(flat_set_descriptor_t *flat_set_desc, size_t index) {
+    return (char *)*flat_set_desc->keys + index * flat_set_desc->key_size;
+}
+
+static cmagic_flat_set_iterator_t _iterator_at(flat_set_descriptor_t *flat_set_desc,
+                                               size_t index) {
+    return index < _size(flat_set_desc) ? _key_at(flat_set_desc, index) : NULL;
+}
+
+static size_t _index_of(flat_set_descriptor_t *flat_set_desc,
+                        cmagic_flat_set_iterator_t iterator) {
+    assert(iterator);
+    const size_t index =
+        (size_t)((const char *)iterator - _key_at(flat_set_desc, 0)) / flat_set_desc->key_size;
+    assert(index < _size(flat_set_desc));
+    return index;
+}
+
+static size_t _lower_bound(flat_set_descriptor_t *flat_set_desc, const void *key) {
+    return cmagic_sorted_array_lower_bound(*flat_set_desc->keys, _size(flat_set_desc),
+                                           flat_set_desc->key_size, key,
+                                           flat_set_desc->key_comparator);
+}
+
+static bool _contains_at(flat_set_descriptor_t *flat_set_desc, size_t index, const void *key) {
+    return index < _size(flat_set_desc)
+        && flat_set_desc->key_comparator(_key_at(flat_set_desc, index), key) == 0;
+}
+
+// Appends uninitialized keys to the vector, which is unchanged if the allocation fails
+static bool _grow_vector(void **vector, size_t count) {
+    return cmagic_vector_resize(vector, cmagic_vector_size(vector) + count);
+}
+
+static void _free_batch(flat_set_descriptor_t *flat_set_desc) {
+    if (flat_set_desc->pending_keys) {
+        cmagic_vector_free(flat_set_desc->pending_keys);
+        flat_set_desc->pending_keys = NULL;
+    }
+}
+
+void
+cmagic_flat_set_free(void *flat_set_ptr) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(flat_set_desc);
+    _free_batch(flat_set_desc);
+    cmagic_vector_free(flat_set_desc->keys);
+    alloc_packet->free_function(flat_set_desc);
+}
+
+void *
+cmagic_flat_set_copy(void *flat_set_ptr, cmagic_flat_set_copy_function_t copy) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    assert(!flat_set_desc->pending_keys);
+    const size_t size = _size(flat_set_desc);
+    flat_set_descriptor_t *copy_desc = (flat_set_descriptor_t *)cmagic_flat_set_new(
+        flat_set_desc->key_size, flat_set_desc->key_comparator, _get_alloc_packet(flat_set_desc));
+    if (!copy_desc) {
+        return NULL;
+    }
+    if (!_grow_vector(copy_desc->keys, size)) {
+        cmagic_flat_set_free(copy_desc);
+        return NULL;
+    }
+
+    if (copy) {
+        for (size_t i = 0; i < size; i++) {
+            copy(_key_at(copy_desc, i), _key_at(flat_set_desc, i));
+        }
+    } else if (size > 0) {
+        memcpy(_key_at(copy_desc, 0), _key_at(flat_set_desc, 0), size * flat_set_desc->key_size);
+    }
+
+    return (void *)copy_desc;
+}
+
+bool
+cmagic_flat_set_build_sorted(void *flat_set_ptr, const void *keys, size_t count) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    assert(_size(flat_set_desc) == 0);
+    assert(!flat_set_desc->pending_keys);
+    assert(count == 0 || keys);
+#ifndef NDEBUG
+    const char *key_bytes = (const char *)keys;
+    for (size_t i = 1; i < count; i++) {
+        assert(flat_set_desc->key_comparator(key_bytes + (i - 1) * flat_set_desc->key_size,
+                                             key_bytes + i * flat_set_desc->key_size) < 0);
+    }
+#endif
+
+    if (count == 0) {
+        return true;
+    }
+    if (!_grow_vector(flat_set_desc->keys, count)) {
+        return false;
+    }
+
+    memcpy(_key_at(flat_set_desc, 0), keys, count * flat_set_desc->key_size);
+    return true;
+}
+
+cmagic_flat_set_insert_result_t
+cmagic_flat_set_insert(void *flat_set_ptr, const void *key) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    const size_t index = _lower_bound(flat_set_desc, key);
+    if (_contains_at(flat_set_desc, index, key)) {
+        return (cmagic_flat_set_insert_result_t) {
+            .inserted_or_existing = _iterator_at(flat_set_desc, index),
+            .already_exists = true
+        };
+    }
+
+    const size_t moved_count = _size(flat_set_desc) - index;
+    if (!cmagic_vector_allocate_back(flat_set_desc->keys)) {
+        return (cmagic_flat_set_insert_result_t) {
+            .inserted_or_existing = NULL,
+            .already_exists = false
+        };
+    }
+
+    memmove(_key_at(flat_set_desc, index + 1), _key_at(flat_set_desc, index),
+            moved_count * flat_set_desc->key_size);
+    memcpy(_key_at(flat_set_desc, index), key, flat_set_desc->key_size);
+    return (cmagic_flat_set_insert_result_t) {
+        .inserted_or_existing = _iterator_at(flat_set_desc, index),
+        .already_exists = false
+    };
+}
+
+bool
+cmagic_flat_set_batch_insert(void *flat_set_ptr, const void *key) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    if (!flat_set_desc->pending_keys) {
+        flat_set_desc->pending_keys =
+            cmagic_vector_new(flat_set_desc->key_size, _get_alloc_packet(flat_set_desc));
+        if (!flat_set_desc->pending_keys) {
+            return false;
+        }
+    }
+
+    return cmagic_vector_push_back(flat_set_desc->pending_keys, key);
+}
+
+size_t
+cmagic_flat_set_batch_size(void *flat_set_ptr) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    return flat_set_desc->pending_keys ? cmagic_vector_size(flat_set_desc->pending_keys) : 0;
+}
+
+static char *_pending_key_at(flat_set_descriptor_t *flat_set_desc, size_t index) {
+    return (char *)*flat_set_desc->pending_keys + index * flat_set_desc->key_size;
+}
+
+// Same algorithm as the commit of the flat map batch
+bool
+cmagic_flat_set_batch_commit(void *flat_set_ptr, cmagic_flat_set_erase_destructor_t destructor) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    const size_t pending_count = cmagic_flat_set_batch_size(flat_set_ptr);
+    if (pending_count == 0) {
+        _free_batch(flat_set_desc);
+        return true;
+    }
+
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(flat_set_desc);
+    size_t *indices = (size_t *)alloc_packet->malloc_function(2 * pending_count * sizeof(size_t));
+    if (!indices) {
+        return false;
+    }
+
+    size_t *dropped = indices + pending_count;
+    for (size_t i = 0; i < pending_count; i++) {
+        indices[i] = i;
+    }
+    cmagic_sorted_array_sort_indices(*flat_set_desc->pending_keys, flat_set_desc->key_size,
+                                     indices, dropped, pending_count,
+                                     flat_set_desc->key_comparator);
+
+    const size_t size = _size(flat_set_desc);
+    size_t kept_count = 0;
+    size_t dropped_count = 0;
+    size_t position = 0;
+    for (size_t i = 0; i < pending_count; i++) {
+        const char *key = _pending_key_at(flat_set_desc, indices[i]);
+        position += cmagic_sorted_array_lower_bound(_key_at(flat_set_desc, position),
+                                                    size - position, flat_set_desc->key_size,
+                                                    key, flat_set_desc->key_comparator);
+        const bool duplicate = (kept_count > 0 && flat_set_desc->key_comparator(
+            _pending_key_at(flat_set_desc, indices[kept_count - 1]), key) == 0)
+            || _contains_at(flat_set_desc, position, key);
+        if (duplicate) {
+            dropped[dropped_count++] = indices[i];
+        } else {
+            indices[kept_count++] = indices[i];
+        }
+    }
+
+    if (!_grow_vector(flat_set_desc->keys, kept_count)) {
+        alloc_packet->free_function(indices);
+        return false;
+    }
+
+    size_t old_index = size;
+    size_t kept_index = kept_count;
+    size_t merged_index = size + kept_count;
+    while (kept_index > 0) {
+        merged_index--;
+        const char *pending_key = _pending_key_at(flat_set_desc, indices[kept_index - 1]);
+        if (old_index > 0 && flat_set_desc->key_comparator(_key_at(flat_set_desc, old_index - 1),
+                                                           pending_key) > 0) {
+            old_index--;
+            memcpy(_key_at(flat_set_desc, merged_index), _key_at(flat_set_desc, old_index),
+                   flat_set_desc->key_size);
+        } else {
+            kept_index--;
+            memcpy(_key_at(flat_set_desc, merged_index), pending_key, flat_set_desc->key_size);
+        }
+    }
+
+    if (destructor) {
+        for (size_t i = 0; i < dropped_count; i++) {
+            destructor(_pending_key_at(flat_set_desc, dropped[i]));
+        }
+    }
+
+    alloc_packet->free_function(indices);
+    _free_batch(flat_set_desc);
+    return true;
+}
+
+void
+cmagic_flat_set_erase_iterator(void *flat_set_ptr, cmagic_flat_set_iterator_t iterator,
+                               cmagic_flat_set_erase_destructor_t destructor) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    const size_t index = _index_of(flat_set_desc, iterator);
+    if (destructor) {
+        destructor(_key_at(flat_set_desc, index));
+    }
+
+    memmove(_key_at(flat_set_desc, index), _key_at(flat_set_desc, index + 1),
+            (_size(flat_set_desc) - index - 1) * flat_set_desc->key_size);
+    cmagic_vector_pop_back(flat_set_desc->keys);
+}
+
+void
+cmagic_flat_set_erase(void *flat_set_ptr, const void *key,
+                      cmagic_flat_set_erase_destructor_t destructor) {
+    cmagic_flat_set_iterator_t found = cmagic_flat_set_find(flat_set_ptr, key);
+    if (found) {
+        cmagic_flat_set_erase_iterator(flat_set_ptr, found, destructor);
+    }
+}
+
+void
+cmagic_flat_set_clear_ext(void *flat_set_ptr, cmagic_flat_set_erase_destructor_t destructor) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    const size_t size = _size(flat_set_desc);
+    const size_t pending_count = cmagic_flat_set_batch_size(flat_set_ptr);
+    if (destructor) {
+        for (size_t i = 0; i < size; i++) {
+            destructor(_key_at(flat_set_desc, i));
+        }
+        for (size_t i = 0; i < pending_count; i++) {
+            destructor(_pending_key_at(flat_set_desc, i));
+        }
+    }
+
+    cmagic_vector_clear(flat_set_desc->keys);
+    _free_batch(flat_set_desc);
+}
+
+void
+cmagic_flat_set_clear(void *flat_set_ptr) {
+    cmagic_flat_set_clear_ext(flat_set_ptr, NULL);
+}
+
+size_t
+cmagic_flat_set_size(void *flat_set_ptr) {
+    return _size(_get_flat_set_descriptor(flat_set_ptr));
+}
+
+const void *
+cmagic_flat_set_keys(void *flat_set_ptr) {
+    return *_get_flat_set_descriptor(flat_set_ptr)->keys;
+}
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_first(void *flat_set_ptr) {
+    return _iterator_at(_get_flat_set_descriptor(flat_set_ptr), 0);
+}
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_last(void *flat_set_ptr) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    const size_t size = _size(flat_set_desc);
+    return size > 0 ? _iterator_at(flat_set_desc, size - 1) : NULL;
+}
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_iterator_next(void *flat_set_ptr, cmagic_flat_set_iterator_t iterator) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    return _iterator_at(flat_set_desc, _index_of(flat_set_desc, iterator) + 1);
+}
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_iterator_prev(void *flat_set_ptr, cmagic_flat_set_iterator_t iterator) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    const size_t index = _index_of(flat_set_desc, iterator);
+    return index > 0 ? _iterator_at(flat_set_desc, index - 1) : NULL;
+}
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_find(void *flat_set_ptr, const void *key) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    const size_t index = _lower_bound(flat_set_desc, key);
+    return _contains_at(flat_set_desc, index, key) ? _iterator_at(flat_set_desc, index) : NULL;
+}
+
+bool
+cmagic_flat_set_contains(void *flat_set_ptr, const void *key) {
+    return cmagic_flat_set_find(flat_set_ptr, key) != NULL;
+}
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_lower_bound(void *flat_set_ptr, const void *key) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    return _iterator_at(flat_set_desc, _lower_bound(flat_set_desc, key));
+}
+
+cmagic_flat_set_iterator_t
+cmagic_flat_set_upper_bound(void *flat_set_ptr, const void *key) {
+    flat_set_descriptor_t *flat_set_desc = _get_flat_set_descriptor(flat_set_ptr);
+    return _iterator_at(flat_set_desc, cmagic_sorted_array_upper_bound(
+        *flat_set_desc->keys, _size(flat_set_desc), flat_set_desc->key_size, key,
+        flat_set_desc->key_comparator));
+}
+
+const cmagic_memory_alloc_packet_t *
+cmagic_flat_set_get_alloc_packet(void *flat_set_ptr) {
+    return _get_alloc_packet(_get_flat_set_descriptor(flat_set_ptr));
+}
@@ -0,0 +1,133 @@
+#include <string.h>
+#include "cmagic/hash.h"
+
+static const uint64_t SECRET[] = {
+    UINT64_C(0x2D358DCCAA6C78A5),
+    UINT64_C(0x8BB84B93962EACC9),
+    UINT64_C(0x4B33A62ED433D4A3),
+    UINT64_C(0x4D5A2DA51DE1AA47)
+};
+
+
+// Multiplies both values, leaving the low half of the product in the first and the high half in
+// the second
+static void _multiply(uint64_t *low, uint64_t *high) {
+#ifdef __SIZEOF_INT128__
+    __extension__ unsigned __int128 product = (unsigned __int128)*low * *high;
+    *low = (uint64_t)product;
+    *high = (uint64_t)(product >> 64);
+#else
+    const uint64_t a = *low, b = *high;
+    const uint64_t a_high = a >> 32, a_low = (uint32_t)a;
+    const uint64_t b_high = b >> 32, b_low = (uint32_t)b;
+    const uint64_t low_low = a_low * b_low, low_high = a_low * b_high;
+    const uint64_t high_low = a_high * b_low, high_high = a_high * b_high;
+    const uint64_t middle = (low_low >> 32) + (uint32_t)low_high + high_low;
+    *low = (middle << 32) | (uint32_t)low_low;
+    *high = high_high + (low_high >> 32) + (middle >> 32);
+#endif
+}
+
+static uint64_t _mix(uint64_t a, uint64_t b) {
+    _multiply(&a, &b);
+    return a ^ b;
+}
+
+// Inputs are read as little endian on every platform, so their hashes don't depend on it
+static uint64_t _read64(const uint8_t *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static uint64_t _read32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+// Reads 1 to 3 bytes, each of them at least once
+static uint64_t _read_small(const uint8_t *p, size_t size) {
+    return (uint64_t)p[0] << 16 | (uint64_t)p[size >> 1] << 8 | p[size - 1];
+}
+
+uint64_t
+cmagic_hash_bytes(const void *data, size_t size, uint64_t seed) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t a, b;
+    seed ^= _mix(seed ^ SECRET[0], SECRET[1]);
+
+    if (size <= 16) {
+        if (size >= 4) {
+            // Two possibly overlapping pairs of 32-bit words cover the whole input
+            const size_t offset = (size >> 3) << 2;
+            a = _read32(p) << 32 | _read32(p + offset);
+            b = _read32(p + size - 4) << 32 | _read32(p + size - 4 - offset);
+        } else if (size > 0) {
+            a = _read_small(p, size);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t left = size;
+        if (left > 48) {
+            uint64_t lane1 = seed, lane2 = seed;
+            do {
+                seed = _mix(_read64(p) ^ SECRET[1], _read64(p + 8) ^ seed);
+                lane1 = _mix(_read64(p + 16) ^ SECRET[2], _read64(p + 24) ^ lane1);
+                lane2 = _mix(_read64(p + 32) ^ SECRET[3], _read64(p + 40) ^ lane2);
+                p += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= lane1 ^ lane2;
+        }
+        while (left > 16) {
+            seed = _mix(_read64(p) ^ SECRET[1], _read64(p + 8) ^ seed);
+            p += 16;
+            left -= 16;
+        }
+        // The last 16 bytes of the input, which may overlap the already hashed ones
+        a = _read64(p + left - 16);
+        b = _read64(p + left - 8);
+    }
+
+    a ^= SECRET[1];
+    b ^= seed;
+    _multiply(&a, &b);
+    return _mix(a ^ SECRET[0] ^ (uint64_t)size, b ^ SECRET[1]);
+}
+
+size_t
+cmagic_hash_int32(const void *key) {
+    int32_t value;
+    memcpy(&value, key, sizeof(value));
+    return (size_t)cmagic_hash_mix64((uint64_t)(int64_t)value);
+}
+
+size_t
+cmagic_hash_uint32(const void *key) {
+    uint32_t value;
+    memcpy(&value, key, sizeof(value));
+    return (size_t)cmagic_hash_mix64(value);
+}
+
+size_t
+cmagic_hash_int64(const void *key) {
+    int64_t value;
+    memcpy(&value, key, sizeof(value));
+    return (size_t)cmagic_hash_mix64((uint64_t)value);
+}
+
+size_t
+cmagic_hash_uint64(const void *key) {
+    uint64_t value;
+    memcpy(&value, key, sizeof(value));
+    return (size_t)cmagic_hash_mix64(value);
+}
@@ -0,0 +1,255 @@
+#include <stdint.h>
+#include <string.h>
+#include "cmagic/hashmap.h"
+#include "hash_table.h"
+
+#ifndef NDEBUG
+static const int_least32_t HASHMAP_MAGIC_VALUE = 'H' << 16 | 'M' << 8 | 'P';
+#endif
+
+
+typedef struct {
+#ifndef NDEBUG
+    int_least32_t magic_value;
+#endif
+    void *internal_table;
+    cmagic_hashmap_relocate_function_t relocate;
+    size_t key_size;
+    size_t value_size;
+} hashmap_descriptor_t;
+
+
+void *
+cmagic_hashmap_new(size_t key_size, size_t value_size, cmagic_hashmap_hash_function_t hash,
+                   cmagic_hashmap_key_equal_t key_equal,
+                   const cmagic_memory_alloc_packet_t *alloc_packet) {
+    return cmagic_hashmap_new_ext(key_size, value_size, hash, key_equal, alloc_packet, NULL);
+}
+
+void *
+cmagic_hashmap_new_ext(size_t key_size, size_t value_size, cmagic_hashmap_hash_function_t hash,
+                       cmagic_hashmap_key_equal_t key_equal,
+                       const cmagic_memory_alloc_packet_t *alloc_packet,
+                       cmagic_hashmap_relocate_function_t relocate) {
+    assert(key_size > 0);
+    assert(value_size > 0);
+    assert(hash);
+    assert(alloc_packet);
+
+    hashmap_descriptor_t *hashmap_desc =
+        (hashmap_descriptor_t *) alloc_packet->malloc_function(sizeof(hashmap_descriptor_t));
+    if (!hashmap_desc) {
+        return NULL;
+    }
+
+    *hashmap_desc = (hashmap_descriptor_t) {
+#ifndef NDEBUG
+        .magic_value = HASHMAP_MAGIC_VALUE,
+#endif
+        .internal_table = cmagic_hash_table_new(key_size, value_size, hash, key_equal,
+                                                alloc_packet),
+        .relocate = relocate,
+        .key_size = key_size,
+        .value_size = value_size
+    };
+
+    if (!hashmap_desc->internal_table) {
+        alloc_packet->free_function(hashmap_desc);
+        return NULL;
+    }
+
+    return (void *)hashmap_desc;
+}
+
+static hashmap_descriptor_t *_get_hashmap_descriptor(void *hashmap_ptr) {
+    assert(hashmap_ptr);
+    hashmap_descriptor_t *result = (hashmap_descriptor_t *)hashmap_ptr;
+    assert(result->magic_value == HASHMAP_MAGIC_VALUE);
+    return result;
+}
+
+static const cmagic_memory_alloc_packet_t *
+_get_alloc_packet(hashmap_descriptor_t *hashmap_desc) {
+    return cmagic_hash_table_get_alloc_packet(hashmap_desc->internal_table);
+}
+
+static void *_value_of(hashmap_descriptor_t *hashmap_desc, void *slot) {
+    return (char *)slot + cmagic_hash_table_value_offset(hashmap_desc->internal_table);
+}
+
+static cmagic_hashmap_iterator_t _iterator_of(hashmap_descriptor_t *hashmap_desc, void *slot) {
+    return (cmagic_hashmap_iterator_t) {
+        .key = slot,
+        .value = slot ? _value_of(hashmap_desc, slot) : NULL
+    };
+}
+
+static void _relocate_callback(void *destination, void *source, void *context) {
+    hashmap_descriptor_t *hashmap_desc = (hashmap_descriptor_t *)context;
+    hashmap_desc->relocate(destination, _value_of(hashmap_desc, destination),
+                           source, _value_of(hashmap_desc, source));
+}
+
+static cmagic_hash_table_relocate_t _get_relocate_callback(hashmap_descriptor_t *hashmap_desc) {
+    return hashmap_desc->relocate ? _relocate_callback : NULL;
+}
+
+void
+cmagic_hashmap_free(void *hashmap_ptr) {
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(hashmap_desc);
+    cmagic_hash_table_free(hashmap_desc->internal_table);
+    alloc_packet->free_function(hashmap_desc);
+}
+
+cmagic_hashmap_insert_result_t
+cmagic_hashmap_allocate(void *hashmap_ptr, const void *key) {
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    cmagic_hash_table_insert_result_t inserted =
+        cmagic_hash_table_insert(hashmap_desc->internal_table, key,
+                                 _get_relocate_callback(hashmap_desc), hashmap_desc);
+    return (cmagic_hashmap_insert_result_t) {
+        .inserted_or_existing = _iterator_of(hashmap_desc, inserted.slot),
+        .already_exists = inserted.already_exists
+    };
+}
+
+cmagic_hashmap_insert_result_t
+cmagic_hashmap_insert(void *hashmap_ptr, const void *key, const void *value) {
+    cmagic_hashmap_insert_result_t result = cmagic_hashmap_allocate(hashmap_ptr, key);
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+
+    if (result.inserted_or_existing.key && !result.already_exists) {
+        memcpy((void *)result.inserted_or_existing.key, key, hashmap_desc->key_size);
+        memcpy(result.inserted_or_existing.value, value, hashmap_desc->value_size);
+    }
+
+    return result;
+}
+
+void
+cmagic_hashmap_erase_iterator(void *hashmap_ptr, cmagic_hashmap_iterator_t iterator,
+                              cmagic_hashmap_erase_destructor_t destructor) {
+    assert(iterator.key);
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    if (destructor) {
+        destructor((void *)iterator.key, iterator.value);
+    }
+    cmagic_hash_table_erase_slot(hashmap_desc->internal_table, (void *)iterator.key);
+}
+
+void
+cmagic_hashmap_erase(void *hashmap_ptr, const void *key,
+                     cmagic_hashmap_erase_destructor_t destructor) {
+    cmagic_hashmap_iterator_t found = cmagic_hashmap_find(hashmap_ptr, key);
+    if (found.key) {
+        cmagic_hashmap_erase_iterator(hashmap_ptr, found, destructor);
+    }
+}
+
+typedef struct {
+    hashmap_descriptor_t *hashmap_desc;
+    cmagic_hashmap_erase_destructor_t destructor;
+} clear_context_t;
+
+static void _clear_callback(void *slot, void *context) {
+    const clear_context_t *clear_context = (const clear_context_t *)context;
+    clear_context->destructor(slot, _value_of(clear_context->hashmap_desc, slot));
+}
+
+void
+cmagic_hashmap_clear_ext(void *hashmap_ptr, cmagic_hashmap_erase_destructor_t destructor) {
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    clear_context_t clear_context = {
+        .hashmap_desc = hashmap_desc,
+        .destructor = destructor
+    };
+    cmagic_hash_table_clear(hashmap_desc->internal_table, destructor ? _clear_callback : NULL,
+                            &clear_context);
+}
+
+void
+cmagic_hashmap_clear(void *hashmap_ptr) {
+    cmagic_hashmap_clear_ext(hashmap_ptr, NULL);
+}
+
+typedef struct {
+    hashmap_descriptor_t *hashmap_desc;
+    cmagic_hashmap_copy_function_t copy;
+} copy_context_t;
+
+static void _copy_callback(void *destination, const void *source, void *context) {
+    const copy_context_t *copy_context = (const copy_context_t *)context;
+    copy_context->copy(destination, _value_of(copy_context->hashmap_desc, destination),
+                       source, _value_of(copy_context->hashmap_desc, (void *)source));
+}
+
+void *
+cmagic_hashmap_copy(void *hashmap_ptr, cmagic_hashmap_copy_function_t copy) {
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(hashmap_desc);
+    hashmap_descriptor_t *copy_desc = (hashmap_descriptor_t *)
+        alloc_packet->malloc_function(sizeof(hashmap_descriptor_t));
+    if (!copy_desc) {
+        return NULL;
+    }
+
+    copy_context_t copy_context = {
+        .hashmap_desc = hashmap_desc,
+        .copy = copy
+    };
+    *copy_desc = *hashmap_desc;
+    copy_desc->internal_table = cmagic_hash_table_copy(hashmap_desc->internal_table,
+                                                       copy ? _copy_callback : NULL,
+                                                       &copy_context);
+    if (!copy_desc->internal_table) {
+        alloc_packet->free_function(copy_desc);
+        return NULL;
+    }
+
+    return (void *)copy_desc;
+}
+
+bool
+cmagic_hashmap_reserve(void *hashmap_ptr, size_t count) {
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    return cmagic_hash_table_reserve(hashmap_desc->internal_table, count,
+                                     _get_relocate_callback(hashmap_desc), hashmap_desc);
+}
+
+size_t
+cmagic_hashmap_size(void *hashmap_ptr) {
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    return cmagic_hash_table_size(hashmap_desc->internal_table);
+}
+
+size_t
+cmagic_hashmap_capacity(void *hashmap_ptr) {
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    return cmagic_hash_table_capacity(hashmap_desc->internal_table);
+}
+
+cmagic_hashmap_iterator_t
+cmagic_hashmap_first(void *hashmap_ptr) {
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    return _iterator_of(hashmap_desc, cmagic_hash_table_first(hashmap_desc->internal_table));
+}
+
+cmagic_hashmap_iterator_t
+cmagic_hashmap_iterator_next(void *hashmap_ptr, cmagic_hashmap_iterator_t iterator) {
+    assert(iterator.key);
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    return _iterator_of(hashmap_desc, cmagic_hash_table_next(hashmap_desc->internal_table,
+                                                             (void *)iterator.key));
+}
+
+cmagic_hashmap_iterator_t
+cmagic_hashmap_find(void *hashmap_ptr, const void *key) {
+    hashmap_descriptor_t *hashmap_desc = _get_hashmap_descriptor(hashmap_ptr);
+    return _iterator_of(hashmap_desc, cmagic_hash_table_find(hashmap_desc->internal_table, key));
+}
+
+const cmagic_memory_alloc_packet_t *
+cmagic_hashmap_get_alloc_packet(void *hashmap_ptr) {
+    return _get_alloc_packet(_get_hashmap_descriptor(hashmap_ptr));
+}
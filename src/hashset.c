@@ -0,0 +1,220 @@
+#include <stdint.h>
+#include <string.h>
+#include "cmagic/hashset.h"
+#include "hash_table.h"
+
+#ifndef NDEBUG
+static const int_least32_t HASHSET_MAGIC_VALUE = 'H' << 16 | 'S' << 8 | 'T';
+#endif
+
+
+// The hash table is shared with the hashmap, its slots hold the keys only
+typedef struct {
+#ifndef NDEBUG
+    int_least32_t magic_value;
+#endif
+    void *internal_table;
+    cmagic_hashset_relocate_function_t relocate;
+    size_t key_size;
+} hashset_descriptor_t;
+
+
+void *
+cmagic_hashset_new(size_t key_size, cmagic_hashset_hash_function_t hash,
+                   cmagic_hashset_key_equal_t key_equal,
+                   const cmagic_memory_alloc_packet_t *alloc_packet) {
+    return cmagic_hashset_new_ext(key_size, hash, key_equal, alloc_packet, NULL);
+}
+
+void *
+cmagic_hashset_new_ext(size_t key_size, cmagic_hashset_hash_function_t hash,
+                       cmagic_hashset_key_equal_t key_equal,
+                       const cmagic_memory_alloc_packet_t *alloc_packet,
+                       cmagic_hashset_relocate_function_t relocate) {
+    assert(key_size > 0);
+    assert(hash);
+    assert(alloc_packet);
+
+    hashset_descriptor_t *hashset_desc =
+        (hashset_descriptor_t *) alloc_packet->malloc_function(sizeof(hashset_descriptor_t));
+    if (!hashset_desc) {
+        return NULL;
+    }
+
+    *hashset_desc = (hashset_descriptor_t) {
+#ifndef NDEBUG
+        .magic_value = HASHSET_MAGIC_VALUE,
+#endif
+        .internal_table = cmagic_hash_table_new(key_size, 0, hash, key_equal, alloc_packet),
+        .relocate = relocate,
+        .key_size = key_size
+    };
+
+    if (!hashset_desc->internal_table) {
+        alloc_packet->free_function(hashset_desc);
+        return NULL;
+    }
+
+    return (void *)hashset_desc;
+}
+
+static hashset_descriptor_t *_get_hashset_descriptor(void *hashset_ptr) {
+    assert(hashset_ptr);
+    hashset_descriptor_t *result = (hashset_descriptor_t *)hashset_ptr;
+    assert(result->magic_value == HASHSET_MAGIC_VALUE);
+    return result;
+}
+
+static const cmagic_memory_alloc_packet_t *
+_get_alloc_packet(hashset_descriptor_t *hashset_desc) {
+    return cmagic_hash_table_get_alloc_packet(hashset_desc->internal_table);
+}
+
+static void _relocate_callback(void *destination, void *source, void *context) {
+    ((hashset_descriptor_t *)context)->relocate(destination, source);
+}
+
+static cmagic_hash_table_relocate_t _get_relocate_callback(hashset_descriptor_t *hashset_desc) {
+    return hashset_desc->relocate ? _relocate_callback : NULL;
+}
+
+void
+cmagic_hashset_free(void *hashset_ptr) {
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(hashset_desc);
+    cmagic_hash_table_free(hashset_desc->internal_table);
+    alloc_packet->free_function(hashset_desc);
+}
+
+cmagic_hashset_insert_result_t
+cmagic_hashset_allocate(void *hashset_ptr, const void *key) {
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    cmagic_hash_table_insert_result_t inserted =
+        cmagic_hash_table_insert(hashset_desc->internal_table, key,
+                                 _get_relocate_callback(hashset_desc), hashset_desc);
+    return (cmagic_hashset_insert_result_t) {
+        .inserted_or_existing = inserted.slot,
+        .already_exists = inserted.already_exists
+    };
+}
+
+cmagic_hashset_insert_result_t
+cmagic_hashset_insert(void *hashset_ptr, const void *key) {
+    cmagic_hashset_insert_result_t result = cmagic_hashset_allocate(hashset_ptr, key);
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+
+    if (result.inserted_or_existing && !result.already_exists) {
+        memcpy((void *)result.inserted_or_existing, key, hashset_desc->key_size);
+    }
+
+    return result;
+}
+
+void
+cmagic_hashset_erase_iterator(void *hashset_ptr, cmagic_hashset_iterator_t iterator,
+                              cmagic_hashset_erase_destructor_t destructor) {
+    assert(iterator);
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    if (destructor) {
+        destructor((void *)iterator);
+    }
+    cmagic_hash_table_erase_slot(hashset_desc->internal_table, (void *)iterator);
+}
+
+void
+cmagic_hashset_erase(void *hashset_ptr, const void *key,
+                     cmagic_hashset_erase_destructor_t destructor) {
+    cmagic_hashset_iterator_t found = cmagic_hashset_find(hashset_ptr, key);
+    if (found) {
+        cmagic_hashset_erase_iterator(hashset_ptr, found, destructor);
+    }
+}
+
+static void _clear_callback(void *slot, void *context) {
+    (*(cmagic_hashset_erase_destructor_t *)context)(slot);
+}
+
+void
+cmagic_hashset_clear_ext(void *hashset_ptr, cmagic_hashset_erase_destructor_t destructor) {
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    cmagic_hash_table_clear(hashset_desc->internal_table, destructor ? _clear_callback : NULL,
+                            &destructor);
+}
+
+void
+cmagic_hashset_clear(void *hashset_ptr) {
+    cmagic_hashset_clear_ext(hashset_ptr, NULL);
+}
+
+static void _copy_callback(void *destination, const void *source, void *context) {
+    (*(cmagic_hashset_copy_function_t *)context)(destination, source);
+}
+
+void *
+cmagic_hashset_copy(void *hashset_ptr, cmagic_hashset_copy_function_t copy) {
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(hashset_desc);
+    hashset_descriptor_t *copy_desc = (hashset_descriptor_t *)
+        alloc_packet->malloc_function(sizeof(hashset_descriptor_t));
+    if (!copy_desc) {
+        return NULL;
+    }
+
+    *copy_desc = *hashset_desc;
+    copy_desc->internal_table = cmagic_hash_table_copy(hashset_desc->internal_table,
+                                                       copy ? _copy_callback : NULL, &copy);
+    if (!copy_desc->internal_table) {
+        alloc_packet->free_function(copy_desc);
+        return NULL;
+    }
+
+    return (void *)copy_desc;
+}
+
+bool
+cmagic_hashset_reserve(void *hashset_ptr, size_t count) {
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    return cmagic_hash_table_reserve(hashset_desc->internal_table, count,
+                                     _get_relocate_callback(hashset_desc), hashset_desc);
+}
+
+size_t
+cmagic_hashset_size(void *hashset_ptr) {
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    return cmagic_hash_table_size(hashset_desc->internal_table);
+}
+
+size_t
+cmagic_hashset_capacity(void *hashset_ptr) {
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    return cmagic_hash_table_capacity(hashset_desc->internal_table);
+}
+
+cmagic_hashset_iterator_t
+cmagic_hashset_first(void *hashset_ptr) {
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    return cmagic_hash_table_first(hashset_desc->internal_table);
+}
+
+cmagic_hashset_iterator_t
+cmagic_hashset_iterator_next(void *hashset_ptr, cmagic_hashset_iterator_t iterator) {
+    assert(iterator);
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    return cmagic_hash_table_next(hashset_desc->internal_table, (void *)iterator);
+}
+
+cmagic_hashset_iterator_t
+cmagic_hashset_find(void *hashset_ptr, const void *key) {
+    hashset_descriptor_t *hashset_desc = _get_hashset_descriptor(hashset_ptr);
+    return cmagic_hash_table_find(hashset_desc->internal_table, key);
+}
+
+bool
+cmagic_hashset_contains(void *hashset_ptr, const void *key) {
+    return cmagic_hashset_find(hashset_ptr, key) != NULL;
+}
+
+const cmagic_memory_alloc_packet_t *
+cmagic_hashset_get_alloc_packet(void *hashset_ptr) {
+    return _get_alloc_packet(_get_hashset_descriptor(hashset_ptr));
+}
@@ -7,6 +7,9 @@
 static const int_least32_t AVL_TREE_MAGIC_VALUE = 'T' << 24 | 'R' << 16 | 'E' << 8 | 'E';
 #endif
 
+// Subtree sizes are 32-bit, so that they fit next to the height and the node stays small
+#define AVL_TREE_MAX_SIZE ((size_t)UINT32_MAX)
+
 typedef struct tree_node {
     const void *key;
     void *value;
@@ -14,8 +17,12 @@ typedef struct tree_node {
     struct tree_node *left_kid;
     struct tree_node *right_kid;
     int subtree_height;
+    uint32_t subtree_size;
 } tree_node_t;
 
+_Static_assert(sizeof(tree_node_t) <= 5 * sizeof(void *) + 2 * sizeof(uint32_t),
+               "subtree size has to fit into the padding after the height");
+
 typedef struct {
 #ifndef NDEBUG
     int_least32_t magic_value;
@@ -62,11 +69,24 @@ static int _get_height(const tree_node_t *node) {
     return node ? node->subtree_height : 0;
 }
 
+static size_t _get_size(const tree_node_t *node) {
+    return node ? node->subtree_size : 0;
+}
+
+static void _update_subtree_info(tree_node_t *node) {
+    node->subtree_height =
+        1 + CMAGIC_UTILS_MAX(_get_height(node->left_kid), _get_height(node->right_kid));
+    node->subtree_size = (uint32_t)(1 + _get_size(node->left_kid) + _get_size(node->right_kid));
+}
+
 static tree_node_t *_new_node(tree_descriptor_t *tree, tree_node_t *parent, const void *key,
                               void *value) {
     assert(tree);
     assert(key);
-    
+    if (tree->tree_size >= AVL_TREE_MAX_SIZE) {
+        return NULL;
+    }
+
     tree_node_t *new_node = (tree_node_t *)tree->alloc_packet->malloc_function(sizeof(tree_node_t));
     if (!new_node) {
         return NULL;
@@ -78,7 +98,8 @@ static tree_node_t *_new_node(tree_descriptor_t *tree, tree_node_t *parent, cons
         .parent = parent,
         .left_kid = NULL,
         .right_kid = NULL,
-        .subtree_height = 1
+        .subtree_height = 1,
+        .subtree_size = 1
     };
 
     return new_node;
@@ -105,8 +126,8 @@ static void _rotate_right(tree_node_t **y_ptr) {
         T2->parent = y;
     }
 
-    y->subtree_height = CMAGIC_UTILS_MAX(_get_height(y->left_kid), _get_height(y->right_kid)) + 1;
-    x->subtree_height = CMAGIC_UTILS_MAX(_get_height(x->left_kid), _get_height(x->right_kid)) + 1;
+    _update_subtree_info(y);
+    _update_subtree_info(x);
 }
 
 /*
@@ -130,23 +151,19 @@ static void _rotate_left(tree_node_t **x_ptr) {
         T2->parent = x;
     }
 
-    y->subtree_height = CMAGIC_UTILS_MAX(_get_height(y->left_kid), _get_height(y->right_kid)) + 1;
-    x->subtree_height = CMAGIC_UTILS_MAX(_get_height(x->left_kid), _get_height(x->right_kid)) + 1;
+    _update_subtree_info(x);
+    _update_subtree_info(y);
 }
 
 static int _get_balance(const tree_node_t *node) {
     return node ? _get_height(node->left_kid) - _get_height(node->right_kid) : 0;
 }
 
-static void _rebalance(tree_descriptor_t *tree, tree_node_t **node_ptr,
-                       const void *inserted_or_erased_key) {
-    assert(tree);
+static void _rebalance(tree_node_t **node_ptr) {
     assert(node_ptr && *node_ptr);
-    assert(inserted_or_erased_key);
 
     tree_node_t *node = *node_ptr;
-    node->subtree_height = 1 + CMAGIC_UTILS_MAX(_get_height(node->left_kid),
-                                                _get_height(node->right_kid));
+    _update_subtree_info(node);
 
     // Handle balance violation cases, see https://en.wikipedia.org/wiki/AVL_tree#Rebalancing
     int balance = _get_balance(node);
@@ -160,7 +177,7 @@ static void _rebalance(tree_descriptor_t *tree, tree_node_t **node_ptr,
      *     / \
      *   T1   T2
      */
-    if (balance > 1 && tree->key_comparator(inserted_or_erased_key, node->left_kid->key) < 0) {
+    if (balance > 1 && _get_balance(node->left_kid) >= 0) {
         _rotate_right(node_ptr);
         return;
     }
@@ -174,7 +191,7 @@ static void _rebalance(tree_descriptor_t *tree, tree_node_t **node_ptr,
      *          / \
      *        T3  T4
      */
-    if (balance < -1 && tree->key_comparator(inserted_or_erased_key, node->right_kid->key) > 0) {
+    if (balance < -1 && _get_balance(node->right_kid) <= 0) {
         _rotate_left(node_ptr);
         return;
     }
@@ -188,7 +205,7 @@ static void _rebalance(tree_descriptor_t *tree, tree_node_t **node_ptr,
      *       / \
      *     T2   T3
      */
-    if (balance > 1 && tree->key_comparator(inserted_or_erased_key, node->left_kid->key) > 0) {
+    if (balance > 1) {
         _rotate_left(&node->left_kid);
         _rotate_right(node_ptr);
         return;
@@ -203,7 +220,7 @@ static void _rebalance(tree_descriptor_t *tree, tree_node_t **node_ptr,
      *     / \
      *   T2   T3
      */
-    if (balance < -1 && tree->key_comparator(inserted_or_erased_key, node->right_kid->key) < 0) {
+    if (balance < -1) {
         _rotate_right(&node->right_kid);
         _rotate_left(node_ptr);
         return;
@@ -217,14 +234,13 @@ typedef struct {
     tree_node_t *node_parent; // needed when *node_ptr == NULL
 } internal_find_result_t;
 
-static internal_find_result_t _internal_find(tree_descriptor_t *tree, const void *key) {
-    assert(tree);
-    assert(key);
+static inline internal_find_result_t _find_with(tree_descriptor_t *tree, const void *key,
+                                                cmagic_avl_tree_key_comparator_t key_comparator) {
     tree_node_t **node_ptr = &tree->root;
     tree_node_t *node_parent = NULL;
 
     while (*node_ptr) {
-        int comparison_result = tree->key_comparator(key, (*node_ptr)->key);
+        int comparison_result = key_comparator(key, (*node_ptr)->key);
         if (comparison_result < 0) {
             node_parent = *node_ptr;
             node_ptr = &(*node_ptr)->left_kid;
@@ -239,17 +255,32 @@ static internal_find_result_t _internal_find(tree_descriptor_t *tree, const void
     return (internal_find_result_t) { node_ptr, node_parent };
 }
 
-static tree_node_t **_get_node_ptr(tree_descriptor_t *tree, tree_node_t *node) {
+static internal_find_result_t _internal_find(tree_descriptor_t *tree, const void *key) {
     assert(tree);
+    assert(key);
+    return CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(_find_with, tree->key_comparator, tree, key);
+}
+
+static tree_node_t **_get_node_ptr(tree_node_t **root_ptr, tree_node_t *node) {
+    assert(root_ptr);
     assert(node);
     if (!node->parent) {
-        return &tree->root;
+        return root_ptr;
     }
 
     assert(node->parent->left_kid == node || node->parent->right_kid == node);
     return node->parent->left_kid == node ? &node->parent->left_kid : &node->parent->right_kid;
 }
 
+// Heights and sizes may change on the whole path from the node up to the root
+static void _rebalance_path(tree_node_t **root_ptr, tree_node_t *node) {
+    for (; node; node = node->parent) {
+        tree_node_t **node_ptr = _get_node_ptr(root_ptr, node);
+        _rebalance(node_ptr);
+        node = *node_ptr;
+    }
+}
+
 cmagic_avl_tree_insert_result_t
 cmagic_avl_tree_insert(void *avl_tree, const void *key, void *value) {
     assert(key);
@@ -273,12 +304,7 @@ cmagic_avl_tree_insert(void *avl_tree, const void *key, void *value) {
         };
     }
     tree->tree_size++;
-
-    for (tree_node_t *node = new_node->parent; node; node = node->parent) {
-        tree_node_t **node_ptr = _get_node_ptr(tree, node);
-        _rebalance(tree, node_ptr, key);
-        node = *node_ptr;
-    }
+    _rebalance_path(&tree->root, new_node->parent);
 
     return (cmagic_avl_tree_insert_result_t) {
         .inserted_or_existing = (cmagic_avl_tree_iterator_t)new_node,
@@ -286,78 +312,456 @@ cmagic_avl_tree_insert(void *avl_tree, const void *key, void *value) {
     };
 }
 
-void
-cmagic_avl_tree_erase(void *avl_tree, const void *key) {
+// Equivalent keys lead to the right, so a new element goes after all elements equivalent to it
+static inline internal_find_result_t
+_find_last_with(tree_descriptor_t *tree, const void *key,
+                cmagic_avl_tree_key_comparator_t key_comparator) {
+    tree_node_t **node_ptr = &tree->root;
+    tree_node_t *node_parent = NULL;
+
+    while (*node_ptr) {
+        node_parent = *node_ptr;
+        node_ptr = key_comparator(key, (*node_ptr)->key) < 0 ? &(*node_ptr)->left_kid
+                                                             : &(*node_ptr)->right_kid;
+    }
+
+    return (internal_find_result_t) { node_ptr, node_parent };
+}
+
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_insert_equal(void *avl_tree, const void *key, void *value) {
     assert(key);
     tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
-    internal_find_result_t find_result = _internal_find(tree, key);
-    assert(find_result.node_ptr);
-    if (!*find_result.node_ptr) {
-        return;
+    internal_find_result_t find_result =
+        CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(_find_last_with, tree->key_comparator, tree, key);
+    assert(find_result.node_ptr && !*find_result.node_ptr);
+
+    tree_node_t *new_node = *find_result.node_ptr =
+        _new_node(tree, find_result.node_parent, key, value);
+    if (!new_node) {
+        return NULL;
     }
+    tree->tree_size++;
+    _rebalance_path(&tree->root, new_node->parent);
+    return (cmagic_avl_tree_iterator_t)new_node;
+}
 
-    tree_node_t **node_ptr = find_result.node_ptr;
-    tree_node_t *node = *node_ptr;
+void
+cmagic_avl_tree_replace_key(void *avl_tree, cmagic_avl_tree_iterator_t iterator,
+                            const void *new_key) {
+    (void)_get_avl_tree_descriptor(avl_tree);
+    assert(iterator);
+    assert(new_key);
+    iterator->key = new_key;
+}
+
+/*
+ * Detaches the node from the tree. A node with two kids is replaced by its successor node, not by
+ * its successor's key and value, so iterators to all other elements stay valid.
+ */
+static void _unlink_node(tree_descriptor_t *tree, tree_node_t *node) {
+    tree_node_t **node_ptr = _get_node_ptr(&tree->root, node);
+    tree_node_t *rebalance_start;
     if (node->left_kid && node->right_kid) {
         tree_node_t *successor =
             (tree_node_t *)cmagic_avl_tree_iterator_next((cmagic_avl_tree_iterator_t)node);
         assert(successor);
         assert(!successor->left_kid);
 
-        // Unlink successor from the tree
-        if (successor->right_kid) {
-            successor->right_kid->parent = successor->parent;
+        if (successor->parent == node) {
+            rebalance_start = successor;
+        } else {
+            // Unlink successor from its place and take over the right subtree of the node
+            rebalance_start = successor->parent;
+            successor->parent->left_kid = successor->right_kid;
+            if (successor->right_kid) {
+                successor->right_kid->parent = successor->parent;
+            }
+            successor->right_kid = node->right_kid;
+            successor->right_kid->parent = successor;
         }
-        node_ptr = _get_node_ptr(tree, successor);
-        *node_ptr = successor->right_kid;
 
-        // Move key and value
-        node->key = successor->key;
-        node->value = successor->value;
-
-        // Delete successor
-        tree->alloc_packet->free_function(successor);
-        tree->tree_size--;
+        successor->left_kid = node->left_kid;
+        successor->left_kid->parent = successor;
+        successor->parent = node->parent;
+        *node_ptr = successor;
     } else {
         tree_node_t *kid = node->left_kid ? node->left_kid : node->right_kid;
-
-        // Unlink node from the tree
         if (kid) {
             kid->parent = node->parent;
         }
         *node_ptr = kid;
-
-        // Delete node
-        tree->alloc_packet->free_function(node);
-        tree->tree_size--;
+        rebalance_start = node->parent;
     }
 
-    for (node = *node_ptr; node; node = node->parent) {
-        node_ptr = _get_node_ptr(tree, node);
-        _rebalance(tree, node_ptr, key);
-        node = *node_ptr;
-    }
+    tree->tree_size--;
+    _rebalance_path(&tree->root, rebalance_start);
+    node->parent = node->left_kid = node->right_kid = NULL;
+    _update_subtree_info(node);
 }
 
-static void _internal_free(tree_descriptor_t *tree, tree_node_t *node) {
-    assert(tree);
-    if (!node) {
+void
+cmagic_avl_tree_erase(void *avl_tree, const void *key) {
+    assert(key);
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    internal_find_result_t find_result = _internal_find(tree, key);
+    assert(find_result.node_ptr);
+    if (!*find_result.node_ptr) {
         return;
     }
 
-    _internal_free(tree, node->left_kid);
-    _internal_free(tree, node->right_kid);
+    tree_node_t *node = *find_result.node_ptr;
+    _unlink_node(tree, node);
     tree->alloc_packet->free_function(node);
 }
 
 void
-cmagic_avl_tree_clear(void *avl_tree) {
+cmagic_avl_tree_erase_iterator(void *avl_tree, cmagic_avl_tree_iterator_t iterator) {
+    assert(iterator);
     tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
-    _internal_free(tree, tree->root);
+    _unlink_node(tree, (tree_node_t *)iterator);
+    tree->alloc_packet->free_function(iterator);
+}
+
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_extract(void *avl_tree, const void *key) {
+    assert(key);
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    internal_find_result_t find_result = _internal_find(tree, key);
+    assert(find_result.node_ptr);
+    tree_node_t *node = *find_result.node_ptr;
+    if (node) {
+        _unlink_node(tree, node);
+    }
+    return (cmagic_avl_tree_iterator_t)node;
+}
+
+cmagic_avl_tree_insert_result_t
+cmagic_avl_tree_insert_node(void *avl_tree, cmagic_avl_tree_iterator_t iterator) {
+    assert(iterator);
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    tree_node_t *node = (tree_node_t *)iterator;
+    assert(!node->parent && !node->left_kid && !node->right_kid);
+    internal_find_result_t find_result = _internal_find(tree, node->key);
+    assert(find_result.node_ptr);
+
+    if (*find_result.node_ptr) {
+        return (cmagic_avl_tree_insert_result_t) {
+            .inserted_or_existing = (cmagic_avl_tree_iterator_t)*find_result.node_ptr,
+            .already_exists = true
+        };
+    }
+    if (tree->tree_size >= AVL_TREE_MAX_SIZE) {
+        return (cmagic_avl_tree_insert_result_t) {
+            .inserted_or_existing = NULL,
+            .already_exists = false
+        };
+    }
+
+    *find_result.node_ptr = node;
+    node->parent = find_result.node_parent;
+    tree->tree_size++;
+    _rebalance_path(&tree->root, node->parent);
+    return (cmagic_avl_tree_insert_result_t) {
+        .inserted_or_existing = iterator,
+        .already_exists = false
+    };
+}
+
+void
+cmagic_avl_tree_free_node(cmagic_avl_tree_iterator_t iterator,
+                          const cmagic_memory_alloc_packet_t *alloc_packet) {
+    assert(iterator);
+    assert(alloc_packet);
+    assert(!((tree_node_t *)iterator)->parent);
+    alloc_packet->free_function(iterator);
+}
+
+/*
+ * Post-order teardown without recursion. Parent pointers lead back up, and a kid pointer is reset
+ * once its subtree is gone, so every node is visited at most three times.
+ */
+static void _internal_free(tree_descriptor_t *tree, cmagic_avl_tree_clear_callback_t callback,
+                           void *context) {
+    assert(tree);
+    tree_node_t *node = tree->root;
+    while (node) {
+        if (node->left_kid) {
+            node = node->left_kid;
+        } else if (node->right_kid) {
+            node = node->right_kid;
+        } else {
+            tree_node_t *parent = node->parent;
+            if (parent) {
+                if (parent->left_kid == node) {
+                    parent->left_kid = NULL;
+                } else {
+                    parent->right_kid = NULL;
+                }
+            }
+            if (callback) {
+                callback(node->key, node->value, context);
+            }
+            tree->alloc_packet->free_function(node);
+            node = parent;
+        }
+    }
+
     tree->root = NULL;
     tree->tree_size = 0;
 }
 
+void
+cmagic_avl_tree_clear_ext(void *avl_tree, cmagic_avl_tree_clear_callback_t callback,
+                          void *context) {
+    _internal_free(_get_avl_tree_descriptor(avl_tree), callback, context);
+}
+
+void
+cmagic_avl_tree_clear(void *avl_tree) {
+    _internal_free(_get_avl_tree_descriptor(avl_tree), NULL, NULL);
+}
+
+/*
+ * Builds a perfectly balanced subtree by taking the middle element as the root. Sizes of both
+ * halves differ by at most one, so the result satisfies the AVL condition. Recursion depth is
+ * logarithmic. Nodes are linked as soon as they are created, so a partially built tree can be
+ * released by regular teardown.
+ */
+static tree_node_t *_internal_build(tree_descriptor_t *tree, tree_node_t *parent,
+                                    const cmagic_avl_tree_element_t *elements, size_t count,
+                                    bool *failed) {
+    if (count == 0 || *failed) {
+        return NULL;
+    }
+
+    const size_t middle = count / 2;
+    tree_node_t *node = _new_node(tree, parent, elements[middle].key, elements[middle].value);
+    if (!node) {
+        *failed = true;
+        return NULL;
+    }
+
+    node->left_kid = _internal_build(tree, node, elements, middle, failed);
+    node->right_kid =
+        _internal_build(tree, node, &elements[middle + 1], count - middle - 1, failed);
+    _update_subtree_info(node);
+    return node;
+}
+
+bool
+cmagic_avl_tree_build(void *avl_tree, const cmagic_avl_tree_element_t *elements, size_t count) {
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    assert(!tree->root);
+    assert(elements || count == 0);
+    if (count > AVL_TREE_MAX_SIZE) {
+        return false;
+    }
+
+    bool failed = false;
+    tree->root = _internal_build(tree, NULL, elements, count, &failed);
+    if (failed) {
+        _internal_free(tree, NULL, NULL);
+        return false;
+    }
+
+    tree->tree_size = count;
+    return true;
+}
+
+/*
+ * Copies the subtree node by node in pre-order, keeping heights and sizes of the source. Like in
+ * the build, nodes are linked as soon as their elements are copied, so a partial copy can be
+ * released by regular teardown.
+ */
+static tree_node_t *_internal_clone(tree_descriptor_t *tree, tree_node_t *parent,
+                                    const tree_node_t *source,
+                                    cmagic_avl_tree_copy_callback_t copy_callback, void *context,
+                                    bool *failed) {
+    if (!source || *failed) {
+        return NULL;
+    }
+
+    tree_node_t *node = (tree_node_t *)tree->alloc_packet->malloc_function(sizeof(tree_node_t));
+    if (!node) {
+        *failed = true;
+        return NULL;
+    }
+
+    cmagic_avl_tree_element_t element = { .key = source->key, .value = source->value };
+    if (!copy_callback(&element, context)) {
+        tree->alloc_packet->free_function(node);
+        *failed = true;
+        return NULL;
+    }
+
+    *node = (tree_node_t) {
+        .key = element.key,
+        .value = element.value,
+        .parent = parent,
+        .left_kid = NULL,
+        .right_kid = NULL,
+        .subtree_height = source->subtree_height,
+        .subtree_size = source->subtree_size
+    };
+    node->left_kid =
+        _internal_clone(tree, node, source->left_kid, copy_callback, context, failed);
+    node->right_kid =
+        _internal_clone(tree, node, source->right_kid, copy_callback, context, failed);
+    return node;
+}
+
+void *
+cmagic_avl_tree_clone(void *avl_tree, cmagic_avl_tree_copy_callback_t copy_callback,
+                      cmagic_avl_tree_clear_callback_t clear_callback, void *context) {
+    tree_descriptor_t *source = _get_avl_tree_descriptor(avl_tree);
+    assert(copy_callback);
+    assert(clear_callback);
+    tree_descriptor_t *tree =
+        (tree_descriptor_t *)cmagic_avl_tree_new(source->key_comparator, source->alloc_packet);
+    if (!tree) {
+        return NULL;
+    }
+
+    bool failed = false;
+    tree->root = _internal_clone(tree, NULL, source->root, copy_callback, context, &failed);
+    if (failed) {
+        _internal_free(tree, clear_callback, context);
+        cmagic_avl_tree_free(tree);
+        return NULL;
+    }
+
+    tree->tree_size = source->tree_size;
+    return (void *)tree;
+}
+
+/*
+ * Joins two subtrees, all keys of which respectively go before and after the pivot key, into a
+ * single tree and returns its root. The pivot is hung on the spine of the higher subtree where the
+ * heights match, then the path up to the root is rebalanced, so the cost is proportional to the
+ * difference of the heights.
+ */
+static tree_node_t *_join(tree_node_t *left, tree_node_t *pivot, tree_node_t *right) {
+    assert(pivot);
+    if (left) {
+        left->parent = NULL;
+    }
+    if (right) {
+        right->parent = NULL;
+    }
+
+    tree_node_t *root = NULL;
+    tree_node_t *parent = NULL;
+    bool attach_as_right_kid = true;
+    if (_get_height(left) > _get_height(right) + 1) {
+        root = left;
+        while (_get_height(left) > _get_height(right) + 1) {
+            parent = left;
+            left = left->right_kid;
+        }
+    } else if (_get_height(right) > _get_height(left) + 1) {
+        root = right;
+        attach_as_right_kid = false;
+        while (_get_height(right) > _get_height(left) + 1) {
+            parent = right;
+            right = right->left_kid;
+        }
+    }
+
+    pivot->left_kid = left;
+    pivot->right_kid = right;
+    pivot->parent = parent;
+    if (left) {
+        left->parent = pivot;
+    }
+    if (right) {
+        right->parent = pivot;
+    }
+    _update_subtree_info(pivot);
+
+    if (!parent) {
+        return pivot;
+    }
+
+    if (attach_as_right_kid) {
+        parent->right_kid = pivot;
+    } else {
+        parent->left_kid = pivot;
+    }
+    _rebalance_path(&root, parent);
+    return root;
+}
+
+/*
+ * Splits a subtree into the nodes going before the key and the remaining ones. Every level of the
+ * recursion joins the node with one of its subtrees. The heights of the joined trees grow along
+ * the way, so the total cost of all joins is logarithmic.
+ */
+static void _split(tree_node_t *node, const void *key, cmagic_avl_tree_key_comparator_t comparator,
+                   tree_node_t **left, tree_node_t **right) {
+    if (!node) {
+        *left = *right = NULL;
+        return;
+    }
+
+    tree_node_t *left_kid = node->left_kid;
+    tree_node_t *right_kid = node->right_kid;
+    if (comparator(key, node->key) <= 0) {
+        tree_node_t *middle;
+        _split(left_kid, key, comparator, left, &middle);
+        *right = _join(middle, node, right_kid);
+    } else {
+        tree_node_t *middle;
+        _split(right_kid, key, comparator, &middle, right);
+        *left = _join(left_kid, node, middle);
+    }
+}
+
+bool
+cmagic_avl_tree_split(void *avl_tree, const void *key, void *right_avl_tree) {
+    assert(key);
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    tree_descriptor_t *right_tree = _get_avl_tree_descriptor(right_avl_tree);
+    assert(!right_tree->root);
+
+    _split(tree->root, key, tree->key_comparator, &tree->root, &right_tree->root);
+    tree->tree_size = _get_size(tree->root);
+    right_tree->tree_size = _get_size(right_tree->root);
+    return true;
+}
+
+bool
+cmagic_avl_tree_join(void *avl_tree, void *right_avl_tree) {
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    tree_descriptor_t *right_tree = _get_avl_tree_descriptor(right_avl_tree);
+    if (!right_tree->root) {
+        return true;
+    }
+    if (right_tree->tree_size > AVL_TREE_MAX_SIZE - tree->tree_size) {
+        return false;
+    }
+
+    // The smallest node of the right tree becomes the pivot
+    tree_node_t *pivot = right_tree->root;
+    while (pivot->left_kid) {
+        pivot = pivot->left_kid;
+    }
+    assert(!tree->root ||
+           tree->key_comparator(cmagic_avl_tree_last(avl_tree)->key, pivot->key) < 0);
+
+    if (pivot->right_kid) {
+        pivot->right_kid->parent = pivot->parent;
+    }
+    *_get_node_ptr(&right_tree->root, pivot) = pivot->right_kid;
+    _rebalance_path(&right_tree->root, pivot->parent);
+
+    tree->root = _join(tree->root, pivot, right_tree->root);
+    tree->tree_size += right_tree->tree_size;
+    right_tree->root = NULL;
+    right_tree->tree_size = 0;
+    return true;
+}
+
 size_t
 cmagic_avl_tree_size(void *avl_tree) {
     tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
@@ -367,7 +771,7 @@ cmagic_avl_tree_size(void *avl_tree) {
 void
 cmagic_avl_tree_free(void *avl_tree) {
     tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
-    _internal_free(tree, tree->root);
+    _internal_free(tree, NULL, NULL);
     tree->alloc_packet->free_function(tree);
 }
 
@@ -450,7 +854,206 @@ cmagic_avl_tree_find(void *avl_tree, const void *key) {
     return *result.node_ptr ? (cmagic_avl_tree_iterator_t)*result.node_ptr : NULL;
 }
 
+/*
+ * Number of lookups advanced in lock-step. It should be large enough to cover the memory latency,
+ * but not exceed the number of outstanding cache misses the processor can track.
+ */
+#define FIND_BATCH_WIDTH 8
+
+/*
+ * Every round first prefetches the keys of the current nodes of all lookups and then compares them,
+ * descends and prefetches the next nodes. The memory accesses of independent lookups overlap
+ * instead of waiting for each other.
+ */
+void
+cmagic_avl_tree_find_batch(void *avl_tree, const void *keys, size_t key_size, size_t count,
+                           cmagic_avl_tree_iterator_t *results) {
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    assert(keys || count == 0);
+    assert(results || count == 0);
+    const char *key_bytes = (const char *)keys;
+
+    for (size_t batch_start = 0; batch_start < count; batch_start += FIND_BATCH_WIDTH) {
+        const size_t width = CMAGIC_UTILS_MIN((size_t)FIND_BATCH_WIDTH, count - batch_start);
+        tree_node_t *nodes[FIND_BATCH_WIDTH];
+        for (size_t i = 0; i < width; i++) {
+            nodes[i] = tree->root;
+            results[batch_start + i] = NULL;
+        }
+
+        size_t active = tree->root ? width : 0;
+        while (active > 0) {
+            for (size_t i = 0; i < width; i++) {
+                if (nodes[i]) {
+                    CMAGIC_UTILS_PREFETCH(nodes[i]->key);
+                }
+            }
+
+            active = 0;
+            for (size_t i = 0; i < width; i++) {
+                tree_node_t *node = nodes[i];
+                if (!node) {
+                    continue;
+                }
+
+                int comparison_result =
+                    tree->key_comparator(key_bytes + (batch_start + i) * key_size, node->key);
+                if (comparison_result == 0) {
+                    results[batch_start + i] = (cmagic_avl_tree_iterator_t)node;
+                    node = NULL;
+                } else {
+                    node = comparison_result < 0 ? node->left_kid : node->right_kid;
+                }
+
+                if (node) {
+                    CMAGIC_UTILS_PREFETCH(node);
+                    active++;
+                }
+                nodes[i] = node;
+            }
+        }
+    }
+}
+
+typedef enum {
+    BOUND_LOWER,
+    BOUND_UPPER
+} bound_kind_t;
+
+static inline tree_node_t *_bound_with(tree_descriptor_t *tree, const void *key, bound_kind_t kind,
+                                       cmagic_avl_tree_key_comparator_t key_comparator) {
+    tree_node_t *node = tree->root;
+    tree_node_t *candidate = NULL;
+
+    while (node) {
+        int comparison_result = key_comparator(key, node->key);
+        if (comparison_result < 0 || (comparison_result == 0 && kind == BOUND_LOWER)) {
+            candidate = node;
+            node = node->left_kid;
+        } else {
+            node = node->right_kid;
+        }
+    }
+
+    return candidate;
+}
+
+static tree_node_t *_internal_bound(tree_descriptor_t *tree, const void *key,
+                                   cmagic_avl_tree_key_comparator_t key_comparator,
+                                   bound_kind_t kind) {
+    assert(tree);
+    assert(key);
+    return CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(_bound_with, key_comparator, tree, key, kind);
+}
+
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_lower_bound(void *avl_tree, const void *key) {
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    return (cmagic_avl_tree_iterator_t)
+        _internal_bound(tree, key, tree->key_comparator, BOUND_LOWER);
+}
+
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_upper_bound(void *avl_tree, const void *key) {
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    return (cmagic_avl_tree_iterator_t)
+        _internal_bound(tree, key, tree->key_comparator, BOUND_UPPER);
+}
+
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_lower_bound_by(void *avl_tree, const void *key,
+                               cmagic_avl_tree_key_comparator_t key_comparator) {
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    return (cmagic_avl_tree_iterator_t)_internal_bound(tree, key, key_comparator, BOUND_LOWER);
+}
+
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_upper_bound_by(void *avl_tree, const void *key,
+                               cmagic_avl_tree_key_comparator_t key_comparator) {
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    return (cmagic_avl_tree_iterator_t)_internal_bound(tree, key, key_comparator, BOUND_UPPER);
+}
+
+// Number of elements going before the bound, counted from the sizes of the skipped left subtrees
+static inline size_t _rank_with(tree_descriptor_t *tree, const void *key, bound_kind_t kind,
+                                cmagic_avl_tree_key_comparator_t key_comparator) {
+    tree_node_t *node = tree->root;
+    size_t rank = 0;
+
+    while (node) {
+        int comparison_result = key_comparator(key, node->key);
+        if (comparison_result < 0 || (comparison_result == 0 && kind == BOUND_LOWER)) {
+            node = node->left_kid;
+        } else {
+            rank += _get_size(node->left_kid) + 1;
+            node = node->right_kid;
+        }
+    }
+
+    return rank;
+}
+
+size_t
+cmagic_avl_tree_count(void *avl_tree, const void *key) {
+    assert(key);
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    return CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(_rank_with, tree->key_comparator, tree, key,
+                                                   BOUND_UPPER)
+           - CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(_rank_with, tree->key_comparator, tree, key,
+                                                     BOUND_LOWER);
+}
+
+cmagic_avl_tree_range_t
+cmagic_avl_tree_equal_range(void *avl_tree, const void *key) {
+    tree_descriptor_t *tree = _get_avl_tree_descriptor(avl_tree);
+    tree_node_t *lower = _internal_bound(tree, key, tree->key_comparator, BOUND_LOWER);
+
+    // Keys are unique, so the range holds at most one element
+    cmagic_avl_tree_iterator_t upper = (cmagic_avl_tree_iterator_t)lower;
+    if (lower && tree->key_comparator(key, lower->key) == 0) {
+        upper = cmagic_avl_tree_iterator_next(upper);
+    }
+
+    return (cmagic_avl_tree_range_t) {
+        .begin = (cmagic_avl_tree_iterator_t)lower,
+        .end = upper
+    };
+}
+
 const cmagic_memory_alloc_packet_t *
 cmagic_avl_tree_get_alloc_packet(void *avl_tree) {
     return _get_avl_tree_descriptor(avl_tree)->alloc_packet;
 }
+
+// Keys are compared only through the pointers to them, so their size is not needed
+static void *_new_engine_tree(cmagic_tree_key_comparator_t key_comparator, size_t key_size,
+                              const cmagic_memory_alloc_packet_t *alloc_packet) {
+    (void)key_size;
+    return cmagic_avl_tree_new(key_comparator, alloc_packet);
+}
+
+const cmagic_tree_engine_t CMAGIC_TREE_ENGINE_AVL_TREE = {
+    .new_function = _new_engine_tree,
+    .free_function = cmagic_avl_tree_free,
+    .insert_function = cmagic_avl_tree_insert,
+    .replace_key_function = cmagic_avl_tree_replace_key,
+    .erase_function = cmagic_avl_tree_erase,
+    .clear_function = cmagic_avl_tree_clear_ext,
+    .build_function = cmagic_avl_tree_build,
+    .split_function = cmagic_avl_tree_split,
+    .join_function = cmagic_avl_tree_join,
+    .clone_function = cmagic_avl_tree_clone,
+    .extract_function = cmagic_avl_tree_extract,
+    .insert_node_function = cmagic_avl_tree_insert_node,
+    .find_batch_function = cmagic_avl_tree_find_batch,
+    .size_function = cmagic_avl_tree_size,
+    .first_function = cmagic_avl_tree_first,
+    .last_function = cmagic_avl_tree_last,
+    .find_function = cmagic_avl_tree_find,
+    .lower_bound_function = cmagic_avl_tree_lower_bound,
+    .upper_bound_function = cmagic_avl_tree_upper_bound,
+    .lower_bound_by_function = cmagic_avl_tree_lower_bound_by,
+    .upper_bound_by_function = cmagic_avl_tree_upper_bound_by,
+    .equal_range_function = cmagic_avl_tree_equal_range,
+    .get_alloc_packet_function = cmagic_avl_tree_get_alloc_packet
+};
@@ -5,12 +5,13 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "cmagic/memory.h"
+#include "tree_engine.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-typedef int (*cmagic_avl_tree_key_comparator_t)(const void *key1, const void *key2);
+typedef cmagic_tree_key_comparator_t cmagic_avl_tree_key_comparator_t;
 
 void *
 cmagic_avl_tree_new(cmagic_avl_tree_key_comparator_t key_comparator,
@@ -19,25 +20,76 @@ cmagic_avl_tree_new(cmagic_avl_tree_key_comparator_t key_comparator,
 void
 cmagic_avl_tree_free(void *avl_tree);
 
-typedef struct {
-    const void *key;
-    void *value;
-} *cmagic_avl_tree_iterator_t;
+typedef cmagic_tree_iterator_t cmagic_avl_tree_iterator_t;
 
-typedef struct {
-    cmagic_avl_tree_iterator_t inserted_or_existing;
-    bool already_exists;
-} cmagic_avl_tree_insert_result_t;
+typedef cmagic_tree_insert_result_t cmagic_avl_tree_insert_result_t;
 
 cmagic_avl_tree_insert_result_t
 cmagic_avl_tree_insert(void *avl_tree, const void *key, void *value);
 
+/*
+ * Inserts the element even if equivalent keys already exist, right after all of them. Returns NULL
+ * if the allocation has failed.
+ */
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_insert_equal(void *avl_tree, const void *key, void *value);
+
+void
+cmagic_avl_tree_replace_key(void *avl_tree, cmagic_avl_tree_iterator_t iterator,
+                            const void *new_key);
+
 void
 cmagic_avl_tree_erase(void *avl_tree, const void *key);
 
+// Removes the element the iterator points to, iterators to other elements stay valid
+void
+cmagic_avl_tree_erase_iterator(void *avl_tree, cmagic_avl_tree_iterator_t iterator);
+
+/*
+ * Detaches the element from the tree without freeing it. The detached node keeps its key and value
+ * and can be inserted into another tree using the same memory allocation functions.
+ */
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_extract(void *avl_tree, const void *key);
+
+cmagic_avl_tree_insert_result_t
+cmagic_avl_tree_insert_node(void *avl_tree, cmagic_avl_tree_iterator_t iterator);
+
+void
+cmagic_avl_tree_free_node(cmagic_avl_tree_iterator_t iterator,
+                          const cmagic_memory_alloc_packet_t *alloc_packet);
+
+typedef cmagic_tree_clear_callback_t cmagic_avl_tree_clear_callback_t;
+
+void
+cmagic_avl_tree_clear_ext(void *avl_tree, cmagic_avl_tree_clear_callback_t callback,
+                          void *context);
+
 void
 cmagic_avl_tree_clear(void *avl_tree);
 
+typedef cmagic_tree_element_t cmagic_avl_tree_element_t;
+
+bool
+cmagic_avl_tree_build(void *avl_tree, const cmagic_avl_tree_element_t *elements, size_t count);
+
+typedef cmagic_tree_copy_callback_t cmagic_avl_tree_copy_callback_t;
+
+/*
+ * Creates a tree of the same shape with copies of the elements made by the copy callback. Neither
+ * comparisons nor rotations are made. On failure the copies made so far are passed to the clear
+ * callback and NULL is returned.
+ */
+void *
+cmagic_avl_tree_clone(void *avl_tree, cmagic_avl_tree_copy_callback_t copy_callback,
+                      cmagic_avl_tree_clear_callback_t clear_callback, void *context);
+
+bool
+cmagic_avl_tree_split(void *avl_tree, const void *key, void *right_avl_tree);
+
+bool
+cmagic_avl_tree_join(void *avl_tree, void *right_avl_tree);
+
 size_t
 cmagic_avl_tree_size(void *avl_tree);
 
@@ -56,6 +108,35 @@ cmagic_avl_tree_iterator_prev(cmagic_avl_tree_iterator_t iterator);
 cmagic_avl_tree_iterator_t
 cmagic_avl_tree_find(void *avl_tree, const void *key);
 
+// Looks up count keys stored contiguously, key_size bytes each
+void
+cmagic_avl_tree_find_batch(void *avl_tree, const void *keys, size_t key_size, size_t count,
+                           cmagic_avl_tree_iterator_t *results);
+
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_lower_bound(void *avl_tree, const void *key);
+
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_upper_bound(void *avl_tree, const void *key);
+
+typedef cmagic_tree_range_t cmagic_avl_tree_range_t;
+
+// Same as the bounds above, but compare the key using the given comparator instead of the tree one
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_lower_bound_by(void *avl_tree, const void *key,
+                               cmagic_avl_tree_key_comparator_t key_comparator);
+
+cmagic_avl_tree_iterator_t
+cmagic_avl_tree_upper_bound_by(void *avl_tree, const void *key,
+                               cmagic_avl_tree_key_comparator_t key_comparator);
+
+cmagic_avl_tree_range_t
+cmagic_avl_tree_equal_range(void *avl_tree, const void *key);
+
+// Counts the elements equivalent to the key in logarithmic time, using the subtree sizes
+size_t
+cmagic_avl_tree_count(void *avl_tree, const void *key);
+
 const cmagic_memory_alloc_packet_t *
 cmagic_avl_tree_get_alloc_packet(void *avl_tree);
 
@@ -92,6 +173,18 @@ cmagic_avl_tree_get_alloc_packet(void *avl_tree);
 #define CMAGIC_AVL_TREE_FIND(avl_tree, key) (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(avl_tree), *(key)), \
     cmagic_avl_tree_find((void*)(avl_tree), (key)))
 
+#define CMAGIC_AVL_TREE_LOWER_BOUND(avl_tree, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(avl_tree), *(key)), \
+    cmagic_avl_tree_lower_bound((void*)(avl_tree), (key)))
+
+#define CMAGIC_AVL_TREE_UPPER_BOUND(avl_tree, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(avl_tree), *(key)), \
+    cmagic_avl_tree_upper_bound((void*)(avl_tree), (key)))
+
+#define CMAGIC_AVL_TREE_EQUAL_RANGE(avl_tree, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(avl_tree), *(key)), \
+    cmagic_avl_tree_equal_range((void*)(avl_tree), (key)))
+
 #define CMAGIC_AVL_TREE_GET_ALLOC_PACKET(avl_tree) \
     cmagic_avl_tree_get_alloc_packet((void*)(avl_tree))
 
@@ -0,0 +1,1023 @@
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "cmagic/utils.h"
+#include "b_tree.h"
+
+#ifndef NDEBUG
+static const int_least32_t B_TREE_MAGIC_VALUE = 'B' << 24 | 'T' << 16 | 'R' << 8 | 'E';
+#endif
+
+#define B_TREE_CACHE_LINE_SIZE 64
+#define B_TREE_INTERNAL_NODE_SIZE (4 * B_TREE_CACHE_LINE_SIZE)
+#define B_TREE_LEAF_NODE_SIZE (8 * B_TREE_CACHE_LINE_SIZE)
+// Nodes grow beyond their size for large keys, so that every node holds at least a few keys
+#define B_TREE_MIN_NODE_CAPACITY 4
+#define B_TREE_MAX_LEVELS 32
+// Keys are copied into the nodes at a multiple of their size from a maximally aligned offset
+#define B_TREE_KEY_ALIGNMENT _Alignof(max_align_t)
+
+typedef struct node_header {
+    struct internal_node *parent;
+    size_t count; // number of keys in internal node, number of elements in leaf node
+    bool is_leaf;
+} node_header_t;
+
+/*
+ * Followed by the separator keys. Every key in the subtree of kids[i] goes before keys[i] and no
+ * key in the subtree of kids[i + 1] goes before it.
+ */
+typedef struct internal_node {
+    node_header_t header;
+    node_header_t *kids[];
+} internal_node_t;
+
+// Allocated separately, so that it never moves and iterators pointing to it stay valid
+typedef struct {
+    const void *key;
+    void *value;
+    uintptr_t tagged_leaf; // owning leaf with CMAGIC_TREE_ENGINE_TAG_B_TREE in the lowest bits
+    size_t index; // position in the owning leaf, so iterators are advanced without any search
+} element_t;
+
+// Followed by copies of the keys of the elements, which are searched without leaving the node
+typedef struct leaf_node {
+    node_header_t header;
+    struct leaf_node *prev;
+    struct leaf_node *next;
+    element_t *elements[];
+} leaf_node_t;
+
+typedef struct {
+#ifndef NDEBUG
+    int_least32_t magic_value;
+#endif
+    cmagic_b_tree_key_comparator_t key_comparator;
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+    size_t tree_size;
+    node_header_t *root;
+    leaf_node_t *first_leaf;
+    leaf_node_t *last_leaf;
+    size_t key_size;
+    size_t leaf_capacity;
+    size_t leaf_keys_offset;
+    size_t leaf_node_size;
+    size_t internal_capacity; // maximum number of keys in internal node
+    size_t internal_keys_offset;
+    size_t internal_node_size;
+} tree_descriptor_t;
+
+static size_t _align_key_offset(size_t offset) {
+    return CMAGIC_UTILS_DIV_CEIL(offset, B_TREE_KEY_ALIGNMENT) * B_TREE_KEY_ALIGNMENT;
+}
+
+// Number of keys fitting into the node together with one pointer per key
+static size_t _get_node_capacity(size_t node_size, size_t fixed_size, size_t key_size) {
+    const size_t reserved = fixed_size + B_TREE_KEY_ALIGNMENT - 1;
+    const size_t capacity = (node_size - reserved) / (sizeof(void *) + key_size);
+    return capacity < B_TREE_MIN_NODE_CAPACITY ? B_TREE_MIN_NODE_CAPACITY : capacity;
+}
+
+void *
+cmagic_b_tree_new(cmagic_b_tree_key_comparator_t key_comparator, size_t key_size,
+                  const cmagic_memory_alloc_packet_t *alloc_packet) {
+    assert(key_comparator);
+    assert(key_size > 0);
+    assert(alloc_packet);
+
+    tree_descriptor_t *tree_descriptor =
+        (tree_descriptor_t *) alloc_packet->malloc_function(sizeof(tree_descriptor_t));
+    if (!tree_descriptor) {
+        return NULL;
+    }
+
+    const size_t leaf_capacity =
+        _get_node_capacity(B_TREE_LEAF_NODE_SIZE, sizeof(leaf_node_t), key_size);
+    const size_t leaf_keys_offset =
+        _align_key_offset(sizeof(leaf_node_t) + leaf_capacity * sizeof(element_t *));
+    // An internal node has one kid more than keys
+    const size_t internal_capacity = _get_node_capacity(
+        B_TREE_INTERNAL_NODE_SIZE, sizeof(internal_node_t) + sizeof(node_header_t *), key_size);
+    const size_t internal_keys_offset = _align_key_offset(
+        sizeof(internal_node_t) + (internal_capacity + 1) * sizeof(node_header_t *));
+
+    *tree_descriptor = (tree_descriptor_t) {
+#ifndef NDEBUG
+        .magic_value = B_TREE_MAGIC_VALUE,
+#endif
+        .key_comparator = key_comparator,
+        .alloc_packet = alloc_packet,
+        .tree_size = 0,
+        .root = NULL,
+        .first_leaf = NULL,
+        .last_leaf = NULL,
+        .key_size = key_size,
+        .leaf_capacity = leaf_capacity,
+        .leaf_keys_offset = leaf_keys_offset,
+        .leaf_node_size = leaf_keys_offset + leaf_capacity * key_size,
+        .internal_capacity = internal_capacity,
+        .internal_keys_offset = internal_keys_offset,
+        .internal_node_size = internal_keys_offset + internal_capacity * key_size
+    };
+
+    return (void *)tree_descriptor;
+}
+
+static tree_descriptor_t *_get_b_tree_descriptor(void *tree_ptr) {
+    assert(tree_ptr);
+    tree_descriptor_t *result = (tree_descriptor_t *)tree_ptr;
+    assert(result->magic_value == B_TREE_MAGIC_VALUE);
+    return result;
+}
+
+static leaf_node_t *_as_leaf(node_header_t *node) {
+    assert(node && node->is_leaf);
+    return (leaf_node_t *)node;
+}
+
+static internal_node_t *_as_internal(node_header_t *node) {
+    assert(node && !node->is_leaf);
+    return (internal_node_t *)node;
+}
+
+static inline void *_get_leaf_key(const tree_descriptor_t *tree, const leaf_node_t *leaf,
+                                  size_t index) {
+    return (char *)leaf + tree->leaf_keys_offset + index * tree->key_size;
+}
+
+static inline void *_get_internal_key(const tree_descriptor_t *tree,
+                                      const internal_node_t *internal, size_t index) {
+    return (char *)internal + tree->internal_keys_offset + index * tree->key_size;
+}
+
+static leaf_node_t *_get_element_leaf(const element_t *element) {
+    assert((element->tagged_leaf & CMAGIC_TREE_ENGINE_TAG_MASK) == CMAGIC_TREE_ENGINE_TAG_B_TREE);
+    return (leaf_node_t *)(element->tagged_leaf & ~CMAGIC_TREE_ENGINE_TAG_MASK);
+}
+
+static size_t _get_kid_position(const internal_node_t *parent, const node_header_t *kid) {
+    for (size_t i = 0; i <= parent->header.count; i++) {
+        if (parent->kids[i] == kid) {
+            return i;
+        }
+    }
+
+    assert(false);
+    return 0;
+}
+
+static const void *_get_min_key(const tree_descriptor_t *tree, node_header_t *node) {
+    while (!node->is_leaf) {
+        node = _as_internal(node)->kids[0];
+    }
+
+    assert(node->count > 0);
+    return _get_leaf_key(tree, _as_leaf(node), 0);
+}
+
+static inline leaf_node_t *_find_leaf(tree_descriptor_t *tree, const void *key,
+                                      cmagic_b_tree_key_comparator_t key_comparator) {
+    assert(tree->root);
+    node_header_t *node = tree->root;
+    while (!node->is_leaf) {
+        internal_node_t *internal = _as_internal(node);
+        size_t low = 0;
+        size_t high = internal->header.count;
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (key_comparator(key, _get_internal_key(tree, internal, middle)) < 0) {
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        node = internal->kids[low];
+    }
+
+    return _as_leaf(node);
+}
+
+typedef enum {
+    BOUND_LOWER,
+    BOUND_UPPER
+} bound_kind_t;
+
+static inline size_t _find_in_leaf(const tree_descriptor_t *tree, const leaf_node_t *leaf,
+                                   const void *key, cmagic_b_tree_key_comparator_t key_comparator,
+                                   bound_kind_t kind) {
+    size_t low = 0;
+    size_t high = leaf->header.count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int comparison_result = key_comparator(key, _get_leaf_key(tree, leaf, middle));
+        if (comparison_result < 0 || (comparison_result == 0 && kind == BOUND_LOWER)) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+
+    return low;
+}
+
+typedef struct {
+    leaf_node_t *leaf;
+    size_t index;
+} position_t;
+
+static inline position_t _locate_with(tree_descriptor_t *tree, const void *key, bound_kind_t kind,
+                                      cmagic_b_tree_key_comparator_t key_comparator) {
+    leaf_node_t *leaf = _find_leaf(tree, key, key_comparator);
+    return (position_t) { leaf, _find_in_leaf(tree, leaf, key, key_comparator, kind) };
+}
+
+// Finds the leaf and the position in it where the bound of the key would be
+static position_t _locate(tree_descriptor_t *tree, const void *key,
+                          cmagic_b_tree_key_comparator_t key_comparator, bound_kind_t kind) {
+    assert(tree->root);
+    return CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(_locate_with, key_comparator, tree, key, kind);
+}
+
+static bool _is_key_at(tree_descriptor_t *tree, position_t position, const void *key) {
+    return position.index < position.leaf->header.count
+        && tree->key_comparator(key, _get_leaf_key(tree, position.leaf, position.index)) == 0;
+}
+
+static cmagic_b_tree_iterator_t _element_or_next(leaf_node_t *leaf, size_t index) {
+    if (index < leaf->header.count) {
+        return (cmagic_b_tree_iterator_t)leaf->elements[index];
+    }
+
+    return leaf->next ? (cmagic_b_tree_iterator_t)leaf->next->elements[0] : NULL;
+}
+
+static leaf_node_t *_new_leaf(tree_descriptor_t *tree) {
+    leaf_node_t *leaf = (leaf_node_t *)tree->alloc_packet->malloc_function(tree->leaf_node_size);
+    if (!leaf) {
+        return NULL;
+    }
+
+    leaf->header = (node_header_t) { .parent = NULL, .count = 0, .is_leaf = true };
+    leaf->prev = NULL;
+    leaf->next = NULL;
+    return leaf;
+}
+
+static internal_node_t *_new_internal(tree_descriptor_t *tree) {
+    internal_node_t *internal =
+        (internal_node_t *)tree->alloc_packet->malloc_function(tree->internal_node_size);
+    if (!internal) {
+        return NULL;
+    }
+
+    internal->header = (node_header_t) { .parent = NULL, .count = 0, .is_leaf = false };
+    return internal;
+}
+
+static void _set_element_position(element_t *element, leaf_node_t *leaf, size_t index) {
+    element->tagged_leaf = (uintptr_t)leaf | CMAGIC_TREE_ENGINE_TAG_B_TREE;
+    element->index = index;
+}
+
+// Moves the elements together with their keys, the ranges may overlap if both leaves are the same
+static void _move_elements(const tree_descriptor_t *tree, leaf_node_t *destination,
+                           size_t destination_index, leaf_node_t *source, size_t source_index,
+                           size_t count) {
+    memmove(&destination->elements[destination_index], &source->elements[source_index],
+            count * sizeof(destination->elements[0]));
+    memmove(_get_leaf_key(tree, destination, destination_index),
+            _get_leaf_key(tree, source, source_index), count * tree->key_size);
+    for (size_t i = destination_index; i < destination_index + count; i++) {
+        _set_element_position(destination->elements[i], destination, i);
+    }
+}
+
+static void _insert_into_leaf(const tree_descriptor_t *tree, leaf_node_t *leaf, size_t index,
+                              element_t *element, const void *key) {
+    assert(leaf->header.count < tree->leaf_capacity);
+    _move_elements(tree, leaf, index + 1, leaf, index, leaf->header.count - index);
+    leaf->elements[index] = element;
+    memcpy(_get_leaf_key(tree, leaf, index), key, tree->key_size);
+    _set_element_position(element, leaf, index);
+    leaf->header.count++;
+}
+
+static void _adopt_kids(internal_node_t *parent, size_t first_kid, size_t kids_count) {
+    for (size_t i = first_kid; i < first_kid + kids_count; i++) {
+        parent->kids[i]->parent = parent;
+    }
+}
+
+static void _insert_into_internal(const tree_descriptor_t *tree, internal_node_t *node,
+                                  size_t position, const void *key, node_header_t *right_kid) {
+    assert(node->header.count < tree->internal_capacity);
+    memmove(_get_internal_key(tree, node, position + 1), _get_internal_key(tree, node, position),
+            (node->header.count - position) * tree->key_size);
+    memmove(&node->kids[position + 2], &node->kids[position + 1],
+            (node->header.count - position) * sizeof(node->kids[0]));
+    memcpy(_get_internal_key(tree, node, position), key, tree->key_size);
+    node->kids[position + 1] = right_kid;
+    right_kid->parent = node;
+    node->header.count++;
+}
+
+/*
+ * Nodes needed by an insertion into a full leaf: a sibling of the leaf, a sibling of every full
+ * ancestor and a new root if all of them are full. They are allocated before any node is split, so
+ * on allocation failure the tree stays untouched.
+ */
+typedef struct {
+    leaf_node_t *leaf;
+    internal_node_t *internals[B_TREE_MAX_LEVELS];
+    size_t internal_count;
+} spare_nodes_t;
+
+static bool _allocate_spare_nodes(tree_descriptor_t *tree, const leaf_node_t *full_leaf,
+                                  spare_nodes_t *spare) {
+    size_t needed = 0;
+    const internal_node_t *node = full_leaf->header.parent;
+    while (node && node->header.count == tree->internal_capacity) {
+        needed++;
+        node = node->header.parent;
+    }
+    if (!node) {
+        needed++;
+    }
+    assert(needed <= B_TREE_MAX_LEVELS);
+
+    spare->internal_count = 0;
+    spare->leaf = _new_leaf(tree);
+    if (!spare->leaf) {
+        return false;
+    }
+
+    while (spare->internal_count < needed) {
+        internal_node_t *internal = _new_internal(tree);
+        if (!internal) {
+            while (spare->internal_count > 0) {
+                tree->alloc_packet->free_function(spare->internals[--spare->internal_count]);
+            }
+            tree->alloc_packet->free_function(spare->leaf);
+            return false;
+        }
+        spare->internals[spare->internal_count++] = internal;
+    }
+
+    return true;
+}
+
+static internal_node_t *_take_spare_internal(spare_nodes_t *spare) {
+    assert(spare->internal_count > 0);
+    return spare->internals[--spare->internal_count];
+}
+
+// Links a new right sibling of the left node into the parent, splitting the full ancestors
+static void _insert_into_parent(tree_descriptor_t *tree, node_header_t *left, const void *key,
+                                node_header_t *right, spare_nodes_t *spare) {
+    internal_node_t *parent = left->parent;
+    if (!parent) {
+        internal_node_t *new_root = _take_spare_internal(spare);
+        new_root->header.count = 1;
+        memcpy(_get_internal_key(tree, new_root, 0), key, tree->key_size);
+        new_root->kids[0] = left;
+        new_root->kids[1] = right;
+        _adopt_kids(new_root, 0, 2);
+        tree->root = &new_root->header;
+        return;
+    }
+
+    size_t position = _get_kid_position(parent, left);
+    if (parent->header.count < tree->internal_capacity) {
+        _insert_into_internal(tree, parent, position, key, right);
+        return;
+    }
+
+    /*
+     * The keys are split as if the new key was already inserted. The key in the middle goes up to
+     * the grandparent, meanwhile it's kept in the first unused key slot of the parent.
+     */
+    internal_node_t *sibling = _take_spare_internal(spare);
+    const size_t capacity = tree->internal_capacity;
+    const size_t left_keys = (capacity + 1) / 2;
+    void *middle_key = _get_internal_key(tree, parent, left_keys);
+    if (position < left_keys) {
+        sibling->header.count = capacity - left_keys;
+        memcpy(_get_internal_key(tree, sibling, 0), middle_key,
+               sibling->header.count * tree->key_size);
+        memcpy(sibling->kids, &parent->kids[left_keys],
+               (sibling->header.count + 1) * sizeof(sibling->kids[0]));
+        memcpy(middle_key, _get_internal_key(tree, parent, left_keys - 1), tree->key_size);
+        parent->header.count = left_keys - 1;
+        _insert_into_internal(tree, parent, position, key, right);
+    } else if (position == left_keys) {
+        sibling->header.count = capacity - left_keys;
+        memcpy(_get_internal_key(tree, sibling, 0), middle_key,
+               sibling->header.count * tree->key_size);
+        sibling->kids[0] = right;
+        memcpy(&sibling->kids[1], &parent->kids[left_keys + 1],
+               sibling->header.count * sizeof(sibling->kids[0]));
+        memcpy(middle_key, key, tree->key_size);
+        parent->header.count = left_keys;
+    } else {
+        sibling->header.count = capacity - left_keys - 1;
+        memcpy(_get_internal_key(tree, sibling, 0), _get_internal_key(tree, parent, left_keys + 1),
+               sibling->header.count * tree->key_size);
+        memcpy(sibling->kids, &parent->kids[left_keys + 1],
+               (sibling->header.count + 1) * sizeof(sibling->kids[0]));
+        parent->header.count = left_keys;
+        _insert_into_internal(tree, sibling, position - left_keys - 1, key, right);
+    }
+    _adopt_kids(sibling, 0, sibling->header.count + 1);
+
+    _insert_into_parent(tree, &parent->header, middle_key, &sibling->header, spare);
+}
+
+static void _split_leaf_and_insert(tree_descriptor_t *tree, leaf_node_t *leaf, size_t index,
+                                   element_t *element, const void *key, spare_nodes_t *spare) {
+    assert(leaf->header.count == tree->leaf_capacity);
+    leaf_node_t *sibling = spare->leaf;
+    spare->leaf = NULL;
+
+    // Move the upper half to the sibling, then insert into the proper half
+    const size_t left_elements = (tree->leaf_capacity + 1) / 2;
+    const bool to_sibling = index >= left_elements;
+    const size_t split_point = to_sibling ? left_elements : left_elements - 1;
+    _move_elements(tree, sibling, 0, leaf, split_point, tree->leaf_capacity - split_point);
+    sibling->header.count = tree->leaf_capacity - split_point;
+    leaf->header.count = split_point;
+    if (to_sibling) {
+        _insert_into_leaf(tree, sibling, index - split_point, element, key);
+    } else {
+        _insert_into_leaf(tree, leaf, index, element, key);
+    }
+
+    sibling->prev = leaf;
+    sibling->next = leaf->next;
+    if (leaf->next) {
+        leaf->next->prev = sibling;
+    } else {
+        tree->last_leaf = sibling;
+    }
+    leaf->next = sibling;
+
+    _insert_into_parent(tree, &leaf->header, _get_leaf_key(tree, sibling, 0), &sibling->header,
+                        spare);
+}
+
+cmagic_b_tree_insert_result_t
+cmagic_b_tree_insert(void *b_tree, const void *key, void *value) {
+    assert(key);
+    tree_descriptor_t *tree = _get_b_tree_descriptor(b_tree);
+    const cmagic_b_tree_insert_result_t failure = {
+        .inserted_or_existing = NULL,
+        .already_exists = false
+    };
+
+    position_t found = { .leaf = NULL, .index = 0 };
+    if (tree->root) {
+        found = _locate(tree, key, tree->key_comparator, BOUND_LOWER);
+        if (_is_key_at(tree, found, key)) {
+            return (cmagic_b_tree_insert_result_t) {
+                .inserted_or_existing =
+                    (cmagic_b_tree_iterator_t)found.leaf->elements[found.index],
+                .already_exists = true
+            };
+        }
+    }
+
+    element_t *element = (element_t *)tree->alloc_packet->malloc_function(sizeof(element_t));
+    if (!element) {
+        return failure;
+    }
+    *element = (element_t) { .key = key, .value = value, .tagged_leaf = 0, .index = 0 };
+
+    if (!tree->root) {
+        leaf_node_t *leaf = _new_leaf(tree);
+        if (!leaf) {
+            tree->alloc_packet->free_function(element);
+            return failure;
+        }
+        tree->root = &leaf->header;
+        tree->first_leaf = tree->last_leaf = leaf;
+        found.leaf = leaf;
+    }
+
+    if (found.leaf->header.count < tree->leaf_capacity) {
+        _insert_into_leaf(tree, found.leaf, found.index, element, key);
+    } else {
+        spare_nodes_t spare;
+        if (!_allocate_spare_nodes(tree, found.leaf, &spare)) {
+            tree->alloc_packet->free_function(element);
+            return failure;
+        }
+        _split_leaf_and_insert(tree, found.leaf, found.index, element, key, &spare);
+        assert(!spare.leaf && spare.internal_count == 0);
+    }
+
+    tree->tree_size++;
+    return (cmagic_b_tree_insert_result_t) {
+        .inserted_or_existing = (cmagic_b_tree_iterator_t)element,
+        .already_exists = false
+    };
+}
+
+void
+cmagic_b_tree_replace_key(void *b_tree, cmagic_b_tree_iterator_t iterator, const void *new_key) {
+    (void)_get_b_tree_descriptor(b_tree);
+    assert(iterator);
+    assert(new_key);
+    // The copies of the key in the nodes compare equal to the new key, so they are kept
+    ((element_t *)iterator)->key = new_key;
+}
+
+static void _remove_from_internal(const tree_descriptor_t *tree, internal_node_t *node,
+                                  size_t key_position) {
+    assert(key_position < node->header.count);
+    memmove(_get_internal_key(tree, node, key_position),
+            _get_internal_key(tree, node, key_position + 1),
+            (node->header.count - key_position - 1) * tree->key_size);
+    memmove(&node->kids[key_position + 1], &node->kids[key_position + 2],
+            (node->header.count - key_position - 1) * sizeof(node->kids[0]));
+    node->header.count--;
+}
+
+static void _rebalance_internal(tree_descriptor_t *tree, internal_node_t *node) {
+    const size_t min_keys = tree->internal_capacity / 2;
+    const size_t key_size = tree->key_size;
+    while (node) {
+        internal_node_t *parent = node->header.parent;
+        if (!parent) {
+            if (node->header.count == 0) {
+                tree->root = node->kids[0];
+                tree->root->parent = NULL;
+                tree->alloc_packet->free_function(node);
+            }
+            return;
+        }
+
+        if (node->header.count >= min_keys) {
+            return;
+        }
+
+        size_t position = _get_kid_position(parent, &node->header);
+        internal_node_t *left = position > 0 ? _as_internal(parent->kids[position - 1]) : NULL;
+        internal_node_t *right = position < parent->header.count
+            ? _as_internal(parent->kids[position + 1]) : NULL;
+
+        if (left && left->header.count > min_keys) {
+            // Rotate the last kid of the left sibling through the parent
+            memmove(_get_internal_key(tree, node, 1), _get_internal_key(tree, node, 0),
+                    node->header.count * key_size);
+            memmove(&node->kids[1], &node->kids[0],
+                    (node->header.count + 1) * sizeof(node->kids[0]));
+            memcpy(_get_internal_key(tree, node, 0),
+                   _get_internal_key(tree, parent, position - 1), key_size);
+            node->kids[0] = left->kids[left->header.count];
+            node->kids[0]->parent = node;
+            node->header.count++;
+            memcpy(_get_internal_key(tree, parent, position - 1),
+                   _get_internal_key(tree, left, left->header.count - 1), key_size);
+            left->header.count--;
+            return;
+        }
+
+        if (right && right->header.count > min_keys) {
+            // Rotate the first kid of the right sibling through the parent
+            memcpy(_get_internal_key(tree, node, node->header.count),
+                   _get_internal_key(tree, parent, position), key_size);
+            node->kids[node->header.count + 1] = right->kids[0];
+            right->kids[0]->parent = node;
+            node->header.count++;
+            memcpy(_get_internal_key(tree, parent, position), _get_internal_key(tree, right, 0),
+                   key_size);
+            memmove(_get_internal_key(tree, right, 0), _get_internal_key(tree, right, 1),
+                    (right->header.count - 1) * key_size);
+            memmove(&right->kids[0], &right->kids[1], right->header.count * sizeof(right->kids[0]));
+            right->header.count--;
+            return;
+        }
+
+        // Merge with a sibling, the separator from the parent goes down between them
+        internal_node_t *merge_left = left ? left : node;
+        internal_node_t *merge_right = left ? node : right;
+        size_t separator_position = left ? position - 1 : position;
+        assert(merge_right);
+        size_t count = merge_left->header.count;
+        assert(count + 1 + merge_right->header.count <= tree->internal_capacity);
+        memcpy(_get_internal_key(tree, merge_left, count),
+               _get_internal_key(tree, parent, separator_position), key_size);
+        memcpy(_get_internal_key(tree, merge_left, count + 1),
+               _get_internal_key(tree, merge_right, 0), merge_right->header.count * key_size);
+        memcpy(&merge_left->kids[count + 1], merge_right->kids,
+               (merge_right->header.count + 1) * sizeof(merge_right->kids[0]));
+        merge_left->header.count += 1 + merge_right->header.count;
+        _adopt_kids(merge_left, count + 1, merge_right->header.count + 1);
+        _remove_from_internal(tree, parent, separator_position);
+        tree->alloc_packet->free_function(merge_right);
+
+        node = parent;
+    }
+}
+
+static void _unlink_leaf(tree_descriptor_t *tree, leaf_node_t *leaf) {
+    if (leaf->prev) {
+        leaf->prev->next = leaf->next;
+    } else {
+        tree->first_leaf = leaf->next;
+    }
+
+    if (leaf->next) {
+        leaf->next->prev = leaf->prev;
+    } else {
+        tree->last_leaf = leaf->prev;
+    }
+}
+
+/*
+ * Separators are copies of the keys, so they stay valid when the key they were copied from is
+ * erased. Only a leaf borrowing an element from its sibling refreshes the separator between them.
+ */
+void
+cmagic_b_tree_erase(void *b_tree, const void *key) {
+    assert(key);
+    tree_descriptor_t *tree = _get_b_tree_descriptor(b_tree);
+    if (!tree->root) {
+        return;
+    }
+
+    const position_t found = _locate(tree, key, tree->key_comparator, BOUND_LOWER);
+    if (!_is_key_at(tree, found, key)) {
+        return;
+    }
+
+    leaf_node_t *leaf = found.leaf;
+    tree->alloc_packet->free_function(leaf->elements[found.index]);
+    _move_elements(tree, leaf, found.index, leaf, found.index + 1,
+                   leaf->header.count - found.index - 1);
+    leaf->header.count--;
+    tree->tree_size--;
+
+    internal_node_t *parent = leaf->header.parent;
+    if (!parent) {
+        if (leaf->header.count == 0) {
+            tree->alloc_packet->free_function(leaf);
+            tree->root = NULL;
+            tree->first_leaf = tree->last_leaf = NULL;
+        }
+        return;
+    }
+
+    const size_t min_elements = tree->leaf_capacity / 2;
+    if (leaf->header.count >= min_elements) {
+        return;
+    }
+
+    size_t position = _get_kid_position(parent, &leaf->header);
+    leaf_node_t *left = position > 0 ? _as_leaf(parent->kids[position - 1]) : NULL;
+    leaf_node_t *right = position < parent->header.count
+        ? _as_leaf(parent->kids[position + 1]) : NULL;
+
+    if (left && left->header.count > min_elements) {
+        _move_elements(tree, leaf, 1, leaf, 0, leaf->header.count);
+        _move_elements(tree, leaf, 0, left, left->header.count - 1, 1);
+        left->header.count--;
+        leaf->header.count++;
+        memcpy(_get_internal_key(tree, parent, position - 1), _get_leaf_key(tree, leaf, 0),
+               tree->key_size);
+        return;
+    }
+
+    if (right && right->header.count > min_elements) {
+        _move_elements(tree, leaf, leaf->header.count, right, 0, 1);
+        leaf->header.count++;
+        _move_elements(tree, right, 0, right, 1, right->header.count - 1);
+        right->header.count--;
+        memcpy(_get_internal_key(tree, parent, position), _get_leaf_key(tree, right, 0),
+               tree->key_size);
+        return;
+    }
+
+    if (left) {
+        _move_elements(tree, left, left->header.count, leaf, 0, leaf->header.count);
+        left->header.count += leaf->header.count;
+        _unlink_leaf(tree, leaf);
+        _remove_from_internal(tree, parent, position - 1);
+        tree->alloc_packet->free_function(leaf);
+    } else {
+        assert(right);
+        _move_elements(tree, leaf, leaf->header.count, right, 0, right->header.count);
+        leaf->header.count += right->header.count;
+        _unlink_leaf(tree, right);
+        _remove_from_internal(tree, parent, position);
+        tree->alloc_packet->free_function(right);
+    }
+
+    _rebalance_internal(tree, parent);
+}
+
+/*
+ * Single pass over the leaf list. Leaves are visited in order, so after the last kid of an internal
+ * node is freed the whole subtree of that node is gone and the node itself can be released too.
+ */
+static void _internal_free(tree_descriptor_t *tree, cmagic_b_tree_clear_callback_t callback,
+                           void *context) {
+    leaf_node_t *leaf = tree->first_leaf;
+    while (leaf) {
+        leaf_node_t *next_leaf = leaf->next;
+        for (size_t i = 0; i < leaf->header.count; i++) {
+            element_t *element = leaf->elements[i];
+            if (callback) {
+                callback(element->key, element->value, context);
+            }
+            tree->alloc_packet->free_function(element);
+        }
+
+        node_header_t *node = &leaf->header;
+        bool subtree_finished;
+        do {
+            internal_node_t *parent = node->parent;
+            subtree_finished = parent && parent->kids[parent->header.count] == node;
+            tree->alloc_packet->free_function(node);
+            node = subtree_finished ? &parent->header : NULL;
+        } while (subtree_finished);
+
+        leaf = next_leaf;
+    }
+
+    tree->root = NULL;
+    tree->first_leaf = tree->last_leaf = NULL;
+    tree->tree_size = 0;
+}
+
+void
+cmagic_b_tree_clear_ext(void *b_tree, cmagic_b_tree_clear_callback_t callback, void *context) {
+    _internal_free(_get_b_tree_descriptor(b_tree), callback, context);
+}
+
+void
+cmagic_b_tree_clear(void *b_tree) {
+    _internal_free(_get_b_tree_descriptor(b_tree), NULL, NULL);
+}
+
+// Releases the nodes of an unfinished build together with the elements already in the leaves
+static void _discard_built_nodes(tree_descriptor_t *tree, node_header_t **nodes,
+                                 size_t nodes_count) {
+    for (size_t i = 0; i < nodes_count; i++) {
+        if (nodes[i]->is_leaf) {
+            leaf_node_t *leaf = _as_leaf(nodes[i]);
+            for (size_t j = 0; j < leaf->header.count; j++) {
+                tree->alloc_packet->free_function(leaf->elements[j]);
+            }
+        }
+        tree->alloc_packet->free_function(nodes[i]);
+    }
+    tree->alloc_packet->free_function(nodes);
+}
+
+/*
+ * Bottom-up construction. The number of nodes on every level is known in advance, so all of them
+ * are allocated before anything is linked and a failure never leaves a half-built tree. Elements
+ * and kids are spread evenly, which keeps every non-root node at least about half full.
+ */
+bool
+cmagic_b_tree_build(void *b_tree, const cmagic_b_tree_element_t *elements, size_t count) {
+    tree_descriptor_t *tree = _get_b_tree_descriptor(b_tree);
+    assert(!tree->root);
+    assert(elements || count == 0);
+    if (count == 0) {
+        return true;
+    }
+
+    size_t level_sizes[B_TREE_MAX_LEVELS];
+    size_t levels = 0;
+    size_t total_nodes = 0;
+    size_t level_size = CMAGIC_UTILS_DIV_CEIL(count, tree->leaf_capacity);
+    while (true) {
+        assert(levels < B_TREE_MAX_LEVELS);
+        level_sizes[levels++] = level_size;
+        total_nodes += level_size;
+        if (level_size == 1) {
+            break;
+        }
+        level_size = CMAGIC_UTILS_DIV_CEIL(level_size, tree->internal_capacity + 1);
+    }
+
+    node_header_t **nodes = (node_header_t **)
+        tree->alloc_packet->malloc_function(total_nodes * sizeof(node_header_t *));
+    if (!nodes) {
+        return false;
+    }
+
+    for (size_t i = 0; i < total_nodes; i++) {
+        nodes[i] = i < level_sizes[0] ? (node_header_t *)_new_leaf(tree)
+                                      : (node_header_t *)_new_internal(tree);
+        if (!nodes[i]) {
+            _discard_built_nodes(tree, nodes, i);
+            return false;
+        }
+    }
+
+    const size_t leaf_count = level_sizes[0];
+    const cmagic_b_tree_element_t *source = elements;
+    for (size_t i = 0; i < leaf_count; i++) {
+        leaf_node_t *leaf = _as_leaf(nodes[i]);
+        const size_t leaf_size = count / leaf_count + (i < count % leaf_count ? 1 : 0);
+        while (leaf->header.count < leaf_size) {
+            element_t *element =
+                (element_t *)tree->alloc_packet->malloc_function(sizeof(element_t));
+            if (!element) {
+                _discard_built_nodes(tree, nodes, total_nodes);
+                return false;
+            }
+            *element = (element_t) {
+                .key = source->key,
+                .value = source->value,
+                .tagged_leaf = 0,
+                .index = 0
+            };
+            _insert_into_leaf(tree, leaf, leaf->header.count, element, source->key);
+            source++;
+        }
+        leaf->prev = i > 0 ? _as_leaf(nodes[i - 1]) : NULL;
+        leaf->next = i + 1 < leaf_count ? _as_leaf(nodes[i + 1]) : NULL;
+    }
+    assert(source == elements + count);
+
+    node_header_t **kids = nodes;
+    for (size_t level = 1; level < levels; level++) {
+        const size_t kid_count = level_sizes[level - 1];
+        const size_t parent_count = level_sizes[level];
+        node_header_t **parents = kids + kid_count;
+        for (size_t i = 0; i < parent_count; i++) {
+            internal_node_t *parent = _as_internal(parents[i]);
+            const size_t parent_kids =
+                kid_count / parent_count + (i < kid_count % parent_count ? 1 : 0);
+            parent->header.count = parent_kids - 1;
+            for (size_t j = 0; j < parent_kids; j++) {
+                parent->kids[j] = *kids++;
+                parent->kids[j]->parent = parent;
+                if (j > 0) {
+                    memcpy(_get_internal_key(tree, parent, j - 1),
+                           _get_min_key(tree, parent->kids[j]), tree->key_size);
+                }
+            }
+        }
+        assert(kids == parents);
+    }
+
+    tree->root = nodes[total_nodes - 1];
+    tree->first_leaf = _as_leaf(nodes[0]);
+    tree->last_leaf = _as_leaf(nodes[leaf_count - 1]);
+    tree->tree_size = count;
+    tree->alloc_packet->free_function(nodes);
+    return true;
+}
+
+size_t
+cmagic_b_tree_size(void *b_tree) {
+    return _get_b_tree_descriptor(b_tree)->tree_size;
+}
+
+void
+cmagic_b_tree_free(void *b_tree) {
+    tree_descriptor_t *tree = _get_b_tree_descriptor(b_tree);
+    _internal_free(tree, NULL, NULL);
+    tree->alloc_packet->free_function(tree);
+}
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_first(void *b_tree) {
+    tree_descriptor_t *tree = _get_b_tree_descriptor(b_tree);
+    return tree->first_leaf ? (cmagic_b_tree_iterator_t)tree->first_leaf->elements[0] : NULL;
+}
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_last(void *b_tree) {
+    tree_descriptor_t *tree = _get_b_tree_descriptor(b_tree);
+    if (!tree->last_leaf) {
+        return NULL;
+    }
+
+    return (cmagic_b_tree_iterator_t)tree->last_leaf->elements[tree->last_leaf->header.count - 1];
+}
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_iterator_next(cmagic_b_tree_iterator_t iterator) {
+    if (!iterator) {
+        return NULL;
+    }
+
+    const element_t *element = (const element_t *)iterator;
+    leaf_node_t *leaf = _get_element_leaf(element);
+    assert(leaf->elements[element->index] == element);
+    return _element_or_next(leaf, element->index + 1);
+}
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_iterator_prev(cmagic_b_tree_iterator_t iterator) {
+    if (!iterator) {
+        return NULL;
+    }
+
+    const element_t *element = (const element_t *)iterator;
+    leaf_node_t *leaf = _get_element_leaf(element);
+    size_t index = element->index;
+    assert(leaf->elements[index] == element);
+    if (index > 0) {
+        return (cmagic_b_tree_iterator_t)leaf->elements[index - 1];
+    }
+
+    return leaf->prev
+        ? (cmagic_b_tree_iterator_t)leaf->prev->elements[leaf->prev->header.count - 1] : NULL;
+}
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_find(void *b_tree, const void *key) {
+    tree_descriptor_t *tree = _get_b_tree_descriptor(b_tree);
+    if (!tree->root) {
+        return NULL;
+    }
+
+    const position_t found = _locate(tree, key, tree->key_comparator, BOUND_LOWER);
+    return _is_key_at(tree, found, key)
+        ? (cmagic_b_tree_iterator_t)found.leaf->elements[found.index] : NULL;
+}
+
+static cmagic_b_tree_iterator_t _internal_bound(tree_descriptor_t *tree, const void *key,
+                                                cmagic_b_tree_key_comparator_t key_comparator,
+                                                bound_kind_t kind) {
+    if (!tree->root) {
+        return NULL;
+    }
+
+    const position_t found = _locate(tree, key, key_comparator, kind);
+    return _element_or_next(found.leaf, found.index);
+}
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_lower_bound(void *b_tree, const void *key) {
+    tree_descriptor_t *tree = _get_b_tree_descriptor(b_tree);
+    return _internal_bound(tree, key, tree->key_comparator, BOUND_LOWER);
+}
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_upper_bound(void *b_tree, const void *key) {
+    tree_descriptor_t *tree = _get_b_tree_descriptor(b_tree);
+    return _internal_bound(tree, key, tree->key_comparator, BOUND_UPPER);
+}
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_lower_bound_by(void *b_tree, const void *key,
+                             cmagic_b_tree_key_comparator_t key_comparator) {
+    return _internal_bound(_get_b_tree_descriptor(b_tree), key, key_comparator, BOUND_LOWER);
+}
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_upper_bound_by(void *b_tree, const void *key,
+                             cmagic_b_tree_key_comparator_t key_comparator) {
+    return _internal_bound(_get_b_tree_descriptor(b_tree), key, key_comparator, BOUND_UPPER);
+}
+
+cmagic_b_tree_range_t
+cmagic_b_tree_equal_range(void *b_tree, const void *key) {
+    tree_descriptor_t *tree = _get_b_tree_descriptor(b_tree);
+    cmagic_b_tree_iterator_t lower = _internal_bound(tree, key, tree->key_comparator, BOUND_LOWER);
+
+    // Keys are unique, so the range holds at most one element
+    cmagic_b_tree_iterator_t upper = lower;
+    if (lower && tree->key_comparator(key, lower->key) == 0) {
+        upper = cmagic_b_tree_iterator_next(upper);
+    }
+
+    return (cmagic_b_tree_range_t) { .begin = lower, .end = upper };
+}
+
+const cmagic_memory_alloc_packet_t *
+cmagic_b_tree_get_alloc_packet(void *b_tree) {
+    return _get_b_tree_descriptor(b_tree)->alloc_packet;
+}
+
+const cmagic_tree_engine_t CMAGIC_TREE_ENGINE_B_TREE = {
+    .new_function = cmagic_b_tree_new,
+    .free_function = cmagic_b_tree_free,
+    .insert_function = cmagic_b_tree_insert,
+    .replace_key_function = cmagic_b_tree_replace_key,
+    .erase_function = cmagic_b_tree_erase,
+    .clear_function = cmagic_b_tree_clear_ext,
+    .build_function = cmagic_b_tree_build,
+    .split_function = NULL,
+    .join_function = NULL,
+    .extract_function = NULL,
+    .insert_node_function = NULL,
+    .find_batch_function = NULL,
+    .size_function = cmagic_b_tree_size,
+    .first_function = cmagic_b_tree_first,
+    .last_function = cmagic_b_tree_last,
+    .find_function = cmagic_b_tree_find,
+    .lower_bound_function = cmagic_b_tree_lower_bound,
+    .upper_bound_function = cmagic_b_tree_upper_bound,
+    .lower_bound_by_function = cmagic_b_tree_lower_bound_by,
+    .upper_bound_by_function = cmagic_b_tree_upper_bound_by,
+    .equal_range_function = cmagic_b_tree_equal_range,
+    .get_alloc_packet_function = cmagic_b_tree_get_alloc_packet
+};
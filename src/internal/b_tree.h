@@ -0,0 +1,145 @@
+#ifndef CMAGIC_B_TREE_H
+#define CMAGIC_B_TREE_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmagic/memory.h"
+#include "tree_engine.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * B+ tree with multi-key nodes sized to a few cache lines. Nodes keep copies of the keys, so a
+ * lookup compares keys without leaving the node. All elements are referenced from the leaves which
+ * form a doubly linked list, and every element knows its leaf and its position there, so advancing
+ * an iterator takes constant time. Every element is allocated separately, so as in the AVL tree,
+ * its iterator stays valid until the element is erased.
+ */
+
+typedef cmagic_tree_key_comparator_t cmagic_b_tree_key_comparator_t;
+
+typedef cmagic_tree_iterator_t cmagic_b_tree_iterator_t;
+
+typedef cmagic_tree_insert_result_t cmagic_b_tree_insert_result_t;
+
+typedef cmagic_tree_range_t cmagic_b_tree_range_t;
+
+void *
+cmagic_b_tree_new(cmagic_b_tree_key_comparator_t key_comparator, size_t key_size,
+                  const cmagic_memory_alloc_packet_t *alloc_packet);
+
+void
+cmagic_b_tree_free(void *b_tree);
+
+cmagic_b_tree_insert_result_t
+cmagic_b_tree_insert(void *b_tree, const void *key, void *value);
+
+// The new key has to compare equal to the replaced one, since the copies in the nodes are kept
+void
+cmagic_b_tree_replace_key(void *b_tree, cmagic_b_tree_iterator_t iterator, const void *new_key);
+
+void
+cmagic_b_tree_erase(void *b_tree, const void *key);
+
+typedef cmagic_tree_clear_callback_t cmagic_b_tree_clear_callback_t;
+
+void
+cmagic_b_tree_clear_ext(void *b_tree, cmagic_b_tree_clear_callback_t callback, void *context);
+
+void
+cmagic_b_tree_clear(void *b_tree);
+
+typedef cmagic_tree_element_t cmagic_b_tree_element_t;
+
+bool
+cmagic_b_tree_build(void *b_tree, const cmagic_b_tree_element_t *elements, size_t count);
+
+size_t
+cmagic_b_tree_size(void *b_tree);
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_first(void *b_tree);
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_last(void *b_tree);
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_iterator_next(cmagic_b_tree_iterator_t iterator);
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_iterator_prev(cmagic_b_tree_iterator_t iterator);
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_find(void *b_tree, const void *key);
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_lower_bound(void *b_tree, const void *key);
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_upper_bound(void *b_tree, const void *key);
+
+// Same as the bounds above, but compare the key using the given comparator instead of the tree one
+cmagic_b_tree_iterator_t
+cmagic_b_tree_lower_bound_by(void *b_tree, const void *key,
+                             cmagic_b_tree_key_comparator_t key_comparator);
+
+cmagic_b_tree_iterator_t
+cmagic_b_tree_upper_bound_by(void *b_tree, const void *key,
+                             cmagic_b_tree_key_comparator_t key_comparator);
+
+cmagic_b_tree_range_t
+cmagic_b_tree_equal_range(void *b_tree, const void *key);
+
+const cmagic_memory_alloc_packet_t *
+cmagic_b_tree_get_alloc_packet(void *b_tree);
+
+#define CMAGIC_B_TREE(key_type) key_type*
+
+#define CMAGIC_B_TREE_NEW(key_type, key_comparator, alloc_packet) \
+    ((CMAGIC_B_TREE(key_type))cmagic_b_tree_new((key_comparator), sizeof(key_type), \
+    (alloc_packet)))
+
+#define CMAGIC_B_TREE_FREE(b_tree) cmagic_b_tree_free((void*)(b_tree))
+
+#define CMAGIC_B_TREE_INSERT(b_tree, key, value) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(b_tree), *(key)), \
+    cmagic_b_tree_insert((void*)(b_tree), (key), (value)))
+
+#define CMAGIC_B_TREE_ERASE(b_tree, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(b_tree), *(key)), \
+    cmagic_b_tree_erase((void*)(b_tree), (key)))
+
+#define CMAGIC_B_TREE_CLEAR(b_tree) cmagic_b_tree_clear((void*)(b_tree))
+
+#define CMAGIC_B_TREE_SIZE(b_tree) cmagic_b_tree_size((void*)(b_tree))
+
+#define CMAGIC_B_TREE_FIRST(b_tree) cmagic_b_tree_first((void*)(b_tree))
+
+#define CMAGIC_B_TREE_LAST(b_tree) cmagic_b_tree_last((void*)(b_tree))
+
+#define CMAGIC_B_TREE_ITERATOR_NEXT(iterator) cmagic_b_tree_iterator_next(iterator)
+
+#define CMAGIC_B_TREE_ITERATOR_PREV(iterator) cmagic_b_tree_iterator_prev(iterator)
+
+#define CMAGIC_B_TREE_GET_KEY(key_type, iterator) \
+    (assert(iterator), assert((iterator)->key), *((const key_type*)(iterator)->key))
+
+#define CMAGIC_B_TREE_FIND(b_tree, key) (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(b_tree), *(key)), \
+    cmagic_b_tree_find((void*)(b_tree), (key)))
+
+#define CMAGIC_B_TREE_LOWER_BOUND(b_tree, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(b_tree), *(key)), \
+    cmagic_b_tree_lower_bound((void*)(b_tree), (key)))
+
+#define CMAGIC_B_TREE_UPPER_BOUND(b_tree, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(b_tree), *(key)), \
+    cmagic_b_tree_upper_bound((void*)(b_tree), (key)))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_B_TREE_H */
@@ -0,0 +1,733 @@
+#include <assert.h>
+#include <stdint.h>
+#include "cmagic/utils.h"
+#include "compact_tree.h"
+
+#ifndef NDEBUG
+static const int_least32_t COMPACT_TREE_MAGIC_VALUE = 'C' << 24 | 'T' << 16 | 'R' << 8 | 'E';
+#endif
+
+// Index of the sentinel node standing for a missing kid or parent, its height is always zero
+#define NIL ((uint32_t)0)
+
+#define INITIAL_CAPACITY ((size_t)16)
+
+/*
+ * The header word of a node holds the engine tag in the two lowest bits, the subtree height in the
+ * next six bits and the index of the node itself above them. The own index leads from an iterator
+ * back to the beginning of the array. On 64-bit targets the index of the parent takes the upper
+ * bits of the same word, so a node is only four pointers large, which caps the array at 2^28 slots.
+ */
+#define HEIGHT_SHIFT 2
+#define HEIGHT_MASK ((uintptr_t)0x3f << HEIGHT_SHIFT)
+#define INDEX_SHIFT 8
+#if UINTPTR_MAX > UINT32_MAX
+#define INDEX_BITS 28
+#define PARENT_SHIFT (INDEX_SHIFT + INDEX_BITS)
+#else
+#define INDEX_BITS 24
+#endif
+#define INDEX_MASK ((((uintptr_t)1 << INDEX_BITS) - 1) << INDEX_SHIFT)
+#define MAX_CAPACITY ((size_t)1 << INDEX_BITS)
+
+typedef struct {
+    const void *key; // NULL in a free slot
+    void *value;
+    uintptr_t header; // a zero header stands for a NIL parent
+#ifndef PARENT_SHIFT
+    uint32_t parent;
+#endif
+    uint32_t left_kid; // next free slot in a free slot
+    uint32_t right_kid;
+} tree_node_t;
+
+#ifdef PARENT_SHIFT
+_Static_assert(sizeof(tree_node_t) == 4 * sizeof(void *),
+               "the parent index must share the header word with the height and own index");
+#endif
+
+typedef struct {
+#ifndef NDEBUG
+    int_least32_t magic_value;
+#endif
+    cmagic_compact_tree_key_comparator_t key_comparator;
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+    size_t tree_size;
+    tree_node_t *nodes; // allocated only while the tree is not empty, starts with the sentinel
+    size_t capacity;
+    size_t used; // number of slots ever handed out, including the sentinel
+    uint32_t free_list;
+    uint32_t root;
+} tree_descriptor_t;
+
+void *
+cmagic_compact_tree_new(cmagic_compact_tree_key_comparator_t key_comparator,
+                        const cmagic_memory_alloc_packet_t *alloc_packet) {
+    assert(key_comparator);
+    assert(alloc_packet);
+
+    tree_descriptor_t *tree_descriptor =
+        (tree_descriptor_t *) alloc_packet->malloc_function(sizeof(tree_descriptor_t));
+    if (!tree_descriptor) {
+        return NULL;
+    }
+
+    *tree_descriptor = (tree_descriptor_t) {
+#ifndef NDEBUG
+        .magic_value = COMPACT_TREE_MAGIC_VALUE,
+#endif
+        .key_comparator = key_comparator,
+        .alloc_packet = alloc_packet,
+        .tree_size = 0,
+        .nodes = NULL,
+        .capacity = 0,
+        .used = 0,
+        .free_list = NIL,
+        .root = NIL
+    };
+
+    return (void *)tree_descriptor;
+}
+
+static tree_descriptor_t *_get_compact_tree_descriptor(void *tree_ptr) {
+    assert(tree_ptr);
+    tree_descriptor_t *result = (tree_descriptor_t *)tree_ptr;
+    assert(result->magic_value == COMPACT_TREE_MAGIC_VALUE);
+    return result;
+}
+
+static uint32_t _get_index(const tree_node_t *node) {
+    return (uint32_t)((node->header & INDEX_MASK) >> INDEX_SHIFT);
+}
+
+static uint32_t _get_parent(const tree_node_t *node) {
+#ifdef PARENT_SHIFT
+    return (uint32_t)(node->header >> PARENT_SHIFT);
+#else
+    return node->parent;
+#endif
+}
+
+static void _set_parent(tree_node_t *node, uint32_t parent) {
+    assert(parent < MAX_CAPACITY);
+#ifdef PARENT_SHIFT
+    node->header = (node->header & (((uintptr_t)1 << PARENT_SHIFT) - 1)) |
+        (uintptr_t)parent << PARENT_SHIFT;
+#else
+    node->parent = parent;
+#endif
+}
+
+// Every node knows its own index, so the array can be found without the tree descriptor
+static tree_node_t *_get_nodes(tree_node_t *node) {
+    return node - _get_index(node);
+}
+
+static int _get_height(const tree_node_t *nodes, uint32_t index) {
+    return (int)((nodes[index].header & HEIGHT_MASK) >> HEIGHT_SHIFT);
+}
+
+static void _set_header(tree_node_t *node, uint32_t index, int height) {
+    assert(height >= 0 && (uintptr_t)height <= (HEIGHT_MASK >> HEIGHT_SHIFT));
+    assert(index < MAX_CAPACITY);
+    // The parent index, if it is packed into the header, is kept
+    node->header = (node->header & ~(INDEX_MASK | HEIGHT_MASK | CMAGIC_TREE_ENGINE_TAG_MASK)) |
+        (uintptr_t)index << INDEX_SHIFT | (uintptr_t)height << HEIGHT_SHIFT |
+        CMAGIC_TREE_ENGINE_TAG_COMPACT_TREE;
+}
+
+static void _update_height(tree_node_t *nodes, uint32_t index) {
+    tree_node_t *node = &nodes[index];
+    _set_header(node, index, 1 + CMAGIC_UTILS_MAX(_get_height(nodes, node->left_kid),
+                                                  _get_height(nodes, node->right_kid)));
+}
+
+static void _release_nodes(tree_descriptor_t *tree) {
+    tree->alloc_packet->free_function(tree->nodes);
+    tree->nodes = NULL;
+    tree->capacity = tree->used = 0;
+    tree->free_list = tree->root = NIL;
+    tree->tree_size = 0;
+}
+
+// Moves the whole array if needed, so no pointer to a node survives a successful call
+static bool _reserve(tree_descriptor_t *tree, size_t capacity) {
+    if (capacity <= tree->capacity) {
+        return true;
+    }
+    if (capacity > MAX_CAPACITY) {
+        return false;
+    }
+
+    tree_node_t *nodes = (tree_node_t *)tree->alloc_packet->realloc_function(
+        tree->nodes, capacity * sizeof(tree_node_t));
+    if (!nodes) {
+        return false;
+    }
+    if (!tree->nodes) {
+        nodes[NIL] = (tree_node_t) {
+            .key = NULL,
+            .value = NULL,
+            .header = 0,
+            .left_kid = NIL,
+            .right_kid = NIL
+        };
+        _set_header(&nodes[NIL], NIL, 0);
+        tree->used = 1;
+    }
+    tree->nodes = nodes;
+    tree->capacity = capacity;
+    return true;
+}
+
+// Returns a slot for a new node, reusing the erased ones first, or NIL if the allocation has failed
+static uint32_t _allocate_node(tree_descriptor_t *tree) {
+    if (tree->free_list != NIL) {
+        const uint32_t index = tree->free_list;
+        tree->free_list = tree->nodes[index].left_kid;
+        return index;
+    }
+    if (tree->used == tree->capacity) {
+        const size_t capacity = tree->capacity ?
+            CMAGIC_UTILS_MIN(2 * tree->capacity, MAX_CAPACITY) : INITIAL_CAPACITY;
+        if (!_reserve(tree, capacity)) {
+            return NIL;
+        }
+    }
+    return (uint32_t)tree->used++;
+}
+
+static void _free_node(tree_descriptor_t *tree, uint32_t index) {
+    tree_node_t *node = &tree->nodes[index];
+    node->key = NULL;
+    node->value = NULL;
+    node->left_kid = tree->free_list;
+    tree->free_list = index;
+}
+
+/*
+ * Rotations and rebalancing take a pointer to the link referring to the subtree, which is either
+ * a kid index inside the array or the root index in the descriptor. The array does not move while
+ * the tree is being rebalanced, so these pointers stay valid.
+ *
+ *       y                x
+ *      / \              /  \
+ *     x   T3  ------>  T1   y
+ *    / \                   / \
+ *   T1  T2               T2  T3
+ */
+static void _rotate_right(tree_node_t *nodes, uint32_t *y_link) {
+    const uint32_t y = *y_link;
+    const uint32_t x = nodes[y].left_kid;
+    const uint32_t T2 = nodes[x].right_kid;
+
+    nodes[x].right_kid = y;
+    _set_parent(&nodes[x], _get_parent(&nodes[y]));
+    nodes[y].left_kid = T2;
+    _set_parent(&nodes[y], x);
+    *y_link = x;
+    if (T2 != NIL) {
+        _set_parent(&nodes[T2], y);
+    }
+
+    _update_height(nodes, y);
+    _update_height(nodes, x);
+}
+
+/*
+ *     x                    y
+ *    /  \                 / \
+ *   T1   y    ------>    x   T3
+ *       / \             / \
+ *     T2  T3           T1  T2
+ */
+static void _rotate_left(tree_node_t *nodes, uint32_t *x_link) {
+    const uint32_t x = *x_link;
+    const uint32_t y = nodes[x].right_kid;
+    const uint32_t T2 = nodes[y].left_kid;
+
+    nodes[y].left_kid = x;
+    _set_parent(&nodes[y], _get_parent(&nodes[x]));
+    nodes[x].right_kid = T2;
+    _set_parent(&nodes[x], y);
+    *x_link = y;
+    if (T2 != NIL) {
+        _set_parent(&nodes[T2], x);
+    }
+
+    _update_height(nodes, x);
+    _update_height(nodes, y);
+}
+
+static int _get_balance(const tree_node_t *nodes, uint32_t index) {
+    return index != NIL ?
+        _get_height(nodes, nodes[index].left_kid) - _get_height(nodes, nodes[index].right_kid) : 0;
+}
+
+// Same cases as in the pointer-based AVL tree
+static void _rebalance(tree_node_t *nodes, uint32_t *link) {
+    assert(link && *link != NIL);
+
+    tree_node_t *node = &nodes[*link];
+    _update_height(nodes, *link);
+    int balance = _get_balance(nodes, *link);
+
+    if (balance > 1 && _get_balance(nodes, node->left_kid) >= 0) {
+        _rotate_right(nodes, link);
+    } else if (balance < -1 && _get_balance(nodes, node->right_kid) <= 0) {
+        _rotate_left(nodes, link);
+    } else if (balance > 1) {
+        _rotate_left(nodes, &node->left_kid);
+        _rotate_right(nodes, link);
+    } else if (balance < -1) {
+        _rotate_right(nodes, &node->right_kid);
+        _rotate_left(nodes, link);
+    }
+}
+
+static uint32_t *_get_link(tree_descriptor_t *tree, uint32_t index) {
+    assert(index != NIL);
+    const uint32_t parent = _get_parent(&tree->nodes[index]);
+    if (parent == NIL) {
+        return &tree->root;
+    }
+
+    tree_node_t *parent_node = &tree->nodes[parent];
+    assert(parent_node->left_kid == index || parent_node->right_kid == index);
+    return parent_node->left_kid == index ? &parent_node->left_kid : &parent_node->right_kid;
+}
+
+static void _rebalance_path(tree_descriptor_t *tree, uint32_t index) {
+    while (index != NIL) {
+        uint32_t *link = _get_link(tree, index);
+        _rebalance(tree->nodes, link);
+        index = _get_parent(&tree->nodes[*link]);
+    }
+}
+
+typedef struct {
+    uint32_t node; // NIL if the key is not present
+    uint32_t parent;
+    int last_comparison_result;
+} internal_find_result_t;
+
+static inline internal_find_result_t _find_with(
+        tree_descriptor_t *tree, const void *key,
+        cmagic_compact_tree_key_comparator_t key_comparator) {
+    internal_find_result_t result = { tree->root, NIL, 0 };
+
+    while (result.node != NIL) {
+        const tree_node_t *node = &tree->nodes[result.node];
+        result.last_comparison_result = key_comparator(key, node->key);
+        if (result.last_comparison_result == 0) {
+            break;
+        }
+        result.parent = result.node;
+        result.node = result.last_comparison_result < 0 ? node->left_kid : node->right_kid;
+    }
+
+    return result;
+}
+
+static internal_find_result_t _internal_find(tree_descriptor_t *tree, const void *key) {
+    assert(tree);
+    assert(key);
+    return CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(_find_with, tree->key_comparator, tree, key);
+}
+
+cmagic_compact_tree_insert_result_t
+cmagic_compact_tree_insert(void *compact_tree, const void *key, void *value) {
+    assert(key);
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    internal_find_result_t find_result = _internal_find(tree, key);
+
+    if (find_result.node != NIL) {
+        return (cmagic_compact_tree_insert_result_t) {
+            .inserted_or_existing = (cmagic_compact_tree_iterator_t)&tree->nodes[find_result.node],
+            .already_exists = true
+        };
+    }
+
+    const uint32_t index = _allocate_node(tree);
+    if (index == NIL) {
+        return (cmagic_compact_tree_insert_result_t) {
+            .inserted_or_existing = NULL,
+            .already_exists = false
+        };
+    }
+
+    tree_node_t *new_node = &tree->nodes[index];
+    *new_node = (tree_node_t) {
+        .key = key,
+        .value = value,
+        .header = 0,
+        .left_kid = NIL,
+        .right_kid = NIL
+    };
+    _set_header(new_node, index, 1);
+    _set_parent(new_node, find_result.parent);
+
+    if (find_result.parent == NIL) {
+        tree->root = index;
+    } else if (find_result.last_comparison_result < 0) {
+        tree->nodes[find_result.parent].left_kid = index;
+    } else {
+        tree->nodes[find_result.parent].right_kid = index;
+    }
+    tree->tree_size++;
+    _rebalance_path(tree, find_result.parent);
+
+    return (cmagic_compact_tree_insert_result_t) {
+        .inserted_or_existing = (cmagic_compact_tree_iterator_t)new_node,
+        .already_exists = false
+    };
+}
+
+void
+cmagic_compact_tree_replace_key(void *compact_tree, cmagic_compact_tree_iterator_t iterator,
+                                const void *new_key) {
+    (void)_get_compact_tree_descriptor(compact_tree);
+    assert(iterator);
+    assert(new_key);
+    iterator->key = new_key;
+}
+
+// A node with two kids is replaced by its successor node, so other iterators stay valid
+static void _unlink_node(tree_descriptor_t *tree, uint32_t index) {
+    tree_node_t *nodes = tree->nodes;
+    tree_node_t *node = &nodes[index];
+    uint32_t *link = _get_link(tree, index);
+    uint32_t rebalance_start;
+    if (node->left_kid != NIL && node->right_kid != NIL) {
+        uint32_t successor = node->right_kid;
+        while (nodes[successor].left_kid != NIL) {
+            successor = nodes[successor].left_kid;
+        }
+
+        if (_get_parent(&nodes[successor]) == index) {
+            rebalance_start = successor;
+        } else {
+            // Unlink successor from its place and take over the right subtree of the node
+            const uint32_t successor_parent = _get_parent(&nodes[successor]);
+            const uint32_t successor_right_kid = nodes[successor].right_kid;
+            rebalance_start = successor_parent;
+            nodes[successor_parent].left_kid = successor_right_kid;
+            if (successor_right_kid != NIL) {
+                _set_parent(&nodes[successor_right_kid], successor_parent);
+            }
+            nodes[successor].right_kid = node->right_kid;
+            _set_parent(&nodes[node->right_kid], successor);
+        }
+
+        nodes[successor].left_kid = node->left_kid;
+        _set_parent(&nodes[node->left_kid], successor);
+        _set_parent(&nodes[successor], _get_parent(node));
+        *link = successor;
+    } else {
+        const uint32_t kid = node->left_kid != NIL ? node->left_kid : node->right_kid;
+        if (kid != NIL) {
+            _set_parent(&nodes[kid], _get_parent(node));
+        }
+        *link = kid;
+        rebalance_start = _get_parent(node);
+    }
+
+    tree->tree_size--;
+    _rebalance_path(tree, rebalance_start);
+}
+
+void
+cmagic_compact_tree_erase(void *compact_tree, const void *key) {
+    assert(key);
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    internal_find_result_t find_result = _internal_find(tree, key);
+    if (find_result.node == NIL) {
+        return;
+    }
+
+    _unlink_node(tree, find_result.node);
+    if (tree->tree_size == 0) {
+        _release_nodes(tree);
+    } else {
+        _free_node(tree, find_result.node);
+    }
+}
+
+// The array is scanned in order of the slots, skipping the free ones
+static void _internal_free(tree_descriptor_t *tree, cmagic_compact_tree_clear_callback_t callback,
+                           void *context) {
+    assert(tree);
+    if (callback) {
+        for (size_t i = 1; i < tree->used; i++) {
+            if (tree->nodes[i].key) {
+                callback(tree->nodes[i].key, tree->nodes[i].value, context);
+            }
+        }
+    }
+    _release_nodes(tree);
+}
+
+void
+cmagic_compact_tree_clear_ext(void *compact_tree, cmagic_compact_tree_clear_callback_t callback,
+                              void *context) {
+    _internal_free(_get_compact_tree_descriptor(compact_tree), callback, context);
+}
+
+void
+cmagic_compact_tree_clear(void *compact_tree) {
+    _internal_free(_get_compact_tree_descriptor(compact_tree), NULL, NULL);
+}
+
+/*
+ * Builds a perfectly balanced subtree of the nodes occupying the given range of slots. The nodes
+ * are already placed in the order of their keys, so only the links and heights are set here.
+ */
+static uint32_t _internal_build(tree_node_t *nodes, uint32_t parent, uint32_t first,
+                                uint32_t count) {
+    if (count == 0) {
+        return NIL;
+    }
+    const uint32_t middle = first + count / 2;
+    _set_parent(&nodes[middle], parent);
+    nodes[middle].left_kid = _internal_build(nodes, middle, first, count / 2);
+    nodes[middle].right_kid = _internal_build(nodes, middle, middle + 1, count - count / 2 - 1);
+    _update_height(nodes, middle);
+    return middle;
+}
+
+/*
+ * The nodes are laid out in the array in the order of their keys, so iteration of a freshly built
+ * tree walks the memory sequentially.
+ */
+bool
+cmagic_compact_tree_build(void *compact_tree, const cmagic_compact_tree_element_t *elements,
+                          size_t count) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    assert(tree->tree_size == 0 && !tree->nodes);
+    assert(elements || count == 0);
+    if (count == 0) {
+        return true;
+    }
+    if (count >= MAX_CAPACITY || !_reserve(tree, count + 1)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        tree->nodes[i + 1] = (tree_node_t) {
+            .key = elements[i].key,
+            .value = elements[i].value,
+            .header = 0,
+            .left_kid = NIL,
+            .right_kid = NIL
+        };
+    }
+    tree->root = _internal_build(tree->nodes, NIL, 1, (uint32_t)count);
+    tree->used = count + 1;
+    tree->tree_size = count;
+    return true;
+}
+
+size_t
+cmagic_compact_tree_size(void *compact_tree) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    return tree->tree_size;
+}
+
+void
+cmagic_compact_tree_free(void *compact_tree) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    _internal_free(tree, NULL, NULL);
+    tree->alloc_packet->free_function(tree);
+}
+
+static tree_node_t *_leftmost(tree_node_t *nodes, uint32_t index) {
+    while (nodes[index].left_kid != NIL) {
+        index = nodes[index].left_kid;
+    }
+    return &nodes[index];
+}
+
+static tree_node_t *_rightmost(tree_node_t *nodes, uint32_t index) {
+    while (nodes[index].right_kid != NIL) {
+        index = nodes[index].right_kid;
+    }
+    return &nodes[index];
+}
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_first(void *compact_tree) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    if (tree->root == NIL) {
+        return NULL;
+    }
+    return (cmagic_compact_tree_iterator_t)_leftmost(tree->nodes, tree->root);
+}
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_last(void *compact_tree) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    if (tree->root == NIL) {
+        return NULL;
+    }
+    return (cmagic_compact_tree_iterator_t)_rightmost(tree->nodes, tree->root);
+}
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_iterator_next(cmagic_compact_tree_iterator_t iterator) {
+    if (!iterator) {
+        return NULL;
+    }
+
+    tree_node_t *node = (tree_node_t *)iterator;
+    tree_node_t *nodes = _get_nodes(node);
+    if (node->right_kid != NIL) {
+        return (cmagic_compact_tree_iterator_t)_leftmost(nodes, node->right_kid);
+    }
+
+    uint32_t index = _get_index(node);
+    uint32_t parent = _get_parent(node);
+    while (parent != NIL && nodes[parent].right_kid == index) {
+        index = parent;
+        parent = _get_parent(&nodes[index]);
+    }
+    return parent != NIL ? (cmagic_compact_tree_iterator_t)&nodes[parent] : NULL;
+}
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_iterator_prev(cmagic_compact_tree_iterator_t iterator) {
+    if (!iterator) {
+        return NULL;
+    }
+
+    tree_node_t *node = (tree_node_t *)iterator;
+    tree_node_t *nodes = _get_nodes(node);
+    if (node->left_kid != NIL) {
+        return (cmagic_compact_tree_iterator_t)_rightmost(nodes, node->left_kid);
+    }
+
+    uint32_t index = _get_index(node);
+    uint32_t parent = _get_parent(node);
+    while (parent != NIL && nodes[parent].left_kid == index) {
+        index = parent;
+        parent = _get_parent(&nodes[index]);
+    }
+    return parent != NIL ? (cmagic_compact_tree_iterator_t)&nodes[parent] : NULL;
+}
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_find(void *compact_tree, const void *key) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    internal_find_result_t result = _internal_find(tree, key);
+    return result.node != NIL ? (cmagic_compact_tree_iterator_t)&tree->nodes[result.node] : NULL;
+}
+
+typedef enum {
+    BOUND_LOWER,
+    BOUND_UPPER
+} bound_kind_t;
+
+static inline tree_node_t *_bound_with(tree_descriptor_t *tree, const void *key, bound_kind_t kind,
+                                       cmagic_compact_tree_key_comparator_t key_comparator) {
+    uint32_t index = tree->root;
+    tree_node_t *candidate = NULL;
+    while (index != NIL) {
+        tree_node_t *node = &tree->nodes[index];
+        int comparison_result = key_comparator(key, node->key);
+        if (comparison_result < 0 || (comparison_result == 0 && kind == BOUND_LOWER)) {
+            candidate = node;
+            index = node->left_kid;
+        } else {
+            index = node->right_kid;
+        }
+    }
+    return candidate;
+}
+
+static tree_node_t *_internal_bound(tree_descriptor_t *tree, const void *key,
+                                   cmagic_compact_tree_key_comparator_t key_comparator,
+                                   bound_kind_t kind) {
+    assert(tree);
+    assert(key);
+    return CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(_bound_with, key_comparator, tree, key, kind);
+}
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_lower_bound(void *compact_tree, const void *key) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    return (cmagic_compact_tree_iterator_t)
+        _internal_bound(tree, key, tree->key_comparator, BOUND_LOWER);
+}
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_upper_bound(void *compact_tree, const void *key) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    return (cmagic_compact_tree_iterator_t)
+        _internal_bound(tree, key, tree->key_comparator, BOUND_UPPER);
+}
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_lower_bound_by(void *compact_tree, const void *key,
+                                   cmagic_compact_tree_key_comparator_t key_comparator) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    return (cmagic_compact_tree_iterator_t)_internal_bound(tree, key, key_comparator, BOUND_LOWER);
+}
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_upper_bound_by(void *compact_tree, const void *key,
+                                   cmagic_compact_tree_key_comparator_t key_comparator) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    return (cmagic_compact_tree_iterator_t)_internal_bound(tree, key, key_comparator, BOUND_UPPER);
+}
+
+cmagic_compact_tree_range_t
+cmagic_compact_tree_equal_range(void *compact_tree, const void *key) {
+    tree_descriptor_t *tree = _get_compact_tree_descriptor(compact_tree);
+    tree_node_t *lower = _internal_bound(tree, key, tree->key_comparator, BOUND_LOWER);
+    // Keys are unique, so the range holds at most one element
+    cmagic_compact_tree_iterator_t upper = (cmagic_compact_tree_iterator_t)lower;
+    if (lower && tree->key_comparator(key, lower->key) == 0) {
+        upper = cmagic_compact_tree_iterator_next(upper);
+    }
+
+    return (cmagic_compact_tree_range_t) {
+        .begin = (cmagic_compact_tree_iterator_t)lower,
+        .end = upper
+    };
+}
+
+const cmagic_memory_alloc_packet_t *
+cmagic_compact_tree_get_alloc_packet(void *compact_tree) {
+    return _get_compact_tree_descriptor(compact_tree)->alloc_packet;
+}
+
+// Keys are compared only through the pointers to them, so their size is not needed
+static void *_new_engine_tree(cmagic_tree_key_comparator_t key_comparator, size_t key_size,
+                              const cmagic_memory_alloc_packet_t *alloc_packet) {
+    (void)key_size;
+    return cmagic_compact_tree_new(key_comparator, alloc_packet);
+}
+
+const cmagic_tree_engine_t CMAGIC_TREE_ENGINE_COMPACT_TREE = {
+    .new_function = _new_engine_tree,
+    .free_function = cmagic_compact_tree_free,
+    .insert_function = cmagic_compact_tree_insert,
+    .replace_key_function = cmagic_compact_tree_replace_key,
+    .erase_function = cmagic_compact_tree_erase,
+    .clear_function = cmagic_compact_tree_clear_ext,
+    .build_function = cmagic_compact_tree_build,
+    .split_function = NULL,
+    .join_function = NULL,
+    .extract_function = NULL,
+    .insert_node_function = NULL,
+    .find_batch_function = NULL,
+    .size_function = cmagic_compact_tree_size,
+    .first_function = cmagic_compact_tree_first,
+    .last_function = cmagic_compact_tree_last,
+    .find_function = cmagic_compact_tree_find,
+    .lower_bound_function = cmagic_compact_tree_lower_bound,
+    .upper_bound_function = cmagic_compact_tree_upper_bound,
+    .lower_bound_by_function = cmagic_compact_tree_lower_bound_by,
+    .upper_bound_by_function = cmagic_compact_tree_upper_bound_by,
+    .equal_range_function = cmagic_compact_tree_equal_range,
+    .get_alloc_packet_function = cmagic_compact_tree_get_alloc_packet
+};
@@ -0,0 +1,149 @@
+#ifndef CMAGIC_COMPACT_TREE_H
+#define CMAGIC_COMPACT_TREE_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmagic/memory.h"
+#include "tree_engine.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * AVL tree whose nodes live in a single growable array and link each other by 32-bit indices
+ * instead of pointers. The subtree height, the own index and, on 64-bit targets, the parent index
+ * are packed into one header word, so a node takes 32 bytes there instead of 48 in the
+ * pointer-based AVL tree, and no allocation is made per node. Nodes only point to the keys and
+ * values, so copying the array does not copy the contents of the tree. The array holds at most
+ * 2^28 slots on 64-bit targets and 2^24 on 32-bit ones. Erasing an element keeps iterators to
+ * other elements valid, but inserting one may grow the array, which invalidates all iterators.
+ */
+
+typedef cmagic_tree_key_comparator_t cmagic_compact_tree_key_comparator_t;
+
+typedef cmagic_tree_iterator_t cmagic_compact_tree_iterator_t;
+
+typedef cmagic_tree_insert_result_t cmagic_compact_tree_insert_result_t;
+
+typedef cmagic_tree_range_t cmagic_compact_tree_range_t;
+
+void *
+cmagic_compact_tree_new(cmagic_compact_tree_key_comparator_t key_comparator,
+                        const cmagic_memory_alloc_packet_t *alloc_packet);
+
+void
+cmagic_compact_tree_free(void *compact_tree);
+
+cmagic_compact_tree_insert_result_t
+cmagic_compact_tree_insert(void *compact_tree, const void *key, void *value);
+
+void
+cmagic_compact_tree_replace_key(void *compact_tree, cmagic_compact_tree_iterator_t iterator,
+                                const void *new_key);
+
+void
+cmagic_compact_tree_erase(void *compact_tree, const void *key);
+
+typedef cmagic_tree_clear_callback_t cmagic_compact_tree_clear_callback_t;
+
+void
+cmagic_compact_tree_clear_ext(void *compact_tree, cmagic_compact_tree_clear_callback_t callback,
+                              void *context);
+
+void
+cmagic_compact_tree_clear(void *compact_tree);
+
+typedef cmagic_tree_element_t cmagic_compact_tree_element_t;
+
+bool
+cmagic_compact_tree_build(void *compact_tree, const cmagic_compact_tree_element_t *elements,
+                          size_t count);
+
+size_t
+cmagic_compact_tree_size(void *compact_tree);
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_first(void *compact_tree);
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_last(void *compact_tree);
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_iterator_next(cmagic_compact_tree_iterator_t iterator);
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_iterator_prev(cmagic_compact_tree_iterator_t iterator);
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_find(void *compact_tree, const void *key);
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_lower_bound(void *compact_tree, const void *key);
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_upper_bound(void *compact_tree, const void *key);
+
+// Same as the bounds above, but compare the key using the given comparator instead of the tree one
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_lower_bound_by(void *compact_tree, const void *key,
+                                   cmagic_compact_tree_key_comparator_t key_comparator);
+
+cmagic_compact_tree_iterator_t
+cmagic_compact_tree_upper_bound_by(void *compact_tree, const void *key,
+                                   cmagic_compact_tree_key_comparator_t key_comparator);
+
+cmagic_compact_tree_range_t
+cmagic_compact_tree_equal_range(void *compact_tree, const void *key);
+
+const cmagic_memory_alloc_packet_t *
+cmagic_compact_tree_get_alloc_packet(void *compact_tree);
+
+#define CMAGIC_COMPACT_TREE(key_type) key_type*
+
+#define CMAGIC_COMPACT_TREE_NEW(key_type, key_comparator, alloc_packet) \
+    ((CMAGIC_COMPACT_TREE(key_type))cmagic_compact_tree_new((key_comparator), (alloc_packet)))
+
+#define CMAGIC_COMPACT_TREE_FREE(compact_tree) cmagic_compact_tree_free((void*)(compact_tree))
+
+#define CMAGIC_COMPACT_TREE_INSERT(compact_tree, key, value) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(compact_tree), *(key)), \
+    cmagic_compact_tree_insert((void*)(compact_tree), (key), (value)))
+
+#define CMAGIC_COMPACT_TREE_ERASE(compact_tree, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(compact_tree), *(key)), \
+    cmagic_compact_tree_erase((void*)(compact_tree), (key)))
+
+#define CMAGIC_COMPACT_TREE_CLEAR(compact_tree) cmagic_compact_tree_clear((void*)(compact_tree))
+
+#define CMAGIC_COMPACT_TREE_SIZE(compact_tree) cmagic_compact_tree_size((void*)(compact_tree))
+
+#define CMAGIC_COMPACT_TREE_FIRST(compact_tree) cmagic_compact_tree_first((void*)(compact_tree))
+
+#define CMAGIC_COMPACT_TREE_LAST(compact_tree) cmagic_compact_tree_last((void*)(compact_tree))
+
+#define CMAGIC_COMPACT_TREE_ITERATOR_NEXT(iterator) cmagic_compact_tree_iterator_next(iterator)
+
+#define CMAGIC_COMPACT_TREE_ITERATOR_PREV(iterator) cmagic_compact_tree_iterator_prev(iterator)
+
+#define CMAGIC_COMPACT_TREE_GET_KEY(key_type, iterator) \
+    (assert(iterator), assert((iterator)->key), *((const key_type*)(iterator)->key))
+
+#define CMAGIC_COMPACT_TREE_FIND(compact_tree, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(compact_tree), *(key)), \
+    cmagic_compact_tree_find((void*)(compact_tree), (key)))
+
+#define CMAGIC_COMPACT_TREE_LOWER_BOUND(compact_tree, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(compact_tree), *(key)), \
+    cmagic_compact_tree_lower_bound((void*)(compact_tree), (key)))
+
+#define CMAGIC_COMPACT_TREE_UPPER_BOUND(compact_tree, key) \
+    (CMAGIC_UTILS_ASSERT_SAME_TYPE(*(compact_tree), *(key)), \
+    cmagic_compact_tree_upper_bound((void*)(compact_tree), (key)))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_COMPACT_TREE_H */
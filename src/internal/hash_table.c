@@ -0,0 +1,464 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "cmagic/utils.h"
+#include "hash_table.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HASH_TABLE_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifndef NDEBUG
+static const int_least32_t HASH_TABLE_MAGIC_VALUE = 'H' << 16 | 'T' << 8 | 'B';
+#endif
+
+#define GROUP_WIDTH ((size_t)16)
+
+// Control bytes of free slots have the most significant bit set, full slots keep 7 bits of hash
+#define CTRL_EMPTY ((uint8_t)0x80)
+#define CTRL_DELETED ((uint8_t)0xFE)
+#define CTRL_HASH_MASK ((size_t)0x7F)
+#define CTRL_HASH_BITS 7
+
+// The table grows when 7/8 of its slots are full or deleted
+#define MAX_LOAD_NUMERATOR 7
+#define MAX_LOAD_DENOMINATOR 8
+
+
+typedef struct {
+#ifndef NDEBUG
+    int_least32_t magic_value;
+#endif
+    size_t key_size;
+    size_t value_offset;
+    size_t slot_size;
+    cmagic_hash_table_hash_function_t hash_function;
+    cmagic_hash_table_key_equal_t key_equal;
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+    size_t capacity; // 0 or a power of two not less than GROUP_WIDTH
+    size_t size;
+    size_t growth_left; // number of empty slots which may be filled before the table grows
+    char *slots; // single allocation holding the slots followed by their control bytes
+    uint8_t *ctrl;
+} table_descriptor_t;
+
+// Bit mask of the bytes of a group, the lowest bit corresponds to the first byte
+typedef uint32_t group_mask_t;
+
+
+static size_t _alignment_of_size(size_t size) {
+    size_t alignment = size & (~size + 1);
+    return alignment == 0 || alignment > sizeof(max_align_t) ? sizeof(max_align_t) : alignment;
+}
+
+static size_t _round_up(size_t value, size_t alignment) {
+    return CMAGIC_UTILS_DIV_CEIL(value, alignment) * alignment;
+}
+
+void *
+cmagic_hash_table_new(size_t key_size, size_t value_size,
+                      cmagic_hash_table_hash_function_t hash_function,
+                      cmagic_hash_table_key_equal_t key_equal,
+                      const cmagic_memory_alloc_packet_t *alloc_packet) {
+    assert(key_size > 0);
+    assert(hash_function);
+    assert(alloc_packet);
+
+    table_descriptor_t *table =
+        (table_descriptor_t *)alloc_packet->malloc_function(sizeof(table_descriptor_t));
+    if (!table) {
+        return NULL;
+    }
+
+    const size_t value_alignment = value_size > 0 ? _alignment_of_size(value_size) : 1;
+    const size_t slot_alignment = CMAGIC_UTILS_MAX(_alignment_of_size(key_size), value_alignment);
+    const size_t value_offset = _round_up(key_size, value_alignment);
+    *table = (table_descriptor_t) {
+#ifndef NDEBUG
+        .magic_value = HASH_TABLE_MAGIC_VALUE,
+#endif
+        .key_size = key_size,
+        .value_offset = value_offset,
+        .slot_size = _round_up(value_offset + value_size, slot_alignment),
+        .hash_function = hash_function,
+        .key_equal = key_equal,
+        .alloc_packet = alloc_packet
+    };
+    return (void *)table;
+}
+
+static table_descriptor_t *_get_table_descriptor(void *hash_table) {
+    assert(hash_table);
+    table_descriptor_t *result = (table_descriptor_t *)hash_table;
+    assert(result->magic_value == HASH_TABLE_MAGIC_VALUE);
+    return result;
+}
+
+void
+cmagic_hash_table_free(void *hash_table) {
+    table_descriptor_t *table = _get_table_descriptor(hash_table);
+    table->alloc_packet->free_function(table->slots);
+    table->alloc_packet->free_function(table);
+}
+
+static void *_slot(table_descriptor_t *table, size_t index) {
+    return table->slots + index * table->slot_size;
+}
+
+static size_t _slot_index(table_descriptor_t *table, const void *slot) {
+    assert((const char *)slot >= table->slots);
+    size_t index = (size_t)((const char *)slot - table->slots) / table->slot_size;
+    assert(index < table->capacity);
+    return index;
+}
+
+static bool _is_full(uint8_t ctrl) {
+    return (ctrl & CTRL_EMPTY) == 0;
+}
+
+/*
+ * Users often hash integers with the identity function, so the hash is mixed before it's split
+ * into the group index and the bits stored in the control byte.
+ */
+static size_t _hash(table_descriptor_t *table, const void *key) {
+    uint64_t hash = (uint64_t)table->hash_function(key) * UINT64_C(0x9E3779B97F4A7C15);
+    return (size_t)(hash ^ (hash >> 32));
+}
+
+static bool _keys_equal(table_descriptor_t *table, const void *key, const void *slot) {
+    return table->key_equal ? table->key_equal(key, slot)
+                            : memcmp(key, slot, table->key_size) == 0;
+}
+
+/*
+ * A whole group of control bytes is compared at once with SSE2. Other targets compare the bytes
+ * one by one, which the compiler may still vectorize.
+ */
+#ifdef HASH_TABLE_USE_SSE2
+
+static group_mask_t _group_match(const uint8_t *group, uint8_t ctrl) {
+    const __m128i group_bytes = _mm_loadu_si128((const __m128i *)(const void *)group);
+    const __m128i match = _mm_cmpeq_epi8(group_bytes, _mm_set1_epi8((char)ctrl));
+    return (group_mask_t)_mm_movemask_epi8(match);
+}
+
+// Free control bytes are exactly the ones with the sign bit set
+static group_mask_t _group_match_free(const uint8_t *group) {
+    const __m128i group_bytes = _mm_loadu_si128((const __m128i *)(const void *)group);
+    return (group_mask_t)_mm_movemask_epi8(group_bytes);
+}
+
+#else
+
+static group_mask_t _group_match(const uint8_t *group, uint8_t ctrl) {
+    group_mask_t mask = 0;
+    for (size_t i = 0; i < GROUP_WIDTH; i++) {
+        mask |= (group_mask_t)(group[i] == ctrl) << i;
+    }
+    return mask;
+}
+
+static group_mask_t _group_match_free(const uint8_t *group) {
+    group_mask_t mask = 0;
+    for (size_t i = 0; i < GROUP_WIDTH; i++) {
+        mask |= (group_mask_t)(!_is_full(group[i])) << i;
+    }
+    return mask;
+}
+
+#endif /* HASH_TABLE_USE_SSE2 */
+
+static size_t _lowest_bit_index(group_mask_t mask) {
+    assert(mask);
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctz(mask);
+#else
+    size_t index = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/*
+ * Groups are probed in triangular steps, which visit every group of a power-of-two table exactly
+ * once.
+ */
+typedef struct {
+    size_t group;
+    size_t step;
+    size_t group_mask;
+} probe_t;
+
+static probe_t _probe_start(table_descriptor_t *table, size_t hash) {
+    const size_t group_mask = table->capacity / GROUP_WIDTH - 1;
+    return (probe_t) {
+        .group = (hash >> CTRL_HASH_BITS) & group_mask,
+        .step = 0,
+        .group_mask = group_mask
+    };
+}
+
+static void _probe_next(probe_t *probe) {
+    probe->step++;
+    probe->group = (probe->group + probe->step) & probe->group_mask;
+    assert(probe->step <= probe->group_mask);
+}
+
+static void *_find_with_hash(table_descriptor_t *table, const void *key, size_t hash) {
+    if (table->capacity == 0) {
+        return NULL;
+    }
+
+    const uint8_t hash_ctrl = (uint8_t)(hash & CTRL_HASH_MASK);
+    for (probe_t probe = _probe_start(table, hash); ; _probe_next(&probe)) {
+        const uint8_t *group = table->ctrl + probe.group * GROUP_WIDTH;
+        for (group_mask_t match = _group_match(group, hash_ctrl); match; match &= match - 1) {
+            void *slot = _slot(table, probe.group * GROUP_WIDTH + _lowest_bit_index(match));
+            if (_keys_equal(table, key, slot)) {
+                return slot;
+            }
+        }
+        if (_group_match(group, CTRL_EMPTY)) {
+            return NULL;
+        }
+    }
+}
+
+// Returns the index of the first empty or deleted slot on the probe sequence of the hash
+static size_t _find_free(table_descriptor_t *table, size_t hash) {
+    for (probe_t probe = _probe_start(table, hash); ; _probe_next(&probe)) {
+        group_mask_t free_mask = _group_match_free(table->ctrl + probe.group * GROUP_WIDTH);
+        if (free_mask) {
+            return probe.group * GROUP_WIDTH + _lowest_bit_index(free_mask);
+        }
+    }
+}
+
+static size_t _max_load(size_t capacity) {
+    return capacity / MAX_LOAD_DENOMINATOR * MAX_LOAD_NUMERATOR;
+}
+
+// Returns 0 if no capacity can hold the given number of elements
+static size_t _capacity_for(size_t count) {
+    size_t capacity = GROUP_WIDTH;
+    while (_max_load(capacity) < count) {
+        if (capacity > SIZE_MAX / 2) {
+            return 0;
+        }
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/*
+ * Moves all elements to a new allocation of the given capacity, which also drops the deleted
+ * slots. The table is unchanged if the allocation fails.
+ */
+static bool _rehash(table_descriptor_t *table, size_t new_capacity,
+                    cmagic_hash_table_relocate_t relocate, void *context) {
+    assert(new_capacity >= GROUP_WIDTH && _max_load(new_capacity) >= table->size);
+    if (new_capacity > (SIZE_MAX - new_capacity) / table->slot_size) {
+        return false;
+    }
+    char *new_slots = (char *)table->alloc_packet->malloc_function(
+        new_capacity * table->slot_size + new_capacity);
+    if (!new_slots) {
+        return false;
+    }
+
+    table_descriptor_t old_table = *table;
+    table->capacity = new_capacity;
+    table->growth_left = _max_load(new_capacity) - table->size;
+    table->slots = new_slots;
+    table->ctrl = (uint8_t *)(new_slots + new_capacity * table->slot_size);
+    memset(table->ctrl, CTRL_EMPTY, new_capacity);
+
+    for (size_t i = 0; i < old_table.capacity; i++) {
+        if (_is_full(old_table.ctrl[i])) {
+            void *old_slot = _slot(&old_table, i);
+            const size_t hash = _hash(table, old_slot);
+            const size_t index = _find_free(table, hash);
+            table->ctrl[index] = (uint8_t)(hash & CTRL_HASH_MASK);
+            if (relocate) {
+                relocate(_slot(table, index), old_slot, context);
+            } else {
+                memcpy(_slot(table, index), old_slot, table->slot_size);
+            }
+        }
+    }
+
+    table->alloc_packet->free_function(old_table.slots);
+    return true;
+}
+
+cmagic_hash_table_insert_result_t
+cmagic_hash_table_insert(void *hash_table, const void *key, cmagic_hash_table_relocate_t relocate,
+                         void *context) {
+    assert(key);
+    table_descriptor_t *table = _get_table_descriptor(hash_table);
+    const size_t hash = _hash(table, key);
+    void *existing = _find_with_hash(table, key, hash);
+    if (existing) {
+        return (cmagic_hash_table_insert_result_t) { .slot = existing, .already_exists = true };
+    }
+
+    size_t index = table->capacity > 0 ? _find_free(table, hash) : 0;
+    if (table->capacity == 0 || (table->growth_left == 0 && table->ctrl[index] == CTRL_EMPTY)) {
+        // Tables filled mostly with deleted slots are only cleaned up instead of growing
+        size_t new_capacity = table->size < _max_load(table->capacity) / 2
+                              ? CMAGIC_UTILS_MAX(table->capacity, GROUP_WIDTH)
+                              : _capacity_for(table->size + 1);
+        if (new_capacity == 0 || !_rehash(table, new_capacity, relocate, context)) {
+            return (cmagic_hash_table_insert_result_t) { .slot = NULL };
+        }
+        index = _find_free(table, hash);
+    }
+
+    if (table->ctrl[index] == CTRL_EMPTY) {
+        table->growth_left--;
+    }
+    table->ctrl[index] = (uint8_t)(hash & CTRL_HASH_MASK);
+    table->size++;
+    return (cmagic_hash_table_insert_result_t) {
+        .slot = _slot(table, index),
+        .already_exists = false
+    };
+}
+
+void *
+cmagic_hash_table_find(void *hash_table, const void *key) {
+    assert(key);
+    table_descriptor_t *table = _get_table_descriptor(hash_table);
+    return _find_with_hash(table, key, _hash(table, key));
+}
+
+/*
+ * Probing stops at the first group with an empty slot. If the group of the erased slot has one,
+ * no probe sequence has ever passed through it, so the slot can become empty again instead of
+ * being marked as deleted.
+ */
+void
+cmagic_hash_table_erase_slot(void *hash_table, void *slot) {
+    table_descriptor_t *table = _get_table_descriptor(hash_table);
+    const size_t index = _slot_index(table, slot);
+    assert(_is_full(table->ctrl[index]));
+    const uint8_t *group = table->ctrl + index / GROUP_WIDTH * GROUP_WIDTH;
+    if (_group_match(group, CTRL_EMPTY)) {
+        table->ctrl[index] = CTRL_EMPTY;
+        table->growth_left++;
+    } else {
+        table->ctrl[index] = CTRL_DELETED;
+    }
+    table->size--;
+}
+
+bool
+cmagic_hash_table_reserve(void *hash_table, size_t count, cmagic_hash_table_relocate_t relocate,
+                          void *context) {
+    table_descriptor_t *table = _get_table_descriptor(hash_table);
+    if (count <= table->size + table->growth_left) {
+        return true;
+    }
+    const size_t new_capacity = _capacity_for(count);
+    return new_capacity != 0 && _rehash(table, new_capacity, relocate, context);
+}
+
+void
+cmagic_hash_table_clear(void *hash_table, cmagic_hash_table_clear_callback_t callback,
+                        void *context) {
+    table_descriptor_t *table = _get_table_descriptor(hash_table);
+    if (table->size == 0 && table->growth_left == _max_load(table->capacity)) {
+        return;
+    }
+
+    for (size_t i = 0; callback && i < table->capacity; i++) {
+        if (_is_full(table->ctrl[i])) {
+            callback(_slot(table, i), context);
+        }
+    }
+    memset(table->ctrl, CTRL_EMPTY, table->capacity);
+    table->size = 0;
+    table->growth_left = _max_load(table->capacity);
+}
+
+void *
+cmagic_hash_table_copy(void *hash_table, cmagic_hash_table_copy_callback_t copy_callback,
+                       void *context) {
+    table_descriptor_t *table = _get_table_descriptor(hash_table);
+    table_descriptor_t *copy =
+        (table_descriptor_t *)table->alloc_packet->malloc_function(sizeof(table_descriptor_t));
+    if (!copy) {
+        return NULL;
+    }
+
+    *copy = *table;
+    if (table->capacity == 0) {
+        return (void *)copy;
+    }
+
+    const size_t allocation_size = table->capacity * table->slot_size + table->capacity;
+    copy->slots = (char *)table->alloc_packet->malloc_function(allocation_size);
+    if (!copy->slots) {
+        table->alloc_packet->free_function(copy);
+        return NULL;
+    }
+    copy->ctrl = (uint8_t *)(copy->slots + table->capacity * table->slot_size);
+
+    if (!copy_callback) {
+        memcpy(copy->slots, table->slots, allocation_size);
+        return (void *)copy;
+    }
+
+    memcpy(copy->ctrl, table->ctrl, table->capacity);
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (_is_full(table->ctrl[i])) {
+            copy_callback(_slot(copy, i), _slot(table, i), context);
+        }
+    }
+    return (void *)copy;
+}
+
+size_t
+cmagic_hash_table_size(void *hash_table) {
+    return _get_table_descriptor(hash_table)->size;
+}
+
+size_t
+cmagic_hash_table_capacity(void *hash_table) {
+    return _get_table_descriptor(hash_table)->capacity;
+}
+
+size_t
+cmagic_hash_table_value_offset(void *hash_table) {
+    return _get_table_descriptor(hash_table)->value_offset;
+}
+
+static void *_next_full(table_descriptor_t *table, size_t index) {
+    for (; index < table->capacity; index++) {
+        if (_is_full(table->ctrl[index])) {
+            return _slot(table, index);
+        }
+    }
+    return NULL;
+}
+
+void *
+cmagic_hash_table_first(void *hash_table) {
+    return _next_full(_get_table_descriptor(hash_table), 0);
+}
+
+void *
+cmagic_hash_table_next(void *hash_table, void *slot) {
+    table_descriptor_t *table = _get_table_descriptor(hash_table);
+    return _next_full(table, _slot_index(table, slot) + 1);
+}
+
+const cmagic_memory_alloc_packet_t *
+cmagic_hash_table_get_alloc_packet(void *hash_table) {
+    return _get_table_descriptor(hash_table)->alloc_packet;
+}
@@ -0,0 +1,108 @@
+#ifndef CMAGIC_HASH_TABLE_H
+#define CMAGIC_HASH_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmagic/memory.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Open addressing hash table storing fixed-size slots inline in a single flat array. Every slot
+ * holds a key followed by an optional value. The state of every slot is kept in a separate array of
+ * control bytes: empty, deleted, or the 7 low bits of the hash of its key. Lookups scan groups of
+ * control bytes for the hash bits first, so keys are compared only on likely matches. Groups are
+ * probed quadratically. Keys and values are neither copied nor destroyed by the table.
+ */
+
+typedef size_t (*cmagic_hash_table_hash_function_t)(const void *key);
+
+// Returns true if both keys are equal, NULL means comparing the keys byte by byte
+typedef bool (*cmagic_hash_table_key_equal_t)(const void *key1, const void *key2);
+
+// Called for every occupied slot right before the table is cleared
+typedef void (*cmagic_hash_table_clear_callback_t)(void *slot, void *context);
+
+// Initializes a new slot from the source slot when the table is copied
+typedef void (*cmagic_hash_table_copy_callback_t)(void *destination, const void *source,
+                                                  void *context);
+
+/*
+ * Moves a slot to uninitialized memory when the table grows. The source slot is released
+ * afterwards without any further call. Functions which may grow the table take it together with
+ * its context, NULL means moving the slots byte by byte.
+ */
+typedef void (*cmagic_hash_table_relocate_t)(void *destination, void *source, void *context);
+
+typedef struct {
+    void *slot; // NULL if the allocation has failed
+    bool already_exists;
+} cmagic_hash_table_insert_result_t;
+
+void *
+cmagic_hash_table_new(size_t key_size, size_t value_size,
+                      cmagic_hash_table_hash_function_t hash_function,
+                      cmagic_hash_table_key_equal_t key_equal,
+                      const cmagic_memory_alloc_packet_t *alloc_packet);
+
+void
+cmagic_hash_table_free(void *hash_table);
+
+/*
+ * Returns the slot of the key, claiming a new one if the key is not present. A new slot is left
+ * uninitialized and its key has to be written before the table is used again.
+ */
+cmagic_hash_table_insert_result_t
+cmagic_hash_table_insert(void *hash_table, const void *key, cmagic_hash_table_relocate_t relocate,
+                         void *context);
+
+void *
+cmagic_hash_table_find(void *hash_table, const void *key);
+
+void
+cmagic_hash_table_erase_slot(void *hash_table, void *slot);
+
+// Makes room for the given number of elements, so inserting them doesn't rehash the table
+bool
+cmagic_hash_table_reserve(void *hash_table, size_t count, cmagic_hash_table_relocate_t relocate,
+                          void *context);
+
+void
+cmagic_hash_table_clear(void *hash_table, cmagic_hash_table_clear_callback_t callback,
+                        void *context);
+
+/*
+ * Creates a table with the same capacity and the same slot positions, so nothing is hashed. Slots
+ * are copied byte by byte if no callback is given.
+ */
+void *
+cmagic_hash_table_copy(void *hash_table, cmagic_hash_table_copy_callback_t copy_callback,
+                       void *context);
+
+size_t
+cmagic_hash_table_size(void *hash_table);
+
+size_t
+cmagic_hash_table_capacity(void *hash_table);
+
+// Offset of the value from the beginning of its slot
+size_t
+cmagic_hash_table_value_offset(void *hash_table);
+
+// Occupied slots are visited in the order of the slot array, NULL marks the end
+void *
+cmagic_hash_table_first(void *hash_table);
+
+void *
+cmagic_hash_table_next(void *hash_table, void *slot);
+
+const cmagic_memory_alloc_packet_t *
+cmagic_hash_table_get_alloc_packet(void *hash_table);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_HASH_TABLE_H */
@@ -0,0 +1,60 @@
+#ifndef CMAGIC_KEY_COMPARATORS_H
+#define CMAGIC_KEY_COMPARATORS_H
+
+#include <stdint.h>
+#include "cmagic/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Inline versions of the built-in comparators from utils.h. The public comparators in utils.c are
+ * defined through them, so the engines order the keys exactly like the comparators they replace.
+ */
+static inline int cmagic_tree_engine_compare_int32(const void *key1, const void *key2) {
+    const int32_t value1 = *(const int32_t *)key1;
+    const int32_t value2 = *(const int32_t *)key2;
+    return (value1 > value2) - (value1 < value2);
+}
+
+static inline int cmagic_tree_engine_compare_uint32(const void *key1, const void *key2) {
+    const uint32_t value1 = *(const uint32_t *)key1;
+    const uint32_t value2 = *(const uint32_t *)key2;
+    return (value1 > value2) - (value1 < value2);
+}
+
+static inline int cmagic_tree_engine_compare_int64(const void *key1, const void *key2) {
+    const int64_t value1 = *(const int64_t *)key1;
+    const int64_t value2 = *(const int64_t *)key2;
+    return (value1 > value2) - (value1 < value2);
+}
+
+static inline int cmagic_tree_engine_compare_uint64(const void *key1, const void *key2) {
+    const uint64_t value1 = *(const uint64_t *)key1;
+    const uint64_t value2 = *(const uint64_t *)key2;
+    return (value1 > value2) - (value1 < value2);
+}
+
+/*
+ * Calls the function with the given arguments followed by the key comparator. A built-in
+ * comparator is replaced by its inline version, so once the compiler inlines the function into
+ * each branch, its search loop compares the keys without any call. The function should therefore
+ * be small and declared inline.
+ */
+#define CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(function, key_comparator, ...) \
+    ((key_comparator) == cmagic_utils_compare_int32 \
+        ? function(__VA_ARGS__, cmagic_tree_engine_compare_int32) \
+    : (key_comparator) == cmagic_utils_compare_uint32 \
+        ? function(__VA_ARGS__, cmagic_tree_engine_compare_uint32) \
+    : (key_comparator) == cmagic_utils_compare_int64 \
+        ? function(__VA_ARGS__, cmagic_tree_engine_compare_int64) \
+    : (key_comparator) == cmagic_utils_compare_uint64 \
+        ? function(__VA_ARGS__, cmagic_tree_engine_compare_uint64) \
+    : function(__VA_ARGS__, (key_comparator)))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_KEY_COMPARATORS_H */
@@ -0,0 +1,116 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+#include "key_comparators.h"
+#include "sorted_array.h"
+
+// Runs of this many indices are sorted by insertion before they are merged
+#define INSERTION_SORT_RUN ((size_t)16)
+
+
+/*
+ * Halves the range without any branch depending on the comparison, so the compiler can turn it into
+ * a conditional move. The last comparison decides between the two remaining positions. The upper
+ * bound passes over the keys equal to the searched one as well.
+ */
+static inline size_t _bound_with(const char *keys, size_t count, size_t key_size, const void *key,
+                                 bool upper, cmagic_sorted_array_comparator_t comparator) {
+    if (count == 0) {
+        return 0;
+    }
+
+    const char *base = keys;
+    while (count > 1) {
+        const size_t half = count / 2;
+        const int comparison_result = comparator(base + half * key_size, key);
+        base = (comparison_result < 0 || (upper && comparison_result == 0))
+            ? base + half * key_size : base;
+        count -= half;
+    }
+
+    const int comparison_result = comparator(base, key);
+    const size_t index = (size_t)(base - keys) / key_size;
+    return index + (comparison_result < 0 || (upper && comparison_result == 0));
+}
+
+size_t
+cmagic_sorted_array_lower_bound(const void *keys, size_t count, size_t key_size, const void *key,
+                                cmagic_sorted_array_comparator_t comparator) {
+    return CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(_bound_with, comparator, (const char *)keys,
+                                                   count, key_size, key, false);
+}
+
+size_t
+cmagic_sorted_array_upper_bound(const void *keys, size_t count, size_t key_size, const void *key,
+                                cmagic_sorted_array_comparator_t comparator) {
+    return CMAGIC_TREE_ENGINE_CALL_WITH_COMPARATOR(_bound_with, comparator, (const char *)keys,
+                                                   count, key_size, key, true);
+}
+
+static void _insertion_sort(const char *keys, size_t key_size, size_t *indices, size_t count,
+                            cmagic_sorted_array_comparator_t comparator) {
+    for (size_t i = 1; i < count; i++) {
+        const size_t index = indices[i];
+        size_t j = i;
+        // Only strictly greater keys are passed over, which keeps equal keys in their order
+        while (j > 0 && comparator(keys + indices[j - 1] * key_size, keys + index * key_size) > 0) {
+            indices[j] = indices[j - 1];
+            j--;
+        }
+        indices[j] = index;
+    }
+}
+
+static void _merge(const char *keys, size_t key_size, const size_t *left, size_t left_count,
+                   const size_t *right, size_t right_count, size_t *destination,
+                   cmagic_sorted_array_comparator_t comparator) {
+    while (left_count > 0 && right_count > 0) {
+        // Equal keys are taken from the left run first
+        if (comparator(keys + *right * key_size, keys + *left * key_size) < 0) {
+            *destination++ = *right++;
+            right_count--;
+        } else {
+            *destination++ = *left++;
+            left_count--;
+        }
+    }
+
+    memcpy(destination, left, left_count * sizeof(size_t));
+    memcpy(destination + left_count, right, right_count * sizeof(size_t));
+}
+
+void
+cmagic_sorted_array_sort_indices(const void *keys, size_t key_size, size_t *indices,
+                                 size_t *buffer, size_t count,
+                                 cmagic_sorted_array_comparator_t comparator) {
+    assert(key_size > 0);
+    assert(comparator);
+    assert(count == 0 || (indices && buffer));
+
+    const char *key_bytes = (const char *)keys;
+    for (size_t begin = 0; begin < count; begin += INSERTION_SORT_RUN) {
+        const size_t run_count = count - begin < INSERTION_SORT_RUN
+            ? count - begin : INSERTION_SORT_RUN;
+        _insertion_sort(key_bytes, key_size, indices + begin, run_count, comparator);
+    }
+
+    // Sorted runs are merged bottom up, alternating between the indices and the buffer
+    size_t *source = indices;
+    size_t *destination = buffer;
+    for (size_t width = INSERTION_SORT_RUN; width < count; width *= 2) {
+        for (size_t begin = 0; begin < count; begin += 2 * width) {
+            const size_t middle = count - begin < width ? count : begin + width;
+            const size_t end = count - middle < width ? count : middle + width;
+            _merge(key_bytes, key_size, source + begin, middle - begin, source + middle,
+                   end - middle, destination + begin, comparator);
+        }
+
+        size_t *merged = destination;
+        destination = source;
+        source = merged;
+    }
+
+    if (source != indices) {
+        memcpy(indices, source, count * sizeof(size_t));
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef CMAGIC_SORTED_ARRAY_H
+#define CMAGIC_SORTED_ARRAY_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Algorithms on arrays of fixed-size keys kept in ascending order, the storage of the flat
+ * containers. Keys are ordered by the comparators of the ordered containers. The arrays are owned
+ * by the caller, none of the functions allocates memory.
+ */
+
+typedef int (*cmagic_sorted_array_comparator_t)(const void *key1, const void *key2);
+
+// Returns the index of the first key not less than the given key, count if there is none
+size_t
+cmagic_sorted_array_lower_bound(const void *keys, size_t count, size_t key_size, const void *key,
+                                cmagic_sorted_array_comparator_t comparator);
+
+// Returns the index of the first key greater than the given key, count if there is none
+size_t
+cmagic_sorted_array_upper_bound(const void *keys, size_t count, size_t key_size, const void *key,
+                                cmagic_sorted_array_comparator_t comparator);
+
+/*
+ * Sorts indices of an unordered key array by the keys they refer to. The sort is stable, so indices
+ * of equal keys stay in ascending order. The buffer must have room for count indices, its content
+ * is overwritten.
+ */
+void
+cmagic_sorted_array_sort_indices(const void *keys, size_t key_size, size_t *indices,
+                                 size_t *buffer, size_t count,
+                                 cmagic_sorted_array_comparator_t comparator);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_SORTED_ARRAY_H */
@@ -0,0 +1,209 @@
+#include <assert.h>
+#include <string.h>
+#include "avl_tree.h"
+#include "b_tree.h"
+#include "compact_tree.h"
+#include "tree_engine.h"
+
+static uintptr_t _get_engine_tag(cmagic_tree_iterator_t iterator) {
+    assert(iterator);
+    uintptr_t tagged_word;
+    memcpy(&tagged_word, (const char *)iterator + sizeof(*iterator), sizeof(tagged_word));
+    return tagged_word & CMAGIC_TREE_ENGINE_TAG_MASK;
+}
+
+cmagic_tree_iterator_t
+cmagic_tree_engine_iterator_next(cmagic_tree_iterator_t iterator) {
+    if (!iterator) {
+        return NULL;
+    }
+
+    switch (_get_engine_tag(iterator)) {
+    case CMAGIC_TREE_ENGINE_TAG_B_TREE:
+        return cmagic_b_tree_iterator_next(iterator);
+    case CMAGIC_TREE_ENGINE_TAG_COMPACT_TREE:
+        return cmagic_compact_tree_iterator_next(iterator);
+    default:
+        assert(_get_engine_tag(iterator) == CMAGIC_TREE_ENGINE_TAG_AVL_TREE);
+        return cmagic_avl_tree_iterator_next(iterator);
+    }
+}
+
+cmagic_tree_iterator_t
+cmagic_tree_engine_iterator_prev(cmagic_tree_iterator_t iterator) {
+    if (!iterator) {
+        return NULL;
+    }
+
+    switch (_get_engine_tag(iterator)) {
+    case CMAGIC_TREE_ENGINE_TAG_B_TREE:
+        return cmagic_b_tree_iterator_prev(iterator);
+    case CMAGIC_TREE_ENGINE_TAG_COMPACT_TREE:
+        return cmagic_compact_tree_iterator_prev(iterator);
+    default:
+        assert(_get_engine_tag(iterator) == CMAGIC_TREE_ENGINE_TAG_AVL_TREE);
+        return cmagic_avl_tree_iterator_prev(iterator);
+    }
+}
+
+void
+cmagic_tree_engine_free_node(cmagic_tree_iterator_t node,
+                             const cmagic_memory_alloc_packet_t *alloc_packet) {
+    // Only the AVL tree supports detached nodes
+    assert(_get_engine_tag(node) == CMAGIC_TREE_ENGINE_TAG_AVL_TREE);
+    cmagic_avl_tree_free_node(node, alloc_packet);
+}
+
+/*
+ * Collects the elements of the tree followed by the elements of the right tree, if any. Returns
+ * NULL if the allocation has failed.
+ */
+static cmagic_tree_element_t *_collect_elements(const cmagic_tree_engine_t *engine, void *tree,
+                                                void *right_tree, size_t *count) {
+    const size_t size = engine->size_function(tree);
+    const size_t right_size = right_tree ? engine->size_function(right_tree) : 0;
+    const cmagic_memory_alloc_packet_t *alloc_packet = engine->get_alloc_packet_function(tree);
+    cmagic_tree_element_t *elements = (cmagic_tree_element_t *)alloc_packet->malloc_function(
+        (size + right_size) * sizeof(cmagic_tree_element_t));
+    if (!elements) {
+        return NULL;
+    }
+
+    *count = 0;
+    for (cmagic_tree_iterator_t it = engine->first_function(tree);
+         it;
+         it = cmagic_tree_engine_iterator_next(it)) {
+        elements[(*count)++] = *it;
+    }
+    for (cmagic_tree_iterator_t it = right_tree ? engine->first_function(right_tree) : NULL;
+         it;
+         it = cmagic_tree_engine_iterator_next(it)) {
+        elements[(*count)++] = *it;
+    }
+    assert(*count == size + right_size);
+    return elements;
+}
+
+static void *_build_tree(const cmagic_tree_engine_t *engine,
+                         cmagic_tree_key_comparator_t key_comparator, size_t key_size,
+                         const cmagic_memory_alloc_packet_t *alloc_packet,
+                         const cmagic_tree_element_t *elements, size_t count) {
+    void *tree = engine->new_function(key_comparator, key_size, alloc_packet);
+    if (tree && !engine->build_function(tree, elements, count)) {
+        engine->free_function(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+/*
+ * Replaces both trees with the trees built from the two parts of the elements. Only the old nodes
+ * are released, the keys and values are taken over by the new trees.
+ */
+static bool _rebuild_trees(const cmagic_tree_engine_t *engine,
+                           cmagic_tree_key_comparator_t key_comparator, size_t key_size,
+                           void **tree_ptr, void **right_tree_ptr, cmagic_tree_element_t *elements,
+                           size_t left_count, size_t right_count) {
+    const cmagic_memory_alloc_packet_t *alloc_packet = engine->get_alloc_packet_function(*tree_ptr);
+    void *tree = _build_tree(engine, key_comparator, key_size, alloc_packet, elements, left_count);
+    void *right_tree = tree ? _build_tree(engine, key_comparator, key_size, alloc_packet,
+                                          elements + left_count, right_count) : NULL;
+    alloc_packet->free_function(elements);
+    if (!right_tree) {
+        if (tree) {
+            engine->free_function(tree);
+        }
+        return false;
+    }
+
+    engine->free_function(*tree_ptr);
+    *tree_ptr = tree;
+    engine->free_function(*right_tree_ptr);
+    *right_tree_ptr = right_tree;
+    return true;
+}
+
+bool
+cmagic_tree_engine_split(const cmagic_tree_engine_t *engine,
+                         cmagic_tree_key_comparator_t key_comparator, size_t key_size,
+                         void **tree_ptr, const void *key, void **right_tree_ptr) {
+    assert(engine->size_function(*right_tree_ptr) == 0);
+    if (engine->split_function) {
+        return engine->split_function(*tree_ptr, key, *right_tree_ptr);
+    }
+    if (engine->size_function(*tree_ptr) == 0) {
+        return true;
+    }
+
+    size_t count;
+    cmagic_tree_element_t *elements = _collect_elements(engine, *tree_ptr, NULL, &count);
+    if (!elements) {
+        return false;
+    }
+
+    size_t left_count = 0;
+    while (left_count < count && key_comparator(elements[left_count].key, key) < 0) {
+        left_count++;
+    }
+    return _rebuild_trees(engine, key_comparator, key_size, tree_ptr, right_tree_ptr, elements,
+                          left_count, count - left_count);
+}
+
+bool
+cmagic_tree_engine_join(const cmagic_tree_engine_t *engine,
+                        cmagic_tree_key_comparator_t key_comparator, size_t key_size,
+                        void **tree_ptr, void **right_tree_ptr) {
+    if (engine->join_function) {
+        return engine->join_function(*tree_ptr, *right_tree_ptr);
+    }
+    if (engine->size_function(*right_tree_ptr) == 0) {
+        return true;
+    }
+
+    size_t count;
+    cmagic_tree_element_t *elements =
+        _collect_elements(engine, *tree_ptr, *right_tree_ptr, &count);
+    if (!elements) {
+        return false;
+    }
+    return _rebuild_trees(engine, key_comparator, key_size, tree_ptr, right_tree_ptr, elements,
+                          count, 0);
+}
+
+void *
+cmagic_tree_engine_clone(const cmagic_tree_engine_t *engine,
+                         cmagic_tree_key_comparator_t key_comparator, size_t key_size, void *tree,
+                         cmagic_tree_copy_callback_t copy_callback,
+                         cmagic_tree_clear_callback_t clear_callback, void *context) {
+    assert(copy_callback);
+    assert(clear_callback);
+    if (engine->clone_function) {
+        return engine->clone_function(tree, copy_callback, clear_callback, context);
+    }
+
+    const cmagic_memory_alloc_packet_t *alloc_packet = engine->get_alloc_packet_function(tree);
+    if (engine->size_function(tree) == 0) {
+        return engine->new_function(key_comparator, key_size, alloc_packet);
+    }
+
+    size_t count;
+    cmagic_tree_element_t *elements = _collect_elements(engine, tree, NULL, &count);
+    if (!elements) {
+        return NULL;
+    }
+
+    size_t copied = 0;
+    while (copied < count && copy_callback(&elements[copied], context)) {
+        copied++;
+    }
+    void *clone = copied == count
+        ? _build_tree(engine, key_comparator, key_size, alloc_packet, elements, count) : NULL;
+    if (!clone) {
+        for (size_t i = 0; i < copied; i++) {
+            clear_callback(elements[i].key, elements[i].value, context);
+        }
+    }
+
+    alloc_packet->free_function(elements);
+    return clone;
+}
@@ -0,0 +1,154 @@
+#ifndef CMAGIC_TREE_ENGINE_H
+#define CMAGIC_TREE_ENGINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cmagic/memory.h"
+#include "key_comparators.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int (*cmagic_tree_key_comparator_t)(const void *key1, const void *key2);
+
+/*
+ * Every engine iterator points to a structure which starts with the key and value pointers followed
+ * by a pointer-sized word. Two least significant bits of that word identify the engine owning the
+ * element, so the iterator can be advanced without knowing its container.
+ */
+typedef struct {
+    const void *key;
+    void *value;
+} cmagic_tree_element_t;
+
+typedef cmagic_tree_element_t *cmagic_tree_iterator_t;
+
+#define CMAGIC_TREE_ENGINE_TAG_MASK ((uintptr_t)3)
+#define CMAGIC_TREE_ENGINE_TAG_AVL_TREE ((uintptr_t)0) // aligned parent pointer
+#define CMAGIC_TREE_ENGINE_TAG_B_TREE ((uintptr_t)1)
+#define CMAGIC_TREE_ENGINE_TAG_COMPACT_TREE ((uintptr_t)2)
+
+typedef struct {
+    cmagic_tree_iterator_t inserted_or_existing;
+    bool already_exists;
+} cmagic_tree_insert_result_t;
+
+typedef struct {
+    cmagic_tree_iterator_t begin;
+    cmagic_tree_iterator_t end;
+} cmagic_tree_range_t;
+
+// Called for every element right before its removal by clear, elements are visited in no order
+typedef void (*cmagic_tree_clear_callback_t)(const void *key, void *value, void *context);
+
+/*
+ * Called for every element of a cloned tree with the element's key and value, which have to be
+ * replaced by their copies. Returns false if the copy could not be allocated.
+ */
+typedef bool (*cmagic_tree_copy_callback_t)(cmagic_tree_element_t *element, void *context);
+
+/*
+ * Set of functions implementing an ordered associative tree. Used by map and set to select their
+ * internal data structure at run time.
+ */
+typedef struct {
+    /*
+     * Keys are copied byte by byte, so an engine may keep copies of the keys of the given size
+     * taken on insertion and compare them instead of the keys the elements point to.
+     */
+    void *(*new_function)(cmagic_tree_key_comparator_t key_comparator, size_t key_size,
+                          const cmagic_memory_alloc_packet_t *alloc_packet);
+    void (*free_function)(void *tree);
+    cmagic_tree_insert_result_t (*insert_function)(void *tree, const void *key, void *value);
+    // Points the element to another key comparing equal to its current key
+    void (*replace_key_function)(void *tree, cmagic_tree_iterator_t iterator, const void *new_key);
+    void (*erase_function)(void *tree, const void *key);
+    void (*clear_function)(void *tree, cmagic_tree_clear_callback_t callback, void *context);
+    /*
+     * Fills an empty tree with elements sorted in strictly ascending order, without comparisons.
+     * Their keys have to be initialized already, since they may be copied.
+     */
+    bool (*build_function)(void *tree, const cmagic_tree_element_t *elements, size_t count);
+    // Moves the elements not going before the key to an empty tree, optional
+    bool (*split_function)(void *tree, const void *key, void *right_tree);
+    // Moves all elements of a tree whose keys go after all keys of the first tree, optional
+    bool (*join_function)(void *tree, void *right_tree);
+    /*
+     * Creates a tree of the same shape holding copies of the elements, optional. On failure the
+     * copies made so far are released by the clear callback and NULL is returned.
+     */
+    void *(*clone_function)(void *tree, cmagic_tree_copy_callback_t copy_callback,
+                            cmagic_tree_clear_callback_t clear_callback, void *context);
+    // Detaches the element without freeing it, optional
+    cmagic_tree_iterator_t (*extract_function)(void *tree, const void *key);
+    // Links a node detached by the extract function, required if extract is available
+    cmagic_tree_insert_result_t (*insert_node_function)(void *tree, cmagic_tree_iterator_t node);
+    // Looks up many keys stored contiguously at once, optional
+    void (*find_batch_function)(void *tree, const void *keys, size_t key_size, size_t count,
+                                cmagic_tree_iterator_t *results);
+    size_t (*size_function)(void *tree);
+    cmagic_tree_iterator_t (*first_function)(void *tree);
+    cmagic_tree_iterator_t (*last_function)(void *tree);
+    cmagic_tree_iterator_t (*find_function)(void *tree, const void *key);
+    cmagic_tree_iterator_t (*lower_bound_function)(void *tree, const void *key);
+    cmagic_tree_iterator_t (*upper_bound_function)(void *tree, const void *key);
+    /*
+     * Bounds searched with a comparator given by the caller, which takes the searched key as its
+     * first argument. It may be of another type than the stored keys, as long as the comparator
+     * orders it consistently with the tree comparator.
+     */
+    cmagic_tree_iterator_t (*lower_bound_by_function)(void *tree, const void *key,
+                                                      cmagic_tree_key_comparator_t key_comparator);
+    cmagic_tree_iterator_t (*upper_bound_by_function)(void *tree, const void *key,
+                                                      cmagic_tree_key_comparator_t key_comparator);
+    cmagic_tree_range_t (*equal_range_function)(void *tree, const void *key);
+    const cmagic_memory_alloc_packet_t *(*get_alloc_packet_function)(void *tree);
+} cmagic_tree_engine_t;
+
+extern const cmagic_tree_engine_t CMAGIC_TREE_ENGINE_AVL_TREE;
+extern const cmagic_tree_engine_t CMAGIC_TREE_ENGINE_B_TREE;
+extern const cmagic_tree_engine_t CMAGIC_TREE_ENGINE_COMPACT_TREE;
+
+cmagic_tree_iterator_t
+cmagic_tree_engine_iterator_next(cmagic_tree_iterator_t iterator);
+
+cmagic_tree_iterator_t
+cmagic_tree_engine_iterator_prev(cmagic_tree_iterator_t iterator);
+
+// Releases a node detached by the extract function of any engine
+void
+cmagic_tree_engine_free_node(cmagic_tree_iterator_t node,
+                             const cmagic_memory_alloc_packet_t *alloc_packet);
+
+/*
+ * Split and join use the engine functions if available. Otherwise both trees are rebuilt from
+ * scratch in linear time and replaced through the given handles. Return false if an allocation has
+ * failed, in which case both trees are unchanged.
+ */
+bool
+cmagic_tree_engine_split(const cmagic_tree_engine_t *engine,
+                         cmagic_tree_key_comparator_t key_comparator, size_t key_size,
+                         void **tree_ptr, const void *key, void **right_tree_ptr);
+
+bool
+cmagic_tree_engine_join(const cmagic_tree_engine_t *engine,
+                        cmagic_tree_key_comparator_t key_comparator, size_t key_size,
+                        void **tree_ptr, void **right_tree_ptr);
+
+/*
+ * Clone uses the engine function if available. Otherwise the copied elements are collected in
+ * order and a new tree is built from them in linear time.
+ */
+void *
+cmagic_tree_engine_clone(const cmagic_tree_engine_t *engine,
+                         cmagic_tree_key_comparator_t key_comparator, size_t key_size, void *tree,
+                         cmagic_tree_copy_callback_t copy_callback,
+                         cmagic_tree_clear_callback_t clear_callback, void *context);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* CMAGIC_TREE_ENGINE_H */
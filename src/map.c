@@ -1,79 +1,146 @@
 #include <stdint.h>
 #include <string.h>
 #include "cmagic/map.h"
-#include "avl_tree.h"
+#include "tree_engine.h"
 
 #ifndef NDEBUG
 static const int_least32_t MAP_MAGIC_VALUE = 'M' << 16 | 'A' << 8 | 'P';
+static const int_least32_t EMBEDDED_MAP_MAGIC_VALUE = 'E' << 24 | 'M' << 16 | 'A' << 8 | 'P';
 #endif
 
 
+// The internal tree is NULL until the first element is inserted
 typedef struct {
 #ifndef NDEBUG
     int_least32_t magic_value;
 #endif
-    void *internal_avl_tree;
+    const cmagic_tree_engine_t *engine;
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+    void *internal_tree;
+    cmagic_map_key_comparator_t key_comparator;
     size_t key_size;
     size_t value_size;
 } map_descriptor_t;
 
+_Static_assert(sizeof(map_descriptor_t) <= sizeof(cmagic_map_storage_t),
+               "map storage is too small");
+_Static_assert(_Alignof(map_descriptor_t) <= _Alignof(cmagic_map_storage_t),
+               "map storage is not aligned enough");
 
-void *
-cmagic_map_new(size_t key_size, size_t value_size, cmagic_map_key_comparator_t key_comparator,
-               const cmagic_memory_alloc_packet_t *alloc_packet) {
+
+static const cmagic_tree_engine_t *_get_tree_engine(cmagic_map_engine_t engine) {
+    switch (engine) {
+    case CMAGIC_MAP_ENGINE_B_TREE:
+        return &CMAGIC_TREE_ENGINE_B_TREE;
+    case CMAGIC_MAP_ENGINE_COMPACT_TREE:
+        return &CMAGIC_TREE_ENGINE_COMPACT_TREE;
+    default:
+        assert(engine == CMAGIC_MAP_ENGINE_AVL_TREE);
+        return &CMAGIC_TREE_ENGINE_AVL_TREE;
+    }
+}
+
+static void _init_map_descriptor(map_descriptor_t *map_desc, size_t key_size, size_t value_size,
+                                 cmagic_map_key_comparator_t key_comparator,
+                                 const cmagic_memory_alloc_packet_t *alloc_packet,
+                                 cmagic_map_engine_t engine) {
     assert(key_size > 0);
     assert(value_size > 0);
     assert(key_comparator);
     assert(alloc_packet);
-
-    map_descriptor_t *map_desc =
-        (map_descriptor_t *) alloc_packet->malloc_function(sizeof(map_descriptor_t));
-    if (!map_desc) {
-        return NULL;
-    }
-
     *map_desc = (map_descriptor_t) {
 #ifndef NDEBUG
         .magic_value = MAP_MAGIC_VALUE,
 #endif
-        .internal_avl_tree = cmagic_avl_tree_new(key_comparator, alloc_packet),
+        .engine = _get_tree_engine(engine),
+        .alloc_packet = alloc_packet,
+        .internal_tree = NULL,
+        .key_comparator = key_comparator,
         .key_size = key_size,
         .value_size = value_size
     };
+}
 
-    if (!map_desc->internal_avl_tree) {
-        alloc_packet->free_function(map_desc);
+void *
+cmagic_map_new_ext(size_t key_size, size_t value_size, cmagic_map_key_comparator_t key_comparator,
+                   const cmagic_memory_alloc_packet_t *alloc_packet, cmagic_map_engine_t engine) {
+    map_descriptor_t *map_desc =
+        (map_descriptor_t *) alloc_packet->malloc_function(sizeof(map_descriptor_t));
+    if (!map_desc) {
         return NULL;
     }
 
+    _init_map_descriptor(map_desc, key_size, value_size, key_comparator, alloc_packet, engine);
     return (void *)map_desc;
 }
 
+void *
+cmagic_map_init_ext(cmagic_map_storage_t *storage, size_t key_size, size_t value_size,
+                    cmagic_map_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet, cmagic_map_engine_t engine) {
+    assert(storage);
+    map_descriptor_t *map_desc = (map_descriptor_t *)storage;
+    _init_map_descriptor(map_desc, key_size, value_size, key_comparator, alloc_packet, engine);
+#ifndef NDEBUG
+    map_desc->magic_value = EMBEDDED_MAP_MAGIC_VALUE;
+#endif
+    return (void *)map_desc;
+}
+
+void *
+cmagic_map_new(size_t key_size, size_t value_size, cmagic_map_key_comparator_t key_comparator,
+               const cmagic_memory_alloc_packet_t *alloc_packet) {
+    return cmagic_map_new_ext(key_size, value_size, key_comparator, alloc_packet,
+                              CMAGIC_MAP_ENGINE_AVL_TREE);
+}
+
 static map_descriptor_t *_get_map_descriptor(void *map_ptr) {
     assert(map_ptr);
     map_descriptor_t *result = (map_descriptor_t *)map_ptr;
-    assert(result->magic_value == MAP_MAGIC_VALUE);
+    assert(result->magic_value == MAP_MAGIC_VALUE
+           || result->magic_value == EMBEDDED_MAP_MAGIC_VALUE);
     return result;
 }
 
 static const cmagic_memory_alloc_packet_t *_get_alloc_packet(map_descriptor_t *map_desc) {
-    return cmagic_avl_tree_get_alloc_packet(map_desc->internal_avl_tree);
+    return map_desc->alloc_packet;
+}
+
+// Creates the internal tree before the first insertion
+static bool _ensure_internal_tree(map_descriptor_t *map_desc) {
+    if (!map_desc->internal_tree) {
+        map_desc->internal_tree = map_desc->engine->new_function(
+            map_desc->key_comparator, map_desc->key_size, map_desc->alloc_packet);
+    }
+    return map_desc->internal_tree != NULL;
+}
+
+void
+cmagic_map_destroy(void *map_ptr) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    if (map_desc->internal_tree) {
+        cmagic_map_clear(map_ptr);
+        map_desc->engine->free_function(map_desc->internal_tree);
+        map_desc->internal_tree = NULL;
+    }
 }
 
 void
 cmagic_map_free(void *map_ptr) {
     map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
-    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(map_desc);
-    cmagic_map_clear(map_ptr);
-    cmagic_avl_tree_free(map_desc->internal_avl_tree);
-    alloc_packet->free_function(map_desc);
+    assert(map_desc->magic_value == MAP_MAGIC_VALUE);
+    cmagic_map_destroy(map_ptr);
+    _get_alloc_packet(map_desc)->free_function(map_desc);
 }
 
 cmagic_map_insert_result_t
 cmagic_map_allocate(void *map_ptr, const void *key) {
     map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
-    cmagic_avl_tree_insert_result_t tree_result =
-        cmagic_avl_tree_insert(map_desc->internal_avl_tree, key, NULL);
+    if (!_ensure_internal_tree(map_desc)) {
+        return (cmagic_map_insert_result_t) { .inserted_or_existing = NULL };
+    }
+    cmagic_tree_insert_result_t tree_result =
+        map_desc->engine->insert_function(map_desc->internal_tree, key, NULL);
     cmagic_map_insert_result_t result = {
         .inserted_or_existing = (cmagic_map_iterator_t)tree_result.inserted_or_existing,
         .already_exists = tree_result.already_exists
@@ -86,20 +153,22 @@ cmagic_map_allocate(void *map_ptr, const void *key) {
     const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(map_desc);
     const void *allocated_key = alloc_packet->malloc_function(map_desc->key_size);
     if (!allocated_key) {
-        cmagic_avl_tree_erase(map_desc->internal_avl_tree, key);
+        map_desc->engine->erase_function(map_desc->internal_tree, key);
         result.inserted_or_existing = NULL;
         return result;
     }
 
     void *allocated_value = alloc_packet->malloc_function(map_desc->value_size);
     if (!allocated_value) {
-        cmagic_avl_tree_erase(map_desc->internal_avl_tree, key);
+        map_desc->engine->erase_function(map_desc->internal_tree, key);
         result.inserted_or_existing = NULL;
         alloc_packet->free_function((void *)allocated_key);
         return result;
     }
 
-    result.inserted_or_existing->key = allocated_key;
+    map_desc->engine->replace_key_function(map_desc->internal_tree,
+                                          (cmagic_tree_iterator_t)result.inserted_or_existing,
+                                          allocated_key);
     result.inserted_or_existing->value = allocated_value;
     return result;
 }
@@ -119,14 +188,13 @@ cmagic_map_insert(void *map_ptr, const void *key, const void *value) {
     return result;
 }
 
-void
-cmagic_map_erase(void *map_ptr, const void *key, cmagic_map_erase_destructor_t destructor) {
-    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
-    cmagic_avl_tree_iterator_t found = cmagic_avl_tree_find(map_desc->internal_avl_tree, key);
+// The stored key is still alive during the erasure, so it serves as the key to be searched for
+static void _erase_found(map_descriptor_t *map_desc, cmagic_tree_iterator_t found,
+                         cmagic_map_erase_destructor_t destructor) {
     if (found) {
         const void *key_to_delete = found->key;
         void *value_to_delete = found->value;
-        cmagic_avl_tree_erase(map_desc->internal_avl_tree, key);
+        map_desc->engine->erase_function(map_desc->internal_tree, key_to_delete);
         if (destructor) {
             destructor((void *)key_to_delete, value_to_delete);
         }
@@ -136,52 +204,478 @@ cmagic_map_erase(void *map_ptr, const void *key, cmagic_map_erase_destructor_t d
     }
 }
 
+void
+cmagic_map_erase(void *map_ptr, const void *key, cmagic_map_erase_destructor_t destructor) {
+    cmagic_tree_iterator_t found = (cmagic_tree_iterator_t)cmagic_map_find(map_ptr, key);
+    _erase_found(_get_map_descriptor(map_ptr), found, destructor);
+}
+
+static cmagic_tree_iterator_t _find_by(map_descriptor_t *map_desc, const void *key,
+                                       cmagic_map_key_comparator_t key_comparator) {
+    assert(key_comparator);
+    if (!map_desc->internal_tree) {
+        return NULL;
+    }
+    cmagic_tree_iterator_t lower =
+        map_desc->engine->lower_bound_by_function(map_desc->internal_tree, key, key_comparator);
+    return lower && key_comparator(key, lower->key) == 0 ? lower : NULL;
+}
+
+void
+cmagic_map_erase_by(void *map_ptr, const void *key, cmagic_map_key_comparator_t key_comparator,
+                    cmagic_map_erase_destructor_t destructor) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    _erase_found(map_desc, _find_by(map_desc, key, key_comparator), destructor);
+}
+
+cmagic_map_node_t
+cmagic_map_extract(void *map_ptr, const void *key) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    assert(map_desc->engine->extract_function);
+    if (!map_desc->internal_tree) {
+        return NULL;
+    }
+    return (cmagic_map_node_t)map_desc->engine->extract_function(map_desc->internal_tree, key);
+}
+
+cmagic_map_insert_result_t
+cmagic_map_insert_node(void *map_ptr, cmagic_map_node_t node) {
+    assert(node);
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    assert(map_desc->engine->insert_node_function);
+    if (!_ensure_internal_tree(map_desc)) {
+        return (cmagic_map_insert_result_t) { .inserted_or_existing = NULL };
+    }
+
+    cmagic_tree_insert_result_t tree_result = map_desc->engine->insert_node_function(
+        map_desc->internal_tree, (cmagic_tree_iterator_t)node);
+    return (cmagic_map_insert_result_t) {
+        .inserted_or_existing = (cmagic_map_iterator_t)tree_result.inserted_or_existing,
+        .already_exists = tree_result.already_exists
+    };
+}
+
+void
+cmagic_map_node_free(cmagic_map_node_t node, const cmagic_memory_alloc_packet_t *alloc_packet,
+                     cmagic_map_erase_destructor_t destructor) {
+    assert(node);
+    assert(alloc_packet);
+    if (destructor) {
+        destructor((void *)node->key, node->value);
+    }
+    alloc_packet->free_function((void *)node->key);
+    alloc_packet->free_function(node->value);
+    cmagic_tree_engine_free_node((cmagic_tree_iterator_t)node, alloc_packet);
+}
+
+typedef struct {
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+    cmagic_map_erase_destructor_t destructor;
+} clear_context_t;
+
+static void _clear_callback(const void *key, void *value, void *context) {
+    const clear_context_t *clear_context = (const clear_context_t *)context;
+    if (clear_context->destructor) {
+        clear_context->destructor((void *)key, value);
+    }
+    clear_context->alloc_packet->free_function((void *)key);
+    clear_context->alloc_packet->free_function(value);
+}
+
+void
+cmagic_map_clear_ext(void *map_ptr, cmagic_map_erase_destructor_t destructor) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    if (!map_desc->internal_tree) {
+        return;
+    }
+    clear_context_t clear_context = {
+        .alloc_packet = _get_alloc_packet(map_desc),
+        .destructor = destructor
+    };
+    map_desc->engine->clear_function(map_desc->internal_tree, _clear_callback, &clear_context);
+}
+
 void
 cmagic_map_clear(void *map_ptr) {
+    cmagic_map_clear_ext(map_ptr, NULL);
+}
+
+typedef struct {
+    clear_context_t clear_context;
+    cmagic_map_copy_function_t copy;
+    size_t key_size;
+    size_t value_size;
+} copy_context_t;
+
+static bool _copy_callback(cmagic_tree_element_t *element, void *context) {
+    const copy_context_t *copy_context = (const copy_context_t *)context;
+    const cmagic_memory_alloc_packet_t *alloc_packet = copy_context->clear_context.alloc_packet;
+    void *key = alloc_packet->malloc_function(copy_context->key_size);
+    if (!key) {
+        return false;
+    }
+    void *value = alloc_packet->malloc_function(copy_context->value_size);
+    if (!value) {
+        alloc_packet->free_function(key);
+        return false;
+    }
+
+    if (copy_context->copy) {
+        copy_context->copy(key, value, element->key, element->value);
+    } else {
+        memcpy(key, element->key, copy_context->key_size);
+        memcpy(value, element->value, copy_context->value_size);
+    }
+    element->key = key;
+    element->value = value;
+    return true;
+}
+
+static void _copy_rollback_callback(const void *key, void *value, void *context) {
+    _clear_callback(key, value, &((copy_context_t *)context)->clear_context);
+}
+
+void *
+cmagic_map_copy(void *map_ptr, cmagic_map_copy_function_t copy,
+                cmagic_map_erase_destructor_t destructor) {
     map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
     const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(map_desc);
-    for (cmagic_avl_tree_iterator_t it = cmagic_avl_tree_first(map_desc->internal_avl_tree);
-         it;
-         it = cmagic_avl_tree_iterator_next(it)) {
-        alloc_packet->free_function((void *)it->key);
-        alloc_packet->free_function(it->value);
+    map_descriptor_t *copy_desc =
+        (map_descriptor_t *)alloc_packet->malloc_function(sizeof(map_descriptor_t));
+    if (!copy_desc) {
+        return NULL;
     }
-    cmagic_avl_tree_clear(map_desc->internal_avl_tree);
+
+    copy_context_t copy_context = {
+        .clear_context = {
+            .alloc_packet = alloc_packet,
+            .destructor = destructor
+        },
+        .copy = copy,
+        .key_size = map_desc->key_size,
+        .value_size = map_desc->value_size
+    };
+    *copy_desc = *map_desc;
+#ifndef NDEBUG
+    copy_desc->magic_value = MAP_MAGIC_VALUE;
+#endif
+    if (!map_desc->internal_tree) {
+        return (void *)copy_desc;
+    }
+    copy_desc->internal_tree =
+        cmagic_tree_engine_clone(map_desc->engine, map_desc->key_comparator, map_desc->key_size,
+                                 map_desc->internal_tree, _copy_callback,
+                                 _copy_rollback_callback, &copy_context);
+    if (!copy_desc->internal_tree) {
+        alloc_packet->free_function(copy_desc);
+        return NULL;
+    }
+
+    return (void *)copy_desc;
+}
+
+/*
+ * Builds a new internal tree of the map from the sorted elements. The old tree is replaced only
+ * if the whole operation succeeds.
+ */
+static void *_build_internal_tree(map_descriptor_t *map_desc,
+                                  const cmagic_tree_element_t *elements, size_t count) {
+    void *tree = map_desc->engine->new_function(map_desc->key_comparator, map_desc->key_size,
+                                                _get_alloc_packet(map_desc));
+    if (tree && !map_desc->engine->build_function(tree, elements, count)) {
+        map_desc->engine->free_function(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+bool
+cmagic_map_merge(void *map_ptr, void *source_map_ptr) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    map_descriptor_t *source_desc = _get_map_descriptor(source_map_ptr);
+    assert(map_desc->key_size == source_desc->key_size);
+    assert(map_desc->value_size == source_desc->value_size);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(map_desc);
+    assert(alloc_packet->malloc_function == _get_alloc_packet(source_desc)->malloc_function);
+    assert(alloc_packet->free_function == _get_alloc_packet(source_desc)->free_function);
+
+    const size_t size = cmagic_map_size(map_ptr);
+    const size_t source_size = cmagic_map_size(source_map_ptr);
+    if (source_size == 0) {
+        return true;
+    }
+    if (!map_desc->internal_tree && map_desc->engine == source_desc->engine) {
+        // All elements move, so the trees are swapped without allocation
+        map_desc->internal_tree = source_desc->internal_tree;
+        source_desc->internal_tree = NULL;
+        return true;
+    }
+    if (!_ensure_internal_tree(map_desc)) {
+        return false;
+    }
+
+    // Elements of both new trees share a single temporary allocation
+    cmagic_tree_element_t *merged = (cmagic_tree_element_t *)alloc_packet->malloc_function(
+        (size + 2 * source_size) * sizeof(cmagic_tree_element_t));
+    if (!merged) {
+        return false;
+    }
+    cmagic_tree_element_t *remaining = merged + size + source_size;
+    size_t merged_size = 0;
+    size_t remaining_size = 0;
+
+    cmagic_tree_iterator_t it = map_desc->engine->first_function(map_desc->internal_tree);
+    cmagic_tree_iterator_t source_it =
+        source_desc->engine->first_function(source_desc->internal_tree);
+    while (it || source_it) {
+        int comparison_result =
+            !it ? 1 : !source_it ? -1 : map_desc->key_comparator(it->key, source_it->key);
+        if (comparison_result <= 0) {
+            merged[merged_size++] = *it;
+            it = cmagic_tree_engine_iterator_next(it);
+        }
+        if (comparison_result == 0) {
+            remaining[remaining_size++] = *source_it;
+            source_it = cmagic_tree_engine_iterator_next(source_it);
+        } else if (comparison_result > 0) {
+            merged[merged_size++] = *source_it;
+            source_it = cmagic_tree_engine_iterator_next(source_it);
+        }
+    }
+
+    if (remaining_size == source_size) {
+        alloc_packet->free_function(merged);
+        return true;
+    }
+
+    void *merged_tree = _build_internal_tree(map_desc, merged, merged_size);
+    void *remaining_tree =
+        merged_tree ? _build_internal_tree(source_desc, remaining, remaining_size) : NULL;
+    alloc_packet->free_function(merged);
+    if (!remaining_tree) {
+        if (merged_tree) {
+            map_desc->engine->free_function(merged_tree);
+        }
+        return false;
+    }
+
+    // Keys and values are now owned by the new trees, only the old nodes are released
+    map_desc->engine->free_function(map_desc->internal_tree);
+    map_desc->internal_tree = merged_tree;
+    source_desc->engine->free_function(source_desc->internal_tree);
+    source_desc->internal_tree = remaining_tree;
+    return true;
+}
+
+static void _assert_compatible(map_descriptor_t *map_desc, map_descriptor_t *other_desc) {
+    (void)map_desc;
+    (void)other_desc;
+    assert(map_desc->engine == other_desc->engine);
+    assert(map_desc->key_size == other_desc->key_size);
+    assert(map_desc->value_size == other_desc->value_size);
+    assert(_get_alloc_packet(map_desc)->malloc_function ==
+           _get_alloc_packet(other_desc)->malloc_function);
+    assert(_get_alloc_packet(map_desc)->free_function ==
+           _get_alloc_packet(other_desc)->free_function);
+}
+
+bool
+cmagic_map_split(void *map_ptr, const void *key, void *right_map_ptr) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    map_descriptor_t *right_desc = _get_map_descriptor(right_map_ptr);
+    _assert_compatible(map_desc, right_desc);
+    if (!map_desc->internal_tree) {
+        return true;
+    }
+    if (!_ensure_internal_tree(right_desc)) {
+        return false;
+    }
+    return cmagic_tree_engine_split(map_desc->engine, map_desc->key_comparator, map_desc->key_size,
+                                    &map_desc->internal_tree, key, &right_desc->internal_tree);
+}
+
+bool
+cmagic_map_join(void *map_ptr, void *right_map_ptr) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    map_descriptor_t *right_desc = _get_map_descriptor(right_map_ptr);
+    _assert_compatible(map_desc, right_desc);
+    if (!right_desc->internal_tree) {
+        return true;
+    }
+    if (!map_desc->internal_tree) {
+        map_desc->internal_tree = right_desc->internal_tree;
+        right_desc->internal_tree = NULL;
+        return true;
+    }
+    return cmagic_tree_engine_join(map_desc->engine, map_desc->key_comparator, map_desc->key_size,
+                                   &map_desc->internal_tree, &right_desc->internal_tree);
 }
 
 size_t
 cmagic_map_size(void *map_ptr) {
-    return cmagic_avl_tree_size(_get_map_descriptor(map_ptr)->internal_avl_tree);
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    return map_desc->internal_tree ? map_desc->engine->size_function(map_desc->internal_tree) : 0;
 }
 
 cmagic_map_iterator_t
 cmagic_map_first(void *map_ptr) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    if (!map_desc->internal_tree) {
+        return NULL;
+    }
     return (cmagic_map_iterator_t)
-        cmagic_avl_tree_first(_get_map_descriptor(map_ptr)->internal_avl_tree);
+        map_desc->engine->first_function(map_desc->internal_tree);
 }
 
 cmagic_map_iterator_t
 cmagic_map_last(void *map_ptr) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    if (!map_desc->internal_tree) {
+        return NULL;
+    }
     return (cmagic_map_iterator_t)
-        cmagic_avl_tree_last(_get_map_descriptor(map_ptr)->internal_avl_tree);
+        map_desc->engine->last_function(map_desc->internal_tree);
 }
 
 cmagic_map_iterator_t
 cmagic_map_iterator_next(cmagic_map_iterator_t iterator) {
     return (cmagic_map_iterator_t)
-        cmagic_avl_tree_iterator_next((cmagic_avl_tree_iterator_t)iterator);
+        cmagic_tree_engine_iterator_next((cmagic_tree_iterator_t)iterator);
 }
 
 cmagic_map_iterator_t
 cmagic_map_iterator_prev(cmagic_map_iterator_t iterator) {
     return (cmagic_map_iterator_t)
-        cmagic_avl_tree_iterator_prev((cmagic_avl_tree_iterator_t)iterator);
+        cmagic_tree_engine_iterator_prev((cmagic_tree_iterator_t)iterator);
 }
 
 cmagic_map_iterator_t
 cmagic_map_find(void *map_ptr, const void *key) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    if (!map_desc->internal_tree) {
+        return NULL;
+    }
     return (cmagic_map_iterator_t)
-        cmagic_avl_tree_find(_get_map_descriptor(map_ptr)->internal_avl_tree, key);
+        map_desc->engine->find_function(map_desc->internal_tree, key);
+}
+
+// Engine results are converted to map iterators through a small buffer on the stack
+#define FIND_BATCH_CHUNK 64
+
+void
+cmagic_map_find_batch(void *map_ptr, const void *keys, size_t count,
+                      cmagic_map_iterator_t *out_iterators) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    assert(keys || count == 0);
+    assert(out_iterators || count == 0);
+    if (!map_desc->internal_tree) {
+        for (size_t i = 0; i < count; i++) {
+            out_iterators[i] = NULL;
+        }
+        return;
+    }
+    const char *key_bytes = (const char *)keys;
+
+    for (size_t chunk_start = 0; chunk_start < count; chunk_start += FIND_BATCH_CHUNK) {
+        const size_t chunk_size = CMAGIC_UTILS_MIN((size_t)FIND_BATCH_CHUNK, count - chunk_start);
+        const char *chunk_keys = key_bytes + chunk_start * map_desc->key_size;
+        cmagic_tree_iterator_t results[FIND_BATCH_CHUNK];
+        if (map_desc->engine->find_batch_function) {
+            map_desc->engine->find_batch_function(map_desc->internal_tree, chunk_keys,
+                                                  map_desc->key_size, chunk_size, results);
+        } else {
+            for (size_t i = 0; i < chunk_size; i++) {
+                results[i] = map_desc->engine->find_function(map_desc->internal_tree,
+                                                             chunk_keys + i * map_desc->key_size);
+            }
+        }
+
+        for (size_t i = 0; i < chunk_size; i++) {
+            out_iterators[chunk_start + i] = (cmagic_map_iterator_t)results[i];
+        }
+    }
+}
+
+cmagic_map_iterator_t
+cmagic_map_lower_bound(void *map_ptr, const void *key) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    if (!map_desc->internal_tree) {
+        return NULL;
+    }
+    return (cmagic_map_iterator_t)
+        map_desc->engine->lower_bound_function(map_desc->internal_tree, key);
+}
+
+cmagic_map_iterator_t
+cmagic_map_upper_bound(void *map_ptr, const void *key) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    if (!map_desc->internal_tree) {
+        return NULL;
+    }
+    return (cmagic_map_iterator_t)
+        map_desc->engine->upper_bound_function(map_desc->internal_tree, key);
+}
+
+cmagic_map_range_t
+cmagic_map_equal_range(void *map_ptr, const void *key) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    if (!map_desc->internal_tree) {
+        return (cmagic_map_range_t) { .begin = NULL, .end = NULL };
+    }
+    cmagic_tree_range_t tree_range =
+        map_desc->engine->equal_range_function(map_desc->internal_tree, key);
+    return (cmagic_map_range_t) {
+        .begin = (cmagic_map_iterator_t)tree_range.begin,
+        .end = (cmagic_map_iterator_t)tree_range.end
+    };
+}
+
+cmagic_map_iterator_t
+cmagic_map_find_by(void *map_ptr, const void *key, cmagic_map_key_comparator_t key_comparator) {
+    return (cmagic_map_iterator_t)_find_by(_get_map_descriptor(map_ptr), key, key_comparator);
+}
+
+cmagic_map_iterator_t
+cmagic_map_lower_bound_by(void *map_ptr, const void *key,
+                          cmagic_map_key_comparator_t key_comparator) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    if (!map_desc->internal_tree) {
+        return NULL;
+    }
+    return (cmagic_map_iterator_t)
+        map_desc->engine->lower_bound_by_function(map_desc->internal_tree, key, key_comparator);
+}
+
+cmagic_map_iterator_t
+cmagic_map_upper_bound_by(void *map_ptr, const void *key,
+                          cmagic_map_key_comparator_t key_comparator) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    if (!map_desc->internal_tree) {
+        return NULL;
+    }
+    return (cmagic_map_iterator_t)
+        map_desc->engine->upper_bound_by_function(map_desc->internal_tree, key, key_comparator);
+}
+
+cmagic_map_range_t
+cmagic_map_equal_range_by(void *map_ptr, const void *key,
+                          cmagic_map_key_comparator_t key_comparator) {
+    map_descriptor_t *map_desc = _get_map_descriptor(map_ptr);
+    assert(key_comparator);
+    if (!map_desc->internal_tree) {
+        return (cmagic_map_range_t) { .begin = NULL, .end = NULL };
+    }
+    cmagic_tree_iterator_t lower =
+        map_desc->engine->lower_bound_by_function(map_desc->internal_tree, key, key_comparator);
+    // Keys are unique, so the range holds at most one element
+    cmagic_tree_iterator_t upper = lower;
+    if (lower && key_comparator(key, lower->key) == 0) {
+        upper = cmagic_tree_engine_iterator_next(lower);
+    }
+    return (cmagic_map_range_t) {
+        .begin = (cmagic_map_iterator_t)lower,
+        .end = (cmagic_map_iterator_t)upper
+    };
 }
 
 const cmagic_memory_alloc_packet_t *
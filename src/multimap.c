@@ -0,0 +1,304 @@
+#include <stdint.h>
+#include <string.h>
+#include "cmagic/multimap.h"
+#include "avl_tree.h"
+
+#ifndef NDEBUG
+static const int_least32_t MULTIMAP_MAGIC_VALUE = 'M' << 16 | 'M' << 8 | 'P';
+#endif
+
+
+// Equal keys are supported by the AVL tree only, so unlike map the engine is fixed
+typedef struct {
+#ifndef NDEBUG
+    int_least32_t magic_value;
+#endif
+    void *internal_tree;
+    cmagic_map_key_comparator_t key_comparator;
+    size_t key_size;
+    size_t value_size;
+} multimap_descriptor_t;
+
+
+void *
+cmagic_multimap_new(size_t key_size, size_t value_size,
+                    cmagic_map_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet) {
+    assert(key_size > 0);
+    assert(value_size > 0);
+    assert(key_comparator);
+    assert(alloc_packet);
+
+    multimap_descriptor_t *multimap_desc =
+        (multimap_descriptor_t *) alloc_packet->malloc_function(sizeof(multimap_descriptor_t));
+    if (!multimap_desc) {
+        return NULL;
+    }
+
+    *multimap_desc = (multimap_descriptor_t) {
+#ifndef NDEBUG
+        .magic_value = MULTIMAP_MAGIC_VALUE,
+#endif
+        .internal_tree = cmagic_avl_tree_new(key_comparator, alloc_packet),
+        .key_comparator = key_comparator,
+        .key_size = key_size,
+        .value_size = value_size
+    };
+
+    if (!multimap_desc->internal_tree) {
+        alloc_packet->free_function(multimap_desc);
+        return NULL;
+    }
+
+    return (void *)multimap_desc;
+}
+
+static multimap_descriptor_t *_get_multimap_descriptor(void *multimap_ptr) {
+    assert(multimap_ptr);
+    multimap_descriptor_t *result = (multimap_descriptor_t *)multimap_ptr;
+    assert(result->magic_value == MULTIMAP_MAGIC_VALUE);
+    return result;
+}
+
+static const cmagic_memory_alloc_packet_t *
+_get_alloc_packet(multimap_descriptor_t *multimap_desc) {
+    return cmagic_avl_tree_get_alloc_packet(multimap_desc->internal_tree);
+}
+
+void
+cmagic_multimap_free(void *multimap_ptr) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(multimap_desc);
+    cmagic_multimap_clear(multimap_ptr);
+    cmagic_avl_tree_free(multimap_desc->internal_tree);
+    alloc_packet->free_function(multimap_desc);
+}
+
+/*
+ * The key and value are allocated before the node, so a failed allocation never leaves a node
+ * without its key in the tree, where it could not be told apart from its equal neighbours.
+ */
+cmagic_map_iterator_t
+cmagic_multimap_allocate(void *multimap_ptr, const void *key) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(multimap_desc);
+    void *allocated_key = alloc_packet->malloc_function(multimap_desc->key_size);
+    if (!allocated_key) {
+        return NULL;
+    }
+
+    void *allocated_value = alloc_packet->malloc_function(multimap_desc->value_size);
+    if (!allocated_value) {
+        alloc_packet->free_function(allocated_key);
+        return NULL;
+    }
+
+    cmagic_avl_tree_iterator_t inserted =
+        cmagic_avl_tree_insert_equal(multimap_desc->internal_tree, key, allocated_value);
+    if (!inserted) {
+        alloc_packet->free_function(allocated_key);
+        alloc_packet->free_function(allocated_value);
+        return NULL;
+    }
+
+    cmagic_avl_tree_replace_key(multimap_desc->internal_tree, inserted, allocated_key);
+    return (cmagic_map_iterator_t)inserted;
+}
+
+cmagic_map_iterator_t
+cmagic_multimap_insert(void *multimap_ptr, const void *key, const void *value) {
+    cmagic_map_iterator_t inserted = cmagic_multimap_allocate(multimap_ptr, key);
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+
+    if (inserted) {
+        memcpy((void *)inserted->key, key, multimap_desc->key_size);
+        memcpy(inserted->value, value, multimap_desc->value_size);
+    }
+
+    return inserted;
+}
+
+void
+cmagic_multimap_erase_iterator(void *multimap_ptr, cmagic_map_iterator_t iterator,
+                               cmagic_map_erase_destructor_t destructor) {
+    assert(iterator);
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    const void *key_to_delete = iterator->key;
+    void *value_to_delete = iterator->value;
+    cmagic_avl_tree_erase_iterator(multimap_desc->internal_tree,
+                                   (cmagic_avl_tree_iterator_t)iterator);
+    if (destructor) {
+        destructor((void *)key_to_delete, value_to_delete);
+    }
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(multimap_desc);
+    alloc_packet->free_function((void *)key_to_delete);
+    alloc_packet->free_function(value_to_delete);
+}
+
+size_t
+cmagic_multimap_erase(void *multimap_ptr, const void *key,
+                      cmagic_map_erase_destructor_t destructor) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    cmagic_map_iterator_t it = cmagic_multimap_lower_bound(multimap_ptr, key);
+    size_t erased = 0;
+    while (it && multimap_desc->key_comparator(key, it->key) == 0) {
+        cmagic_map_iterator_t next = (cmagic_map_iterator_t)
+            cmagic_avl_tree_iterator_next((cmagic_avl_tree_iterator_t)it);
+        cmagic_multimap_erase_iterator(multimap_ptr, it, destructor);
+        it = next;
+        erased++;
+    }
+    return erased;
+}
+
+typedef struct {
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+    cmagic_map_erase_destructor_t destructor;
+} clear_context_t;
+
+static void _clear_callback(const void *key, void *value, void *context) {
+    const clear_context_t *clear_context = (const clear_context_t *)context;
+    if (clear_context->destructor) {
+        clear_context->destructor((void *)key, value);
+    }
+    clear_context->alloc_packet->free_function((void *)key);
+    clear_context->alloc_packet->free_function(value);
+}
+
+void
+cmagic_multimap_clear_ext(void *multimap_ptr, cmagic_map_erase_destructor_t destructor) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    clear_context_t clear_context = {
+        .alloc_packet = _get_alloc_packet(multimap_desc),
+        .destructor = destructor
+    };
+    cmagic_avl_tree_clear_ext(multimap_desc->internal_tree, _clear_callback, &clear_context);
+}
+
+void
+cmagic_multimap_clear(void *multimap_ptr) {
+    cmagic_multimap_clear_ext(multimap_ptr, NULL);
+}
+
+typedef struct {
+    clear_context_t clear_context;
+    cmagic_map_copy_function_t copy;
+    size_t key_size;
+    size_t value_size;
+} copy_context_t;
+
+static bool _copy_callback(cmagic_avl_tree_element_t *element, void *context) {
+    const copy_context_t *copy_context = (const copy_context_t *)context;
+    const cmagic_memory_alloc_packet_t *alloc_packet = copy_context->clear_context.alloc_packet;
+    void *key = alloc_packet->malloc_function(copy_context->key_size);
+    if (!key) {
+        return false;
+    }
+    void *value = alloc_packet->malloc_function(copy_context->value_size);
+    if (!value) {
+        alloc_packet->free_function(key);
+        return false;
+    }
+
+    if (copy_context->copy) {
+        copy_context->copy(key, value, element->key, element->value);
+    } else {
+        memcpy(key, element->key, copy_context->key_size);
+        memcpy(value, element->value, copy_context->value_size);
+    }
+    element->key = key;
+    element->value = value;
+    return true;
+}
+
+static void _copy_rollback_callback(const void *key, void *value, void *context) {
+    _clear_callback(key, value, &((copy_context_t *)context)->clear_context);
+}
+
+void *
+cmagic_multimap_copy(void *multimap_ptr, cmagic_map_copy_function_t copy,
+                     cmagic_map_erase_destructor_t destructor) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(multimap_desc);
+    multimap_descriptor_t *copy_desc = (multimap_descriptor_t *)
+        alloc_packet->malloc_function(sizeof(multimap_descriptor_t));
+    if (!copy_desc) {
+        return NULL;
+    }
+
+    copy_context_t copy_context = {
+        .clear_context = {
+            .alloc_packet = alloc_packet,
+            .destructor = destructor
+        },
+        .copy = copy,
+        .key_size = multimap_desc->key_size,
+        .value_size = multimap_desc->value_size
+    };
+    *copy_desc = *multimap_desc;
+    copy_desc->internal_tree =
+        cmagic_avl_tree_clone(multimap_desc->internal_tree, _copy_callback,
+                              _copy_rollback_callback, &copy_context);
+    if (!copy_desc->internal_tree) {
+        alloc_packet->free_function(copy_desc);
+        return NULL;
+    }
+
+    return (void *)copy_desc;
+}
+
+size_t
+cmagic_multimap_size(void *multimap_ptr) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    return cmagic_avl_tree_size(multimap_desc->internal_tree);
+}
+
+cmagic_map_iterator_t
+cmagic_multimap_first(void *multimap_ptr) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    return (cmagic_map_iterator_t)cmagic_avl_tree_first(multimap_desc->internal_tree);
+}
+
+cmagic_map_iterator_t
+cmagic_multimap_last(void *multimap_ptr) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    return (cmagic_map_iterator_t)cmagic_avl_tree_last(multimap_desc->internal_tree);
+}
+
+cmagic_map_iterator_t
+cmagic_multimap_find(void *multimap_ptr, const void *key) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    cmagic_map_iterator_t lower = cmagic_multimap_lower_bound(multimap_ptr, key);
+    return lower && multimap_desc->key_comparator(key, lower->key) == 0 ? lower : NULL;
+}
+
+size_t
+cmagic_multimap_count(void *multimap_ptr, const void *key) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    return cmagic_avl_tree_count(multimap_desc->internal_tree, key);
+}
+
+cmagic_map_iterator_t
+cmagic_multimap_lower_bound(void *multimap_ptr, const void *key) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    return (cmagic_map_iterator_t)cmagic_avl_tree_lower_bound(multimap_desc->internal_tree, key);
+}
+
+cmagic_map_iterator_t
+cmagic_multimap_upper_bound(void *multimap_ptr, const void *key) {
+    multimap_descriptor_t *multimap_desc = _get_multimap_descriptor(multimap_ptr);
+    return (cmagic_map_iterator_t)cmagic_avl_tree_upper_bound(multimap_desc->internal_tree, key);
+}
+
+cmagic_map_range_t
+cmagic_multimap_equal_range(void *multimap_ptr, const void *key) {
+    return (cmagic_map_range_t) {
+        .begin = cmagic_multimap_lower_bound(multimap_ptr, key),
+        .end = cmagic_multimap_upper_bound(multimap_ptr, key)
+    };
+}
+
+const cmagic_memory_alloc_packet_t *
+cmagic_multimap_get_alloc_packet(void *multimap_ptr) {
+    return _get_alloc_packet(_get_multimap_descriptor(multimap_ptr));
+}
@@ -0,0 +1,278 @@
+#include <stdint.h>
+#include <string.h>
+#include "cmagic/multiset.h"
+#include "avl_tree.h"
+
+#ifndef NDEBUG
+static const int_least32_t MULTISET_MAGIC_VALUE = 'M' << 16 | 'S' << 8 | 'T';
+#endif
+
+
+// Equal keys are supported by the AVL tree only, so unlike set the engine is fixed
+typedef struct {
+#ifndef NDEBUG
+    int_least32_t magic_value;
+#endif
+    void *internal_tree;
+    cmagic_set_key_comparator_t key_comparator;
+    size_t key_size;
+} multiset_descriptor_t;
+
+
+void *
+cmagic_multiset_new(size_t key_size, cmagic_set_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet) {
+    assert(key_size > 0);
+    assert(key_comparator);
+    assert(alloc_packet);
+
+    multiset_descriptor_t *multiset_desc =
+        (multiset_descriptor_t *) alloc_packet->malloc_function(sizeof(multiset_descriptor_t));
+    if (!multiset_desc) {
+        return NULL;
+    }
+
+    *multiset_desc = (multiset_descriptor_t) {
+#ifndef NDEBUG
+        .magic_value = MULTISET_MAGIC_VALUE,
+#endif
+        .internal_tree = cmagic_avl_tree_new(key_comparator, alloc_packet),
+        .key_comparator = key_comparator,
+        .key_size = key_size
+    };
+
+    if (!multiset_desc->internal_tree) {
+        alloc_packet->free_function(multiset_desc);
+        return NULL;
+    }
+
+    return (void *)multiset_desc;
+}
+
+static multiset_descriptor_t *_get_multiset_descriptor(void *multiset_ptr) {
+    assert(multiset_ptr);
+    multiset_descriptor_t *result = (multiset_descriptor_t *)multiset_ptr;
+    assert(result->magic_value == MULTISET_MAGIC_VALUE);
+    return result;
+}
+
+static const cmagic_memory_alloc_packet_t *
+_get_alloc_packet(multiset_descriptor_t *multiset_desc) {
+    return cmagic_avl_tree_get_alloc_packet(multiset_desc->internal_tree);
+}
+
+void
+cmagic_multiset_free(void *multiset_ptr) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(multiset_desc);
+    cmagic_multiset_clear(multiset_ptr);
+    cmagic_avl_tree_free(multiset_desc->internal_tree);
+    alloc_packet->free_function(multiset_desc);
+}
+
+/*
+ * The key is allocated before the node, so a failed allocation never leaves a node without its key
+ * in the tree, where it could not be told apart from its equal neighbours.
+ */
+cmagic_set_iterator_t
+cmagic_multiset_allocate(void *multiset_ptr, const void *key) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(multiset_desc);
+    void *allocated_key = alloc_packet->malloc_function(multiset_desc->key_size);
+    if (!allocated_key) {
+        return NULL;
+    }
+
+    cmagic_avl_tree_iterator_t inserted =
+        cmagic_avl_tree_insert_equal(multiset_desc->internal_tree, key, NULL);
+    if (!inserted) {
+        alloc_packet->free_function(allocated_key);
+        return NULL;
+    }
+
+    cmagic_avl_tree_replace_key(multiset_desc->internal_tree, inserted, allocated_key);
+    return (cmagic_set_iterator_t)inserted;
+}
+
+cmagic_set_iterator_t
+cmagic_multiset_insert(void *multiset_ptr, const void *key) {
+    cmagic_set_iterator_t inserted = cmagic_multiset_allocate(multiset_ptr, key);
+
+    if (inserted) {
+        memcpy((void *)inserted->key, key, _get_multiset_descriptor(multiset_ptr)->key_size);
+    }
+
+    return inserted;
+}
+
+void
+cmagic_multiset_erase_iterator(void *multiset_ptr, cmagic_set_iterator_t iterator,
+                               cmagic_set_erase_destructor_t destructor) {
+    assert(iterator);
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    const void *key_to_delete = iterator->key;
+    cmagic_avl_tree_erase_iterator(multiset_desc->internal_tree,
+                                   (cmagic_avl_tree_iterator_t)iterator);
+    if (destructor) {
+        destructor((void *)key_to_delete);
+    }
+    _get_alloc_packet(multiset_desc)->free_function((void *)key_to_delete);
+}
+
+size_t
+cmagic_multiset_erase(void *multiset_ptr, const void *key,
+                      cmagic_set_erase_destructor_t destructor) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    cmagic_set_iterator_t it = cmagic_multiset_lower_bound(multiset_ptr, key);
+    size_t erased = 0;
+    while (it && multiset_desc->key_comparator(key, it->key) == 0) {
+        cmagic_set_iterator_t next = (cmagic_set_iterator_t)
+            cmagic_avl_tree_iterator_next((cmagic_avl_tree_iterator_t)it);
+        cmagic_multiset_erase_iterator(multiset_ptr, it, destructor);
+        it = next;
+        erased++;
+    }
+    return erased;
+}
+
+typedef struct {
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+    cmagic_set_erase_destructor_t destructor;
+} clear_context_t;
+
+static void _clear_callback(const void *key, void *value, void *context) {
+    (void)value;
+    const clear_context_t *clear_context = (const clear_context_t *)context;
+    if (clear_context->destructor) {
+        clear_context->destructor((void *)key);
+    }
+    clear_context->alloc_packet->free_function((void *)key);
+}
+
+void
+cmagic_multiset_clear_ext(void *multiset_ptr, cmagic_set_erase_destructor_t destructor) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    clear_context_t clear_context = {
+        .alloc_packet = _get_alloc_packet(multiset_desc),
+        .destructor = destructor
+    };
+    cmagic_avl_tree_clear_ext(multiset_desc->internal_tree, _clear_callback, &clear_context);
+}
+
+void
+cmagic_multiset_clear(void *multiset_ptr) {
+    cmagic_multiset_clear_ext(multiset_ptr, NULL);
+}
+
+typedef struct {
+    clear_context_t clear_context;
+    cmagic_set_copy_function_t copy;
+    size_t key_size;
+} copy_context_t;
+
+static bool _copy_callback(cmagic_avl_tree_element_t *element, void *context) {
+    const copy_context_t *copy_context = (const copy_context_t *)context;
+    void *key = copy_context->clear_context.alloc_packet->malloc_function(copy_context->key_size);
+    if (!key) {
+        return false;
+    }
+
+    if (copy_context->copy) {
+        copy_context->copy(key, element->key);
+    } else {
+        memcpy(key, element->key, copy_context->key_size);
+    }
+    element->key = key;
+    return true;
+}
+
+static void _copy_rollback_callback(const void *key, void *value, void *context) {
+    _clear_callback(key, value, &((copy_context_t *)context)->clear_context);
+}
+
+void *
+cmagic_multiset_copy(void *multiset_ptr, cmagic_set_copy_function_t copy,
+                     cmagic_set_erase_destructor_t destructor) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(multiset_desc);
+    multiset_descriptor_t *copy_desc = (multiset_descriptor_t *)
+        alloc_packet->malloc_function(sizeof(multiset_descriptor_t));
+    if (!copy_desc) {
+        return NULL;
+    }
+
+    copy_context_t copy_context = {
+        .clear_context = {
+            .alloc_packet = alloc_packet,
+            .destructor = destructor
+        },
+        .copy = copy,
+        .key_size = multiset_desc->key_size
+    };
+    *copy_desc = *multiset_desc;
+    copy_desc->internal_tree =
+        cmagic_avl_tree_clone(multiset_desc->internal_tree, _copy_callback,
+                              _copy_rollback_callback, &copy_context);
+    if (!copy_desc->internal_tree) {
+        alloc_packet->free_function(copy_desc);
+        return NULL;
+    }
+
+    return (void *)copy_desc;
+}
+
+size_t
+cmagic_multiset_size(void *multiset_ptr) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    return cmagic_avl_tree_size(multiset_desc->internal_tree);
+}
+
+cmagic_set_iterator_t
+cmagic_multiset_first(void *multiset_ptr) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    return (cmagic_set_iterator_t)cmagic_avl_tree_first(multiset_desc->internal_tree);
+}
+
+cmagic_set_iterator_t
+cmagic_multiset_last(void *multiset_ptr) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    return (cmagic_set_iterator_t)cmagic_avl_tree_last(multiset_desc->internal_tree);
+}
+
+cmagic_set_iterator_t
+cmagic_multiset_find(void *multiset_ptr, const void *key) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    cmagic_set_iterator_t lower = cmagic_multiset_lower_bound(multiset_ptr, key);
+    return lower && multiset_desc->key_comparator(key, lower->key) == 0 ? lower : NULL;
+}
+
+size_t
+cmagic_multiset_count(void *multiset_ptr, const void *key) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    return cmagic_avl_tree_count(multiset_desc->internal_tree, key);
+}
+
+cmagic_set_iterator_t
+cmagic_multiset_lower_bound(void *multiset_ptr, const void *key) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    return (cmagic_set_iterator_t)cmagic_avl_tree_lower_bound(multiset_desc->internal_tree, key);
+}
+
+cmagic_set_iterator_t
+cmagic_multiset_upper_bound(void *multiset_ptr, const void *key) {
+    multiset_descriptor_t *multiset_desc = _get_multiset_descriptor(multiset_ptr);
+    return (cmagic_set_iterator_t)cmagic_avl_tree_upper_bound(multiset_desc->internal_tree, key);
+}
+
+cmagic_set_range_t
+cmagic_multiset_equal_range(void *multiset_ptr, const void *key) {
+    return (cmagic_set_range_t) {
+        .begin = cmagic_multiset_lower_bound(multiset_ptr, key),
+        .end = cmagic_multiset_upper_bound(multiset_ptr, key)
+    };
+}
+
+const cmagic_memory_alloc_packet_t *
+cmagic_multiset_get_alloc_packet(void *multiset_ptr) {
+    return _get_alloc_packet(_get_multiset_descriptor(multiset_ptr));
+}
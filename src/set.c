@@ -1,75 +1,151 @@
 #include <stdint.h>
 #include <string.h>
-#include "avl_tree.h"
+#include "tree_engine.h"
 #include "cmagic/set.h"
 
 #ifndef NDEBUG
 static const int_least32_t SET_MAGIC_VALUE = 'S' << 16 | 'E' << 8 | 'T';
+static const int_least32_t EMBEDDED_SET_MAGIC_VALUE = 'E' << 24 | 'S' << 16 | 'E' << 8 | 'T';
 #endif
 
+// The internal tree is NULL until the first element is inserted
 typedef struct {
 #ifndef NDEBUG
     int_least32_t magic_value;
 #endif
-    void *internal_avl_tree;
+    const cmagic_tree_engine_t *engine;
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+    void *internal_tree;
+    cmagic_set_key_comparator_t key_comparator;
     size_t key_size;
 } set_descriptor_t;
 
+_Static_assert(sizeof(set_descriptor_t) <= sizeof(cmagic_set_storage_t),
+               "set storage is too small");
+_Static_assert(_Alignof(set_descriptor_t) <= _Alignof(cmagic_set_storage_t),
+               "set storage is not aligned enough");
 
-void *
-cmagic_set_new(size_t key_size, cmagic_set_key_comparator_t key_comparator,
-               const cmagic_memory_alloc_packet_t *alloc_packet) {
-    assert(key_size > 0);
-    assert(key_comparator);
-    assert(alloc_packet);
 
-    set_descriptor_t *set_desc =
-        (set_descriptor_t *) alloc_packet->malloc_function(sizeof(set_descriptor_t));
-    if (!set_desc) {
-        return NULL;
+static const cmagic_tree_engine_t *_get_tree_engine(cmagic_set_engine_t engine) {
+    switch (engine) {
+    case CMAGIC_SET_ENGINE_B_TREE:
+        return &CMAGIC_TREE_ENGINE_B_TREE;
+    case CMAGIC_SET_ENGINE_COMPACT_TREE:
+        return &CMAGIC_TREE_ENGINE_COMPACT_TREE;
+    default:
+        assert(engine == CMAGIC_SET_ENGINE_AVL_TREE);
+        return &CMAGIC_TREE_ENGINE_AVL_TREE;
     }
+}
 
+static void _init_set_descriptor(set_descriptor_t *set_desc, size_t key_size,
+                                 cmagic_set_key_comparator_t key_comparator,
+                                 const cmagic_memory_alloc_packet_t *alloc_packet,
+                                 const cmagic_tree_engine_t *tree_engine) {
     *set_desc = (set_descriptor_t) {
 #ifndef NDEBUG
         .magic_value = SET_MAGIC_VALUE,
 #endif
-        .internal_avl_tree = cmagic_avl_tree_new(key_comparator, alloc_packet),
+        .engine = tree_engine,
+        .alloc_packet = alloc_packet,
+        .internal_tree = NULL,
+        .key_comparator = key_comparator,
         .key_size = key_size
     };
+}
 
-    if (!set_desc->internal_avl_tree) {
-        alloc_packet->free_function(set_desc);
-        return NULL;
+static set_descriptor_t *
+_new_set_descriptor(size_t key_size, cmagic_set_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet,
+                    const cmagic_tree_engine_t *tree_engine) {
+    set_descriptor_t *set_desc =
+        (set_descriptor_t *) alloc_packet->malloc_function(sizeof(set_descriptor_t));
+    if (set_desc) {
+        _init_set_descriptor(set_desc, key_size, key_comparator, alloc_packet, tree_engine);
     }
+    return set_desc;
+}
+
+void *
+cmagic_set_new_ext(size_t key_size, cmagic_set_key_comparator_t key_comparator,
+                   const cmagic_memory_alloc_packet_t *alloc_packet, cmagic_set_engine_t engine) {
+    assert(key_size > 0);
+    assert(key_comparator);
+    assert(alloc_packet);
+    return (void *)_new_set_descriptor(key_size, key_comparator, alloc_packet,
+                                       _get_tree_engine(engine));
+}
 
+void *
+cmagic_set_init_ext(cmagic_set_storage_t *storage, size_t key_size,
+                    cmagic_set_key_comparator_t key_comparator,
+                    const cmagic_memory_alloc_packet_t *alloc_packet, cmagic_set_engine_t engine) {
+    assert(storage);
+    assert(key_size > 0);
+    assert(key_comparator);
+    assert(alloc_packet);
+    set_descriptor_t *set_desc = (set_descriptor_t *)storage;
+    _init_set_descriptor(set_desc, key_size, key_comparator, alloc_packet,
+                         _get_tree_engine(engine));
+#ifndef NDEBUG
+    set_desc->magic_value = EMBEDDED_SET_MAGIC_VALUE;
+#endif
     return (void *)set_desc;
 }
 
+void *
+cmagic_set_new(size_t key_size, cmagic_set_key_comparator_t key_comparator,
+               const cmagic_memory_alloc_packet_t *alloc_packet) {
+    return cmagic_set_new_ext(key_size, key_comparator, alloc_packet, CMAGIC_SET_ENGINE_AVL_TREE);
+}
+
 static set_descriptor_t *_get_set_descriptor(void *set_ptr) {
     assert(set_ptr);
     set_descriptor_t *result = (set_descriptor_t *)set_ptr;
-    assert(result->magic_value == SET_MAGIC_VALUE);
+    assert(result->magic_value == SET_MAGIC_VALUE
+           || result->magic_value == EMBEDDED_SET_MAGIC_VALUE);
     return result;
 }
 
 static const cmagic_memory_alloc_packet_t *_get_alloc_packet(set_descriptor_t *set_desc) {
-    return cmagic_avl_tree_get_alloc_packet(set_desc->internal_avl_tree);
+    return set_desc->alloc_packet;
+}
+
+// Creates the internal tree before the first insertion
+static bool _ensure_internal_tree(set_descriptor_t *set_desc) {
+    if (!set_desc->internal_tree) {
+        set_desc->internal_tree = set_desc->engine->new_function(
+            set_desc->key_comparator, set_desc->key_size, set_desc->alloc_packet);
+    }
+    return set_desc->internal_tree != NULL;
+}
+
+void
+cmagic_set_destroy(void *set_ptr) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    if (set_desc->internal_tree) {
+        cmagic_set_clear(set_ptr);
+        set_desc->engine->free_function(set_desc->internal_tree);
+        set_desc->internal_tree = NULL;
+    }
 }
 
 void
 cmagic_set_free(void *set_ptr) {
     set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
-    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(set_desc);
-    cmagic_set_clear(set_ptr);
-    cmagic_avl_tree_free(set_desc->internal_avl_tree);
-    alloc_packet->free_function(set_desc);
+    assert(set_desc->magic_value == SET_MAGIC_VALUE);
+    cmagic_set_destroy(set_ptr);
+    _get_alloc_packet(set_desc)->free_function(set_desc);
 }
 
 cmagic_set_insert_result_t
 cmagic_set_allocate(void *set_ptr, const void *key) {
     set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
-    cmagic_avl_tree_insert_result_t tree_result =
-        cmagic_avl_tree_insert(set_desc->internal_avl_tree, key, NULL);
+    if (!_ensure_internal_tree(set_desc)) {
+        return (cmagic_set_insert_result_t) { .inserted_or_existing = NULL };
+    }
+    cmagic_tree_insert_result_t tree_result =
+        set_desc->engine->insert_function(set_desc->internal_tree, key, NULL);
     cmagic_set_insert_result_t result = {
         .inserted_or_existing = (cmagic_set_iterator_t)tree_result.inserted_or_existing,
         .already_exists = tree_result.already_exists
@@ -81,12 +157,14 @@ cmagic_set_allocate(void *set_ptr, const void *key) {
 
     const void *allocated_key = _get_alloc_packet(set_desc)->malloc_function(set_desc->key_size);
     if (!allocated_key) {
-        cmagic_avl_tree_erase(set_desc->internal_avl_tree, key);
+        set_desc->engine->erase_function(set_desc->internal_tree, key);
         result.inserted_or_existing = NULL;
         return result;
     }
 
-    result.inserted_or_existing->key = allocated_key;
+    set_desc->engine->replace_key_function(set_desc->internal_tree,
+                                          (cmagic_tree_iterator_t)result.inserted_or_existing,
+                                          allocated_key);
     return result;
 }
 
@@ -103,13 +181,12 @@ cmagic_set_insert(void *set_ptr, const void *key) {
     return result;
 }
 
-void
-cmagic_set_erase(void *set_ptr, const void *key, cmagic_set_erase_destructor_t destructor) {
-    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
-    cmagic_avl_tree_iterator_t found = cmagic_avl_tree_find(set_desc->internal_avl_tree, key);
+// The stored key is still alive during the erasure, so it serves as the key to be searched for
+static void _erase_found(set_descriptor_t *set_desc, cmagic_tree_iterator_t found,
+                         cmagic_set_erase_destructor_t destructor) {
     if (found) {
         const void *key_to_delete = found->key;
-        cmagic_avl_tree_erase(set_desc->internal_avl_tree, key);
+        set_desc->engine->erase_function(set_desc->internal_tree, key_to_delete);
         if (destructor) {
             destructor((void *)key_to_delete);
         }
@@ -117,50 +194,436 @@ cmagic_set_erase(void *set_ptr, const void *key, cmagic_set_erase_destructor_t d
     }
 }
 
+void
+cmagic_set_erase(void *set_ptr, const void *key, cmagic_set_erase_destructor_t destructor) {
+    cmagic_tree_iterator_t found = (cmagic_tree_iterator_t)cmagic_set_find(set_ptr, key);
+    _erase_found(_get_set_descriptor(set_ptr), found, destructor);
+}
+
+static cmagic_tree_iterator_t _find_by(set_descriptor_t *set_desc, const void *key,
+                                       cmagic_set_key_comparator_t key_comparator) {
+    assert(key_comparator);
+    if (!set_desc->internal_tree) {
+        return NULL;
+    }
+    cmagic_tree_iterator_t lower =
+        set_desc->engine->lower_bound_by_function(set_desc->internal_tree, key, key_comparator);
+    return lower && key_comparator(key, lower->key) == 0 ? lower : NULL;
+}
+
+void
+cmagic_set_erase_by(void *set_ptr, const void *key, cmagic_set_key_comparator_t key_comparator,
+                    cmagic_set_erase_destructor_t destructor) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    _erase_found(set_desc, _find_by(set_desc, key, key_comparator), destructor);
+}
+
+typedef struct {
+    const cmagic_memory_alloc_packet_t *alloc_packet;
+    cmagic_set_erase_destructor_t destructor;
+} clear_context_t;
+
+static void _clear_callback(const void *key, void *value, void *context) {
+    (void)value;
+    const clear_context_t *clear_context = (const clear_context_t *)context;
+    if (clear_context->destructor) {
+        clear_context->destructor((void *)key);
+    }
+    clear_context->alloc_packet->free_function((void *)key);
+}
+
+void
+cmagic_set_clear_ext(void *set_ptr, cmagic_set_erase_destructor_t destructor) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    if (!set_desc->internal_tree) {
+        return;
+    }
+    clear_context_t clear_context = {
+        .alloc_packet = _get_alloc_packet(set_desc),
+        .destructor = destructor
+    };
+    set_desc->engine->clear_function(set_desc->internal_tree, _clear_callback, &clear_context);
+}
+
 void
 cmagic_set_clear(void *set_ptr) {
+    cmagic_set_clear_ext(set_ptr, NULL);
+}
+
+typedef struct {
+    clear_context_t clear_context;
+    cmagic_set_copy_function_t copy;
+    size_t key_size;
+} copy_context_t;
+
+static bool _copy_callback(cmagic_tree_element_t *element, void *context) {
+    const copy_context_t *copy_context = (const copy_context_t *)context;
+    void *key = copy_context->clear_context.alloc_packet->malloc_function(copy_context->key_size);
+    if (!key) {
+        return false;
+    }
+
+    if (copy_context->copy) {
+        copy_context->copy(key, element->key);
+    } else {
+        memcpy(key, element->key, copy_context->key_size);
+    }
+    element->key = key;
+    return true;
+}
+
+static void _copy_rollback_callback(const void *key, void *value, void *context) {
+    _clear_callback(key, value, &((copy_context_t *)context)->clear_context);
+}
+
+void *
+cmagic_set_copy(void *set_ptr, cmagic_set_copy_function_t copy,
+                cmagic_set_erase_destructor_t destructor) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(set_desc);
+    set_descriptor_t *copy_desc =
+        (set_descriptor_t *)alloc_packet->malloc_function(sizeof(set_descriptor_t));
+    if (!copy_desc) {
+        return NULL;
+    }
+
+    copy_context_t copy_context = {
+        .clear_context = {
+            .alloc_packet = alloc_packet,
+            .destructor = destructor
+        },
+        .copy = copy,
+        .key_size = set_desc->key_size
+    };
+    *copy_desc = *set_desc;
+#ifndef NDEBUG
+    copy_desc->magic_value = SET_MAGIC_VALUE;
+#endif
+    if (!set_desc->internal_tree) {
+        return (void *)copy_desc;
+    }
+    copy_desc->internal_tree =
+        cmagic_tree_engine_clone(set_desc->engine, set_desc->key_comparator, set_desc->key_size,
+                                 set_desc->internal_tree, _copy_callback,
+                                 _copy_rollback_callback, &copy_context);
+    if (!copy_desc->internal_tree) {
+        alloc_packet->free_function(copy_desc);
+        return NULL;
+    }
+
+    return (void *)copy_desc;
+}
+
+typedef enum {
+    SET_OPERATION_UNION,
+    SET_OPERATION_INTERSECTION,
+    SET_OPERATION_DIFFERENCE
+} set_operation_t;
+
+/*
+ * Walks both sets in order at once and collects pointers to the keys belonging to the result.
+ * Returns the number of collected keys.
+ */
+static size_t _merge_walk(set_descriptor_t *set1_desc, set_descriptor_t *set2_desc,
+                          set_operation_t operation, const void **result_keys) {
+    size_t result_size = 0;
+    cmagic_tree_iterator_t it1 = set1_desc->internal_tree
+        ? set1_desc->engine->first_function(set1_desc->internal_tree) : NULL;
+    cmagic_tree_iterator_t it2 = set2_desc->internal_tree
+        ? set2_desc->engine->first_function(set2_desc->internal_tree) : NULL;
+    while (it1 || (it2 && operation == SET_OPERATION_UNION)) {
+        int comparison_result =
+            !it1 ? 1 : !it2 ? -1 : set1_desc->key_comparator(it1->key, it2->key);
+        if (comparison_result < 0) {
+            if (operation != SET_OPERATION_INTERSECTION) {
+                result_keys[result_size++] = it1->key;
+            }
+            it1 = cmagic_tree_engine_iterator_next(it1);
+        } else if (comparison_result > 0) {
+            if (operation == SET_OPERATION_UNION) {
+                result_keys[result_size++] = it2->key;
+            }
+            it2 = cmagic_tree_engine_iterator_next(it2);
+        } else {
+            if (operation != SET_OPERATION_DIFFERENCE) {
+                result_keys[result_size++] = it1->key;
+            }
+            it1 = cmagic_tree_engine_iterator_next(it1);
+            it2 = cmagic_tree_engine_iterator_next(it2);
+        }
+    }
+
+    return result_size;
+}
+
+static void *_set_operation(void *set1_ptr, void *set2_ptr, set_operation_t operation,
+                            cmagic_set_copy_function_t copy) {
+    set_descriptor_t *set1_desc = _get_set_descriptor(set1_ptr);
+    set_descriptor_t *set2_desc = _get_set_descriptor(set2_ptr);
+    assert(set1_desc->key_size == set2_desc->key_size);
+    const cmagic_memory_alloc_packet_t *alloc_packet = _get_alloc_packet(set1_desc);
+
+    set_descriptor_t *result_desc = _new_set_descriptor(set1_desc->key_size,
+                                                        set1_desc->key_comparator, alloc_packet,
+                                                        set1_desc->engine);
+    if (!result_desc) {
+        return NULL;
+    }
+
+    const size_t size1 = cmagic_set_size(set1_ptr);
+    const size_t size2 = cmagic_set_size(set2_ptr);
+    size_t max_result_size = size1;
+    if (operation == SET_OPERATION_UNION) {
+        max_result_size = size1 + size2;
+    } else if (operation == SET_OPERATION_INTERSECTION) {
+        max_result_size = CMAGIC_UTILS_MIN(size1, size2);
+    }
+    if (max_result_size == 0) {
+        return (void *)result_desc;
+    }
+    if (!_ensure_internal_tree(result_desc)) {
+        cmagic_set_free(result_desc);
+        return NULL;
+    }
+
+    // Source keys, their copies and elements of the result tree share a single temporary allocation
+    void *buffer = alloc_packet->malloc_function(
+        max_result_size * (2 * sizeof(const void *) + sizeof(cmagic_tree_element_t)));
+    if (!buffer) {
+        cmagic_set_free(result_desc);
+        return NULL;
+    }
+    cmagic_tree_element_t *elements = (cmagic_tree_element_t *)buffer;
+    const void **source_keys = (const void **)(elements + max_result_size);
+    void **copied_keys = (void **)(source_keys + max_result_size);
+
+    const size_t result_size = _merge_walk(set1_desc, set2_desc, operation, source_keys);
+    for (size_t i = 0; i < result_size; i++) {
+        copied_keys[i] = alloc_packet->malloc_function(result_desc->key_size);
+        elements[i] = (cmagic_tree_element_t) { .key = source_keys[i], .value = NULL };
+        if (!copied_keys[i]) {
+            while (i > 0) {
+                alloc_packet->free_function(copied_keys[--i]);
+            }
+            alloc_packet->free_function(buffer);
+            cmagic_set_free(result_desc);
+            return NULL;
+        }
+    }
+
+    // The tree is built on the source keys, they are replaced by copies once nothing can fail
+    if (!result_desc->engine->build_function(result_desc->internal_tree, elements, result_size)) {
+        for (size_t i = 0; i < result_size; i++) {
+            alloc_packet->free_function(copied_keys[i]);
+        }
+        alloc_packet->free_function(buffer);
+        cmagic_set_free(result_desc);
+        return NULL;
+    }
+
+    size_t copied = 0;
+    cmagic_tree_iterator_t it = result_desc->engine->first_function(result_desc->internal_tree);
+    for (; it; it = cmagic_tree_engine_iterator_next(it), copied++) {
+        if (copy) {
+            copy(copied_keys[copied], source_keys[copied]);
+        } else {
+            memcpy(copied_keys[copied], source_keys[copied], result_desc->key_size);
+        }
+        result_desc->engine->replace_key_function(result_desc->internal_tree, it,
+                                                  copied_keys[copied]);
+    }
+    assert(copied == result_size);
+
+    alloc_packet->free_function(buffer);
+    return (void *)result_desc;
+}
+
+void *
+cmagic_set_union(void *set1_ptr, void *set2_ptr, cmagic_set_copy_function_t copy) {
+    return _set_operation(set1_ptr, set2_ptr, SET_OPERATION_UNION, copy);
+}
+
+void *
+cmagic_set_intersection(void *set1_ptr, void *set2_ptr, cmagic_set_copy_function_t copy) {
+    return _set_operation(set1_ptr, set2_ptr, SET_OPERATION_INTERSECTION, copy);
+}
+
+void *
+cmagic_set_difference(void *set1_ptr, void *set2_ptr, cmagic_set_copy_function_t copy) {
+    return _set_operation(set1_ptr, set2_ptr, SET_OPERATION_DIFFERENCE, copy);
+}
+
+static void _assert_compatible(set_descriptor_t *set_desc, set_descriptor_t *other_desc) {
+    (void)set_desc;
+    (void)other_desc;
+    assert(set_desc->engine == other_desc->engine);
+    assert(set_desc->key_size == other_desc->key_size);
+    assert(_get_alloc_packet(set_desc)->malloc_function ==
+           _get_alloc_packet(other_desc)->malloc_function);
+    assert(_get_alloc_packet(set_desc)->free_function ==
+           _get_alloc_packet(other_desc)->free_function);
+}
+
+bool
+cmagic_set_split(void *set_ptr, const void *key, void *right_set_ptr) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    set_descriptor_t *right_desc = _get_set_descriptor(right_set_ptr);
+    _assert_compatible(set_desc, right_desc);
+    if (!set_desc->internal_tree) {
+        return true;
+    }
+    if (!_ensure_internal_tree(right_desc)) {
+        return false;
+    }
+    return cmagic_tree_engine_split(set_desc->engine, set_desc->key_comparator, set_desc->key_size,
+                                    &set_desc->internal_tree, key, &right_desc->internal_tree);
+}
+
+bool
+cmagic_set_join(void *set_ptr, void *right_set_ptr) {
     set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
-    for (cmagic_avl_tree_iterator_t it = cmagic_avl_tree_first(set_desc->internal_avl_tree);
-         it;
-         it = cmagic_avl_tree_iterator_next(it)) {
-        _get_alloc_packet(set_desc)->free_function((void *)it->key);
+    set_descriptor_t *right_desc = _get_set_descriptor(right_set_ptr);
+    _assert_compatible(set_desc, right_desc);
+    if (!right_desc->internal_tree) {
+        return true;
+    }
+    if (!set_desc->internal_tree) {
+        set_desc->internal_tree = right_desc->internal_tree;
+        right_desc->internal_tree = NULL;
+        return true;
     }
-    cmagic_avl_tree_clear(set_desc->internal_avl_tree);
+    return cmagic_tree_engine_join(set_desc->engine, set_desc->key_comparator, set_desc->key_size,
+                                   &set_desc->internal_tree, &right_desc->internal_tree);
 }
 
 size_t
 cmagic_set_size(void *set_ptr) {
-    return cmagic_avl_tree_size(_get_set_descriptor(set_ptr)->internal_avl_tree);
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    return set_desc->internal_tree ? set_desc->engine->size_function(set_desc->internal_tree) : 0;
 }
 
 cmagic_set_iterator_t
 cmagic_set_first(void *set_ptr) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    if (!set_desc->internal_tree) {
+        return NULL;
+    }
     return (cmagic_set_iterator_t)
-        cmagic_avl_tree_first(_get_set_descriptor(set_ptr)->internal_avl_tree);
+        set_desc->engine->first_function(set_desc->internal_tree);
 }
 
 cmagic_set_iterator_t
 cmagic_set_last(void *set_ptr) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    if (!set_desc->internal_tree) {
+        return NULL;
+    }
     return (cmagic_set_iterator_t)
-        cmagic_avl_tree_last(_get_set_descriptor(set_ptr)->internal_avl_tree);
+        set_desc->engine->last_function(set_desc->internal_tree);
 }
 
 cmagic_set_iterator_t
 cmagic_set_iterator_next(cmagic_set_iterator_t iterator) {
     return (cmagic_set_iterator_t)
-        cmagic_avl_tree_iterator_next((cmagic_avl_tree_iterator_t)iterator);
+        cmagic_tree_engine_iterator_next((cmagic_tree_iterator_t)iterator);
 }
 
 cmagic_set_iterator_t
 cmagic_set_iterator_prev(cmagic_set_iterator_t iterator) {
     return (cmagic_set_iterator_t)
-        cmagic_avl_tree_iterator_prev((cmagic_avl_tree_iterator_t)iterator);
+        cmagic_tree_engine_iterator_prev((cmagic_tree_iterator_t)iterator);
 }
 
 cmagic_set_iterator_t
 cmagic_set_find(void *set_ptr, const void *key) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    if (!set_desc->internal_tree) {
+        return NULL;
+    }
+    return (cmagic_set_iterator_t)
+        set_desc->engine->find_function(set_desc->internal_tree, key);
+}
+
+cmagic_set_iterator_t
+cmagic_set_lower_bound(void *set_ptr, const void *key) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    if (!set_desc->internal_tree) {
+        return NULL;
+    }
     return (cmagic_set_iterator_t)
-        cmagic_avl_tree_find(_get_set_descriptor(set_ptr)->internal_avl_tree, key);
+        set_desc->engine->lower_bound_function(set_desc->internal_tree, key);
+}
+
+cmagic_set_iterator_t
+cmagic_set_upper_bound(void *set_ptr, const void *key) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    if (!set_desc->internal_tree) {
+        return NULL;
+    }
+    return (cmagic_set_iterator_t)
+        set_desc->engine->upper_bound_function(set_desc->internal_tree, key);
+}
+
+cmagic_set_range_t
+cmagic_set_equal_range(void *set_ptr, const void *key) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    if (!set_desc->internal_tree) {
+        return (cmagic_set_range_t) { .begin = NULL, .end = NULL };
+    }
+    cmagic_tree_range_t tree_range =
+        set_desc->engine->equal_range_function(set_desc->internal_tree, key);
+    return (cmagic_set_range_t) {
+        .begin = (cmagic_set_iterator_t)tree_range.begin,
+        .end = (cmagic_set_iterator_t)tree_range.end
+    };
+}
+
+cmagic_set_iterator_t
+cmagic_set_find_by(void *set_ptr, const void *key, cmagic_set_key_comparator_t key_comparator) {
+    return (cmagic_set_iterator_t)_find_by(_get_set_descriptor(set_ptr), key, key_comparator);
+}
+
+cmagic_set_iterator_t
+cmagic_set_lower_bound_by(void *set_ptr, const void *key,
+                          cmagic_set_key_comparator_t key_comparator) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    if (!set_desc->internal_tree) {
+        return NULL;
+    }
+    return (cmagic_set_iterator_t)
+        set_desc->engine->lower_bound_by_function(set_desc->internal_tree, key, key_comparator);
+}
+
+cmagic_set_iterator_t
+cmagic_set_upper_bound_by(void *set_ptr, const void *key,
+                          cmagic_set_key_comparator_t key_comparator) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    if (!set_desc->internal_tree) {
+        return NULL;
+    }
+    return (cmagic_set_iterator_t)
+        set_desc->engine->upper_bound_by_function(set_desc->internal_tree, key, key_comparator);
+}
+
+cmagic_set_range_t
+cmagic_set_equal_range_by(void *set_ptr, const void *key,
+                          cmagic_set_key_comparator_t key_comparator) {
+    set_descriptor_t *set_desc = _get_set_descriptor(set_ptr);
+    assert(key_comparator);
+    if (!set_desc->internal_tree) {
+        return (cmagic_set_range_t) { .begin = NULL, .end = NULL };
+    }
+    cmagic_tree_iterator_t lower =
+        set_desc->engine->lower_bound_by_function(set_desc->internal_tree, key, key_comparator);
+    // Keys are unique, so the range holds at most one element
+    cmagic_tree_iterator_t upper = lower;
+    if (lower && key_comparator(key, lower->key) == 0) {
+        upper = cmagic_tree_engine_iterator_next(lower);
+    }
+    return (cmagic_set_range_t) {
+        .begin = (cmagic_set_iterator_t)lower,
+        .end = (cmagic_set_iterator_t)upper
+    };
 }
 
 const cmagic_memory_alloc_packet_t *
@@ -1,4 +1,5 @@
 #include "cmagic/utils.h"
+#include "key_comparators.h"
 
 uintptr_t
 cmagic_utils_align_address_up(uintptr_t unaligned_addr,
@@ -11,3 +12,23 @@ cmagic_utils_align_address_down(uintptr_t unaligned_addr,
                                 size_t required_alignment) {
     return unaligned_addr / required_alignment * required_alignment;
 }
+
+int
+cmagic_utils_compare_int32(const void *key1, const void *key2) {
+    return cmagic_tree_engine_compare_int32(key1, key2);
+}
+
+int
+cmagic_utils_compare_uint32(const void *key1, const void *key2) {
+    return cmagic_tree_engine_compare_uint32(key1, key2);
+}
+
+int
+cmagic_utils_compare_int64(const void *key1, const void *key2) {
+    return cmagic_tree_engine_compare_int64(key1, key2);
+}
+
+int
+cmagic_utils_compare_uint64(const void *key1, const void *key2) {
+    return cmagic_tree_engine_compare_uint64(key1, key2);
+}
@@ -2,12 +2,12 @@
 #include <string.h>
 #include "cmagic/vector.h"
 
-static const size_t VECTOR_MIN_CAPACITY = 5;
-
 #ifndef NDEBUG
 static const int_least32_t VECTOR_MAGIC_VALUE = 'V' << 24 | 'E' << 16 | 'C' << 8 | 'T';
+static const int_least32_t EMBEDDED_VECTOR_MAGIC_VALUE = 'E' << 24 | 'V' << 16 | 'E' << 8 | 'C';
 #endif
 
+// The data is NULL and the capacity is 0 until the first element is added
 typedef struct {
 #ifndef NDEBUG
     int_least32_t magic_value;
@@ -16,34 +16,67 @@ typedef struct {
     size_t size;
     size_t capacity;
     size_t member_size;
+    cmagic_vector_policy_t policy;
     void *data_begin;
 } vector_descriptor_t;
 
+_Static_assert(sizeof(vector_descriptor_t) <= sizeof(cmagic_vector_storage_t),
+               "vector storage is too small");
+_Static_assert(_Alignof(vector_descriptor_t) <= _Alignof(cmagic_vector_storage_t),
+               "vector storage is not aligned enough");
+
+static void _assert_policy(const cmagic_vector_policy_t *policy) {
+    assert(policy);
+    assert(policy->growth_percent > 100);
+    assert(policy->min_capacity > 0);
+    (void) policy;
+}
+
 void **
 cmagic_vector_new(size_t member_size, const cmagic_memory_alloc_packet_t *alloc_packet) {
-    vector_descriptor_t *vector_descriptor =
-        (vector_descriptor_t *) alloc_packet->malloc_function(sizeof(vector_descriptor_t));
-    if (!vector_descriptor) {
-        return NULL;
-    }
-
-    void *data_begin = alloc_packet->malloc_function(VECTOR_MIN_CAPACITY * member_size);
-    if (!data_begin) {
-        alloc_packet->free_function(vector_descriptor);
-        return NULL;
-    }
+    return cmagic_vector_new_ext(member_size, alloc_packet, &CMAGIC_VECTOR_POLICY_DEFAULT);
+}
 
+static void _init_vector_descriptor(vector_descriptor_t *vector_descriptor, size_t member_size,
+                                    const cmagic_memory_alloc_packet_t *alloc_packet,
+                                    const cmagic_vector_policy_t *policy) {
+    _assert_policy(policy);
     *vector_descriptor = (vector_descriptor_t) {
 #ifndef NDEBUG
         .magic_value = VECTOR_MAGIC_VALUE,
 #endif
         .alloc_packet = alloc_packet,
         .size = 0,
-        .capacity = VECTOR_MIN_CAPACITY,
+        .capacity = 0,
         .member_size = member_size,
-        .data_begin = data_begin
+        .policy = *policy,
+        .data_begin = NULL
     };
+}
+
+void **
+cmagic_vector_new_ext(size_t member_size, const cmagic_memory_alloc_packet_t *alloc_packet,
+                      const cmagic_vector_policy_t *policy) {
+    vector_descriptor_t *vector_descriptor =
+        (vector_descriptor_t *) alloc_packet->malloc_function(sizeof(vector_descriptor_t));
+    if (!vector_descriptor) {
+        return NULL;
+    }
+
+    _init_vector_descriptor(vector_descriptor, member_size, alloc_packet, policy);
+    return &vector_descriptor->data_begin;
+}
 
+void **
+cmagic_vector_init_ext(cmagic_vector_storage_t *storage, size_t member_size,
+                       const cmagic_memory_alloc_packet_t *alloc_packet,
+                       const cmagic_vector_policy_t *policy) {
+    assert(storage);
+    vector_descriptor_t *vector_descriptor = (vector_descriptor_t *)storage;
+    _init_vector_descriptor(vector_descriptor, member_size, alloc_packet, policy);
+#ifndef NDEBUG
+    vector_descriptor->magic_value = EMBEDDED_VECTOR_MAGIC_VALUE;
+#endif
     return &vector_descriptor->data_begin;
 }
 
@@ -51,13 +84,27 @@ static vector_descriptor_t *_get_vector_descriptor(void **vector_ptr) {
     assert(vector_ptr);
     vector_descriptor_t *result = (vector_descriptor_t *)(
         (const char *)vector_ptr - offsetof(vector_descriptor_t, data_begin));
-    assert(result->magic_value == VECTOR_MAGIC_VALUE);
+    assert(result->magic_value == VECTOR_MAGIC_VALUE
+           || result->magic_value == EMBEDDED_VECTOR_MAGIC_VALUE);
     return result;
 }
 
+static void _release_data(vector_descriptor_t *vector_descriptor) {
+    vector_descriptor->alloc_packet->free_function(vector_descriptor->data_begin);
+    vector_descriptor->data_begin = NULL;
+    vector_descriptor->size = 0;
+    vector_descriptor->capacity = 0;
+}
+
+void
+cmagic_vector_destroy(void **vector_ptr) {
+    _release_data(_get_vector_descriptor(vector_ptr));
+}
+
 void
 cmagic_vector_free(void **vector_ptr) {
     vector_descriptor_t *vector_descriptor = _get_vector_descriptor(vector_ptr);
+    assert(vector_descriptor->magic_value == VECTOR_MAGIC_VALUE);
     vector_descriptor->alloc_packet->free_function(vector_descriptor->data_begin);
     vector_descriptor->alloc_packet->free_function(vector_descriptor);
 }
@@ -65,6 +112,9 @@ cmagic_vector_free(void **vector_ptr) {
 static bool _change_capacity(vector_descriptor_t *vector_descriptor,
                             size_t new_capacity) {
     assert(vector_descriptor->size <= new_capacity);
+    if (new_capacity > SIZE_MAX / vector_descriptor->member_size) {
+        return false;
+    }
     void *new_data_begin = vector_descriptor->alloc_packet->realloc_function(
         vector_descriptor->data_begin, new_capacity * vector_descriptor->member_size);
     if (!new_data_begin) {
@@ -76,12 +126,34 @@ static bool _change_capacity(vector_descriptor_t *vector_descriptor,
     return true;
 }
 
+// Capacity after growing by the growth factor, split to avoid overflow of the multiplication
+static size_t _grown_capacity(const vector_descriptor_t *vector_descriptor) {
+    const size_t capacity = vector_descriptor->capacity;
+    const size_t growth_percent = vector_descriptor->policy.growth_percent;
+    if (capacity < vector_descriptor->policy.min_capacity) {
+        return vector_descriptor->policy.min_capacity;
+    }
+    const size_t result = capacity / 100 * growth_percent + capacity % 100 * growth_percent / 100;
+    return result > capacity ? result : capacity + 1;
+}
+
+// Makes room for size elements, growing by at least the growth factor to keep repeated growth
+// amortized constant
+static bool _ensure_capacity(vector_descriptor_t *vector_descriptor, size_t size) {
+    if (size <= vector_descriptor->capacity) {
+        return true;
+    }
+
+    const size_t grown_capacity = _grown_capacity(vector_descriptor);
+    return _change_capacity(vector_descriptor, size > grown_capacity ? size : grown_capacity);
+}
+
 bool
 cmagic_vector_allocate_back(void **vector_ptr) {
     vector_descriptor_t *vector_descriptor = _get_vector_descriptor(vector_ptr);
 
     if (vector_descriptor->size == vector_descriptor->capacity
-        && !_change_capacity(vector_descriptor, 2 * vector_descriptor->capacity)) {
+        && !_change_capacity(vector_descriptor, _grown_capacity(vector_descriptor))) {
         return false;
     }
 
@@ -108,11 +180,114 @@ void
 cmagic_vector_pop_back(void **vector_ptr) {
     vector_descriptor_t *vector_descriptor = _get_vector_descriptor(vector_ptr);
     assert(vector_descriptor->size > 0);
+    cmagic_vector_truncate(vector_ptr, vector_descriptor->size - 1);
+}
+
+void
+cmagic_vector_truncate(void **vector_ptr, size_t size) {
+    vector_descriptor_t *vector_descriptor = _get_vector_descriptor(vector_ptr);
+    assert(size <= vector_descriptor->size);
+    vector_descriptor->size = size;
+    if (!vector_descriptor->policy.auto_shrink) {
+        return;
+    }
 
-    vector_descriptor->size--;
-    if (vector_descriptor->capacity > VECTOR_MIN_CAPACITY
-        && vector_descriptor->size <= vector_descriptor->capacity / 4) {
-        (void) _change_capacity(vector_descriptor, vector_descriptor->capacity / 2);
+    // Ends with the same capacity as popping the elements one by one, but reallocates only once
+    size_t new_capacity = vector_descriptor->capacity;
+    while (new_capacity / 2 >= vector_descriptor->policy.min_capacity
+           && size <= new_capacity / 4) {
+        new_capacity /= 2;
+    }
+    if (new_capacity < vector_descriptor->capacity) {
+        (void) _change_capacity(vector_descriptor, new_capacity);
+    }
+}
+
+void
+cmagic_vector_clear(void **vector_ptr) {
+    cmagic_vector_truncate(vector_ptr, 0);
+}
+
+bool
+cmagic_vector_resize(void **vector_ptr, size_t size) {
+    vector_descriptor_t *vector_descriptor = _get_vector_descriptor(vector_ptr);
+    if (size <= vector_descriptor->size) {
+        cmagic_vector_truncate(vector_ptr, size);
+        return true;
+    }
+
+    if (!_ensure_capacity(vector_descriptor, size)) {
+        return false;
+    }
+    vector_descriptor->size = size;
+    return true;
+}
+
+bool
+cmagic_vector_insert_range(void **vector_ptr, size_t pos, const void *src, size_t count) {
+    vector_descriptor_t *vector_descriptor = _get_vector_descriptor(vector_ptr);
+    const size_t old_size = vector_descriptor->size;
+    assert(pos <= old_size);
+    if (count == 0) {
+        return true;
+    }
+    const size_t member_size = vector_descriptor->member_size;
+    if (count > SIZE_MAX / member_size - old_size
+        || !_ensure_capacity(vector_descriptor, old_size + count)) {
+        return false;
+    }
+
+    char *gap = (char *)vector_descriptor->data_begin + pos * member_size;
+    memmove(gap + count * member_size, gap, (old_size - pos) * member_size);
+    if (src) {
+        memcpy(gap, src, count * member_size);
+    }
+    vector_descriptor->size = old_size + count;
+    return true;
+}
+
+bool
+cmagic_vector_append(void **vector_ptr, const void *src, size_t count) {
+    return cmagic_vector_insert_range(vector_ptr, cmagic_vector_size(vector_ptr), src, count);
+}
+
+void
+cmagic_vector_erase_range(void **vector_ptr, size_t first, size_t last) {
+    vector_descriptor_t *vector_descriptor = _get_vector_descriptor(vector_ptr);
+    const size_t size = vector_descriptor->size;
+    assert(first <= last && last <= size);
+    if (first == last) {
+        return;
+    }
+
+    const size_t member_size = vector_descriptor->member_size;
+    char *data = (char *)vector_descriptor->data_begin;
+    memmove(data + first * member_size, data + last * member_size, (size - last) * member_size);
+    cmagic_vector_truncate(vector_ptr, size - (last - first));
+}
+
+bool
+cmagic_vector_reserve(void **vector_ptr, size_t capacity) {
+    vector_descriptor_t *vector_descriptor = _get_vector_descriptor(vector_ptr);
+    if (capacity <= vector_descriptor->capacity) {
+        return true;
+    }
+
+    return _change_capacity(vector_descriptor, capacity);
+}
+
+void
+cmagic_vector_shrink_to_fit(void **vector_ptr) {
+    vector_descriptor_t *vector_descriptor = _get_vector_descriptor(vector_ptr);
+    if (vector_descriptor->size == 0) {
+        _release_data(vector_descriptor);
+        return;
+    }
+    const size_t min_capacity = vector_descriptor->policy.min_capacity;
+    const size_t new_capacity = vector_descriptor->size > min_capacity
+        ? vector_descriptor->size : min_capacity;
+    if (new_capacity < vector_descriptor->capacity) {
+        (void) _change_capacity(vector_descriptor, new_capacity);
     }
 }
 
@@ -121,6 +296,22 @@ cmagic_vector_size(void **vector_ptr) {
     return _get_vector_descriptor(vector_ptr)->size;
 }
 
+size_t
+cmagic_vector_capacity(void **vector_ptr) {
+    return _get_vector_descriptor(vector_ptr)->capacity;
+}
+
+const cmagic_vector_policy_t *
+cmagic_vector_get_policy(void **vector_ptr) {
+    return &_get_vector_descriptor(vector_ptr)->policy;
+}
+
+void
+cmagic_vector_set_policy(void **vector_ptr, const cmagic_vector_policy_t *policy) {
+    _assert_policy(policy);
+    _get_vector_descriptor(vector_ptr)->policy = *policy;
+}
+
 const cmagic_memory_alloc_packet_t *
 cmagic_vector_get_alloc_packet(void **vector_ptr) {
     return _get_vector_descriptor(vector_ptr)->alloc_packet;
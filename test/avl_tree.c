@@ -298,6 +298,231 @@ static void test_DeleteNodeWithTwoKids(void) {
     CMAGIC_AVL_TREE_FREE(tree);
 }
 
+static void test_Bounds(void) {
+    CMAGIC_AVL_TREE(int) tree = CMAGIC_AVL_TREE_NEW(int, int_ptr_comparator,
+                                                    &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(tree);
+
+    const int keys[] = { 10, 40, 20, 50, 30 };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(keys); i++) {
+        cmagic_avl_tree_insert_result_t insert_result = CMAGIC_AVL_TREE_INSERT(tree, &keys[i], NULL);
+        TEST_ASSERT_NOT_NULL(insert_result.inserted_or_existing);
+        TEST_ASSERT_FALSE(insert_result.already_exists);
+    }
+
+    cmagic_avl_tree_iterator_t it = CMAGIC_AVL_TREE_LOWER_BOUND(tree, &(int){20});
+    TEST_ASSERT_EQUAL_INT(20, CMAGIC_AVL_TREE_GET_KEY(int, it));
+    it = CMAGIC_AVL_TREE_LOWER_BOUND(tree, &(int){25});
+    TEST_ASSERT_EQUAL_INT(30, CMAGIC_AVL_TREE_GET_KEY(int, it));
+    it = CMAGIC_AVL_TREE_LOWER_BOUND(tree, &(int){-5});
+    TEST_ASSERT_EQUAL_INT(10, CMAGIC_AVL_TREE_GET_KEY(int, it));
+    TEST_ASSERT_NULL(CMAGIC_AVL_TREE_LOWER_BOUND(tree, &(int){55}));
+
+    it = CMAGIC_AVL_TREE_UPPER_BOUND(tree, &(int){20});
+    TEST_ASSERT_EQUAL_INT(30, CMAGIC_AVL_TREE_GET_KEY(int, it));
+    it = CMAGIC_AVL_TREE_UPPER_BOUND(tree, &(int){25});
+    TEST_ASSERT_EQUAL_INT(30, CMAGIC_AVL_TREE_GET_KEY(int, it));
+    TEST_ASSERT_NULL(CMAGIC_AVL_TREE_UPPER_BOUND(tree, &(int){50}));
+
+    cmagic_avl_tree_range_t range = CMAGIC_AVL_TREE_EQUAL_RANGE(tree, &(int){40});
+    TEST_ASSERT_EQUAL_INT(40, CMAGIC_AVL_TREE_GET_KEY(int, range.begin));
+    TEST_ASSERT_EQUAL_INT(50, CMAGIC_AVL_TREE_GET_KEY(int, range.end));
+    range = CMAGIC_AVL_TREE_EQUAL_RANGE(tree, &(int){50});
+    TEST_ASSERT_EQUAL_INT(50, CMAGIC_AVL_TREE_GET_KEY(int, range.begin));
+    TEST_ASSERT_NULL(range.end);
+    range = CMAGIC_AVL_TREE_EQUAL_RANGE(tree, &(int){35});
+    TEST_ASSERT_TRUE(range.begin == range.end);
+    TEST_ASSERT_EQUAL_INT(40, CMAGIC_AVL_TREE_GET_KEY(int, range.begin));
+
+    CMAGIC_AVL_TREE_FREE(tree);
+}
+
+static void test_RandomInsertErase(void) {
+    // Tree nodes are bigger than the static memory pool allows, use the standard allocator instead
+    CMAGIC_AVL_TREE(int) tree = CMAGIC_AVL_TREE_NEW(int, int_ptr_comparator,
+                                                    &CMAGIC_MEMORY_ALLOC_PACKET_STD);
+    TEST_ASSERT_NOT_NULL(tree);
+
+    static int keys[10000];
+    const int keys_count = (int)CMAGIC_UTILS_ARRAY_SIZE(keys);
+    for (int i = 0; i < keys_count; i++) {
+        keys[i] = (int)(((unsigned)i * 7919u) % (unsigned)keys_count);
+        TEST_ASSERT_NOT_NULL(CMAGIC_AVL_TREE_INSERT(tree, &keys[i], NULL).inserted_or_existing);
+    }
+    TEST_ASSERT_EQUAL_size_t((size_t)keys_count, CMAGIC_AVL_TREE_SIZE(tree));
+
+    for (int key = 0; key < keys_count; key += 2) {
+        CMAGIC_AVL_TREE_ERASE(tree, &key);
+    }
+    TEST_ASSERT_EQUAL_size_t((size_t)keys_count / 2, CMAGIC_AVL_TREE_SIZE(tree));
+
+    int expected_key = 1;
+    for (cmagic_avl_tree_iterator_t it = CMAGIC_AVL_TREE_FIRST(tree);
+         it;
+         it = CMAGIC_AVL_TREE_ITERATOR_NEXT(it), expected_key += 2) {
+        TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_AVL_TREE_GET_KEY(int, it));
+    }
+    TEST_ASSERT_EQUAL_INT(keys_count + 1, expected_key);
+
+    CMAGIC_AVL_TREE_FREE(tree);
+}
+
+static void test_Build(void) {
+    static int keys[1000];
+    static cmagic_avl_tree_element_t elements[1000];
+    const int keys_count = (int)CMAGIC_UTILS_ARRAY_SIZE(keys);
+    for (int i = 0; i < keys_count; i++) {
+        keys[i] = 2 * i;
+        elements[i] = (cmagic_avl_tree_element_t){ .key = &keys[i], .value = &keys[i] };
+    }
+
+    CMAGIC_AVL_TREE(int) tree = CMAGIC_AVL_TREE_NEW(int, int_ptr_comparator,
+                                                    &CMAGIC_MEMORY_ALLOC_PACKET_STD);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_TRUE(cmagic_avl_tree_build(tree, elements, (size_t)keys_count));
+    TEST_ASSERT_EQUAL_size_t((size_t)keys_count, CMAGIC_AVL_TREE_SIZE(tree));
+
+    int expected_key = 0;
+    for (cmagic_avl_tree_iterator_t it = CMAGIC_AVL_TREE_FIRST(tree);
+         it;
+         it = CMAGIC_AVL_TREE_ITERATOR_NEXT(it), expected_key += 2) {
+        TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_AVL_TREE_GET_KEY(int, it));
+        TEST_ASSERT_EQUAL_PTR(it->key, it->value);
+    }
+    TEST_ASSERT_EQUAL_INT(2 * keys_count, expected_key);
+
+    // The built tree must stay balanced when modified later
+    static int odd_keys[1000];
+    for (int i = 0; i < keys_count; i++) {
+        odd_keys[i] = 2 * i + 1;
+        TEST_ASSERT_NOT_NULL(CMAGIC_AVL_TREE_INSERT(tree, &odd_keys[i], NULL).inserted_or_existing);
+        CMAGIC_AVL_TREE_ERASE(tree, &keys[i]);
+    }
+    expected_key = 1;
+    for (cmagic_avl_tree_iterator_t it = CMAGIC_AVL_TREE_FIRST(tree);
+         it;
+         it = CMAGIC_AVL_TREE_ITERATOR_NEXT(it), expected_key += 2) {
+        TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_AVL_TREE_GET_KEY(int, it));
+    }
+    TEST_ASSERT_EQUAL_INT(2 * keys_count + 1, expected_key);
+
+    CMAGIC_AVL_TREE_FREE(tree);
+}
+
+static void check_int_range(CMAGIC_AVL_TREE(int) tree, int first, int end) {
+    TEST_ASSERT_EQUAL_size_t((size_t)(end - first), CMAGIC_AVL_TREE_SIZE(tree));
+    int expected_key = first;
+    for (cmagic_avl_tree_iterator_t it = CMAGIC_AVL_TREE_FIRST(tree);
+         it;
+         it = CMAGIC_AVL_TREE_ITERATOR_NEXT(it), expected_key++) {
+        TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_AVL_TREE_GET_KEY(int, it));
+        TEST_ASSERT_EQUAL_PTR(it, CMAGIC_AVL_TREE_FIND(tree, &expected_key));
+    }
+    TEST_ASSERT_EQUAL_INT(end, expected_key);
+    expected_key = end;
+    for (cmagic_avl_tree_iterator_t it = CMAGIC_AVL_TREE_LAST(tree);
+         it;
+         it = CMAGIC_AVL_TREE_ITERATOR_PREV(it)) {
+        TEST_ASSERT_EQUAL_INT(--expected_key, CMAGIC_AVL_TREE_GET_KEY(int, it));
+    }
+    TEST_ASSERT_EQUAL_INT(first, expected_key);
+}
+
+static void test_SplitJoin(void) {
+    static int keys[1000];
+    const int keys_count = (int)CMAGIC_UTILS_ARRAY_SIZE(keys);
+    CMAGIC_AVL_TREE(int) tree = CMAGIC_AVL_TREE_NEW(int, int_ptr_comparator,
+                                                    &CMAGIC_MEMORY_ALLOC_PACKET_STD);
+    CMAGIC_AVL_TREE(int) right_tree = CMAGIC_AVL_TREE_NEW(int, int_ptr_comparator,
+                                                          &CMAGIC_MEMORY_ALLOC_PACKET_STD);
+    for (int i = 0; i < keys_count; i++) {
+        keys[i] = i;
+        TEST_ASSERT_NOT_NULL(CMAGIC_AVL_TREE_INSERT(tree, &keys[i], NULL).inserted_or_existing);
+    }
+
+    const int split_keys[] = { -1, 0, 1, 2, 100, 500, 998, 999, 1000 };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(split_keys); i++) {
+        const int split_key = split_keys[i];
+        const int left_end = CMAGIC_UTILS_MAX(0, CMAGIC_UTILS_MIN(split_key, keys_count));
+        cmagic_avl_tree_iterator_t moved = CMAGIC_AVL_TREE_FIND(tree, &(int){keys_count / 2});
+        TEST_ASSERT_TRUE(cmagic_avl_tree_split(tree, &split_key, right_tree));
+        check_int_range(tree, 0, left_end);
+        check_int_range(right_tree, left_end, keys_count);
+
+        // Both parts must stay balanced AVL trees
+        for (int key = 0; key < keys_count; key += 3) {
+            CMAGIC_AVL_TREE(int) part = key < left_end ? tree : right_tree;
+            CMAGIC_AVL_TREE_ERASE(part, &key);
+            TEST_ASSERT_NOT_NULL(
+                CMAGIC_AVL_TREE_INSERT(part, &keys[key], NULL).inserted_or_existing);
+        }
+
+        TEST_ASSERT_TRUE(cmagic_avl_tree_join(tree, right_tree));
+        check_int_range(tree, 0, keys_count);
+        TEST_ASSERT_EQUAL_size_t(0, CMAGIC_AVL_TREE_SIZE(right_tree));
+        TEST_ASSERT_NULL(CMAGIC_AVL_TREE_FIRST(right_tree));
+        TEST_ASSERT_EQUAL_INT(keys_count / 2, CMAGIC_AVL_TREE_GET_KEY(int, moved));
+    }
+
+    CMAGIC_AVL_TREE_FREE(tree);
+    CMAGIC_AVL_TREE_FREE(right_tree);
+}
+
+static void test_ExtractInsertNode(void) {
+    static int keys[100];
+    const int keys_count = (int)CMAGIC_UTILS_ARRAY_SIZE(keys);
+    CMAGIC_AVL_TREE(int) tree = CMAGIC_AVL_TREE_NEW(int, int_ptr_comparator,
+                                                    &CMAGIC_MEMORY_ALLOC_PACKET_STD);
+    CMAGIC_AVL_TREE(int) other_tree = CMAGIC_AVL_TREE_NEW(int, int_ptr_comparator,
+                                                          &CMAGIC_MEMORY_ALLOC_PACKET_STD);
+    for (int i = 0; i < keys_count; i++) {
+        keys[i] = i;
+        TEST_ASSERT_NOT_NULL(CMAGIC_AVL_TREE_INSERT(tree, &keys[i], &keys[i]).inserted_or_existing);
+    }
+
+    // Extract the elements with two kids first, iterators to their successors must stay valid
+    for (int i = 0; i < keys_count; i++) {
+        int key = (int)(((unsigned)i * 37u) % (unsigned)keys_count);
+        cmagic_avl_tree_iterator_t successor =
+            CMAGIC_AVL_TREE_ITERATOR_NEXT(CMAGIC_AVL_TREE_FIND(tree, &key));
+        cmagic_avl_tree_iterator_t node = cmagic_avl_tree_extract(tree, &key);
+        TEST_ASSERT_NOT_NULL(node);
+        TEST_ASSERT_EQUAL_PTR(&keys[key], node->key);
+        TEST_ASSERT_EQUAL_PTR(&keys[key], node->value);
+        TEST_ASSERT_NULL(CMAGIC_AVL_TREE_FIND(tree, &key));
+        if (successor) {
+            TEST_ASSERT_EQUAL_PTR(successor,
+                                  CMAGIC_AVL_TREE_FIND(tree, (const int *)successor->key));
+        }
+
+        cmagic_avl_tree_insert_result_t insert_result =
+            cmagic_avl_tree_insert_node(other_tree, node);
+        TEST_ASSERT_FALSE(insert_result.already_exists);
+        TEST_ASSERT_EQUAL_PTR(node, insert_result.inserted_or_existing);
+    }
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_AVL_TREE_SIZE(tree));
+    TEST_ASSERT_NULL(cmagic_avl_tree_extract(tree, &keys[0]));
+
+    int expected_key = 0;
+    for (cmagic_avl_tree_iterator_t it = CMAGIC_AVL_TREE_FIRST(other_tree);
+         it;
+         it = CMAGIC_AVL_TREE_ITERATOR_NEXT(it), expected_key++) {
+        TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_AVL_TREE_GET_KEY(int, it));
+    }
+    TEST_ASSERT_EQUAL_INT(keys_count, expected_key);
+
+    // A node with an already existing key stays detached
+    TEST_ASSERT_NOT_NULL(CMAGIC_AVL_TREE_INSERT(tree, &keys[5], NULL).inserted_or_existing);
+    cmagic_avl_tree_iterator_t node = cmagic_avl_tree_extract(tree, &keys[5]);
+    cmagic_avl_tree_insert_result_t insert_result = cmagic_avl_tree_insert_node(other_tree, node);
+    TEST_ASSERT_TRUE(insert_result.already_exists);
+    TEST_ASSERT_EQUAL_PTR(&keys[5], insert_result.inserted_or_existing->value);
+    cmagic_avl_tree_free_node(node, &CMAGIC_MEMORY_ALLOC_PACKET_STD);
+
+    CMAGIC_AVL_TREE_FREE(tree);
+    CMAGIC_AVL_TREE_FREE(other_tree);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_StringTree);
@@ -307,5 +532,10 @@ int main(void) {
     RUN_TEST(test_InsertManyDeleteOne);
     RUN_TEST(test_Clear);
     RUN_TEST(test_DeleteNodeWithTwoKids);
+    RUN_TEST(test_Bounds);
+    RUN_TEST(test_RandomInsertErase);
+    RUN_TEST(test_Build);
+    RUN_TEST(test_SplitJoin);
+    RUN_TEST(test_ExtractInsertNode);
     return UNITY_END();
 }
@@ -0,0 +1,71 @@
+#include <string.h>
+#include <stdlib.h>
+#include "cmagic/utils.h"
+#include "b_tree.h"
+#include "unity.h"
+
+#define KEYS_COUNT 2000
+
+static uint8_t memory_pool[1 << 18];
+
+void setUp(void) {
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+static int int_ptr_comparator(const void *key1, const void *key2) {
+    TEST_ASSERT_NOT_NULL(key1);
+    TEST_ASSERT_NOT_NULL(key2);
+    int int_key1 = *(int *)key1;
+    int int_key2 = *(int *)key2;
+    return int_key1 - int_key2;
+}
+
+static void test_IteratorsStayValid(void) {
+    static int keys[KEYS_COUNT];
+    static cmagic_b_tree_iterator_t iterators[KEYS_COUNT];
+    CMAGIC_B_TREE(int) tree = CMAGIC_B_TREE_NEW(int, int_ptr_comparator,
+                                                &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(tree);
+
+    // Odd keys land between the even ones, so they shift and split the leaves holding them
+    for (int i = 0; i < KEYS_COUNT; i++) {
+        keys[i] = i;
+    }
+    for (int i = 0; i < KEYS_COUNT; i += 2) {
+        iterators[i] = CMAGIC_B_TREE_INSERT(tree, &keys[i], &keys[i]).inserted_or_existing;
+        TEST_ASSERT_NOT_NULL(iterators[i]);
+    }
+    for (int i = 1; i < KEYS_COUNT; i += 2) {
+        iterators[i] = CMAGIC_B_TREE_INSERT(tree, &keys[i], &keys[i]).inserted_or_existing;
+        TEST_ASSERT_NOT_NULL(iterators[i]);
+    }
+    for (int i = 0; i < KEYS_COUNT; i++) {
+        TEST_ASSERT_EQUAL_PTR(iterators[i], CMAGIC_B_TREE_FIND(tree, &i));
+    }
+
+    // Erasing moves the remaining elements between the leaves and merges them
+    for (int i = 0; i < KEYS_COUNT; i++) {
+        if (i % 3 != 0) {
+            CMAGIC_B_TREE_ERASE(tree, &keys[i]);
+        }
+    }
+    for (int i = 0; i + 3 < KEYS_COUNT; i += 3) {
+        TEST_ASSERT_EQUAL_PTR(&keys[i], iterators[i]->key);
+        TEST_ASSERT_EQUAL_PTR(&keys[i], iterators[i]->value);
+        TEST_ASSERT_EQUAL_PTR(iterators[i + 3], CMAGIC_B_TREE_ITERATOR_NEXT(iterators[i]));
+        TEST_ASSERT_EQUAL_PTR(iterators[i], CMAGIC_B_TREE_ITERATOR_PREV(iterators[i + 3]));
+    }
+
+    CMAGIC_B_TREE_FREE(tree);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_IteratorsStayValid);
+    return UNITY_END();
+}
@@ -0,0 +1,94 @@
+#include <string.h>
+#include <stdlib.h>
+#include "cmagic/utils.h"
+#include "avl_tree.h"
+#include "compact_tree.h"
+#include "unity.h"
+
+#define KEYS_COUNT 2000
+
+static uint8_t memory_pool[1 << 18];
+
+void setUp(void) {
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+static int int_ptr_comparator(const void *key1, const void *key2) {
+    TEST_ASSERT_NOT_NULL(key1);
+    TEST_ASSERT_NOT_NULL(key2);
+    int int_key1 = *(int *)key1;
+    int int_key2 = *(int *)key2;
+    return int_key1 - int_key2;
+}
+
+static void test_EraseKeepsIterators(void) {
+    static int keys[KEYS_COUNT];
+    static cmagic_compact_tree_iterator_t iterators[KEYS_COUNT];
+    CMAGIC_COMPACT_TREE(int) tree =
+        CMAGIC_COMPACT_TREE_NEW(int, int_ptr_comparator, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    for (int i = 0; i < KEYS_COUNT; i++) {
+        keys[i] = (i * 7919) % KEYS_COUNT;
+        TEST_ASSERT_NOT_NULL(
+            CMAGIC_COMPACT_TREE_INSERT(tree, &keys[i], &keys[i]).inserted_or_existing);
+    }
+    for (int i = 0; i < KEYS_COUNT; i++) {
+        iterators[i] = CMAGIC_COMPACT_TREE_FIND(tree, &i);
+    }
+
+    for (int i = 0; i < KEYS_COUNT; i += 2) {
+        CMAGIC_COMPACT_TREE_ERASE(tree, &i);
+    }
+    for (int i = 1; i < KEYS_COUNT; i += 2) {
+        TEST_ASSERT_EQUAL_INT(i, CMAGIC_COMPACT_TREE_GET_KEY(int, iterators[i]));
+        TEST_ASSERT_EQUAL_PTR(iterators[i], CMAGIC_COMPACT_TREE_FIND(tree, &i));
+        if (i + 2 < KEYS_COUNT) {
+            TEST_ASSERT_EQUAL_PTR(iterators[i + 2],
+                                  CMAGIC_COMPACT_TREE_ITERATOR_NEXT(iterators[i]));
+        }
+    }
+
+    // Erased slots are reused, so the array doesn't grow
+    const size_t allocated_bytes = cmagic_memory_get_allocated_bytes();
+    for (int i = 0; i < KEYS_COUNT; i += 2) {
+        TEST_ASSERT_NOT_NULL(CMAGIC_COMPACT_TREE_INSERT(tree, &keys[i], NULL).inserted_or_existing);
+    }
+    TEST_ASSERT_EQUAL_size_t(allocated_bytes, cmagic_memory_get_allocated_bytes());
+    TEST_ASSERT_EQUAL_size_t(KEYS_COUNT, CMAGIC_COMPACT_TREE_SIZE(tree));
+
+    CMAGIC_COMPACT_TREE_FREE(tree);
+}
+
+static void test_SmallerThanAvlTree(void) {
+    static int keys[KEYS_COUNT];
+    for (int i = 0; i < KEYS_COUNT; i++) {
+        keys[i] = i;
+    }
+
+    CMAGIC_AVL_TREE(int) avl_tree = CMAGIC_AVL_TREE_NEW(int, int_ptr_comparator,
+                                                        &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    for (size_t i = 0; i < KEYS_COUNT; i++) {
+        TEST_ASSERT_NOT_NULL(CMAGIC_AVL_TREE_INSERT(avl_tree, &keys[i], NULL).inserted_or_existing);
+    }
+    const size_t avl_tree_bytes = cmagic_memory_get_allocated_bytes();
+    CMAGIC_AVL_TREE_FREE(avl_tree);
+
+    CMAGIC_COMPACT_TREE(int) tree =
+        CMAGIC_COMPACT_TREE_NEW(int, int_ptr_comparator, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    for (size_t i = 0; i < KEYS_COUNT; i++) {
+        TEST_ASSERT_NOT_NULL(CMAGIC_COMPACT_TREE_INSERT(tree, &keys[i], NULL).inserted_or_existing);
+    }
+    TEST_ASSERT_LESS_THAN_size_t(avl_tree_bytes, cmagic_memory_get_allocated_bytes());
+    CMAGIC_COMPACT_TREE_FREE(tree);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_EraseKeepsIterators);
+    RUN_TEST(test_SmallerThanAvlTree);
+    return UNITY_END();
+}
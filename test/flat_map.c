@@ -0,0 +1,252 @@
+#include "cmagic/flat_map.h"
+#include "cmagic/utils.h"
+#include "unity.h"
+
+void setUp(void) {
+    static uint8_t memory_pool[16000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+static CMAGIC_FLAT_MAP(int) new_flat_map(void) {
+    CMAGIC_FLAT_MAP(int) flat_map = CMAGIC_FLAT_MAP_NEW(int, int, cmagic_utils_compare_int32,
+                                                        &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(flat_map);
+    return flat_map;
+}
+
+// Keys are the even numbers below 200 inserted in scrambled order, values are keys times 10
+static CMAGIC_FLAT_MAP(int) new_filled_flat_map(void) {
+    CMAGIC_FLAT_MAP(int) flat_map = new_flat_map();
+    for (int i = 0; i < 100; i++) {
+        const int key = (i * 37 % 100) * 2;
+        cmagic_flat_map_insert_result_t result =
+            CMAGIC_FLAT_MAP_INSERT(flat_map, &key, &(int){key * 10});
+        TEST_ASSERT_NOT_NULL(result.inserted_or_existing.key);
+        TEST_ASSERT_FALSE(result.already_exists);
+        TEST_ASSERT_EQUAL_INT(key, CMAGIC_FLAT_MAP_GET_KEY(int, result.inserted_or_existing));
+        TEST_ASSERT_EQUAL_INT(key * 10,
+                              CMAGIC_FLAT_MAP_GET_VALUE(int, result.inserted_or_existing));
+    }
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_FLAT_MAP_SIZE(flat_map));
+    return flat_map;
+}
+
+static void assert_even_keys(CMAGIC_FLAT_MAP(int) flat_map, int count) {
+    TEST_ASSERT_EQUAL_size_t((size_t)count, CMAGIC_FLAT_MAP_SIZE(flat_map));
+    const int *keys = CMAGIC_FLAT_MAP_KEYS(int, flat_map);
+    const int *values = CMAGIC_FLAT_MAP_VALUES(int, flat_map);
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_INT(i * 2, keys[i]);
+        TEST_ASSERT_EQUAL_INT(i * 20, values[i]);
+    }
+}
+
+static void test_InsertAndFind(void) {
+    CMAGIC_FLAT_MAP(int) flat_map = new_filled_flat_map();
+    assert_even_keys(flat_map, 100);
+
+    for (int key = -1; key <= 200; key++) {
+        cmagic_flat_map_iterator_t found = CMAGIC_FLAT_MAP_FIND(flat_map, &key);
+        if (key >= 0 && key < 200 && key % 2 == 0) {
+            TEST_ASSERT_EQUAL_INT(key, CMAGIC_FLAT_MAP_GET_KEY(int, found));
+            TEST_ASSERT_EQUAL_INT(key * 10, CMAGIC_FLAT_MAP_GET_VALUE(int, found));
+        } else {
+            TEST_ASSERT_NULL(found.key);
+        }
+    }
+
+    cmagic_flat_map_insert_result_t result =
+        CMAGIC_FLAT_MAP_INSERT(flat_map, &(int){42}, &(int){-1});
+    TEST_ASSERT_TRUE(result.already_exists);
+    TEST_ASSERT_EQUAL_INT(420, CMAGIC_FLAT_MAP_GET_VALUE(int, result.inserted_or_existing));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_FLAT_MAP_SIZE(flat_map));
+
+    result = CMAGIC_FLAT_MAP_ALLOCATE(flat_map, &(int){43});
+    TEST_ASSERT_FALSE(result.already_exists);
+    *(int *)result.inserted_or_existing.value = 430;
+    TEST_ASSERT_EQUAL_INT(430, CMAGIC_FLAT_MAP_GET_VALUE(int,
+                          CMAGIC_FLAT_MAP_FIND(flat_map, &(int){43})));
+    TEST_ASSERT_EQUAL_INT(44, CMAGIC_FLAT_MAP_KEYS(int, flat_map)[23]);
+
+    CMAGIC_FLAT_MAP_FREE(flat_map);
+}
+
+static void test_BoundsAndIteration(void) {
+    CMAGIC_FLAT_MAP(int) flat_map = new_filled_flat_map();
+
+    TEST_ASSERT_EQUAL_INT(10, CMAGIC_FLAT_MAP_GET_KEY(int,
+                          CMAGIC_FLAT_MAP_LOWER_BOUND(flat_map, &(int){10})));
+    TEST_ASSERT_EQUAL_INT(12, CMAGIC_FLAT_MAP_GET_KEY(int,
+                          CMAGIC_FLAT_MAP_LOWER_BOUND(flat_map, &(int){11})));
+    TEST_ASSERT_EQUAL_INT(12, CMAGIC_FLAT_MAP_GET_KEY(int,
+                          CMAGIC_FLAT_MAP_UPPER_BOUND(flat_map, &(int){10})));
+    TEST_ASSERT_EQUAL_INT(0, CMAGIC_FLAT_MAP_GET_KEY(int,
+                          CMAGIC_FLAT_MAP_UPPER_BOUND(flat_map, &(int){-5})));
+    TEST_ASSERT_NULL(CMAGIC_FLAT_MAP_LOWER_BOUND(flat_map, &(int){199}).key);
+    TEST_ASSERT_NULL(CMAGIC_FLAT_MAP_UPPER_BOUND(flat_map, &(int){198}).key);
+
+    int expected_key = 0;
+    for (cmagic_flat_map_iterator_t it = CMAGIC_FLAT_MAP_FIRST(flat_map);
+         it.key;
+         it = CMAGIC_FLAT_MAP_ITERATOR_NEXT(flat_map, it)) {
+        TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_FLAT_MAP_GET_KEY(int, it));
+        expected_key += 2;
+    }
+    TEST_ASSERT_EQUAL_INT(200, expected_key);
+
+    for (cmagic_flat_map_iterator_t it = CMAGIC_FLAT_MAP_LAST(flat_map);
+         it.key;
+         it = CMAGIC_FLAT_MAP_ITERATOR_PREV(flat_map, it)) {
+        expected_key -= 2;
+        TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_FLAT_MAP_GET_KEY(int, it));
+    }
+    TEST_ASSERT_EQUAL_INT(0, expected_key);
+
+    CMAGIC_FLAT_MAP_FREE(flat_map);
+}
+
+static int destructed_values_sum;
+
+static void sum_destructor(void *key, void *value) {
+    TEST_ASSERT_NOT_NULL(key);
+    destructed_values_sum += *(int *)value;
+}
+
+static void test_EraseAndClear(void) {
+    CMAGIC_FLAT_MAP(int) flat_map = new_filled_flat_map();
+    destructed_values_sum = 0;
+
+    for (int key = 0; key < 200; key += 4) {
+        CMAGIC_FLAT_MAP_ERASE_EXT(flat_map, &key, sum_destructor);
+    }
+    CMAGIC_FLAT_MAP_ERASE_EXT(flat_map, &(int){1}, sum_destructor);
+    TEST_ASSERT_EQUAL_size_t(50, CMAGIC_FLAT_MAP_SIZE(flat_map));
+    TEST_ASSERT_EQUAL_INT((0 + 196) * 50 / 2 * 10, destructed_values_sum);
+    const int *keys = CMAGIC_FLAT_MAP_KEYS(int, flat_map);
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT_EQUAL_INT(i * 4 + 2, keys[i]);
+    }
+
+    CMAGIC_FLAT_MAP_ERASE_ITERATOR(flat_map, CMAGIC_FLAT_MAP_FIRST(flat_map));
+    CMAGIC_FLAT_MAP_ERASE_ITERATOR(flat_map, CMAGIC_FLAT_MAP_LAST(flat_map));
+    TEST_ASSERT_EQUAL_INT(6, CMAGIC_FLAT_MAP_GET_KEY(int, CMAGIC_FLAT_MAP_FIRST(flat_map)));
+    TEST_ASSERT_EQUAL_INT(194, CMAGIC_FLAT_MAP_GET_KEY(int, CMAGIC_FLAT_MAP_LAST(flat_map)));
+
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BATCH_INSERT(flat_map, &(int){1000}, &(int){1}));
+    destructed_values_sum = 0;
+    CMAGIC_FLAT_MAP_CLEAR_EXT(flat_map, sum_destructor);
+    TEST_ASSERT_EQUAL_INT((60 + 1940) * 48 / 2 + 1, destructed_values_sum);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_FLAT_MAP_SIZE(flat_map));
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_FLAT_MAP_BATCH_SIZE(flat_map));
+    TEST_ASSERT_NULL(CMAGIC_FLAT_MAP_FIRST(flat_map).key);
+    TEST_ASSERT_NULL(CMAGIC_FLAT_MAP_LAST(flat_map).key);
+    TEST_ASSERT_NULL(CMAGIC_FLAT_MAP_FIND(flat_map, &(int){6}).key);
+
+    CMAGIC_FLAT_MAP_FREE(flat_map);
+}
+
+static void test_BuildSorted(void) {
+    int keys[100];
+    int values[100];
+    for (int i = 0; i < 100; i++) {
+        keys[i] = i * 2;
+        values[i] = i * 20;
+    }
+
+    CMAGIC_FLAT_MAP(int) flat_map = new_flat_map();
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BUILD_SORTED(flat_map, keys, values, 0));
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_FLAT_MAP_SIZE(flat_map));
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BUILD_SORTED(flat_map, keys, values, 100));
+    assert_even_keys(flat_map, 100);
+    TEST_ASSERT_EQUAL_INT(1980, CMAGIC_FLAT_MAP_GET_VALUE(int,
+                          CMAGIC_FLAT_MAP_FIND(flat_map, &(int){198})));
+
+    CMAGIC_FLAT_MAP_FREE(flat_map);
+}
+
+static void test_BatchCommit(void) {
+    CMAGIC_FLAT_MAP(int) flat_map = new_flat_map();
+    for (int i = 0; i < 100; i += 2) {
+        TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_INSERT(flat_map, &(int){i * 2}, &(int){i * 20})
+                         .inserted_or_existing.key);
+    }
+
+    // Odd indices in scrambled order, each twice, then some keys already in the flat map
+    for (int i = 0; i < 100; i++) {
+        const int key = (i * 37 % 100) * 2;
+        if (key % 4 != 0) {
+            TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BATCH_INSERT(flat_map, &key, &(int){key * 10}));
+            TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BATCH_INSERT(flat_map, &key, &(int){-1}));
+        }
+    }
+    for (int key = 0; key < 40; key += 4) {
+        TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BATCH_INSERT(flat_map, &key, &(int){-1}));
+    }
+    TEST_ASSERT_EQUAL_size_t(110, CMAGIC_FLAT_MAP_BATCH_SIZE(flat_map));
+
+    // Pending elements are not visible before the commit
+    TEST_ASSERT_EQUAL_size_t(50, CMAGIC_FLAT_MAP_SIZE(flat_map));
+    TEST_ASSERT_NULL(CMAGIC_FLAT_MAP_FIND(flat_map, &(int){2}).key);
+
+    destructed_values_sum = 0;
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BATCH_COMMIT_EXT(flat_map, sum_destructor));
+    TEST_ASSERT_EQUAL_INT(-60, destructed_values_sum);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_FLAT_MAP_BATCH_SIZE(flat_map));
+    assert_even_keys(flat_map, 100);
+
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BATCH_COMMIT(flat_map));
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BATCH_INSERT(flat_map, &(int){-2}, &(int){-20}));
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BATCH_INSERT(flat_map, &(int){500}, &(int){5000}));
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_MAP_BATCH_COMMIT(flat_map));
+    TEST_ASSERT_EQUAL_size_t(102, CMAGIC_FLAT_MAP_SIZE(flat_map));
+    TEST_ASSERT_EQUAL_INT(-2, CMAGIC_FLAT_MAP_GET_KEY(int, CMAGIC_FLAT_MAP_FIRST(flat_map)));
+    TEST_ASSERT_EQUAL_INT(5000, CMAGIC_FLAT_MAP_GET_VALUE(int, CMAGIC_FLAT_MAP_LAST(flat_map)));
+
+    CMAGIC_FLAT_MAP_FREE(flat_map);
+}
+
+static void copy_negated(void *destination_key, void *destination_value, const void *source_key,
+                         const void *source_value) {
+    *(int *)destination_key = *(const int *)source_key;
+    *(int *)destination_value = -*(const int *)source_value;
+}
+
+static void test_Copy(void) {
+    CMAGIC_FLAT_MAP(int) flat_map = new_filled_flat_map();
+    CMAGIC_FLAT_MAP(int) copy = CMAGIC_FLAT_MAP_COPY(int, flat_map);
+    TEST_ASSERT_NOT_NULL(copy);
+    CMAGIC_FLAT_MAP(int) negated_copy = CMAGIC_FLAT_MAP_COPY_EXT(int, flat_map, copy_negated);
+    TEST_ASSERT_NOT_NULL(negated_copy);
+    CMAGIC_FLAT_MAP_FREE(flat_map);
+
+    assert_even_keys(copy, 100);
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_FLAT_MAP_SIZE(negated_copy));
+    TEST_ASSERT_EQUAL_INT(-1980, CMAGIC_FLAT_MAP_GET_VALUE(int,
+                          CMAGIC_FLAT_MAP_FIND(negated_copy, &(int){198})));
+
+    CMAGIC_FLAT_MAP(int) empty = new_flat_map();
+    CMAGIC_FLAT_MAP(int) empty_copy = CMAGIC_FLAT_MAP_COPY(int, empty);
+    TEST_ASSERT_NOT_NULL(empty_copy);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_FLAT_MAP_SIZE(empty_copy));
+
+    CMAGIC_FLAT_MAP_FREE(empty_copy);
+    CMAGIC_FLAT_MAP_FREE(empty);
+    CMAGIC_FLAT_MAP_FREE(negated_copy);
+    CMAGIC_FLAT_MAP_FREE(copy);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_InsertAndFind);
+    RUN_TEST(test_BoundsAndIteration);
+    RUN_TEST(test_EraseAndClear);
+    RUN_TEST(test_BuildSorted);
+    RUN_TEST(test_BatchCommit);
+    RUN_TEST(test_Copy);
+    return UNITY_END();
+}
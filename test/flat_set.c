@@ -0,0 +1,141 @@
+#include "cmagic/flat_set.h"
+#include "cmagic/utils.h"
+#include "unity.h"
+
+void setUp(void) {
+    static uint8_t memory_pool[16000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+static CMAGIC_FLAT_SET(uint64_t) new_flat_set(void) {
+    CMAGIC_FLAT_SET(uint64_t) flat_set = CMAGIC_FLAT_SET_NEW(
+        uint64_t, cmagic_utils_compare_uint64, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(flat_set);
+    return flat_set;
+}
+
+static void assert_keys(CMAGIC_FLAT_SET(uint64_t) flat_set, uint64_t count, uint64_t stride) {
+    TEST_ASSERT_EQUAL_size_t((size_t)count, CMAGIC_FLAT_SET_SIZE(flat_set));
+    const uint64_t *keys = CMAGIC_FLAT_SET_KEYS(uint64_t, flat_set);
+    for (uint64_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT64(i * stride, keys[i]);
+    }
+}
+
+static void test_InsertAndContains(void) {
+    CMAGIC_FLAT_SET(uint64_t) flat_set = new_flat_set();
+    for (uint64_t i = 0; i < 200; i++) {
+        const uint64_t key = i * 73 % 200 * 3;
+        cmagic_flat_set_insert_result_t result = CMAGIC_FLAT_SET_INSERT(flat_set, &key);
+        TEST_ASSERT_NOT_NULL(result.inserted_or_existing);
+        TEST_ASSERT_FALSE(result.already_exists);
+        TEST_ASSERT_EQUAL_UINT64(key, CMAGIC_FLAT_SET_GET_KEY(uint64_t,
+                                 result.inserted_or_existing));
+    }
+    assert_keys(flat_set, 200, 3);
+
+    for (uint64_t key = 0; key < 600; key++) {
+        TEST_ASSERT_EQUAL_INT(key % 3 == 0, CMAGIC_FLAT_SET_CONTAINS(flat_set, &key));
+    }
+    cmagic_flat_set_insert_result_t result = CMAGIC_FLAT_SET_INSERT(flat_set, &(uint64_t){300});
+    TEST_ASSERT_TRUE(result.already_exists);
+    TEST_ASSERT_EQUAL_PTR(CMAGIC_FLAT_SET_FIND(flat_set, &(uint64_t){300}),
+                          result.inserted_or_existing);
+
+    TEST_ASSERT_EQUAL_UINT64(300, CMAGIC_FLAT_SET_GET_KEY(uint64_t,
+                             CMAGIC_FLAT_SET_LOWER_BOUND(flat_set, &(uint64_t){298})));
+    TEST_ASSERT_EQUAL_UINT64(303, CMAGIC_FLAT_SET_GET_KEY(uint64_t,
+                             CMAGIC_FLAT_SET_UPPER_BOUND(flat_set, &(uint64_t){300})));
+    TEST_ASSERT_NULL(CMAGIC_FLAT_SET_UPPER_BOUND(flat_set, &(uint64_t){597}));
+
+    uint64_t expected_key = 597;
+    for (cmagic_flat_set_iterator_t it = CMAGIC_FLAT_SET_LAST(flat_set);
+         it;
+         it = CMAGIC_FLAT_SET_ITERATOR_PREV(flat_set, it)) {
+        TEST_ASSERT_EQUAL_UINT64(expected_key, CMAGIC_FLAT_SET_GET_KEY(uint64_t, it));
+        if (it != CMAGIC_FLAT_SET_FIRST(flat_set)) {
+            TEST_ASSERT_EQUAL_PTR(it, CMAGIC_FLAT_SET_ITERATOR_NEXT(flat_set,
+                                  CMAGIC_FLAT_SET_ITERATOR_PREV(flat_set, it)));
+            expected_key -= 3;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT64(0, expected_key);
+
+    CMAGIC_FLAT_SET_FREE(flat_set);
+}
+
+static int destructed_count;
+
+static void count_destructor(void *key) {
+    TEST_ASSERT_NOT_NULL(key);
+    destructed_count++;
+}
+
+static void test_EraseAndClear(void) {
+    CMAGIC_FLAT_SET(uint64_t) flat_set = new_flat_set();
+    for (uint64_t key = 0; key < 100; key++) {
+        TEST_ASSERT_NOT_NULL(CMAGIC_FLAT_SET_INSERT(flat_set, &key).inserted_or_existing);
+    }
+    destructed_count = 0;
+
+    for (uint64_t key = 1; key < 100; key += 2) {
+        CMAGIC_FLAT_SET_ERASE_EXT(flat_set, &key, count_destructor);
+    }
+    CMAGIC_FLAT_SET_ERASE_EXT(flat_set, &(uint64_t){1}, count_destructor);
+    TEST_ASSERT_EQUAL_INT(50, destructed_count);
+    assert_keys(flat_set, 50, 2);
+
+    CMAGIC_FLAT_SET_ERASE_ITERATOR(flat_set, CMAGIC_FLAT_SET_FIND(flat_set, &(uint64_t){98}));
+    assert_keys(flat_set, 49, 2);
+
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_SET_BATCH_INSERT(flat_set, &(uint64_t){1}));
+    CMAGIC_FLAT_SET_CLEAR_EXT(flat_set, count_destructor);
+    TEST_ASSERT_EQUAL_INT(100, destructed_count);
+    TEST_ASSERT_NULL(CMAGIC_FLAT_SET_FIRST(flat_set));
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_FLAT_SET_BATCH_SIZE(flat_set));
+
+    CMAGIC_FLAT_SET_FREE(flat_set);
+}
+
+static void test_BuildSortedAndBatch(void) {
+    uint64_t keys[100];
+    for (uint64_t i = 0; i < 100; i++) {
+        keys[i] = i * 4;
+    }
+
+    CMAGIC_FLAT_SET(uint64_t) flat_set = new_flat_set();
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_SET_BUILD_SORTED(flat_set, keys, 100));
+    assert_keys(flat_set, 100, 4);
+
+    // Keys in descending order fill the gaps, every second key is already in the flat set
+    for (uint64_t i = 200; i > 0; i--) {
+        TEST_ASSERT_TRUE(CMAGIC_FLAT_SET_BATCH_INSERT(flat_set, &(uint64_t){(i - 1) * 2}));
+    }
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_SET_BATCH_INSERT(flat_set, &(uint64_t){2}));
+    TEST_ASSERT_EQUAL_size_t(201, CMAGIC_FLAT_SET_BATCH_SIZE(flat_set));
+
+    destructed_count = 0;
+    TEST_ASSERT_TRUE(CMAGIC_FLAT_SET_BATCH_COMMIT_EXT(flat_set, count_destructor));
+    TEST_ASSERT_EQUAL_INT(101, destructed_count);
+    assert_keys(flat_set, 200, 2);
+
+    CMAGIC_FLAT_SET(uint64_t) copy = CMAGIC_FLAT_SET_COPY(uint64_t, flat_set);
+    TEST_ASSERT_NOT_NULL(copy);
+    CMAGIC_FLAT_SET_FREE(flat_set);
+    assert_keys(copy, 200, 2);
+
+    CMAGIC_FLAT_SET_FREE(copy);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_InsertAndContains);
+    RUN_TEST(test_EraseAndClear);
+    RUN_TEST(test_BuildSortedAndBatch);
+    return UNITY_END();
+}
@@ -0,0 +1,120 @@
+#include <string.h>
+#include "cmagic/hash.h"
+#include "cmagic/utils.h"
+#include "unity.h"
+
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_KnownAnswers(void) {
+    // Test vectors of wyhash, the input at index i is hashed with seed i. The last two, whose
+    // lengths are multiples of the 48 bytes hashed at once, come from a separate Python port of it
+    static const struct {
+        uint64_t hash;
+        const char *input;
+    } vectors[] = {
+        { UINT64_C(0x93228A4DE0EEC5A2), "" },
+        { UINT64_C(0xC5BAC3DB178713C4), "a" },
+        { UINT64_C(0xA97F2F7B1D9B3314), "abc" },
+        { UINT64_C(0x786D1F1DF3801DF4), "message digest" },
+        { UINT64_C(0xDCA5A8138AD37C87), "abcdefghijklmnopqrstuvwxyz" },
+        { UINT64_C(0xB9E734F117CFAF70),
+          "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789" },
+        { UINT64_C(0x6CC5EAB49A92D617),
+          "1234567890123456789012345678901234567890123456789012345678901234567890"
+          "1234567890" },
+        { UINT64_C(0x4B8F527C95882B62), "123456789012345678901234567890123456789012345678" },
+        { UINT64_C(0xF15DD0FB879E8383),
+          "123456789012345678901234567890123456789012345678"
+          "901234567890123456789012345678901234567890123456" }
+    };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(vectors); i++) {
+        TEST_ASSERT_EQUAL_UINT64(vectors[i].hash, cmagic_hash_bytes(vectors[i].input,
+                                                                   strlen(vectors[i].input), i));
+    }
+}
+
+static void test_AllLengthsDistinct(void) {
+    static uint8_t buffer[200 + 8];
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)(i * 7);
+    }
+
+    static uint64_t hashes[200];
+    for (size_t size = 0; size < CMAGIC_UTILS_ARRAY_SIZE(hashes); size++) {
+        hashes[size] = cmagic_hash_bytes(buffer, size, 0);
+        for (size_t j = 0; j < size; j++) {
+            TEST_ASSERT_NOT_EQUAL(hashes[j], hashes[size]);
+        }
+    }
+
+    // Misaligned input gives the same hash as aligned input with the same bytes
+    static uint8_t misaligned[200 + 3];
+    for (size_t offset = 1; offset < 4; offset++) {
+        memcpy(misaligned + offset, buffer, 200);
+        for (size_t size = 0; size <= 200; size += 13) {
+            TEST_ASSERT_EQUAL_UINT64(cmagic_hash_bytes(buffer, size, 0),
+                                    cmagic_hash_bytes(misaligned + offset, size, 0));
+        }
+    }
+}
+
+static void test_EveryByteMatters(void) {
+    uint8_t buffer[100] = { 0 };
+    for (size_t size = 1; size <= sizeof(buffer); size++) {
+        const uint64_t zeros_hash = cmagic_hash_bytes(buffer, size, 0);
+        TEST_ASSERT_NOT_EQUAL(zeros_hash, cmagic_hash_bytes(buffer, size, 1));
+        for (size_t i = 0; i < size; i++) {
+            buffer[i] = 1;
+            TEST_ASSERT_NOT_EQUAL(zeros_hash, cmagic_hash_bytes(buffer, size, 0));
+            buffer[i] = 0;
+        }
+    }
+}
+
+static void test_Mixers(void) {
+    TEST_ASSERT_EQUAL_UINT64(0, cmagic_hash_mix64(0));
+    TEST_ASSERT_NOT_EQUAL(cmagic_hash_mix64(1), cmagic_hash_mix64(2));
+    TEST_ASSERT_EQUAL_UINT32(0, cmagic_hash_mix32(0));
+    TEST_ASSERT_NOT_EQUAL(cmagic_hash_mix32(1), cmagic_hash_mix32(2));
+
+    // A single flipped input bit flips roughly half of the output bits
+    for (unsigned bit = 0; bit < 64; bit++) {
+        uint64_t difference =
+            cmagic_hash_mix64(12345) ^ cmagic_hash_mix64(12345 ^ (UINT64_C(1) << bit));
+        unsigned flipped = 0;
+        for (; difference; difference &= difference - 1) {
+            flipped++;
+        }
+        TEST_ASSERT_GREATER_OR_EQUAL_INT(16, (int)flipped);
+        TEST_ASSERT_LESS_OR_EQUAL_INT(48, (int)flipped);
+    }
+
+    const int32_t negative = -5;
+    const int64_t negative_wide = -5;
+    TEST_ASSERT_EQUAL_size_t(cmagic_hash_int32(&negative), cmagic_hash_int64(&negative_wide));
+    const uint32_t positive = 5;
+    const uint64_t positive_wide = 5;
+    TEST_ASSERT_EQUAL_size_t(cmagic_hash_uint32(&positive), cmagic_hash_uint64(&positive_wide));
+    TEST_ASSERT_EQUAL_size_t((size_t)cmagic_hash_mix64(5), cmagic_hash_uint64(&positive_wide));
+}
+
+static void test_Combine(void) {
+    const uint64_t x = cmagic_hash_mix64(1), y = cmagic_hash_mix64(2);
+    TEST_ASSERT_NOT_EQUAL(cmagic_hash_combine(cmagic_hash_combine(0, x), y),
+                          cmagic_hash_combine(cmagic_hash_combine(0, y), x));
+    TEST_ASSERT_NOT_EQUAL(cmagic_hash_combine(0, x), cmagic_hash_combine(1, x));
+    TEST_ASSERT_NOT_EQUAL(cmagic_hash_combine(0, x), x);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_KnownAnswers);
+    RUN_TEST(test_AllLengthsDistinct);
+    RUN_TEST(test_EveryByteMatters);
+    RUN_TEST(test_Mixers);
+    RUN_TEST(test_Combine);
+    return UNITY_END();
+}
@@ -0,0 +1,78 @@
+#include <cstdint>
+#include <string>
+#include "cmagic/hash.hpp"
+#include "cmagic/unordered_set.hpp"
+#include "unity.h"
+
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+
+struct point {
+    int x;
+    int y;
+
+    bool operator==(const point &other) const {
+        return x == other.x && y == other.y;
+    }
+};
+
+struct point_hash {
+    size_t operator()(const point &p) const {
+        size_t seed = 0;
+        cmagic::hash_combine(seed, p.x);
+        cmagic::hash_combine(seed, p.y);
+        return seed;
+    }
+};
+
+enum class color { red, green };
+
+void test_Specializations() {
+    const int32_t key = -5;
+    TEST_ASSERT_EQUAL_size_t(cmagic_hash_int32(&key), cmagic::hash<int32_t>()(key));
+    TEST_ASSERT_EQUAL_size_t(cmagic::hash<int>()(7), cmagic::hash<long long>()(7));
+    TEST_ASSERT_NOT_EQUAL(cmagic::hash<color>()(color::red), cmagic::hash<color>()(color::green));
+
+    int values[2] = {};
+    TEST_ASSERT_NOT_EQUAL(cmagic::hash<int *>()(&values[0]), cmagic::hash<int *>()(&values[1]));
+
+    TEST_ASSERT_EQUAL_size_t(cmagic::hash<double>()(0.0), cmagic::hash<double>()(-0.0));
+    TEST_ASSERT_NOT_EQUAL(cmagic::hash<double>()(1.0), cmagic::hash<double>()(2.0));
+    TEST_ASSERT_NOT_EQUAL(cmagic::hash<float>()(1.0f), cmagic::hash<float>()(2.0f));
+
+    const std::string text = "message digest";
+    TEST_ASSERT_EQUAL_size_t(cmagic_hash_bytes(text.data(), text.size(), 0),
+                             cmagic::hash<std::string>()(text));
+    TEST_ASSERT_EQUAL_size_t(cmagic::hash<std::string>()(text),
+                             cmagic::hash<std::string>()(std::string("message ") + "digest"));
+    TEST_ASSERT_NOT_EQUAL(cmagic::hash<std::string>()("ab"), cmagic::hash<std::string>()("ba"));
+    TEST_ASSERT_NOT_EQUAL(cmagic::hash<std::u16string>()(u"ab"),
+                          cmagic::hash<std::u16string>()(u"ba"));
+}
+
+void test_HashCombine() {
+    TEST_ASSERT_NOT_EQUAL(point_hash()(point {1, 2}), point_hash()(point {2, 1}));
+
+    cmagic::unordered_set<point, point_hash> points;
+    for (int x = 0; x < 30; x++) {
+        for (int y = 0; y < 30; y++) {
+            TEST_ASSERT_TRUE(points.insert(point {x, y}).second);
+        }
+    }
+    TEST_ASSERT_EQUAL_size_t(900, points.size());
+    TEST_ASSERT_TRUE(points.contains(point {29, 0}));
+    TEST_ASSERT_FALSE(points.contains(point {30, 0}));
+}
+
+} // namespace
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_Specializations);
+    RUN_TEST(test_HashCombine);
+    return UNITY_END();
+}
@@ -0,0 +1,212 @@
+#include "cmagic/hashmap.h"
+#include "cmagic/utils.h"
+#include "unity.h"
+
+void setUp(void) {
+    static uint8_t memory_pool[16000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+static size_t int_hash(const void *key) {
+    TEST_ASSERT_NOT_NULL(key);
+    return (size_t)*(const int *)key;
+}
+
+// Puts all keys into a single probe sequence
+static size_t constant_hash(const void *key) {
+    TEST_ASSERT_NOT_NULL(key);
+    return 42;
+}
+
+static CMAGIC_HASHMAP(int) new_filled_hashmap(int size) {
+    CMAGIC_HASHMAP(int) hashmap = CMAGIC_HASHMAP_NEW(int, int, int_hash, NULL,
+                                                     &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(hashmap);
+    for (int i = 0; i < size; i++) {
+        int value = i * 10;
+        cmagic_hashmap_insert_result_t result = CMAGIC_HASHMAP_INSERT(hashmap, &i, &value);
+        TEST_ASSERT_NOT_NULL(result.inserted_or_existing.key);
+        TEST_ASSERT_FALSE(result.already_exists);
+    }
+    TEST_ASSERT_EQUAL_size_t((size_t)size, CMAGIC_HASHMAP_SIZE(hashmap));
+    return hashmap;
+}
+
+static void test_InsertFind(void) {
+    CMAGIC_HASHMAP(int) hashmap = CMAGIC_HASHMAP_NEW(int, int, int_hash, NULL,
+                                                     &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(hashmap);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_HASHMAP_CAPACITY(hashmap));
+    TEST_ASSERT_NULL(CMAGIC_HASHMAP_FIND(hashmap, &(int){0}).key);
+    TEST_ASSERT_NULL(CMAGIC_HASHMAP_FIRST(hashmap).key);
+    CMAGIC_HASHMAP_FREE(hashmap);
+
+    hashmap = new_filled_hashmap(200);
+    const size_t capacity = CMAGIC_HASHMAP_CAPACITY(hashmap);
+    TEST_ASSERT_EQUAL_size_t(0, capacity & (capacity - 1));
+    TEST_ASSERT_GREATER_OR_EQUAL_size_t(200 * 8 / 7, capacity);
+
+    for (int i = 0; i < 200; i++) {
+        cmagic_hashmap_iterator_t it = CMAGIC_HASHMAP_FIND(hashmap, &i);
+        TEST_ASSERT_EQUAL_INT(i, CMAGIC_HASHMAP_GET_KEY(int, it));
+        TEST_ASSERT_EQUAL_INT(i * 10, CMAGIC_HASHMAP_GET_VALUE(int, it));
+    }
+    TEST_ASSERT_NULL(CMAGIC_HASHMAP_FIND(hashmap, &(int){-1}).key);
+    TEST_ASSERT_NULL(CMAGIC_HASHMAP_FIND(hashmap, &(int){200}).key);
+
+    cmagic_hashmap_insert_result_t result = CMAGIC_HASHMAP_INSERT(hashmap, &(int){7}, &(int){0});
+    TEST_ASSERT_TRUE(result.already_exists);
+    TEST_ASSERT_EQUAL_INT(70, CMAGIC_HASHMAP_GET_VALUE(int, result.inserted_or_existing));
+    TEST_ASSERT_EQUAL_size_t(200, CMAGIC_HASHMAP_SIZE(hashmap));
+
+    CMAGIC_HASHMAP_FREE(hashmap);
+}
+
+static void test_Collisions(void) {
+    CMAGIC_HASHMAP(int) hashmap = CMAGIC_HASHMAP_NEW(int, int, constant_hash, NULL,
+                                                     &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(hashmap);
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_NOT_NULL(CMAGIC_HASHMAP_INSERT(hashmap, &i, &i).inserted_or_existing.key);
+    }
+    for (int i = 0; i < 100; i += 3) {
+        CMAGIC_HASHMAP_ERASE(hashmap, &i);
+    }
+    for (int i = 0; i < 100; i++) {
+        cmagic_hashmap_iterator_t it = CMAGIC_HASHMAP_FIND(hashmap, &i);
+        if (i % 3 == 0) {
+            TEST_ASSERT_NULL(it.key);
+        } else {
+            TEST_ASSERT_EQUAL_INT(i, CMAGIC_HASHMAP_GET_VALUE(int, it));
+        }
+    }
+    TEST_ASSERT_EQUAL_size_t(66, CMAGIC_HASHMAP_SIZE(hashmap));
+    CMAGIC_HASHMAP_FREE(hashmap);
+}
+
+static void test_DeletedSlotsReused(void) {
+    CMAGIC_HASHMAP(int) hashmap = new_filled_hashmap(100);
+    const size_t capacity = CMAGIC_HASHMAP_CAPACITY(hashmap);
+
+    // Every key is new, so only cleaning up the deleted slots keeps the capacity
+    for (int i = 100; i < 10000; i++) {
+        TEST_ASSERT_NOT_NULL(CMAGIC_HASHMAP_INSERT(hashmap, &i, &i).inserted_or_existing.key);
+        CMAGIC_HASHMAP_ERASE(hashmap, &(int){i - 100});
+        TEST_ASSERT_EQUAL_size_t(100, CMAGIC_HASHMAP_SIZE(hashmap));
+    }
+    TEST_ASSERT_EQUAL_size_t(capacity, CMAGIC_HASHMAP_CAPACITY(hashmap));
+    for (int i = 9900; i < 10000; i++) {
+        TEST_ASSERT_EQUAL_INT(i, CMAGIC_HASHMAP_GET_VALUE(int, CMAGIC_HASHMAP_FIND(hashmap, &i)));
+    }
+
+    CMAGIC_HASHMAP_FREE(hashmap);
+}
+
+static int destructed_values_sum;
+
+static void sum_destructor(void *key, void *value) {
+    TEST_ASSERT_NOT_NULL(key);
+    destructed_values_sum += *(int *)value;
+}
+
+static void test_IterateAndErase(void) {
+    CMAGIC_HASHMAP(int) hashmap = new_filled_hashmap(50);
+
+    int keys_sum = 0;
+    size_t visited = 0;
+    for (cmagic_hashmap_iterator_t it = CMAGIC_HASHMAP_FIRST(hashmap);
+         it.key;
+         it = CMAGIC_HASHMAP_ITERATOR_NEXT(hashmap, it), visited++) {
+        keys_sum += CMAGIC_HASHMAP_GET_KEY(int, it);
+    }
+    TEST_ASSERT_EQUAL_size_t(50, visited);
+    TEST_ASSERT_EQUAL_INT(49 * 50 / 2, keys_sum);
+
+    // Erasing moves no element, so the iteration may continue
+    destructed_values_sum = 0;
+    cmagic_hashmap_iterator_t it = CMAGIC_HASHMAP_FIRST(hashmap);
+    while (it.key) {
+        cmagic_hashmap_iterator_t next = CMAGIC_HASHMAP_ITERATOR_NEXT(hashmap, it);
+        if (CMAGIC_HASHMAP_GET_KEY(int, it) % 2) {
+            CMAGIC_HASHMAP_ERASE_ITERATOR_EXT(hashmap, it, sum_destructor);
+        }
+        it = next;
+    }
+    TEST_ASSERT_EQUAL_INT(25 * 25 * 10, destructed_values_sum);
+    TEST_ASSERT_EQUAL_size_t(25, CMAGIC_HASHMAP_SIZE(hashmap));
+
+    destructed_values_sum = 0;
+    CMAGIC_HASHMAP_ERASE_EXT(hashmap, &(int){10}, sum_destructor);
+    CMAGIC_HASHMAP_ERASE_EXT(hashmap, &(int){11}, sum_destructor);
+    TEST_ASSERT_EQUAL_INT(100, destructed_values_sum);
+
+    const size_t capacity = CMAGIC_HASHMAP_CAPACITY(hashmap);
+    destructed_values_sum = 0;
+    CMAGIC_HASHMAP_CLEAR_EXT(hashmap, sum_destructor);
+    TEST_ASSERT_EQUAL_INT((49 * 50 / 2 - 25 * 25) * 10 - 100, destructed_values_sum);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_HASHMAP_SIZE(hashmap));
+    TEST_ASSERT_EQUAL_size_t(capacity, CMAGIC_HASHMAP_CAPACITY(hashmap));
+    TEST_ASSERT_NULL(CMAGIC_HASHMAP_FIRST(hashmap).key);
+
+    CMAGIC_HASHMAP_FREE(hashmap);
+}
+
+static void test_Reserve(void) {
+    CMAGIC_HASHMAP(int) hashmap = CMAGIC_HASHMAP_NEW(int, int, int_hash, NULL,
+                                                     &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(hashmap);
+    TEST_ASSERT_TRUE(CMAGIC_HASHMAP_RESERVE(hashmap, 300));
+    const size_t capacity = CMAGIC_HASHMAP_CAPACITY(hashmap);
+    TEST_ASSERT_GREATER_OR_EQUAL_size_t(300 * 8 / 7, capacity);
+
+    int *first_value = NULL;
+    for (int i = 0; i < 300; i++) {
+        cmagic_hashmap_iterator_t it = CMAGIC_HASHMAP_INSERT(hashmap, &i, &i).inserted_or_existing;
+        first_value = first_value ? first_value : (int *)it.value;
+    }
+    TEST_ASSERT_EQUAL_size_t(capacity, CMAGIC_HASHMAP_CAPACITY(hashmap));
+    TEST_ASSERT_EQUAL_PTR(first_value, CMAGIC_HASHMAP_FIND(hashmap, &(int){0}).value);
+    TEST_ASSERT_FALSE(CMAGIC_HASHMAP_RESERVE(hashmap, SIZE_MAX));
+    TEST_ASSERT_EQUAL_size_t(300, CMAGIC_HASHMAP_SIZE(hashmap));
+
+    CMAGIC_HASHMAP_FREE(hashmap);
+}
+
+static void test_Copy(void) {
+    CMAGIC_HASHMAP(int) hashmap = new_filled_hashmap(100);
+    CMAGIC_HASHMAP_ERASE(hashmap, &(int){50});
+    CMAGIC_HASHMAP(int) copy = CMAGIC_HASHMAP_COPY(int, hashmap);
+    TEST_ASSERT_NOT_NULL(copy);
+    CMAGIC_HASHMAP_FREE(hashmap);
+
+    TEST_ASSERT_EQUAL_size_t(99, CMAGIC_HASHMAP_SIZE(copy));
+    TEST_ASSERT_NULL(CMAGIC_HASHMAP_FIND(copy, &(int){50}).key);
+    for (int i = 0; i < 100; i++) {
+        if (i != 50) {
+            TEST_ASSERT_EQUAL_INT(i * 10, CMAGIC_HASHMAP_GET_VALUE(int,
+                                                                   CMAGIC_HASHMAP_FIND(copy, &i)));
+        }
+    }
+    cmagic_hashmap_insert_result_t result = CMAGIC_HASHMAP_INSERT(copy, &(int){50}, &(int){5});
+    TEST_ASSERT_NOT_NULL(result.inserted_or_existing.key);
+    TEST_ASSERT_FALSE(result.already_exists);
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_HASHMAP_SIZE(copy));
+
+    CMAGIC_HASHMAP_FREE(copy);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_InsertFind);
+    RUN_TEST(test_Collisions);
+    RUN_TEST(test_DeletedSlotsReused);
+    RUN_TEST(test_IterateAndErase);
+    RUN_TEST(test_Reserve);
+    RUN_TEST(test_Copy);
+    return UNITY_END();
+}
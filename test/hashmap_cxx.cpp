@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "cmagic/memory.h"
+#include "cmagic/unordered_map.hpp"
+#include "unity.h"
+
+
+void setUp() {
+    static uint8_t memory_pool[40000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+}
+
+void tearDown() {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+}
+
+namespace {
+
+// Points to itself, so moving it byte by byte would be noticed
+struct self_pointing {
+    const self_pointing *self;
+    int value;
+    static int alive;
+
+    explicit self_pointing(int value_arg = 0) : self(this), value(value_arg) { alive++; }
+    self_pointing(const self_pointing &other) : self(this), value(other.get()) { alive++; }
+    self_pointing &operator=(const self_pointing &other) {
+        value = other.get();
+        return *this;
+    }
+    ~self_pointing() { alive--; }
+
+    int get() const {
+        TEST_ASSERT_EQUAL_PTR(this, self);
+        return value;
+    }
+};
+
+int self_pointing::alive = 0;
+
+using word_map = cmagic::unordered_map<std::string, self_pointing>;
+
+template<typename Map>
+std::vector<std::pair<std::string, int>> sorted_elements_of(const Map &map) {
+    std::vector<std::pair<std::string, int>> elements;
+    for (const auto &element : map) {
+        elements.emplace_back(element.first, element.second.get());
+    }
+    std::sort(elements.begin(), elements.end());
+    return elements;
+}
+
+void test_InsertAndGrow() {
+    {
+        word_map words {word_map::custom_allocation_unordered_map()};
+        TEST_ASSERT_TRUE(words.empty());
+        TEST_ASSERT_TRUE(words.begin() == words.end());
+        for (int i = 0; i < 100; i++) {
+            auto inserted = words.try_emplace("word number " + std::to_string(i), i);
+            TEST_ASSERT_TRUE(inserted.second);
+            TEST_ASSERT_EQUAL_INT(i, inserted.first->second.get());
+        }
+        TEST_ASSERT_EQUAL_size_t(100, words.size());
+        TEST_ASSERT_EQUAL_INT(100, self_pointing::alive);
+
+        for (int i = 0; i < 100; i++) {
+            auto found = words.find("word number " + std::to_string(i));
+            TEST_ASSERT_TRUE(found != words.end());
+            TEST_ASSERT_EQUAL_INT(i, found->second.get());
+        }
+        TEST_ASSERT_TRUE(words.find("word number 100") == words.end());
+
+        auto existing = words.insert({ "word number 7", self_pointing {0} });
+        TEST_ASSERT_FALSE(existing.second);
+        TEST_ASSERT_EQUAL_INT(7, existing.first->second.get());
+        TEST_ASSERT_EQUAL_INT(0, words["new word"].get());
+        words["new word"].value = 5;
+        TEST_ASSERT_EQUAL_INT(5, words.find("new word")->second.get());
+        TEST_ASSERT_EQUAL_size_t(1, words.count("new word"));
+        TEST_ASSERT_EQUAL_size_t(101, words.size());
+    }
+    TEST_ASSERT_EQUAL_INT(0, self_pointing::alive);
+}
+
+void test_Erase() {
+    word_map words {word_map::custom_allocation_unordered_map()};
+    for (int i = 0; i < 10; i++) {
+        words.emplace(std::string(static_cast<size_t>(i + 1), 'a'), self_pointing {i});
+    }
+    TEST_ASSERT_EQUAL_size_t(1, words.erase("aaa"));
+    TEST_ASSERT_EQUAL_size_t(0, words.erase("aaa"));
+
+    for (auto it = words.begin(); it != words.end();) {
+        it = it->second.get() % 2 ? words.erase(it) : std::next(it);
+    }
+    TEST_ASSERT_TRUE((sorted_elements_of(words) == std::vector<std::pair<std::string, int>> {
+        { "a", 0 }, { "aaaaa", 4 }, { "aaaaaaa", 6 }, { "aaaaaaaaa", 8 }
+    }));
+    TEST_ASSERT_EQUAL_INT(4, self_pointing::alive);
+
+    const size_t capacity = words.capacity();
+    words.clear();
+    TEST_ASSERT_TRUE(words.empty());
+    TEST_ASSERT_EQUAL_size_t(capacity, words.capacity());
+    TEST_ASSERT_EQUAL_INT(0, self_pointing::alive);
+}
+
+void test_CopyAndMove() {
+    word_map words {word_map::custom_allocation_unordered_map()};
+    TEST_ASSERT_TRUE(words.reserve(20));
+    const size_t capacity = words.capacity();
+    for (int i = 0; i < 20; i++) {
+        words.try_emplace(std::to_string(i), i);
+    }
+    TEST_ASSERT_EQUAL_size_t(capacity, words.capacity());
+
+    word_map copy {words};
+    TEST_ASSERT_EQUAL_size_t(1, copy.erase("3"));
+    TEST_ASSERT_EQUAL_size_t(1, words.count("3"));
+    TEST_ASSERT_EQUAL_INT(39, self_pointing::alive);
+
+    word_map moved {std::move(words)};
+    TEST_ASSERT_FALSE(words);
+    TEST_ASSERT_TRUE(words.find("3") == words.end());
+    TEST_ASSERT_EQUAL_size_t(0, words.erase("3"));
+    TEST_ASSERT_EQUAL_size_t(20, moved.size());
+
+    // Inserting into the moved-from unordered map allocates it again
+    TEST_ASSERT_TRUE(words.try_emplace("3", 3).second);
+    TEST_ASSERT_TRUE(words);
+    TEST_ASSERT_EQUAL_size_t(1, words.size());
+    TEST_ASSERT_EQUAL_INT(40, self_pointing::alive);
+
+    words = copy;
+    TEST_ASSERT_TRUE(sorted_elements_of(words) == sorted_elements_of(copy));
+    moved = std::move(copy);
+    TEST_ASSERT_EQUAL_size_t(19, moved.size());
+    TEST_ASSERT_EQUAL_INT(38, self_pointing::alive);
+}
+
+void test_TrivialElements() {
+    cmagic::unordered_map<int, int> squares;
+    for (int i = 0; i < 1000; i++) {
+        squares[i] = i * i;
+    }
+    int sum = 0;
+    for (auto element : squares) {
+        TEST_ASSERT_EQUAL_INT(element.first * element.first, element.second);
+        sum += element.first;
+    }
+    TEST_ASSERT_EQUAL_INT(999 * 1000 / 2, sum);
+    TEST_ASSERT_EQUAL_INT(81, squares.find(9)->second);
+}
+
+} // namespace
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_InsertAndGrow);
+    RUN_TEST(test_Erase);
+    RUN_TEST(test_CopyAndMove);
+    RUN_TEST(test_TrivialElements);
+    return UNITY_END();
+}
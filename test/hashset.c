@@ -0,0 +1,105 @@
+#include "cmagic/hashset.h"
+#include "cmagic/utils.h"
+#include "unity.h"
+
+void setUp(void) {
+    static uint8_t memory_pool[16000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+static size_t uint64_hash(const void *key) {
+    TEST_ASSERT_NOT_NULL(key);
+    return (size_t)*(const uint64_t *)key;
+}
+
+// Stride of the keys is a multiple of every group count, so only the mixing spreads them
+#define KEY_STRIDE ((uint64_t)1 << 20)
+
+static CMAGIC_HASHSET(uint64_t) new_filled_hashset(uint64_t size) {
+    CMAGIC_HASHSET(uint64_t) hashset =
+        CMAGIC_HASHSET_NEW(uint64_t, uint64_hash, NULL, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(hashset);
+    for (uint64_t i = 0; i < size; i++) {
+        uint64_t key = i * KEY_STRIDE;
+        cmagic_hashset_insert_result_t result = CMAGIC_HASHSET_INSERT(hashset, &key);
+        TEST_ASSERT_NOT_NULL(result.inserted_or_existing);
+        TEST_ASSERT_FALSE(result.already_exists);
+        TEST_ASSERT_EQUAL_UINT64(key,
+                                 CMAGIC_HASHSET_GET_KEY(uint64_t, result.inserted_or_existing));
+    }
+    TEST_ASSERT_EQUAL_size_t((size_t)size, CMAGIC_HASHSET_SIZE(hashset));
+    return hashset;
+}
+
+static void test_Membership(void) {
+    CMAGIC_HASHSET(uint64_t) hashset = new_filled_hashset(300);
+
+    for (uint64_t i = 0; i < 300; i++) {
+        TEST_ASSERT_TRUE(CMAGIC_HASHSET_CONTAINS(hashset, &(uint64_t){i * KEY_STRIDE}));
+        TEST_ASSERT_FALSE(CMAGIC_HASHSET_CONTAINS(hashset, &(uint64_t){i * KEY_STRIDE + 1}));
+    }
+    TEST_ASSERT_NULL(CMAGIC_HASHSET_FIND(hashset, &(uint64_t){300 * KEY_STRIDE}));
+
+    cmagic_hashset_insert_result_t result = CMAGIC_HASHSET_INSERT(hashset, &(uint64_t){0});
+    TEST_ASSERT_TRUE(result.already_exists);
+    TEST_ASSERT_EQUAL_PTR(CMAGIC_HASHSET_FIND(hashset, &(uint64_t){0}),
+                          result.inserted_or_existing);
+    TEST_ASSERT_EQUAL_size_t(300, CMAGIC_HASHSET_SIZE(hashset));
+
+    CMAGIC_HASHSET_FREE(hashset);
+}
+
+static void test_EraseAndIterate(void) {
+    CMAGIC_HASHSET(uint64_t) hashset = new_filled_hashset(100);
+    for (uint64_t i = 0; i < 100; i += 2) {
+        CMAGIC_HASHSET_ERASE(hashset, &(uint64_t){i * KEY_STRIDE});
+    }
+    CMAGIC_HASHSET_ERASE(hashset, &(uint64_t){1});
+    TEST_ASSERT_EQUAL_size_t(50, CMAGIC_HASHSET_SIZE(hashset));
+
+    uint64_t sum = 0;
+    for (cmagic_hashset_iterator_t it = CMAGIC_HASHSET_FIRST(hashset);
+         it;
+         it = CMAGIC_HASHSET_ITERATOR_NEXT(hashset, it)) {
+        sum += CMAGIC_HASHSET_GET_KEY(uint64_t, it) / KEY_STRIDE;
+    }
+    TEST_ASSERT_EQUAL_UINT64(50 * 50, sum);
+
+    CMAGIC_HASHSET_ERASE_ITERATOR(hashset, CMAGIC_HASHSET_FIRST(hashset));
+    TEST_ASSERT_EQUAL_size_t(49, CMAGIC_HASHSET_SIZE(hashset));
+    CMAGIC_HASHSET_CLEAR(hashset);
+    TEST_ASSERT_NULL(CMAGIC_HASHSET_FIRST(hashset));
+    TEST_ASSERT_FALSE(CMAGIC_HASHSET_CONTAINS(hashset, &(uint64_t){KEY_STRIDE}));
+
+    CMAGIC_HASHSET_FREE(hashset);
+}
+
+static void test_Copy(void) {
+    CMAGIC_HASHSET(uint64_t) hashset = new_filled_hashset(200);
+    TEST_ASSERT_TRUE(CMAGIC_HASHSET_RESERVE(hashset, 400));
+    const size_t capacity = CMAGIC_HASHSET_CAPACITY(hashset);
+    CMAGIC_HASHSET(uint64_t) copy = CMAGIC_HASHSET_COPY(uint64_t, hashset);
+    TEST_ASSERT_NOT_NULL(copy);
+    CMAGIC_HASHSET_FREE(hashset);
+
+    TEST_ASSERT_EQUAL_size_t(capacity, CMAGIC_HASHSET_CAPACITY(copy));
+    TEST_ASSERT_EQUAL_size_t(200, CMAGIC_HASHSET_SIZE(copy));
+    for (uint64_t i = 0; i < 200; i++) {
+        TEST_ASSERT_TRUE(CMAGIC_HASHSET_CONTAINS(copy, &(uint64_t){i * KEY_STRIDE}));
+    }
+
+    CMAGIC_HASHSET_FREE(copy);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Membership);
+    RUN_TEST(test_EraseAndIterate);
+    RUN_TEST(test_Copy);
+    return UNITY_END();
+}
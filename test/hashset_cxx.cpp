@@ -0,0 +1,85 @@
+#include <string>
+#include <utility>
+#include "cmagic/memory.h"
+#include "cmagic/unordered_set.hpp"
+#include "unity.h"
+
+
+void setUp() {
+    static uint8_t memory_pool[20000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+}
+
+void tearDown() {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+}
+
+namespace {
+
+using string_set = cmagic::unordered_set<std::string>;
+
+void test_Strings() {
+    string_set names {string_set::custom_allocation_unordered_set()};
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(names.insert("name number " + std::to_string(i)).second);
+    }
+    TEST_ASSERT_FALSE(names.emplace("name number 42").second);
+    TEST_ASSERT_EQUAL_size_t(100, names.size());
+
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(names.contains("name number " + std::to_string(i)));
+    }
+    TEST_ASSERT_FALSE(names.contains("name number 100"));
+    TEST_ASSERT_EQUAL_STRING("name number 7", names.find("name number 7")->c_str());
+
+    TEST_ASSERT_EQUAL_size_t(1, names.erase("name number 7"));
+    TEST_ASSERT_EQUAL_size_t(0, names.erase("name number 7"));
+    size_t visited = 0;
+    for (auto it = names.begin(); it != names.end(); visited++) {
+        it = it->size() == 13 ? names.erase(it) : std::next(it);
+    }
+    TEST_ASSERT_EQUAL_size_t(99, visited);
+    TEST_ASSERT_EQUAL_size_t(90, names.size());
+    TEST_ASSERT_EQUAL_size_t(0, names.count("name number 1"));
+    TEST_ASSERT_EQUAL_size_t(1, names.count("name number 10"));
+}
+
+void test_CopyAndMove() {
+    string_set names {string_set::custom_allocation_unordered_set()};
+    for (const char *name : { "ada", "grace", "linus", "ken" }) {
+        names.insert(name);
+    }
+
+    string_set copy {names};
+    copy.erase("ada");
+    TEST_ASSERT_TRUE(names.contains("ada"));
+    TEST_ASSERT_EQUAL_size_t(3, copy.size());
+
+    string_set moved {std::move(names)};
+    TEST_ASSERT_FALSE(names);
+    TEST_ASSERT_FALSE(names.contains("ada"));
+    TEST_ASSERT_EQUAL_size_t(0, names.erase("ada"));
+    TEST_ASSERT_TRUE(moved.contains("ada"));
+
+    // Inserting into the moved-from unordered set allocates it again
+    TEST_ASSERT_TRUE(names.insert("ada").second);
+    TEST_ASSERT_TRUE(names);
+    TEST_ASSERT_EQUAL_size_t(1, names.size());
+
+    names = copy;
+    TEST_ASSERT_EQUAL_size_t(3, names.size());
+    TEST_ASSERT_TRUE(names.contains("ken"));
+    names.clear();
+    TEST_ASSERT_TRUE(names.empty());
+    TEST_ASSERT_TRUE(names.begin() == names.end());
+}
+
+} // namespace
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_Strings);
+    RUN_TEST(test_CopyAndMove);
+    return UNITY_END();
+}
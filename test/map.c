@@ -1,9 +1,10 @@
+#include <stdlib.h>
 #include "cmagic/map.h"
 #include "cmagic/utils.h"
 #include "unity.h"
 
 void setUp(void) {
-    static uint8_t memory_pool[5000];
+    static uint8_t memory_pool[16000];
     cmagic_memory_init(memory_pool, sizeof(memory_pool));
     TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
 }
@@ -84,8 +85,558 @@ static void test_Association(void) {
     CMAGIC_MAP_FREE(int_str_map);
 }
 
+static void test_RangeQueries(void) {
+    CMAGIC_MAP(int) int_int_map = CMAGIC_MAP_NEW(int, int, int_ptr_comparator,
+                                                 &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    for (int key = 0; key < 100; key += 10) {
+        cmagic_map_insert_result_t insert_result =
+            CMAGIC_MAP_INSERT(int_int_map, &key, &(int){key * 2});
+        TEST_ASSERT_NOT_NULL(insert_result.inserted_or_existing);
+    }
+
+    const int range_first = 25;
+    const int range_last = 60;
+    int expected_key = 30;
+    for (cmagic_map_iterator_t it = CMAGIC_MAP_LOWER_BOUND(int_int_map, &range_first),
+             end = CMAGIC_MAP_UPPER_BOUND(int_int_map, &range_last);
+         it != end;
+         it = CMAGIC_MAP_ITERATOR_NEXT(it), expected_key += 10) {
+        TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_MAP_GET_KEY(int, it));
+        TEST_ASSERT_EQUAL_INT(expected_key * 2, CMAGIC_MAP_GET_VALUE(int, it));
+    }
+    TEST_ASSERT_EQUAL_INT(70, expected_key);
+
+    cmagic_map_range_t range = CMAGIC_MAP_EQUAL_RANGE(int_int_map, &(int){90});
+    TEST_ASSERT_EQUAL_INT(90, CMAGIC_MAP_GET_KEY(int, range.begin));
+    TEST_ASSERT_NULL(range.end);
+    range = CMAGIC_MAP_EQUAL_RANGE(int_int_map, &(int){91});
+    TEST_ASSERT_NULL(range.begin);
+    TEST_ASSERT_NULL(range.end);
+
+    CMAGIC_MAP_FREE(int_int_map);
+}
+
+static void test_BTreeEngine(void) {
+    CMAGIC_MAP(int) int_int_map = CMAGIC_MAP_NEW_EXT(int, int, int_ptr_comparator,
+                                                     &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                     CMAGIC_MAP_ENGINE_B_TREE);
+    TEST_ASSERT_NOT_NULL(int_int_map);
+
+    const int keys_count = 50;
+    for (int i = 0; i < keys_count; i++) {
+        int key = (i * 17) % keys_count;
+        cmagic_map_insert_result_t insert_result =
+            CMAGIC_MAP_INSERT(int_int_map, &key, &(int){key * 2});
+        TEST_ASSERT_NOT_NULL(insert_result.inserted_or_existing);
+        TEST_ASSERT_FALSE(insert_result.already_exists);
+    }
+    TEST_ASSERT_EQUAL_size_t((size_t)keys_count, CMAGIC_MAP_SIZE(int_int_map));
+
+    int expected_key = 0;
+    for (cmagic_map_iterator_t it = CMAGIC_MAP_FIRST(int_int_map);
+         it;
+         it = CMAGIC_MAP_ITERATOR_NEXT(it), expected_key++) {
+        TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_MAP_GET_KEY(int, it));
+        TEST_ASSERT_EQUAL_INT(expected_key * 2, CMAGIC_MAP_GET_VALUE(int, it));
+    }
+    TEST_ASSERT_EQUAL_INT(keys_count, expected_key);
+
+    // Erasing moves other elements between the nodes, but their iterators stay valid
+    cmagic_map_iterator_t kept = CMAGIC_MAP_FIND(int_int_map, &(int){11});
+    for (int key = 0; key < keys_count; key += 2) {
+        CMAGIC_MAP_ERASE(int_int_map, &key);
+    }
+    TEST_ASSERT_EQUAL_size_t((size_t)keys_count / 2, CMAGIC_MAP_SIZE(int_int_map));
+    TEST_ASSERT_NULL(CMAGIC_MAP_FIND(int_int_map, &(int){10}));
+    TEST_ASSERT_EQUAL_PTR(kept, CMAGIC_MAP_FIND(int_int_map, &(int){11}));
+    TEST_ASSERT_EQUAL_INT(22, CMAGIC_MAP_GET_VALUE(int, kept));
+    TEST_ASSERT_EQUAL_INT(13,
+                          CMAGIC_MAP_GET_KEY(int, CMAGIC_MAP_UPPER_BOUND(int_int_map, &(int){11})));
+    TEST_ASSERT_EQUAL_INT(keys_count - 1, CMAGIC_MAP_GET_KEY(int, CMAGIC_MAP_LAST(int_int_map)));
+
+    CMAGIC_MAP_FREE(int_int_map);
+}
+
+static int destructed_values_sum;
+
+static void sum_destructor(void *key, void *value) {
+    TEST_ASSERT_NOT_NULL(key);
+    TEST_ASSERT_NOT_NULL(value);
+    destructed_values_sum += *(int *)value;
+}
+
+static void test_ClearWithDestructor(void) {
+    const cmagic_map_engine_t engines[] = {
+        CMAGIC_MAP_ENGINE_AVL_TREE, CMAGIC_MAP_ENGINE_B_TREE, CMAGIC_MAP_ENGINE_COMPACT_TREE
+    };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(engines); i++) {
+        CMAGIC_MAP(int) int_int_map = CMAGIC_MAP_NEW_EXT(int, int, int_ptr_comparator,
+                                                         &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                         engines[i]);
+        TEST_ASSERT_NOT_NULL(int_int_map);
+
+        int expected_sum = 0;
+        for (int key = 0; key < 40; key++) {
+            TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(int_int_map, &key, &key).inserted_or_existing);
+            expected_sum += key;
+        }
+
+        destructed_values_sum = 0;
+        CMAGIC_MAP_CLEAR_EXT(int_int_map, sum_destructor);
+        TEST_ASSERT_EQUAL_INT(expected_sum, destructed_values_sum);
+        TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MAP_SIZE(int_int_map));
+        TEST_ASSERT_NULL(CMAGIC_MAP_FIRST(int_int_map));
+
+        CMAGIC_MAP_FREE(int_int_map);
+    }
+}
+
+static void test_Merge(void) {
+    CMAGIC_MAP(int) even_map = CMAGIC_MAP_NEW(int, int, int_ptr_comparator,
+                                              &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    CMAGIC_MAP(int) triple_map = CMAGIC_MAP_NEW_EXT(int, int, int_ptr_comparator,
+                                                    &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                    CMAGIC_MAP_ENGINE_B_TREE);
+    for (int key = 0; key < 20; key++) {
+        if (key % 2 == 0) {
+            TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(even_map, &key, &key).inserted_or_existing);
+        }
+        if (key % 3 == 0) {
+            int value = -key;
+            TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(triple_map, &key, &value).inserted_or_existing);
+        }
+    }
+    const void *moved_value = CMAGIC_MAP_FIND(triple_map, &(int){9})->value;
+
+    TEST_ASSERT_TRUE(CMAGIC_MAP_MERGE(even_map, triple_map));
+
+    const int expected_keys[] = { 0, 2, 3, 4, 6, 8, 9, 10, 12, 14, 15, 16, 18 };
+    TEST_ASSERT_EQUAL_size_t(CMAGIC_UTILS_ARRAY_SIZE(expected_keys), CMAGIC_MAP_SIZE(even_map));
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(expected_keys); i++) {
+        int key = expected_keys[i];
+        int expected_value = key % 2 == 0 ? key : -key;
+        TEST_ASSERT_EQUAL_INT(expected_value,
+                              CMAGIC_MAP_GET_VALUE(int, CMAGIC_MAP_FIND(even_map, &key)));
+    }
+    TEST_ASSERT_EQUAL_PTR(moved_value, CMAGIC_MAP_FIND(even_map, &(int){9})->value);
+
+    // Elements with keys already present in the destination stay in the source
+    const int remaining_keys[] = { 0, 6, 12, 18 };
+    TEST_ASSERT_EQUAL_size_t(CMAGIC_UTILS_ARRAY_SIZE(remaining_keys), CMAGIC_MAP_SIZE(triple_map));
+    cmagic_map_iterator_t it = CMAGIC_MAP_FIRST(triple_map);
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(remaining_keys); i++) {
+        TEST_ASSERT_EQUAL_INT(remaining_keys[i], CMAGIC_MAP_GET_KEY(int, it));
+        TEST_ASSERT_EQUAL_INT(-remaining_keys[i], CMAGIC_MAP_GET_VALUE(int, it));
+        it = CMAGIC_MAP_ITERATOR_NEXT(it);
+    }
+    TEST_ASSERT_NULL(it);
+
+    TEST_ASSERT_TRUE(CMAGIC_MAP_MERGE(even_map, triple_map));
+    TEST_ASSERT_EQUAL_size_t(CMAGIC_UTILS_ARRAY_SIZE(remaining_keys), CMAGIC_MAP_SIZE(triple_map));
+
+    CMAGIC_MAP_FREE(even_map);
+    CMAGIC_MAP_FREE(triple_map);
+}
+
+static void test_MergeIntoEmpty(void) {
+    const cmagic_map_engine_t engines[] = {
+        CMAGIC_MAP_ENGINE_AVL_TREE, CMAGIC_MAP_ENGINE_B_TREE, CMAGIC_MAP_ENGINE_COMPACT_TREE
+    };
+    // Every source engine is merged into an empty map of every engine
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(engines); i++) {
+        for (size_t j = 0; j < CMAGIC_UTILS_ARRAY_SIZE(engines); j++) {
+            CMAGIC_MAP(int) map = CMAGIC_MAP_NEW_EXT(int, int, int_ptr_comparator,
+                                                     &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                     engines[i]);
+            CMAGIC_MAP(int) source_map = CMAGIC_MAP_NEW_EXT(
+                int, int, int_ptr_comparator, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                engines[j]);
+            for (int key = 0; key < 10; key++) {
+                int value = -key;
+                TEST_ASSERT_NOT_NULL(
+                    CMAGIC_MAP_INSERT(source_map, &key, &value).inserted_or_existing);
+            }
+
+            TEST_ASSERT_TRUE(CMAGIC_MAP_MERGE(map, source_map));
+            TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MAP_SIZE(source_map));
+            TEST_ASSERT_EQUAL_size_t(10, CMAGIC_MAP_SIZE(map));
+            int expected_key = 0;
+            for (cmagic_map_iterator_t it = CMAGIC_MAP_FIRST(map);
+                 it;
+                 it = CMAGIC_MAP_ITERATOR_NEXT(it), expected_key++) {
+                TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_MAP_GET_KEY(int, it));
+                TEST_ASSERT_EQUAL_INT(-expected_key, CMAGIC_MAP_GET_VALUE(int, it));
+            }
+            TEST_ASSERT_EQUAL_INT(10, expected_key);
+
+            // Both maps keep working with their own engine
+            TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(map, &(int){ 10 }, &(int){ 0 })
+                                 .inserted_or_existing);
+            TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(source_map, &(int){ 1 }, &(int){ 0 })
+                                 .inserted_or_existing);
+            TEST_ASSERT_EQUAL_size_t(11, CMAGIC_MAP_SIZE(map));
+            TEST_ASSERT_EQUAL_size_t(1, CMAGIC_MAP_SIZE(source_map));
+
+            CMAGIC_MAP_FREE(map);
+            CMAGIC_MAP_FREE(source_map);
+        }
+    }
+}
+
+static void test_SplitJoin(void) {
+    const cmagic_map_engine_t engines[] = {
+        CMAGIC_MAP_ENGINE_AVL_TREE, CMAGIC_MAP_ENGINE_B_TREE, CMAGIC_MAP_ENGINE_COMPACT_TREE
+    };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(engines); i++) {
+        CMAGIC_MAP(int) left_map = CMAGIC_MAP_NEW_EXT(int, int, int_ptr_comparator,
+                                                      &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                      engines[i]);
+        CMAGIC_MAP(int) right_map = CMAGIC_MAP_NEW_EXT(int, int, int_ptr_comparator,
+                                                       &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                       engines[i]);
+        for (int key = 0; key < 30; key++) {
+            int value = -key;
+            TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(left_map, &key, &value).inserted_or_existing);
+        }
+        const void *moved_value = CMAGIC_MAP_FIND(left_map, &(int){20})->value;
+
+        TEST_ASSERT_TRUE(CMAGIC_MAP_SPLIT(left_map, &(int){12}, right_map));
+        TEST_ASSERT_EQUAL_size_t(12, CMAGIC_MAP_SIZE(left_map));
+        TEST_ASSERT_EQUAL_size_t(18, CMAGIC_MAP_SIZE(right_map));
+        TEST_ASSERT_EQUAL_INT(11, CMAGIC_MAP_GET_KEY(int, CMAGIC_MAP_LAST(left_map)));
+        TEST_ASSERT_EQUAL_INT(12, CMAGIC_MAP_GET_KEY(int, CMAGIC_MAP_FIRST(right_map)));
+        TEST_ASSERT_NULL(CMAGIC_MAP_FIND(left_map, &(int){20}));
+        TEST_ASSERT_EQUAL_PTR(moved_value, CMAGIC_MAP_FIND(right_map, &(int){20})->value);
+        TEST_ASSERT_EQUAL_INT(-20,
+                              CMAGIC_MAP_GET_VALUE(int, CMAGIC_MAP_FIND(right_map, &(int){20})));
+
+        TEST_ASSERT_TRUE(CMAGIC_MAP_JOIN(left_map, right_map));
+        TEST_ASSERT_EQUAL_size_t(30, CMAGIC_MAP_SIZE(left_map));
+        TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MAP_SIZE(right_map));
+        int expected_key = 0;
+        for (cmagic_map_iterator_t it = CMAGIC_MAP_FIRST(left_map);
+             it;
+             it = CMAGIC_MAP_ITERATOR_NEXT(it), expected_key++) {
+            TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_MAP_GET_KEY(int, it));
+            TEST_ASSERT_EQUAL_INT(-expected_key, CMAGIC_MAP_GET_VALUE(int, it));
+        }
+        TEST_ASSERT_EQUAL_INT(30, expected_key);
+
+        CMAGIC_MAP_FREE(left_map);
+        CMAGIC_MAP_FREE(right_map);
+    }
+}
+
+static size_t copied_elements;
+
+static void counting_copy(void *destination_key, void *destination_value, const void *source_key,
+                          const void *source_value) {
+    *(int *)destination_key = *(const int *)source_key;
+    *(int *)destination_value = *(const int *)source_value;
+    copied_elements++;
+}
+
+static void counting_destructor(void *key, void *value) {
+    TEST_ASSERT_NOT_NULL(key);
+    TEST_ASSERT_NOT_NULL(value);
+    copied_elements--;
+}
+
+static size_t allocations_left;
+
+static void *limited_malloc(size_t size) {
+    if (allocations_left == 0) {
+        return NULL;
+    }
+    allocations_left--;
+    return cmagic_memory_malloc(size);
+}
+
+static const cmagic_memory_alloc_packet_t LIMITED_ALLOC_PACKET = {
+    limited_malloc, cmagic_memory_realloc, cmagic_memory_free
+};
+
+static void test_Copy(void) {
+    const cmagic_map_engine_t engines[] = {
+        CMAGIC_MAP_ENGINE_AVL_TREE, CMAGIC_MAP_ENGINE_B_TREE, CMAGIC_MAP_ENGINE_COMPACT_TREE
+    };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(engines); i++) {
+        allocations_left = SIZE_MAX;
+        CMAGIC_MAP(int) int_map = CMAGIC_MAP_NEW_EXT(int, int, int_ptr_comparator,
+                                                     &LIMITED_ALLOC_PACKET, engines[i]);
+        CMAGIC_MAP(int) empty_copy = CMAGIC_MAP_COPY(int, int_map);
+        TEST_ASSERT_NOT_NULL(empty_copy);
+        TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MAP_SIZE(empty_copy));
+        CMAGIC_MAP_FREE(empty_copy);
+
+        for (int key = 0; key < 30; key++) {
+            int value = -key;
+            TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(int_map, &key, &value).inserted_or_existing);
+        }
+
+        copied_elements = 0;
+        CMAGIC_MAP(int) copy = CMAGIC_MAP_COPY_EXT(int, int_map, counting_copy, NULL);
+        TEST_ASSERT_NOT_NULL(copy);
+        TEST_ASSERT_EQUAL_size_t(30, copied_elements);
+        TEST_ASSERT_EQUAL_size_t(30, CMAGIC_MAP_SIZE(copy));
+        CMAGIC_MAP_ERASE(int_map, &(int){10});
+        int expected_key = 0;
+        for (cmagic_map_iterator_t it = CMAGIC_MAP_FIRST(copy);
+             it;
+             it = CMAGIC_MAP_ITERATOR_NEXT(it), expected_key++) {
+            TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_MAP_GET_KEY(int, it));
+            TEST_ASSERT_EQUAL_INT(-expected_key, CMAGIC_MAP_GET_VALUE(int, it));
+        }
+        TEST_ASSERT_EQUAL_INT(30, expected_key);
+        TEST_ASSERT_EQUAL_INT(-29, CMAGIC_MAP_GET_VALUE(int, CMAGIC_MAP_FIND(copy, &(int){29})));
+        CMAGIC_MAP_INSERT(copy, &(int){100}, &(int){100});
+        TEST_ASSERT_NULL(CMAGIC_MAP_FIND(int_map, &(int){100}));
+        CMAGIC_MAP_FREE(copy);
+
+        // Elements copied before the allocation failure are destroyed and released
+        for (size_t limit = 0; limit < 40; limit += 3) {
+            copied_elements = 0;
+            allocations_left = limit;
+            TEST_ASSERT_NULL(CMAGIC_MAP_COPY_EXT(int, int_map, counting_copy,
+                                                 counting_destructor));
+            TEST_ASSERT_EQUAL_size_t(0, copied_elements);
+        }
+
+        CMAGIC_MAP_FREE(int_map);
+    }
+}
+
+static void test_ExtractInsertNode(void) {
+    CMAGIC_MAP(int) active_map = CMAGIC_MAP_NEW(int, int, int_ptr_comparator,
+                                                &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    CMAGIC_MAP(int) expired_map = CMAGIC_MAP_NEW(int, int, int_ptr_comparator,
+                                                 &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    for (int key = 0; key < 20; key++) {
+        int value = 100 + key;
+        TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(active_map, &key, &value).inserted_or_existing);
+    }
+    TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(expired_map, &(int){7}, &(int){0}).inserted_or_existing);
+    const size_t allocations = cmagic_memory_get_allocations();
+
+    for (int key = 0; key < 20; key += 2) {
+        cmagic_map_node_t node = CMAGIC_MAP_EXTRACT(active_map, &key);
+        TEST_ASSERT_NOT_NULL(node);
+        TEST_ASSERT_EQUAL_INT(key, CMAGIC_MAP_GET_KEY(int, node));
+        cmagic_map_insert_result_t insert_result = CMAGIC_MAP_INSERT_NODE(expired_map, node);
+        TEST_ASSERT_FALSE(insert_result.already_exists);
+        TEST_ASSERT_EQUAL_PTR(node, insert_result.inserted_or_existing);
+    }
+    TEST_ASSERT_NULL(CMAGIC_MAP_EXTRACT(active_map, &(int){0}));
+    TEST_ASSERT_EQUAL_size_t(allocations, cmagic_memory_get_allocations());
+    TEST_ASSERT_EQUAL_size_t(10, CMAGIC_MAP_SIZE(active_map));
+    TEST_ASSERT_EQUAL_size_t(11, CMAGIC_MAP_SIZE(expired_map));
+    TEST_ASSERT_EQUAL_INT(118, CMAGIC_MAP_GET_VALUE(int, CMAGIC_MAP_FIND(expired_map, &(int){18})));
+
+    cmagic_map_node_t node = CMAGIC_MAP_EXTRACT(active_map, &(int){7});
+    cmagic_map_insert_result_t insert_result = CMAGIC_MAP_INSERT_NODE(expired_map, node);
+    TEST_ASSERT_TRUE(insert_result.already_exists);
+    TEST_ASSERT_EQUAL_INT(0, CMAGIC_MAP_GET_VALUE(int, insert_result.inserted_or_existing));
+    destructed_values_sum = 0;
+    CMAGIC_MAP_NODE_FREE_EXT(node, CMAGIC_MAP_GET_ALLOC_PACKET(active_map), sum_destructor);
+    TEST_ASSERT_EQUAL_INT(107, destructed_values_sum);
+
+    CMAGIC_MAP_FREE(active_map);
+    CMAGIC_MAP_FREE(expired_map);
+}
+
+static void test_FindBatch(void) {
+    const cmagic_map_engine_t engines[] = {
+        CMAGIC_MAP_ENGINE_AVL_TREE, CMAGIC_MAP_ENGINE_B_TREE, CMAGIC_MAP_ENGINE_COMPACT_TREE
+    };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(engines); i++) {
+        CMAGIC_MAP(int) int_int_map = CMAGIC_MAP_NEW_EXT(int, int, int_ptr_comparator,
+                                                         &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                         engines[i]);
+        cmagic_map_iterator_t results[100];
+        CMAGIC_MAP_FIND_BATCH(int_int_map, &(int){0}, 1, results);
+        TEST_ASSERT_NULL(results[0]);
+
+        for (int key = 0; key < 40; key += 2) {
+            int value = 10 * key;
+            TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(int_int_map, &key, &value).inserted_or_existing);
+        }
+
+        // More keys than fit in a single chunk, odd and out of range keys are missing
+        int keys[CMAGIC_UTILS_ARRAY_SIZE(results)];
+        for (size_t j = 0; j < CMAGIC_UTILS_ARRAY_SIZE(keys); j++) {
+            keys[j] = (int)((j * 7) % 50) - 5;
+        }
+        CMAGIC_MAP_FIND_BATCH(int_int_map, keys, CMAGIC_UTILS_ARRAY_SIZE(keys), results);
+        for (size_t j = 0; j < CMAGIC_UTILS_ARRAY_SIZE(keys); j++) {
+            TEST_ASSERT_EQUAL_PTR(CMAGIC_MAP_FIND(int_int_map, &keys[j]), results[j]);
+            if (results[j]) {
+                TEST_ASSERT_EQUAL_INT(10 * keys[j], CMAGIC_MAP_GET_VALUE(int, results[j]));
+            }
+        }
+
+        CMAGIC_MAP_FREE(int_int_map);
+    }
+}
+
+// Compares a decimal number written as a string with an integer key
+static int decimal_int_comparator(const void *probe, const void *key) {
+    const int probe_value = atoi(*(const char *const *)probe);
+    const int key_value = *(const int *)key;
+    return probe_value < key_value ? -1 : probe_value > key_value;
+}
+
+static void test_FindBy(void) {
+    const cmagic_map_engine_t engines[] = {
+        CMAGIC_MAP_ENGINE_AVL_TREE, CMAGIC_MAP_ENGINE_B_TREE, CMAGIC_MAP_ENGINE_COMPACT_TREE
+    };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(engines); i++) {
+        CMAGIC_MAP(int) int_int_map = CMAGIC_MAP_NEW_EXT(int, int, int_ptr_comparator,
+                                                         &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                         engines[i]);
+        for (int key = 0; key < 100; key += 10) {
+            int value = -key;
+            TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(int_int_map, &key, &value).inserted_or_existing);
+        }
+
+        const char *probe = "30";
+        cmagic_map_iterator_t found =
+            CMAGIC_MAP_FIND_BY(int_int_map, &probe, decimal_int_comparator);
+        TEST_ASSERT_NOT_NULL(found);
+        TEST_ASSERT_EQUAL_INT(-30, CMAGIC_MAP_GET_VALUE(int, found));
+        TEST_ASSERT_EQUAL_PTR(found, CMAGIC_MAP_LOWER_BOUND_BY(int_int_map, &probe,
+                                                               decimal_int_comparator));
+        TEST_ASSERT_EQUAL_INT(40, CMAGIC_MAP_GET_KEY(int, CMAGIC_MAP_UPPER_BOUND_BY(
+            int_int_map, &probe, decimal_int_comparator)));
+        cmagic_map_range_t range =
+            CMAGIC_MAP_EQUAL_RANGE_BY(int_int_map, &probe, decimal_int_comparator);
+        TEST_ASSERT_EQUAL_PTR(found, range.begin);
+        TEST_ASSERT_EQUAL_PTR(CMAGIC_MAP_ITERATOR_NEXT(found), range.end);
+
+        probe = "35";
+        TEST_ASSERT_NULL(CMAGIC_MAP_FIND_BY(int_int_map, &probe, decimal_int_comparator));
+        TEST_ASSERT_EQUAL_INT(40, CMAGIC_MAP_GET_KEY(int, CMAGIC_MAP_LOWER_BOUND_BY(
+            int_int_map, &probe, decimal_int_comparator)));
+        range = CMAGIC_MAP_EQUAL_RANGE_BY(int_int_map, &probe, decimal_int_comparator);
+        TEST_ASSERT_EQUAL_PTR(range.begin, range.end);
+        CMAGIC_MAP_ERASE_BY(int_int_map, &probe, decimal_int_comparator);
+        TEST_ASSERT_EQUAL_size_t(10, CMAGIC_MAP_SIZE(int_int_map));
+
+        probe = "90";
+        CMAGIC_MAP_ERASE_BY(int_int_map, &probe, decimal_int_comparator);
+        TEST_ASSERT_EQUAL_size_t(9, CMAGIC_MAP_SIZE(int_int_map));
+        TEST_ASSERT_NULL(CMAGIC_MAP_FIND(int_int_map, &(int){90}));
+        TEST_ASSERT_EQUAL_INT(80, CMAGIC_MAP_GET_KEY(int, CMAGIC_MAP_LAST(int_int_map)));
+
+        CMAGIC_MAP_FREE(int_int_map);
+    }
+}
+
+static void test_BuiltinComparators(void) {
+    const cmagic_map_engine_t engines[] = {
+        CMAGIC_MAP_ENGINE_AVL_TREE, CMAGIC_MAP_ENGINE_B_TREE, CMAGIC_MAP_ENGINE_COMPACT_TREE
+    };
+    // Unsigned keys with the highest bit set must go after all others
+    const uint64_t unsigned_keys[] = { UINT64_MAX, 0, UINT64_C(1) << 63, 42, 7 };
+    const uint64_t sorted_unsigned_keys[] = { 0, 7, 42, UINT64_C(1) << 63, UINT64_MAX };
+    const int32_t signed_keys[] = { 5, INT32_MIN, -3, INT32_MAX, 0 };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(engines); i++) {
+        CMAGIC_MAP(uint64_t) uint_map = CMAGIC_MAP_NEW_EXT(
+            uint64_t, int, cmagic_utils_compare_uint64, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+            engines[i]);
+        for (size_t j = 0; j < CMAGIC_UTILS_ARRAY_SIZE(unsigned_keys); j++) {
+            int value = (int)j;
+            TEST_ASSERT_NOT_NULL(
+                CMAGIC_MAP_INSERT(uint_map, &unsigned_keys[j], &value).inserted_or_existing);
+        }
+        size_t position = 0;
+        for (cmagic_map_iterator_t it = CMAGIC_MAP_FIRST(uint_map);
+             it;
+             it = CMAGIC_MAP_ITERATOR_NEXT(it)) {
+            TEST_ASSERT_EQUAL_UINT64(sorted_unsigned_keys[position++],
+                                     CMAGIC_MAP_GET_KEY(uint64_t, it));
+        }
+        TEST_ASSERT_EQUAL_size_t(CMAGIC_UTILS_ARRAY_SIZE(unsigned_keys), position);
+        TEST_ASSERT_EQUAL_INT(2, CMAGIC_MAP_GET_VALUE(int, CMAGIC_MAP_FIND(
+            uint_map, &(uint64_t){ UINT64_C(1) << 63 })));
+        TEST_ASSERT_EQUAL_UINT64(UINT64_C(1) << 63, CMAGIC_MAP_GET_KEY(uint64_t,
+            CMAGIC_MAP_LOWER_BOUND(uint_map, &(uint64_t){ 43 })));
+        CMAGIC_MAP_ERASE(uint_map, &(uint64_t){ UINT64_MAX });
+        TEST_ASSERT_NULL(CMAGIC_MAP_UPPER_BOUND(uint_map, &(uint64_t){ UINT64_C(1) << 63 }));
+        CMAGIC_MAP_FREE(uint_map);
+
+        CMAGIC_MAP(int32_t) int_map = CMAGIC_MAP_NEW_EXT(
+            int32_t, int, cmagic_utils_compare_int32, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+            engines[i]);
+        for (size_t j = 0; j < CMAGIC_UTILS_ARRAY_SIZE(signed_keys); j++) {
+            int value = (int)j;
+            TEST_ASSERT_NOT_NULL(
+                CMAGIC_MAP_INSERT(int_map, &signed_keys[j], &value).inserted_or_existing);
+        }
+        TEST_ASSERT_EQUAL_INT(INT32_MIN, CMAGIC_MAP_GET_KEY(int32_t, CMAGIC_MAP_FIRST(int_map)));
+        TEST_ASSERT_EQUAL_INT(INT32_MAX, CMAGIC_MAP_GET_KEY(int32_t, CMAGIC_MAP_LAST(int_map)));
+        TEST_ASSERT_EQUAL_INT(0, CMAGIC_MAP_GET_KEY(int32_t,
+            CMAGIC_MAP_UPPER_BOUND(int_map, &(int32_t){ -3 })));
+        TEST_ASSERT_NULL(CMAGIC_MAP_FIND(int_map, &(int32_t){ 4 }));
+        CMAGIC_MAP_FREE(int_map);
+    }
+}
+
+static void test_Storage(void) {
+    cmagic_map_storage_t storage;
+    CMAGIC_MAP(int) int_map = CMAGIC_MAP_INIT(&storage, int, int, int_ptr_comparator,
+                                              &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(int_map);
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+
+    // An empty map answers every query without allocating its internal tree
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MAP_SIZE(int_map));
+    TEST_ASSERT_NULL(CMAGIC_MAP_FIRST(int_map));
+    TEST_ASSERT_NULL(CMAGIC_MAP_LAST(int_map));
+    TEST_ASSERT_NULL(CMAGIC_MAP_FIND(int_map, &(int){ 1 }));
+    TEST_ASSERT_NULL(CMAGIC_MAP_LOWER_BOUND(int_map, &(int){ 1 }));
+    CMAGIC_MAP_ERASE(int_map, &(int){ 1 });
+    CMAGIC_MAP_CLEAR(int_map);
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+
+    for (int i = 0; i < 10; i++) {
+        int value = i * 10;
+        TEST_ASSERT_NOT_NULL(CMAGIC_MAP_INSERT(int_map, &i, &value).inserted_or_existing);
+    }
+    TEST_ASSERT_EQUAL_size_t(10, CMAGIC_MAP_SIZE(int_map));
+    TEST_ASSERT_EQUAL_INT(50, CMAGIC_MAP_GET_VALUE(int, CMAGIC_MAP_FIND(int_map, &(int){ 5 })));
+
+    // Merging into an empty map takes over the source tree
+    cmagic_map_storage_t target_storage;
+    CMAGIC_MAP(int) target = CMAGIC_MAP_INIT(&target_storage, int, int, int_ptr_comparator,
+                                             &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_TRUE(CMAGIC_MAP_MERGE(target, int_map));
+    TEST_ASSERT_EQUAL_size_t(10, CMAGIC_MAP_SIZE(target));
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MAP_SIZE(int_map));
+    TEST_ASSERT_EQUAL_INT(0, CMAGIC_MAP_GET_KEY(int, CMAGIC_MAP_FIRST(target)));
+
+    CMAGIC_MAP(int) copy = CMAGIC_MAP_COPY(int, target);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_EQUAL_size_t(10, CMAGIC_MAP_SIZE(copy));
+    CMAGIC_MAP_FREE(copy);
+
+    CMAGIC_MAP_DESTROY(target);
+    CMAGIC_MAP_DESTROY(int_map);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_Association);
+    RUN_TEST(test_RangeQueries);
+    RUN_TEST(test_BTreeEngine);
+    RUN_TEST(test_ClearWithDestructor);
+    RUN_TEST(test_Merge);
+    RUN_TEST(test_MergeIntoEmpty);
+    RUN_TEST(test_SplitJoin);
+    RUN_TEST(test_Copy);
+    RUN_TEST(test_ExtractInsertNode);
+    RUN_TEST(test_FindBatch);
+    RUN_TEST(test_FindBy);
+    RUN_TEST(test_BuiltinComparators);
+    RUN_TEST(test_Storage);
     return UNITY_END();
 }
@@ -1,3 +1,6 @@
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <string>
 #include "cmagic/memory.h"
 #include "cmagic/map.hpp"
@@ -119,6 +122,360 @@ void test_CopyAndMove() {
     TEST_ASSERT_FALSE(str_int_map.find("Ellen") == str_int_map.end());
 }
 
+void test_MoveWithoutAllocation() {
+    using map_type = cmagic::map<std::string, int>;
+    static_assert(std::is_nothrow_move_constructible<map_type>::value,
+                  "map must be nothrow move constructible");
+    static_assert(std::is_nothrow_move_assignable<map_type>::value,
+                  "map must be nothrow move assignable");
+
+    map_type map = map_type::custom_allocation_map();
+    map["one"] = 1;
+    map["two"] = 2;
+    const size_t allocations = cmagic_memory_get_allocations();
+
+    map_type moved {std::move(map)};
+    TEST_ASSERT_EQUAL_size_t(allocations, cmagic_memory_get_allocations());
+    TEST_ASSERT_EQUAL_size_t(2, moved.size());
+    TEST_ASSERT_EQUAL_INT(2, moved.find("two")->second);
+
+    // Moved-from map is empty, can be searched and assigned to
+    TEST_ASSERT_FALSE(map);
+    TEST_ASSERT_TRUE(map.empty());
+    TEST_ASSERT_TRUE(map.begin() == map.end());
+    TEST_ASSERT_TRUE(map.find("one") == map.end());
+    TEST_ASSERT_TRUE(map.lower_bound("one") == map.end());
+    TEST_ASSERT_TRUE(map.equal_range("one").first == map.end());
+    map.erase("one");
+    map.clear();
+
+    map = moved;
+    TEST_ASSERT_TRUE(map);
+    TEST_ASSERT_EQUAL_size_t(2, map.size());
+    TEST_ASSERT_EQUAL_INT(1, map.find("one")->second);
+
+    moved = std::move(map);
+    TEST_ASSERT_FALSE(map);
+    TEST_ASSERT_EQUAL_size_t(allocations, cmagic_memory_get_allocations());
+    TEST_ASSERT_EQUAL_size_t(2, moved.size());
+
+    map_type copy_of_empty {map};
+    TEST_ASSERT_FALSE(copy_of_empty);
+    moved = copy_of_empty;
+    TEST_ASSERT_FALSE(moved);
+}
+
+void test_UseAfterMove() {
+    using map_type = cmagic::map<std::string, int>;
+    map_type map = map_type::custom_allocation_map();
+    map["one"] = 1;
+    map_type moved {std::move(map)};
+    const size_t allocations = cmagic_memory_get_allocations();
+
+    // Inserting into a moved-from map allocates it again with the same allocator
+    map["two"] = 2;
+    TEST_ASSERT_TRUE(map);
+    TEST_ASSERT_GREATER_THAN_size_t(allocations, cmagic_memory_get_allocations());
+    TEST_ASSERT_EQUAL_INT(2, map.find("two")->second);
+
+    moved = std::move(map);
+    TEST_ASSERT_TRUE(map.insert({ "three", 3 }).second);
+    moved = std::move(map);
+    TEST_ASSERT_TRUE(map.emplace("four", 4).second);
+    moved = std::move(map);
+    TEST_ASSERT_TRUE(map.try_emplace("five", 5).second);
+    moved = std::move(map);
+    TEST_ASSERT_TRUE(map.insert_or_assign("six", 6).second);
+    TEST_ASSERT_EQUAL_size_t(1, map.size());
+
+    // Moved-from maps take part in merge, split, join and node handling
+    map_type source {std::move(map)};
+    TEST_ASSERT_TRUE(map.merge(source));
+    TEST_ASSERT_EQUAL_size_t(1, map.size());
+    TEST_ASSERT_TRUE(source.merge(moved));
+    TEST_ASSERT_EQUAL_size_t(1, source.size());
+    TEST_ASSERT_EQUAL_size_t(0, moved.size());
+
+    map_type right {std::move(source)};
+    TEST_ASSERT_TRUE(map.split("six", source));
+    TEST_ASSERT_EQUAL_size_t(0, map.size());
+    TEST_ASSERT_EQUAL_size_t(1, source.size());
+    TEST_ASSERT_TRUE(right.join(source));
+    TEST_ASSERT_EQUAL_size_t(2, right.size());
+    map_type joined {std::move(right)};
+    TEST_ASSERT_TRUE(right.join(joined));
+    TEST_ASSERT_EQUAL_size_t(2, right.size());
+
+    map_type taken {std::move(source)};
+    TEST_ASSERT_TRUE(source.extract("six").empty());
+    map_type::node_type node = right.extract("six");
+    TEST_ASSERT_FALSE(node.empty());
+    map_type::insert_return_type insert_result = source.insert(std::move(node));
+    TEST_ASSERT_TRUE(insert_result.inserted);
+    TEST_ASSERT_EQUAL_INT(6, insert_result.position->second);
+}
+
+void test_RangeQueries() {
+    auto int_str_map = cmagic::map<int, std::string>::custom_allocation_map();
+    TEST_ASSERT_TRUE(int_str_map);
+
+    int_str_map.insert({ 10, "ten" });
+    int_str_map.insert({ 20, "twenty" });
+    int_str_map.insert({ 30, "thirty" });
+    int_str_map.insert({ 40, "forty" });
+
+    auto it = int_str_map.lower_bound(15);
+    const auto end = int_str_map.upper_bound(30);
+    TEST_ASSERT_EQUAL_INT(20, it->first);
+    TEST_ASSERT_EQUAL_STRING("twenty", it->second.c_str());
+    ++it;
+    TEST_ASSERT_EQUAL_INT(30, it->first);
+    ++it;
+    TEST_ASSERT_TRUE(it == end);
+    TEST_ASSERT_EQUAL_INT(40, end->first);
+
+    auto range = int_str_map.equal_range(40);
+    TEST_ASSERT_EQUAL_STRING("forty", range.first->second.c_str());
+    TEST_ASSERT_TRUE(range.second == int_str_map.end());
+    range = int_str_map.equal_range(5);
+    TEST_ASSERT_TRUE(range.first == range.second);
+    TEST_ASSERT_TRUE(range.first == int_str_map.begin());
+}
+
+struct instance_counter {
+    static int alive;
+    int id;
+
+    instance_counter(int id_arg = 0) : id(id_arg) { alive++; }
+    instance_counter(const instance_counter &x) : id(x.id) { alive++; }
+    ~instance_counter() { alive--; }
+};
+
+int instance_counter::alive = 0;
+
+void test_Clear() {
+    auto int_counter_map = cmagic::map<int, instance_counter>::custom_allocation_map();
+    TEST_ASSERT_TRUE(int_counter_map);
+
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_TRUE(int_counter_map.insert({ i, instance_counter(i) }).second);
+    }
+    TEST_ASSERT_EQUAL_INT(20, instance_counter::alive);
+
+    int_counter_map.clear();
+    TEST_ASSERT_EQUAL_INT(0, instance_counter::alive);
+    TEST_ASSERT_EQUAL_size_t(0, int_counter_map.size());
+    TEST_ASSERT_TRUE(int_counter_map.begin() == int_counter_map.end());
+
+    int_counter_map.insert({ 1, instance_counter(1) });
+    TEST_ASSERT_EQUAL_INT(1, instance_counter::alive);
+}
+
+void test_Merge() {
+    cmagic::map<int, std::string> x;
+    cmagic::map<int, std::string> y;
+    x.insert({ 1, "one" });
+    x.insert({ 3, "three" });
+    y.insert({ 2, "two" });
+    y.insert({ 3, "drei" });
+    y.insert({ 4, "four" });
+
+    TEST_ASSERT_TRUE(x.merge(y));
+    TEST_ASSERT_EQUAL_size_t(4, x.size());
+    int expected_key = 1;
+    for (const auto &element : x) {
+        TEST_ASSERT_EQUAL_INT(expected_key++, element.first);
+    }
+    TEST_ASSERT_EQUAL_STRING("three", x.find(3)->second.c_str());
+    TEST_ASSERT_EQUAL_STRING("four", x.find(4)->second.c_str());
+
+    TEST_ASSERT_EQUAL_size_t(1, y.size());
+    TEST_ASSERT_EQUAL_STRING("drei", y.find(3)->second.c_str());
+}
+
+void test_ExtractInsert() {
+    using map_type = cmagic::map<int, instance_counter>;
+    map_type active {map_type::custom_allocation_map()};
+    map_type expired {map_type::custom_allocation_map()};
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(active.insert({ i, instance_counter(i) }).second);
+    }
+    TEST_ASSERT_TRUE(expired.insert({ 3, instance_counter(-3) }).second);
+    const size_t allocations = cmagic_memory_get_allocations();
+
+    {
+        map_type::node_type node = active.extract(1);
+        TEST_ASSERT_FALSE(node.empty());
+        TEST_ASSERT_EQUAL_INT(1, node.mapped().id);
+        node.key() = 10;
+        map_type::insert_return_type result = expired.insert(std::move(node));
+        TEST_ASSERT_TRUE(result.inserted);
+        TEST_ASSERT_TRUE(result.node.empty());
+        TEST_ASSERT_EQUAL_INT(10, result.position->first);
+    }
+    TEST_ASSERT_EQUAL_size_t(allocations, cmagic_memory_get_allocations());
+    TEST_ASSERT_EQUAL_INT(6, instance_counter::alive);
+
+    {
+        map_type::insert_return_type result = expired.insert(active.extract(3));
+        TEST_ASSERT_FALSE(result.inserted);
+        TEST_ASSERT_EQUAL_INT(-3, result.position->second.id);
+        TEST_ASSERT_EQUAL_INT(3, result.node.mapped().id);
+    }
+    TEST_ASSERT_EQUAL_INT(5, instance_counter::alive);
+
+    TEST_ASSERT_TRUE(active.extract(42).empty());
+    TEST_ASSERT_FALSE(active.insert(map_type::node_type {}).inserted);
+}
+
+void test_EmplaceAndAssign() {
+    auto word_count = cmagic::map<std::string, int>::custom_allocation_map();
+    for (const char *word : { "b", "a", "b", "c", "b", "a" }) {
+        word_count[word]++;
+    }
+    TEST_ASSERT_EQUAL_size_t(3, word_count.size());
+    TEST_ASSERT_EQUAL_INT(2, word_count["a"]);
+    TEST_ASSERT_EQUAL_INT(3, word_count["b"]);
+    TEST_ASSERT_EQUAL_INT(1, word_count["c"]);
+
+    // Existing key is neither moved from nor overwritten
+    std::string key = "a";
+    auto result = word_count.try_emplace(std::move(key), 100);
+    TEST_ASSERT_FALSE(result.second);
+    TEST_ASSERT_EQUAL_STRING("a", key.c_str());
+    TEST_ASSERT_EQUAL_INT(2, result.first->second);
+    result = word_count.try_emplace("d", 4);
+    TEST_ASSERT_TRUE(result.second);
+    TEST_ASSERT_EQUAL_INT(4, result.first->second);
+
+    result = word_count.insert_or_assign("a", 10);
+    TEST_ASSERT_FALSE(result.second);
+    TEST_ASSERT_EQUAL_INT(10, word_count.find("a")->second);
+    result = word_count.insert_or_assign("e", 5);
+    TEST_ASSERT_TRUE(result.second);
+    TEST_ASSERT_EQUAL_STRING("e", result.first->first.c_str());
+
+    TEST_ASSERT_TRUE(word_count.emplace("f", 6).second);
+    result = word_count.emplace("f", 7);
+    TEST_ASSERT_FALSE(result.second);
+    TEST_ASSERT_EQUAL_INT(6, result.first->second);
+    TEST_ASSERT_EQUAL_size_t(6, word_count.size());
+
+    cmagic::map<int, std::string> int_str_map;
+    TEST_ASSERT_TRUE(int_str_map.try_emplace(3, size_t {3}, 'x').second);
+    TEST_ASSERT_EQUAL_STRING("xxx", int_str_map[3].c_str());
+    TEST_ASSERT_EQUAL_STRING("", int_str_map[4].c_str());
+    TEST_ASSERT_EQUAL_size_t(2, int_str_map.size());
+}
+
+struct counted_key {
+    static int constructions;
+    int id;
+
+    counted_key(int id_arg) : id(id_arg) { constructions++; }
+    counted_key(const counted_key &x) : id(x.id) { constructions++; }
+};
+
+int counted_key::constructions = 0;
+
+bool operator<(const counted_key &x, const counted_key &y) { return x.id < y.id; }
+bool operator<(const counted_key &x, int y) { return x.id < y; }
+bool operator<(int x, const counted_key &y) { return x < y.id; }
+
+void test_HeterogeneousLookup() {
+    cmagic::map<std::string, int> str_int_map;
+    str_int_map.insert({ "Alex", 100 });
+    str_int_map.insert({ "Barbara", 200 });
+    str_int_map.insert({ "Claudia", 300 });
+
+    const char *name = "Barbara";
+    TEST_ASSERT_EQUAL_INT(200, str_int_map.find(name)->second);
+    TEST_ASSERT_EQUAL_size_t(1, str_int_map.count(name));
+    TEST_ASSERT_EQUAL_size_t(0, str_int_map.count("Bob"));
+    TEST_ASSERT_EQUAL_size_t(1, str_int_map.count(std::string {"Alex"}));
+    TEST_ASSERT_EQUAL_STRING("Claudia", str_int_map.lower_bound("Bob")->first.c_str());
+    TEST_ASSERT_EQUAL_STRING("Claudia", str_int_map.upper_bound(name)->first.c_str());
+    auto range = str_int_map.equal_range(name);
+    TEST_ASSERT_TRUE(range.first == str_int_map.find("Barbara"));
+    TEST_ASSERT_TRUE(range.second == str_int_map.find("Claudia"));
+
+    str_int_map.erase(name);
+    TEST_ASSERT_EQUAL_size_t(2, str_int_map.size());
+    TEST_ASSERT_TRUE(str_int_map.find(name) == str_int_map.end());
+
+    cmagic::map<counted_key, int> counted_map;
+    for (int id = 0; id < 10; id++) {
+        counted_map.insert({ counted_key {id}, id });
+    }
+    TEST_ASSERT_TRUE(counted_map.find(5) != counted_map.end());
+    TEST_ASSERT_EQUAL_size_t(0, counted_map.count(10));
+
+    const int constructions = counted_key::constructions;
+    counted_map.erase(5);
+    TEST_ASSERT_EQUAL_size_t(9, counted_map.size());
+    TEST_ASSERT_EQUAL_INT(constructions, counted_key::constructions);
+}
+
+void test_IteratorsDoNotCopy() {
+    using map_type = cmagic::map<counted_key, std::string>;
+    map_type counted_map;
+    for (int id = 0; id < 5; id++) {
+        counted_map.insert({ counted_key {id}, "value" });
+    }
+
+    const int constructions = counted_key::constructions;
+    for (auto &&element : counted_map) {
+        element.second += "!";
+    }
+    map_type::iterator it = counted_map.find(counted_key {2});
+    it->second += "?";
+    const map_type &const_map = counted_map;
+    for (map_type::const_iterator const_it = const_map.begin(); const_it != const_map.end();
+         ++const_it) {
+        TEST_ASSERT_EQUAL_STRING(const_it->first.id == 2 ? "value!?" : "value!",
+                                 const_it->second.c_str());
+    }
+    map_type::const_iterator converted = it;
+    TEST_ASSERT_TRUE(converted == const_map.find(counted_key {2}));
+    TEST_ASSERT_TRUE(it == converted);
+    TEST_ASSERT_EQUAL_INT(5, std::distance(const_map.cbegin(), const_map.cend()));
+    TEST_ASSERT_EQUAL_INT(constructions + 2, counted_key::constructions);
+
+    // Copy of the element is made only on request
+    map_type::value_type copy = *it;
+    TEST_ASSERT_EQUAL_INT(2, copy.first.id);
+    TEST_ASSERT_EQUAL_STRING("value!?", copy.second.c_str());
+}
+
+void test_CustomOrder() {
+    cmagic::map<int, std::string, std::greater<int>> int_str_map;
+    for (int key : { 3, 1, 4, 5, 9, 2, 6 }) {
+        TEST_ASSERT_TRUE(int_str_map.insert({ key, std::to_string(key) }).second);
+    }
+
+    int expected = 9;
+    for (const auto &element : int_str_map) {
+        while (expected == 8 || expected == 7) {
+            expected--;
+        }
+        TEST_ASSERT_EQUAL_INT(expected--, element.first);
+    }
+    TEST_ASSERT_EQUAL_STRING("4", int_str_map.find(4)->second.c_str());
+    TEST_ASSERT_EQUAL_INT(6, int_str_map.lower_bound(8)->first);
+    TEST_ASSERT_EQUAL_INT(2, int_str_map.upper_bound(3)->first);
+    TEST_ASSERT_TRUE(int_str_map.lower_bound(0) == int_str_map.end());
+
+    // Integer keys in the natural order are compared inline by the tree
+    TEST_ASSERT_TRUE((cmagic::key_comparator<int, cmagic::less>::function()
+                      == cmagic_utils_compare_int32));
+    TEST_ASSERT_TRUE((cmagic::key_comparator<uint64_t, std::less<uint64_t>>::function()
+                      == cmagic_utils_compare_uint64));
+    TEST_ASSERT_TRUE((cmagic::key_comparator<int, std::greater<int>>::function()
+                      == cmagic::key_comparator<int, std::greater<int>>::compare));
+    TEST_ASSERT_TRUE((cmagic::key_comparator<std::string, cmagic::less>::function()
+                      == cmagic::key_comparator<std::string, cmagic::less>::compare));
+}
+
 } // namespace
 
 int main() {
@@ -127,5 +484,16 @@ int main() {
     RUN_TEST(test_Erase);
     RUN_TEST(test_RangeLoop);
     RUN_TEST(test_CopyAndMove);
+    RUN_TEST(test_MoveWithoutAllocation);
+    RUN_TEST(test_UseAfterMove);
+    RUN_TEST(test_RangeQueries);
+    RUN_TEST(test_Clear);
+    RUN_TEST(test_Merge);
+    RUN_TEST(test_ExtractInsert);
+    RUN_TEST(test_HeterogeneousLookup);
+    RUN_TEST(test_CustomOrder);
+    RUN_TEST(test_IteratorsDoNotCopy);
+    RUN_TEST(test_EmplaceAndAssign);
+    TEST_ASSERT_EQUAL_INT(0, instance_counter::alive);
     return UNITY_END();
 }
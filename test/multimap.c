@@ -0,0 +1,169 @@
+#include "cmagic/multimap.h"
+#include "cmagic/utils.h"
+#include "unity.h"
+
+void setUp(void) {
+    static uint8_t memory_pool[16000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+static int int_ptr_comparator(const void *key1, const void *key2) {
+    TEST_ASSERT_NOT_NULL(key1);
+    TEST_ASSERT_NOT_NULL(key2);
+    int int_key1 = *(int *)key1;
+    int int_key2 = *(int *)key2;
+    return int_key1 - int_key2;
+}
+
+// Keys 0..4 are inserted in rounds, every value records the order of its insertion
+static CMAGIC_MULTIMAP(int) new_filled_multimap(void) {
+    CMAGIC_MULTIMAP(int) multimap = CMAGIC_MULTIMAP_NEW(int, int, int_ptr_comparator,
+                                                        &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(multimap);
+    const int keys[] = { 3, 1, 4, 1, 0, 3, 2, 1, 4, 3, 1, 0 };
+    for (int i = 0; i < (int)CMAGIC_UTILS_ARRAY_SIZE(keys); i++) {
+        cmagic_map_iterator_t it = CMAGIC_MULTIMAP_INSERT(multimap, &keys[i], &i);
+        TEST_ASSERT_NOT_NULL(it);
+        TEST_ASSERT_EQUAL_INT(keys[i], CMAGIC_MAP_GET_KEY(int, it));
+        TEST_ASSERT_EQUAL_INT(i, CMAGIC_MAP_GET_VALUE(int, it));
+    }
+    TEST_ASSERT_EQUAL_size_t(CMAGIC_UTILS_ARRAY_SIZE(keys), CMAGIC_MULTIMAP_SIZE(multimap));
+    return multimap;
+}
+
+static void check_contents(CMAGIC_MULTIMAP(int) multimap, const int *expected_keys,
+                           const int *expected_values, size_t expected_size) {
+    TEST_ASSERT_EQUAL_size_t(expected_size, CMAGIC_MULTIMAP_SIZE(multimap));
+    size_t i = 0;
+    for (cmagic_map_iterator_t it = CMAGIC_MULTIMAP_FIRST(multimap);
+         it;
+         it = CMAGIC_MAP_ITERATOR_NEXT(it), i++) {
+        TEST_ASSERT_LESS_THAN_size_t(expected_size, i);
+        TEST_ASSERT_EQUAL_INT(expected_keys[i], CMAGIC_MAP_GET_KEY(int, it));
+        TEST_ASSERT_EQUAL_INT(expected_values[i], CMAGIC_MAP_GET_VALUE(int, it));
+    }
+    TEST_ASSERT_EQUAL_size_t(expected_size, i);
+}
+
+static void test_StableOrder(void) {
+    CMAGIC_MULTIMAP(int) multimap = new_filled_multimap();
+    const int expected_keys[] = { 0, 0, 1, 1, 1, 1, 2, 3, 3, 3, 4, 4 };
+    const int expected_values[] = { 4, 11, 1, 3, 7, 10, 6, 0, 5, 9, 2, 8 };
+    check_contents(multimap, expected_keys, expected_values,
+                   CMAGIC_UTILS_ARRAY_SIZE(expected_keys));
+
+    size_t i = CMAGIC_UTILS_ARRAY_SIZE(expected_keys);
+    for (cmagic_map_iterator_t it = CMAGIC_MULTIMAP_LAST(multimap);
+         it;
+         it = CMAGIC_MAP_ITERATOR_PREV(it)) {
+        i--;
+        TEST_ASSERT_EQUAL_INT(expected_values[i], CMAGIC_MAP_GET_VALUE(int, it));
+    }
+    TEST_ASSERT_EQUAL_size_t(0, i);
+
+    CMAGIC_MULTIMAP_FREE(multimap);
+}
+
+static void test_Lookup(void) {
+    CMAGIC_MULTIMAP(int) multimap = new_filled_multimap();
+
+    TEST_ASSERT_EQUAL_size_t(2, CMAGIC_MULTIMAP_COUNT(multimap, &(int){0}));
+    TEST_ASSERT_EQUAL_size_t(4, CMAGIC_MULTIMAP_COUNT(multimap, &(int){1}));
+    TEST_ASSERT_EQUAL_size_t(1, CMAGIC_MULTIMAP_COUNT(multimap, &(int){2}));
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MULTIMAP_COUNT(multimap, &(int){-1}));
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MULTIMAP_COUNT(multimap, &(int){5}));
+
+    TEST_ASSERT_EQUAL_INT(1, CMAGIC_MAP_GET_VALUE(int, CMAGIC_MULTIMAP_FIND(multimap, &(int){1})));
+    TEST_ASSERT_EQUAL_INT(0, CMAGIC_MAP_GET_VALUE(int, CMAGIC_MULTIMAP_FIND(multimap, &(int){3})));
+    TEST_ASSERT_NULL(CMAGIC_MULTIMAP_FIND(multimap, &(int){5}));
+
+    cmagic_map_range_t range = CMAGIC_MULTIMAP_EQUAL_RANGE(multimap, &(int){1});
+    const int expected_values[] = { 1, 3, 7, 10 };
+    size_t i = 0;
+    for (cmagic_map_iterator_t it = range.begin;
+         it != range.end;
+         it = CMAGIC_MAP_ITERATOR_NEXT(it)) {
+        TEST_ASSERT_EQUAL_INT(1, CMAGIC_MAP_GET_KEY(int, it));
+        TEST_ASSERT_EQUAL_INT(expected_values[i++], CMAGIC_MAP_GET_VALUE(int, it));
+    }
+    TEST_ASSERT_EQUAL_size_t(CMAGIC_UTILS_ARRAY_SIZE(expected_values), i);
+    TEST_ASSERT_EQUAL_INT(2, CMAGIC_MAP_GET_KEY(int, range.end));
+
+    range = CMAGIC_MULTIMAP_EQUAL_RANGE(multimap, &(int){4});
+    TEST_ASSERT_EQUAL_INT(2, CMAGIC_MAP_GET_VALUE(int, range.begin));
+    TEST_ASSERT_NULL(range.end);
+    range = CMAGIC_MULTIMAP_EQUAL_RANGE(multimap, &(int){-1});
+    TEST_ASSERT_TRUE(range.begin == range.end);
+    TEST_ASSERT_TRUE(range.begin == CMAGIC_MULTIMAP_FIRST(multimap));
+    TEST_ASSERT_TRUE(CMAGIC_MULTIMAP_UPPER_BOUND(multimap, &(int){3})
+                     == CMAGIC_MULTIMAP_LOWER_BOUND(multimap, &(int){4}));
+
+    CMAGIC_MULTIMAP_FREE(multimap);
+}
+
+static int destructed_values_sum;
+
+static void sum_destructor(void *key, void *value) {
+    TEST_ASSERT_NOT_NULL(key);
+    destructed_values_sum += *(int *)value;
+}
+
+static void test_Erase(void) {
+    CMAGIC_MULTIMAP(int) multimap = new_filled_multimap();
+
+    destructed_values_sum = 0;
+    TEST_ASSERT_EQUAL_size_t(4, CMAGIC_MULTIMAP_ERASE_EXT(multimap, &(int){1}, sum_destructor));
+    TEST_ASSERT_EQUAL_INT(1 + 3 + 7 + 10, destructed_values_sum);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MULTIMAP_ERASE(multimap, &(int){1}));
+
+    cmagic_map_iterator_t second_three =
+        CMAGIC_MAP_ITERATOR_NEXT(CMAGIC_MULTIMAP_FIND(multimap, &(int){3}));
+    CMAGIC_MULTIMAP_ERASE_ITERATOR(multimap, second_three);
+    CMAGIC_MULTIMAP_ERASE_ITERATOR(multimap, CMAGIC_MULTIMAP_FIRST(multimap));
+    const int expected_keys[] = { 0, 2, 3, 3, 4, 4 };
+    const int expected_values[] = { 11, 6, 0, 9, 2, 8 };
+    check_contents(multimap, expected_keys, expected_values,
+                   CMAGIC_UTILS_ARRAY_SIZE(expected_keys));
+
+    destructed_values_sum = 0;
+    CMAGIC_MULTIMAP_CLEAR_EXT(multimap, sum_destructor);
+    TEST_ASSERT_EQUAL_INT(11 + 6 + 0 + 9 + 2 + 8, destructed_values_sum);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MULTIMAP_SIZE(multimap));
+    TEST_ASSERT_NULL(CMAGIC_MULTIMAP_FIRST(multimap));
+
+    CMAGIC_MULTIMAP_FREE(multimap);
+}
+
+static void test_Copy(void) {
+    CMAGIC_MULTIMAP(int) multimap = new_filled_multimap();
+    CMAGIC_MULTIMAP(int) copy = CMAGIC_MULTIMAP_COPY(int, multimap);
+    TEST_ASSERT_NOT_NULL(copy);
+    CMAGIC_MULTIMAP_FREE(multimap);
+
+    const int expected_keys[] = { 0, 0, 1, 1, 1, 1, 2, 3, 3, 3, 4, 4 };
+    const int expected_values[] = { 4, 11, 1, 3, 7, 10, 6, 0, 5, 9, 2, 8 };
+    check_contents(copy, expected_keys, expected_values, CMAGIC_UTILS_ARRAY_SIZE(expected_keys));
+
+    // The copy stays a valid tree which accepts further equal keys at the end of their run
+    int value = 12;
+    TEST_ASSERT_NOT_NULL(CMAGIC_MULTIMAP_INSERT(copy, &(int){1}, &value));
+    TEST_ASSERT_EQUAL_size_t(5, CMAGIC_MULTIMAP_COUNT(copy, &(int){1}));
+    TEST_ASSERT_EQUAL_INT(12, CMAGIC_MAP_GET_VALUE(int, CMAGIC_MAP_ITERATOR_PREV(
+        CMAGIC_MULTIMAP_UPPER_BOUND(copy, &(int){1}))));
+
+    CMAGIC_MULTIMAP_FREE(copy);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_StableOrder);
+    RUN_TEST(test_Lookup);
+    RUN_TEST(test_Erase);
+    RUN_TEST(test_Copy);
+    return UNITY_END();
+}
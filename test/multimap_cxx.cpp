@@ -0,0 +1,115 @@
+#include <string>
+#include <utility>
+#include <vector>
+#include "cmagic/memory.h"
+#include "cmagic/multimap.hpp"
+#include "unity.h"
+
+
+void setUp() {
+    static uint8_t memory_pool[8000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+}
+
+void tearDown() {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+}
+
+namespace {
+
+using string_multimap = cmagic::multimap<std::string, std::string>;
+
+std::vector<std::string> values_of(const string_multimap &multimap) {
+    std::vector<std::string> values;
+    for (const auto &element : multimap) {
+        values.push_back(element.first + "=" + element.second);
+    }
+    return values;
+}
+
+void test_StableOrder() {
+    string_multimap multimap {string_multimap::custom_allocation_multimap()};
+    TEST_ASSERT_TRUE(multimap.empty());
+
+    TEST_ASSERT_TRUE(multimap.insert({ "fruit", "pear" }) != multimap.end());
+    TEST_ASSERT_TRUE(multimap.insert({ "vegetable", "leek" }) != multimap.end());
+    TEST_ASSERT_TRUE(multimap.emplace("fruit", "apple") != multimap.end());
+    auto inserted = multimap.emplace("fruit", "plum");
+    TEST_ASSERT_EQUAL_STRING("plum", inserted->second.c_str());
+    TEST_ASSERT_TRUE(multimap.insert({ "berry", "currant" }) != multimap.end());
+
+    TEST_ASSERT_TRUE((values_of(multimap) == std::vector<std::string> {
+        "berry=currant", "fruit=pear", "fruit=apple", "fruit=plum", "vegetable=leek"
+    }));
+    TEST_ASSERT_EQUAL_size_t(3, multimap.count("fruit"));
+    TEST_ASSERT_EQUAL_size_t(0, multimap.count("nut"));
+    TEST_ASSERT_EQUAL_STRING("pear", multimap.find("fruit")->second.c_str());
+    TEST_ASSERT_TRUE(multimap.find("nut") == multimap.end());
+
+    auto range = multimap.equal_range("fruit");
+    TEST_ASSERT_TRUE(range.first == multimap.lower_bound("fruit"));
+    TEST_ASSERT_TRUE(range.second == multimap.upper_bound("fruit"));
+    TEST_ASSERT_EQUAL_STRING("vegetable", range.second->first.c_str());
+    range.first->second = "quince";
+    TEST_ASSERT_EQUAL_STRING("quince", multimap.find("fruit")->second.c_str());
+}
+
+void test_Erase() {
+    string_multimap multimap {string_multimap::custom_allocation_multimap()};
+    for (const char *value : { "a", "b", "c", "d" }) {
+        multimap.emplace("x", value);
+        multimap.emplace("y", value);
+    }
+
+    auto next = multimap.erase(++multimap.find("x"));
+    TEST_ASSERT_EQUAL_STRING("c", next->second.c_str());
+    TEST_ASSERT_EQUAL_size_t(3, multimap.count("x"));
+    TEST_ASSERT_EQUAL_size_t(4, multimap.erase("y"));
+    TEST_ASSERT_EQUAL_size_t(0, multimap.erase("y"));
+    TEST_ASSERT_TRUE((values_of(multimap) == std::vector<std::string> { "x=a", "x=c", "x=d" }));
+
+    multimap.clear();
+    TEST_ASSERT_TRUE(multimap.empty());
+}
+
+void test_CopyAndMove() {
+    string_multimap multimap {string_multimap::custom_allocation_multimap()};
+    multimap.emplace("k", "1");
+    multimap.emplace("j", "0");
+    multimap.emplace("k", "2");
+
+    string_multimap copy {multimap};
+    TEST_ASSERT_TRUE(values_of(copy) == values_of(multimap));
+    copy.emplace("k", "3");
+    TEST_ASSERT_EQUAL_size_t(3, copy.count("k"));
+    TEST_ASSERT_EQUAL_size_t(2, multimap.count("k"));
+
+    const size_t allocations = cmagic_memory_get_allocations();
+    string_multimap moved {std::move(copy)};
+    TEST_ASSERT_EQUAL_size_t(allocations, cmagic_memory_get_allocations());
+    TEST_ASSERT_FALSE(copy);
+    TEST_ASSERT_TRUE(copy.empty());
+    TEST_ASSERT_EQUAL_size_t(0, copy.count("k"));
+    TEST_ASSERT_TRUE(copy.equal_range("k").first == copy.end());
+    TEST_ASSERT_EQUAL_size_t(4, moved.size());
+
+    // Inserting into the moved-from multimap allocates it again with the same allocator
+    TEST_ASSERT_TRUE(copy.emplace("k", "4") != copy.end());
+    TEST_ASSERT_TRUE(copy);
+    TEST_ASSERT_GREATER_THAN_size_t(allocations, cmagic_memory_get_allocations());
+    TEST_ASSERT_EQUAL_size_t(1, copy.count("k"));
+
+    copy = moved;
+    TEST_ASSERT_TRUE(values_of(copy) == values_of(moved));
+}
+
+} // namespace
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_StableOrder);
+    RUN_TEST(test_Erase);
+    RUN_TEST(test_CopyAndMove);
+    return UNITY_END();
+}
@@ -0,0 +1,90 @@
+#include "cmagic/multiset.h"
+#include "cmagic/utils.h"
+#include "unity.h"
+
+void setUp(void) {
+    static uint8_t memory_pool[10000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+// Orders pairs by their first member only, so the second one tells equivalent elements apart
+typedef struct {
+    int key;
+    int order;
+} element_t;
+
+static int element_comparator(const void *element1, const void *element2) {
+    TEST_ASSERT_NOT_NULL(element1);
+    TEST_ASSERT_NOT_NULL(element2);
+    return ((const element_t *)element1)->key - ((const element_t *)element2)->key;
+}
+
+static void test_StableOrder(void) {
+    CMAGIC_MULTISET(element_t) multiset = CMAGIC_MULTISET_NEW(
+        element_t, element_comparator, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(multiset);
+    const int keys[] = { 2, 2, 1, 2, 0, 1, 2 };
+    for (int i = 0; i < (int)CMAGIC_UTILS_ARRAY_SIZE(keys); i++) {
+        element_t element = { .key = keys[i], .order = i };
+        TEST_ASSERT_NOT_NULL(CMAGIC_MULTISET_INSERT(multiset, &element));
+    }
+
+    const element_t expected[] = { {0, 4}, {1, 2}, {1, 5}, {2, 0}, {2, 1}, {2, 3}, {2, 6} };
+    size_t i = 0;
+    for (cmagic_set_iterator_t it = CMAGIC_MULTISET_FIRST(multiset);
+         it;
+         it = CMAGIC_SET_ITERATOR_NEXT(it), i++) {
+        TEST_ASSERT_EQUAL_INT(expected[i].key, CMAGIC_SET_GET_KEY(element_t, it).key);
+        TEST_ASSERT_EQUAL_INT(expected[i].order, CMAGIC_SET_GET_KEY(element_t, it).order);
+    }
+    TEST_ASSERT_EQUAL_size_t(CMAGIC_UTILS_ARRAY_SIZE(expected), i);
+
+    element_t probe = { .key = 2, .order = -1 };
+    TEST_ASSERT_EQUAL_size_t(4, CMAGIC_MULTISET_COUNT(multiset, &probe));
+    TEST_ASSERT_EQUAL_INT(0, CMAGIC_SET_GET_KEY(element_t,
+                                                CMAGIC_MULTISET_FIND(multiset, &probe)).order);
+    cmagic_set_range_t range = CMAGIC_MULTISET_EQUAL_RANGE(multiset, &probe);
+    TEST_ASSERT_EQUAL_INT(0, CMAGIC_SET_GET_KEY(element_t, range.begin).order);
+    TEST_ASSERT_NULL(range.end);
+
+    CMAGIC_MULTISET(element_t) copy = CMAGIC_MULTISET_COPY(element_t, multiset);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_EQUAL_INT(6, CMAGIC_SET_GET_KEY(element_t, CMAGIC_MULTISET_LAST(copy)).order);
+    CMAGIC_MULTISET_FREE(copy);
+
+    CMAGIC_MULTISET_FREE(multiset);
+}
+
+static void test_Erase(void) {
+    CMAGIC_MULTISET(int) multiset = CMAGIC_MULTISET_NEW(int, cmagic_utils_compare_int32,
+                                                        &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(multiset);
+    for (int i = 0; i < 30; i++) {
+        TEST_ASSERT_NOT_NULL(CMAGIC_MULTISET_INSERT(multiset, &(int){i % 3}));
+    }
+    TEST_ASSERT_EQUAL_size_t(10, CMAGIC_MULTISET_COUNT(multiset, &(int){1}));
+
+    TEST_ASSERT_EQUAL_size_t(10, CMAGIC_MULTISET_ERASE(multiset, &(int){1}));
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_MULTISET_COUNT(multiset, &(int){1}));
+    TEST_ASSERT_EQUAL_size_t(20, CMAGIC_MULTISET_SIZE(multiset));
+    TEST_ASSERT_TRUE(CMAGIC_MULTISET_UPPER_BOUND(multiset, &(int){0})
+                     == CMAGIC_MULTISET_FIND(multiset, &(int){2}));
+
+    CMAGIC_MULTISET_ERASE_ITERATOR(multiset, CMAGIC_MULTISET_LAST(multiset));
+    TEST_ASSERT_EQUAL_size_t(9, CMAGIC_MULTISET_COUNT(multiset, &(int){2}));
+    TEST_ASSERT_EQUAL_size_t(10, CMAGIC_MULTISET_COUNT(multiset, &(int){0}));
+
+    CMAGIC_MULTISET_FREE(multiset);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_StableOrder);
+    RUN_TEST(test_Erase);
+    return UNITY_END();
+}
@@ -0,0 +1,93 @@
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "cmagic/memory.h"
+#include "cmagic/multiset.hpp"
+#include "unity.h"
+
+
+void setUp() {
+    static uint8_t memory_pool[5000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+}
+
+void tearDown() {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+}
+
+namespace {
+
+// Orders the words by their length only, so words of the same length are equivalent
+struct shorter {
+    bool operator()(const std::string &lhs, const std::string &rhs) const {
+        return lhs.size() < rhs.size();
+    }
+};
+
+using word_multiset = cmagic::multiset<std::string, shorter>;
+
+template<typename Multiset>
+std::vector<typename Multiset::value_type> elements_of(const Multiset &multiset) {
+    return std::vector<typename Multiset::value_type>(multiset.begin(), multiset.end());
+}
+
+void test_StableOrder() {
+    word_multiset words {word_multiset::custom_allocation_multiset()};
+    for (const char *word : { "kiwi", "fig", "pear", "apple", "lime", "yam" }) {
+        TEST_ASSERT_TRUE(words.insert(word) != words.end());
+    }
+    TEST_ASSERT_TRUE(words.emplace(size_t {4}, 'x') != words.end());
+
+    TEST_ASSERT_TRUE((elements_of(words) == std::vector<std::string> {
+        "fig", "yam", "kiwi", "pear", "lime", "xxxx", "apple"
+    }));
+    TEST_ASSERT_EQUAL_size_t(4, words.count("????"));
+    TEST_ASSERT_EQUAL_STRING("kiwi", words.find("????")->c_str());
+    TEST_ASSERT_TRUE(words.find("??") == words.end());
+
+    auto range = words.equal_range("???");
+    TEST_ASSERT_EQUAL_STRING("fig", range.first->c_str());
+    TEST_ASSERT_EQUAL_STRING("kiwi", range.second->c_str());
+
+    TEST_ASSERT_EQUAL_STRING("pear", words.erase(words.find("????"))->c_str());
+    TEST_ASSERT_EQUAL_size_t(3, words.count("????"));
+    TEST_ASSERT_EQUAL_size_t(3, words.erase("????"));
+    TEST_ASSERT_TRUE((elements_of(words) == std::vector<std::string> { "fig", "yam", "apple" }));
+}
+
+void test_CopyAndMove() {
+    cmagic::multiset<int, std::greater<int>> numbers;
+    for (int number : { 1, 3, 3, 2, 3, 1 }) {
+        numbers.insert(number);
+    }
+    TEST_ASSERT_TRUE((elements_of(numbers) == std::vector<int> { 3, 3, 3, 2, 1, 1 }));
+
+    cmagic::multiset<int, std::greater<int>> copy {numbers};
+    TEST_ASSERT_EQUAL_size_t(3, copy.erase(3));
+    TEST_ASSERT_EQUAL_size_t(3, numbers.count(3));
+
+    cmagic::multiset<int, std::greater<int>> moved {std::move(numbers)};
+    TEST_ASSERT_FALSE(numbers);
+    TEST_ASSERT_EQUAL_size_t(0, numbers.count(3));
+    TEST_ASSERT_EQUAL_size_t(0, numbers.erase(3));
+    TEST_ASSERT_EQUAL_size_t(6, moved.size());
+
+    // Inserting into the moved-from multiset allocates it again
+    TEST_ASSERT_TRUE(numbers.insert(3) != numbers.end());
+    TEST_ASSERT_TRUE(numbers);
+    TEST_ASSERT_EQUAL_size_t(1, numbers.count(3));
+
+    numbers = copy;
+    TEST_ASSERT_TRUE((elements_of(numbers) == std::vector<int> { 2, 1, 1 }));
+}
+
+} // namespace
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_StableOrder);
+    RUN_TEST(test_CopyAndMove);
+    return UNITY_END();
+}
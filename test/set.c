@@ -3,7 +3,7 @@
 #include "unity.h"
 
 void setUp(void) {
-    static uint8_t memory_pool[5000];
+    static uint8_t memory_pool[10000];
     cmagic_memory_init(memory_pool, sizeof(memory_pool));
     TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
 }
@@ -47,8 +47,218 @@ static void test_Sorting(void) {
     CMAGIC_SET_FREE(int_set);
 }
 
+static void test_Bounds(void) {
+    CMAGIC_SET(int) int_set = CMAGIC_SET_NEW(int, int_ptr_comparator,
+                                             &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    for (int key = 1; key <= 9; key += 2) {
+        TEST_ASSERT_NOT_NULL(CMAGIC_SET_INSERT(int_set, &key).inserted_or_existing);
+    }
+
+    TEST_ASSERT_EQUAL_INT(3, CMAGIC_SET_GET_KEY(int, CMAGIC_SET_LOWER_BOUND(int_set, &(int){3})));
+    TEST_ASSERT_EQUAL_INT(5, CMAGIC_SET_GET_KEY(int, CMAGIC_SET_LOWER_BOUND(int_set, &(int){4})));
+    TEST_ASSERT_EQUAL_INT(5, CMAGIC_SET_GET_KEY(int, CMAGIC_SET_UPPER_BOUND(int_set, &(int){3})));
+    TEST_ASSERT_NULL(CMAGIC_SET_UPPER_BOUND(int_set, &(int){9}));
+
+    cmagic_set_range_t range = CMAGIC_SET_EQUAL_RANGE(int_set, &(int){7});
+    TEST_ASSERT_EQUAL_INT(7, CMAGIC_SET_GET_KEY(int, range.begin));
+    TEST_ASSERT_EQUAL_INT(9, CMAGIC_SET_GET_KEY(int, range.end));
+    range = CMAGIC_SET_EQUAL_RANGE(int_set, &(int){0});
+    TEST_ASSERT_TRUE(range.begin == range.end);
+    TEST_ASSERT_TRUE(range.begin == CMAGIC_SET_FIRST(int_set));
+
+    CMAGIC_SET_FREE(int_set);
+}
+
+static void test_BTreeEngine(void) {
+    CMAGIC_SET(int) int_set = CMAGIC_SET_NEW_EXT(int, int_ptr_comparator,
+                                                 &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                 CMAGIC_SET_ENGINE_B_TREE);
+    TEST_ASSERT_NOT_NULL(int_set);
+
+    // Inserting moves other elements between the nodes, but their iterators stay valid
+    const int keys_count = 50;
+    cmagic_set_iterator_t first_inserted = NULL;
+    for (int i = 0; i < keys_count; i++) {
+        int key = keys_count - 1 - i;
+        cmagic_set_iterator_t inserted = CMAGIC_SET_INSERT(int_set, &key).inserted_or_existing;
+        TEST_ASSERT_NOT_NULL(inserted);
+        first_inserted = first_inserted ? first_inserted : inserted;
+    }
+    TEST_ASSERT_TRUE(CMAGIC_SET_INSERT(int_set, &(int){25}).already_exists);
+    TEST_ASSERT_EQUAL_PTR(first_inserted, CMAGIC_SET_LAST(int_set));
+
+    int expected_key = keys_count - 1;
+    for (cmagic_set_iterator_t it = CMAGIC_SET_LAST(int_set);
+         it;
+         it = CMAGIC_SET_ITERATOR_PREV(it), expected_key--) {
+        TEST_ASSERT_EQUAL_INT(expected_key, CMAGIC_SET_GET_KEY(int, it));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, expected_key);
+
+    CMAGIC_SET_CLEAR(int_set);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_SET_SIZE(int_set));
+    TEST_ASSERT_NULL(CMAGIC_SET_FIRST(int_set));
+
+    CMAGIC_SET_FREE(int_set);
+}
+
+static int destructed_keys_count;
+
+static void count_destructor(void *key) {
+    TEST_ASSERT_NOT_NULL(key);
+    destructed_keys_count++;
+}
+
+static void test_ClearWithDestructor(void) {
+    CMAGIC_SET(int) int_set = CMAGIC_SET_NEW(int, int_ptr_comparator,
+                                             &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    for (int key = 0; key < 30; key++) {
+        TEST_ASSERT_NOT_NULL(CMAGIC_SET_INSERT(int_set, &key).inserted_or_existing);
+    }
+
+    destructed_keys_count = 0;
+    CMAGIC_SET_CLEAR_EXT(int_set, count_destructor);
+    TEST_ASSERT_EQUAL_INT(30, destructed_keys_count);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_SET_SIZE(int_set));
+
+    CMAGIC_SET_FREE(int_set);
+}
+
+static void check_set_contents(CMAGIC_SET(int) int_set, const int *expected, size_t size) {
+    TEST_ASSERT_NOT_NULL(int_set);
+    TEST_ASSERT_EQUAL_size_t(size, CMAGIC_SET_SIZE(int_set));
+    cmagic_set_iterator_t it = CMAGIC_SET_FIRST(int_set);
+    for (size_t i = 0; i < size; i++, it = CMAGIC_SET_ITERATOR_NEXT(it)) {
+        TEST_ASSERT_EQUAL_INT(expected[i], CMAGIC_SET_GET_KEY(int, it));
+        TEST_ASSERT_EQUAL_PTR(it, CMAGIC_SET_FIND(int_set, &expected[i]));
+    }
+    TEST_ASSERT_NULL(it);
+}
+
+static int copied_keys_count;
+
+static void count_copy(void *destination, const void *source) {
+    *(int *)destination = *(const int *)source;
+    copied_keys_count++;
+}
+
+static void test_Algebra(void) {
+    const cmagic_set_engine_t engines[] = {
+        CMAGIC_SET_ENGINE_AVL_TREE, CMAGIC_SET_ENGINE_B_TREE, CMAGIC_SET_ENGINE_COMPACT_TREE
+    };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(engines); i++) {
+        CMAGIC_SET(int) even_set = CMAGIC_SET_NEW_EXT(int, int_ptr_comparator,
+                                                      &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                      engines[i]);
+        CMAGIC_SET(int) triple_set = CMAGIC_SET_NEW_EXT(int, int_ptr_comparator,
+                                                        &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                        engines[i]);
+        for (int key = 0; key < 20; key++) {
+            if (key % 2 == 0) {
+                TEST_ASSERT_NOT_NULL(CMAGIC_SET_INSERT(even_set, &key).inserted_or_existing);
+            }
+            if (key % 3 == 0) {
+                TEST_ASSERT_NOT_NULL(CMAGIC_SET_INSERT(triple_set, &key).inserted_or_existing);
+            }
+        }
+
+        const int expected_union[] = { 0, 2, 3, 4, 6, 8, 9, 10, 12, 14, 15, 16, 18 };
+        CMAGIC_SET(int) result = CMAGIC_SET_UNION(int, even_set, triple_set);
+        check_set_contents(result, expected_union, CMAGIC_UTILS_ARRAY_SIZE(expected_union));
+        CMAGIC_SET_FREE(result);
+
+        const int expected_intersection[] = { 0, 6, 12, 18 };
+        copied_keys_count = 0;
+        result = CMAGIC_SET_INTERSECTION_EXT(int, even_set, triple_set, count_copy);
+        TEST_ASSERT_EQUAL_INT(4, copied_keys_count);
+        check_set_contents(result, expected_intersection,
+                           CMAGIC_UTILS_ARRAY_SIZE(expected_intersection));
+        CMAGIC_SET_FREE(result);
+
+        const int expected_difference[] = { 2, 4, 8, 10, 14, 16 };
+        result = CMAGIC_SET_DIFFERENCE(int, even_set, triple_set);
+        check_set_contents(result, expected_difference,
+                           CMAGIC_UTILS_ARRAY_SIZE(expected_difference));
+        CMAGIC_SET_FREE(result);
+
+        CMAGIC_SET_CLEAR(triple_set);
+        result = CMAGIC_SET_INTERSECTION(int, even_set, triple_set);
+        check_set_contents(result, NULL, 0);
+        CMAGIC_SET_FREE(result);
+
+        CMAGIC_SET_FREE(even_set);
+        CMAGIC_SET_FREE(triple_set);
+    }
+}
+
+static void test_Copy(void) {
+    const cmagic_set_engine_t engines[] = {
+        CMAGIC_SET_ENGINE_AVL_TREE, CMAGIC_SET_ENGINE_B_TREE, CMAGIC_SET_ENGINE_COMPACT_TREE
+    };
+    const int expected[] = { 1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144 };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(engines); i++) {
+        CMAGIC_SET(int) int_set = CMAGIC_SET_NEW_EXT(int, int_ptr_comparator,
+                                                     &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC,
+                                                     engines[i]);
+        for (size_t j = CMAGIC_UTILS_ARRAY_SIZE(expected); j > 0; j--) {
+            TEST_ASSERT_NOT_NULL(CMAGIC_SET_INSERT(int_set, &expected[j - 1]).inserted_or_existing);
+        }
+
+        CMAGIC_SET(int) copy = CMAGIC_SET_COPY(int, int_set);
+        check_set_contents(copy, expected, CMAGIC_UTILS_ARRAY_SIZE(expected));
+        CMAGIC_SET_FREE(copy);
+
+        copied_keys_count = 0;
+        destructed_keys_count = 0;
+        copy = CMAGIC_SET_COPY_EXT(int, int_set, count_copy, count_destructor);
+        TEST_ASSERT_EQUAL_INT(CMAGIC_UTILS_ARRAY_SIZE(expected), copied_keys_count);
+        CMAGIC_SET_CLEAR(int_set);
+        check_set_contents(copy, expected, CMAGIC_UTILS_ARRAY_SIZE(expected));
+        CMAGIC_SET_FREE(copy);
+        TEST_ASSERT_EQUAL_INT(0, destructed_keys_count);
+
+        CMAGIC_SET_FREE(int_set);
+    }
+}
+
+static void test_Storage(void) {
+    cmagic_set_storage_t storage;
+    CMAGIC_SET(int) int_set = CMAGIC_SET_INIT(&storage, int, int_ptr_comparator,
+                                              &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(int_set);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_SET_SIZE(int_set));
+    TEST_ASSERT_NULL(CMAGIC_SET_FIRST(int_set));
+    TEST_ASSERT_NULL(CMAGIC_SET_FIND(int_set, &(int){ 1 }));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+
+    const int keys[] = { 3, 1, 2 };
+    for (size_t i = 0; i < CMAGIC_UTILS_ARRAY_SIZE(keys); i++) {
+        TEST_ASSERT_NOT_NULL(CMAGIC_SET_INSERT(int_set, &keys[i]).inserted_or_existing);
+    }
+    check_set_contents(int_set, (const int[]){ 1, 2, 3 }, 3);
+
+    // Set operations accept an embedded set and return a heap allocated one
+    cmagic_set_storage_t empty_storage;
+    CMAGIC_SET(int) empty_set = CMAGIC_SET_INIT(&empty_storage, int, int_ptr_comparator,
+                                                &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    CMAGIC_SET(int) union_set = CMAGIC_SET_UNION(int, empty_set, int_set);
+    TEST_ASSERT_NOT_NULL(union_set);
+    check_set_contents(union_set, (const int[]){ 1, 2, 3 }, 3);
+    CMAGIC_SET_FREE(union_set);
+
+    CMAGIC_SET_DESTROY(empty_set);
+    CMAGIC_SET_DESTROY(int_set);
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_Sorting);
+    RUN_TEST(test_Bounds);
+    RUN_TEST(test_BTreeEngine);
+    RUN_TEST(test_ClearWithDestructor);
+    RUN_TEST(test_Algebra);
+    RUN_TEST(test_Copy);
+    RUN_TEST(test_Storage);
     return UNITY_END();
 }
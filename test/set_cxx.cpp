@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <functional>
 #include <string>
 #include <vector>
 #include "cmagic/memory.h"
@@ -87,11 +88,196 @@ void test_Erase() {
     }
 }
 
+void test_Bounds() {
+    cmagic::set<int> int_set {cmagic::set<int>::custom_allocation_set()};
+    for (int number : { 2, 4, 6, 8 }) {
+        TEST_ASSERT_TRUE(int_set.insert(number).second);
+    }
+
+    std::vector<int> in_range;
+    for (auto it = int_set.lower_bound(3); it != int_set.upper_bound(6); ++it) {
+        in_range.push_back(*it);
+    }
+    TEST_ASSERT_EQUAL_size_t(2, in_range.size());
+    TEST_ASSERT_EQUAL_INT(4, in_range[0]);
+    TEST_ASSERT_EQUAL_INT(6, in_range[1]);
+
+    auto range = int_set.equal_range(8);
+    TEST_ASSERT_EQUAL_INT(8, *range.first);
+    TEST_ASSERT_TRUE(range.second == int_set.end());
+    TEST_ASSERT_TRUE(int_set.lower_bound(9) == int_set.end());
+}
+
+void test_Algebra() {
+    cmagic::set<std::string> x;
+    cmagic::set<std::string> y;
+    for (const char *word : { "Ann", "Bob", "Eve", "Tom" }) {
+        TEST_ASSERT_TRUE(x.insert(word).second);
+    }
+    for (const char *word : { "Bob", "Joe", "Tom", "Zoe" }) {
+        TEST_ASSERT_TRUE(y.insert(word).second);
+    }
+
+    auto to_vector = [](const cmagic::set<std::string> &s) {
+        TEST_ASSERT_TRUE(s);
+        std::vector<std::string> elements;
+        for (const std::string &element : s) {
+            elements.push_back(element);
+        }
+        return elements;
+    };
+
+    cmagic::set<std::string> result = cmagic::set_union(x, y);
+    TEST_ASSERT_TRUE((to_vector(result) ==
+                      std::vector<std::string> { "Ann", "Bob", "Eve", "Joe", "Tom", "Zoe" }));
+    result = cmagic::set_intersection(x, y);
+    TEST_ASSERT_TRUE((to_vector(result) == std::vector<std::string> { "Bob", "Tom" }));
+    result = cmagic::set_difference(x, y);
+    TEST_ASSERT_TRUE((to_vector(result) == std::vector<std::string> { "Ann", "Eve" }));
+
+    // Copied elements must be independent of the source sets
+    x.clear();
+    TEST_ASSERT_TRUE(result.find("Ann") != result.end());
+}
+
+void test_SplitJoin() {
+    cmagic::set<int> left {cmagic::set<int>::custom_allocation_set()};
+    cmagic::set<int> right {cmagic::set<int>::custom_allocation_set()};
+    for (int number = 1; number <= 10; number++) {
+        TEST_ASSERT_TRUE(left.insert(number).second);
+    }
+
+    TEST_ASSERT_TRUE(left.split(7, right));
+    TEST_ASSERT_EQUAL_size_t(6, left.size());
+    TEST_ASSERT_EQUAL_size_t(4, right.size());
+    TEST_ASSERT_EQUAL_INT(7, *right.begin());
+    TEST_ASSERT_TRUE(left.find(7) == left.end());
+
+    TEST_ASSERT_TRUE(left.join(right));
+    TEST_ASSERT_TRUE(right.empty());
+    int expected = 1;
+    for (int number : left) {
+        TEST_ASSERT_EQUAL_INT(expected++, number);
+    }
+    TEST_ASSERT_EQUAL_INT(11, expected);
+}
+
+void test_MoveWithoutAllocation() {
+    using set_type = cmagic::set<std::string>;
+    static_assert(std::is_nothrow_move_constructible<set_type>::value,
+                  "set must be nothrow move constructible");
+    static_assert(std::is_nothrow_move_assignable<set_type>::value,
+                  "set must be nothrow move assignable");
+
+    std::vector<set_type> sets;
+    sets.reserve(1);
+    sets.push_back(set_type::custom_allocation_set());
+    sets.back().insert("first");
+    const size_t allocations = cmagic_memory_get_allocations();
+
+    // Reallocation of std::vector moves the sets
+    sets.push_back(set_type::custom_allocation_set());
+    sets.back().insert("second");
+    TEST_ASSERT_EQUAL_size_t(allocations * 2, cmagic_memory_get_allocations());
+    TEST_ASSERT_EQUAL_size_t(1, sets[0].count("first"));
+
+    set_type moved {std::move(sets[0])};
+    TEST_ASSERT_FALSE(sets[0]);
+    TEST_ASSERT_TRUE(sets[0].empty());
+    TEST_ASSERT_EQUAL_size_t(0, sets[0].count("first"));
+    TEST_ASSERT_TRUE(sets[0].begin() == sets[0].end());
+
+    sets[0] = std::move(sets[1]);
+    TEST_ASSERT_EQUAL_size_t(1, sets[0].count("second"));
+    sets[1] = moved;
+    TEST_ASSERT_EQUAL_size_t(1, sets[1].count("first"));
+}
+
+void test_UseAfterMove() {
+    using set_type = cmagic::set<std::string>;
+    set_type set = set_type::custom_allocation_set();
+    set.insert("one");
+    set_type moved {std::move(set)};
+
+    // Inserting into a moved-from set allocates it again with the same allocator
+    const size_t allocations = cmagic_memory_get_allocations();
+    TEST_ASSERT_TRUE(set.insert("two").second);
+    TEST_ASSERT_TRUE(set);
+    TEST_ASSERT_GREATER_THAN_size_t(allocations, cmagic_memory_get_allocations());
+    TEST_ASSERT_EQUAL_size_t(1, set.count("two"));
+
+    // A moved-from set is an empty operand of set operations
+    set_type empty {std::move(set)};
+    TEST_ASSERT_EQUAL_size_t(1, cmagic::set_union(set, moved).size());
+    TEST_ASSERT_EQUAL_size_t(1, cmagic::set_union(moved, set).size());
+    TEST_ASSERT_EQUAL_size_t(0, cmagic::set_intersection(moved, set).size());
+    TEST_ASSERT_EQUAL_size_t(0, cmagic::set_difference(set, moved).size());
+    TEST_ASSERT_EQUAL_size_t(1, cmagic::set_difference(moved, set).size());
+
+    TEST_ASSERT_TRUE(empty.split("two", set));
+    TEST_ASSERT_TRUE(empty.empty());
+    TEST_ASSERT_EQUAL_size_t(1, set.count("two"));
+    TEST_ASSERT_TRUE(moved.join(set));
+    TEST_ASSERT_EQUAL_size_t(2, moved.size());
+    set_type joined {std::move(moved)};
+    TEST_ASSERT_TRUE(moved.join(joined));
+    TEST_ASSERT_EQUAL_size_t(2, moved.size());
+}
+
+void test_HeterogeneousLookup() {
+    cmagic::set<std::string> str_set;
+    for (const char *name : { "Alex", "Barbara", "Claudia" }) {
+        TEST_ASSERT_TRUE(str_set.insert(name).second);
+    }
+
+    const char *name = "Barbara";
+    TEST_ASSERT_EQUAL_STRING("Barbara", str_set.find(name)->c_str());
+    TEST_ASSERT_EQUAL_size_t(1, str_set.count(name));
+    TEST_ASSERT_EQUAL_size_t(0, str_set.count("Bob"));
+    TEST_ASSERT_EQUAL_STRING("Claudia", str_set.lower_bound("Bob")->c_str());
+    TEST_ASSERT_EQUAL_STRING("Claudia", str_set.upper_bound(name)->c_str());
+    auto range = str_set.equal_range("Alex");
+    TEST_ASSERT_TRUE(range.first == str_set.begin());
+    TEST_ASSERT_TRUE(range.second == str_set.find(name));
+
+    str_set.erase(name);
+    TEST_ASSERT_EQUAL_size_t(2, str_set.size());
+    TEST_ASSERT_EQUAL_size_t(0, str_set.count(name));
+}
+
+void test_CustomOrder() {
+    using descending_set = cmagic::set<std::string, std::greater<std::string>>;
+    descending_set x;
+    descending_set y;
+    for (const char *word : { "Ann", "Eve", "Bob" }) {
+        TEST_ASSERT_TRUE(x.insert(word).second);
+    }
+    for (const char *word : { "Zoe", "Bob" }) {
+        TEST_ASSERT_TRUE(y.insert(word).second);
+    }
+
+    descending_set result = cmagic::set_union(x, y);
+    std::vector<std::string> elements;
+    for (const std::string &element : result) {
+        elements.push_back(element);
+    }
+    TEST_ASSERT_TRUE((elements == std::vector<std::string> { "Zoe", "Eve", "Bob", "Ann" }));
+    TEST_ASSERT_EQUAL_STRING("Bob", result.lower_bound("Cid")->c_str());
+    TEST_ASSERT_TRUE(result.key_comp()("Zoe", "Ann"));
+}
+
 } // namespace
 
 int main() {
     UNITY_BEGIN();
     RUN_TEST(test_Sorting);
     RUN_TEST(test_Erase);
+    RUN_TEST(test_Bounds);
+    RUN_TEST(test_Algebra);
+    RUN_TEST(test_SplitJoin);
+    RUN_TEST(test_MoveWithoutAllocation);
+    RUN_TEST(test_UseAfterMove);
+    RUN_TEST(test_HeterogeneousLookup);
+    RUN_TEST(test_CustomOrder);
     return UNITY_END();
 }
@@ -0,0 +1,322 @@
+#include <string.h>
+#include <stdlib.h>
+#include "cmagic/utils.h"
+#include "tree_engine.h"
+#include "unity.h"
+
+#define KEYS_COUNT 2000
+
+typedef struct {
+    const cmagic_tree_engine_t *engine;
+    // Sizes around the capacities of the nodes, where the shape of a built tree changes
+    size_t build_counts[8];
+} engine_case_t;
+
+static const engine_case_t engine_cases[] = {
+    { &CMAGIC_TREE_ENGINE_AVL_TREE, { 0, 1, 2, 3, 4, 7, 8, KEYS_COUNT } },
+    // A leaf holds 38 int keys and an internal node 17 of them
+    { &CMAGIC_TREE_ENGINE_B_TREE, { 0, 1, 38, 39, 684, 685, 1000, KEYS_COUNT } },
+    // The node array starts with 16 slots, including the sentinel
+    { &CMAGIC_TREE_ENGINE_COMPACT_TREE, { 0, 1, 14, 15, 16, 17, 1000, KEYS_COUNT } }
+};
+
+static uint8_t memory_pool[1 << 19];
+
+void setUp(void) {
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+void tearDown(void) {
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+}
+
+static int int_ptr_comparator(const void *key1, const void *key2) {
+    TEST_ASSERT_NOT_NULL(key1);
+    TEST_ASSERT_NOT_NULL(key2);
+    int int_key1 = *(int *)key1;
+    int int_key2 = *(int *)key2;
+    return int_key1 - int_key2;
+}
+
+static void shuffle(int *array, size_t size, unsigned seed) {
+    srand(seed);
+    for (size_t i = size - 1; i > 0; i--) {
+        size_t j = (size_t)rand() % (i + 1);
+        int tmp = array[i];
+        array[i] = array[j];
+        array[j] = tmp;
+    }
+}
+
+static void *new_tree(const cmagic_tree_engine_t *engine) {
+    void *tree = engine->new_function(int_ptr_comparator, sizeof(int),
+                                      &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(tree);
+    return tree;
+}
+
+static void check_tree_contents(const cmagic_tree_engine_t *engine, void *tree,
+                                const bool *present) {
+    size_t expected_size = 0;
+    int expected_key = -1;
+    for (cmagic_tree_iterator_t it = engine->first_function(tree);
+         it;
+         it = cmagic_tree_engine_iterator_next(it)) {
+        do {
+            expected_key++;
+        } while (!present[expected_key]);
+        TEST_ASSERT_EQUAL_INT(expected_key, *(const int *)it->key);
+        TEST_ASSERT_EQUAL_PTR(it, engine->find_function(tree, &expected_key));
+        expected_size++;
+    }
+    TEST_ASSERT_EQUAL_size_t(expected_size, engine->size_function(tree));
+
+    size_t reverse_size = 0;
+    for (cmagic_tree_iterator_t it = engine->last_function(tree);
+         it;
+         it = cmagic_tree_engine_iterator_prev(it)) {
+        reverse_size++;
+    }
+    TEST_ASSERT_EQUAL_size_t(expected_size, reverse_size);
+}
+
+static void test_InsertEraseRandomOrder(void) {
+    static int keys[KEYS_COUNT];
+    static int erase_order[KEYS_COUNT];
+    static bool present[KEYS_COUNT];
+    for (size_t e = 0; e < CMAGIC_UTILS_ARRAY_SIZE(engine_cases); e++) {
+        const cmagic_tree_engine_t *engine = engine_cases[e].engine;
+        for (int i = 0; i < KEYS_COUNT; i++) {
+            keys[i] = erase_order[i] = i;
+            present[i] = false;
+        }
+        shuffle(keys, KEYS_COUNT, 1);
+        shuffle(erase_order, KEYS_COUNT, 2);
+
+        void *tree = new_tree(engine);
+        for (size_t i = 0; i < KEYS_COUNT; i++) {
+            cmagic_tree_insert_result_t insert_result =
+                engine->insert_function(tree, &keys[i], &keys[i]);
+            TEST_ASSERT_NOT_NULL(insert_result.inserted_or_existing);
+            TEST_ASSERT_FALSE(insert_result.already_exists);
+            TEST_ASSERT_EQUAL_PTR(&keys[i], insert_result.inserted_or_existing->value);
+            present[keys[i]] = true;
+        }
+        check_tree_contents(engine, tree, present);
+
+        cmagic_tree_insert_result_t insert_result = engine->insert_function(tree, &keys[0], NULL);
+        TEST_ASSERT_TRUE(insert_result.already_exists);
+        TEST_ASSERT_EQUAL_PTR(&keys[0], insert_result.inserted_or_existing->value);
+
+        for (size_t i = 0; i < KEYS_COUNT / 2; i++) {
+            engine->erase_function(tree, &erase_order[i]);
+            present[erase_order[i]] = false;
+            TEST_ASSERT_NULL(engine->find_function(tree, &erase_order[i]));
+        }
+        check_tree_contents(engine, tree, present);
+
+        for (size_t i = 0; i < KEYS_COUNT / 2; i++) {
+            TEST_ASSERT_FALSE(engine->insert_function(tree, &erase_order[i], NULL).already_exists);
+            present[erase_order[i]] = true;
+        }
+        check_tree_contents(engine, tree, present);
+
+        for (size_t i = 0; i < KEYS_COUNT; i++) {
+            engine->erase_function(tree, &erase_order[i]);
+        }
+        TEST_ASSERT_EQUAL_size_t(0, engine->size_function(tree));
+        TEST_ASSERT_NULL(engine->first_function(tree));
+        TEST_ASSERT_NULL(engine->last_function(tree));
+
+        engine->free_function(tree);
+    }
+}
+
+static void test_ReplaceKey(void) {
+    static int stored_keys[KEYS_COUNT];
+    for (size_t e = 0; e < CMAGIC_UTILS_ARRAY_SIZE(engine_cases); e++) {
+        const cmagic_tree_engine_t *engine = engine_cases[e].engine;
+        void *tree = new_tree(engine);
+        for (int i = 0; i < KEYS_COUNT; i++) {
+            int probe = i;
+            cmagic_tree_insert_result_t insert_result =
+                engine->insert_function(tree, &probe, NULL);
+            TEST_ASSERT_NOT_NULL(insert_result.inserted_or_existing);
+            stored_keys[i] = i;
+            engine->replace_key_function(tree, insert_result.inserted_or_existing,
+                                         &stored_keys[i]);
+            probe = -1;
+        }
+
+        // The overwritten probes must not be reachable from the tree anymore
+        for (int i = 0; i < KEYS_COUNT; i++) {
+            cmagic_tree_iterator_t found = engine->find_function(tree, &i);
+            TEST_ASSERT_NOT_NULL(found);
+            TEST_ASSERT_EQUAL_PTR(&stored_keys[i], found->key);
+        }
+
+        engine->clear_function(tree, NULL, NULL);
+        TEST_ASSERT_EQUAL_size_t(0, engine->size_function(tree));
+        engine->free_function(tree);
+    }
+}
+
+static void test_Bounds(void) {
+    static int keys[KEYS_COUNT];
+    for (size_t e = 0; e < CMAGIC_UTILS_ARRAY_SIZE(engine_cases); e++) {
+        const cmagic_tree_engine_t *engine = engine_cases[e].engine;
+        void *tree = new_tree(engine);
+        for (int i = 0; i < KEYS_COUNT; i++) {
+            keys[i] = 2 * i;
+            TEST_ASSERT_NOT_NULL(
+                engine->insert_function(tree, &keys[i], NULL).inserted_or_existing);
+        }
+
+        for (int i = 0; i < KEYS_COUNT - 1; i++) {
+            int even = 2 * i;
+            int odd = 2 * i + 1;
+            cmagic_tree_iterator_t bound = engine->lower_bound_function(tree, &even);
+            TEST_ASSERT_EQUAL_INT(even, *(const int *)bound->key);
+            bound = engine->upper_bound_function(tree, &even);
+            TEST_ASSERT_EQUAL_INT(even + 2, *(const int *)bound->key);
+            bound = engine->lower_bound_function(tree, &odd);
+            TEST_ASSERT_EQUAL_INT(even + 2, *(const int *)bound->key);
+            TEST_ASSERT_EQUAL_PTR(bound,
+                                  engine->upper_bound_by_function(tree, &odd, int_ptr_comparator));
+            TEST_ASSERT_EQUAL_PTR(engine->find_function(tree, &even),
+                                  engine->lower_bound_by_function(tree, &even,
+                                                                  int_ptr_comparator));
+
+            cmagic_tree_range_t range = engine->equal_range_function(tree, &odd);
+            TEST_ASSERT_EQUAL_PTR(range.begin, range.end);
+            range = engine->equal_range_function(tree, &even);
+            TEST_ASSERT_EQUAL_INT(even, *(const int *)range.begin->key);
+            TEST_ASSERT_EQUAL_PTR(cmagic_tree_engine_iterator_next(range.begin), range.end);
+        }
+
+        int last = 2 * (KEYS_COUNT - 1);
+        TEST_ASSERT_NULL(engine->upper_bound_function(tree, &last));
+        int before_first = -1;
+        TEST_ASSERT_EQUAL_PTR(engine->first_function(tree),
+                              engine->lower_bound_function(tree, &before_first));
+
+        engine->free_function(tree);
+    }
+}
+
+static void test_OutOfMemory(void) {
+    static uint8_t small_memory_pool[4000];
+    static int keys[KEYS_COUNT];
+    static bool present[KEYS_COUNT];
+    for (size_t e = 0; e < CMAGIC_UTILS_ARRAY_SIZE(engine_cases); e++) {
+        const cmagic_tree_engine_t *engine = engine_cases[e].engine;
+        cmagic_memory_init(small_memory_pool, sizeof(small_memory_pool));
+        void *tree = new_tree(engine);
+
+        int i;
+        for (i = 0; i < KEYS_COUNT; i++) {
+            keys[i] = (i * 7919) % KEYS_COUNT;
+            present[keys[i]] = false;
+        }
+        for (i = 0; i < KEYS_COUNT; i++) {
+            cmagic_tree_insert_result_t insert_result =
+                engine->insert_function(tree, &keys[i], NULL);
+            if (!insert_result.inserted_or_existing) {
+                break;
+            }
+            present[keys[i]] = true;
+        }
+        TEST_ASSERT_LESS_THAN_INT(KEYS_COUNT, i);
+        check_tree_contents(engine, tree, present);
+
+        engine->free_function(tree);
+        TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocated_bytes());
+    }
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+}
+
+static void test_Build(void) {
+    static int keys[KEYS_COUNT];
+    static cmagic_tree_element_t elements[KEYS_COUNT];
+    static bool present[KEYS_COUNT];
+    for (int i = 0; i < KEYS_COUNT; i++) {
+        keys[i] = i;
+        elements[i] = (cmagic_tree_element_t){ .key = &keys[i], .value = NULL };
+    }
+
+    for (size_t e = 0; e < CMAGIC_UTILS_ARRAY_SIZE(engine_cases); e++) {
+        const cmagic_tree_engine_t *engine = engine_cases[e].engine;
+        for (size_t c = 0; c < CMAGIC_UTILS_ARRAY_SIZE(engine_cases[e].build_counts); c++) {
+            const size_t count = engine_cases[e].build_counts[c];
+            void *tree = new_tree(engine);
+            TEST_ASSERT_TRUE(engine->build_function(tree, elements, count));
+            for (size_t i = 0; i < KEYS_COUNT; i++) {
+                present[i] = i < count;
+            }
+            check_tree_contents(engine, tree, present);
+
+            for (size_t i = 0; i < count; i += 3) {
+                engine->erase_function(tree, &keys[i]);
+                present[i] = false;
+            }
+            for (size_t i = count; i < KEYS_COUNT; i += 5) {
+                TEST_ASSERT_NOT_NULL(
+                    engine->insert_function(tree, &keys[i], NULL).inserted_or_existing);
+                present[i] = true;
+            }
+            check_tree_contents(engine, tree, present);
+
+            engine->free_function(tree);
+        }
+    }
+}
+
+static void test_SplitJoin(void) {
+    static int keys[KEYS_COUNT];
+    static bool present[KEYS_COUNT];
+    for (size_t e = 0; e < CMAGIC_UTILS_ARRAY_SIZE(engine_cases); e++) {
+        const cmagic_tree_engine_t *engine = engine_cases[e].engine;
+        void *tree = new_tree(engine);
+        void *right_tree = new_tree(engine);
+        for (int i = 0; i < KEYS_COUNT; i++) {
+            keys[i] = i;
+            TEST_ASSERT_NOT_NULL(
+                engine->insert_function(tree, &keys[i], NULL).inserted_or_existing);
+        }
+
+        const int split_key = KEYS_COUNT / 3;
+        TEST_ASSERT_TRUE(cmagic_tree_engine_split(engine, int_ptr_comparator, sizeof(int), &tree,
+                                                  &split_key, &right_tree));
+        for (int i = 0; i < KEYS_COUNT; i++) {
+            present[i] = i < split_key;
+        }
+        check_tree_contents(engine, tree, present);
+        for (int i = 0; i < KEYS_COUNT; i++) {
+            present[i] = !present[i];
+        }
+        check_tree_contents(engine, right_tree, present);
+
+        TEST_ASSERT_TRUE(cmagic_tree_engine_join(engine, int_ptr_comparator, sizeof(int), &tree,
+                                                 &right_tree));
+        TEST_ASSERT_EQUAL_size_t(0, engine->size_function(right_tree));
+        for (int i = 0; i < KEYS_COUNT; i++) {
+            present[i] = true;
+        }
+        check_tree_contents(engine, tree, present);
+
+        engine->free_function(right_tree);
+        engine->free_function(tree);
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_InsertEraseRandomOrder);
+    RUN_TEST(test_ReplaceKey);
+    RUN_TEST(test_Bounds);
+    RUN_TEST(test_OutOfMemory);
+    RUN_TEST(test_Build);
+    RUN_TEST(test_SplitJoin);
+    return UNITY_END();
+}
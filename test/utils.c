@@ -20,8 +20,22 @@ static void test_Utils(void) {
     TEST_ASSERT_EQUAL_UINT32(expected_aligned_up, (uint32_t)cmagic_utils_align_address_up((uintptr_t)base_address, alignment));
 }
 
+static void test_CompareIntegers(void) {
+    TEST_ASSERT_LESS_THAN_INT(0, cmagic_utils_compare_int32(&(int32_t){ INT32_MIN },
+                                                            &(int32_t){ 1 }));
+    TEST_ASSERT_EQUAL_INT(0, cmagic_utils_compare_int32(&(int32_t){ -7 }, &(int32_t){ -7 }));
+    TEST_ASSERT_GREATER_THAN_INT(0, cmagic_utils_compare_uint32(&(uint32_t){ UINT32_MAX },
+                                                                &(uint32_t){ 1 }));
+    TEST_ASSERT_LESS_THAN_INT(0, cmagic_utils_compare_int64(&(int64_t){ INT64_MIN },
+                                                            &(int64_t){ INT64_MAX }));
+    TEST_ASSERT_GREATER_THAN_INT(0, cmagic_utils_compare_uint64(&(uint64_t){ UINT64_MAX },
+                                                                &(uint64_t){ 0 }));
+    TEST_ASSERT_EQUAL_INT(0, cmagic_utils_compare_uint64(&(uint64_t){ 3 }, &(uint64_t){ 3 }));
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_Utils);
+    RUN_TEST(test_CompareIntegers);
     return UNITY_END();
 }
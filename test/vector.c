@@ -53,11 +53,224 @@ static void test_PushMaximum(void) {
     CMAGIC_VECTOR_FREE(vector);
 }
 
+static void test_ReserveAndShrink(void) {
+    CMAGIC_VECTOR(int) vector = CMAGIC_VECTOR_NEW(int, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(vector);
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_RESERVE(vector, 100));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_VECTOR_CAPACITY(vector));
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_RESERVE(vector, 50));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_VECTOR_CAPACITY(vector));
+
+    // Filling the reserved space never reallocates the data
+    int *data = CMAGIC_VECTOR_DATA(vector);
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(CMAGIC_VECTOR_PUSH_BACK(vector, &i));
+    }
+    TEST_ASSERT_EQUAL_PTR(data, CMAGIC_VECTOR_DATA(vector));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_VECTOR_CAPACITY(vector));
+
+    // The capacity is unchanged if there's not enough memory
+    TEST_ASSERT_FALSE(CMAGIC_VECTOR_RESERVE(vector, 1000));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_VECTOR_CAPACITY(vector));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_VECTOR_SIZE(vector));
+
+    // Neither if the data size would overflow
+    TEST_ASSERT_FALSE(CMAGIC_VECTOR_RESERVE(vector, SIZE_MAX / sizeof(int) + 2));
+    TEST_ASSERT_FALSE(CMAGIC_VECTOR_RESIZE(vector, SIZE_MAX / sizeof(int) + 2));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_VECTOR_CAPACITY(vector));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_VECTOR_SIZE(vector));
+
+    for (int i = 0; i < 30; i++) {
+        CMAGIC_VECTOR_POP_BACK(vector);
+    }
+    CMAGIC_VECTOR_SHRINK_TO_FIT(vector);
+    TEST_ASSERT_EQUAL_size_t(70, CMAGIC_VECTOR_CAPACITY(vector));
+    for (int i = 0; i < 70; i++) {
+        TEST_ASSERT_EQUAL_INT(i, CMAGIC_VECTOR_DATA(vector)[i]);
+    }
+
+    while (CMAGIC_VECTOR_SIZE(vector) > 0) {
+        CMAGIC_VECTOR_POP_BACK(vector);
+    }
+    // An empty vector releases its data entirely
+    CMAGIC_VECTOR_SHRINK_TO_FIT(vector);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_VECTOR_CAPACITY(vector));
+    TEST_ASSERT_NULL(CMAGIC_VECTOR_DATA(vector));
+    TEST_ASSERT_EQUAL_size_t(1, cmagic_memory_get_allocations());
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_PUSH_BACK(vector, &(int){123}));
+    TEST_ASSERT_EQUAL_INT(123, *CMAGIC_VECTOR_BACK(vector));
+
+    CMAGIC_VECTOR_FREE(vector);
+}
+
+static void test_Policy(void) {
+    CMAGIC_VECTOR(int) vector = CMAGIC_VECTOR_NEW(int, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(vector);
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(CMAGIC_VECTOR_PUSH_BACK(vector, &i));
+    }
+    const size_t capacity = CMAGIC_VECTOR_CAPACITY(vector);
+
+    // By default removing the elements keeps the data in place
+    const int *data = CMAGIC_VECTOR_DATA(vector);
+    while (CMAGIC_VECTOR_SIZE(vector) > 0) {
+        CMAGIC_VECTOR_POP_BACK(vector);
+    }
+    TEST_ASSERT_EQUAL_PTR(data, CMAGIC_VECTOR_DATA(vector));
+    TEST_ASSERT_EQUAL_size_t(capacity, CMAGIC_VECTOR_CAPACITY(vector));
+    CMAGIC_VECTOR_FREE(vector);
+
+    const cmagic_vector_policy_t policy = {
+        .growth_percent = 150, .auto_shrink = true, .min_capacity = 8
+    };
+    vector = CMAGIC_VECTOR_NEW_EXT(int, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC, &policy);
+    TEST_ASSERT_NOT_NULL(vector);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_VECTOR_CAPACITY(vector));
+    TEST_ASSERT_EQUAL_size_t(150, CMAGIC_VECTOR_GET_POLICY(vector)->growth_percent);
+    const size_t expected_capacities[] = { 8, 12, 18, 27, 40 };
+    for (int i = 0; i < 40; i++) {
+        TEST_ASSERT_TRUE(CMAGIC_VECTOR_PUSH_BACK(vector, &i));
+        size_t expected_capacity = 0;
+        for (size_t j = 0; (size_t)i >= expected_capacity; j++) {
+            expected_capacity = expected_capacities[j];
+        }
+        TEST_ASSERT_EQUAL_size_t(expected_capacity, CMAGIC_VECTOR_CAPACITY(vector));
+    }
+
+    // The capacity halves when the size drops to a quarter, but not below the minimum capacity
+    while (CMAGIC_VECTOR_SIZE(vector) > 10) {
+        CMAGIC_VECTOR_POP_BACK(vector);
+    }
+    TEST_ASSERT_EQUAL_size_t(20, CMAGIC_VECTOR_CAPACITY(vector));
+    while (CMAGIC_VECTOR_SIZE(vector) > 0) {
+        CMAGIC_VECTOR_POP_BACK(vector);
+    }
+    TEST_ASSERT_EQUAL_size_t(10, CMAGIC_VECTOR_CAPACITY(vector));
+
+    CMAGIC_VECTOR_SET_POLICY(vector, &CMAGIC_VECTOR_POLICY_DEFAULT);
+    TEST_ASSERT_FALSE(CMAGIC_VECTOR_GET_POLICY(vector)->auto_shrink);
+    CMAGIC_VECTOR_SHRINK_TO_FIT(vector);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_VECTOR_CAPACITY(vector));
+
+    CMAGIC_VECTOR_FREE(vector);
+}
+
+static void test_ResizeAndTruncate(void) {
+    CMAGIC_VECTOR(int) vector = CMAGIC_VECTOR_NEW(int, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(vector);
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_RESIZE(vector, 50));
+    TEST_ASSERT_EQUAL_size_t(50, CMAGIC_VECTOR_SIZE(vector));
+    TEST_ASSERT_EQUAL_size_t(50, CMAGIC_VECTOR_CAPACITY(vector));
+    for (int i = 0; i < 50; i++) {
+        CMAGIC_VECTOR_DATA(vector)[i] = i;
+    }
+
+    // Growing by less than the growth factor allocates the full growth
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_RESIZE(vector, 60));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_VECTOR_CAPACITY(vector));
+    TEST_ASSERT_FALSE(CMAGIC_VECTOR_RESIZE(vector, 1000));
+    TEST_ASSERT_EQUAL_size_t(60, CMAGIC_VECTOR_SIZE(vector));
+
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_RESIZE(vector, 40));
+    CMAGIC_VECTOR_TRUNCATE(vector, 30);
+    TEST_ASSERT_EQUAL_size_t(30, CMAGIC_VECTOR_SIZE(vector));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_VECTOR_CAPACITY(vector));
+    for (int i = 0; i < 30; i++) {
+        TEST_ASSERT_EQUAL_INT(i, CMAGIC_VECTOR_DATA(vector)[i]);
+    }
+
+    CMAGIC_VECTOR_CLEAR(vector);
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_VECTOR_SIZE(vector));
+    TEST_ASSERT_EQUAL_size_t(100, CMAGIC_VECTOR_CAPACITY(vector));
+
+    // With automatic shrinking the capacity ends as if the elements were popped one by one
+    cmagic_vector_policy_t policy = *CMAGIC_VECTOR_GET_POLICY(vector);
+    policy.auto_shrink = true;
+    CMAGIC_VECTOR_SET_POLICY(vector, &policy);
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_RESIZE(vector, 100));
+    CMAGIC_VECTOR_TRUNCATE(vector, 12);
+    TEST_ASSERT_EQUAL_size_t(25, CMAGIC_VECTOR_CAPACITY(vector));
+    CMAGIC_VECTOR_CLEAR(vector);
+    TEST_ASSERT_EQUAL_size_t(6, CMAGIC_VECTOR_CAPACITY(vector));
+
+    CMAGIC_VECTOR_FREE(vector);
+}
+
+static void assert_vector(CMAGIC_VECTOR(int) vector, const int *expected, size_t size) {
+    TEST_ASSERT_EQUAL_size_t(size, CMAGIC_VECTOR_SIZE(vector));
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, CMAGIC_VECTOR_DATA(vector), size);
+}
+
+static void test_InsertAndEraseRange(void) {
+    CMAGIC_VECTOR(int) vector = CMAGIC_VECTOR_NEW(int, &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(vector);
+    const int values[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_APPEND(vector, values, 3));
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_APPEND(vector, values + 6, 2));
+    assert_vector(vector, (const int[]){ 1, 2, 3, 7, 8 }, 5);
+
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_INSERT_RANGE(vector, 3, values + 3, 3));
+    assert_vector(vector, values, 8);
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_INSERT_RANGE(vector, 0, values + 7, 1));
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_INSERT_RANGE(vector, 9, values, 0));
+    assert_vector(vector, (const int[]){ 8, 1, 2, 3, 4, 5, 6, 7, 8 }, 9);
+
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_INSERT_UNINITIALIZED(vector, 1, 2));
+    CMAGIC_VECTOR_DATA(vector)[1] = 10;
+    CMAGIC_VECTOR_DATA(vector)[2] = 20;
+    assert_vector(vector, (const int[]){ 8, 10, 20, 1, 2, 3, 4, 5, 6, 7, 8 }, 11);
+
+    TEST_ASSERT_FALSE(CMAGIC_VECTOR_INSERT_UNINITIALIZED(vector, 0, 1000));
+    // Counts whose data size overflows, with or without the current size
+    TEST_ASSERT_FALSE(CMAGIC_VECTOR_INSERT_UNINITIALIZED(vector, 0, SIZE_MAX - 5));
+    TEST_ASSERT_FALSE(CMAGIC_VECTOR_APPEND(vector, values, SIZE_MAX / sizeof(int)));
+    TEST_ASSERT_EQUAL_size_t(11, CMAGIC_VECTOR_SIZE(vector));
+
+    CMAGIC_VECTOR_ERASE_RANGE(vector, 0, 3);
+    assert_vector(vector, values, 8);
+    CMAGIC_VECTOR_ERASE_RANGE(vector, 2, 5);
+    assert_vector(vector, (const int[]){ 1, 2, 6, 7, 8 }, 5);
+    CMAGIC_VECTOR_ERASE_RANGE(vector, 3, 5);
+    CMAGIC_VECTOR_ERASE_RANGE(vector, 1, 1);
+    assert_vector(vector, (const int[]){ 1, 2, 6 }, 3);
+
+    CMAGIC_VECTOR_FREE(vector);
+}
+
+static void test_Storage(void) {
+    cmagic_vector_storage_t storage;
+    CMAGIC_VECTOR(int) vector = CMAGIC_VECTOR_INIT(&storage, int,
+                                                   &CMAGIC_MEMORY_ALLOC_PACKET_CUSTOM_CMAGIC);
+    TEST_ASSERT_NOT_NULL(vector);
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_VECTOR_SIZE(vector));
+    TEST_ASSERT_NULL(CMAGIC_VECTOR_DATA(vector));
+
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_TRUE(CMAGIC_VECTOR_PUSH_BACK(vector, &i));
+    }
+    // Only the data is allocated, the descriptor lives in the storage
+    TEST_ASSERT_EQUAL_size_t(1, cmagic_memory_get_allocations());
+    assert_vector(vector, (const int[]){ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }, 10);
+
+    CMAGIC_VECTOR_DESTROY(vector);
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
+    TEST_ASSERT_EQUAL_size_t(0, CMAGIC_VECTOR_SIZE(vector));
+    TEST_ASSERT_TRUE(CMAGIC_VECTOR_PUSH_BACK(vector, &(int){7}));
+    assert_vector(vector, (const int[]){ 7 }, 1);
+    CMAGIC_VECTOR_DESTROY(vector);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_Empty);
     RUN_TEST(test_Single);
     RUN_TEST(test_100);
     RUN_TEST(test_PushMaximum);
+    RUN_TEST(test_ReserveAndShrink);
+    RUN_TEST(test_Policy);
+    RUN_TEST(test_ResizeAndTruncate);
+    RUN_TEST(test_InsertAndEraseRange);
+    RUN_TEST(test_Storage);
     return UNITY_END();
 }
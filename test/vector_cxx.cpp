@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstdint>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -189,7 +190,7 @@ void test_moving_semantics() {
         TEST_ASSERT_EQUAL_INT(2, mgmt->deallocations);
 
         cmagic::vector<object> vec_moved {std::move(vec)};
-        TEST_ASSERT_TRUE(vec);
+        TEST_ASSERT_FALSE(vec);
         TEST_ASSERT_TRUE(vec_moved);
         TEST_ASSERT_EQUAL_size_t(0, vec.size());
         TEST_ASSERT_EQUAL_size_t(2, vec_moved.size());
@@ -198,10 +199,86 @@ void test_moving_semantics() {
         
         TEST_ASSERT_EQUAL_INT(123, vec_moved[0].val);
         TEST_ASSERT_EQUAL_INT(456, vec_moved[1].val);
+
+        // Moved-from vector is empty and becomes usable again once assigned to
+        TEST_ASSERT_TRUE(vec.begin() == vec.end());
+        vec.clear();
+        vec = vec_moved;
+        TEST_ASSERT_TRUE(vec);
+        TEST_ASSERT_EQUAL_size_t(2, vec.size());
+        TEST_ASSERT_EQUAL_INT(6, mgmt->allocations);
     }
 
-    TEST_ASSERT_EQUAL_INT(4, mgmt->allocations); 
-    TEST_ASSERT_EQUAL_INT(4, mgmt->deallocations);
+    TEST_ASSERT_EQUAL_INT(6, mgmt->allocations);
+    TEST_ASSERT_EQUAL_INT(6, mgmt->deallocations);
+}
+
+void test_move_without_allocation() {
+    static_assert(std::is_nothrow_move_constructible<cmagic::vector<std::string>>::value,
+                  "vector must be nothrow move constructible");
+    static_assert(std::is_nothrow_move_assignable<cmagic::vector<std::string>>::value,
+                  "vector must be nothrow move assignable");
+
+    uint8_t memory_pool[2000];
+    cmagic_memory_init(memory_pool, sizeof(memory_pool));
+    {
+        // Growing std::vector moves its elements instead of copying them
+        std::vector<cmagic::vector<int>> vectors;
+        for (int i = 0; i < 10; i++) {
+            vectors.push_back(cmagic::vector<int>::custom_allocation_vector());
+            TEST_ASSERT_TRUE(vectors.back().push_back(i));
+        }
+        const size_t allocations = cmagic_memory_get_allocations();
+        vectors.shrink_to_fit();
+        TEST_ASSERT_EQUAL_size_t(allocations, cmagic_memory_get_allocations());
+
+        // Erasing shifts the elements by move assignment, only the erased vector is freed
+        vectors.erase(vectors.begin());
+        TEST_ASSERT_EQUAL_size_t(allocations - 2, cmagic_memory_get_allocations());
+
+        for (int i = 0; i < 9; i++) {
+            TEST_ASSERT_EQUAL_size_t(1, vectors[static_cast<size_t>(i)].size());
+            TEST_ASSERT_EQUAL_INT(i + 1, vectors[static_cast<size_t>(i)][0]);
+        }
+
+        vectors[0] = std::move(vectors[1]);
+        TEST_ASSERT_FALSE(vectors[1]);
+        TEST_ASSERT_EQUAL_INT(2, vectors[0][0]);
+        TEST_ASSERT_EQUAL_size_t(allocations - 4, cmagic_memory_get_allocations());
+
+        // Moved-from vector is allocated again by the same allocator once an element is added
+        cmagic::vector<int> &moved_from = vectors[1];
+        TEST_ASSERT_TRUE(moved_from.empty());
+        TEST_ASSERT_TRUE(moved_from.erase(moved_from.begin(), moved_from.end()) == nullptr);
+        TEST_ASSERT_TRUE(moved_from.resize(0));
+        TEST_ASSERT_FALSE(moved_from);
+        TEST_ASSERT_TRUE(moved_from.push_back(7));
+        TEST_ASSERT_TRUE(moved_from);
+        TEST_ASSERT_EQUAL_size_t(allocations - 2, cmagic_memory_get_allocations());
+        const int values[] = { 1, 2 };
+        TEST_ASSERT_NOT_NULL(moved_from.insert(moved_from.begin(), values, values + 2));
+        TEST_ASSERT_NOT_NULL(moved_from.insert(moved_from.end(), 8));
+        TEST_ASSERT_EQUAL_size_t(4, moved_from.size());
+        TEST_ASSERT_EQUAL_INT(1, moved_from[0]);
+        TEST_ASSERT_EQUAL_INT(8, moved_from[3]);
+
+        // Every way of adding elements works on a moved-from vector
+        cmagic::vector<int> other {std::move(moved_from)};
+        TEST_ASSERT_TRUE(moved_from.emplace_back(1));
+        other = std::move(moved_from);
+        TEST_ASSERT_NOT_NULL(moved_from.insert(moved_from.begin(), 2));
+        other = std::move(moved_from);
+        TEST_ASSERT_TRUE(moved_from.resize(3, 4));
+        TEST_ASSERT_EQUAL_INT(4, moved_from[2]);
+        other = std::move(moved_from);
+        TEST_ASSERT_EQUAL_size_t(200, moved_from.policy().growth_percent);
+        TEST_ASSERT_TRUE(moved_from.reserve(3));
+        TEST_ASSERT_EQUAL_size_t(3, moved_from.capacity());
+        other = std::move(moved_from);
+        TEST_ASSERT_TRUE(moved_from.set_policy(cmagic_vector_policy_t {300, false, 2}));
+        TEST_ASSERT_EQUAL_size_t(300, moved_from.policy().growth_percent);
+    }
+    TEST_ASSERT_EQUAL_size_t(0, cmagic_memory_get_allocations());
 }
 
 void test_custom_alloc_vector() {
@@ -211,8 +288,8 @@ void test_custom_alloc_vector() {
         auto str_vector = cmagic::vector<std::string>::custom_allocation_vector();
         TEST_ASSERT_TRUE(str_vector);
 
-        // One allocation for metadata, one for effective data
-        TEST_ASSERT_EQUAL_size_t(2, cmagic_memory_get_allocations());
+        // Only metadata is allocated, effective data comes with the first element
+        TEST_ASSERT_EQUAL_size_t(1, cmagic_memory_get_allocations());
 
         constexpr const char* strings[] {
             "Lorem", "ipsum", "dolor", "sit", "amet,", "consectetur", "adipiscing", "elit,", "sed",
@@ -277,6 +354,171 @@ void test_back_inserter() {
     TEST_ASSERT_EQUAL_STRING("C", c_vec[2].c_str());
 }
 
+void test_reserve() {
+    cmagic::vector<int> vec;
+    TEST_ASSERT_TRUE(vec.reserve(100));
+    TEST_ASSERT_EQUAL_size_t(100, vec.capacity());
+    TEST_ASSERT_TRUE(vec.empty());
+
+    const int *data = vec.begin();
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(vec.push_back(i));
+    }
+    TEST_ASSERT_EQUAL_PTR(data, vec.begin());
+    TEST_ASSERT_EQUAL_size_t(100, vec.capacity());
+
+    for (int i = 0; i < 40; i++) {
+        vec.pop_back();
+    }
+    vec.shrink_to_fit();
+    TEST_ASSERT_EQUAL_size_t(60, vec.capacity());
+    TEST_ASSERT_EQUAL_INT(59, vec[59]);
+    TEST_ASSERT_FALSE(vec.reserve(SIZE_MAX / sizeof(int) + 2));
+    TEST_ASSERT_FALSE(vec.resize(SIZE_MAX / sizeof(int) + 2));
+    TEST_ASSERT_EQUAL_size_t(60, vec.capacity());
+    TEST_ASSERT_EQUAL_size_t(60, vec.size());
+
+    cmagic::vector<int> moved {std::move(vec)};
+    TEST_ASSERT_EQUAL_size_t(0, vec.capacity());
+    vec.shrink_to_fit();
+    TEST_ASSERT_EQUAL_size_t(60, moved.capacity());
+}
+
+void test_policy() {
+    cmagic::vector<int> vec {cmagic_vector_policy_t {300, false, 2}};
+    TEST_ASSERT_EQUAL_size_t(0, vec.capacity());
+    TEST_ASSERT_TRUE(vec.push_back(0));
+    TEST_ASSERT_EQUAL_size_t(2, vec.capacity());
+    for (int i = 1; i < 3; i++) {
+        TEST_ASSERT_TRUE(vec.push_back(i));
+    }
+    TEST_ASSERT_EQUAL_size_t(6, vec.capacity());
+
+    // The copy changes its capacity by the same rules
+    cmagic::vector<int> copy {vec};
+    TEST_ASSERT_EQUAL_size_t(300, copy.policy().growth_percent);
+    TEST_ASSERT_EQUAL_size_t(2, copy.policy().min_capacity);
+    cmagic::vector<int> assigned;
+    TEST_ASSERT_TRUE(assigned.push_back(0));
+    assigned = vec;
+    TEST_ASSERT_EQUAL_size_t(300, assigned.policy().growth_percent);
+    TEST_ASSERT_EQUAL_size_t(2, assigned.policy().min_capacity);
+    TEST_ASSERT_EQUAL_size_t(3, assigned.size());
+
+    vec.set_policy(CMAGIC_VECTOR_POLICY_DEFAULT);
+    TEST_ASSERT_EQUAL_size_t(200, vec.policy().growth_percent);
+    vec.clear();
+    TEST_ASSERT_EQUAL_size_t(6, vec.capacity());
+}
+
+void test_resize() {
+    auto mgmt {std::make_shared<mem_mgmt>()};
+    {
+        cmagic::vector<object> vec;
+        TEST_ASSERT_TRUE(vec.resize(10, object(7, mgmt)));
+        TEST_ASSERT_EQUAL_size_t(10, vec.size());
+        // One temporary object, ten copies stored in the vector
+        TEST_ASSERT_EQUAL_INT(11, mgmt->allocations);
+        TEST_ASSERT_EQUAL_INT(1, mgmt->deallocations);
+        TEST_ASSERT_EQUAL_INT(7, vec[9].val);
+
+        TEST_ASSERT_TRUE(vec.resize(20, vec[0]));
+        TEST_ASSERT_EQUAL_INT(7, vec[19].val);
+        TEST_ASSERT_EQUAL_INT(22, mgmt->allocations);
+        TEST_ASSERT_EQUAL_INT(2, mgmt->deallocations);
+
+        TEST_ASSERT_TRUE(vec.resize(4, vec[0]));
+        TEST_ASSERT_EQUAL_size_t(4, vec.size());
+        TEST_ASSERT_EQUAL_INT(18, mgmt->deallocations);
+
+        vec.clear();
+        TEST_ASSERT_TRUE(vec.empty());
+        TEST_ASSERT_EQUAL_INT(22, mgmt->deallocations);
+    }
+    TEST_ASSERT_EQUAL_INT(22, mgmt->allocations);
+    TEST_ASSERT_EQUAL_INT(22, mgmt->deallocations);
+
+    cmagic::vector<int> vec;
+    TEST_ASSERT_TRUE(vec.resize(100));
+    TEST_ASSERT_EQUAL_size_t(100, vec.size());
+    TEST_ASSERT_EQUAL_INT(100, std::count(vec.begin(), vec.end(), 0));
+    const size_t capacity {vec.capacity()};
+    vec.clear();
+    TEST_ASSERT_TRUE(vec.empty());
+    TEST_ASSERT_EQUAL_size_t(capacity, vec.capacity());
+
+    cmagic::vector<int> moved {std::move(vec)};
+    vec.clear();
+    TEST_ASSERT_TRUE(vec.empty());
+}
+
+void test_insert_erase() {
+    auto mgmt {std::make_shared<mem_mgmt>()};
+    {
+        cmagic::vector<object> vec;
+        for (int i = 0; i < 4; i++) {
+            TEST_ASSERT_TRUE(vec.emplace_back(i, mgmt));
+        }
+        object *inserted {vec.insert(vec.begin() + 2, object(10, mgmt))};
+        TEST_ASSERT_EQUAL_PTR(vec.begin() + 2, inserted);
+        // The inserted element is copied aside first because it's in the vector itself
+        TEST_ASSERT_NOT_NULL(vec.insert(vec.end(), vec[0]));
+        TEST_ASSERT_EQUAL_INT(8, mgmt->allocations);
+        TEST_ASSERT_EQUAL_INT(2, mgmt->deallocations);
+
+        const std::vector<object> source {object(20, mgmt), object(30, mgmt)};
+        TEST_ASSERT_NOT_NULL(vec.insert(vec.begin(), source.begin(), source.end()));
+        const int expected_values[] {20, 30, 0, 1, 10, 2, 3, 0};
+        TEST_ASSERT_EQUAL_size_t(8, vec.size());
+        for (size_t i = 0; i < vec.size(); i++) {
+            TEST_ASSERT_EQUAL_INT(expected_values[i], vec[i].val);
+        }
+
+        const int deallocations {mgmt->deallocations};
+        object *next {vec.erase(vec.begin() + 1, vec.begin() + 5)};
+        TEST_ASSERT_EQUAL_INT(deallocations + 4, mgmt->deallocations);
+        TEST_ASSERT_EQUAL_INT(2, next->val);
+        next = vec.erase(vec.end() - 1);
+        TEST_ASSERT_EQUAL_PTR(vec.end(), next);
+        TEST_ASSERT_EQUAL_size_t(3, vec.size());
+        TEST_ASSERT_EQUAL_INT(20, vec[0].val);
+        TEST_ASSERT_EQUAL_INT(3, vec[2].val);
+    }
+    TEST_ASSERT_EQUAL_INT(mgmt->allocations, mgmt->deallocations);
+
+    cmagic::vector<int> vec;
+    const int values[] {1, 2, 3, 4, 5};
+    TEST_ASSERT_NOT_NULL(vec.insert(vec.end(), std::begin(values), std::end(values)));
+    TEST_ASSERT_NOT_NULL(vec.insert(vec.begin() + 1, std::begin(values), std::end(values)));
+    TEST_ASSERT_EQUAL_size_t(10, vec.size());
+    vec.erase(vec.begin() + 1, vec.begin() + 6);
+    TEST_ASSERT_EQUAL_INT_ARRAY(values, vec.begin(), 5);
+}
+
+void test_copy_trivial() {
+    cmagic::vector<int> vec;
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(vec.push_back(i));
+    }
+
+    // The copy is allocated once for all the elements
+    cmagic::vector<int> copy {vec};
+    TEST_ASSERT_EQUAL_size_t(100, copy.size());
+    TEST_ASSERT_EQUAL_size_t(100, copy.capacity());
+    TEST_ASSERT_EQUAL_INT_ARRAY(vec.begin(), copy.begin(), 100);
+
+    cmagic::vector<int> larger;
+    TEST_ASSERT_TRUE(larger.resize(200, -1));
+    const int *data {larger.begin()};
+    larger = vec;
+    TEST_ASSERT_EQUAL_PTR(data, larger.begin());
+    TEST_ASSERT_EQUAL_size_t(100, larger.size());
+    TEST_ASSERT_EQUAL_INT_ARRAY(vec.begin(), larger.begin(), 100);
+
+    larger = cmagic::vector<int>();
+    TEST_ASSERT_TRUE(larger.empty());
+}
+
 } // namespace
 
 int main() {
@@ -285,8 +527,14 @@ int main() {
     RUN_TEST(test_memory_management);
     RUN_TEST(test_copy);
     RUN_TEST(test_moving_semantics);
+    RUN_TEST(test_move_without_allocation);
     RUN_TEST(test_custom_alloc_vector);
     RUN_TEST(test_emplace_back);
     RUN_TEST(test_back_inserter);
+    RUN_TEST(test_reserve);
+    RUN_TEST(test_policy);
+    RUN_TEST(test_resize);
+    RUN_TEST(test_insert_erase);
+    RUN_TEST(test_copy_trivial);
     return UNITY_END();
 }